@@ -230,6 +230,19 @@ LINE_READER* DSNLEXER::PopReader()
 }
 
 
+const char* DSNLEXER::CurLine()
+{
+    // A line read in place is followed by the rest of the text, not by a nul
+    if( start != reader->Line() )
+    {
+        curLine.assign( start, limit );
+        return curLine.c_str();
+    }
+
+    return (const char*)(*reader);
+}
+
+
 #if 0
 static int compare( const void* a1, const void* a2 )
 {
@@ -657,7 +670,7 @@ L_read:
                     case 'x':   // 1 or 2 byte hex escape sequence
                         for( i=0; i<2; ++i )
                         {
-                            if( !isxdigit( head[i] ) )
+                            if( head+i >= limit || !isxdigit( head[i] ) )
                                 break;
                             tbuf[i] = head[i];
                         }
@@ -673,7 +686,7 @@ L_read:
                         --head;
                         for( i=0; i<3; ++i )
                         {
-                            if( head[i] < '0' || head[i] > '7' )
+                            if( head+i >= limit || head[i] < '0' || head[i] > '7' )
                                 break;
                             tbuf[i] = head[i];
                         }
@@ -697,7 +710,15 @@ L_read:
                 }
 
                 else
-                    curText += *head++;
+                {
+                    // copy the run of plain characters at once
+                    const char* run = head;
+
+                    while( head<limit && *head != '\\' && *head != '"' )
+                        ++head;
+
+                    curText.append( run, head );
+                }
 
             }   // while
 
@@ -777,13 +798,13 @@ L_read:
     }           // specctraMode
 
     // non-quoted token, read it into curText.
-    curText.clear();
-
     head = cur;
     while( head<limit && !isSep( *head ) )
-        curText += *head++;
+        ++head;
+
+    curText.assign( cur, head );
 
-    if( isNumber( curText.c_str(), curText.c_str() + curText.size() ) )
+    if( isNumber( cur, head ) )
     {
         curTok = DSN_NUMBER;
         goto exit;
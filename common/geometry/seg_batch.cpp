@@ -0,0 +1,273 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+
+#include <geometry/seg_batch.h>
+
+// SSE2 is always there on x86-64. The AVX2 kernel is built with a target attribute and
+// only used if the processor has it, which needs GCC or clang.
+#if defined( __x86_64__ ) || defined( _M_X64 ) || defined( __SSE2__ )
+#define SEG_BATCH_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined( SEG_BATCH_SSE2 ) && defined( __GNUC__ )
+#define SEG_BATCH_AVX2
+#include <immintrin.h>
+#endif
+
+// The kernels read the points as pairs of 32 bit coordinates
+static_assert( sizeof( VECTOR2I ) == 2 * sizeof( int32_t ), "VECTOR2I is not packed" );
+
+
+static std::atomic<int> s_kernel( -1 );
+
+
+static int firstBit( int aMask )
+{
+    int bit = 0;
+
+    while( !( aMask & ( 1 << bit ) ) )
+        bit++;
+
+    return bit;
+}
+
+
+#ifdef SEG_BATCH_SSE2
+
+/**
+ * Advances aIndex to the first segment kept among the next groups of 4 segments.
+ * @return false if there is none, aIndex being then the first segment left to test.
+ */
+static bool nextSse2( const VECTOR2I* aPoints, int& aIndex, int aLast,
+                      const int32_t aLo[2], const int32_t aHi[2] )
+{
+    const __m128i loX = _mm_set1_epi32( aLo[0] );
+    const __m128i loY = _mm_set1_epi32( aLo[1] );
+    const __m128i hiX = _mm_set1_epi32( aHi[0] );
+    const __m128i hiY = _mm_set1_epi32( aHi[1] );
+
+    // 4 segments at a time: the starts are the points i to i + 3, the ends i + 1 to i + 4
+    for( int& i = aIndex; i + 4 <= aLast; i += 4 )
+    {
+        const __m128i* a = reinterpret_cast<const __m128i*>( aPoints + i );
+        const __m128i* b = reinterpret_cast<const __m128i*>( aPoints + i + 1 );
+
+        const __m128 a01 = _mm_castsi128_ps( _mm_loadu_si128( a ) );
+        const __m128 a23 = _mm_castsi128_ps( _mm_loadu_si128( a + 1 ) );
+        const __m128 b01 = _mm_castsi128_ps( _mm_loadu_si128( b ) );
+        const __m128 b23 = _mm_castsi128_ps( _mm_loadu_si128( b + 1 ) );
+
+        const __m128i ax = _mm_castps_si128( _mm_shuffle_ps( a01, a23, _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+        const __m128i ay = _mm_castps_si128( _mm_shuffle_ps( a01, a23, _MM_SHUFFLE( 3, 1, 3, 1 ) ) );
+        const __m128i bx = _mm_castps_si128( _mm_shuffle_ps( b01, b23, _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+        const __m128i by = _mm_castps_si128( _mm_shuffle_ps( b01, b23, _MM_SHUFFLE( 3, 1, 3, 1 ) ) );
+
+        const __m128i keepX = _mm_and_si128(
+                _mm_or_si128( _mm_cmpgt_epi32( ax, loX ), _mm_cmpgt_epi32( bx, loX ) ),
+                _mm_or_si128( _mm_cmpgt_epi32( hiX, ax ), _mm_cmpgt_epi32( hiX, bx ) ) );
+        const __m128i keepY = _mm_and_si128(
+                _mm_or_si128( _mm_cmpgt_epi32( ay, loY ), _mm_cmpgt_epi32( by, loY ) ),
+                _mm_or_si128( _mm_cmpgt_epi32( hiY, ay ), _mm_cmpgt_epi32( hiY, by ) ) );
+
+        int mask = _mm_movemask_ps( _mm_castsi128_ps( _mm_and_si128( keepX, keepY ) ) );
+
+        if( mask )
+        {
+            i += firstBit( mask );
+            return true;
+        }
+    }
+
+    return false;
+}
+
+#endif
+
+
+#ifdef SEG_BATCH_AVX2
+
+/**
+ * Advances aIndex to the first segment kept among the next groups of 8 segments.
+ * @return false if there is none, aIndex being then the first segment left to test.
+ */
+__attribute__(( target( "avx2" ) ))
+static bool nextAvx2( const VECTOR2I* aPoints, int& aIndex, int aLast,
+                      const int32_t aLo[2], const int32_t aHi[2] )
+{
+    const __m256i loX = _mm256_set1_epi32( aLo[0] );
+    const __m256i loY = _mm256_set1_epi32( aLo[1] );
+    const __m256i hiX = _mm256_set1_epi32( aHi[0] );
+    const __m256i hiY = _mm256_set1_epi32( aHi[1] );
+
+    // Gathers the x coordinates of 4 points in the low lane, and the y ones in the high lane
+    const __m256i split = _mm256_setr_epi32( 0, 2, 4, 6, 1, 3, 5, 7 );
+
+    // 8 segments at a time: the starts are the points i to i + 7, the ends i + 1 to i + 8
+    for( int& i = aIndex; i + 8 <= aLast; i += 8 )
+    {
+        const __m256i* a = reinterpret_cast<const __m256i*>( aPoints + i );
+        const __m256i* b = reinterpret_cast<const __m256i*>( aPoints + i + 1 );
+
+        const __m256i a03 = _mm256_permutevar8x32_epi32( _mm256_loadu_si256( a ), split );
+        const __m256i a47 = _mm256_permutevar8x32_epi32( _mm256_loadu_si256( a + 1 ), split );
+        const __m256i b03 = _mm256_permutevar8x32_epi32( _mm256_loadu_si256( b ), split );
+        const __m256i b47 = _mm256_permutevar8x32_epi32( _mm256_loadu_si256( b + 1 ), split );
+
+        const __m256i ax = _mm256_permute2x128_si256( a03, a47, 0x20 );
+        const __m256i ay = _mm256_permute2x128_si256( a03, a47, 0x31 );
+        const __m256i bx = _mm256_permute2x128_si256( b03, b47, 0x20 );
+        const __m256i by = _mm256_permute2x128_si256( b03, b47, 0x31 );
+
+        const __m256i keepX = _mm256_and_si256(
+                _mm256_or_si256( _mm256_cmpgt_epi32( ax, loX ), _mm256_cmpgt_epi32( bx, loX ) ),
+                _mm256_or_si256( _mm256_cmpgt_epi32( hiX, ax ), _mm256_cmpgt_epi32( hiX, bx ) ) );
+        const __m256i keepY = _mm256_and_si256(
+                _mm256_or_si256( _mm256_cmpgt_epi32( ay, loY ), _mm256_cmpgt_epi32( by, loY ) ),
+                _mm256_or_si256( _mm256_cmpgt_epi32( hiY, ay ), _mm256_cmpgt_epi32( hiY, by ) ) );
+
+        int mask = _mm256_movemask_ps( _mm256_castsi256_ps( _mm256_and_si256( keepX, keepY ) ) );
+
+        if( mask )
+        {
+            i += firstBit( mask );
+            return true;
+        }
+    }
+
+    return false;
+}
+
+#endif
+
+
+SEG_BATCH::SEG_BATCH( const SEG& aQuery, int aDistance )
+{
+    m_lo[0] = (int64_t) std::min( aQuery.A.x, aQuery.B.x ) - aDistance;
+    m_lo[1] = (int64_t) std::min( aQuery.A.y, aQuery.B.y ) - aDistance;
+    m_hi[0] = (int64_t) std::max( aQuery.A.x, aQuery.B.x ) + aDistance;
+    m_hi[1] = (int64_t) std::max( aQuery.A.y, aQuery.B.y ) + aDistance;
+
+    m_enabled = aDistance > 0;
+    m_fitsInt32 = true;
+
+    for( int axis = 0; axis < 2; axis++ )
+    {
+        if( m_lo[axis] < INT32_MIN || m_hi[axis] > INT32_MAX )
+            m_fitsInt32 = false;
+    }
+}
+
+
+int SEG_BATCH::nextScalar( const VECTOR2I* aPoints, int aFirst, int aLast ) const
+{
+    for( int i = aFirst; i < aLast; i++ )
+    {
+        if( !Skips( aPoints[i], aPoints[i + 1] ) )
+            return i;
+    }
+
+    return aLast;
+}
+
+
+int SEG_BATCH::NextCandidate( const VECTOR2I* aPoints, int aFirst, int aLast ) const
+{
+    if( !m_enabled || aFirst >= aLast )
+        return aFirst;
+
+    if( !m_fitsInt32 )
+        return nextScalar( aPoints, aFirst, aLast );
+
+    const int32_t lo[2] = { (int32_t) m_lo[0], (int32_t) m_lo[1] };
+    const int32_t hi[2] = { (int32_t) m_hi[0], (int32_t) m_hi[1] };
+    int i = aFirst;
+
+    // The vector kernels leave the last few segments to the scalar loop
+    switch( GetKernel() )
+    {
+#ifdef SEG_BATCH_AVX2
+    case KERNEL_AVX2:
+        if( nextAvx2( aPoints, i, aLast, lo, hi ) )
+            return i;
+
+        // Less than 8 segments are left, which may still fill an SSE2 register
+        if( nextSse2( aPoints, i, aLast, lo, hi ) )
+            return i;
+
+        break;
+#endif
+
+#ifdef SEG_BATCH_SSE2
+    case KERNEL_SSE2:
+        if( nextSse2( aPoints, i, aLast, lo, hi ) )
+            return i;
+
+        break;
+#endif
+
+    default:
+        break;
+    }
+
+    return nextScalar( aPoints, i, aLast );
+}
+
+
+SEG_BATCH::KERNEL SEG_BATCH::BestKernel()
+{
+#ifdef SEG_BATCH_AVX2
+    if( __builtin_cpu_supports( "avx2" ) )
+        return KERNEL_AVX2;
+#endif
+
+#ifdef SEG_BATCH_SSE2
+    return KERNEL_SSE2;
+#else
+    return KERNEL_SCALAR;
+#endif
+}
+
+
+void SEG_BATCH::SetKernel( KERNEL aKernel )
+{
+    s_kernel = std::min( aKernel, BestKernel() );
+}
+
+
+SEG_BATCH::KERNEL SEG_BATCH::GetKernel()
+{
+    int kernel = s_kernel;
+
+    if( kernel < 0 )
+    {
+        kernel = BestKernel();
+        s_kernel = kernel;
+    }
+
+    return (KERNEL) kernel;
+}
@@ -31,6 +31,7 @@
 #include <geometry/shape_rect.h>
 #include <geometry/shape_segment.h>
 #include <geometry/shape_convex.h>
+#include <geometry/seg_batch.h>
 
 typedef VECTOR2I::extended_type ecoord;
 
@@ -151,7 +152,13 @@ static inline bool Collide( const SHAPE_CIRCLE& aA, const SHAPE_LINE_CHAIN& aB,
 {
     bool found = false;
 
-    for( int s = 0; s < aB.SegmentCount(); s++ )
+    // The segments whose bounding box is too far from the circle are skipped; the batch
+    // agrees with SEG::Distance() below 2^26
+    const int rc = aClearance + aA.GetRadius();
+    const SEG_BATCH batch( SEG( aA.GetCenter(), aA.GetCenter() ), rc < ( 1 << 26 ) ? rc : 0 );
+
+    for( int s = aB.NextCandidateSegment( batch, 0 ); s < aB.SegmentCount();
+         s = aB.NextCandidateSegment( batch, s + 1 ) )
     {
         if( aA.Collide( aB.CSegment( s ), aClearance ) )
         {
@@ -24,6 +24,9 @@
 
 #include <geometry/shape_line_chain.h>
 #include <geometry/shape_circle.h>
+#include <geometry/seg_batch.h>
+
+#include <atomic>
 
 using boost::optional;
 
@@ -40,7 +43,11 @@ bool SHAPE_LINE_CHAIN::Collide( const SEG& aSeg, int aClearance ) const
     BOX2I box_a( aSeg.A, aSeg.B - aSeg.A );
     BOX2I::ecoord_type dist_sq = (BOX2I::ecoord_type) aClearance * aClearance;
 
-    for( int i = 0; i < SegmentCount(); i++ )
+    // Skips the segments whose bounding box is too far, several at a time
+    const SEG_BATCH batch( aSeg, aClearance );
+
+    for( int i = NextCandidateSegment( batch, 0 ); i < SegmentCount();
+         i = NextCandidateSegment( batch, i + 1 ) )
     {
         const SEG& s = CSegment( i );
         BOX2I box_b( s.A, s.B - s.A );
@@ -58,6 +65,26 @@ bool SHAPE_LINE_CHAIN::Collide( const SEG& aSeg, int aClearance ) const
 }
 
 
+int SHAPE_LINE_CHAIN::NextCandidateSegment( const SEG_BATCH& aBatch, int aFirst ) const
+{
+    // The segments between consecutive points, then the closing one
+    int last = PointCount() - 1;
+
+    if( aFirst < last )
+    {
+        aFirst = aBatch.NextCandidate( &m_points[0], aFirst, last );
+
+        if( aFirst < last )
+            return aFirst;
+    }
+
+    if( m_closed && aFirst == last && !aBatch.Skips( m_points[last], m_points[0] ) )
+        return aFirst;
+
+    return SegmentCount();
+}
+
+
 const SHAPE_LINE_CHAIN SHAPE_LINE_CHAIN::Reverse() const
 {
     SHAPE_LINE_CHAIN a( *this );
@@ -95,6 +122,8 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const VECTOR2I&
         m_points.erase( m_points.begin() + aStartIndex + 1, m_points.begin() + aEndIndex + 1 );
         m_points[aStartIndex] = aP;
     }
+
+    changed();
 }
 
 
@@ -108,6 +137,7 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const SHAPE_LINE
 
     m_points.erase( m_points.begin() + aStartIndex, m_points.begin() + aEndIndex + 1 );
     m_points.insert( m_points.begin() + aStartIndex, aLine.m_points.begin(), aLine.m_points.end() );
+    changed();
 }
 
 
@@ -120,6 +150,7 @@ void SHAPE_LINE_CHAIN::Remove( int aStartIndex, int aEndIndex )
         aStartIndex += PointCount();
 
     m_points.erase( m_points.begin() + aStartIndex, m_points.begin() + aEndIndex + 1 );
+    changed();
 }
 
 
@@ -167,6 +198,7 @@ int SHAPE_LINE_CHAIN::Split( const VECTOR2I& aP )
     if( ii >= 0 )
     {
         m_points.insert( m_points.begin() + ii + 1, aP );
+        changed();
 
         return ii + 1;
     }
@@ -425,7 +457,10 @@ SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify()
     else if( PointCount() == 2 )
     {
         if( m_points[0] == m_points[1] )
+        {
             m_points.pop_back();
+            changed();
+        }
 
         return *this;
     }
@@ -446,6 +481,7 @@ SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify()
     }
 
     m_points.clear();
+    changed();
     np = pts_unique.size();
 
     i = 0;
@@ -559,6 +595,25 @@ bool SHAPE_LINE_CHAIN::Intersects( const SHAPE_LINE_CHAIN& aChain ) const
 }
 
 
+uint64_t SHAPE_LINE_CHAIN::newVersion()
+{
+    // Each thread takes the versions it gives from a block of its own, so that the changes
+    // of the chains do not all update the same counter
+    const uint64_t blockSize = 4096;
+    static std::atomic<uint64_t> nextBlock( 1 );
+    thread_local uint64_t next = 0;
+    thread_local uint64_t blockEnd = 0;
+
+    if( next == blockEnd )
+    {
+        next = nextBlock.fetch_add( 1 ) * blockSize;
+        blockEnd = next + blockSize;
+    }
+
+    return next++;
+}
+
+
 SHAPE* SHAPE_LINE_CHAIN::Clone() const
 {
     return new SHAPE_LINE_CHAIN( *this );
@@ -569,6 +624,7 @@ bool SHAPE_LINE_CHAIN::Parse( std::stringstream& aStream )
     int n_pts;
 
     m_points.clear();
+    changed();
     aStream >> n_pts;
 
     // Rough sanity check, just make sure the loop bounds aren't absolutely outlandish
@@ -38,6 +38,8 @@
 #include <geometry/shape.h>
 #include <geometry/shape_line_chain.h>
 #include <geometry/shape_poly_set.h>
+#include <geometry/shape_poly_set_index.h>
+#include <thread_pool.h>
 
 using namespace ClipperLib;
 
@@ -48,7 +50,8 @@ SHAPE_POLY_SET::SHAPE_POLY_SET() :
 
 
 SHAPE_POLY_SET::SHAPE_POLY_SET( const SHAPE_POLY_SET& aOther ) :
-    SHAPE( SH_POLY_SET ), m_polys( aOther.m_polys )
+    SHAPE( SH_POLY_SET ), m_polys( aOther.m_polys ),
+    m_index( std::atomic_load( &aOther.m_index ) )
 {
 }
 
@@ -153,6 +156,7 @@ int SHAPE_POLY_SET::NewOutline()
     POLYGON poly;
     empty_path.SetClosed( true );
     poly.push_back( empty_path );
+    invalidateIndex();
     m_polys.push_back( poly );
     return m_polys.size() - 1;
 }
@@ -160,6 +164,8 @@ int SHAPE_POLY_SET::NewOutline()
 
 int SHAPE_POLY_SET::NewHole( int aOutline )
 {
+    invalidateIndex();
+
     SHAPE_LINE_CHAIN empty_path;
     empty_path.SetClosed( true );
 
@@ -176,6 +182,8 @@ int SHAPE_POLY_SET::NewHole( int aOutline )
 
 int SHAPE_POLY_SET::Append( int x, int y, int aOutline, int aHole, bool aAllowDuplication )
 {
+    invalidateIndex();
+
     if( aOutline < 0 )
         aOutline += m_polys.size();
 
@@ -199,6 +207,8 @@ void SHAPE_POLY_SET::InsertVertex( int aGlobalIndex, VECTOR2I aNewVertex )
 {
     VERTEX_INDEX index;
 
+    invalidateIndex();
+
     if( aGlobalIndex < 0 )
         aGlobalIndex = 0;
 
@@ -251,7 +261,7 @@ SHAPE_POLY_SET SHAPE_POLY_SET::Subset( int aFirstPolygon, int aLastPolygon )
 
     for( int index = aFirstPolygon; index < aLastPolygon; index++ )
     {
-        newPolySet.m_polys.push_back( Polygon( index ) );
+        newPolySet.m_polys.push_back( CPolygon( index ) );
     }
 
     return newPolySet;
@@ -428,6 +438,7 @@ int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
 
     poly.push_back( aOutline );
 
+    invalidateIndex();
     m_polys.push_back( poly );
 
     return m_polys.size() - 1;
@@ -441,6 +452,8 @@ int SHAPE_POLY_SET::AddHole( const SHAPE_LINE_CHAIN& aHole, int aOutline )
     if( aOutline < 0 )
         aOutline += m_polys.size();
 
+    invalidateIndex();
+
     POLYGON& poly = m_polys[aOutline];
 
     assert( poly.size() );
@@ -484,9 +497,12 @@ const SHAPE_LINE_CHAIN SHAPE_POLY_SET::convertFromClipper( const Path& aPath )
 void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType, const SHAPE_POLY_SET& aOtherShape,
                                 POLYGON_MODE aFastMode )
 {
+    if( isPartitioned( aFastMode ) && booleanOpPartitioned( aType, *this, aOtherShape, aFastMode ) )
+        return;
+
     Clipper c;
 
-    if( aFastMode == PM_STRICTLY_SIMPLE )
+    if( isStrictlySimple( aFastMode ) )
         c.StrictlySimple( true );
 
     for( const POLYGON& poly : m_polys )
@@ -514,9 +530,12 @@ void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType,
                                 const SHAPE_POLY_SET& aOtherShape,
                                 POLYGON_MODE aFastMode )
 {
+    if( isPartitioned( aFastMode ) && booleanOpPartitioned( aType, aShape, aOtherShape, aFastMode ) )
+        return;
+
     Clipper c;
 
-    if( aFastMode == PM_STRICTLY_SIMPLE )
+    if( isStrictlySimple( aFastMode ) )
         c.StrictlySimple( true );
 
     for( const POLYGON& poly : aShape.m_polys )
@@ -539,6 +558,227 @@ void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType,
 }
 
 
+// Below this number of vertices, the partitioned operations are not worth the threads
+static const int PartitionMinVertexCount = 2000;
+
+// The groups of polygons are gathered in tasks of about this number of vertices
+static const int PartitionTaskVertexCount = 1000;
+
+
+/**
+ * Splits polygons into groups whose bounding boxes, inflated by aMargin, do not touch each
+ * other, and gathers the groups in tasks of about PartitionTaskVertexCount vertices. The
+ * groups and the polygons of the tasks are in the order of their first polygon, so the
+ * tasks do not depend on the number of threads.
+ * @param aBoxes are the bounding boxes of the polygons.
+ * @param aVertexCounts are the number of vertices of the polygons.
+ * @return the tasks, as lists of indexes in aBoxes.
+ */
+static std::vector<std::vector<int>> partitionPolygons( const std::vector<BOX2I>& aBoxes,
+                                                        const std::vector<int>& aVertexCounts,
+                                                        int aMargin )
+{
+    int count = aBoxes.size();
+    std::vector<int> parent( count );
+    std::vector<int> byLeft( count );
+
+    for( int i = 0; i < count; i++ )
+        parent[i] = byLeft[i] = i;
+
+    auto root = [&]( int aItem ) -> int
+    {
+        while( parent[aItem] != aItem )
+        {
+            parent[aItem] = parent[parent[aItem]];
+            aItem = parent[aItem];
+        }
+
+        return aItem;
+    };
+
+    // Sweep along x: a box can only touch the boxes still open at its left side
+    std::sort( byLeft.begin(), byLeft.end(), [&]( int aA, int aB )
+    {
+        return aBoxes[aA].GetLeft() < aBoxes[aB].GetLeft();
+    } );
+
+    std::vector<int> open;
+
+    for( int item : byLeft )
+    {
+        const BOX2I& box = aBoxes[item];
+        int64_t left = (int64_t) box.GetLeft() - aMargin;
+        int64_t top = (int64_t) box.GetTop() - aMargin;
+        int64_t bottom = (int64_t) box.GetBottom() + aMargin;
+        unsigned kept = 0;
+
+        for( int other : open )
+        {
+            const BOX2I& otherBox = aBoxes[other];
+
+            if( (int64_t) otherBox.GetRight() + aMargin < left )
+                continue;
+
+            open[kept++] = other;
+
+            if( (int64_t) otherBox.GetTop() - aMargin <= bottom
+                    && (int64_t) otherBox.GetBottom() + aMargin >= top )
+                parent[root( other )] = root( item );
+        }
+
+        open.resize( kept );
+        open.push_back( item );
+    }
+
+    // Number the groups in the order of their first polygon
+    std::vector<int> groupOf( count, -1 );
+    std::vector<std::vector<int>> groups;
+
+    for( int i = 0; i < count; i++ )
+    {
+        int& group = groupOf[root( i )];
+
+        if( group < 0 )
+        {
+            group = groups.size();
+            groups.emplace_back();
+        }
+
+        groups[group].push_back( i );
+    }
+
+    std::vector<std::vector<int>> tasks;
+    int taskVertices = PartitionTaskVertexCount;
+
+    for( const std::vector<int>& group : groups )
+    {
+        if( taskVertices >= PartitionTaskVertexCount )
+        {
+            tasks.emplace_back();
+            taskVertices = 0;
+        }
+
+        for( int item : group )
+        {
+            tasks.back().push_back( item );
+            taskVertices += aVertexCounts[item];
+        }
+    }
+
+    for( std::vector<int>& task : tasks )
+        std::sort( task.begin(), task.end() );
+
+    return tasks;
+}
+
+
+/**
+ * Collects the bounding boxes and the number of vertices of the polygons of aPolys.
+ * @return the total number of vertices.
+ */
+static int polygonBoxes( const std::vector<SHAPE_POLY_SET::POLYGON>& aPolys,
+                         std::vector<BOX2I>& aBoxes, std::vector<int>& aVertexCounts )
+{
+    int total = 0;
+
+    for( const SHAPE_POLY_SET::POLYGON& poly : aPolys )
+    {
+        BOX2I box;
+        int vertices = 0;
+
+        for( unsigned int i = 0; i < poly.size(); i++ )
+        {
+            if( i == 0 )
+                box = poly[i].BBox();
+            else
+                box.Merge( poly[i].BBox() );
+
+            vertices += poly[i].PointCount();
+        }
+
+        aBoxes.push_back( box );
+        aVertexCounts.push_back( vertices );
+        total += vertices;
+    }
+
+    return total;
+}
+
+
+bool SHAPE_POLY_SET::booleanOpPartitioned( ClipperLib::ClipType aType,
+                                           const SHAPE_POLY_SET& aShape,
+                                           const SHAPE_POLY_SET& aOtherShape,
+                                           POLYGON_MODE aFastMode )
+{
+    std::vector<BOX2I> boxes;
+    std::vector<int> vertexCounts;
+    int subjectCount = aShape.m_polys.size();
+    int total = polygonBoxes( aShape.m_polys, boxes, vertexCounts );
+
+    total += polygonBoxes( aOtherShape.m_polys, boxes, vertexCounts );
+
+    if( total < PartitionMinVertexCount )
+        return false;
+
+    std::vector<std::vector<int>> tasks = partitionPolygons( boxes, vertexCounts, 0 );
+
+    if( tasks.size() < 2 )
+        return false;
+
+    std::vector<std::vector<POLYGON>> results( tasks.size() );
+
+    THREAD_POOL::GetInstance().ParallelFor( tasks.size(), [&]( size_t aTask )
+    {
+        Clipper c;
+        bool hasSubject = false;
+        bool hasClip = false;
+
+        if( isStrictlySimple( aFastMode ) )
+            c.StrictlySimple( true );
+
+        for( int item : tasks[aTask] )
+        {
+            bool isSubject = item < subjectCount;
+            const POLYGON& poly = isSubject ? aShape.m_polys[item]
+                                            : aOtherShape.m_polys[item - subjectCount];
+
+            hasSubject |= isSubject;
+            hasClip |= !isSubject;
+
+            for( unsigned int i = 0; i < poly.size(); i++ )
+            {
+                c.AddPath( convertToClipper( poly[i], i > 0 ? false : true ),
+                           isSubject ? ptSubject : ptClip, true );
+            }
+        }
+
+        // Nothing is left of a difference without subject or of an intersection without
+        // both operands
+        if( ( aType == ctDifference && !hasSubject )
+                || ( aType == ctIntersection && !( hasSubject && hasClip ) ) )
+            return;
+
+        PolyTree solution;
+
+        c.Execute( aType, solution, pftNonZero, pftNonZero );
+
+        appendTree( &solution, results[aTask] );
+    } );
+
+    // aShape may be this set
+    invalidateIndex();
+    m_polys.clear();
+
+    for( std::vector<POLYGON>& result : results )
+    {
+        for( POLYGON& poly : result )
+            m_polys.push_back( std::move( poly ) );
+    }
+
+    return true;
+}
+
+
 void SHAPE_POLY_SET::BooleanAdd( const SHAPE_POLY_SET& b, POLYGON_MODE aFastMode )
 {
     booleanOp( ctUnion, b, aFastMode );
@@ -557,6 +797,12 @@ void SHAPE_POLY_SET::BooleanIntersection( const SHAPE_POLY_SET& b, POLYGON_MODE
 }
 
 
+void SHAPE_POLY_SET::BooleanXor( const SHAPE_POLY_SET& b, POLYGON_MODE aFastMode )
+{
+    booleanOp( ctXor, b, aFastMode );
+}
+
+
 void SHAPE_POLY_SET::BooleanAdd( const SHAPE_POLY_SET& a, const SHAPE_POLY_SET& b, POLYGON_MODE aFastMode )
 {
     booleanOp( ctUnion, a, b, aFastMode );
@@ -575,7 +821,7 @@ void SHAPE_POLY_SET::BooleanIntersection( const SHAPE_POLY_SET& a, const SHAPE_P
 }
 
 
-void SHAPE_POLY_SET::Inflate( int aFactor, int aCircleSegmentsCount )
+void SHAPE_POLY_SET::Inflate( int aFactor, int aCircleSegmentsCount, POLYGON_MODE aMode )
 {
     // A static table to avoid repetitive calculations of the coefficient
     // 1.0 - cos( M_PI/aCircleSegmentsCount)
@@ -583,16 +829,6 @@ void SHAPE_POLY_SET::Inflate( int aFactor, int aCircleSegmentsCount )
     #define SEG_CNT_MAX 64
     static double arc_tolerance_factor[SEG_CNT_MAX+1];
 
-    ClipperOffset c;
-
-    for( const POLYGON& poly : m_polys )
-    {
-        for( unsigned int i = 0; i < poly.size(); i++ )
-            c.AddPath( convertToClipper( poly[i], i > 0 ? false : true ), jtRound, etClosedPolygon );
-    }
-
-    PolyTree solution;
-
     // Calculate the arc tolerance (arc error) from the seg count by circle.
     // the seg count is nn = M_PI / acos(1.0 - c.ArcTolerance / abs(aFactor))
     // see:
@@ -613,18 +849,77 @@ void SHAPE_POLY_SET::Inflate( int aFactor, int aCircleSegmentsCount )
     else
         coeff = arc_tolerance_factor[aCircleSegmentsCount];
 
-    c.ArcTolerance = std::abs( aFactor ) * coeff;
+    double arcTolerance = std::abs( aFactor ) * coeff;
 
-    c.Execute( solution, aFactor );
+    std::vector<std::vector<int>> tasks;
 
-    importTree( &solution );
+    if( isPartitioned( aMode ) )
+    {
+        std::vector<BOX2I> boxes;
+        std::vector<int> vertexCounts;
+
+        // The polygons may grow by aFactor, and one more unit for the rounding of the arcs
+        if( polygonBoxes( m_polys, boxes, vertexCounts ) >= PartitionMinVertexCount )
+            tasks = partitionPolygons( boxes, vertexCounts, std::max( aFactor, 0 ) + 1 );
+    }
+
+    if( tasks.size() < 2 )
+    {
+        tasks.assign( 1, std::vector<int>( m_polys.size() ) );
+
+        for( unsigned int i = 0; i < m_polys.size(); i++ )
+            tasks[0][i] = i;
+    }
+
+    std::vector<std::vector<POLYGON>> results( tasks.size() );
+
+    auto inflateTask = [&]( size_t aTask )
+    {
+        ClipperOffset c;
+
+        for( int item : tasks[aTask] )
+        {
+            const POLYGON& poly = m_polys[item];
+
+            for( unsigned int i = 0; i < poly.size(); i++ )
+                c.AddPath( convertToClipper( poly[i], i > 0 ? false : true ), jtRound, etClosedPolygon );
+        }
+
+        PolyTree solution;
+
+        c.ArcTolerance = arcTolerance;
+        c.Execute( solution, aFactor );
+
+        appendTree( &solution, results[aTask] );
+    };
+
+    if( tasks.size() == 1 )
+        inflateTask( 0 );
+    else
+        THREAD_POOL::GetInstance().ParallelFor( tasks.size(), inflateTask );
+
+    invalidateIndex();
+    m_polys.clear();
+
+    for( std::vector<POLYGON>& result : results )
+    {
+        for( POLYGON& poly : result )
+            m_polys.push_back( std::move( poly ) );
+    }
 }
 
 
 void SHAPE_POLY_SET::importTree( PolyTree* tree )
 {
+    invalidateIndex();
     m_polys.clear();
 
+    appendTree( tree, m_polys );
+}
+
+
+void SHAPE_POLY_SET::appendTree( PolyTree* tree, std::vector<POLYGON>& aPolys )
+{
     for( PolyNode* n = tree->GetFirst(); n; n = n->GetNext() )
     {
         if( !n->IsHole() )
@@ -636,7 +931,7 @@ void SHAPE_POLY_SET::importTree( PolyTree* tree )
             for( unsigned int i = 0; i < n->Childs.size(); i++ )
                 paths.push_back( convertFromClipper( n->Childs[i]->Contour ) );
 
-            m_polys.push_back( paths );
+            aPolys.push_back( paths );
         }
     }
 }
@@ -858,6 +1153,25 @@ void SHAPE_POLY_SET::Fracture( POLYGON_MODE aFastMode )
 {
     Simplify( aFastMode ); // remove overlapping holes/degeneracy
 
+    FractureSimplified( aFastMode );
+}
+
+
+void SHAPE_POLY_SET::FractureSimplified( POLYGON_MODE aMode )
+{
+    invalidateIndex();
+
+    if( isPartitioned( aMode ) && m_polys.size() > 1
+            && TotalVertices() >= PartitionMinVertexCount )
+    {
+        THREAD_POOL::GetInstance().ParallelFor( m_polys.size(), [&]( size_t aPolygon )
+        {
+            fractureSingle( m_polys[aPolygon] );
+        } );
+
+        return;
+    }
+
     for( POLYGON& paths : m_polys )
     {
         fractureSingle( paths );
@@ -994,6 +1308,7 @@ bool SHAPE_POLY_SET::Parse( std::stringstream& aStream )
             paths.push_back( outline );
         }
 
+        invalidateIndex();
         m_polys.push_back( paths );
     }
     return true;
@@ -1019,13 +1334,20 @@ const BOX2I SHAPE_POLY_SET::BBox( int aClearance ) const
 
 bool SHAPE_POLY_SET::PointOnEdge( const VECTOR2I& aP ) const
 {
+    std::shared_ptr<const SHAPE_POLY_SET_INDEX> polyIndex = index();
+
     // Iterate through all the polygons in the set
-    for( const POLYGON& polygon : m_polys )
+    for( unsigned polygonIdx = 0; polygonIdx < m_polys.size(); polygonIdx++ )
     {
+        const POLYGON& polygon = m_polys[polygonIdx];
+
         // Iterate through all the line chains in the polygon
-        for( const SHAPE_LINE_CHAIN& lineChain : polygon )
+        for( unsigned contourIdx = 0; contourIdx < polygon.size(); contourIdx++ )
         {
-            if( lineChain.PointOnEdge( aP ) )
+            const SHAPE_LINE_CHAIN& lineChain = polygon[contourIdx];
+
+            if( polyIndex ? polyIndex->PointOnContourEdge( aP, polygonIdx, contourIdx, lineChain )
+                          : lineChain.PointOnEdge( aP ) )
                 return true;
         }
     }
@@ -1052,6 +1374,7 @@ bool SHAPE_POLY_SET::Collide( const VECTOR2I& aP, int aClearance ) const
 
 void SHAPE_POLY_SET::RemoveAllContours()
 {
+    invalidateIndex();
     m_polys.clear();
 }
 
@@ -1062,6 +1385,7 @@ void SHAPE_POLY_SET::RemoveContour( int aContourIdx, int aPolygonIdx )
     if( aPolygonIdx < 0 )
         aPolygonIdx += m_polys.size();
 
+    invalidateIndex();
      m_polys[aPolygonIdx].erase( m_polys[aPolygonIdx].begin() + aContourIdx );
 }
 
@@ -1121,12 +1445,14 @@ int SHAPE_POLY_SET::RemoveNullSegments()
 
 void SHAPE_POLY_SET::DeletePolygon( int aIdx )
 {
+    invalidateIndex();
     m_polys.erase( m_polys.begin() + aIdx );
 }
 
 
 void SHAPE_POLY_SET::Append( const SHAPE_POLY_SET& aSet )
 {
+    invalidateIndex();
     m_polys.insert( m_polys.end(), aSet.m_polys.begin(), aSet.m_polys.end() );
 }
 
@@ -1138,7 +1464,8 @@ void SHAPE_POLY_SET::Append( const VECTOR2I& aP, int aOutline, int aHole )
 
 
 bool SHAPE_POLY_SET::CollideVertex( const VECTOR2I& aPoint,
-                                    SHAPE_POLY_SET::VERTEX_INDEX& aClosestVertex, int aClearance )
+                                    SHAPE_POLY_SET::VERTEX_INDEX& aClosestVertex,
+                                    int aClearance ) const
 {
     // Shows whether there was a collision
     bool collision = false;
@@ -1150,10 +1477,16 @@ bool SHAPE_POLY_SET::CollideVertex( const VECTOR2I& aPoint,
     // Convert clearance to double for precission when comparing distances
     clearance = aClearance;
 
-    for( ITERATOR iterator = IterateWithHoles(); iterator; iterator++ )
+    // The vertices close enough to aPoint are the first ones of the edges close enough,
+    // in the same order
+    std::vector<VERTEX_INDEX> edges;
+
+    collectEdges( aPoint, aClearance, edges );
+
+    for( const VERTEX_INDEX& edge : edges )
     {
         // Get the difference vector between current vertex and aPoint
-        delta = *iterator - aPoint;
+        delta = CVertex( edge ) - aPoint;
 
         // Compute distance
         distance = delta.EuclideanNorm();
@@ -1167,7 +1500,7 @@ bool SHAPE_POLY_SET::CollideVertex( const VECTOR2I& aPoint,
             clearance = distance;
 
             // Store the indices that identify the vertex
-            aClosestVertex = iterator.GetIndex();
+            aClosestVertex = edge;
         }
     }
 
@@ -1176,16 +1509,26 @@ bool SHAPE_POLY_SET::CollideVertex( const VECTOR2I& aPoint,
 
 
 bool SHAPE_POLY_SET::CollideEdge( const VECTOR2I& aPoint,
-                                  SHAPE_POLY_SET::VERTEX_INDEX& aClosestVertex, int aClearance )
+                                  SHAPE_POLY_SET::VERTEX_INDEX& aClosestVertex,
+                                  int aClearance ) const
 {
     // Shows whether there was a collision
     bool collision = false;
 
-    SEGMENT_ITERATOR iterator;
+    // A segment at aClearance or less (rounded down) is less than aClearance + 1 away
+    std::vector<VERTEX_INDEX> edges;
+
+    collectEdges( aPoint, aClearance + 1, edges );
 
-    for( iterator = IterateSegmentsWithHoles(); iterator; iterator++ )
+    for( const VERTEX_INDEX& edge : edges )
     {
-        SEG currentSegment = *iterator;
+        const SHAPE_LINE_CHAIN& contour = m_polys[edge.m_polygon][edge.m_contour];
+
+        // The closing edge of an open contour is not a segment
+        if( edge.m_vertex >= contour.SegmentCount() )
+            continue;
+
+        SEG currentSegment = contour.CSegment( edge.m_vertex );
         int distance = currentSegment.Distance( aPoint );
 
         // Check for collisions
@@ -1197,7 +1540,7 @@ bool SHAPE_POLY_SET::CollideEdge( const VECTOR2I& aPoint,
             aClearance = distance;
 
             // Store the indices that identify the vertex
-            aClosestVertex = iterator.GetIndex();
+            aClosestVertex = edge;
         }
     }
 
@@ -1205,19 +1548,93 @@ bool SHAPE_POLY_SET::CollideEdge( const VECTOR2I& aPoint,
 }
 
 
+bool SHAPE_POLY_SET::IsNearEdge( const VECTOR2I& aPoint, int aDistance ) const
+{
+    VECTOR2I::extended_type maxDistance = (VECTOR2I::extended_type) aDistance * aDistance;
+    std::vector<VERTEX_INDEX> edges;
+
+    collectEdges( aPoint, aDistance, edges );
+
+    for( const VERTEX_INDEX& edge : edges )
+    {
+        const SHAPE_LINE_CHAIN& contour = m_polys[edge.m_polygon][edge.m_contour];
+
+        // The closing edge of an open contour is not a segment
+        if( edge.m_vertex >= contour.SegmentCount() )
+            continue;
+
+        if( contour.CSegment( edge.m_vertex ).SquaredDistance( aPoint ) <= maxDistance )
+            return true;
+    }
+
+    return false;
+}
+
+
+void SHAPE_POLY_SET::collectEdges( const VECTOR2I& aP, int aDistance,
+                                   std::vector<VERTEX_INDEX>& aEdges ) const
+{
+    std::shared_ptr<const SHAPE_POLY_SET_INDEX> polyIndex = index();
+
+    if( polyIndex )
+    {
+        polyIndex->QueryEdges( aP, aDistance, aEdges );
+        return;
+    }
+
+    for( unsigned polygonIdx = 0; polygonIdx < m_polys.size(); polygonIdx++ )
+    {
+        for( unsigned contourIdx = 0; contourIdx < m_polys[polygonIdx].size(); contourIdx++ )
+        {
+            VERTEX_INDEX edge;
+
+            edge.m_polygon = polygonIdx;
+            edge.m_contour = contourIdx;
+
+            for( int i = 0; i < m_polys[polygonIdx][contourIdx].PointCount(); i++ )
+            {
+                edge.m_vertex = i;
+                aEdges.push_back( edge );
+            }
+        }
+    }
+}
+
+
+std::shared_ptr<const SHAPE_POLY_SET_INDEX> SHAPE_POLY_SET::index() const
+{
+    std::shared_ptr<const SHAPE_POLY_SET_INDEX> polyIndex = std::atomic_load( &m_index );
+
+    // The contours may have been changed through references to them
+    if( polyIndex && !polyIndex->IsValid( *this ) )
+        polyIndex.reset();
+
+    if( !polyIndex && TotalVertices() >= SHAPE_POLY_SET_INDEX::MinVertexCount )
+    {
+        // Two threads may build it at once: one of the indexes is kept, they are the same
+        polyIndex = std::make_shared<const SHAPE_POLY_SET_INDEX>( *this );
+        std::atomic_store( &m_index, polyIndex );
+    }
+
+    return polyIndex;
+}
+
+
 bool SHAPE_POLY_SET::Contains( const VECTOR2I& aP, int aSubpolyIndex ) const
 {
     if( m_polys.size() == 0 ) // empty set?
         return false;
 
+    std::shared_ptr<const SHAPE_POLY_SET_INDEX> polyIndex = index();
+
     // If there is a polygon specified, check the condition against that polygon
     if( aSubpolyIndex >= 0 )
-        return containsSingle( aP, aSubpolyIndex );
+        return containsSingle( aP, aSubpolyIndex, polyIndex.get() );
 
     // In any other case, check it against all polygons in the set
     for( int polygonIdx = 0; polygonIdx < OutlineCount(); polygonIdx++ )
     {
-        if( containsSingle( aP, polygonIdx ) )
+        if( containsSingle( aP, polygonIdx, polyIndex.get() ) )
             return true;
     }
 
@@ -1240,23 +1657,37 @@ void SHAPE_POLY_SET::RemoveVertex( int aGlobalIndex )
 
 void SHAPE_POLY_SET::RemoveVertex( VERTEX_INDEX aIndex )
 {
+    invalidateIndex();
     m_polys[aIndex.m_polygon][aIndex.m_contour].Remove( aIndex.m_vertex );
 }
 
 
-bool SHAPE_POLY_SET::containsSingle( const VECTOR2I& aP, int aSubpolyIndex ) const
+bool SHAPE_POLY_SET::containsSingle( const VECTOR2I& aP, int aSubpolyIndex,
+                                     const SHAPE_POLY_SET_INDEX* aIndex ) const
 {
+    const POLYGON& polygon = m_polys[aSubpolyIndex];
+
     // Check that the point is inside the outline
-    if( pointInPolygon( aP, m_polys[aSubpolyIndex][0] ) )
+    if( aIndex ? aIndex->PointInContour( aP, aSubpolyIndex, 0, polygon[0] )
+               : pointInPolygon( aP, polygon[0] ) )
     {
         // Check that the point is not in any of the holes
         for( int holeIdx = 0; holeIdx < HoleCount( aSubpolyIndex ); holeIdx++ )
         {
-            const SHAPE_LINE_CHAIN hole = CHole( aSubpolyIndex, holeIdx );
+            const SHAPE_LINE_CHAIN& hole = polygon[holeIdx + 1];
+
             // If the point is inside a hole (and not on its edge),
             // it is outside of the polygon
-            if( pointInPolygon( aP, hole ) && !hole.PointOnEdge( aP ) )
+            if( aIndex )
+            {
+                if( aIndex->PointInContour( aP, aSubpolyIndex, holeIdx + 1, hole )
+                        && !aIndex->PointOnContourEdge( aP, aSubpolyIndex, holeIdx + 1, hole ) )
+                    return false;
+            }
+            else if( pointInPolygon( aP, hole ) && !hole.PointOnEdge( aP ) )
+            {
                 return false;
+            }
         }
 
         return true;
@@ -1282,48 +1713,12 @@ bool SHAPE_POLY_SET::pointInPolygon( const VECTOR2I& aP, const SHAPE_LINE_CHAIN&
     for( int i = 1; i <= cnt; ++i )
     {
         VECTOR2I ipNext = ( i == cnt ? aPath.CPoint( 0 ) : aPath.CPoint( i ) );
+        int crossing = SHAPE_POLY_SET_INDEX::EdgeCrossing( aP, ip, ipNext );
 
-        if( ipNext.y == aP.y )
-        {
-            if( ( ipNext.x == aP.x ) || ( ip.y == aP.y &&
-                ( ( ipNext.x > aP.x ) == ( ip.x < aP.x ) ) ) )
-                return true;
-        }
-
-        if( ( ip.y < aP.y ) != ( ipNext.y < aP.y ) )
-        {
-            if( ip.x >= aP.x )
-            {
-                if( ipNext.x > aP.x )
-                    result = 1 - result;
-                else
-                {
-                    int64_t d = (int64_t)( ip.x - aP.x ) * (int64_t)( ipNext.y - aP.y ) -
-                                (int64_t)( ipNext.x - aP.x ) * (int64_t)( ip.y - aP.y );
-
-                    if( !d )
-                        return true;
-
-                    if( ( d > 0 ) == ( ipNext.y > ip.y ) )
-                        result = 1 - result;
-                }
-            }
-            else
-            {
-                if( ipNext.x > aP.x )
-                {
-                    int64_t d = (int64_t)( ip.x - aP.x ) * (int64_t)( ipNext.y - aP.y ) -
-                                (int64_t)( ipNext.x - aP.x ) * (int64_t)( ip.y - aP.y );
-
-                if( !d )
-                    return true;
-
-                if( ( d > 0 ) == ( ipNext.y > ip.y ) )
-                    result = 1 - result;
-                }
-            }
-        }
+        if( crossing < 0 )
+            return true;
 
+        result ^= crossing;
         ip = ipNext;
     }
 
@@ -1333,6 +1728,8 @@ bool SHAPE_POLY_SET::pointInPolygon( const VECTOR2I& aP, const SHAPE_LINE_CHAIN&
 
 void SHAPE_POLY_SET::Move( const VECTOR2I& aVector )
 {
+    invalidateIndex();
+
     for( POLYGON &poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN &path : poly )
@@ -1379,7 +1776,7 @@ int SHAPE_POLY_SET::DistanceToPolygon( VECTOR2I aPoint, int aPolygonIndex )
     // However, if the segment to test is inside the outline, and does not cross
     // any edge, it can be seen outside the polygon.
     // Therefore test if a segment end is inside ( testing only one end is enough )
-    if( containsSingle( aPoint, aPolygonIndex ) )
+    if( containsSingle( aPoint, aPolygonIndex, index().get() ) )
         return 0;
 
     SEGMENT_ITERATOR iterator = IterateSegmentsWithHoles( aPolygonIndex );
@@ -1407,7 +1804,7 @@ int SHAPE_POLY_SET::DistanceToPolygon( SEG aSegment, int aPolygonIndex, int aSeg
     // However, if the segment to test is inside the outline, and does not cross
     // any edge, it can be seen outside the polygon.
     // Therefore test if a segment end is inside ( testing only one end is enough )
-    if( containsSingle( aSegment.A, aPolygonIndex ) )
+    if( containsSingle( aSegment.A, aPolygonIndex, index().get() ) )
         return 0;
 
     SEGMENT_ITERATOR iterator = IterateSegmentsWithHoles( aPolygonIndex );
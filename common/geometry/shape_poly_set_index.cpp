@@ -0,0 +1,312 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <geometry/shape_poly_set_index.h>
+
+// Average number of edges in a band, and limit of the edges listed in all the bands of a
+// contour, relative to its number of edges: long edges are listed in many bands
+static const int EdgesPerBand = 4;
+static const int MaxBandCount = 4096;
+static const int MaxEntriesPerEdge = 8;
+
+
+SHAPE_POLY_SET_INDEX::SHAPE_POLY_SET_INDEX( const SHAPE_POLY_SET& aSet )
+{
+    m_contours.resize( aSet.OutlineCount() );
+
+    for( int polygon = 0; polygon < aSet.OutlineCount(); polygon++ )
+    {
+        const SHAPE_POLY_SET::POLYGON& paths = aSet.CPolygon( polygon );
+
+        m_contours[polygon].resize( paths.size() );
+
+        for( unsigned contour = 0; contour < paths.size(); contour++ )
+            build( m_contours[polygon][contour], paths[contour] );
+    }
+}
+
+
+bool SHAPE_POLY_SET_INDEX::IsValid( const SHAPE_POLY_SET& aSet ) const
+{
+    if( (int) m_contours.size() != aSet.OutlineCount() )
+        return false;
+
+    for( int polygon = 0; polygon < aSet.OutlineCount(); polygon++ )
+    {
+        const SHAPE_POLY_SET::POLYGON& paths = aSet.CPolygon( polygon );
+
+        if( m_contours[polygon].size() != paths.size() )
+            return false;
+
+        for( unsigned contour = 0; contour < paths.size(); contour++ )
+        {
+            if( m_contours[polygon][contour].m_version != paths[contour].Version() )
+                return false;
+        }
+    }
+
+    return true;
+}
+
+
+void SHAPE_POLY_SET_INDEX::build( CONTOUR& aContour, const SHAPE_LINE_CHAIN& aPath )
+{
+    int cnt = aPath.PointCount();
+
+    aContour.m_version = aPath.Version();
+
+    aContour.m_bbox = aPath.BBox();
+    aContour.m_yMin = cnt ? aPath.CPoint( 0 ).y : 0;
+    aContour.m_yMax = aContour.m_yMin;
+
+    for( int i = 1; i < cnt; i++ )
+    {
+        aContour.m_yMin = std::min<int64_t>( aContour.m_yMin, aPath.CPoint( i ).y );
+        aContour.m_yMax = std::max<int64_t>( aContour.m_yMax, aPath.CPoint( i ).y );
+    }
+
+    auto edgeBands = [&]( int aEdge, int& aFirst, int& aLast )
+    {
+        int a = aPath.CPoint( aEdge ).y;
+        int b = aPath.CPoint( aEdge + 1 == cnt ? 0 : aEdge + 1 ).y;
+
+        aFirst = aContour.band( std::min( a, b ) );
+        aLast = aContour.band( std::max( a, b ) );
+    };
+
+    int bands = std::max( 1, std::min( cnt / EdgesPerBand, MaxBandCount ) );
+
+    // Fewer bands if the edges are so long that they would be listed too many times
+    while( true )
+    {
+        aContour.m_bandStart.assign( bands + 1, 0 );
+
+        int64_t entries = 0;
+
+        for( int i = 0; i < cnt; i++ )
+        {
+            int first, last;
+
+            edgeBands( i, first, last );
+            entries += last - first + 1;
+        }
+
+        if( bands == 1 || entries <= (int64_t) MaxEntriesPerEdge * cnt )
+            break;
+
+        bands /= 2;
+    }
+
+    // Count the edges of each band, then list them in the order of the contour
+    for( int i = 0; i < cnt; i++ )
+    {
+        int first, last;
+
+        edgeBands( i, first, last );
+
+        for( int b = first; b <= last; b++ )
+            aContour.m_bandStart[b + 1]++;
+    }
+
+    for( int b = 0; b < bands; b++ )
+        aContour.m_bandStart[b + 1] += aContour.m_bandStart[b];
+
+    std::vector<int> next( aContour.m_bandStart.begin(), aContour.m_bandStart.end() - 1 );
+
+    aContour.m_edges.resize( aContour.m_bandStart[bands] );
+
+    for( int i = 0; i < cnt; i++ )
+    {
+        int first, last;
+
+        edgeBands( i, first, last );
+
+        for( int b = first; b <= last; b++ )
+            aContour.m_edges[next[b]++] = i;
+    }
+}
+
+
+template <class FUNC>
+bool SHAPE_POLY_SET_INDEX::CONTOUR::forEachEdge( int64_t aYMin, int64_t aYMax,
+                                                  FUNC aFunc ) const
+{
+    if( m_edges.empty() || aYMax < m_yMin || aYMin > m_yMax )
+        return false;
+
+    int last = band( aYMax );
+
+    for( int b = band( aYMin ); b <= last; b++ )
+    {
+        for( int i = m_bandStart[b]; i < m_bandStart[b + 1]; i++ )
+        {
+            if( aFunc( m_edges[i] ) )
+                return true;
+        }
+    }
+
+    return false;
+}
+
+
+int SHAPE_POLY_SET_INDEX::EdgeCrossing( const VECTOR2I& aP, const VECTOR2I& aA,
+                                        const VECTOR2I& aB )
+{
+    if( aB.y == aP.y )
+    {
+        if( ( aB.x == aP.x ) || ( aA.y == aP.y &&
+            ( ( aB.x > aP.x ) == ( aA.x < aP.x ) ) ) )
+            return -1;
+    }
+
+    if( ( aA.y < aP.y ) != ( aB.y < aP.y ) )
+    {
+        if( aA.x >= aP.x )
+        {
+            if( aB.x > aP.x )
+                return 1;
+
+            int64_t d = (int64_t)( aA.x - aP.x ) * (int64_t)( aB.y - aP.y ) -
+                        (int64_t)( aB.x - aP.x ) * (int64_t)( aA.y - aP.y );
+
+            if( !d )
+                return -1;
+
+            if( ( d > 0 ) == ( aB.y > aA.y ) )
+                return 1;
+        }
+        else if( aB.x > aP.x )
+        {
+            int64_t d = (int64_t)( aA.x - aP.x ) * (int64_t)( aB.y - aP.y ) -
+                        (int64_t)( aB.x - aP.x ) * (int64_t)( aA.y - aP.y );
+
+            if( !d )
+                return -1;
+
+            if( ( d > 0 ) == ( aB.y > aA.y ) )
+                return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+bool SHAPE_POLY_SET_INDEX::PointInContour( const VECTOR2I& aP, int aPolygon, int aContour,
+                                           const SHAPE_LINE_CHAIN& aPath ) const
+{
+    const CONTOUR& contour = m_contours[aPolygon][aContour];
+    int cnt = aPath.PointCount();
+
+    if( !contour.m_bbox.Contains( aP ) )
+        return false;
+
+    if( cnt < 3 )
+        return false;
+
+    // Only the edges whose y range contains aP.y can cross the half line or hold aP, and
+    // all of them are in the band of aP.y, once
+    int result = 0;
+
+    bool onEdge = contour.forEachEdge( aP.y, aP.y, [&]( int aEdge ) -> bool
+    {
+        int crossing = EdgeCrossing( aP, aPath.CPoint( aEdge ),
+                                     aPath.CPoint( aEdge + 1 == cnt ? 0 : aEdge + 1 ) );
+
+        if( crossing < 0 )
+            return true;
+
+        result ^= crossing;
+        return false;
+    } );
+
+    return onEdge || result;
+}
+
+
+bool SHAPE_POLY_SET_INDEX::PointOnContourEdge( const VECTOR2I& aP, int aPolygon, int aContour,
+                                               const SHAPE_LINE_CHAIN& aPath ) const
+{
+    if( aPath.PointCount() < 2 )
+        return aPath.PointOnEdge( aP );
+
+    const CONTOUR& contour = m_contours[aPolygon][aContour];
+    int segCount = aPath.SegmentCount();
+
+    // A segment at a distance of 1 or less (rounded down) is less than 2 away along y
+    return contour.forEachEdge( (int64_t) aP.y - 2, (int64_t) aP.y + 2, [&]( int aEdge ) -> bool
+    {
+        if( aEdge >= segCount )
+            return false;
+
+        const SEG s = aPath.CSegment( aEdge );
+
+        return s.A == aP || s.B == aP || s.Distance( aP ) <= 1;
+    } );
+}
+
+
+void SHAPE_POLY_SET_INDEX::QueryEdges( const VECTOR2I& aP, int aDistance,
+                                       std::vector<SHAPE_POLY_SET::VERTEX_INDEX>& aEdges ) const
+{
+    if( aDistance < 0 )
+        return;
+
+    std::vector<int> edges;
+
+    for( unsigned polygon = 0; polygon < m_contours.size(); polygon++ )
+    {
+        for( unsigned contourIdx = 0; contourIdx < m_contours[polygon].size(); contourIdx++ )
+        {
+            const CONTOUR& contour = m_contours[polygon][contourIdx];
+            const BOX2I& bbox = contour.m_bbox;
+
+            if( (int64_t) aP.x + aDistance < bbox.GetLeft()
+                    || (int64_t) aP.x - aDistance > bbox.GetRight() )
+                continue;
+
+            edges.clear();
+
+            contour.forEachEdge( (int64_t) aP.y - aDistance, (int64_t) aP.y + aDistance,
+                                 [&]( int aEdge ) -> bool
+            {
+                edges.push_back( aEdge );
+                return false;
+            } );
+
+            // The edges crossing several bands are found once in each of them
+            std::sort( edges.begin(), edges.end() );
+            edges.erase( std::unique( edges.begin(), edges.end() ), edges.end() );
+
+            for( int edge : edges )
+            {
+                SHAPE_POLY_SET::VERTEX_INDEX index;
+
+                index.m_polygon = polygon;
+                index.m_contour = contourIdx;
+                index.m_vertex = edge;
+                aEdges.push_back( index );
+            }
+        }
+    }
+}
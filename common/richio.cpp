@@ -24,10 +24,16 @@
 
 
 #include <cstdarg>
-#include <config.h> // HAVE_FGETC_NOLOCK
+#include <algorithm>
+#include <config.h> // HAVE_FGETC_NOLOCK, HAVE_MMAP
 
 #include <richio.h>
 
+#if defined( HAVE_MMAP )
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 
 // Fall back to getc() when getc_unlocked() is not available on the target platform.
 #if !defined( HAVE_FGETC_NOLOCK )
@@ -226,6 +232,161 @@ char* FILE_LINE_READER::ReadLine()
 }
 
 
+MEMORY_LINE_READER::MEMORY_LINE_READER( const char* aText, size_t aSize,
+            const wxString& aSource, unsigned aStartingLineNumber,
+            unsigned aMaxLineLength ):
+    LINE_READER( aMaxLineLength ),
+    m_text( aText ),
+    m_size( aSize ),
+    m_ndx( 0 )
+{
+    source  = aSource;
+    lineNum = aStartingLineNumber;
+}
+
+
+unsigned MEMORY_LINE_READER::nextLine()
+{
+    size_t len = 0;
+
+    if( m_ndx < m_size )
+    {
+        const char* cur = m_text + m_ndx;
+        const char* eol = (const char*) memchr( cur, '\n', m_size - m_ndx );
+
+        // include the newline
+        len = eol ? eol - cur + 1 : m_size - m_ndx;
+
+        if( len >= maxLineLength )
+            THROW_IO_ERROR( _( "Maximum line length exceeded" ) );
+    }
+
+    // lineNum is incremented even if there was no line read, because this
+    // leads to better error reporting when we hit an end of file.
+    ++lineNum;
+
+    return (unsigned) len;
+}
+
+
+char* MEMORY_LINE_READER::ReadLine()
+{
+    unsigned len = nextLine();
+
+    // nothing to keep from the previous line
+    length = 0;
+
+    if( len+1 > capacity )   // +1 for terminating nul
+        expandCapacity( len+1 );
+
+    if( len )
+        memcpy( line, m_text + m_ndx, len );
+
+    m_ndx += len;
+    length = len;
+    line[length] = 0;
+
+    return length ? line : NULL;
+}
+
+
+const char* MEMORY_LINE_READER::ReadLineInPlace( unsigned* aLength )
+{
+    unsigned    len = nextLine();
+    const char* ret = len ? m_text + m_ndx : NULL;
+
+    m_ndx += len;
+    length = len;
+
+    // The line buffer does not hold this line
+    if( line )
+        line[0] = 0;
+
+    *aLength = len;
+    return ret;
+}
+
+
+MAPPED_FILE_LINE_READER::MAPPED_FILE_LINE_READER( const wxString& aFileName,
+            unsigned aStartingLineNumber,
+            unsigned aMaxLineLength ):
+    MEMORY_LINE_READER( NULL, 0, aFileName, aStartingLineNumber, aMaxLineLength ),
+    m_map( NULL )
+{
+    FILE* fp = wxFopen( aFileName, wxT( "rb" ) );
+
+    if( !fp )
+    {
+        wxString msg = wxString::Format(
+            _( "Unable to open filename '%s' for reading" ), aFileName.GetData() );
+        THROW_IO_ERROR( msg );
+    }
+
+#if defined( HAVE_MMAP )
+    struct stat st;
+
+    if( fstat( fileno( fp ), &st ) == 0 && st.st_size > 0 )
+    {
+        void* map = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fileno( fp ), 0 );
+
+        if( map != MAP_FAILED )
+        {
+            // The lines are read in order
+            madvise( map, st.st_size, MADV_SEQUENTIAL );
+
+            m_map  = map;
+            m_text = (const char*) map;
+            m_size = st.st_size;
+        }
+    }
+#endif
+
+    if( !m_map )
+    {
+        // Read the whole file instead
+        long size = -1;
+
+        if( fseek( fp, 0, SEEK_END ) == 0 )
+            size = ftell( fp );
+
+        if( size < 0 || fseek( fp, 0, SEEK_SET ) != 0 )
+        {
+            fclose( fp );
+
+            wxString msg = wxString::Format(
+                _( "Unable to read file '%s'" ), aFileName.GetData() );
+            THROW_IO_ERROR( msg );
+        }
+
+        m_buffer.resize( size );
+
+        if( size && fread( &m_buffer[0], 1, size, fp ) != (size_t) size )
+        {
+            fclose( fp );
+
+            wxString msg = wxString::Format(
+                _( "Unable to read file '%s'" ), aFileName.GetData() );
+            THROW_IO_ERROR( msg );
+        }
+
+        m_text = size ? &m_buffer[0] : NULL;
+        m_size = size;
+    }
+
+    // The mapping does not need the file to stay open
+    fclose( fp );
+}
+
+
+MAPPED_FILE_LINE_READER::~MAPPED_FILE_LINE_READER()
+{
+#if defined( HAVE_MMAP )
+    if( m_map )
+        munmap( m_map, m_size );
+#endif
+}
+
+
 STRING_LINE_READER::STRING_LINE_READER( const std::string& aString, const wxString& aSource ):
     LINE_READER( LINE_READER_LINE_DEFAULT_MAX ),
     lines( aString ),
@@ -405,10 +566,15 @@ int OUTPUTFORMATTER::sprint( const char* fmt, ... )
 }
 
 
-int OUTPUTFORMATTER::Print( int nestLevel, const char* fmt, ... )
-{
 #define NESTWIDTH           2   ///< how many spaces per nestLevel
 
+/// The indentation of up to 32 nest levels
+static const char indentation[] = "                                "
+                                  "                                ";
+
+
+int OUTPUTFORMATTER::Print( int nestLevel, const char* fmt, ... )
+{
     va_list     args;
 
     va_start( args, fmt );
@@ -416,16 +582,29 @@ int OUTPUTFORMATTER::Print( int nestLevel, const char* fmt, ... )
     int result = 0;
     int total  = 0;
 
-    for( int i=0; i<nestLevel;  ++i )
+    for( int i=0; i<nestLevel;  i += ( sizeof( indentation ) - 1 ) / NESTWIDTH )
     {
+        result = std::min<int>( ( nestLevel - i ) * NESTWIDTH, sizeof( indentation ) - 1 );
+
         // no error checking needed, an exception indicates an error.
-        result = sprint( "%*c", NESTWIDTH, ' ' );
+        write( indentation, result );
 
         total += result;
     }
 
-    // no error checking needed, an exception indicates an error.
-    result = vprint( fmt, args );
+    // A constant text, such as ")\n", needs no formatting
+    if( !strchr( fmt, '%' ) )
+    {
+        result = strlen( fmt );
+
+        if( result > 0 )
+            write( fmt, result );
+    }
+    else
+    {
+        // no error checking needed, an exception indicates an error.
+        result = vprint( fmt, args );
+    }
 
     va_end( args );
 
@@ -434,14 +613,32 @@ int OUTPUTFORMATTER::Print( int nestLevel, const char* fmt, ... )
 }
 
 
-std::string OUTPUTFORMATTER::Quotes( const std::string& aWrapee )
+/**
+ * Function needsQuotes
+ * @return true if @a aWrapee must be quoted for the DSNLEXER to read it back.
+ */
+static bool needsQuotes( const char* aWrapee, size_t aCount )
 {
     static const char quoteThese[] = "\t ()\n\r";
 
-    if( !aWrapee.size() ||  // quote null string as ""
-        aWrapee[0]=='#' ||  // quote a potential s-expression comment, so it is not a comment
-        aWrapee[0]=='"' ||  // NextTok() will travel through DSN_STRING path anyway, then must apply escapes
-        aWrapee.find_first_of( quoteThese ) != std::string::npos )
+    if( !aCount ||              // quote null string as ""
+        aWrapee[0]=='#' ||      // quote a potential s-expression comment, so it is not a comment
+        aWrapee[0]=='"' )       // NextTok() will travel through DSN_STRING path anyway, then must apply escapes
+        return true;
+
+    for( size_t i = 0; i < aCount; ++i )
+    {
+        if( aWrapee[i] && strchr( quoteThese, aWrapee[i] ) )
+            return true;
+    }
+
+    return false;
+}
+
+
+std::string OUTPUTFORMATTER::Quotes( const std::string& aWrapee )
+{
+    if( needsQuotes( aWrapee.c_str(), aWrapee.size() ) )
     {
         std::string ret;
 
@@ -532,6 +729,9 @@ FILE_OUTPUTFORMATTER::FILE_OUTPUTFORMATTER( const wxString& aFileName,
                             m_filename.GetData() );
         THROW_IO_ERROR( msg );
     }
+
+    // Fewer, larger writes for the large files
+    setvbuf( m_fp, NULL, _IOFBF, FILEOUTPUTBUFZ );
 }
 
 
@@ -573,3 +773,180 @@ void STREAM_OUTPUTFORMATTER::write( const char* aOutBuf, int aCount )
     }
 }
 
+
+//-----<FORMAT_BUFFER>-----------------------------------------------
+
+FORMAT_BUFFER& FORMAT_BUFFER::Indent( int aNestLevel )
+{
+    int count = aNestLevel * NESTWIDTH;
+
+    while( count > 0 )
+    {
+        int len = std::min<int>( count, sizeof( indentation ) - 1 );
+
+        Text( indentation, len );
+        count -= len;
+    }
+
+    return *this;
+}
+
+
+FORMAT_BUFFER& FORMAT_BUFFER::Text( const char* aText, size_t aCount )
+{
+    reserve( aCount );
+
+    if( aCount > BUFZ )
+        m_out->write( aText, aCount );
+    else
+    {
+        memcpy( m_buf + m_len, aText, aCount );
+        m_len += aCount;
+    }
+
+    return *this;
+}
+
+
+FORMAT_BUFFER& FORMAT_BUFFER::Int( long long aValue, int aWidth )
+{
+    char                digits[24];
+    int                 count = 0;
+    unsigned long long  value = aValue < 0 ? 0ULL - (unsigned long long) aValue : aValue;
+
+    reserve( sizeof( digits ) + 1 );
+
+    size_t first = m_len;
+
+    do
+    {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while( value );
+
+    if( aValue < 0 )
+        m_buf[m_len++] = '-';
+
+    while( count )
+        m_buf[m_len++] = digits[--count];
+
+    // left justified
+    for( int pad = aWidth - int( m_len - first ); pad > 0; --pad )
+        Char( ' ' );
+
+    return *this;
+}
+
+
+FORMAT_BUFFER& FORMAT_BUFFER::Hex( unsigned long long aValue )
+{
+    static const char   hexDigits[] = "0123456789ABCDEF";
+    char                digits[24];
+    int                 count = 0;
+
+    reserve( sizeof( digits ) );
+
+    do
+    {
+        digits[count++] = hexDigits[aValue & 0xF];
+        aValue >>= 4;
+    } while( aValue );
+
+    while( count )
+        m_buf[m_len++] = digits[--count];
+
+    return *this;
+}
+
+
+FORMAT_BUFFER& FORMAT_BUFFER::Quotew( const wxString& aWrapee )
+{
+    // as Quotew(), up to the first nul
+    wxScopedCharBuffer  utf8 = aWrapee.utf8_str();
+    const char*         text = utf8.data();
+    size_t              count = strlen( text );
+
+    if( !needsQuotes( text, count ) )
+        return Text( text, count );
+
+    Char( '"' );
+
+    for( size_t i = 0; i < count; ++i )
+    {
+        switch( text[i] )
+        {
+        case '\n':     Char( '\\' ).Char( 'n' );      break;
+        case '\r':     Char( '\\' ).Char( 'r' );      break;
+        case '\\':    Char( '\\' ).Char( '\\' );     break;
+        case '"':      Char( '\\' ).Char( '"' );      break;
+        default:       Char( text[i] );               break;
+        }
+    }
+
+    return Char( '"' );
+}
+
+
+void FORMAT_BUFFER::Flush()
+{
+    if( m_len )
+    {
+        // Emptied first: a failed write is not retried
+        size_t len = m_len;
+
+        m_len = 0;
+        m_out->write( m_buf, len );
+    }
+}
+
+
+int FORMAT_BUFFER::FormatFixed( char* aDest, long long aValue, int aDecimals )
+{
+    char*   cur = aDest;
+
+    if( aValue == 0 )
+    {
+        *cur = '0';
+        return 1;
+    }
+
+    // The digits, the least significant first
+    char                digits[24];
+    int                 count = 0;
+    unsigned long long  value = aValue < 0 ? 0ULL - (unsigned long long) aValue : aValue;
+
+    do
+    {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while( value );
+
+    // The trailing zeros of the fraction are dropped
+    int last = 0;
+
+    while( last < aDecimals && last < count && digits[last] == '0' )
+        ++last;
+
+    if( aValue < 0 )
+        *cur++ = '-';
+
+    if( count > aDecimals )
+    {
+        for( int i = count - 1; i >= aDecimals; --i )
+            *cur++ = digits[i];
+    }
+    else
+    {
+        *cur++ = '0';
+    }
+
+    if( last < aDecimals )
+    {
+        *cur++ = '.';
+
+        for( int i = aDecimals - 1; i >= last; --i )
+            *cur++ = i < count ? digits[i] : '0';
+    }
+
+    return cur - aDest;
+}
@@ -507,3 +507,57 @@ bool ReplaceIllegalFileNameChars( std::string* aName, int aReplaceChar )
 
     return changed;
 }
+
+
+double ParseDecimal( const char* aText, const char** aEnd )
+{
+    // The powers of ten exactly represented by a double
+    static const double powersOf10[] =
+    {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    // A mantissa up to 2^53 is exactly represented by a double
+    const uint64_t maxMantissa = (uint64_t) 1 << 53;
+
+    const char* cp = aText;
+    bool        negative = false;
+    uint64_t    mantissa = 0;
+    int         digits = 0;
+    int         decimals = 0;
+
+    if( *cp == '-' || *cp == '+' )
+        negative = *cp++ == '-';
+
+    for( ; *cp >= '0' && *cp <= '9' && digits <= 18; ++cp, ++digits )
+        mantissa = mantissa * 10 + ( *cp - '0' );
+
+    if( *cp == '.' )
+    {
+        for( ++cp; *cp >= '0' && *cp <= '9' && digits <= 18; ++cp, ++digits, ++decimals )
+            mantissa = mantissa * 10 + ( *cp - '0' );
+    }
+
+    // Leave to strtod() the numbers it may read differently: no digit, too many digits, an
+    // exponent, or anything else sticking to the digits ("0x1p3", "1e5", "infinity"...)
+    if( digits == 0 || digits > 18 || mantissa > maxMantissa || isalnum( (unsigned char) *cp )
+            || *cp == '.' )
+    {
+        char*  end;
+        double value = strtod( aText, &end );
+
+        if( aEnd )
+            *aEnd = end;
+
+        return value;
+    }
+
+    if( aEnd )
+        *aEnd = cp;
+
+    // Both operands are exact: the quotient is correctly rounded, as strtod() rounds
+    double value = (double) mantissa / powersOf10[decimals];
+
+    return negative ? -value : value;
+}
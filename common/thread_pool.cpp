@@ -0,0 +1,254 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <thread_pool.h>
+
+#include <algorithm>
+#include <exception>
+
+
+THREAD_POOL::THREAD_POOL( unsigned aThreadCount ) :
+    m_nextDeque( 0 ),
+    m_pending( 0 ),
+    m_quit( false )
+{
+    if( aThreadCount == 0 )
+        aThreadCount = std::max( 1u, std::thread::hardware_concurrency() );
+
+    for( unsigned i = 0; i < aThreadCount; ++i )
+        m_deques.push_back( std::unique_ptr<TASK_DEQUE>( new TASK_DEQUE ) );
+
+    // Workers wait on m_sleepLock before looking at m_workers, so the vector is complete
+    // (and never modified again) by the time currentWorker() reads it.
+    std::lock_guard<std::mutex> lock( m_sleepLock );
+
+    for( unsigned i = 0; i < aThreadCount; ++i )
+        m_workers.push_back( std::thread( &THREAD_POOL::workerLoop, this, (int) i ) );
+}
+
+
+THREAD_POOL::~THREAD_POOL()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_sleepLock );
+        m_quit = true;
+    }
+
+    m_wakeUp.notify_all();
+
+    for( auto& worker : m_workers )
+        worker.join();
+}
+
+
+THREAD_POOL& THREAD_POOL::GetInstance()
+{
+    static THREAD_POOL pool;
+
+    return pool;
+}
+
+
+int THREAD_POOL::currentWorker() const
+{
+    std::thread::id self = std::this_thread::get_id();
+
+    for( unsigned i = 0; i < m_workers.size(); ++i )
+    {
+        if( m_workers[i].get_id() == self )
+            return i;
+    }
+
+    return -1;
+}
+
+
+void THREAD_POOL::push( TASK&& aTask )
+{
+    int own = currentWorker();
+
+    // Tasks spawned by a worker stay on its own deque (better locality), the others are
+    // spread round robin.
+    unsigned idx = own >= 0 ? own : m_nextDeque.fetch_add( 1 ) % m_deques.size();
+
+    {
+        std::lock_guard<std::mutex> lock( m_deques[idx]->m_lock );
+        m_deques[idx]->m_tasks.push_back( std::move( aTask ) );
+    }
+
+    {
+        std::lock_guard<std::mutex> lock( m_sleepLock );
+        m_pending.fetch_add( 1 );
+    }
+
+    m_wakeUp.notify_one();
+}
+
+
+bool THREAD_POOL::popTask( int aOwn, TASK& aTask )
+{
+    if( aOwn >= 0 )
+    {
+        TASK_DEQUE& own = *m_deques[aOwn];
+        std::lock_guard<std::mutex> lock( own.m_lock );
+
+        if( !own.m_tasks.empty() )
+        {
+            aTask = std::move( own.m_tasks.back() );
+            own.m_tasks.pop_back();
+            m_pending.fetch_sub( 1 );
+            return true;
+        }
+    }
+
+    unsigned count = m_deques.size();
+    unsigned start = aOwn >= 0 ? aOwn + 1 : 0;
+
+    for( unsigned i = 0; i < count; ++i )
+    {
+        TASK_DEQUE& victim = *m_deques[( start + i ) % count];
+        std::lock_guard<std::mutex> lock( victim.m_lock );
+
+        if( !victim.m_tasks.empty() )
+        {
+            aTask = std::move( victim.m_tasks.front() );
+            victim.m_tasks.pop_front();
+            m_pending.fetch_sub( 1 );
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+bool THREAD_POOL::RunPendingTask()
+{
+    TASK task;
+
+    if( !popTask( currentWorker(), task ) )
+        return false;
+
+    task();
+    return true;
+}
+
+
+void THREAD_POOL::workerLoop( int aIndex )
+{
+    // Wait for the constructor to finish populating m_workers
+    {
+        std::lock_guard<std::mutex> lock( m_sleepLock );
+    }
+
+    TASK task;
+
+    while( true )
+    {
+        if( popTask( aIndex, task ) )
+        {
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock( m_sleepLock );
+
+        m_wakeUp.wait( lock, [this]() { return m_quit || m_pending.load() > 0; } );
+
+        if( m_quit )
+            return;
+    }
+}
+
+
+void THREAD_POOL::ParallelFor( size_t aCount, const std::function<void( size_t )>& aFunc,
+                               size_t aGrain )
+{
+    aGrain = std::max<size_t>( aGrain, 1 );
+
+    size_t chunks = ( aCount + aGrain - 1 ) / aGrain;
+
+    if( chunks <= 1 || m_workers.size() <= 1 )
+    {
+        for( size_t i = 0; i < aCount; ++i )
+            aFunc( i );
+
+        return;
+    }
+
+    std::atomic<size_t> nextChunk( 0 );
+
+    auto runChunks = [&]()
+    {
+        size_t chunk;
+
+        while( ( chunk = nextChunk.fetch_add( 1 ) ) < chunks )
+        {
+            size_t last = std::min( aCount, ( chunk + 1 ) * aGrain );
+
+            for( size_t i = chunk * aGrain; i < last; ++i )
+                aFunc( i );
+        }
+    };
+
+    size_t helpers = std::min<size_t>( m_workers.size(), chunks - 1 );
+    std::vector<std::future<void>> results;
+
+    for( size_t i = 0; i < helpers; ++i )
+        results.push_back( Submit( runChunks ) );
+
+    std::exception_ptr error;
+
+    try
+    {
+        runChunks();
+    }
+    catch( ... )
+    {
+        error = std::current_exception();
+
+        // Make the helpers stop as soon as possible
+        nextChunk.store( chunks );
+    }
+
+    // The helpers reference our locals: all of them must have returned before we leave,
+    // even when an exception is pending.
+    for( auto& result : results )
+    {
+        Wait( result );
+
+        try
+        {
+            result.get();
+        }
+        catch( ... )
+        {
+            if( !error )
+                error = std::current_exception();
+        }
+    }
+
+    if( error )
+        std::rethrow_exception( error );
+}
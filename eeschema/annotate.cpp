@@ -158,6 +158,10 @@ void SCH_EDIT_FRAME::AnnotateComponents( bool              aAnnotateSchematic,
     references.Annotate( useSheetNum, idStep, lockedComponents );
     references.UpdateAnnotation();
 
+    // The units and the time stamps of the components of all the sheets may have changed
+    for( SCH_SCREEN* screen = screens.GetFirst(); screen; screen = screens.GetNext() )
+        screen->NewRevision();
+
     wxArrayString errors;
 
     // Final control (just in case ... ).
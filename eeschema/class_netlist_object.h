@@ -36,7 +36,10 @@
 #include <lib_pin.h>
 #include <sch_item_struct.h>
 
+#include <memory>
+
 class NETLIST_OBJECT_LIST;
+class NETLIST_SHEET_CACHE;
 class SCH_COMPONENT;
 
 
@@ -308,9 +311,11 @@ public:
      * Build the list of connected objects (pins, labels ...) and
      * all info to generate netlists or run ERC diags
      * @param aSheets = the flattened sheet list
+     * @param aCache = the items of the sheets found by the previous calls, to collect and
+     *                 connect again only those of the sheets which changed since then
      * @return true if OK, false is not item found
      */
-    bool BuildNetListInfo( SCH_SHEET_LIST& aSheets );
+    bool BuildNetListInfo( SCH_SHEET_LIST& aSheets, NETLIST_SHEET_CACHE* aCache = NULL );
 
     /**
      * Acces to an item in list
@@ -367,16 +372,40 @@ public:
 
     /*
      * Sorts the list of connected items by net code
+     * The items of a net stay in the order they have in the list.
      */
     void SortListbyNetcode();
 
+    /**
+     * Function NumberNets
+     * renumbers the net codes from 1, in the order of the first item of each net in the
+     * list. Once connected, the list of BuildNetListInfo() holds the sheet paths in the
+     * order of SortListbySheet(), and the items of each sheet path in the order of the draw
+     * list of its screen, so the net numbers depend on the schematic only: not on the codes
+     * the connections gave, nor on the sheets kept from the previous netlist. The items
+     * without net keep the code 0.
+     */
+    void NumberNets();
+
     /*
      * Sorts the list of connected items by sheet.
      * This sorting is used when searching "physical" connection between items
-     * because obviously only items inside the same sheet can be connected
+     * because obviously only items inside the same sheet can be connected.
+     * The items of a sheet stay in the order they were added to the list.
      */
     void SortListbySheet();
 
+    /**
+     * Function ConnectItems
+     * gives the same net code to the connected items of the list, and the same bus net code
+     * to the connected bus items: by their ends and junctions in a sheet, by their labels,
+     * and between the sheet labels and the hierarchical labels of the sheets they include.
+     * The codes are not consecutive.
+     * The list is expected sorted by sheet (see SortListbySheet()). BuildNetListInfo() gives
+     * the same codes, connecting the items of each sheet apart from the others.
+     */
+    void ConnectItems();
+
     /**
      * Counts number of pins connected on the same net.
      * Used to count all pins connected to a no connect symbol
@@ -416,20 +445,6 @@ public:
     #endif
 
 private:
-    /*
-     * Propagate aNewNetCode to items having an internal netcode aOldNetCode
-     * used to interconnect group of items already physically connected,
-     * when a new connection is found between aOldNetCode and aNewNetCode
-     */
-    void propagateNetCode( int aOldNetCode, int aNewNetCode, bool aIsBus );
-
-    /*
-     * This function merges the net codes of groups of objects already connected
-     * to labels (wires, bus, pins ... ) when 2 labels are equivalents
-     * (i.e. group objects connected by labels)
-     */
-    void labelConnect( NETLIST_OBJECT* aLabelRef );
-
     /* Comparison function to sort by increasing Netcode the list of connected items
      */
     static bool sortItemsbyNetcode( const NETLIST_OBJECT* Objet1, const NETLIST_OBJECT* Objet2 )
@@ -445,30 +460,29 @@ private:
     }
 
     /**
-     * Propagate net codes from a parent sheet to an include sheet,
-     * from a pin sheet connection
+     * Function connectSheetItems
+     * gives the same net code to the items from aStart to aEnd (excluded), which are those
+     * of a sheet path, connected by their ends and junctions, and the same bus net code to
+     * the connected bus items. The bus label members of the same bus having the same member
+     * number are connected too. The codes are numbered from m_lastNetCode + 1 and
+     * m_lastBusNetCode + 1, which are the last codes given when it returns.
      */
-    void sheetLabelConnect( NETLIST_OBJECT* aSheetLabel );
-
-    void pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus, int start );
+    void connectSheetItems( unsigned aStart, unsigned aEnd );
 
     /**
-     * Search connections between a junction and segments
-     * Propagate the junction net code to objects connected by this junction.
-     * The junction must have a valid net code
-     * The list of objects is expected sorted by sheets.
-     * Search is done from index aIdxStart to the last element of list
+     * Function appendSheetItems
+     * appends copies of the items of a sheet path connected by connectSheetItems() in
+     * aItems, with their codes following those of this list.
      */
-    void segmentToPointConnect( NETLIST_OBJECT* aJonction, bool aIsBus, int aIdxStart );
-
+    void appendSheetItems( const NETLIST_OBJECT_LIST& aItems );
 
     /**
-     * Function connectBusLabels
-     * Propagate the net code (and create it, if not yet existing) between
-     * all bus label member objects connected by they name.
-     * Search is done in the entire list
+     * Function connectLabels
+     * gives the same net code to the items connected by their labels, and between the sheet
+     * labels and the hierarchical labels of the sheets they include. The items of each sheet
+     * path are expected connected by connectSheetItems().
      */
-    void connectBusLabels();
+    void connectLabels();
 
     /**
      * Set the m_FlagOfConnection member of items in list
@@ -491,6 +505,45 @@ private:
      * alphabetic order.
      */
     void findBestNetNameForEachNet();
+
+    friend class NETLIST_SHEET_CACHE;
+};
+
+
+/**
+ * Class NETLIST_SHEET_CACHE
+ * keeps the netlist items of each sheet path of a schematic, connected to the other items
+ * of their sheet path, until the screen of the sheet path changes (see
+ * SCH_SCREEN::GetRevision()). Only the connections through the labels, between the sheet
+ * paths, are then searched again for all the items when the netlist is built after an edit.
+ * The items of the components come from their library parts: the cache must be cleared
+ * when the libraries change.
+ */
+class NETLIST_SHEET_CACHE
+{
+public:
+    NETLIST_SHEET_CACHE();
+    ~NETLIST_SHEET_CACHE();
+
+    /**
+     * Function Clear
+     * drops the items of all the sheet paths.
+     */
+    void Clear();
+
+    /**
+     * Function GetItems
+     * appends to aList copies of the netlist items of the sheet paths of aSheets, sorted by
+     * sheet, the items of each sheet path connected to each other. The items of the sheet
+     * paths which are not in the cache or whose screen changed are collected again, and the
+     * sheet paths which are not in aSheets are dropped.
+     */
+    void GetItems( SCH_SHEET_LIST& aSheets, NETLIST_OBJECT_LIST& aList );
+
+private:
+    struct SHEET_ITEMS;
+
+    std::vector<std::unique_ptr<SHEET_ITEMS>> m_sheets;
 };
 
 
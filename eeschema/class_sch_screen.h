@@ -48,6 +48,7 @@ class SCH_SHEET_PATH;
 class SCH_SHEET_PIN;
 class SCH_LINE;
 class SCH_TEXT;
+class SCH_ITEM_INDEX;
 class PLOTTER;
 
 
@@ -85,6 +86,27 @@ private:
     int     m_modification_sync;        ///< inequality with PART_LIBS::GetModificationHash()
                                         ///< will trigger ResolveAll().
 
+    unsigned m_revision;                ///< Changes with the draw items, never the same as
+                                        ///< the revision of another screen.
+
+    static unsigned s_lastRevision;
+
+    SCH_ITEM_INDEX* m_itemIndex;        ///< Spatial index of the draw items, built on the
+                                        ///< first query following a new revision.
+
+    /**
+     * Function itemIndex
+     * @return the index of the draw items, built again if the screen has a new revision.
+     */
+    SCH_ITEM_INDEX& itemIndex() const;
+
+    /**
+     * Function isIndexCurrent
+     * @return true if the index of the draw items is built for the current revision, and
+     *         can be updated along with a change instead of being built again.
+     */
+    bool isIndexCurrent() const;
+
     /**
      * Function addConnectedItemsToBlock
      * add items connected at \a aPosition to the block pick list.
@@ -131,17 +153,27 @@ public:
 
     int GetRefCount() const                                 { return m_refCount; }
 
+    /**
+     * Function GetRevision
+     * @return the revision of the draw items of the screen. It changes each time they are
+     * added, removed or modified (see NewRevision()), so that what is built from them can be
+     * kept until it changes. Two screens never have the same revision.
+     */
+    unsigned GetRevision() const                            { return m_revision; }
+
+    /**
+     * Function NewRevision
+     * gives the screen a new revision, after its draw items were modified.
+     */
+    void NewRevision()                                      { m_revision = ++s_lastRevision; }
+
     /**
      * Function GetDrawItems().
      * @return - A pointer to the first item in the linked list of draw items.
      */
     SCH_ITEM* GetDrawItems() const                          { return m_drawList.begin(); }
 
-    void Append( SCH_ITEM* aItem )
-    {
-        m_drawList.Append( aItem );
-        --m_modification_sync;
-    }
+    void Append( SCH_ITEM* aItem );
 
     /**
      * Function Append
@@ -149,11 +181,7 @@ public:
      *
      * @param aList A reference to a #DLIST containing the #SCH_ITEM to add to the sheet.
      */
-    void Append( DLIST< SCH_ITEM >& aList )
-    {
-        m_drawList.Append( aList );
-        --m_modification_sync;
-    }
+    void Append( DLIST< SCH_ITEM >& aList );
 
     /**
      * Function GetCurItem
@@ -263,6 +291,8 @@ public:
     /**
      * Function TestDanglingEnds
      * tests all of the connectible objects in the schematic for unused connection points.
+     * The spatial index of the draw items is built again, since this is called after the
+     * items are moved or edited in place.
      * @return True if any connection state changes were made.
      */
     bool TestDanglingEnds();
@@ -328,9 +358,15 @@ public:
     bool BreakSegmentsOnJunctions();
 
     /* full undo redo management : */
-    // use BASE_SCREEN::PushCommandToUndoList( PICKED_ITEMS_LIST* aItem )
     // use BASE_SCREEN::PushCommandToRedoList( PICKED_ITEMS_LIST* aItem )
 
+    /**
+     * Function PushCommandToUndoList
+     * adds a command to the undo list, and gives the screen a new revision: the items of
+     * the command are changed in place (moved, rotated, edited...) around this call.
+     */
+    virtual void PushCommandToUndoList( PICKED_ITEMS_LIST* aItem ) override;
+
     /**
      * Function ClearUndoORRedoList
      * free the undo or redo list from List element
@@ -35,11 +35,14 @@
 
 #include <class_netlist_object.h>
 
+#include <set>
+
 
 bool SCH_EDIT_FRAME::HighlightConnectionAtPosition( wxPoint aPosition )
 {
     m_SelectedNetName = "";
     bool buildNetlistOk = false;
+    std::unique_ptr<NETLIST_OBJECT_LIST> objectsConnectedList;
 
     // find which connected item is selected
     EDA_ITEMS nodeList;
@@ -52,7 +55,7 @@ bool SCH_EDIT_FRAME::HighlightConnectionAtPosition( wxPoint aPosition )
         else
         {
             // Build netlist info to get the proper netnames of connected items
-            std::unique_ptr<NETLIST_OBJECT_LIST> objectsConnectedList( BuildNetListBase() );
+            objectsConnectedList.reset( BuildNetListBase() );
             buildNetlistOk = true;
 
             for( auto obj : *objectsConnectedList )
@@ -67,14 +70,14 @@ bool SCH_EDIT_FRAME::HighlightConnectionAtPosition( wxPoint aPosition )
     }
 
     SetStatusText( "selected net: " + m_SelectedNetName );
-    SetCurrentSheetHighlightFlags();
+    SetCurrentSheetHighlightFlags( objectsConnectedList.get() );
     m_canvas->Refresh();
 
     return buildNetlistOk;
 }
 
 
-bool SCH_EDIT_FRAME::SetCurrentSheetHighlightFlags()
+bool SCH_EDIT_FRAME::SetCurrentSheetHighlightFlags( NETLIST_OBJECT_LIST* aNetListItems )
 {
     SCH_SCREEN* screen = m_CurrentSheet->LastScreen();
 
@@ -97,26 +100,37 @@ bool SCH_EDIT_FRAME::SetCurrentSheetHighlightFlags()
         return false;
 
     // Build netlist info to get the proper netnames
-    std::unique_ptr<NETLIST_OBJECT_LIST> objectsConnectedList( BuildNetListBase( false ) );
+    std::unique_ptr<NETLIST_OBJECT_LIST> objectsConnectedList;
+
+    if( !aNetListItems )
+    {
+        objectsConnectedList.reset( BuildNetListBase( false ) );
+        aNetListItems = objectsConnectedList.get();
+    }
 
     // highlight the items belonging to this net
-    for( auto obj1 : *objectsConnectedList )
+    std::set<int> busCodes;
+
+    for( auto obj1 : *aNetListItems )
     {
         if( obj1->m_SheetPath == *m_CurrentSheet &&
             obj1->GetNetName( true ) == m_SelectedNetName && obj1->m_Comp )
         {
             obj1->m_Comp->SetState( BRIGHTENED, true );
 
-            //if a bus is associated with this net highlight it as well
             if( obj1->m_BusNetCode )
-            {
-                for( auto obj2 : *objectsConnectedList )
-                {
-                    if( obj2 && obj2->m_Comp && obj2->m_SheetPath == *m_CurrentSheet &&
-                        obj1->m_BusNetCode == obj2->m_BusNetCode )
-                        obj2->m_Comp->SetState( BRIGHTENED, true );
-                }
-            }
+                busCodes.insert( obj1->m_BusNetCode );
+        }
+    }
+
+    //if a bus is associated with this net highlight it as well
+    if( !busCodes.empty() )
+    {
+        for( auto obj2 : *aNetListItems )
+        {
+            if( obj2 && obj2->m_Comp && obj2->m_SheetPath == *m_CurrentSheet &&
+                busCodes.count( obj2->m_BusNetCode ) )
+                obj2->m_Comp->SetState( BRIGHTENED, true );
         }
     }
 
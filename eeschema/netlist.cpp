@@ -44,7 +44,10 @@
 #include <sch_text.h>
 #include <sch_sheet.h>
 #include <algorithm>
+#include <unordered_map>
 #include <invoke_sch_dialog.h>
+#include <disjoint_set.h>
+#include <hashtables.h>
 
 #define IS_WIRE false
 #define IS_BUS true
@@ -159,13 +162,40 @@ void NETLIST_OBJECT_LIST::Clear()
 
 void NETLIST_OBJECT_LIST::SortListbyNetcode()
 {
-    sort( this->begin(), this->end(), NETLIST_OBJECT_LIST::sortItemsbyNetcode );
+    // Stable, so that the items of each net stay in the order of the list
+    std::stable_sort( this->begin(), this->end(), NETLIST_OBJECT_LIST::sortItemsbyNetcode );
+}
+
+
+void NETLIST_OBJECT_LIST::NumberNets()
+{
+    int lastCode = 0;
+
+    for( unsigned ii = 0; ii < size(); ii++ )
+        lastCode = std::max( lastCode, GetItem( ii )->GetNet() );
+
+    // The number of each code, 0 until its first item is found
+    std::vector<int> numbers( lastCode + 1, 0 );
+
+    m_lastNetCode = 0;
+
+    for( unsigned ii = 0; ii < size(); ii++ )
+    {
+        int code = GetItem( ii )->GetNet();
+
+        if( code && !numbers[code] )
+            numbers[code] = ++m_lastNetCode;
+
+        GetItem( ii )->SetNet( numbers[code] );
+    }
 }
 
 
 void NETLIST_OBJECT_LIST::SortListbySheet()
 {
-    sort( this->begin(), this->end(), NETLIST_OBJECT_LIST::sortItemsBySheet );
+    // Stable, so that the items of each sheet path follow each other even if the time
+    // stamps of two sheets are the same
+    std::stable_sort( this->begin(), this->end(), NETLIST_OBJECT_LIST::sortItemsBySheet );
 }
 
 
@@ -177,8 +207,18 @@ NETLIST_OBJECT_LIST* SCH_EDIT_FRAME::BuildNetListBase( bool updateStatusText )
     // Creates the flattened sheet list:
     SCH_SHEET_LIST aSheets( g_RootSheet );
 
+    // The items of the sheets kept from the previous netlist point to the pins of the
+    // library parts, which are not the same once the libraries changed
+    int libHash = Prj().SchLibs()->GetModifyHash();
+
+    if( libHash != m_netlistLibHash )
+    {
+        m_netlistCache->Clear();
+        m_netlistLibHash = libHash;
+    }
+
     // Build netlist info
-    bool success = ret->BuildNetListInfo( aSheets );
+    bool success = ret->BuildNetListInfo( aSheets, m_netlistCache );
 
     if( !success )
     {
@@ -196,39 +236,464 @@ NETLIST_OBJECT_LIST* SCH_EDIT_FRAME::BuildNetListBase( bool updateStatusText )
 }
 
 
-bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
+bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets,
+                                            NETLIST_SHEET_CACHE* aCache )
+{
+    NETLIST_SHEET_CACHE cache;
+
+    // Fill list with connected items from the flattened sheet list, sorted by sheet, the
+    // items of each sheet being already connected to each other
+    ( aCache ? aCache : &cache )->GetItems( aSheets, *this );
+
+    if( size() == 0 )
+        return false;
+
+    // Give the same net code to the objects connected by their labels
+    connectLabels();
+
+#if defined(NETLIST_DEBUG) && defined(DEBUG)
+    std::cout << "\n\nafter connections\n\n";
+    DumpNetTable();
+#endif
+
+    // Number the nets in the order of the list, which does not depend on the sheets kept
+    // by aCache, then sort objects by NetCode
+    NumberNets();
+    SortListbyNetcode();
+
+#if defined(NETLIST_DEBUG) && defined(DEBUG)
+    std::cout << "\n\nafter qsort()\n";
+    DumpNetTable();
+#endif
+
+    // Set the minimal connection info:
+    setUnconnectedFlag();
+
+    // find the best label object to give the best net name to each net
+    findBestNetNameForEachNet();
+
+    return true;
+}
+
+
+/**
+ * Class NET_CODE_SETS
+ * holds the net codes (or the bus net codes) of the items of a NETLIST_OBJECT_LIST while
+ * they are connected. The items having the same code are in the same set of a
+ * DISJOINT_SET, whose root holds the code: giving a code to all the items having another
+ * one is a union of two sets, not a scan of the list.
+ */
+class NET_CODE_SETS
 {
-    SCH_SHEET_PATH* sheet;
+public:
+    /**
+     * Constructor
+     * @param aItemCount = the number of items
+     * @param aFirstCode = the lowest code the items can be given
+     */
+    NET_CODE_SETS( int aItemCount, int aFirstCode = 1 ) :
+        m_itemSet( aItemCount, -1 ),
+        m_firstCode( aFirstCode )
+    {
+    }
 
-    // Fill list with connected items from the flattened sheet list
-    for( unsigned i = 0; i < aSheets.size();  i++ )
+    /**
+     * Function Get
+     * @return the code of the item aItem, 0 if it has none yet.
+     */
+    int Get( int aItem )
     {
-        sheet = &aSheets[i];
+        int set = m_itemSet[aItem];
+
+        return set < 0 ? 0 : m_setCode[ m_sets.Find( set ) ];
+    }
 
-        for( SCH_ITEM* item = sheet->LastScreen()->GetDrawItems(); item; item = item->Next() )
+    /**
+     * Function Set
+     * gives aCode to the item aItem. If it had another code, it leaves the items having it.
+     */
+    void Set( int aItem, int aCode )
+    {
+        int set = codeSet( aCode );
+
+        if( set < 0 )
         {
-            item->GetNetListItem( *this, sheet );
+            set = m_sets.Add();
+            m_setCode.push_back( aCode );
+            setCodeSet( aCode, set );
         }
+
+        m_itemSet[aItem] = set;
     }
 
-    if( size() == 0 )
-        return false;
+    /**
+     * Function Propagate
+     * gives aNewCode to all the items having aOldCode.
+     */
+    void Propagate( int aOldCode, int aNewCode )
+    {
+        if( aOldCode == aNewCode )
+            return;
+
+        int set = codeSet( aOldCode );
 
-    // Sort objects by Sheet
-    SortListbySheet();
+        if( set < 0 )
+            return;
 
-    sheet = &(GetItem( 0 )->m_SheetPath);
-    m_lastNetCode = m_lastBusNetCode = 1;
+        int newSet = codeSet( aNewCode );
 
-    for( unsigned ii = 0, istart = 0; ii < size(); ii++ )
+        if( newSet >= 0 )
+            m_sets.Union( set, newSet );
+
+        set = m_sets.Find( set );
+        m_setCode[set] = aNewCode;
+        setCodeSet( aOldCode, -1 );
+        setCodeSet( aNewCode, set );
+    }
+
+    /**
+     * Function Connect
+     * gives aCode to the item aItem and to all the items having its code, if it has one.
+     */
+    void Connect( int aItem, int aCode )
+    {
+        int code = Get( aItem );
+
+        if( code )
+            Propagate( code, aCode );
+        else
+            Set( aItem, aCode );
+    }
+
+private:
+    int codeSet( int aCode ) const
     {
-        NETLIST_OBJECT* net_item = GetItem( ii );
+        unsigned index = aCode - m_firstCode;
+
+        return index < m_codeSet.size() ? m_codeSet[index] : -1;
+    }
 
-        if( net_item->m_SheetPath != *sheet )   // Sheet change
+    void setCodeSet( int aCode, int aSet )
+    {
+        unsigned index = aCode - m_firstCode;
+
+        if( index >= m_codeSet.size() )
+            m_codeSet.resize( index + 1, -1 );
+
+        m_codeSet[index] = aSet;
+    }
+
+    DISJOINT_SET        m_sets;
+    std::vector<int>    m_itemSet;  ///< The set of each item, -1 if it has no code
+    std::vector<int>    m_setCode;  ///< The code of each root of m_sets
+    std::vector<int>    m_codeSet;  ///< The root of the set of each code from m_firstCode,
+                                    ///< -1 if unused
+    int                 m_firstCode;
+};
+
+
+/// Hash of the sheets of a sheet path, equal sheet paths having the same sheets
+struct SHEET_PATH_HASH
+{
+    std::size_t operator()( const SCH_SHEET_PATH& aPath ) const
+    {
+        std::size_t hash = aPath.size();
+
+        for( SCH_SHEET* sheet : aPath )
+            hash = hash * 31 + std::hash<SCH_SHEET*>()( sheet );
+
+        return hash;
+    }
+};
+
+
+struct POINT_HASH
+{
+    std::size_t operator()( const wxPoint& aPoint ) const
+    {
+        return (std::size_t) (unsigned) aPoint.x * 1000003 + (unsigned) aPoint.y;
+    }
+};
+
+
+/**
+ * The line along the direction (m_dx, m_dy), m_dx and m_dy having no common divisor,
+ * through the points of which m_dy * x - m_dx * y is m_c.
+ */
+struct LINE_KEY
+{
+    LINE_KEY( const wxPoint& aDirection, const wxPoint& aPos ) :
+        m_dx( aDirection.x ),
+        m_dy( aDirection.y ),
+        m_c( (long long) aDirection.y * aPos.x - (long long) aDirection.x * aPos.y )
+    {
+    }
+
+    bool operator==( const LINE_KEY& aOther ) const
+    {
+        return m_dx == aOther.m_dx && m_dy == aOther.m_dy && m_c == aOther.m_c;
+    }
+
+    int         m_dx;
+    int         m_dy;
+    long long   m_c;
+};
+
+
+struct LINE_KEY_HASH
+{
+    std::size_t operator()( const LINE_KEY& aLine ) const
+    {
+        return ( (std::size_t) (unsigned) aLine.m_dx * 31 + (unsigned) aLine.m_dy ) * 1000003
+               + std::hash<long long>()( aLine.m_c );
+    }
+};
+
+
+/**
+ * Function lineDirection
+ * @return the direction of the segment from aStart to aEnd, with no common divisor and
+ * a positive x (or y for a vertical segment), that of a horizontal segment for a point.
+ */
+static wxPoint lineDirection( const wxPoint& aStart, const wxPoint& aEnd )
+{
+    int dx = aEnd.x - aStart.x;
+    int dy = aEnd.y - aStart.y;
+    int a = std::abs( dx );
+    int b = std::abs( dy );
+
+    if( a == 0 && b == 0 )
+        return wxPoint( 1, 0 );
+
+    while( b )
+    {
+        int r = a % b;
+
+        a = b;
+        b = r;
+    }
+
+    dx /= a;
+    dy /= a;
+
+    if( dx < 0 || ( dx == 0 && dy < 0 ) )
+        return wxPoint( -dx, -dy );
+
+    return wxPoint( dx, dy );
+}
+
+
+/// A label text in the sheet path numbered m_sheet, or in one of the global groups below
+struct LABEL_KEY
+{
+    LABEL_KEY( int aSheet, const wxString& aText ) :
+        m_sheet( aSheet ),
+        m_text( aText )
+    {
+    }
+
+    bool operator==( const LABEL_KEY& aOther ) const
+    {
+        return m_sheet == aOther.m_sheet && m_text == aOther.m_text;
+    }
+
+    int         m_sheet;
+    wxString    m_text;
+};
+
+
+struct LABEL_KEY_HASH
+{
+    std::size_t operator()( const LABEL_KEY& aKey ) const
+    {
+        return WXSTRING_HASH()( aKey.m_text ) * 31 + aKey.m_sheet;
+    }
+};
+
+
+// The groups of labels connected in all the sheets
+enum GLOBAL_LABEL_GROUP
+{
+    PIN_LABELS = -1,
+    GLOBAL_LABELS = -2,
+    GLOBAL_BUS_LABEL_MEMBERS = -3
+};
+
+
+/**
+ * Struct LABEL_GROUP
+ * the items having the same label text in a sheet, or the global labels having the same
+ * text. Once the items of a group have been given a code, they keep having the same code,
+ * so that giving a code to one of them gives it to all of them.
+ */
+struct LABEL_GROUP
+{
+    std::vector<int>    m_items;
+    bool                m_connected = false;
+};
+
+
+template <class MAP>
+static const typename MAP::mapped_type* findItems( const MAP& aMap,
+                                                   const typename MAP::key_type& aKey )
+{
+    auto it = aMap.find( aKey );
+
+    return it == aMap.end() ? NULL : &it->second;
+}
+
+
+/**
+ * Function connectsAtEnds
+ * @return true if an item of type aType connects to the ends of wires (aIsBus == IS_WIRE)
+ * or to the ends of buses (aIsBus == IS_BUS).
+ */
+static bool connectsAtEnds( NETLIST_ITEM_T aType, bool aIsBus )
+{
+    switch( aType )
+    {
+    case NET_SEGMENT:
+    case NET_PIN:
+    case NET_LABEL:
+    case NET_HIERLABEL:
+    case NET_GLOBLABEL:
+    case NET_SHEETLABEL:
+    case NET_PINLABEL:
+    case NET_NOCONNECT:
+        return aIsBus == IS_WIRE;
+
+    case NET_BUS:
+    case NET_BUSLABELMEMBER:
+    case NET_SHEETBUSLABELMEMBER:
+    case NET_HIERBUSLABELMEMBER:
+    case NET_GLOBBUSLABELMEMBER:
+        return aIsBus == IS_BUS;
+
+    case NET_JUNCTION:
+        return true;
+
+    case NET_ITEM_UNSPECIFIED:
+        break;
+    }
+
+    return false;
+}
+
+
+void NETLIST_OBJECT_LIST::ConnectItems()
+{
+    m_lastNetCode = m_lastBusNetCode = 0;
+
+    // Only the items of the same sheet path are physically connected
+    for( unsigned start = 0, end; start < size(); start = end )
+    {
+        const SCH_SHEET_PATH& sheet = GetItem( start )->m_SheetPath;
+
+        for( end = start + 1; end < size() && GetItem( end )->m_SheetPath == sheet; end++ )
+            ;
+
+        connectSheetItems( start, end );
+    }
+
+    connectLabels();
+}
+
+
+void NETLIST_OBJECT_LIST::connectSheetItems( unsigned aStart, unsigned aEnd )
+{
+    // The items are connected in the order of the list, each connection giving the code of
+    // one item to the items connected to it, with the codes of the items they were already
+    // connected to, so that the codes found do not depend on how the connected items are
+    // found: the positions are looked up in hash tables, and the items having the same code
+    // are sets of a union-find structure.
+    int count = aEnd - aStart;
+    NET_CODE_SETS nets( count, m_lastNetCode + 1 );
+    NET_CODE_SETS buses( count, m_lastBusNetCode + 1 );
+
+    auto sheetItem = [&]( int aItem ) -> NETLIST_OBJECT*
+    {
+        return GetItem( aStart + aItem );
+    };
+
+    // The items by the positions of their ends, and the wires and buses by the line they
+    // lie on, with the directions of the lines (few: mostly horizontal and vertical ones)
+    std::unordered_map<wxPoint, std::vector<int>, POINT_HASH> ends;
+    std::unordered_map<LINE_KEY, std::vector<int>, LINE_KEY_HASH> lines;
+    std::vector<wxPoint> directions;
+
+    for( int ii = 0; ii < count; ii++ )
+    {
+        NETLIST_OBJECT* item = sheetItem( ii );
+
+        ends[ item->m_Start ].push_back( ii );
+
+        if( item->m_End != item->m_Start )
+            ends[ item->m_End ].push_back( ii );
+
+        if( item->m_Type != NET_SEGMENT && item->m_Type != NET_BUS )
+            continue;
+
+        wxPoint direction = lineDirection( item->m_Start, item->m_End );
+
+        if( std::find( directions.begin(), directions.end(), direction ) == directions.end() )
+            directions.push_back( direction );
+
+        lines[ LINE_KEY( direction, item->m_Start ) ].push_back( ii );
+    }
+
+    // Connects aRef to the items having an end on one of its ends
+    auto pointToPointConnect = [&]( int aRef, bool aIsBus )
+    {
+        NETLIST_OBJECT* ref = sheetItem( aRef );
+        NET_CODE_SETS& codes = aIsBus ? buses : nets;
+        int code = codes.Get( aRef );
+
+        for( const wxPoint& pos : { ref->m_Start, ref->m_End } )
+        {
+            const std::vector<int>* items = findItems( ends, pos );
+
+            if( !items )
+                continue;
+
+            for( int ii : *items )
+            {
+                if( connectsAtEnds( sheetItem( ii )->m_Type, aIsBus ) )
+                    codes.Connect( ii, code );
+            }
+        }
+    };
+
+    // Connects aJunction to the wires or buses it lies on
+    auto segmentToPointConnect = [&]( int aJunction, bool aIsBus )
+    {
+        const wxPoint& pos = sheetItem( aJunction )->m_Start;
+        NETLIST_ITEM_T type = aIsBus == IS_BUS ? NET_BUS : NET_SEGMENT;
+        NET_CODE_SETS& codes = aIsBus ? buses : nets;
+        int code = codes.Get( aJunction );
+
+        for( const wxPoint& direction : directions )
         {
-            sheet  = &(net_item->m_SheetPath);
-            istart = ii;
+            const std::vector<int>* segments = findItems( lines, LINE_KEY( direction, pos ) );
+
+            if( !segments )
+                continue;
+
+            for( int ii : *segments )
+            {
+                NETLIST_OBJECT* segment = sheetItem( ii );
+
+                if( segment->m_Type != type )
+                    continue;
+
+                if( IsPointOnSegment( segment->m_Start, segment->m_End, pos ) )
+                    codes.Connect( ii, code );
+            }
         }
+    };
+
+    for( int ii = 0; ii < count; ii++ )
+    {
+        NETLIST_OBJECT* net_item = sheetItem( ii );
 
         switch( net_item->m_Type )
         {
@@ -240,167 +705,373 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
         case NET_PINLABEL:
         case NET_SHEETLABEL:
         case NET_NOCONNECT:
-            if( net_item->GetNet() != 0 )
+            if( nets.Get( ii ) != 0 )
                 break;
 
         case NET_SEGMENT:
             // Test connections point to point type without bus.
-            if( net_item->GetNet() == 0 )
-            {
-                net_item->SetNet( m_lastNetCode );
-                m_lastNetCode++;
-            }
+            if( nets.Get( ii ) == 0 )
+                nets.Set( ii, ++m_lastNetCode );
 
-            pointToPointConnect( net_item, IS_WIRE, istart );
+            pointToPointConnect( ii, IS_WIRE );
             break;
 
         case NET_JUNCTION:
             // Control of the junction outside BUS.
-            if( net_item->GetNet() == 0 )
-            {
-                net_item->SetNet( m_lastNetCode );
-                m_lastNetCode++;
-            }
+            if( nets.Get( ii ) == 0 )
+                nets.Set( ii, ++m_lastNetCode );
 
-            segmentToPointConnect( net_item, IS_WIRE, istart );
+            segmentToPointConnect( ii, IS_WIRE );
 
             // Control of the junction, on BUS.
-            if( net_item->m_BusNetCode == 0 )
-            {
-                net_item->m_BusNetCode = m_lastBusNetCode;
-                m_lastBusNetCode++;
-            }
+            if( buses.Get( ii ) == 0 )
+                buses.Set( ii, ++m_lastBusNetCode );
 
-            segmentToPointConnect( net_item, IS_BUS, istart );
+            segmentToPointConnect( ii, IS_BUS );
             break;
 
         case NET_LABEL:
         case NET_HIERLABEL:
         case NET_GLOBLABEL:
             // Test connections type junction without bus.
-            if( net_item->GetNet() == 0 )
-            {
-                net_item->SetNet( m_lastNetCode );
-                m_lastNetCode++;
-            }
+            if( nets.Get( ii ) == 0 )
+                nets.Set( ii, ++m_lastNetCode );
 
-            segmentToPointConnect( net_item, IS_WIRE, istart );
+            segmentToPointConnect( ii, IS_WIRE );
             break;
 
         case NET_SHEETBUSLABELMEMBER:
-            if( net_item->m_BusNetCode != 0 )
+            if( buses.Get( ii ) != 0 )
                 break;
 
         case NET_BUS:
             // Control type connections point to point mode bus
-            if( net_item->m_BusNetCode == 0 )
-            {
-                net_item->m_BusNetCode = m_lastBusNetCode;
-                m_lastBusNetCode++;
-            }
+            if( buses.Get( ii ) == 0 )
+                buses.Set( ii, ++m_lastBusNetCode );
+
+            pointToPointConnect( ii, IS_BUS );
+            break;
+
+        case NET_BUSLABELMEMBER:
+        case NET_HIERBUSLABELMEMBER:
+        case NET_GLOBBUSLABELMEMBER:
+            // Control connections similar has on BUS
+            if( nets.Get( ii ) == 0 )
+                buses.Set( ii, ++m_lastBusNetCode );
 
-            pointToPointConnect( net_item, IS_BUS, istart );
+            segmentToPointConnect( ii, IS_BUS );
             break;
+        }
+    }
+
+    // Connect the bus label members having the same member number on the same bus, giving
+    // a net code to those which have none
+    std::unordered_map<long long, std::vector<int>> busMembers;
+
+    auto busMemberKey = [&]( int aItem ) -> long long
+    {
+        return (long long) buses.Get( aItem ) << 32 | (unsigned) sheetItem( aItem )->m_Member;
+    };
+
+    for( int ii = 0; ii < count; ii++ )
+    {
+        if( sheetItem( ii )->IsLabelBusMemberType() )
+            busMembers[ busMemberKey( ii ) ].push_back( ii );
+    }
+
+    for( int ii = 0; ii < count; ii++ )
+    {
+        if( !sheetItem( ii )->IsLabelBusMemberType() )
+            continue;
+
+        // The first member connects the others, which then have its code
+        const std::vector<int>& members = busMembers[ busMemberKey( ii ) ];
+
+        if( members.front() != ii )
+            continue;
+
+        if( nets.Get( ii ) == 0 )
+            nets.Set( ii, ++m_lastNetCode );
+
+        int code = nets.Get( ii );
+
+        for( int jj : members )
+            nets.Connect( jj, code );
+    }
+
+    for( int ii = 0; ii < count; ii++ )
+    {
+        sheetItem( ii )->SetNet( nets.Get( ii ) );
+        sheetItem( ii )->m_BusNetCode = buses.Get( ii );
+    }
+}
+
+
+void NETLIST_OBJECT_LIST::appendSheetItems( const NETLIST_OBJECT_LIST& aItems )
+{
+    for( NETLIST_OBJECT* item : aItems )
+    {
+        NETLIST_OBJECT* copy = new NETLIST_OBJECT( *item );
+
+        if( copy->GetNet() )
+            copy->SetNet( copy->GetNet() + m_lastNetCode );
+
+        if( copy->m_BusNetCode )
+            copy->m_BusNetCode += m_lastBusNetCode;
+
+        push_back( copy );
+    }
+
+    m_lastNetCode += aItems.m_lastNetCode;
+    m_lastBusNetCode += aItems.m_lastBusNetCode;
+}
+
+
+void NETLIST_OBJECT_LIST::connectLabels()
+{
+    // Only the labels, the sheet labels and their bus members connect the items of several
+    // sheets, or of distant places of a sheet: their codes are merged in the order of the
+    // list, then given to the other items having them
+    std::vector<int> labelItems;
+
+    for( unsigned ii = 0; ii < size(); ii++ )
+    {
+        NETLIST_OBJECT* item = GetItem( ii );
+
+        if( item->IsLabelType() || item->m_Type == NET_SHEETLABEL
+                || item->m_Type == NET_SHEETBUSLABELMEMBER )
+            labelItems.push_back( ii );
+    }
+
+    int count = labelItems.size();
+    NET_CODE_SETS nets( count );
+
+    auto labelItem = [&]( int aLabel ) -> NETLIST_OBJECT*
+    {
+        return GetItem( labelItems[aLabel] );
+    };
+
+    // Number the sheet paths of the labels
+    std::unordered_map<SCH_SHEET_PATH, int, SHEET_PATH_HASH> sheetIds;
+    std::vector<int> sheetOf( count );
+
+    for( int ii = 0; ii < count; ii++ )
+    {
+        NETLIST_OBJECT* item = labelItem( ii );
+        auto id = std::make_pair( item->m_SheetPath, (int) sheetIds.size() );
+
+        sheetOf[ii] = sheetIds.insert( id ).first->second;
+
+        if( item->GetNet() )
+            nets.Set( ii, item->GetNet() );
+    }
+
+    // Group objects by label: a label connects the labels of its sheet having the same text,
+    // the power pin labels having the same text in all the sheets, and the global labels of
+    // its type having the same text in all the sheets
+    std::unordered_map<LABEL_KEY, LABEL_GROUP, LABEL_KEY_HASH> labels;
+    std::unordered_map<LABEL_KEY, LABEL_GROUP, LABEL_KEY_HASH> hierLabels;
+
+    for( int ii = 0; ii < count; ii++ )
+    {
+        NETLIST_OBJECT* item = labelItem( ii );
+
+        if( !item->IsLabelType() )
+            continue;
+
+        labels[ LABEL_KEY( sheetOf[ii], item->m_Label ) ].m_items.push_back( ii );
+
+        if( item->m_Type == NET_PINLABEL )
+            labels[ LABEL_KEY( PIN_LABELS, item->m_Label ) ].m_items.push_back( ii );
+        else if( item->m_Type == NET_GLOBLABEL )
+            labels[ LABEL_KEY( GLOBAL_LABELS, item->m_Label ) ].m_items.push_back( ii );
+        else if( item->m_Type == NET_GLOBBUSLABELMEMBER )
+            labels[ LABEL_KEY( GLOBAL_BUS_LABEL_MEMBERS, item->m_Label ) ].m_items.push_back( ii );
+        else if( item->m_Type == NET_HIERLABEL || item->m_Type == NET_HIERBUSLABELMEMBER )
+            hierLabels[ LABEL_KEY( sheetOf[ii], item->m_Label ) ].m_items.push_back( ii );
+    }
+
+    auto connectGroup = [&]( std::unordered_map<LABEL_KEY, LABEL_GROUP, LABEL_KEY_HASH>& aGroups,
+                             const LABEL_KEY& aKey, int aCode )
+    {
+        auto it = aGroups.find( aKey );
+
+        if( it == aGroups.end() )
+            return;
 
-        case NET_BUSLABELMEMBER:
-        case NET_HIERBUSLABELMEMBER:
-        case NET_GLOBBUSLABELMEMBER:
-            // Control connections similar has on BUS
-            if( net_item->GetNet() == 0 )
-            {
-                net_item->m_BusNetCode = m_lastBusNetCode;
-                m_lastBusNetCode++;
-            }
+        LABEL_GROUP& group = it->second;
 
-            segmentToPointConnect( net_item, IS_BUS, istart );
-            break;
+        if( group.m_connected )
+        {
+            nets.Connect( group.m_items.front(), aCode );
+            return;
         }
-    }
 
-#if defined(NETLIST_DEBUG) && defined(DEBUG)
-    std::cout << "\n\nafter sheet local\n\n";
-    DumpNetTable();
-#endif
+        for( int ii : group.m_items )
+            nets.Connect( ii, aCode );
 
-    // Updating the Bus Labels Netcode connected by Bus
-    connectBusLabels();
+        group.m_connected = true;
+    };
 
-    // Group objects by label.
-    for( unsigned ii = 0; ii < size(); ii++ )
+    for( int ii = 0; ii < count; ii++ )
     {
-        switch( GetItem( ii )->m_Type )
-        {
-        case NET_PIN:
-        case NET_SHEETLABEL:
-        case NET_SEGMENT:
-        case NET_JUNCTION:
-        case NET_BUS:
-        case NET_NOCONNECT:
-            break;
+        NETLIST_OBJECT* item = labelItem( ii );
 
+        switch( item->m_Type )
+        {
         case NET_LABEL:
         case NET_GLOBLABEL:
         case NET_PINLABEL:
         case NET_BUSLABELMEMBER:
         case NET_GLOBBUSLABELMEMBER:
-            labelConnect( GetItem( ii ) );
-            break;
-
-        case NET_SHEETBUSLABELMEMBER:
-        case NET_HIERLABEL:
-        case NET_HIERBUSLABELMEMBER:
             break;
 
-        case NET_ITEM_UNSPECIFIED:
-            break;
+        default:
+            continue;
         }
-    }
 
-#if defined(NETLIST_DEBUG) && defined(DEBUG)
-    std::cout << "\n\nafter sheet global\n\n";
-    DumpNetTable();
-#endif
+        int code = nets.Get( ii );
 
-    // Connection between hierarchy sheets
-    for( unsigned ii = 0; ii < size(); ii++ )
+        if( code == 0 )
+            continue;
+
+        connectGroup( labels, LABEL_KEY( sheetOf[ii], item->m_Label ), code );
+        connectGroup( labels, LABEL_KEY( PIN_LABELS, item->m_Label ), code );
+
+        //global labels only connect other global labels.
+        if( item->m_Type == NET_GLOBLABEL )
+            connectGroup( labels, LABEL_KEY( GLOBAL_LABELS, item->m_Label ), code );
+        else if( item->m_Type == NET_GLOBBUSLABELMEMBER )
+            connectGroup( labels, LABEL_KEY( GLOBAL_BUS_LABEL_MEMBERS, item->m_Label ), code );
+    }
+
+    // Connection between hierarchy sheets: a sheet label connects the hierarchical labels
+    // having the same text in the sheet it includes
+    for( int ii = 0; ii < count; ii++ )
     {
-        if( GetItem( ii )->m_Type == NET_SHEETLABEL
-            || GetItem( ii )->m_Type == NET_SHEETBUSLABELMEMBER )
-            sheetLabelConnect( GetItem( ii ) );
+        NETLIST_OBJECT* item = labelItem( ii );
+
+        if( item->m_Type != NET_SHEETLABEL && item->m_Type != NET_SHEETBUSLABELMEMBER )
+            continue;
+
+        int code = nets.Get( ii );
+        auto include = sheetIds.find( item->m_SheetPathInclude );
+
+        if( code != 0 && include != sheetIds.end() )
+            connectGroup( hierLabels, LABEL_KEY( include->second, item->m_Label ), code );
     }
 
-    // Sort objects by NetCode
-    SortListbyNetcode();
+    // The code each code became, given to all the items
+    std::vector<int> codes( m_lastNetCode + 1 );
 
-#if defined(NETLIST_DEBUG) && defined(DEBUG)
-    std::cout << "\n\nafter qsort()\n";
-    DumpNetTable();
-#endif
+    for( int code = 0; code <= m_lastNetCode; code++ )
+        codes[code] = code;
 
-    // Compress numbers of Netcode having consecutive values.
-    int NetCode = 0;
-    m_lastNetCode = 0;
+    for( int ii = 0; ii < count; ii++ )
+    {
+        int code = labelItem( ii )->GetNet();
+
+        if( code )
+            codes[code] = nets.Get( ii );
+    }
 
     for( unsigned ii = 0; ii < size(); ii++ )
+        GetItem( ii )->SetNet( codes[ GetItem( ii )->GetNet() ] );
+
+    for( int ii = 0; ii < count; ii++ )
+        labelItem( ii )->SetNet( nets.Get( ii ) );
+}
+
+
+/// The netlist items of a sheet path, connected to each other
+struct NETLIST_SHEET_CACHE::SHEET_ITEMS
+{
+    SCH_SHEET_PATH      m_path;
+    wxString            m_pathName;     ///< The time stamps of the sheets of m_path
+    unsigned            m_revision;     ///< The revision of the screen of m_path
+    NETLIST_OBJECT_LIST m_items;
+};
+
+
+NETLIST_SHEET_CACHE::NETLIST_SHEET_CACHE()
+{
+}
+
+
+NETLIST_SHEET_CACHE::~NETLIST_SHEET_CACHE()
+{
+}
+
+
+void NETLIST_SHEET_CACHE::Clear()
+{
+    m_sheets.clear();
+}
+
+
+void NETLIST_SHEET_CACHE::GetItems( SCH_SHEET_LIST& aSheets, NETLIST_OBJECT_LIST& aList )
+{
+    std::unordered_map<SCH_SHEET_PATH, int, SHEET_PATH_HASH> cached;
+    std::vector<std::unique_ptr<SHEET_ITEMS>> sheets;
+
+    for( unsigned ii = 0; ii < m_sheets.size(); ii++ )
+        cached[ m_sheets[ii]->m_path ] = ii;
+
+    for( unsigned i = 0; i < aSheets.size(); i++ )
     {
-        if( GetItem( ii )->GetNet() != m_lastNetCode )
+        SCH_SHEET_PATH* path = &aSheets[i];
+        SCH_SCREEN* screen = path->LastScreen();
+        wxString pathName = path->Path();
+        auto it = cached.find( *path );
+
+        // The units of the components depend on the time stamps of the sheets, and the
+        // revisions of two screens are never the same
+        if( it != cached.end() )
         {
-            NetCode++;
-            m_lastNetCode = GetItem( ii )->GetNet();
+            std::unique_ptr<SHEET_ITEMS>& sheet = m_sheets[it->second];
+
+            if( sheet && sheet->m_revision == screen->GetRevision()
+                    && sheet->m_pathName == pathName )
+            {
+                sheets.push_back( std::move( sheet ) );
+                continue;
+            }
         }
 
-        GetItem( ii )->SetNet( NetCode );
+        std::unique_ptr<SHEET_ITEMS> sheet( new SHEET_ITEMS );
+
+        sheet->m_path = *path;
+        sheet->m_pathName = pathName;
+        sheet->m_revision = screen->GetRevision();
+
+        for( SCH_ITEM* item = screen->GetDrawItems(); item; item = item->Next() )
+            item->GetNetListItem( sheet->m_items, path );
+
+        sheet->m_items.connectSheetItems( 0, sheet->m_items.size() );
+        sheets.push_back( std::move( sheet ) );
     }
 
-    // Set the minimal connection info:
-    setUnconnectedFlag();
+    // Drop the sheet paths which are not in aSheets any more
+    m_sheets = std::move( sheets );
 
-    // find the best label object to give the best net name to each net
-    findBestNetNameForEachNet();
+    // Sorted as SortListbySheet() sorts the items
+    std::vector<SHEET_ITEMS*> sorted;
 
-    return true;
+    for( const std::unique_ptr<SHEET_ITEMS>& sheet : m_sheets )
+        sorted.push_back( sheet.get() );
+
+    std::stable_sort( sorted.begin(), sorted.end(),
+                      []( const SHEET_ITEMS* aFirst, const SHEET_ITEMS* aSecond ) -> bool
+                      {
+                          return aFirst->m_path.Cmp( aSecond->m_path ) < 0;
+                      } );
+
+    for( SHEET_ITEMS* sheet : sorted )
+        aList.appendSheetItems( sheet->m_items );
 }
 
+
+
 // Helper function to give a priority to sort labels:
 // NET_PINLABEL, NET_GLOBBUSLABELMEMBER and NET_GLOBLABEL are global labels
 // and the priority is high
@@ -616,289 +1287,6 @@ void NETLIST_OBJECT_LIST::findBestNetNameForEachNet()
 }
 
 
-void NETLIST_OBJECT_LIST::sheetLabelConnect( NETLIST_OBJECT* SheetLabel )
-{
-    if( SheetLabel->GetNet() == 0 )
-        return;
-
-    for( unsigned ii = 0; ii < size(); ii++ )
-    {
-        NETLIST_OBJECT* ObjetNet = GetItem( ii );
-
-        if( ObjetNet->m_SheetPath != SheetLabel->m_SheetPathInclude )
-            continue;  //use SheetInclude, not the sheet!!
-
-        if( (ObjetNet->m_Type != NET_HIERLABEL ) && (ObjetNet->m_Type != NET_HIERBUSLABELMEMBER ) )
-            continue;
-
-        if( ObjetNet->GetNet() == SheetLabel->GetNet() )
-            continue;  //already connected.
-
-        if( ObjetNet->m_Label != SheetLabel->m_Label )
-            continue;  //different names.
-
-        // Propagate Netcode having all the objects of the same Netcode.
-        if( ObjetNet->GetNet() )
-            propagateNetCode( ObjetNet->GetNet(), SheetLabel->GetNet(), IS_WIRE );
-        else
-            ObjetNet->SetNet( SheetLabel->GetNet() );
-    }
-}
-
-
-void NETLIST_OBJECT_LIST::connectBusLabels()
-{
-    // Propagate the net code between all bus label member objects connected by they name.
-    // If the net code is not yet existing, a new one is created
-    // Search is done in the entire list
-    for( unsigned ii = 0; ii < size(); ii++ )
-    {
-        NETLIST_OBJECT* Label = GetItem( ii );
-
-        if( Label->IsLabelBusMemberType() )
-        {
-            if( Label->GetNet() == 0 )
-            {
-                // Not yet existiing net code: create a new one.
-                Label->SetNet( m_lastNetCode );
-                m_lastNetCode++;
-            }
-
-            for( unsigned jj = ii + 1; jj < size(); jj++ )
-            {
-                NETLIST_OBJECT* LabelInTst =  GetItem( jj );
-
-                if( LabelInTst->IsLabelBusMemberType() )
-                {
-                    if( LabelInTst->m_BusNetCode != Label->m_BusNetCode )
-                        continue;
-
-                    if( LabelInTst->m_Member != Label->m_Member )
-                        continue;
-
-                    if( LabelInTst->GetNet() == 0 )
-                        // Append this object to the current net
-                        LabelInTst->SetNet( Label->GetNet() );
-                    else
-                        // Merge the 2 net codes, they are connected.
-                        propagateNetCode( LabelInTst->GetNet(), Label->GetNet(), IS_WIRE );
-                }
-            }
-        }
-    }
-}
-
-
-void NETLIST_OBJECT_LIST::propagateNetCode( int aOldNetCode, int aNewNetCode, bool aIsBus )
-{
-    if( aOldNetCode == aNewNetCode )
-        return;
-
-    if( aIsBus == false )    // Propagate NetCode
-    {
-        for( unsigned jj = 0; jj < size(); jj++ )
-        {
-            NETLIST_OBJECT* object = GetItem( jj );
-
-            if( object->GetNet() == aOldNetCode )
-                object->SetNet( aNewNetCode );
-        }
-    }
-    else               // Propagate BusNetCode
-    {
-        for( unsigned jj = 0; jj < size(); jj++ )
-        {
-            NETLIST_OBJECT* object = GetItem( jj );
-
-            if( object->m_BusNetCode == aOldNetCode )
-                object->m_BusNetCode = aNewNetCode;
-        }
-    }
-}
-
-
-void NETLIST_OBJECT_LIST::pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus, int start )
-{
-    int netCode;
-
-    if( aIsBus == false )    // Objects other than BUS and BUSLABELS
-    {
-        netCode = aRef->GetNet();
-
-        for( unsigned i = start; i < size(); i++ )
-        {
-            NETLIST_OBJECT* item = GetItem( i );
-
-            if( item->m_SheetPath != aRef->m_SheetPath )  //used to be > (why?)
-                continue;
-
-            switch( item->m_Type )
-            {
-            case NET_SEGMENT:
-            case NET_PIN:
-            case NET_LABEL:
-            case NET_HIERLABEL:
-            case NET_GLOBLABEL:
-            case NET_SHEETLABEL:
-            case NET_PINLABEL:
-            case NET_JUNCTION:
-            case NET_NOCONNECT:
-                if( aRef->m_Start == item->m_Start
-                    || aRef->m_Start == item->m_End
-                    || aRef->m_End   == item->m_Start
-                    || aRef->m_End   == item->m_End )
-                {
-                    if( item->GetNet() == 0 )
-                        item->SetNet( netCode );
-                    else
-                        propagateNetCode( item->GetNet(), netCode, IS_WIRE );
-                }
-                break;
-
-            case NET_BUS:
-            case NET_BUSLABELMEMBER:
-            case NET_SHEETBUSLABELMEMBER:
-            case NET_HIERBUSLABELMEMBER:
-            case NET_GLOBBUSLABELMEMBER:
-            case NET_ITEM_UNSPECIFIED:
-                break;
-            }
-        }
-    }
-    else    // Object type BUS, BUSLABELS, and junctions.
-    {
-        netCode = aRef->m_BusNetCode;
-
-        for( unsigned i = start; i < size(); i++ )
-        {
-            NETLIST_OBJECT* item = GetItem( i );
-
-            if( item->m_SheetPath != aRef->m_SheetPath )
-                continue;
-
-            switch( item->m_Type )
-            {
-            case NET_ITEM_UNSPECIFIED:
-            case NET_SEGMENT:
-            case NET_PIN:
-            case NET_LABEL:
-            case NET_HIERLABEL:
-            case NET_GLOBLABEL:
-            case NET_SHEETLABEL:
-            case NET_PINLABEL:
-            case NET_NOCONNECT:
-                break;
-
-            case NET_BUS:
-            case NET_BUSLABELMEMBER:
-            case NET_SHEETBUSLABELMEMBER:
-            case NET_HIERBUSLABELMEMBER:
-            case NET_GLOBBUSLABELMEMBER:
-            case NET_JUNCTION:
-                if(  aRef->m_Start == item->m_Start
-                  || aRef->m_Start == item->m_End
-                  || aRef->m_End   == item->m_Start
-                  || aRef->m_End   == item->m_End )
-                {
-                    if( item->m_BusNetCode == 0 )
-                        item->m_BusNetCode = netCode;
-                    else
-                        propagateNetCode( item->m_BusNetCode, netCode, IS_BUS );
-                }
-                break;
-            }
-        }
-    }
-}
-
-
-void NETLIST_OBJECT_LIST::segmentToPointConnect( NETLIST_OBJECT* aJonction,
-                                                 bool aIsBus, int aIdxStart )
-{
-    for( unsigned i = aIdxStart; i < size(); i++ )
-    {
-        NETLIST_OBJECT* segment = GetItem( i );
-
-        // if different sheets, obviously no physical connection between elements.
-        if( segment->m_SheetPath != aJonction->m_SheetPath )
-            continue;
-
-        if( aIsBus == IS_WIRE )
-        {
-            if( segment->m_Type != NET_SEGMENT )
-                continue;
-        }
-        else
-        {
-            if( segment->m_Type != NET_BUS )
-                continue;
-        }
-
-        if( IsPointOnSegment( segment->m_Start, segment->m_End, aJonction->m_Start ) )
-        {
-            // Propagation Netcode has all the objects of the same Netcode.
-            if( aIsBus == IS_WIRE )
-            {
-                if( segment->GetNet() )
-                    propagateNetCode( segment->GetNet(), aJonction->GetNet(), aIsBus );
-                else
-                    segment->SetNet( aJonction->GetNet() );
-            }
-            else
-            {
-                if( segment->m_BusNetCode )
-                    propagateNetCode( segment->m_BusNetCode, aJonction->m_BusNetCode, aIsBus );
-                else
-                    segment->m_BusNetCode = aJonction->m_BusNetCode;
-            }
-        }
-    }
-}
-
-
-void NETLIST_OBJECT_LIST::labelConnect( NETLIST_OBJECT* aLabelRef )
-{
-    if( aLabelRef->GetNet() == 0 )
-        return;
-
-    for( unsigned i = 0; i < size(); i++ )
-    {
-        NETLIST_OBJECT* item = GetItem( i );
-
-        if( item->GetNet() == aLabelRef->GetNet() )
-            continue;
-
-        if( item->m_SheetPath != aLabelRef->m_SheetPath )
-        {
-            if( item->m_Type != NET_PINLABEL && item->m_Type != NET_GLOBLABEL
-                && item->m_Type != NET_GLOBBUSLABELMEMBER )
-                continue;
-
-            if( (item->m_Type == NET_GLOBLABEL
-                 || item->m_Type == NET_GLOBBUSLABELMEMBER)
-               && item->m_Type != aLabelRef->m_Type )
-                //global labels only connect other global labels.
-                continue;
-        }
-
-        // NET_HIERLABEL are used to connect sheets.
-        // NET_LABEL are local to a sheet
-        // NET_GLOBLABEL are global.
-        // NET_PINLABEL is a kind of global label (generated by a power pin invisible)
-        if( item->IsLabelType() )
-        {
-            if( item->m_Label != aLabelRef->m_Label )
-                continue;
-
-            if( item->GetNet() )
-                propagateNetCode( item->GetNet(), aLabelRef->GetNet(), IS_WIRE );
-            else
-                item->SetNet( aLabelRef->GetNet() );
-        }
-    }
-}
-
-
 void NETLIST_OBJECT_LIST::setUnconnectedFlag()
 {
     NETLIST_OBJECT* NetItemRef;
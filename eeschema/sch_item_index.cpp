@@ -0,0 +1,212 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+
+#include <fctsys.h>
+#include <general.h>
+#include <sch_item_struct.h>
+#include <sch_sheet.h>
+#include <sch_sheet_pin.h>
+
+#include <sch_item_index.h>
+
+
+// Half the size of the area given to the items hit anywhere
+static const int AnyPosition = 0x10000000;
+
+
+SCH_ITEM_INDEX::SCH_ITEM_INDEX() :
+    m_revision( 0 ),
+    m_lineThickness( 0 ),
+    m_built( false ),
+    m_nextRank( 0 )
+{
+}
+
+
+SCH_ITEM_INDEX::~SCH_ITEM_INDEX()
+{
+}
+
+
+bool SCH_ITEM_INDEX::IsCurrent( unsigned aRevision ) const
+{
+    // The areas of the texts and of the no connect symbols depend on the default line
+    // thickness, which is a preference
+    return m_built && m_revision == aRevision && m_lineThickness == GetDefaultLineThickness();
+}
+
+
+EDA_RECT SCH_ITEM_INDEX::ItemArea( SCH_ITEM* aItem )
+{
+    // Markers are hit around their shape scaled, not in their bounding box: they are
+    // candidates at any position
+    if( aItem->Type() == SCH_MARKER_T )
+        return EDA_RECT( wxPoint( -AnyPosition, -AnyPosition ),
+                         wxSize( 2 * AnyPosition, 2 * AnyPosition ) );
+
+    EDA_RECT area = aItem->GetBoundingBox();
+
+    area.Normalize();
+
+    // The pins of a sheet stick out of its bounding box
+    if( aItem->Type() == SCH_SHEET_T )
+    {
+        for( SCH_SHEET_PIN& pin : static_cast<SCH_SHEET*>( aItem )->GetPins() )
+        {
+            EDA_RECT pinArea = pin.GetBoundingBox();
+
+            pinArea.Normalize();
+            area.Merge( pinArea );
+        }
+    }
+
+    std::vector< wxPoint > points;
+
+    aItem->GetConnectionPoints( points );
+
+    for( const wxPoint& point : points )
+        area.Merge( point );
+
+    // The boxes of the component pins are transformed with the component, and may be
+    // rounded differently from its body box
+    area.Inflate( 1 );
+
+    return area;
+}
+
+
+void SCH_ITEM_INDEX::insert( SCH_ITEM* aItem, size_t aRank )
+{
+    ENTRY entry;
+
+    entry.m_area = ItemArea( aItem );
+    entry.m_rank = aRank;
+
+    const int mmin[2] = { entry.m_area.GetX(), entry.m_area.GetY() };
+    const int mmax[2] = { entry.m_area.GetRight(), entry.m_area.GetBottom() };
+
+    m_tree.Insert( mmin, mmax, aItem );
+    m_entries[aItem] = entry;
+}
+
+
+void SCH_ITEM_INDEX::Build( SCH_ITEM* aFirstItem, unsigned aRevision )
+{
+    m_tree.RemoveAll();
+    m_entries.clear();
+    m_nextRank = 0;
+
+    for( SCH_ITEM* item = aFirstItem; item; item = item->Next() )
+        insert( item, m_nextRank++ );
+
+    m_revision = aRevision;
+    m_lineThickness = GetDefaultLineThickness();
+    m_built = true;
+}
+
+
+void SCH_ITEM_INDEX::Add( SCH_ITEM* aItem )
+{
+    Remove( aItem );
+    insert( aItem, m_nextRank++ );
+}
+
+
+void SCH_ITEM_INDEX::Update( SCH_ITEM* aItem )
+{
+    auto it = m_entries.find( aItem );
+
+    if( it == m_entries.end() )
+        return;
+
+    size_t rank = it->second.m_rank;
+
+    Remove( aItem );
+    insert( aItem, rank );
+}
+
+
+void SCH_ITEM_INDEX::Remove( const SCH_ITEM* aItem )
+{
+    auto it = m_entries.find( aItem );
+
+    if( it == m_entries.end() )
+        return;
+
+    const EDA_RECT& area = it->second.m_area;
+    const int mmin[2] = { area.GetX(), area.GetY() };
+    const int mmax[2] = { area.GetRight(), area.GetBottom() };
+
+    // The tree only compares the pointers: aItem may already be changed
+    m_tree.Remove( mmin, mmax, const_cast<SCH_ITEM*>( aItem ) );
+    m_entries.erase( it );
+}
+
+
+void SCH_ITEM_INDEX::Query( const wxPoint& aPosition, int aAccuracy,
+                            std::vector<SCH_ITEM*>& aItems )
+{
+    aAccuracy = std::max( aAccuracy, 0 );
+
+    EDA_RECT area( wxPoint( aPosition.x - aAccuracy, aPosition.y - aAccuracy ),
+                   wxSize( 2 * aAccuracy, 2 * aAccuracy ) );
+
+    Query( area, aItems );
+}
+
+
+void SCH_ITEM_INDEX::Query( const EDA_RECT& aArea, std::vector<SCH_ITEM*>& aItems )
+{
+    EDA_RECT area = aArea;
+
+    area.Normalize();
+
+    const int mmin[2] = { area.GetX(), area.GetY() };
+    const int mmax[2] = { area.GetRight(), area.GetBottom() };
+
+    aItems.clear();
+
+    auto collect = [&aItems] ( SCH_ITEM* aItem ) -> bool
+    {
+        aItems.push_back( aItem );
+        return true;
+    };
+
+    m_tree.Search( mmin, mmax, collect );
+
+    Sort( aItems );
+}
+
+
+void SCH_ITEM_INDEX::Sort( std::vector<SCH_ITEM*>& aItems )
+{
+    if( aItems.size() < 2 )
+        return;
+
+    std::sort( aItems.begin(), aItems.end(), [this] ( SCH_ITEM* aA, SCH_ITEM* aB ) -> bool
+            {
+                return m_entries[aA].m_rank < m_entries[aB].m_rank;
+            } );
+}
@@ -0,0 +1,139 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef SCH_ITEM_INDEX_H
+#define SCH_ITEM_INDEX_H
+
+#include <unordered_map>
+#include <vector>
+
+#include <class_eda_rect.h>
+#include <geometry/rtree.h>
+
+class SCH_ITEM;
+
+
+/**
+ * Class SCH_ITEM_INDEX
+ *
+ * Spatial index of the draw items of a SCH_SCREEN, used by its position queries
+ * (GetItem(), GetPin(), GetLine(), CountConnectedItems()...).
+ *
+ * The index is valid for one revision of the screen (see SCH_SCREEN::GetRevision()).
+ * SCH_SCREEN::Append(), Remove() and DeleteItem() update it and carry it to the revision
+ * they give the screen. The items moved or edited in place are not seen by the screen:
+ * any other new revision, such as the ones given when an undo command is pushed and by
+ * SCH_EDIT_FRAME::OnModify() after each edit, makes the next query build the index again.
+ * SCH_SCREEN::TestDanglingEnds(), which follows most edits, always builds it again.
+ *
+ * The queries return the candidates in the order of the draw list, so that the first
+ * matching one is the item a walk of the list would find first.
+ */
+class SCH_ITEM_INDEX
+{
+public:
+    SCH_ITEM_INDEX();
+    ~SCH_ITEM_INDEX();
+
+    /**
+     * Function IsCurrent
+     * @return true if the index was built for \a aRevision of the screen, with the line
+     *         thickness the items have now.
+     */
+    bool IsCurrent( unsigned aRevision ) const;
+
+    void SetRevision( unsigned aRevision )  { m_revision = aRevision; }
+
+    /**
+     * Function Build
+     * indexes the draw list starting at \a aFirstItem, for \a aRevision of the screen.
+     */
+    void Build( SCH_ITEM* aFirstItem, unsigned aRevision );
+
+    /**
+     * Function Add
+     * indexes \a aItem, appended at the end of the draw list.
+     */
+    void Add( SCH_ITEM* aItem );
+
+    /**
+     * Function Update
+     * indexes \a aItem again after it has been changed in place. It keeps its rank in the
+     * draw list.
+     */
+    void Update( SCH_ITEM* aItem );
+
+    /**
+     * Function Remove
+     * removes \a aItem from the index, using the area it had when it was indexed.
+     */
+    void Remove( const SCH_ITEM* aItem );
+
+    /**
+     * Function Query
+     * collects the items that may be hit at \a aPosition within \a aAccuracy, or connected
+     * at \a aPosition, in the order of the draw list.
+     */
+    void Query( const wxPoint& aPosition, int aAccuracy, std::vector<SCH_ITEM*>& aItems );
+
+    /**
+     * Function Query
+     * collects the items whose area intersects \a aArea, in the order of the draw list.
+     */
+    void Query( const EDA_RECT& aArea, std::vector<SCH_ITEM*>& aItems );
+
+    /**
+     * Function Sort
+     * sorts \a aItems, all indexed, in the order of the draw list.
+     */
+    void Sort( std::vector<SCH_ITEM*>& aItems );
+
+    /**
+     * Function ItemArea
+     * @return the area containing all the positions \a aItem is hit at with no accuracy,
+     *         its connection points and, for a sheet, its pins.
+     */
+    static EDA_RECT ItemArea( SCH_ITEM* aItem );
+
+private:
+    typedef RTree<SCH_ITEM*, int, 2, float> ITEM_TREE;
+
+    void insert( SCH_ITEM* aItem, size_t aRank );
+
+    struct ENTRY
+    {
+        EDA_RECT    m_area;
+        size_t      m_rank;
+    };
+
+    ITEM_TREE   m_tree;
+    unsigned    m_revision;
+    int         m_lineThickness;
+    bool        m_built;
+    size_t      m_nextRank;
+
+    ///> The area and the rank in the draw list of each item
+    std::unordered_map<const SCH_ITEM*, ENTRY> m_entries;
+};
+
+#endif  // SCH_ITEM_INDEX_H
@@ -1919,8 +1919,11 @@ void SCH_LEGACY_PLUGIN::saveJunction( SCH_JUNCTION* aJunction )
 {
     wxCHECK_RET( aJunction != NULL, "SCH_JUNCTION* is NULL" );
 
-    m_out->Print( 0, "Connection ~ %-4d %-4d\n",
-                  aJunction->GetPosition().x, aJunction->GetPosition().y );
+    FORMAT_BUFFER out( m_out );
+
+    out.Text( "Connection ~ " ).Int( aJunction->GetPosition().x, 4 ).Char( ' ' )
+       .Int( aJunction->GetPosition().y, 4 ).Char( '\n' );
+    out.Flush();
 }
 
 
@@ -1928,8 +1931,11 @@ void SCH_LEGACY_PLUGIN::saveNoConnect( SCH_NO_CONNECT* aNoConnect )
 {
     wxCHECK_RET( aNoConnect != NULL, "SCH_NOCONNECT* is NULL" );
 
-    m_out->Print( 0, "NoConn ~ %-4d %-4d\n", aNoConnect->GetPosition().x,
-                  aNoConnect->GetPosition().y );
+    FORMAT_BUFFER out( m_out );
+
+    out.Text( "NoConn ~ " ).Int( aNoConnect->GetPosition().x, 4 ).Char( ' ' )
+       .Int( aNoConnect->GetPosition().y, 4 ).Char( '\n' );
+    out.Flush();
 }
 
 
@@ -1960,9 +1966,13 @@ void SCH_LEGACY_PLUGIN::saveLine( SCH_LINE* aLine )
     else if( aLine->GetLayer() == LAYER_BUS )
         layer = "Bus";
 
-    m_out->Print( 0, "Wire %s %s\n", layer, width );
-    m_out->Print( 0, "\t%-4d %-4d %-4d %-4d\n", aLine->GetStartPoint().x, aLine->GetStartPoint().y,
-                  aLine->GetEndPoint().x, aLine->GetEndPoint().y );
+    // The wires are the bulk of the schematics: no printf() style formatting
+    FORMAT_BUFFER out( m_out );
+
+    out.Text( "Wire " ).Text( layer ).Char( ' ' ).Text( width ).Text( "\n\t" );
+    out.Int( aLine->GetStartPoint().x, 4 ).Char( ' ' ).Int( aLine->GetStartPoint().y, 4 ).Char( ' ' );
+    out.Int( aLine->GetEndPoint().x, 4 ).Char( ' ' ).Int( aLine->GetEndPoint().y, 4 ).Char( '\n' );
+    out.Flush();
 }
 
 
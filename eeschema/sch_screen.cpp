@@ -53,6 +53,9 @@
 #include <sch_component.h>
 #include <sch_text.h>
 #include <lib_pin.h>
+#include <sch_item_index.h>
+
+#include <algorithm>
 
 
 #define EESCHEMA_FILE_STAMP   "EESchema"
@@ -92,12 +95,17 @@ static GRID_TYPE SchematicGridList[] = {
 };
 
 
+unsigned SCH_SCREEN::s_lastRevision = 0;
+
+
 SCH_SCREEN::SCH_SCREEN( KIWAY* aKiway ) :
     BASE_SCREEN( SCH_SCREEN_T ),
     KIWAY_HOLDER( aKiway ),
     m_paper( wxT( "A4" ) )
 {
     m_modification_sync = 0;
+    m_itemIndex = new SCH_ITEM_INDEX;
+    NewRevision();
 
     SetZoom( 32 );
 
@@ -121,6 +129,7 @@ SCH_SCREEN::~SCH_SCREEN()
 {
     ClearUndoRedoList();
     FreeDrawList();
+    delete m_itemIndex;
 }
 
 
@@ -149,15 +158,75 @@ void SCH_SCREEN::Clear()
 }
 
 
+SCH_ITEM_INDEX& SCH_SCREEN::itemIndex() const
+{
+    if( !m_itemIndex->IsCurrent( m_revision ) )
+        m_itemIndex->Build( m_drawList.begin(), m_revision );
+
+    return *m_itemIndex;
+}
+
+
+bool SCH_SCREEN::isIndexCurrent() const
+{
+    return m_itemIndex->IsCurrent( m_revision );
+}
+
+
+void SCH_SCREEN::Append( SCH_ITEM* aItem )
+{
+    bool indexed = isIndexCurrent();
+
+    m_drawList.Append( aItem );
+    --m_modification_sync;
+    NewRevision();
+
+    if( indexed )
+    {
+        m_itemIndex->Add( aItem );
+        m_itemIndex->SetRevision( m_revision );
+    }
+}
+
+
+void SCH_SCREEN::Append( DLIST< SCH_ITEM >& aList )
+{
+    bool indexed = isIndexCurrent();
+    SCH_ITEM* first = aList.begin();
+
+    m_drawList.Append( aList );
+    --m_modification_sync;
+    NewRevision();
+
+    if( indexed )
+    {
+        for( SCH_ITEM* item = first; item; item = item->Next() )
+            m_itemIndex->Add( item );
+
+        m_itemIndex->SetRevision( m_revision );
+    }
+}
+
+
 void SCH_SCREEN::FreeDrawList()
 {
     m_drawList.DeleteAll();
+    NewRevision();
 }
 
 
 void SCH_SCREEN::Remove( SCH_ITEM* aItem )
 {
+    bool indexed = isIndexCurrent();
+
     m_drawList.Remove( aItem );
+    NewRevision();
+
+    if( indexed )
+    {
+        m_itemIndex->Remove( aItem );
+        m_itemIndex->SetRevision( m_revision );
+    }
 }
 
 
@@ -169,6 +238,9 @@ void SCH_SCREEN::DeleteItem( SCH_ITEM* aItem )
 
     if( aItem->Type() == SCH_SHEET_PIN_T )
     {
+        // The area of the sheet changes
+        NewRevision();
+
         // This structure is attached to a sheet, get the parent sheet object.
         SCH_SHEET_PIN* sheetPin = (SCH_SHEET_PIN*) aItem;
         SCH_SHEET* sheet = sheetPin->GetParent();
@@ -179,7 +251,16 @@ void SCH_SCREEN::DeleteItem( SCH_ITEM* aItem )
     }
     else
     {
+        bool indexed = isIndexCurrent();
+
+        if( indexed )
+            m_itemIndex->Remove( aItem );
+
         delete m_drawList.Remove( aItem );
+        NewRevision();
+
+        if( indexed )
+            m_itemIndex->SetRevision( m_revision );
     }
 }
 
@@ -202,7 +283,12 @@ bool SCH_SCREEN::CheckIfOnDrawList( SCH_ITEM* aItem )
 
 SCH_ITEM* SCH_SCREEN::GetItem( const wxPoint& aPosition, int aAccuracy, KICAD_T aType ) const
 {
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    std::vector< SCH_ITEM* > candidates;
+
+    // The area of a component contains its fields, the area of a sheet its pins
+    itemIndex().Query( aPosition, aAccuracy, candidates );
+
+    for( SCH_ITEM* item : candidates )
     {
         if( item->HitTest( aPosition, aAccuracy ) && (aType == NOT_USED) )
             return item;
@@ -263,6 +349,8 @@ void SCH_SCREEN::ExtractWires( DLIST< SCH_ITEM >& aList, bool aCreateCopy )
             break;
         }
     }
+
+    NewRevision();
 }
 
 
@@ -289,6 +377,7 @@ void SCH_SCREEN::ReplaceWires( DLIST< SCH_ITEM >& aWireList )
     }
 
     m_drawList.Append( aWireList );
+    NewRevision();
 }
 
 
@@ -297,7 +386,14 @@ void SCH_SCREEN::MarkConnections( SCH_LINE* aSegment )
     wxCHECK_RET( (aSegment) && (aSegment->Type() == SCH_LINE_T),
                  wxT( "Invalid object pointer." ) );
 
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    std::vector< SCH_ITEM* > candidates;
+    EDA_RECT area( aSegment->GetStartPoint(), wxSize( 0, 0 ) );
+
+    // Only the items at the ends of the segment are connected to it
+    area.Merge( aSegment->GetEndPoint() );
+    itemIndex().Query( area, candidates );
+
+    for( SCH_ITEM* item : candidates )
     {
         if( item->GetFlags() & CANDIDATE )
             continue;
@@ -426,41 +522,58 @@ bool SCH_SCREEN::IsTerminalPoint( const wxPoint& aPosition, int aLayer )
 bool SCH_SCREEN::SchematicCleanUp()
 {
     bool      modified = false;
+    std::vector< SCH_ITEM* > candidates;
 
     for( SCH_ITEM* item = m_drawList.begin() ; item; item = item->Next() )
     {
         if( ( item->Type() != SCH_LINE_T ) && ( item->Type() != SCH_JUNCTION_T ) )
             continue;
 
-        bool restart;
+        bool restart = true;
 
-        for( SCH_ITEM* testItem = item->Next(); testItem; testItem = restart ? m_drawList.begin() : testItem->Next() )
+        // Only the items overlapping this one can be merged into it.  The search starts
+        // again once an item is merged, since this one may have grown.
+        while( restart )
         {
             restart = false;
 
-            if( ( item->Type() == SCH_LINE_T ) && ( testItem->Type() == SCH_LINE_T ) )
+            if( item->Type() == SCH_LINE_T )
+                itemIndex().Query( SCH_ITEM_INDEX::ItemArea( item ), candidates );
+            else
+                itemIndex().Query( item->GetPosition(), 0, candidates );
+
+            for( SCH_ITEM* testItem : candidates )
             {
-                SCH_LINE* line = (SCH_LINE*) item;
+                if( testItem == item )
+                    continue;
 
-                if( line->MergeOverlap( (SCH_LINE*) testItem ) )
+                if( ( item->Type() == SCH_LINE_T ) && ( testItem->Type() == SCH_LINE_T ) )
                 {
-                    // Keep the current flags, because the deleted segment can be flagged.
-                    item->SetFlags( testItem->GetFlags() );
-                    DeleteItem( testItem );
-                    restart = true;
-                    modified = true;
+                    SCH_LINE* line = (SCH_LINE*) item;
+
+                    if( line->MergeOverlap( (SCH_LINE*) testItem ) )
+                    {
+                        // Keep the current flags, because the deleted segment can be flagged.
+                        item->SetFlags( testItem->GetFlags() );
+                        DeleteItem( testItem );
+                        itemIndex().Update( item );
+                        restart = true;
+                        modified = true;
+                        break;
+                    }
                 }
-            }
-            else if ( ( ( item->Type() == SCH_JUNCTION_T )
-                      && ( testItem->Type() == SCH_JUNCTION_T ) ) && ( testItem != item ) )
-            {
-                if ( testItem->HitTest( item->GetPosition() ) )
+                else if( ( item->Type() == SCH_JUNCTION_T )
+                         && ( testItem->Type() == SCH_JUNCTION_T ) )
                 {
-                    // Keep the current flags, because the deleted segment can be flagged.
-                    item->SetFlags( testItem->GetFlags() );
-                    DeleteItem( testItem );
-                    restart = true;
-                    modified = true;
+                    if( testItem->HitTest( item->GetPosition() ) )
+                    {
+                        // Keep the current flags, because the deleted segment can be flagged.
+                        item->SetFlags( testItem->GetFlags() );
+                        DeleteItem( testItem );
+                        restart = true;
+                        modified = true;
+                        break;
+                    }
                 }
             }
         }
@@ -550,6 +663,9 @@ void SCH_SCREEN::CheckComponentsToPartsLinks()
             SCH_COMPONENT::ResolveAll( c, libs );
 
             m_modification_sync = mod_hash;     // note the last mod_hash
+
+            // The pins of the components come from their parts
+            NewRevision();
         }
     }
 }
@@ -594,6 +710,15 @@ void SCH_SCREEN::Plot( PLOTTER* aPlotter )
 }
 
 
+void SCH_SCREEN::PushCommandToUndoList( PICKED_ITEMS_LIST* aItem )
+{
+    BASE_SCREEN::PushCommandToUndoList( aItem );
+
+    // The items moved or edited in place are not seen otherwise
+    NewRevision();
+}
+
+
 void SCH_SCREEN::ClearUndoORRedoList( UNDO_REDO_CONTAINER& aList, int aItemCount )
 {
     if( aItemCount == 0 )
@@ -628,11 +753,13 @@ void SCH_SCREEN::ClearDrawingState()
 LIB_PIN* SCH_SCREEN::GetPin( const wxPoint& aPosition, SCH_COMPONENT** aComponent,
                              bool aEndPointOnly ) const
 {
-    SCH_ITEM*       item;
     SCH_COMPONENT*  component = NULL;
     LIB_PIN*        pin = NULL;
+    std::vector< SCH_ITEM* > candidates;
+
+    itemIndex().Query( aPosition, 0, candidates );
 
-    for( item = m_drawList.begin(); item; item = item->Next() )
+    for( SCH_ITEM* item : candidates )
     {
         if( item->Type() != SCH_COMPONENT_T )
             continue;
@@ -701,8 +828,11 @@ SCH_SHEET* SCH_SCREEN::GetSheet( const wxString& aName )
 SCH_SHEET_PIN* SCH_SCREEN::GetSheetLabel( const wxPoint& aPosition )
 {
     SCH_SHEET_PIN* sheetPin = NULL;
+    std::vector< SCH_ITEM* > candidates;
 
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    itemIndex().Query( aPosition, 0, candidates );
+
+    for( SCH_ITEM* item : candidates )
     {
         if( item->Type() != SCH_SHEET_T )
             continue;
@@ -720,10 +850,12 @@ SCH_SHEET_PIN* SCH_SCREEN::GetSheetLabel( const wxPoint& aPosition )
 
 int SCH_SCREEN::CountConnectedItems( const wxPoint& aPos, bool aTestJunctions ) const
 {
-    SCH_ITEM* item;
     int       count = 0;
+    std::vector< SCH_ITEM* > candidates;
+
+    itemIndex().Query( aPos, 0, candidates );
 
-    for( item = m_drawList.begin(); item; item = item->Next() )
+    for( SCH_ITEM* item : candidates )
     {
         if( item->Type() == SCH_JUNCTION_T  && !aTestJunctions )
             continue;
@@ -752,6 +884,9 @@ void SCH_SCREEN::ClearAnnotation( SCH_SHEET_PATH* aSheetPath )
             component->ClearFlags();
         }
     }
+
+    // The units of the components may have been reset
+    NewRevision();
 }
 
 
@@ -834,11 +969,13 @@ void SCH_SCREEN::SelectBlockItems()
 
 void SCH_SCREEN::addConnectedItemsToBlock( const wxPoint& position )
 {
-    SCH_ITEM* item;
     ITEM_PICKER picker;
     bool addinlist = true;
+    std::vector< SCH_ITEM* > candidates;
+
+    itemIndex().Query( position, 0, candidates );
 
-    for( item = m_drawList.begin(); item; item = item->Next() )
+    for( SCH_ITEM* item : candidates )
     {
         picker.SetItem( item );
 
@@ -914,15 +1051,42 @@ int SCH_SCREEN::UpdatePickList()
 
 bool SCH_SCREEN::TestDanglingEnds()
 {
-    SCH_ITEM* item;
     std::vector< DANGLING_END_ITEM > endPoints;
+    std::vector< wxPoint > connections;
+    std::vector< SCH_ITEM* > candidates;
+    std::vector< SCH_ITEM* > neighbours;
     bool hasStateChanged = false;
 
-    for( item = m_drawList.begin(); item; item = item->Next() )
-        item->GetEndPoints( endPoints );
+    // The dangling ends are tested after the items are moved or edited in place, which the
+    // screen does not see: index the items where they are now.
+    m_itemIndex->Build( m_drawList.begin(), m_revision );
 
-    for( item = m_drawList.begin(); item; item = item->Next() )
+    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
     {
+        // An item can only be connected to the items found at its connection points.
+        connections.clear();
+        item->GetConnectionPoints( connections );
+        neighbours.clear();
+
+        for( const wxPoint& connection : connections )
+        {
+            m_itemIndex->Query( connection, 0, candidates );
+            neighbours.insert( neighbours.end(), candidates.begin(), candidates.end() );
+        }
+
+        if( connections.size() > 1 )
+        {
+            // Keep the order of the draw list, in which the end points were listed.
+            m_itemIndex->Sort( neighbours );
+            neighbours.erase( std::unique( neighbours.begin(), neighbours.end() ),
+                              neighbours.end() );
+        }
+
+        endPoints.clear();
+
+        for( SCH_ITEM* neighbour : neighbours )
+            neighbour->GetEndPoints( endPoints );
+
         if( item->IsDanglingStateChanged( endPoints ) )
         {
             hasStateChanged = true;
@@ -938,8 +1102,12 @@ bool SCH_SCREEN::BreakSegment( const wxPoint& aPoint )
     SCH_LINE* segment;
     SCH_LINE* newSegment;
     bool brokenSegments = false;
+    std::vector< SCH_ITEM* > candidates;
 
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    // The new segments start at aPoint and are not broken again
+    itemIndex().Query( aPoint, 0, candidates );
+
+    for( SCH_ITEM* item : candidates )
     {
         if( (item->Type() != SCH_LINE_T) || (item->GetLayer() == LAYER_NOTES) )
             continue;
@@ -954,10 +1122,12 @@ bool SCH_SCREEN::BreakSegment( const wxPoint& aPoint )
         newSegment->SetStartPoint( aPoint );
         segment->SetEndPoint( aPoint );
         m_drawList.Insert( newSegment, segment->Next() );
-        item = newSegment;
         brokenSegments = true;
     }
 
+    if( brokenSegments )
+        NewRevision();
+
     return brokenSegments;
 }
 
@@ -993,7 +1163,11 @@ bool SCH_SCREEN::BreakSegmentsOnJunctions()
 
 int SCH_SCREEN::GetNode( const wxPoint& aPosition, EDA_ITEMS& aList )
 {
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    std::vector< SCH_ITEM* > candidates;
+
+    itemIndex().Query( aPosition, 0, candidates );
+
+    for( SCH_ITEM* item : candidates )
     {
         if( item->Type() == SCH_LINE_T && item->HitTest( aPosition )
             && (item->GetLayer() == LAYER_BUS || item->GetLayer() == LAYER_WIRE) )
@@ -1012,7 +1186,11 @@ int SCH_SCREEN::GetNode( const wxPoint& aPosition, EDA_ITEMS& aList )
 
 SCH_LINE* SCH_SCREEN::GetWireOrBus( const wxPoint& aPosition )
 {
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    std::vector< SCH_ITEM* > candidates;
+
+    itemIndex().Query( aPosition, 0, candidates );
+
+    for( SCH_ITEM* item : candidates )
     {
         if( (item->Type() == SCH_LINE_T) && item->HitTest( aPosition )
             && (item->GetLayer() == LAYER_BUS || item->GetLayer() == LAYER_WIRE) )
@@ -1028,7 +1206,11 @@ SCH_LINE* SCH_SCREEN::GetWireOrBus( const wxPoint& aPosition )
 SCH_LINE* SCH_SCREEN::GetLine( const wxPoint& aPosition, int aAccuracy, int aLayer,
                                SCH_LINE_TEST_T aSearchType )
 {
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    std::vector< SCH_ITEM* > candidates;
+
+    itemIndex().Query( aPosition, aAccuracy, candidates );
+
+    for( SCH_ITEM* item : candidates )
     {
         if( item->Type() != SCH_LINE_T )
             continue;
@@ -1061,7 +1243,11 @@ SCH_LINE* SCH_SCREEN::GetLine( const wxPoint& aPosition, int aAccuracy, int aLay
 
 SCH_TEXT* SCH_SCREEN::GetLabel( const wxPoint& aPosition, int aAccuracy )
 {
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    std::vector< SCH_ITEM* > candidates;
+
+    itemIndex().Query( aPosition, aAccuracy, candidates );
+
+    for( SCH_ITEM* item : candidates )
     {
         switch( item->Type() )
         {
@@ -1132,6 +1318,7 @@ int SCH_SCREEN::GetConnection( const wxPoint& aPosition, PICKED_ITEMS_LIST& aLis
     SCH_ITEM* item;
     EDA_ITEM* tmp;
     EDA_ITEMS list;
+    std::vector< SCH_ITEM* > candidates;
 
     // Clear flags member for all items.
     ClearDrawingState();
@@ -1186,20 +1373,26 @@ int SCH_SCREEN::GetConnection( const wxPoint& aPosition, PICKED_ITEMS_LIST& aLis
 
             /* If the wire start point is connected to a wire that was already found
              * and now is not connected, add the wire to the list. */
-            for( tmp = m_drawList.begin(); tmp; tmp = tmp->Next() )
+            tmp = NULL;
+            itemIndex().Query( segment->GetStartPoint(), 0, candidates );
+
+            for( SCH_ITEM* candidate : candidates )
             {
-                // Ensure tmp is a previously deleted segment:
-                if( ( tmp->GetFlags() & STRUCT_DELETED ) == 0 )
+                // Ensure candidate is a previously deleted segment:
+                if( ( candidate->GetFlags() & STRUCT_DELETED ) == 0 )
                     continue;
 
-                if( tmp->Type() != SCH_LINE_T )
+                if( candidate->Type() != SCH_LINE_T )
                     continue;
 
-                SCH_LINE* testSegment = (SCH_LINE*) tmp;
+                SCH_LINE* testSegment = (SCH_LINE*) candidate;
 
-               // Test for segment connected to the previously deleted segment:
+                // Test for segment connected to the previously deleted segment:
                 if( testSegment->IsEndPoint( segment->GetStartPoint() ) )
+                {
+                    tmp = candidate;
                     break;
+                }
             }
 
             // when tmp != NULL, segment is a new candidate:
@@ -1210,20 +1403,26 @@ int SCH_SCREEN::GetConnection( const wxPoint& aPosition, PICKED_ITEMS_LIST& aLis
 
             /* If the wire end point is connected to a wire that has already been found
              * and now is not connected, add the wire to the list. */
-            for( tmp = m_drawList.begin(); tmp; tmp = tmp->Next() )
+            tmp = NULL;
+            itemIndex().Query( segment->GetEndPoint(), 0, candidates );
+
+            for( SCH_ITEM* candidate : candidates )
             {
-                // Ensure tmp is a previously deleted segment:
-                if( ( tmp->GetFlags() & STRUCT_DELETED ) == 0 )
+                // Ensure candidate is a previously deleted segment:
+                if( ( candidate->GetFlags() & STRUCT_DELETED ) == 0 )
                     continue;
 
-                if( tmp->Type() != SCH_LINE_T )
+                if( candidate->Type() != SCH_LINE_T )
                     continue;
 
-                SCH_LINE* testSegment = (SCH_LINE*) tmp;
+                SCH_LINE* testSegment = (SCH_LINE*) candidate;
 
                 // Test for segment connected to the previously deleted segment:
                 if( testSegment->IsEndPoint( segment->GetEndPoint() ) )
+                {
+                    tmp = candidate;
                     break;
+                }
             }
 
             // when tmp != NULL, segment is a new candidate:
@@ -63,6 +63,7 @@
 #include <wildcards_and_files_ext.h>
 
 #include <netlist_exporter_kicad.h>
+#include <class_netlist_object.h>
 #include <kiway.h>
 
 
@@ -363,6 +364,8 @@ SCH_EDIT_FRAME::SCH_EDIT_FRAME( KIWAY* aKiway, wxWindow* aParent ):
     m_dlgFindReplace = NULL;
     m_findReplaceData = new wxFindReplaceData( wxFR_DOWN );
     m_undoItem = NULL;
+    m_netlistCache = new NETLIST_SHEET_CACHE();
+    m_netlistLibHash = 0;
     m_hasAutoSave = true;
 
     SetForceHVLines( true );
@@ -458,11 +461,13 @@ SCH_EDIT_FRAME::~SCH_EDIT_FRAME()
     delete m_undoItem;
     delete g_RootSheet;
     delete m_findReplaceData;
+    delete m_netlistCache;
 
     m_CurrentSheet = NULL;
     m_undoItem = NULL;
     g_RootSheet = NULL;
     m_findReplaceData = NULL;
+    m_netlistCache = NULL;
 }
 
 
@@ -772,6 +777,7 @@ void SCH_EDIT_FRAME::OnModify()
 {
     GetScreen()->SetModify();
     GetScreen()->SetSave();
+    GetScreen()->NewRevision();
 
     m_foundItems.SetForceSearch();
 
@@ -64,6 +64,7 @@ class DIALOG_SCH_FIND;
 class wxFindDialogEvent;
 class wxFindReplaceData;
 class SCHLIB_FILTER;
+class NETLIST_SHEET_CACHE;
 
 
 /// enum used in RotationMiroir()
@@ -141,6 +142,9 @@ private:
     int                     m_repeatLabelDelta;   ///< Repeat label number increment step.
     SCH_COLLECTOR           m_collectedItems;     ///< List of collected items.
     SCH_FIND_COLLECTOR      m_foundItems;         ///< List of find/replace items.
+    NETLIST_SHEET_CACHE*    m_netlistCache;       ///< The netlist items of the sheets, kept
+                                                  ///< from a netlist to the next one.
+    int                     m_netlistLibHash;     ///< The libraries of m_netlistCache items.
     SCH_ITEM*               m_undoItem;           ///< Copy of the current item being edited.
     wxString                m_simulatorCommand;   ///< Command line used to call the circuit
                                                   ///< simulator (gnucap, spice, ...)
@@ -637,10 +641,12 @@ public:
      * Function SetCurrentSheetHighlightFlags
      * Set/reset the BRIGHTENED of connected objects inside the current sheet,
      * according to the highligthed net name.
+     * @param aNetListItems = the netlist items of the schematic if they were just built,
+     * NULL to build them
      * @return true if the flags are correctly set, and false if something goes wrong
      * (duplicate sheet names)
      */
-    bool SetCurrentSheetHighlightFlags();
+    bool SetCurrentSheetHighlightFlags( NETLIST_OBJECT_LIST* aNetListItems = NULL );
 
     /**
      * Function GetUniqueFilenameForCurrentSheet
@@ -39,6 +39,7 @@
 class BOARD;
 class BOARD_ITEM_CONTAINER;
 class EDA_DRAW_PANEL;
+class FORMAT_BUFFER;
 
 
 /**
@@ -338,6 +339,14 @@ public:
 
     static std::string FormatInternalUnits( const wxSize& aSize );
 
+    /**
+     * Function FormatInternalUnits
+     * adds to @a aBuffer the text the std::string version returns, without allocating it.
+     */
+    static FORMAT_BUFFER& FormatInternalUnits( FORMAT_BUFFER& aBuffer, int aValue );
+
+    static FORMAT_BUFFER& FormatInternalUnits( FORMAT_BUFFER& aBuffer, const wxPoint& aPoint );
+
     virtual void ViewGetLayers( int aLayers[], int& aCount ) const override;
 };
 
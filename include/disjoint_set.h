@@ -0,0 +1,123 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef DISJOINT_SET_H
+#define DISJOINT_SET_H
+
+#include <utility>
+#include <vector>
+
+/**
+ * Class DISJOINT_SET
+ *
+ * A union-find structure over the elements 0 .. Size() - 1, kept in flat arrays. Find()
+ * compresses the paths it walks and Union() links by rank, so a sequence of operations
+ * runs in nearly linear time.
+ */
+class DISJOINT_SET
+{
+public:
+    DISJOINT_SET( int aSize = 0 )
+    {
+        Reset( aSize );
+    }
+
+    /**
+     * Function Reset
+     * makes aSize singleton sets, reusing the memory already allocated.
+     */
+    void Reset( int aSize )
+    {
+        m_parent.resize( aSize );
+        m_rank.assign( aSize, 0 );
+
+        for( int i = 0; i < aSize; i++ )
+            m_parent[i] = i;
+    }
+
+    /**
+     * Function Add
+     * adds a singleton set.
+     * @return the new element
+     */
+    int Add()
+    {
+        int element = m_parent.size();
+
+        m_parent.push_back( element );
+        m_rank.push_back( 0 );
+
+        return element;
+    }
+
+    int Size() const
+    {
+        return m_parent.size();
+    }
+
+    /**
+     * Function Find
+     * @return the representative element of the set containing aElement.
+     */
+    int Find( int aElement )
+    {
+        // Path halving: each element visited is linked to its grandparent
+        while( m_parent[aElement] != aElement )
+        {
+            m_parent[aElement] = m_parent[ m_parent[aElement] ];
+            aElement = m_parent[aElement];
+        }
+
+        return aElement;
+    }
+
+    /**
+     * Function Union
+     * merges the sets containing aA and aB.
+     * @return false if they were already in the same set.
+     */
+    bool Union( int aA, int aB )
+    {
+        aA = Find( aA );
+        aB = Find( aB );
+
+        if( aA == aB )
+            return false;
+
+        if( m_rank[aA] < m_rank[aB] )
+            std::swap( aA, aB );
+
+        m_parent[aB] = aA;
+
+        if( m_rank[aA] == m_rank[aB] )
+            m_rank[aA]++;
+
+        return true;
+    }
+
+private:
+    std::vector<int>            m_parent;
+    std::vector<unsigned char>  m_rank;
+};
+
+#endif  // DISJOINT_SET_H
@@ -107,6 +107,7 @@ protected:
 
     int                 curTok;                 ///< the current token obtained on last NextTok()
     std::string         curText;                ///< the text of the current token
+    std::string         curLine;                ///< the current line for CurLine(), if read in place
 
     const KEYWORD*      keywords;               ///< table sorted by CMake for bsearch()
     unsigned            keywordCount;           ///< count of keywords table
@@ -118,13 +119,15 @@ protected:
     {
         if( reader )
         {
-            reader->ReadLine();
+            unsigned len;
 
-            unsigned len = reader->Length();
+            // The line may be left where the reader holds it, not nul terminated.
+            start = reader->ReadLineInPlace( &len );
 
             // start may have changed in ReadLine(), which can resize and
             // relocate reader's line buffer.
-            start = reader->Line();
+            if( !start )
+                start = reader->Line();
 
             next  = start;
             limit = next + len;
@@ -514,10 +517,7 @@ public:
      * returns the current line of text, from which the CurText() would return
      * its token.
      */
-    const char* CurLine()
-    {
-        return (const char*)(*reader);
-    }
+    const char* CurLine();
 
     /**
      * Function CurFilename
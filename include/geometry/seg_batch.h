@@ -0,0 +1,122 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __SEG_BATCH_H
+#define __SEG_BATCH_H
+
+#include <cstdint>
+
+#include <math/vector2d.h>
+#include <geometry/seg.h>
+
+/**
+ * Class SEG_BATCH
+ *
+ * Skips the segments of a polyline which are too far from a query segment to collide
+ * with it, several segments at a time, so that the exact (and much slower) tests of SEG
+ * only run on the remaining ones.
+ *
+ * A segment is skipped when its bounding box is at the query distance or farther from
+ * the bounding box of the query segment along the x or the y axis. Every segment closer
+ * than the query distance to the query segment is kept, whatever the rounding of the
+ * exact tests:
+ * - SEG::Collide( aQuery, aDistance ) as filtered by SHAPE_LINE_CHAIN::Collide(), which
+ *   only tests the segments whose bounding box is closer than aDistance,
+ * - SEG::Distance( aQuery.A ) < aDistance, for a point query (aQuery.A == aQuery.B), as
+ *   long as aDistance is below 2^26.
+ *
+ * The segments are compared in 32 bit lanes with AVX2 or SSE2, depending on the processor,
+ * or one by one in 64 bit integers when the query bounds do not fit in 32 bits. All the
+ * kernels skip exactly the same segments.
+ *
+ * Only the skipping is batched. The distances are still computed by SEG, one segment at a
+ * time: they are products of 64 bit coordinates differences, which SSE2 and AVX2 cannot
+ * multiply, and the collision results must not change by a single unit.
+ */
+class SEG_BATCH
+{
+public:
+    enum KERNEL
+    {
+        KERNEL_SCALAR = 0,
+        KERNEL_SSE2,
+        KERNEL_AVX2
+    };
+
+    /**
+     * Constructor
+     * @param aQuery is the query segment, or point if both ends are the same.
+     * @param aDistance is the distance the segments must be closer than. No segment is
+     * skipped if it is not positive.
+     */
+    SEG_BATCH( const SEG& aQuery, int aDistance );
+
+    /**
+     * Function NextCandidate
+     * returns the index of the first segment [aPoints[i], aPoints[i + 1]] not skipped,
+     * with aFirst <= i < aLast, or aLast if all of them are skipped.
+     */
+    int NextCandidate( const VECTOR2I* aPoints, int aFirst, int aLast ) const;
+
+    /**
+     * Function Skips
+     * tells if the segment [aA, aB] is skipped.
+     */
+    bool Skips( const VECTOR2I& aA, const VECTOR2I& aB ) const
+    {
+        return m_enabled && ( !keepsAxis( aA.x, aB.x, 0 ) || !keepsAxis( aA.y, aB.y, 1 ) );
+    }
+
+    /**
+     * Function SetKernel
+     * selects the kernel used by all the batches, for the tests and the benchmarks.
+     * A kernel the processor does not support is replaced by the best one it supports.
+     */
+    static void SetKernel( KERNEL aKernel );
+
+    static KERNEL GetKernel();
+
+    ///> The fastest kernel the processor supports
+    static KERNEL BestKernel();
+
+private:
+    bool keepsAxis( int64_t aA, int64_t aB, int aAxis ) const
+    {
+        return ( aA > m_lo[aAxis] || aB > m_lo[aAxis] ) && ( aA < m_hi[aAxis] || aB < m_hi[aAxis] );
+    }
+
+    int nextScalar( const VECTOR2I* aPoints, int aFirst, int aLast ) const;
+
+    ///> The segments with both ends at or below m_lo, or at or above m_hi, on an axis are
+    ///> skipped
+    int64_t m_lo[2];
+    int64_t m_hi[2];
+
+    ///> false if no segment can be skipped
+    bool    m_enabled;
+
+    ///> true if the bounds can be compared in 32 bit lanes
+    bool    m_fitsInt32;
+};
+
+#endif // __SEG_BATCH_H
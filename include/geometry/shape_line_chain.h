@@ -26,6 +26,7 @@
 #ifndef __SHAPE_LINE_CHAIN
 #define __SHAPE_LINE_CHAIN
 
+#include <cstdint>
 #include <vector>
 #include <sstream>
 
@@ -35,6 +36,8 @@
 #include <geometry/shape.h>
 #include <geometry/seg.h>
 
+class SEG_BATCH;
+
 /**
  * Class SHAPE_LINE_CHAIN
  *
@@ -73,14 +76,15 @@ public:
      * Initializes an empty line chain.
      */
     SHAPE_LINE_CHAIN() :
-        SHAPE( SH_LINE_CHAIN ), m_closed( false )
+        SHAPE( SH_LINE_CHAIN ), m_closed( false ), m_version( 0 )
     {}
 
     /**
      * Copy Constructor
      */
     SHAPE_LINE_CHAIN( const SHAPE_LINE_CHAIN& aShape ) :
-        SHAPE( SH_LINE_CHAIN ), m_points( aShape.m_points ), m_closed( aShape.m_closed )
+        SHAPE( SH_LINE_CHAIN ), m_points( aShape.m_points ), m_closed( aShape.m_closed ),
+        m_version( aShape.m_version )
     {}
 
     /**
@@ -88,7 +92,7 @@ public:
      * Initializes a 2-point line chain (a single segment)
      */
     SHAPE_LINE_CHAIN( const VECTOR2I& aA, const VECTOR2I& aB ) :
-        SHAPE( SH_LINE_CHAIN ), m_closed( false )
+        SHAPE( SH_LINE_CHAIN ), m_closed( false ), m_version( newVersion() )
     {
         m_points.resize( 2 );
         m_points[0] = aA;
@@ -96,7 +100,7 @@ public:
     }
 
     SHAPE_LINE_CHAIN( const VECTOR2I& aA, const VECTOR2I& aB, const VECTOR2I& aC ) :
-        SHAPE( SH_LINE_CHAIN ), m_closed( false )
+        SHAPE( SH_LINE_CHAIN ), m_closed( false ), m_version( newVersion() )
     {
         m_points.resize( 3 );
         m_points[0] = aA;
@@ -105,7 +109,7 @@ public:
     }
 
     SHAPE_LINE_CHAIN( const VECTOR2I& aA, const VECTOR2I& aB, const VECTOR2I& aC, const VECTOR2I& aD ) :
-        SHAPE( SH_LINE_CHAIN ), m_closed( false )
+        SHAPE( SH_LINE_CHAIN ), m_closed( false ), m_version( newVersion() )
     {
         m_points.resize( 4 );
         m_points[0] = aA;
@@ -117,7 +121,8 @@ public:
 
     SHAPE_LINE_CHAIN( const VECTOR2I* aV, int aCount ) :
         SHAPE( SH_LINE_CHAIN ),
-        m_closed( false )
+        m_closed( false ),
+        m_version( newVersion() )
     {
         m_points.resize( aCount );
 
@@ -138,6 +143,7 @@ public:
     {
         m_points.clear();
         m_closed = false;
+        changed();
     }
 
     /**
@@ -150,6 +156,7 @@ public:
     void SetClosed( bool aClosed )
     {
         m_closed = aClosed;
+        changed();
     }
 
     /**
@@ -240,6 +247,9 @@ public:
         if( aIndex < 0 )
             aIndex += PointCount();
 
+        // The point may be changed through the reference
+        changed();
+
         return m_points[aIndex];
     }
 
@@ -292,6 +302,14 @@ public:
      */
     bool Collide( const SEG& aSeg, int aClearance = 0 ) const override;
 
+    /**
+     * Function NextCandidateSegment()
+     *
+     * Returns the index of the first segment from aFirst on which is not skipped by aBatch,
+     * or SegmentCount() if there is none.
+     */
+    int NextCandidateSegment( const SEG_BATCH& aBatch, int aFirst ) const;
+
     /**
      * Function Distance()
      *
@@ -351,6 +369,7 @@ public:
         {
             m_points.push_back( aP );
             m_bbox.Merge( aP );
+            changed();
         }
     }
 
@@ -378,11 +397,14 @@ public:
             m_points.push_back( p );
             m_bbox.Merge( p );
         }
+
+        changed();
     }
 
     void Insert( int aVertex, const VECTOR2I& aP )
     {
         m_points.insert( m_points.begin() + aVertex, aP );
+        changed();
     }
 
     /**
@@ -593,6 +615,8 @@ public:
     {
         for( std::vector<VECTOR2I>::iterator i = m_points.begin(); i != m_points.end(); ++i )
             (*i) += aVector;
+
+        changed();
     }
 
     bool IsSolid() const override
@@ -604,13 +628,37 @@ public:
 
     double Area() const;
 
+    /**
+     * Function Version()
+     *
+     * @return a number which changes with every change of the line chain, and which no
+     * other chain has, except its copies as long as neither is changed. The empty chains
+     * which were never changed have the version 0.
+     */
+    uint64_t Version() const
+    {
+        return m_version;
+    }
+
 private:
+    /// gives a version no chain had before
+    static uint64_t newVersion();
+
+    /// to be called by every change of the points or of the closed flag
+    void changed()
+    {
+        m_version = newVersion();
+    }
+
     /// array of vertices
     std::vector<VECTOR2I> m_points;
 
     /// is the line chain closed?
     bool m_closed;
 
+    /// the version of the points and closed flag, see Version()
+    uint64_t m_version;
+
     /// cached bounding box
     BOX2I m_bbox;
 };
@@ -28,11 +28,13 @@
 
 #include <vector>
 #include <cstdio>
+#include <memory>
 #include <geometry/shape.h>
 #include <geometry/shape_line_chain.h>
 
 #include "clipper.hpp"
 
+class SHAPE_POLY_SET_INDEX;
 
 /**
  * Class SHAPE_POLY_SET
@@ -48,7 +50,14 @@
  *      outline or a hole.
  *      - Vertex (or corner): each one of the points that define a contour.
  *
- * TODO: add convex partitioning & spatial index
+ * The point queries (Contains(), PointOnEdge(), CollideVertex(), CollideEdge() and
+ * IsNearEdge()) of large sets use a SHAPE_POLY_SET_INDEX, built on the first query. The
+ * changes of the set drop the index, and each query checks it against the versions of the
+ * contours (see SHAPE_LINE_CHAIN::Version()), so the contours may also be changed through
+ * references to them, kept across queries. Only a reference to a single vertex must not be
+ * kept across a query to change the vertex after it.
+ *
+ * TODO: add convex partitioning
  */
 class SHAPE_POLY_SET : public SHAPE
 {
@@ -163,7 +172,8 @@ class SHAPE_POLY_SET : public SHAPE
 
             T& Get()
             {
-                return m_poly->Polygon( m_currentPolygon )[m_currentContour].Point( m_currentVertex );
+                return point( m_poly->m_polys[m_currentPolygon][m_currentContour],
+                              (T*) nullptr );
             }
 
             T& operator*()
@@ -195,6 +205,18 @@ class SHAPE_POLY_SET : public SHAPE
         private:
             friend class SHAPE_POLY_SET;
 
+            ///> The current vertex of aChain: only the iterators of non-const sets may
+            ///> change it, the others do not change the version of the chain
+            VECTOR2I& point( SHAPE_LINE_CHAIN& aChain, VECTOR2I* )
+            {
+                return aChain.Point( m_currentVertex );
+            }
+
+            const VECTOR2I& point( const SHAPE_LINE_CHAIN& aChain, const VECTOR2I* )
+            {
+                return aChain.CPoint( m_currentVertex );
+            }
+
             SHAPE_POLY_SET* m_poly;
             int m_currentPolygon;
             int m_currentContour;
@@ -285,7 +307,7 @@ class SHAPE_POLY_SET : public SHAPE
 
             T Get()
             {
-                return m_poly->Polygon( m_currentPolygon )[m_currentContour].Segment( m_currentSegment );
+                return m_poly->m_polys[m_currentPolygon][m_currentContour].Segment( m_currentSegment );
             }
 
             T operator*()
@@ -719,11 +741,22 @@ class SHAPE_POLY_SET : public SHAPE
          * simple polygon, but calculations can be really significantly time consuming
          * Most of time PM_FAST is preferable.
          * PM_STRICTLY_SIMPLE can be used in critical cases (Gerber output for instance)
+         * The _PARTITIONED modes split the operands into groups of polygons whose bounding boxes
+         * do not touch, and process the groups in parallel. They are worth it for large sets
+         * of many separate polygons, even on a single thread, as Clipper is slower than linear
+         * in the number of edges. They cover the same areas, but not with exactly the same
+         * polygons: the polygons come in another order, and as Clipper rounds the intersections
+         * at the scan lines of all the polygons it is given, a vertex may move by one unit.
+         * So they are only for the callers asking for them, never a default. Below 2000
+         * vertices, or when the polygons cannot be split, they give the same polygons as the
+         * other modes.
          */
         enum POLYGON_MODE
         {
             PM_FAST = true,
-            PM_STRICTLY_SIMPLE = false
+            PM_STRICTLY_SIMPLE = false,
+            PM_FAST_PARTITIONED = 3,
+            PM_STRICTLY_SIMPLE_PARTITIONED = 2
         };
 
         ///> Performs boolean polyset union
@@ -738,6 +771,10 @@ class SHAPE_POLY_SET : public SHAPE
         ///> For aFastMode meaning, see function booleanOp
         void BooleanIntersection( const SHAPE_POLY_SET& b, POLYGON_MODE aFastMode );
 
+        ///> Performs boolean polyset exclusive or: keeps the areas covered by only one set
+        ///> For aFastMode meaning, see function booleanOp
+        void BooleanXor( const SHAPE_POLY_SET& b, POLYGON_MODE aFastMode );
+
         ///> Performs boolean polyset union between a and b, store the result in it self
         ///> For aFastMode meaning, see function booleanOp
         void BooleanAdd( const SHAPE_POLY_SET& a, const SHAPE_POLY_SET& b,
@@ -754,13 +791,20 @@ class SHAPE_POLY_SET : public SHAPE
                                   POLYGON_MODE aFastMode );
 
         ///> Performs outline inflation/deflation, using round corners.
-        void Inflate( int aFactor, int aCircleSegmentsCount );
+        ///> With a _PARTITIONED aMode, the groups of polygons too far apart to merge are
+        ///> inflated in parallel
+        void Inflate( int aFactor, int aCircleSegmentsCount, POLYGON_MODE aMode = PM_FAST );
 
         ///> Converts a set of polygons with holes to a singe outline with "slits"/"fractures" connecting the outer ring
         ///> to the inner holes
         ///> For aFastMode meaning, see function booleanOp
         void Fracture( POLYGON_MODE aFastMode );
 
+        ///> Same as Fracture(), for a set already simplified: each polygon is fractured in place,
+        ///> so polygon i of the set gives outline i of the result
+        ///> With a _PARTITIONED aMode, the polygons are fractured in parallel
+        void FractureSimplified( POLYGON_MODE aMode = PM_FAST );
+
         ///> Returns true if the polygon set has any holes.
         bool HasHoles() const;
 
@@ -830,7 +874,7 @@ class SHAPE_POLY_SET : public SHAPE
          * @return bool - true if there is a collision, false in any other case.
          */
         bool CollideVertex( const VECTOR2I& aPoint, VERTEX_INDEX& aClosestVertex,
-                int aClearance = 0 );
+                int aClearance = 0 ) const;
 
         /**
          * Function CollideEdge
@@ -843,7 +887,15 @@ class SHAPE_POLY_SET : public SHAPE
          * @return bool - true if there is a collision, false in any other case.
          */
         bool CollideEdge( const VECTOR2I& aPoint, VERTEX_INDEX& aClosestVertex,
-                int aClearance = 0 );
+                int aClearance = 0 ) const;
+
+        /**
+         * Function IsNearEdge
+         * tells whether aPoint is at aDistance or less from an edge of one of the contours,
+         * comparing the squared distances: unlike CollideEdge(), which rounds the distances
+         * down, a point even a fraction of a unit farther than aDistance is not near.
+         */
+        bool IsNearEdge( const VECTOR2I& aPoint, int aDistance ) const;
 
         ///> Returns true if a given subpolygon contains the point aP. If aSubpolyIndex < 0
         ///> (default value), checks all polygons in the set
@@ -992,6 +1044,21 @@ class SHAPE_POLY_SET : public SHAPE
         void fractureSingle( POLYGON& paths );
         void importTree( ClipperLib::PolyTree* tree );
 
+        ///> Appends the polygons of tree to aPolys
+        void appendTree( ClipperLib::PolyTree* tree, std::vector<POLYGON>& aPolys );
+
+        ///> Returns true if aMode is one of the _PARTITIONED modes
+        static bool isPartitioned( POLYGON_MODE aMode )
+        {
+            return aMode & 2;
+        }
+
+        ///> Returns true if aMode gives strictly simple polygons
+        static bool isStrictlySimple( POLYGON_MODE aMode )
+        {
+            return !( aMode & PM_FAST );
+        }
+
         /** Function booleanOp
          * this is the engine to execute all polygon boolean transforms
          * (AND, OR, ... and polygon simplification (merging overlaping  polygons)
@@ -1010,6 +1077,20 @@ class SHAPE_POLY_SET : public SHAPE
                         const SHAPE_POLY_SET& aShape,
                         const SHAPE_POLY_SET& aOtherShape, POLYGON_MODE aFastMode );
 
+        /**
+         * Function booleanOpPartitioned
+         * is booleanOp() for the _PARTITIONED modes: the polygons of both operands are split
+         * into groups whose bounding boxes do not touch each other, and each group is given
+         * to its own Clipper, in parallel. The polygons of a group cannot cross, touch or
+         * contain the ones of the other groups, so the results of the groups, put together,
+         * cover the area of the result of the whole operation.
+         * @return false if there are not enough polygons to split, the set being left as it
+         * is.
+         */
+        bool booleanOpPartitioned( ClipperLib::ClipType aType,
+                                   const SHAPE_POLY_SET& aShape,
+                                   const SHAPE_POLY_SET& aOtherShape, POLYGON_MODE aFastMode );
+
         bool pointInPolygon( const VECTOR2I& aP, const SHAPE_LINE_CHAIN& aPath ) const;
 
         const ClipperLib::Path convertToClipper( const SHAPE_LINE_CHAIN& aPath, bool aRequiredOrientation );
@@ -1023,10 +1104,30 @@ class SHAPE_POLY_SET : public SHAPE
          *                       the aSubpolyIndex-th polygon will be tested.
          * @param  aSubpolyIndex is an integer specifying which polygon in the set has to be
          *                       checked.
+         * @param  aIndex        is the index of the set, or NULL to test all the edges.
          * @return bool - true if aP is inside aSubpolyIndex-th polygon; false in any other
          *         case.
          */
-        bool containsSingle( const VECTOR2I& aP, int aSubpolyIndex ) const;
+        bool containsSingle( const VECTOR2I& aP, int aSubpolyIndex,
+                             const SHAPE_POLY_SET_INDEX* aIndex ) const;
+
+        ///> Returns the index of the set, building it if there is none, or NULL if the set is
+        ///> too small to be worth indexing
+        std::shared_ptr<const SHAPE_POLY_SET_INDEX> index() const;
+
+        ///> Drops the index, before any change of the set
+        void invalidateIndex()
+        {
+            m_index.reset();
+        }
+
+        /**
+         * Function collectEdges
+         * collects the edges which may be at aDistance or less from aP (all of them without
+         * an index), sorted by polygon, contour and index. See SHAPE_POLY_SET_INDEX::QueryEdges().
+         */
+        void collectEdges( const VECTOR2I& aP, int aDistance,
+                           std::vector<VERTEX_INDEX>& aEdges ) const;
 
         /**
          * Operations ChamferPolygon and FilletPolygon are computed under the private chamferFillet
@@ -1059,6 +1160,10 @@ class SHAPE_POLY_SET : public SHAPE
         typedef std::vector<POLYGON> POLYSET;
 
         POLYSET m_polys;
+
+        ///> Shared by the copies of the set, as long as they are not changed. Built from
+        ///> const methods, possibly by several threads at once
+        mutable std::shared_ptr<const SHAPE_POLY_SET_INDEX> m_index;
 };
 
 #endif
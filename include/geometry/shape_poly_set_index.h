@@ -0,0 +1,139 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __SHAPE_POLY_SET_INDEX_H
+#define __SHAPE_POLY_SET_INDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <geometry/shape_poly_set.h>
+
+/**
+ * Class SHAPE_POLY_SET_INDEX
+ *
+ * Splits each contour of a SHAPE_POLY_SET (outlines and holes) into horizontal bands, each
+ * band listing the edges crossing it. The point queries of the set then only test the edges
+ * of the band the point is in, instead of all the edges of the contour.
+ *
+ * The edges are tested the same way as without the index: the index only leaves out the
+ * edges which cannot change the result, so the queries give exactly the same answers.
+ *
+ * The index does not keep any reference to the points: the contours are passed to the
+ * queries, and must be the ones the index was built from. It is built by SHAPE_POLY_SET on
+ * the first query, dropped by the changes of the set, and checked against the versions of
+ * its contours by each query, so that it also follows the changes made to the contours
+ * through references to them.
+ */
+class SHAPE_POLY_SET_INDEX
+{
+public:
+    ///> The sets with less vertices are not worth indexing
+    static const int MinVertexCount = 64;
+
+    SHAPE_POLY_SET_INDEX( const SHAPE_POLY_SET& aSet );
+
+    /**
+     * Function IsValid
+     * tells whether the index is still the one of aSet: the set has the same contours, none
+     * of them changed since the index was built (see SHAPE_LINE_CHAIN::Version()).
+     */
+    bool IsValid( const SHAPE_POLY_SET& aSet ) const;
+
+    /**
+     * Function EdgeCrossing
+     * tests the edge [aA, aB] of a contour for the point in polygon test of aP.
+     * @return -1 if aP lies on the edge, 1 if the edge crosses the horizontal half line
+     * starting at aP and going right, 0 otherwise.
+     */
+    static int EdgeCrossing( const VECTOR2I& aP, const VECTOR2I& aA, const VECTOR2I& aB );
+
+    /**
+     * Function PointInContour
+     * is the point in polygon test of SHAPE_POLY_SET for the contour aContour of the polygon
+     * aPolygon: true if aP is inside of aPath or on one of its edges.
+     */
+    bool PointInContour( const VECTOR2I& aP, int aPolygon, int aContour,
+                         const SHAPE_LINE_CHAIN& aPath ) const;
+
+    /**
+     * Function PointOnContourEdge
+     * is SHAPE_LINE_CHAIN::PointOnEdge() for the contour aContour of the polygon aPolygon.
+     */
+    bool PointOnContourEdge( const VECTOR2I& aP, int aPolygon, int aContour,
+                             const SHAPE_LINE_CHAIN& aPath ) const;
+
+    /**
+     * Function QueryEdges
+     * collects the edges which may be at aDistance or less from aP: all of them are, with
+     * some farther ones. The edge n of a contour goes from its vertex n to the next one, the
+     * last edge closing the contour, whether the contour is closed or not. The edges are
+     * sorted by polygon, then by contour, then by index.
+     */
+    void QueryEdges( const VECTOR2I& aP, int aDistance,
+                     std::vector<SHAPE_POLY_SET::VERTEX_INDEX>& aEdges ) const;
+
+private:
+    struct CONTOUR
+    {
+        ///> The version of the contour the index was built from
+        uint64_t            m_version;
+
+        ///> The bounding box of the contour, as given by SHAPE_LINE_CHAIN::BBox()
+        BOX2I               m_bbox;
+
+        ///> The range of y covered by the vertices
+        int64_t             m_yMin;
+        int64_t             m_yMax;
+
+        ///> The edges of band n are m_edges[m_bandStart[n]] to m_edges[m_bandStart[n + 1] - 1]
+        std::vector<int>    m_bandStart;
+        std::vector<int>    m_edges;
+
+        int bandCount() const
+        {
+            return (int) m_bandStart.size() - 1;
+        }
+
+        int band( int64_t aY ) const
+        {
+            int64_t y = std::min( std::max( aY, m_yMin ), m_yMax );
+
+            return (int) ( ( y - m_yMin ) * bandCount() / ( m_yMax - m_yMin + 1 ) );
+        }
+
+        ///> Calls aFunc( edge ) for the edges of the bands covering aYMin to aYMax, an edge
+        ///> crossing several bands being passed once for each band, until aFunc returns true.
+        ///> Returns true if it did.
+        template <class FUNC>
+        bool forEachEdge( int64_t aYMin, int64_t aYMax, FUNC aFunc ) const;
+    };
+
+    void build( CONTOUR& aContour, const SHAPE_LINE_CHAIN& aPath );
+
+    ///> The contours of each polygon, the outline first
+    std::vector<std::vector<CONTOUR>> m_contours;
+};
+
+#endif // __SHAPE_POLY_SET_INDEX_H
@@ -173,6 +173,20 @@ wxString GetIllegalFileNameWxChars();
  */
 bool ReplaceIllegalFileNameChars( std::string* aName, int aReplaceChar = 0 );
 
+/**
+ * Function ParseDecimal
+ * converts the number at the beginning of \a aText like strtod().  The decimal numbers
+ * KiCad writes, an optional sign then up to 18 digits with an optional decimal point, the
+ * digits making an integer not above 2^53, are converted without strtod(), whatever the
+ * locale, to the value strtod() would give in the "C" locale.  Other numbers, such as the
+ * ones having more digits or an exponent, are left to strtod().
+ *
+ * @param aText is the text of the number.
+ * @param aEnd if not NULL, receives the end of the number, or \a aText if there is none.
+ * @return double - the number, 0.0 if there is none.
+ */
+double ParseDecimal( const char* aText, const char** aEnd = NULL );
+
 #ifndef HAVE_STRTOKR
 // common/strtok_r.c optionally:
 extern "C" char* strtok_r( char* str, const char* delim, char** nextp );
@@ -36,6 +36,7 @@
 // but the errorText needs to be wide char so wxString rules.
 #include <wx/wx.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <ki_exception.h>
 
@@ -120,6 +121,24 @@ public:
      */
     virtual char* ReadLine() = 0;
 
+    /**
+     * Function ReadLineInPlace
+     * reads a line of text like ReadLine(), but a reader which holds all its text may
+     * return the line where it is instead of copying it into the line buffer.  Such a line
+     * is not nul terminated, and is not returned by Line().  It is valid until the reader
+     * is destroyed.
+     * @param aLength receives the number of bytes in the line.
+     * @return const char* - The beginning of the read line, or NULL if EOF.
+     * @throw IO_ERROR when a line is too long.
+     */
+    virtual const char* ReadLineInPlace( unsigned* aLength )
+    {
+        const char* ret = ReadLine();
+
+        *aLength = length;
+        return ret;
+    }
+
     /**
      * Function GetSource
      * returns the name of the source of the lines in an abstract sense.
@@ -247,6 +266,115 @@ public:
 };
 
 
+/**
+ * Class MEMORY_LINE_READER
+ * is a LINE_READER over a text held in memory by someone else, which must outlive it.
+ * ReadLineInPlace() returns the lines where they are, without copying them, for the
+ * DSNLEXER reading large texts such as boards.
+ */
+class MEMORY_LINE_READER : public LINE_READER
+{
+protected:
+    const char*         m_text;     ///< the text read
+    size_t              m_size;     ///< no. bytes in m_text
+    size_t              m_ndx;      ///< offset of the next line in m_text
+
+    /**
+     * Function nextLine
+     * finds the next line of text and increments the line number counter.
+     * @return the length of the line, 0 if EOF.
+     * @throw IO_ERROR when the line is too long.
+     */
+    unsigned nextLine();
+
+public:
+
+    /**
+     * Constructor MEMORY_LINE_READER
+     * @param aText is the text to read, which does not need to be nul terminated.
+     * @param aSize is the number of bytes of @a aText.
+     * @param aSource describes the text for error reporting purposes.
+     * @param aStartingLineNumber is the number of the line before the first line of
+     *  @a aText, for the text taken from a larger one.
+     * @param aMaxLineLength is the maximum number of bytes in a line.
+     */
+    MEMORY_LINE_READER( const char* aText, size_t aSize, const wxString& aSource,
+            unsigned aStartingLineNumber = 0,
+            unsigned aMaxLineLength = LINE_READER_LINE_DEFAULT_MAX );
+
+    char* ReadLine() override;
+
+    const char* ReadLineInPlace( unsigned* aLength ) override;
+
+    /**
+     * Function Text
+     * @return the text read, which is not nul terminated.
+     */
+    const char* Text() const { return m_text; }
+
+    /**
+     * Function Size
+     * @return the number of bytes of Text().
+     */
+    size_t Size() const { return m_size; }
+
+    /**
+     * Function Seek
+     * moves to the line starting at offset @a aOffset of Text(), which is numbered
+     * @a aLineNumber.
+     */
+    void Seek( size_t aOffset, unsigned aLineNumber )
+    {
+        m_ndx = aOffset;
+        lineNum = aLineNumber - 1;
+    }
+
+    /**
+     * Function Rewind
+     * goes back to the beginning of the text and resets the line number back to zero.
+     * Line number will go to 1 on first ReadLine().
+     */
+    void Rewind()
+    {
+        m_ndx = 0;
+        lineNum = 0;
+    }
+};
+
+
+/**
+ * Class MAPPED_FILE_LINE_READER
+ * is a MEMORY_LINE_READER that maps a whole file in memory, where the lines are found
+ * without reading the file byte per byte.  The file is read whole on platforms which
+ * cannot map it.
+ */
+class MAPPED_FILE_LINE_READER : public MEMORY_LINE_READER
+{
+protected:
+    void*               m_map;      ///< the mapped file, if mapped
+    std::vector<char>   m_buffer;   ///< the file, if read
+
+public:
+
+    /**
+     * Constructor MAPPED_FILE_LINE_READER
+     * maps the file @a aFileName, and assumes the obligation to unmap it.
+     *
+     * @param aFileName is the name of the file to map and to use for error reporting purposes.
+     * @param aStartingLineNumber is the initial line number to report on error.  See
+     *  FILE_LINE_READER.
+     * @param aMaxLineLength is the maximum number of bytes in a line.
+     *
+     * @throw IO_ERROR if @a aFileName cannot be opened or read.
+     */
+    MAPPED_FILE_LINE_READER( const wxString& aFileName,
+            unsigned aStartingLineNumber = 0,
+            unsigned aMaxLineLength = LINE_READER_LINE_DEFAULT_MAX );
+
+    ~MAPPED_FILE_LINE_READER();
+};
+
+
 /**
  * Class STRING_LINE_READER
  * is a LINE_READER that reads from a multiline 8 bit wide std::string
@@ -307,6 +435,7 @@ public:
 
 
 #define OUTPUTFMTBUFZ    500        ///< default buffer size for any OUTPUT_FORMATTER
+#define FILEOUTPUTBUFZ   ( 256 * 1024 ) ///< stdio buffer size of a FILE_OUTPUTFORMATTER
 
 /**
  * Class OUTPUTFORMATTER
@@ -332,6 +461,8 @@ class OUTPUTFORMATTER
     int sprint( const char* fmt, ... );
     int vprint( const char* fmt,  va_list ap );
 
+    friend class FORMAT_BUFFER;     // writes its text with write()
+
 
 protected:
     OUTPUTFORMATTER( int aReserve = OUTPUTFMTBUFZ, char aQuoteChar = '"' ) :
@@ -545,4 +676,108 @@ protected:
     //-----</OUTPUTFORMATTER>-----------------------------------------------
 };
 
+
+/**
+ * Class FORMAT_BUFFER
+ * collects text for an OUTPUTFORMATTER without the printf() style formatting of
+ * OUTPUTFORMATTER::Print(), for the large outputs such as the point lists of boards.
+ * The numbers are converted to decimal straight into the buffer, which is written to the
+ * formatter when full and by Flush().
+ * <p>
+ * Flush() must be called before anything else is written to the formatter, and before
+ * the buffer is destroyed.
+ */
+class FORMAT_BUFFER
+{
+public:
+    FORMAT_BUFFER( OUTPUTFORMATTER* aOut ) :
+        m_out( aOut ),
+        m_len( 0 )
+    {
+    }
+
+    /**
+     * Function Indent
+     * adds the indentation of @a aNestLevel, as OUTPUTFORMATTER::Print() does.
+     */
+    FORMAT_BUFFER& Indent( int aNestLevel );
+
+    FORMAT_BUFFER& Text( const char* aText, size_t aCount );
+
+    FORMAT_BUFFER& Text( const char* aText )
+    {
+        return Text( aText, strlen( aText ) );
+    }
+
+    FORMAT_BUFFER& Char( char aChar )
+    {
+        reserve( 1 );
+        m_buf[m_len++] = aChar;
+        return *this;
+    }
+
+    /**
+     * Function Int
+     * adds @a aValue as "%d" would, or as "%-*d" would with @a aWidth.
+     */
+    FORMAT_BUFFER& Int( long long aValue, int aWidth = 0 );
+
+    /**
+     * Function Hex
+     * adds @a aValue as "%lX" would.
+     */
+    FORMAT_BUFFER& Hex( unsigned long long aValue );
+
+    /**
+     * Function Fixed
+     * adds @a aValue divided by 10 to the power of @a aDecimals, see FormatFixed().
+     */
+    FORMAT_BUFFER& Fixed( long long aValue, int aDecimals )
+    {
+        reserve( FIXEDBUFZ );
+        m_len += FormatFixed( m_buf + m_len, aValue, aDecimals );
+        return *this;
+    }
+
+    /**
+     * Function Quotew
+     * adds @a aWrapee quoted and escaped if needed, as OUTPUTFORMATTER::Quotew() does.
+     */
+    FORMAT_BUFFER& Quotew( const wxString& aWrapee );
+
+    /**
+     * Function Flush
+     * writes the collected text to the formatter.
+     * @throw IO_ERROR, if there is a problem outputting, such as a full disk.
+     */
+    void Flush();
+
+    /**
+     * Function FormatFixed
+     * writes in @a aDest, without a nul, @a aValue divided by 10 to the power of
+     * @a aDecimals, without its trailing zeros and without a trailing point.  For the
+     * values of less than 10 significant digits, this is what "%.10g" writes, but for the
+     * small values which "%.10g" writes with an exponent.
+     * @param aDest must have room for FIXEDBUFZ bytes.
+     * @param aDecimals is at most 18.
+     * @return the number of bytes written.
+     */
+    static int FormatFixed( char* aDest, long long aValue, int aDecimals );
+
+    static const int FIXEDBUFZ = 48;
+
+private:
+    static const size_t BUFZ = 8192;
+
+    void reserve( size_t aCount )
+    {
+        if( m_len + aCount > BUFZ )
+            Flush();
+    }
+
+    OUTPUTFORMATTER*    m_out;
+    size_t              m_len;
+    char                m_buf[BUFZ];
+};
+
 #endif // RICHIO_H_
@@ -0,0 +1,146 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Class THREAD_POOL
+ *
+ * A small work-stealing thread pool. Every worker owns a task deque: it pops its own tasks
+ * from the back and, when it runs dry, steals the oldest task from the front of the other
+ * workers' deques. Threads waiting for results (see ParallelFor()) run pending tasks instead
+ * of blocking, so tasks may themselves use the pool without deadlocking.
+ *
+ * Tasks must not touch wxWidgets GUI objects.
+ */
+class THREAD_POOL
+{
+public:
+    typedef std::function<void()> TASK;
+
+    /**
+     * @param aThreadCount number of worker threads, 0 to use one per hardware thread.
+     */
+    THREAD_POOL( unsigned aThreadCount = 0 );
+
+    ~THREAD_POOL();
+
+    /**
+     * Function GetInstance
+     * @return the application wide pool, created on first use.
+     */
+    static THREAD_POOL& GetInstance();
+
+    unsigned GetThreadCount() const
+    {
+        return m_workers.size();
+    }
+
+    /**
+     * Function Submit
+     * queues a callable for asynchronous execution.
+     * @return a future holding the callable's result (or the exception it threw).
+     */
+    template <typename FUNC>
+    auto Submit( FUNC aFunc ) -> std::future<decltype( aFunc() )>
+    {
+        typedef decltype( aFunc() ) RESULT;
+
+        auto task = std::make_shared<std::packaged_task<RESULT()>>( std::move( aFunc ) );
+        std::future<RESULT> result = task->get_future();
+
+        push( [task]() { ( *task )(); } );
+
+        return result;
+    }
+
+    /**
+     * Function Wait
+     * blocks until aFuture is ready, running queued tasks on the calling thread meanwhile.
+     */
+    template <typename T>
+    void Wait( std::future<T>& aFuture )
+    {
+        while( aFuture.wait_for( std::chrono::seconds( 0 ) ) != std::future_status::ready )
+        {
+            if( !RunPendingTask() )
+                aFuture.wait_for( std::chrono::milliseconds( 1 ) );
+        }
+    }
+
+    /**
+     * Function ParallelFor
+     * calls aFunc( i ) for every i in [0, aCount), distributing chunks of aGrain indices
+     * over the workers and the calling thread. Returns when every call has completed.
+     * The first exception thrown by aFunc is rethrown to the caller.
+     */
+    void ParallelFor( size_t aCount, const std::function<void( size_t )>& aFunc,
+                      size_t aGrain = 1 );
+
+    /**
+     * Function RunPendingTask
+     * runs one queued task on the calling thread.
+     * @return false if there was nothing to run.
+     */
+    bool RunPendingTask();
+
+private:
+    struct TASK_DEQUE
+    {
+        std::mutex       m_lock;
+        std::deque<TASK> m_tasks;
+    };
+
+    void push( TASK&& aTask );
+
+    /// Pops from the back of deque aOwn, else steals from the front of another one.
+    bool popTask( int aOwn, TASK& aTask );
+
+    /// @return the index of the worker running the calling thread, or -1.
+    int currentWorker() const;
+
+    void workerLoop( int aIndex );
+
+    std::vector<std::thread>                    m_workers;
+    std::vector<std::unique_ptr<TASK_DEQUE>>    m_deques;
+    std::atomic<unsigned>                       m_nextDeque;
+    std::atomic<size_t>                         m_pending;
+
+    std::mutex                                  m_sleepLock;
+    std::condition_variable                     m_wakeUp;
+    bool                                        m_quit;
+};
+
+#endif  // THREAD_POOL_H
@@ -56,7 +56,6 @@
 #include <math/vector2d.h>
 
 class BOARD_CONNECTED_ITEM;
-class CN_CLUSTER;
 
 namespace ttl
 {
@@ -107,7 +106,7 @@ protected:
 
 public:
     /// Constructor
-    NODE( int aX = 0, int aY = 0, std::shared_ptr<CN_CLUSTER> aCluster = nullptr ) :
+    NODE( int aX = 0, int aY = 0 ) :
 #ifdef TTL_USE_NODE_FLAG
         m_flag( false ),
 #endif
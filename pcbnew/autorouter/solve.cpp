@@ -1321,7 +1321,7 @@ static void AddNewTrace( AUTOROUTER_CONTEXT& ctx )
     {
         ITEM_PICKER picker( track, UR_NEW );
         s_ItemsListPicker.PushItem( picker );
-        ctx.board->m_Track.Insert( track, insertBeforeMe );
+        ctx.board->InsertTrack( track, insertBeforeMe );
     }
 
     DrawTraces( panel, ctx.dc, firstTrack, newCount, GR_OR );
@@ -546,7 +546,7 @@ void PCB_EDIT_FRAME::Block_Delete()
         {
             MODULE* module = (MODULE*) item;
             module->ClearFlags();
-            module->UnLink();
+            m_Pcb->Remove( module );
             m_Pcb->m_Status_Pcb = 0;
         }
         break;
@@ -561,7 +561,7 @@ void PCB_EDIT_FRAME::Block_Delete()
         case PCB_VIA_T:           // a via (like track segment on a copper layer)
         case PCB_DIMENSION_T:     // a dimension (graphic item)
         case PCB_TARGET_T:        // a target (graphic item)
-            item->UnLink();
+            m_Pcb->Remove( item );
             break;
 
         // These items are deleted, but not put in undo list
@@ -646,6 +646,7 @@ void PCB_EDIT_FRAME::Block_Rotate()
         wxASSERT( item );
         item->Rotate( centre, rotAngle );
         GetBoard()->GetConnectivity()->Update( item );
+        GetBoard()->UpdateItemIndex( item );
     }
 
     Compile_Ratsnest( NULL, true );
@@ -672,6 +673,7 @@ void PCB_EDIT_FRAME::Block_Flip()
         itemsList->SetPickedItemStatus( UR_FLIPPED, ii );
         item->Flip( center );
         GetBoard()->GetConnectivity()->Update( item );
+        GetBoard()->UpdateItemIndex( item );
 
         // If a connected item is flipped, the ratsnest is no more OK
         switch( item->Type() )
@@ -727,6 +729,7 @@ void PCB_EDIT_FRAME::Block_Move()
         itemsList->SetPickedItemStatus( UR_MOVED, ii );
         item->Move( MoveVector );
         GetBoard()->GetConnectivity()->Update( item );
+        GetBoard()->UpdateItemIndex( item );
         item->ClearFlags( IS_MOVED );
 
         switch( item->Type() )
@@ -31,7 +31,10 @@
 #include <board_commit.h>
 #include <tools/pcb_tool.h>
 #include <connectivity.h>
+#include <drc_stuff.h>
+#include <zone_obstacle_cache.h>
 
+#include <algorithm>
 #include <functional>
 using namespace std::placeholders;
 
@@ -64,11 +67,23 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry )
     BOARD* board = (BOARD*) m_toolMgr->GetModel();
     PCB_BASE_FRAME* frame = (PCB_BASE_FRAME*) m_toolMgr->GetEditFrame();
     auto connectivity = board->GetConnectivity();
+    ZONE_OBSTACLE_CACHE* obstacles = board->GetZoneObstacleCache();
     std::set<EDA_ITEM*> savedModules;
 
+    // Items to be checked by the live DRC
+    std::vector<BOARD_ITEM*> added, modified, removed;
+
     if( Empty() )
         return;
 
+    // The zones, the ratsnest and the DRC do not depend on the markers: there is nothing
+    // to update for the commits of the markers of the DRC
+    bool markersOnly = std::all_of( m_changes.begin(), m_changes.end(),
+                                    []( const COMMIT_LINE& aEnt )
+                                    {
+                                        return aEnt.m_item->Type() == PCB_MARKER_T;
+                                    } );
+
     for( COMMIT_LINE& ent : m_changes )
     {
         int changeType = ent.m_type & CHT_TYPE;
@@ -121,6 +136,9 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry )
                     if( !( changeFlags & CHT_DONE ) )
                         board->Add( boardItem );
 
+                    added.push_back( boardItem );
+                    obstacles->AddDirtyItem( boardItem );
+
                     //ratsnest->Add( boardItem );       // TODO currently done by BOARD::Add()
 
                     if( boardItem->Type() == PCB_MODULE_T )
@@ -220,6 +238,8 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry )
                     if( !( changeFlags & CHT_DONE ) )
                         board->Remove( boardItem );
 
+                    removed.push_back( boardItem );
+                    obstacles->AddDirtyItem( boardItem );
                     break;
 
                 case PCB_MODULE_T:
@@ -236,6 +256,9 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry )
                     if( !( changeFlags & CHT_DONE ) )
                         board->Remove( module );
 
+                    removed.push_back( module );
+                    obstacles->AddDirtyItem( module );
+
                     // Clear flags to indicate, that the ratsnest, list of nets & pads are not valid anymore
                     board->m_Status_Pcb = 0;
                 }
@@ -267,6 +290,16 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry )
                 view->Update ( boardItem );
                 connectivity->MarkItemNetAsDirty( static_cast<BOARD_ITEM*>( ent.m_copy ) );
                 connectivity->Update( boardItem );
+
+                if( !m_editModules )
+                    board->UpdateItemIndex( boardItem );
+
+                if( !m_editModules )
+                {
+                    modified.push_back( boardItem );
+                    obstacles->AddDirtyItem( boardItem, static_cast<BOARD_ITEM*>( ent.m_copy ) );
+                }
+
                 break;
             }
 
@@ -276,17 +309,38 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry )
         }
     }
 
+    // The pads of the edited modules may have been added, removed or changed
+    for( EDA_ITEM* module : savedModules )
+        board->UpdateItemIndex( static_cast<MODULE*>( module ) );
+
     if( !m_editModules && aCreateUndoEntry )
         frame->SaveCopyInUndoList( undoList, UR_UNSPECIFIED );
 
     if( TOOL_MANAGER* toolMgr = frame->GetToolManager() )
         toolMgr->PostEvent( { TC_MESSAGE, TA_MODEL_CHANGE, AS_GLOBAL } );
 
-    if ( !m_editModules )
+    if ( !m_editModules && !markersOnly )
     {
+        // Drop the zone fill polygons of the changed items
+        for( BOARD_ITEM* item : modified )
+            obstacles->Invalidate( item );
+
+        for( BOARD_ITEM* item : removed )
+            obstacles->Invalidate( item );
+
+        // Refill the zones around the changes, before the ratsnest uses them
+        if( frame->IsType( FRAME_PCB ) )
+            static_cast<PCB_EDIT_FRAME*>( frame )->RefillChangedZones();
+
         auto panel = static_cast<PCB_DRAW_PANEL_GAL*>( frame->GetGalCanvas() );
         connectivity->RecalculateRatsnest();
         panel->RedrawRatsnest();
+
+        if( frame->IsType( FRAME_PCB ) )
+        {
+            DRC* drc = static_cast<PCB_EDIT_FRAME*>( frame )->GetDrcController();
+            drc->UpdateLiveDrc( added, modified, removed );
+        }
     }
 
     frame->OnModify();
@@ -376,6 +430,10 @@ void BOARD_COMMIT::Revert()
 
             view->Add( item );
             connectivity->Add( item );
+
+            if( !m_editModules )
+                board->UpdateItemIndex( item );
+
             delete copy;
             break;
         }
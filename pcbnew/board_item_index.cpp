@@ -0,0 +1,353 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+
+#include <board_item_index.h>
+#include <drc_item_index.h>
+
+
+BOARD_ITEM_INDEX::BOARD_ITEM_INDEX( BOARD* aBoard ) :
+    m_board( aBoard ),
+    m_built( false )
+{
+}
+
+
+BOARD_ITEM_INDEX::~BOARD_ITEM_INDEX()
+{
+}
+
+
+void BOARD_ITEM_INDEX::Invalidate()
+{
+    std::lock_guard<std::mutex> lock( m_lock );
+
+    m_pads.RemoveAll();
+    m_tracks.RemoveAll();
+    m_entries.clear();
+    m_modulePads.clear();
+    m_moduleRanks.Clear();
+    m_trackRanks.Clear();
+    m_pending.clear();
+    m_built = false;
+}
+
+
+void BOARD_ITEM_INDEX::build()
+{
+    m_moduleRanks.Number( m_board->m_Modules );
+    m_trackRanks.Number( m_board->m_Track );
+
+    for( MODULE* module = m_board->m_Modules; module; module = module->Next() )
+        addModulePads( module );
+
+    for( TRACK* track = m_board->m_Track; track; track = track->Next() )
+        addItem( track );
+
+    m_built = true;
+}
+
+
+void BOARD_ITEM_INDEX::updatePending()
+{
+    for( BOARD_ITEM* item : m_pending )
+    {
+        if( item->Type() == PCB_MODULE_T )
+        {
+            removeModulePads( static_cast<MODULE*>( item ) );
+            addModulePads( static_cast<MODULE*>( item ) );
+        }
+        else
+        {
+            addItem( static_cast<BOARD_CONNECTED_ITEM*>( item ) );
+        }
+    }
+
+    m_pending.clear();
+}
+
+
+void BOARD_ITEM_INDEX::addItem( BOARD_CONNECTED_ITEM* aItem )
+{
+    // The area covered by the copper of the item, which contains all the positions
+    // it is hit at
+    ENTRY entry;
+
+    entry.m_bbox = DRC_ITEM_INDEX::ItemBoundingBox( aItem );
+    entry.m_isPad = aItem->Type() == PCB_PAD_T;
+    entry.m_module = NULL;
+    entry.m_padRank = 0;
+
+    removeItem( aItem );
+
+    const int mmin[2] = { entry.m_bbox.GetX(), entry.m_bbox.GetY() };
+    const int mmax[2] = { entry.m_bbox.GetRight(), entry.m_bbox.GetBottom() };
+
+    if( entry.m_isPad )
+    {
+        D_PAD* pad = static_cast<D_PAD*>( aItem );
+        auto& pads = m_modulePads[ pad->GetParent() ];
+
+        entry.m_module = pad->GetParent();
+        entry.m_padRank = pads.size();
+        pads.push_back( pad );
+        m_pads.Insert( mmin, mmax, aItem );
+    }
+    else
+    {
+        m_tracks.Insert( mmin, mmax, aItem );
+    }
+
+    m_entries[aItem] = entry;
+}
+
+
+void BOARD_ITEM_INDEX::removeItem( const BOARD_CONNECTED_ITEM* aItem )
+{
+    auto it = m_entries.find( aItem );
+
+    if( it == m_entries.end() )
+        return;
+
+    const ENTRY& entry = it->second;
+    const int mmin[2] = { entry.m_bbox.GetX(), entry.m_bbox.GetY() };
+    const int mmax[2] = { entry.m_bbox.GetRight(), entry.m_bbox.GetBottom() };
+
+    // The trees only compare the pointers: the pads of a removed module may already
+    // be deleted
+    BOARD_CONNECTED_ITEM* data = const_cast<BOARD_CONNECTED_ITEM*>( aItem );
+
+    if( entry.m_isPad )
+        m_pads.Remove( mmin, mmax, data );
+    else
+        m_tracks.Remove( mmin, mmax, data );
+
+    m_entries.erase( it );
+}
+
+
+void BOARD_ITEM_INDEX::addModulePads( MODULE* aModule )
+{
+    // The pads are ranked in the order of the pad list of the module
+    for( D_PAD* pad = aModule->PadsList(); pad; pad = pad->Next() )
+        addItem( pad );
+}
+
+
+void BOARD_ITEM_INDEX::removeModulePads( const MODULE* aModule )
+{
+    // The pads indexed for the module, which may not be the ones it has now
+    auto it = m_modulePads.find( aModule );
+
+    if( it == m_modulePads.end() )
+        return;
+
+    for( const D_PAD* pad : it->second )
+        removeItem( pad );
+
+    m_modulePads.erase( it );
+}
+
+
+void BOARD_ITEM_INDEX::Add( BOARD_ITEM* aItem )
+{
+    std::lock_guard<std::mutex> lock( m_lock );
+
+    if( !m_built )
+        return;
+
+    // The items are indexed by the next query: their geometry may still be set after
+    // their addition
+    switch( aItem->Type() )
+    {
+    case PCB_MODULE_T:
+        m_moduleRanks.Insert( static_cast<MODULE*>( aItem ) );
+        m_pending.insert( aItem );
+        break;
+
+    case PCB_TRACE_T:
+    case PCB_VIA_T:
+        m_trackRanks.Insert( static_cast<TRACK*>( aItem ) );
+        m_pending.insert( aItem );
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+void BOARD_ITEM_INDEX::Remove( const BOARD_ITEM* aItem )
+{
+    std::lock_guard<std::mutex> lock( m_lock );
+
+    if( !m_built )
+        return;
+
+    switch( aItem->Type() )
+    {
+    case PCB_MODULE_T:
+        removeModulePads( static_cast<const MODULE*>( aItem ) );
+        m_moduleRanks.Remove( static_cast<const MODULE*>( aItem ) );
+        m_pending.erase( const_cast<BOARD_ITEM*>( aItem ) );
+        break;
+
+    case PCB_PAD_T:
+    {
+        const D_PAD* pad = static_cast<const D_PAD*>( aItem );
+        auto entry = m_entries.find( pad );
+
+        if( entry == m_entries.end() )
+            break;
+
+        auto it = m_modulePads.find( entry->second.m_module );
+
+        if( it != m_modulePads.end() )
+        {
+            auto& pads = it->second;
+            pads.erase( std::remove( pads.begin(), pads.end(), pad ), pads.end() );
+        }
+
+        removeItem( pad );
+        break;
+    }
+
+    case PCB_TRACE_T:
+    case PCB_VIA_T:
+        removeItem( static_cast<const BOARD_CONNECTED_ITEM*>( aItem ) );
+        m_trackRanks.Remove( static_cast<const TRACK*>( aItem ) );
+        m_pending.erase( const_cast<BOARD_ITEM*>( aItem ) );
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+void BOARD_ITEM_INDEX::Update( BOARD_ITEM* aItem )
+{
+    std::lock_guard<std::mutex> lock( m_lock );
+
+    if( !m_built )
+        return;
+
+    // A changed item keeps its position in its list, and the pads of a module may have
+    // been added or removed
+    if( aItem->Type() == PCB_PAD_T )
+        aItem = static_cast<D_PAD*>( aItem )->GetParent();
+
+    if( !aItem )
+        return;
+
+    // Only the items of the board lists
+    switch( aItem->Type() )
+    {
+    case PCB_MODULE_T:
+        if( m_moduleRanks.Contains( static_cast<MODULE*>( aItem ) ) )
+            m_pending.insert( aItem );
+
+        break;
+
+    case PCB_TRACE_T:
+    case PCB_VIA_T:
+        if( m_trackRanks.Contains( static_cast<TRACK*>( aItem ) ) )
+            m_pending.insert( aItem );
+
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+void BOARD_ITEM_INDEX::QueryPads( const wxPoint& aPosition, std::vector<D_PAD*>& aPads )
+{
+    std::lock_guard<std::mutex> lock( m_lock );
+
+    if( !m_built )
+        build();
+
+    updatePending();
+
+    const int point[2] = { aPosition.x, aPosition.y };
+
+    aPads.clear();
+
+    auto collect = [&aPads] ( BOARD_CONNECTED_ITEM* aItem ) -> bool
+    {
+        aPads.push_back( static_cast<D_PAD*>( aItem ) );
+        return true;
+    };
+
+    m_pads.Search( point, point, collect );
+
+    // In the order of the modules, then of the pads of a module
+    std::sort( aPads.begin(), aPads.end(), [this] ( const D_PAD* aA, const D_PAD* aB ) -> bool
+            {
+                const ENTRY& a = m_entries.at( aA );
+                const ENTRY& b = m_entries.at( aB );
+                uint64_t rankA = m_moduleRanks.Rank( a.m_module );
+                uint64_t rankB = m_moduleRanks.Rank( b.m_module );
+
+                if( rankA != rankB )
+                    return rankA < rankB;
+
+                return a.m_padRank < b.m_padRank;
+            } );
+}
+
+
+void BOARD_ITEM_INDEX::QueryTracks( const wxPoint& aPosition, std::vector<TRACK*>& aTracks )
+{
+    std::lock_guard<std::mutex> lock( m_lock );
+
+    if( !m_built )
+        build();
+
+    updatePending();
+
+    const int point[2] = { aPosition.x, aPosition.y };
+
+    aTracks.clear();
+
+    auto collect = [&aTracks] ( BOARD_CONNECTED_ITEM* aItem ) -> bool
+    {
+        aTracks.push_back( static_cast<TRACK*>( aItem ) );
+        return true;
+    };
+
+    m_tracks.Search( point, point, collect );
+
+    std::sort( aTracks.begin(), aTracks.end(), [this] ( const TRACK* aA, const TRACK* aB ) -> bool
+            {
+                return m_trackRanks.Rank( aA ) < m_trackRanks.Rank( aB );
+            } );
+}
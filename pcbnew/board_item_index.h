@@ -0,0 +1,157 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef BOARD_ITEM_INDEX_H
+#define BOARD_ITEM_INDEX_H
+
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <class_eda_rect.h>
+#include <geometry/rtree.h>
+#include <list_ranks.h>
+
+class BOARD;
+class BOARD_ITEM;
+class BOARD_CONNECTED_ITEM;
+class MODULE;
+class D_PAD;
+class TRACK;
+
+
+/**
+ * Class BOARD_ITEM_INDEX
+ *
+ * Spatial index of the pads, tracks and vias of a board, used by the position queries of
+ * BOARD (GetPad(), GetLockPoint(), GetTracksByPosition(), GetVisibleTrack()...).
+ *
+ * The board keeps it up to date in BOARD::Add() and BOARD::Remove(). The items changed in
+ * place are given to BOARD::UpdateItemIndex() by the commits and the undo/redo, before or
+ * after their change: they are indexed again by the next query. The index is built on the
+ * first query following its creation or its invalidation, after a load.
+ *
+ * The queries return the candidates in the order of the board lists, so that the first
+ * matching one is the item a walk of the lists would find first: the modules and tracks
+ * are ranked in their lists (LIST_RANKS) when they are added. They can be done from
+ * several threads, as long as the board is not modified meanwhile.
+ */
+class BOARD_ITEM_INDEX
+{
+public:
+    BOARD_ITEM_INDEX( BOARD* aBoard );
+    ~BOARD_ITEM_INDEX();
+
+    /**
+     * Function Invalidate
+     * drops the index, which is built again by the next query.
+     */
+    void Invalidate();
+
+    bool IsBuilt() const
+    {
+        return m_built;
+    }
+
+    /**
+     * Function Add
+     * indexes a track, a via or the pads of a module, already linked in their board list.
+     * Other items are ignored.
+     */
+    void Add( BOARD_ITEM* aItem );
+
+    /**
+     * Function Remove
+     * removes a track, a via, a pad or the pads of a module from the index, using the
+     * area they had when they were added: aItem may already have been changed.
+     */
+    void Remove( const BOARD_ITEM* aItem );
+
+    /**
+     * Function Update
+     * indexes aItem (or the module of a pad) again at the next query, after it has been
+     * changed in place.
+     */
+    void Update( BOARD_ITEM* aItem );
+
+    /**
+     * Function QueryPads
+     * collects the pads whose bounding box contains aPosition, in the order of the board
+     * module and pad lists.
+     */
+    void QueryPads( const wxPoint& aPosition, std::vector<D_PAD*>& aPads );
+
+    /**
+     * Function QueryTracks
+     * collects the tracks and vias whose bounding box contains aPosition, in the order of
+     * the board track list.
+     */
+    void QueryTracks( const wxPoint& aPosition, std::vector<TRACK*>& aTracks );
+
+private:
+    typedef RTree<BOARD_CONNECTED_ITEM*, int, 2, float> ITEM_TREE;
+
+    void build();
+
+    ///> Indexes the items added or changed since the last query
+    void updatePending();
+
+    void addItem( BOARD_CONNECTED_ITEM* aItem );
+    void removeItem( const BOARD_CONNECTED_ITEM* aItem );
+
+    ///> Indexes the pads aModule has now, in place of the ones indexed for it
+    void addModulePads( MODULE* aModule );
+    void removeModulePads( const MODULE* aModule );
+
+    struct ENTRY
+    {
+        EDA_RECT        m_bbox;
+        bool            m_isPad;
+        const MODULE*   m_module;       ///< The module of a pad
+        int             m_padRank;      ///< The rank of a pad in its module
+    };
+
+    BOARD*      m_board;
+    bool        m_built;
+    ITEM_TREE   m_pads;
+    ITEM_TREE   m_tracks;
+
+    ///> The area each item was indexed with
+    std::unordered_map<const BOARD_CONNECTED_ITEM*, ENTRY> m_entries;
+
+    ///> The pads indexed for each module, to remove them without reading the module
+    std::unordered_map<const MODULE*, std::vector<const D_PAD*>> m_modulePads;
+
+    ///> The rank of the modules and tracks in their board lists
+    LIST_RANKS<MODULE> m_moduleRanks;
+    LIST_RANKS<TRACK>  m_trackRanks;
+
+    ///> The modules and tracks to index at the next query
+    std::unordered_set<BOARD_ITEM*> m_pending;
+
+    ///> Taken by all the methods: the queries may build or update the index
+    std::mutex  m_lock;
+};
+
+#endif  // BOARD_ITEM_INDEX_H
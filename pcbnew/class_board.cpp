@@ -59,6 +59,8 @@
 #include <class_mire.h>
 #include <class_dimension.h>
 #include <connectivity.h>
+#include <zone_obstacle_cache.h>
+#include <board_item_index.h>
 
 
 /* This is an odd place for this, but CvPcb won't link if it is
@@ -110,6 +112,9 @@ BOARD::BOARD() :
 
     // Initialize ratsnest
     m_connectivity.reset( new CONNECTIVITY_DATA() );
+
+    m_zoneObstacleCache.reset( new ZONE_OBSTACLE_CACHE( this ) );
+    m_itemIndex.reset( new BOARD_ITEM_INDEX( this ) );
 }
 
 
@@ -898,6 +903,7 @@ void BOARD::Add( BOARD_ITEM* aBoardItem, ADD_MODE aMode )
 
     aBoardItem->SetParent( this );
     m_connectivity->Add( aBoardItem );
+    m_itemIndex->Add( aBoardItem );
 }
 
 
@@ -967,6 +973,29 @@ void BOARD::Remove( BOARD_ITEM* aBoardItem )
     }
 
     m_connectivity->Remove( aBoardItem );
+    m_itemIndex->Remove( aBoardItem );
+}
+
+
+void BOARD::InsertTrack( TRACK* aTrack, TRACK* aInsertBeforeMe )
+{
+    m_Track.Insert( aTrack, aInsertBeforeMe );
+
+    aTrack->SetParent( this );
+    m_connectivity->Add( aTrack );
+    m_itemIndex->Add( aTrack );
+}
+
+
+void BOARD::UpdateItemIndex( BOARD_ITEM* aItem )
+{
+    m_itemIndex->Update( aItem );
+}
+
+
+void BOARD::InvalidateItemIndex()
+{
+    m_itemIndex->Invalidate();
 }
 
 
@@ -1540,11 +1569,13 @@ D_PAD* BOARD::GetPad( const wxPoint& aPosition, LSET aLayerSet )
     if( !aLayerSet.any() )
         aLayerSet = LSET::AllCuMask();
 
-    for( MODULE* module = m_Modules;  module;  module = module->Next() )
-    {
-        D_PAD* pad = module->GetPad( aPosition, aLayerSet );
+    // The candidates come in the module and pad list order
+    std::vector<D_PAD*> pads;
+    m_itemIndex->QueryPads( aPosition, pads );
 
-        if( pad )
+    for( D_PAD* pad : pads )
+    {
+        if( ( pad->GetLayerSet() & aLayerSet ).any() && pad->HitTest( aPosition ) )
             return pad;
     }
 
@@ -1558,25 +1589,23 @@ D_PAD* BOARD::GetPad( TRACK* aTrace, ENDPOINT_T aEndPoint )
 
     LSET lset( aTrace->GetLayer() );
 
-    for( MODULE* module = m_Modules;  module;  module = module->Next() )
-    {
-        D_PAD*  pad = module->GetPad( aPosition, lset );
-
-        if( pad )
-            return pad;
-    }
-
-    return NULL;
-
+    return GetPad( aPosition, lset );
 }
 
 
 std::list<TRACK*> BOARD::GetTracksByPosition( const wxPoint& aPosition, PCB_LAYER_ID aLayer ) const
 {
     std::list<TRACK*> tracks;
+    std::vector<TRACK*> candidates;
 
-    for( TRACK* track = GetFirstTrack( m_Track ); track; track = GetFirstTrack( track->Next() ) )
+    m_itemIndex->QueryTracks( aPosition, candidates );
+
+    // Vias are not returned
+    for( TRACK* track : candidates )
     {
+        if( track->Type() != PCB_TRACE_T )
+            continue;
+
         if( ( ( track->GetStart() == aPosition ) || track->GetEnd() == aPosition ) &&
                 ( track->GetState( BUSY | IS_DELETED ) == 0 ) &&
                 ( ( aLayer == UNDEFINED_LAYER ) || ( track->IsOnLayer( aLayer ) ) ) )
@@ -1590,10 +1619,11 @@ std::list<TRACK*> BOARD::GetTracksByPosition( const wxPoint& aPosition, PCB_LAYE
 
 D_PAD* BOARD::GetPadFast( const wxPoint& aPosition, LSET aLayerSet )
 {
-    for( auto mod : Modules() )
+    std::vector<D_PAD*> pads;
+    m_itemIndex->QueryPads( aPosition, pads );
+
+    for( D_PAD* pad : pads )
     {
-        for ( auto pad : mod->Pads() )
-        {
         if( pad->GetPosition() != aPosition )
             continue;
 
@@ -1601,7 +1631,6 @@ D_PAD* BOARD::GetPadFast( const wxPoint& aPosition, LSET aLayerSet )
         if( ( pad->GetLayerSet() & aLayerSet ).any() )
             return pad;
     }
-}
 
     return nullptr;
 }
@@ -1733,6 +1762,7 @@ void BOARD::GetSortedPadListByXthenYCoord( std::vector<D_PAD*>& aVector, int aNe
 
 void BOARD::PadDelete( D_PAD* aPad )
 {
+    m_itemIndex->Remove( aPad );
     aPad->DeleteStructure();
 }
 
@@ -1740,7 +1770,21 @@ void BOARD::PadDelete( D_PAD* aPad )
 TRACK* BOARD::GetVisibleTrack( TRACK* aStartingTrace, const wxPoint& aPosition,
         LSET aLayerSet ) const
 {
-    for( TRACK* track = aStartingTrace; track; track = track->Next() )
+    // A search of the whole list uses the index, which gives the candidates in the
+    // list order
+    std::vector<TRACK*> candidates;
+
+    if( aStartingTrace && aStartingTrace == m_Track.GetFirst() )
+    {
+        m_itemIndex->QueryTracks( aPosition, candidates );
+    }
+    else
+    {
+        for( TRACK* track = aStartingTrace; track; track = track->Next() )
+            candidates.push_back( track );
+    }
+
+    for( TRACK* track : candidates )
     {
         PCB_LAYER_ID layer = track->GetLayer();
 
@@ -2064,9 +2108,12 @@ TRACK* BOARD::MarkTrace( TRACK*  aTrace, int* aCount,
             if( track->GetState( BUSY ) )   // move it!
             {
                 busy_count++;
+
+                // The index ranks the track at its new place in the list
+                m_itemIndex->Remove( track );
                 track->UnLink();
                 list->Insert( track, firstTrack->Next() );
-
+                m_itemIndex->Add( track );
             }
         }
     }
@@ -2182,21 +2229,31 @@ MODULE* BOARD::GetFootprint( const wxPoint& aPosition, PCB_LAYER_ID aActiveLayer
 
 BOARD_CONNECTED_ITEM* BOARD::GetLockPoint( const wxPoint& aPosition, LSET aLayerSet )
 {
-    for( MODULE* module = m_Modules; module; module = module->Next() )
-    {
-        D_PAD* pad = module->GetPad( aPosition, aLayerSet );
+    std::vector<D_PAD*> pads;
+    m_itemIndex->QueryPads( aPosition, pads );
 
-        if( pad )
+    for( D_PAD* pad : pads )
+    {
+        if( ( pad->GetLayerSet() & aLayerSet ).any() && pad->HitTest( aPosition ) )
             return pad;
     }
 
-    // No pad has been located so check for a segment of the trace.
-    TRACK* segment = ::GetTrack( m_Track, NULL, aPosition, aLayerSet );
+    // No pad has been located so check for a segment of the trace: an end point first,
+    // as ::GetTrack() does, then any point.
+    std::vector<TRACK*> tracks;
+    m_itemIndex->QueryTracks( aPosition, tracks );
 
-    if( !segment )
-        segment = GetVisibleTrack( m_Track, aPosition, aLayerSet );
+    for( TRACK* track : tracks )
+    {
+        if( track->GetState( IS_DELETED | BUSY ) )
+            continue;
+
+        if( ( aPosition == track->GetStart() || aPosition == track->GetEnd() )
+                && ( aLayerSet & track->GetLayerSet() ).any() )
+            return track;
+    }
 
-    return segment;
+    return GetVisibleTrack( m_Track, aPosition, aLayerSet );
 }
 
 
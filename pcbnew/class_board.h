@@ -63,6 +63,8 @@ class NETLIST;
 class REPORTER;
 class SHAPE_POLY_SET;
 class CONNECTIVITY_DATA;
+class ZONE_OBSTACLE_CACHE;
+class BOARD_ITEM_INDEX;
 
 /**
  * Enum LAYER_T
@@ -189,6 +191,8 @@ private:
     int                     m_fileFormatVersionAtLoad;  ///< the version loaded from the file
 
     std::shared_ptr<CONNECTIVITY_DATA>      m_connectivity;
+    std::shared_ptr<ZONE_OBSTACLE_CACHE>    m_zoneObstacleCache;
+    std::shared_ptr<BOARD_ITEM_INDEX>       m_itemIndex;
 
     BOARD_DESIGN_SETTINGS   m_designSettings;
     ZONE_SETTINGS           m_zoneSettings;
@@ -280,6 +284,13 @@ public:
 
     void Remove( BOARD_ITEM* aBoardItem ) override;
 
+    /**
+     * Function InsertTrack
+     * adds aTrack to the board like Add() does, but before aInsertBeforeMe in the track
+     * list (at its end if NULL), for the tools which keep the new tracks in chain order.
+     */
+    void InsertTrack( TRACK* aTrack, TRACK* aInsertBeforeMe );
+
     BOARD_ITEM* Duplicate( const BOARD_ITEM* aItem, bool aAddToBoard = false );
 
     /**
@@ -292,6 +303,40 @@ public:
         return m_connectivity;
     }
 
+    /**
+     * Function GetZoneObstacleCache()
+     * @return the pad and track polygons kept for the zone fill.
+     */
+    ZONE_OBSTACLE_CACHE* GetZoneObstacleCache() const
+    {
+        return m_zoneObstacleCache.get();
+    }
+
+    /**
+     * Function GetItemIndex()
+     * @return the spatial index of the pads and tracks used by the position queries.
+     */
+    BOARD_ITEM_INDEX* GetItemIndex() const
+    {
+        return m_itemIndex.get();
+    }
+
+    /**
+     * Function UpdateItemIndex
+     * updates the spatial index of the pads and tracks used by the position queries for
+     * aItem (a track, a via, a pad or a module) changed in place. It can be called before
+     * or after the change: aItem is indexed again by the next position query.
+     */
+    void UpdateItemIndex( BOARD_ITEM* aItem );
+
+    /**
+     * Function InvalidateItemIndex
+     * drops the spatial index of the pads and tracks, after changes of the board that
+     * cannot be told apart (the ones of the action plugins). It is built again on the
+     * next position query.
+     */
+    void InvalidateItemIndex();
+
     /**
      * Builds or rebuilds the board connectivity database for the board,
      * especially the list of connected items, list of nets and rastnest data
@@ -1187,9 +1232,10 @@ public:
 
     /**
      * Function GetPadFast
-     * return pad found at \a aPosition on \a aLayerMask using the fast search method.
+     * return pad found at \a aPosition on \a aLayerMask using the fast search method,
+     * i.e. the pad whose anchor is exactly at \a aPosition.
      * <p>
-     * The fast search method only works if the pad list has already been built.
+     * The pads are looked up in the board spatial index, no pad list has to be built.
      * </p>
      * @param aPosition A wxPoint object containing the position to hit test.
      * @param aLayerMask A layer or layers to mask the hit test.
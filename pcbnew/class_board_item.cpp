@@ -33,6 +33,8 @@
 #include <pcbnew.h>
 
 #include <class_board.h>
+#include <richio.h>
+#include <cmath>
 #include <string>
 
 wxString BOARD_ITEM::ShowShape( STROKE_T aShape )
@@ -88,6 +90,14 @@ wxString BOARD_ITEM::GetLayerName() const
 
 std::string BOARD_ITEM::FormatInternalUnits( int aValue )
 {
+    // Nanometers are written as the "%.10g" below would, without printf()
+    if( IU_PER_MM == 1e6 )
+    {
+        char    buf[FORMAT_BUFFER::FIXEDBUFZ];
+
+        return std::string( buf, FORMAT_BUFFER::FormatFixed( buf, aValue, 6 ) );
+    }
+
 #if 1
 
     char    buf[50];
@@ -169,6 +179,16 @@ std::string BOARD_ITEM::FormatInternalUnits( int aValue )
 
 std::string BOARD_ITEM::FormatAngle( double aAngle )
 {
+    // Most angles are whole tenths of degree, written as "%.10g" would without printf(),
+    // but for -0.0
+    if( std::fabs( aAngle ) < 1e9 && aAngle == (int) aAngle
+            && ( aAngle != 0.0 || !std::signbit( aAngle ) ) )
+    {
+        char    buf[FORMAT_BUFFER::FIXEDBUFZ];
+
+        return std::string( buf, FORMAT_BUFFER::FormatFixed( buf, (int) aAngle, 1 ) );
+    }
+
     char temp[50];
 
     int len = snprintf( temp, sizeof(temp), "%.10g", aAngle / 10.0 );
@@ -189,6 +209,25 @@ std::string BOARD_ITEM::FormatInternalUnits( const wxSize& aSize )
 }
 
 
+FORMAT_BUFFER& BOARD_ITEM::FormatInternalUnits( FORMAT_BUFFER& aBuffer, int aValue )
+{
+    if( IU_PER_MM == 1e6 )
+        return aBuffer.Fixed( aValue, 6 );
+
+    std::string text = FormatInternalUnits( aValue );
+
+    return aBuffer.Text( text.c_str(), text.size() );
+}
+
+
+FORMAT_BUFFER& BOARD_ITEM::FormatInternalUnits( FORMAT_BUFFER& aBuffer, const wxPoint& aPoint )
+{
+    FormatInternalUnits( aBuffer, aPoint.x );
+    aBuffer.Char( ' ' );
+    return FormatInternalUnits( aBuffer, aPoint.y );
+}
+
+
 void BOARD_ITEM::ViewGetLayers( int aLayers[], int& aCount ) const
 {
     // Basic fallback
@@ -43,6 +43,7 @@
 #include <convert_to_biu.h>
 #include <class_board.h>
 #include <class_zone.h>
+#include <zone_obstacle_cache.h>
 
 #include <pcbnew.h>
 #include <zones.h>
@@ -58,6 +59,7 @@ ZONE_CONTAINER::ZONE_CONTAINER( BOARD* aBoard ) :
     m_FillMode = 0;                             // How to fill areas: 0 = use filled polygons, != 0 fill with segments
     m_priority = 0;
     m_smoothedPoly = NULL;
+    m_fillSerial = 0;
     m_cornerSmoothingType = ZONE_SETTINGS::SMOOTHING_NONE;
     SetIsKeepout( false );
     SetDoNotAllowCopperPour( false );           // has meaning only if m_isKeepout == true
@@ -92,6 +94,9 @@ ZONE_CONTAINER::ZONE_CONTAINER( const ZONE_CONTAINER& aZone ) :
     m_ThermalReliefCopperBridge = aZone.m_ThermalReliefCopperBridge;
     m_FilledPolysList.Append( aZone.m_FilledPolysList );
     m_FillSegmList = aZone.m_FillSegmList;      // vector <> copy
+    m_RawPolysList = aZone.m_RawPolysList;
+    m_fillState = aZone.m_fillState;
+    m_fillSerial = aZone.m_fillSerial;
 
     m_isKeepout = aZone.m_isKeepout;
     m_doNotAllowCopperPour = aZone.m_doNotAllowCopperPour;
@@ -133,6 +138,9 @@ ZONE_CONTAINER& ZONE_CONTAINER::operator=( const ZONE_CONTAINER& aOther )
     m_FilledPolysList.Append( aOther.m_FilledPolysList );
     m_FillSegmList.clear();
     m_FillSegmList = aOther.m_FillSegmList;
+    m_RawPolysList = aOther.m_RawPolysList;
+    m_fillState = aOther.m_fillState;
+    m_fillSerial = aOther.m_fillSerial;
 
     SetLayerSet( aOther.GetLayerSet() );
 
@@ -163,10 +171,116 @@ bool ZONE_CONTAINER::UnFill()
     m_FillSegmList.clear();
     m_IsFilled = false;
 
+    // Nothing left to update: the next fill must be a full one
+    m_fillState.reset();
+
     return change;
 }
 
 
+bool ZONE_CONTAINER::FILL_PARAMS::operator==( const FILL_PARAMS& aOther ) const
+{
+    if( m_layers != aOther.m_layers
+        || m_netCode != aOther.m_netCode
+        || m_clearance != aOther.m_clearance
+        || m_zoneClearance != aOther.m_zoneClearance
+        || m_minThickness != aOther.m_minThickness
+        || m_padConnection != aOther.m_padConnection
+        || m_thermalGap != aOther.m_thermalGap
+        || m_thermalBridge != aOther.m_thermalBridge
+        || m_arcSegments != aOther.m_arcSegments
+        || m_cornerSmoothingType != aOther.m_cornerSmoothingType
+        || m_cornerRadius != aOther.m_cornerRadius
+        || m_priority != aOther.m_priority
+        || m_isKeepout != aOther.m_isKeepout
+        || m_doNotAllowCopperPour != aOther.m_doNotAllowCopperPour )
+        return false;
+
+    if( m_outline.OutlineCount() != aOther.m_outline.OutlineCount() )
+        return false;
+
+    for( int ii = 0; ii < m_outline.OutlineCount(); ++ii )
+    {
+        if( m_outline.HoleCount( ii ) != aOther.m_outline.HoleCount( ii ) )
+            return false;
+
+        for( int jj = -1; jj < m_outline.HoleCount( ii ); ++jj )
+        {
+            const SHAPE_LINE_CHAIN& chain = jj < 0 ? m_outline.COutline( ii )
+                                                   : m_outline.CHole( ii, jj );
+            const SHAPE_LINE_CHAIN& other = jj < 0 ? aOther.m_outline.COutline( ii )
+                                                   : aOther.m_outline.CHole( ii, jj );
+
+            if( chain.PointCount() != other.PointCount() )
+                return false;
+
+            for( int kk = 0; kk < chain.PointCount(); ++kk )
+            {
+                if( chain.CPoint( kk ) != other.CPoint( kk ) )
+                    return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+ZONE_CONTAINER::FILL_PARAMS ZONE_CONTAINER::fillParams() const
+{
+    FILL_PARAMS params;
+
+    params.m_outline = *m_Poly;
+    params.m_layers = m_layerSet;
+    params.m_netCode = GetNetCode();
+    params.m_clearance = GetClearance();
+    params.m_zoneClearance = m_ZoneClearance;
+    params.m_minThickness = m_ZoneMinThickness;
+    params.m_padConnection = m_PadConnection;
+    params.m_thermalGap = m_ThermalReliefGap;
+    params.m_thermalBridge = m_ThermalReliefCopperBridge;
+    params.m_arcSegments = m_ArcToSegmentsCount;
+    params.m_cornerSmoothingType = m_cornerSmoothingType;
+    params.m_cornerRadius = m_cornerRadius;
+    params.m_priority = m_priority;
+    params.m_isKeepout = m_isKeepout;
+    params.m_doNotAllowCopperPour = m_doNotAllowCopperPour;
+
+    return params;
+}
+
+
+void ZONE_CONTAINER::storeFillState( BOARD* aPcb, const std::shared_ptr<FILL_STATE>& aState )
+{
+    if( aState )
+        aState->m_params = fillParams();
+
+    m_fillState = aState;
+    m_fillSerial = aPcb->GetZoneObstacleCache()->GetDirtySerial();
+}
+
+
+bool ZONE_CONTAINER::CanUpdateFilledAreas() const
+{
+    return m_fillState && IsOnCopperLayer() && m_fillState->m_params == fillParams();
+}
+
+
+bool ZONE_CONTAINER::HasSameFillParameters( const ZONE_CONTAINER& aOther ) const
+{
+    return fillParams() == aOther.fillParams();
+}
+
+
+void ZONE_CONTAINER::CopyComputedFill( const ZONE_CONTAINER& aZone )
+{
+    m_FilledPolysList = aZone.m_FilledPolysList;
+    m_RawPolysList = aZone.m_RawPolysList;
+    m_fillState = aZone.m_fillState;
+    m_fillSerial = aZone.m_fillSerial;
+}
+
+
 const wxPoint& ZONE_CONTAINER::GetPosition() const
 {
     const WX_VECTOR_CONVERTER* pos;
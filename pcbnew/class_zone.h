@@ -31,6 +31,7 @@
 #define CLASS_ZONE_H_
 
 
+#include <memory>
 #include <vector>
 #include <gr_basic.h>
 #include <class_board_item.h>
@@ -328,6 +329,94 @@ public:
      */
     bool BuildFilledSolidAreasPolygons( BOARD* aPcb, SHAPE_POLY_SET* aOutlineBuffer = NULL );
 
+    /**
+     * Function BuildSmoothedPoly
+     * rebuilds the corner-smoothed outline used to fill the zone, and by the zones of
+     * lower priority to make room for it.
+     * @return false if the outline is malformed (less than 3 corners)
+     */
+    bool BuildSmoothedPoly();
+
+    /**
+     * Function ComputeFilledAreas
+     * first step of BuildFilledSolidAreasPolygons(): computes the filled areas from
+     * the smoothed outline.
+     * The smoothed outlines of this zone and of its knockout zones (see GetKnockoutZones())
+     * must be up to date. This step reads the board but modifies nothing but this zone,
+     * so zones can be computed concurrently.
+     * @param aPcb: the current board
+     * @param aKeepFillState: true to keep the state needed by a later UpdateFilledAreas(),
+     *                        when an incremental refill of the zone is expected
+     * @param aPartitioned: true to use the partitioned polygon modes, which compute the
+     *                      separate parts of large zones in parallel, but do not give
+     *                      exactly the same polygons (see SHAPE_POLY_SET::POLYGON_MODE)
+     */
+    void ComputeFilledAreas( BOARD* aPcb, bool aKeepFillState = false,
+                             bool aPartitioned = false );
+
+    /**
+     * Function FinishFilledAreas
+     * last step of BuildFilledSolidAreasPolygons(): removes the insulated copper islands,
+     * which updates the board connectivity, and creates the filling segments if needed.
+     * The islands are searched in all the filled areas, also after UpdateFilledAreas():
+     * whether a polygon is connected to a pad can change with an edit far from it.
+     * @param aPcb: the current board
+     * @return false if the filling segments cannot be built
+     */
+    bool FinishFilledAreas( BOARD* aPcb );
+
+    /**
+     * Function UpdateFilledAreas
+     * same as ComputeFilledAreas(), but only recomputes the filled areas inside the given
+     * areas, starting from the areas computed by the last fill. The filled polygons not
+     * crossing them are kept as they are.
+     * Can only be used when CanUpdateFilledAreas() returns true, for a copper zone.
+     * The state needed by the next update is kept.
+     * @param aPcb: the current board
+     * @param aAreas: the areas where the board changed since the last fill, including the
+     *                zone clearance
+     * @param aPartitioned: see ComputeFilledAreas()
+     */
+    void UpdateFilledAreas( BOARD* aPcb, const std::vector<EDA_RECT>& aAreas,
+                            bool aPartitioned = false );
+
+    /**
+     * Function CanUpdateFilledAreas
+     * @return true if the zone keeps the areas computed by its last fill (see
+     * ComputeFilledAreas()), and its outline and fill settings did not change since then
+     */
+    bool CanUpdateFilledAreas() const;
+
+    /**
+     * Function HasSameFillParameters
+     * @return true if the filled areas of both zones are built from the same outline and
+     * fill settings
+     */
+    bool HasSameFillParameters( const ZONE_CONTAINER& aOther ) const;
+
+    /**
+     * Function CopyComputedFill
+     * copies the filled areas computed by ComputeFilledAreas() or UpdateFilledAreas() on
+     * aZone, a copy of this zone, with the state needed by a later UpdateFilledAreas().
+     */
+    void CopyComputedFill( const ZONE_CONTAINER& aZone );
+
+    /**
+     * Returns the serial of the last board change (see ZONE_OBSTACLE_CACHE::AddDirtyItem())
+     * taken in account by the filled areas.
+     */
+    unsigned GetFillSerial() const { return m_fillSerial; }
+    void SetFillSerial( unsigned aSerial ) { m_fillSerial = aSerial; }
+
+    /**
+     * Function GetKnockoutZones
+     * collects the zones whose outline is removed from the filled areas of this zone:
+     * the keepout zones forbidding copper and the zones of higher priority overlapping it.
+     * @param aPcb: the current board
+     * @param aZones: the vector to append the zones to
+     */
+    void GetKnockoutZones( BOARD* aPcb, std::vector<ZONE_CONTAINER*>& aZones ) const;
+
     /**
      * Function AddClearanceAreasPolygonsToPolysList
      * Add non copper areas polygons (pads and tracks with clearance)
@@ -338,10 +427,13 @@ public:
      * BuildFilledSolidAreasPolygons() call this function just after creating the
      *  filled copper area polygon (without clearance areas
      * @param aPcb: the current board
+     * @param aKeepFillState: see ComputeFilledAreas()
+     * @param aPartitioned: see ComputeFilledAreas()
      * _NG version uses SHAPE_POLY_SET instead of Boost.Polygon
      */
     void AddClearanceAreasPolygonsToPolysList( BOARD* aPcb );
-    void AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb );
+    void AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb, bool aKeepFillState = false,
+                                                  bool aPartitioned = false );
 
 
      /**
@@ -361,6 +453,16 @@ public:
     void TransformOutlinesShapeWithClearanceToPolygon( SHAPE_POLY_SET& aCornerBuffer,
                                                         int aMinClearanceValue,
                                                         bool aUseNetClearance );
+
+    /**
+     * Function TransformSmoothedOutlinesWithClearanceToPolygon
+     * same as TransformOutlinesShapeWithClearanceToPolygon(), but uses the smoothed
+     * outline built by the last BuildSmoothedPoly() call instead of rebuilding it,
+     * so it does not modify the zone.
+     */
+    void TransformSmoothedOutlinesWithClearanceToPolygon( SHAPE_POLY_SET& aCornerBuffer,
+                                                          int aMinClearanceValue,
+                                                          bool aUseNetClearance ) const;
     /**
      * Function HitTestForCorner
      * tests if the given wxPoint is near a corner.
@@ -736,7 +838,57 @@ public:
 
 
 private:
-    void buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeatures );
+    /**
+     * The outline and the settings the filled areas depend on
+     */
+    struct FILL_PARAMS
+    {
+        SHAPE_POLY_SET  m_outline;
+        LSET            m_layers;
+        int             m_netCode;
+        int             m_clearance;            ///< GetClearance(), the netclass clearance
+        int             m_zoneClearance;
+        int             m_minThickness;
+        ZoneConnection  m_padConnection;
+        int             m_thermalGap;
+        int             m_thermalBridge;
+        int             m_arcSegments;
+        int             m_cornerSmoothingType;
+        unsigned int    m_cornerRadius;
+        unsigned        m_priority;
+        bool            m_isKeepout;
+        bool            m_doNotAllowCopperPour;
+
+        bool operator==( const FILL_PARAMS& aOther ) const;
+    };
+
+    FILL_PARAMS fillParams() const;
+
+    /**
+     * The filled areas before the fracture and the islands removal: the polygon ii gives
+     * the outline ii of m_RawPolysList. They are the starting point of UpdateFilledAreas(),
+     * with the settings they were computed with.
+     */
+    struct FILL_STATE
+    {
+        SHAPE_POLY_SET  m_unfracturedPolys;
+        FILL_PARAMS     m_params;
+    };
+
+    /**
+     * Stores aState, holding the unfractured areas of the fill, with the current settings
+     * for a later UpdateFilledAreas(). A null aState drops the state of the previous fill.
+     */
+    void storeFillState( BOARD* aPcb, const std::shared_ptr<FILL_STATE>& aState );
+
+    /**
+     * Function buildFeatureHoleList
+     * builds the polygons removed from the zone outline to get its filled areas.
+     * @param aArea: if not null, only the features close to this area are built, otherwise
+     *               all the features of the zone.
+     */
+    void buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeatures,
+                               const EDA_RECT* aArea = NULL );
 
     SHAPE_POLY_SET*       m_Poly;                ///< Outline of the zone.
     SHAPE_POLY_SET*       m_smoothedPoly;        // Corner-smoothed version of m_Poly
@@ -806,6 +958,12 @@ private:
     SHAPE_POLY_SET        m_FilledPolysList;
     SHAPE_POLY_SET        m_RawPolysList;
 
+    /* Only kept while an incremental refill is expected. Never modified once stored, so
+     * the copies of the zone (the undo images, the ZONE_FILLER work copies) share it.
+     */
+    std::shared_ptr<const FILL_STATE> m_fillState;
+    unsigned              m_fillSerial;
+
     HATCH_STYLE           m_hatchStyle;     // hatch style, see enum above
     int                   m_hatchPitch;     // for DIAGONAL_EDGE, distance between 2 hatch lines
     std::vector<SEG>      m_HatchLines;     // hatch lines
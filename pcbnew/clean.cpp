@@ -39,6 +39,7 @@
 #include <board_commit.h>
 #include <connectivity.h>
 #include <connectivity_algo.h>
+#include <board_item_index.h>
 
 // Helper class used to clean tracks and vias
 class TRACKS_CLEANER
@@ -73,8 +74,10 @@ private:
     /**
      * Removes all the following THT vias on the same position of the
      * specified one
+     * @param aViaOrder is the rank of the vias in the track list
      */
-    void removeDuplicatesOfVia( const VIA *aVia, std::set<BOARD_ITEM *>& aToRemove );
+    void removeDuplicatesOfVia( const VIA *aVia, std::set<BOARD_ITEM *>& aToRemove,
+                                const std::unordered_map<const TRACK*, int>& aViaOrder );
 
     /**
      * Removes all the following duplicates tracks of the specified one
@@ -89,8 +92,13 @@ private:
     /// Delete null length track segments
     bool deleteNullSegments();
 
-    /// Try to merge the segment to a following collinear one
-    bool MergeCollinearTracks( TRACK* aSegment );
+    /**
+     * Try to merge the segment to a following collinear one
+     * @param aNetRuns is the rank of the run of same net tracks of the track list
+     * each track belongs to: only the tracks of the run of aSegment are connected to it
+     */
+    bool MergeCollinearTracks( TRACK* aSegment,
+                               const std::unordered_map<const TRACK*, int>& aNetRuns );
 
     /**
      * Merge collinear segments and remove duplicated and null len segments
@@ -283,13 +291,21 @@ bool TRACKS_CLEANER::removeBadTrackSegments()
 }
 
 
-void TRACKS_CLEANER::removeDuplicatesOfVia( const VIA *aVia, std::set<BOARD_ITEM *>& aToRemove )
+void TRACKS_CLEANER::removeDuplicatesOfVia( const VIA *aVia, std::set<BOARD_ITEM *>& aToRemove,
+                                            const std::unordered_map<const TRACK*, int>& aViaOrder )
 {
-    VIA* next_via;
+    std::vector<TRACK*> candidates;
+    int rank = aViaOrder.at( aVia );
 
-    for( VIA* alt_via = GetFirstVia( aVia->Next() ); alt_via != NULL; alt_via = next_via )
+    // Only the vias following aVia in the track list are its duplicates
+    m_brd->GetItemIndex()->QueryTracks( aVia->GetStart(), candidates );
+
+    for( TRACK* candidate : candidates )
     {
-        next_via = GetFirstVia( alt_via->Next() );
+        if( candidate->Type() != PCB_VIA_T || aViaOrder.at( candidate ) <= rank )
+            continue;
+
+        VIA* alt_via = static_cast<VIA*>( candidate );
 
         if( ( alt_via->GetViaType() == VIA_THROUGH ) &&
                 ( alt_via->GetStart() == aVia->GetStart() ) )
@@ -301,6 +317,12 @@ void TRACKS_CLEANER::removeDuplicatesOfVia( const VIA *aVia, std::set<BOARD_ITEM
 bool TRACKS_CLEANER::cleanupVias()
 {
     std::set<BOARD_ITEM*> toRemove;
+    std::unordered_map<const TRACK*, int> viaOrder;
+    int rank = 0;
+
+    for( VIA* via = GetFirstVia( m_brd->m_Track ); via != NULL;
+            via = GetFirstVia( via->Next() ) )
+        viaOrder[via] = rank++;
 
     for( VIA* via = GetFirstVia( m_brd->m_Track ); via != NULL;
             via = GetFirstVia( via->Next() ) )
@@ -319,7 +341,7 @@ bool TRACKS_CLEANER::cleanupVias()
          * (yet) handle high density interconnects */
         if( via->GetViaType() == VIA_THROUGH )
         {
-            removeDuplicatesOfVia( via, toRemove );
+            removeDuplicatesOfVia( via, toRemove, viaOrder );
 
             /* To delete through Via on THT pads at same location
              * Examine the list of connected pads:
@@ -363,11 +385,9 @@ bool TRACKS_CLEANER::testTrackEndpointDangling( TRACK* aTrack, ENDPOINT_T aEndPo
     if( !citem->Valid() )
         return false;
 
-    auto anchors = citem->Anchors();
-
-    for( auto anchor : anchors )
+    for( const auto& anchor : citem->Anchors() )
     {
-        if( anchor->Pos() == endpoint && anchor->IsDangling() )
+        if( anchor.Pos() == endpoint && anchor.IsDangling() )
             return true;
     }
 
@@ -447,7 +467,12 @@ void TRACKS_CLEANER::removeDuplicatesOfTrack( const TRACK *aTrack, std::set<BOAR
     if( aTrack->GetFlags() & STRUCT_DELETED )
         return;
 
-    for( auto other : m_brd->Tracks() )
+    std::vector<TRACK*> candidates;
+
+    // A duplicate has an end at the start of aTrack
+    m_brd->GetItemIndex()->QueryTracks( aTrack->GetStart(), candidates );
+
+    for( auto other : candidates )
     {
         // New netcode, break out (can't be there any other)
         if( aTrack->GetNetCode() != other->GetNetCode() )
@@ -477,51 +502,63 @@ void TRACKS_CLEANER::removeDuplicatesOfTrack( const TRACK *aTrack, std::set<BOAR
 }
 
 
-bool TRACKS_CLEANER::MergeCollinearTracks( TRACK* aSegment )
+bool TRACKS_CLEANER::MergeCollinearTracks( TRACK* aSegment,
+                                           const std::unordered_map<const TRACK*, int>& aNetRuns )
 {
     bool merged_this = false;
 
+    // The last segment of the list has no following one to be merged to
+    if( !aSegment->Next() )
+        return false;
+
+    std::vector<TRACK*> candidates;
 
     for( ENDPOINT_T endpoint = ENDPOINT_START; endpoint <= ENDPOINT_END;
             endpoint = ENDPOINT_T( endpoint + 1 ) )
     {
-        // search for a possible segment connected to the current endpoint of the current one
-        TRACK* other = aSegment->Next();
+        // search for the segments connected to the current endpoint of the current one,
+        // among the ones of its run of same net tracks, like TRACK::GetTrack() does
+        const wxPoint& position = aSegment->GetEndPoint( endpoint );
+        int run = aNetRuns.at( aSegment );
+        TRACK* other = NULL;
+        int count = 0;
+
+        m_brd->GetItemIndex()->QueryTracks( position, candidates );
 
-        if( other )
+        for( TRACK* candidate : candidates )
         {
-            other = aSegment->GetTrack( other, NULL, endpoint, true, false );
+            if( candidate == aSegment || candidate->GetState( BUSY | IS_DELETED )
+                    || !( aSegment->GetLayerSet() & candidate->GetLayerSet() ).any() )
+                continue;
+
+            auto it = aNetRuns.find( candidate );
 
-            if( other )
+            if( it == aNetRuns.end() || it->second != run )
+                continue;
+
+            if( candidate->GetStart() == position || candidate->GetEnd() == position )
             {
-                // the two segments must have the same width and the other
-                // cannot be a via
-                if( ( aSegment->GetWidth() == other->GetWidth() ) &&
-                        ( other->Type() == PCB_TRACE_T ) )
-                {
-                    // There can be only one segment connected
-                    other->SetState( BUSY, true );
-                    TRACK* yet_another = aSegment->GetTrack( m_brd->m_Track, NULL,
-                            endpoint, true, false );
-                    other->SetState( BUSY, false );
-
-                    if( !yet_another )
-                    {
-                        // Try to merge them
-                        TRACK* segDelete = mergeCollinearSegmentIfPossible( aSegment,
-                                other, endpoint );
-
-                        // Merge succesful, the other one has to go away
-                        if( segDelete )
-                        {
-                            m_brd->Remove( segDelete );
-                            m_commit.Removed( segDelete );
-                            merged_this = true;
-                        }
-                    }
-                }
+                other = candidate;
+                count++;
             }
         }
+
+        // There can be only one segment connected, of the same width (the other
+        // cannot be a via)
+        if( count != 1 || aSegment->GetWidth() != other->GetWidth()
+                || other->Type() != PCB_TRACE_T )
+            continue;
+
+        // Try to merge them
+        TRACK* segDelete = mergeCollinearSegmentIfPossible( aSegment, other, endpoint );
+
+        // Merge succesful, the other one has to go away
+        if( segDelete )
+        {
+            m_brd->Remove( segDelete );
+            m_commit.Removed( segDelete );
+            merged_this = true;
+        }
     }
 
 
@@ -556,13 +593,26 @@ bool TRACKS_CLEANER::cleanupSegments()
     // merge collinear segments:
     TRACK* nextsegment;
 
+    // The runs of same net tracks of the list. Merges only remove tracks of the run
+    // of the merged one, which keeps the others as they are
+    std::unordered_map<const TRACK*, int> netRuns;
+    int run = 0;
+
+    for( TRACK* segment = m_brd->m_Track; segment; segment = segment->Next() )
+    {
+        if( segment->Back() && segment->Back()->GetNetCode() != segment->GetNetCode() )
+            run++;
+
+        netRuns[segment] = run;
+    }
+
 	for( TRACK* segment = m_brd->m_Track; segment; segment = nextsegment )
     {
         nextsegment = segment->Next();
 
         if( segment->Type() == PCB_TRACE_T )
         {
-            bool merged_this = MergeCollinearTracks( segment );
+            bool merged_this = MergeCollinearTracks( segment, netRuns );
 
             if( merged_this ) // The current segment was modified, retry to merge it again
             {
@@ -678,6 +728,7 @@ TRACK* TRACKS_CLEANER::mergeCollinearSegmentIfPossible( TRACK* aTrackRef, TRACK*
             aTrackRef->SetStart( aCandidate->GetEnd() );
             aTrackRef->SetState( START_ON_PAD, aCandidate->GetState( END_ON_PAD ) );
             connectivity->Update( aTrackRef );
+            m_brd->UpdateItemIndex( aTrackRef );
             return aCandidate;
         }
         else
@@ -686,6 +737,7 @@ TRACK* TRACKS_CLEANER::mergeCollinearSegmentIfPossible( TRACK* aTrackRef, TRACK*
             aTrackRef->SetStart( aCandidate->GetStart() );
             aTrackRef->SetState( START_ON_PAD, aCandidate->GetState( START_ON_PAD ) );
             connectivity->Update( aTrackRef );
+            m_brd->UpdateItemIndex( aTrackRef );
             return aCandidate;
         }
     }
@@ -703,6 +755,7 @@ TRACK* TRACKS_CLEANER::mergeCollinearSegmentIfPossible( TRACK* aTrackRef, TRACK*
             aTrackRef->SetEnd( aCandidate->GetEnd() );
             aTrackRef->SetState( END_ON_PAD, aCandidate->GetState( END_ON_PAD ) );
             connectivity->Update( aTrackRef );
+            m_brd->UpdateItemIndex( aTrackRef );
 
             return aCandidate;
         }
@@ -712,6 +765,7 @@ TRACK* TRACKS_CLEANER::mergeCollinearSegmentIfPossible( TRACK* aTrackRef, TRACK*
             aTrackRef->SetEnd( aCandidate->GetStart() );
             aTrackRef->SetState( END_ON_PAD, aCandidate->GetState( START_ON_PAD ) );
             connectivity->Update( aTrackRef );
+            m_brd->UpdateItemIndex( aTrackRef );
             return aCandidate;
         }
     }
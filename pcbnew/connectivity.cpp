@@ -21,19 +21,18 @@
  * or you may write to the Free Software Foundation, Inc.,
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
-#ifdef PROFILE
 #include <profile.h>
-#endif
 
 #include <connectivity.h>
 #include <connectivity_algo.h>
 #include <ratsnest_data.h>
 
-#ifdef USE_OPENMP
-#include <omp.h>
-#endif /* USE_OPENMP */
+#include <thread_pool.h>
 
-CONNECTIVITY_DATA::CONNECTIVITY_DATA()
+#include <algorithm>
+
+CONNECTIVITY_DATA::CONNECTIVITY_DATA() :
+    m_serial( 0 )
 {
     m_connAlgo.reset( new CN_CONNECTIVITY_ALGO );
 }
@@ -92,28 +91,44 @@ void CONNECTIVITY_DATA::updateRatsnest()
     PROF_COUNTER rnUpdate( "update-ratsnest" );
     #endif
 
-    int nDirty = 0;
-
-    int i;
+    // Start with net number 1, as 0 stands for not connected
+    std::vector<RN_NET*> dirty;
 
-    #ifdef USE_OPENMP
-        #pragma omp parallel shared(lastNet) private(i)
-    {
-        #pragma omp for schedule(guided, 1)
-    #else /* USE_OPENMP */
+    for( int i = 1; i < lastNet; ++i )
     {
-    #endif
+        if( m_nets[i]->IsDirty() )
+            dirty.push_back( m_nets[i] );
+    }
 
-        // Start with net number 1, as 0 stands for not connected
-        for( i = 1; i < lastNet; ++i )
+    // The largest nets first, so that they do not end up last on a single thread
+    std::stable_sort( dirty.begin(), dirty.end(), [] ( const RN_NET* aA, const RN_NET* aB ) {
+        return aA->GetNodeCount() > aB->GetNodeCount();
+    } );
+
+    // Each task computes a large net, or enough small nets to amortize the task
+    const unsigned int taskNodes = 256;
+    std::vector<size_t> taskStart;
+    unsigned int nodes = taskNodes;
+
+    for( size_t i = 0; i < dirty.size(); ++i )
+    {
+        if( nodes >= taskNodes )
         {
-            if( m_nets[i]->IsDirty() )
-            {
-                m_nets[i]->Update();
-                nDirty++;
-            }
+            taskStart.push_back( i );
+            nodes = 0;
         }
-    }          /* end of parallel section */
+
+        nodes += dirty[i]->GetNodeCount() + 1;
+    }
+
+    taskStart.push_back( dirty.size() );
+
+    THREAD_POOL::GetInstance().ParallelFor( taskStart.size() - 1,
+            [&dirty, &taskStart] ( size_t aTask )
+            {
+                for( size_t i = taskStart[aTask]; i < taskStart[aTask + 1]; ++i )
+                    dirty[i]->Update();
+            } );
 
     #ifdef PROFILE
     rnUpdate.Show();
@@ -131,6 +146,10 @@ void CONNECTIVITY_DATA::addRatsnestCluster( std::shared_ptr<CN_CLUSTER> aCluster
 
 void CONNECTIVITY_DATA::RecalculateRatsnest()
 {
+    unsigned start = GetRunningMicroSecs();
+
+    m_serial++;
+    m_connAlgo->ResetStats();
     m_connAlgo->PropagateNets();
 
     int lastNet = m_connAlgo->NetCount();
@@ -169,7 +188,14 @@ void CONNECTIVITY_DATA::RecalculateRatsnest()
 
     m_connAlgo->ClearDirtyFlags();
 
+    unsigned ratsnestStart = GetRunningMicroSecs();
+
     updateRatsnest();
+
+    m_stats = m_connAlgo->GetStats();
+    m_stats.m_netsRecomputed = dirtyNets;
+    m_stats.m_ratsnestTime = GetRunningMicroSecs() - ratsnestStart;
+    m_stats.m_totalTime = GetRunningMicroSecs() - start;
 }
 
 
@@ -198,8 +224,8 @@ void CONNECTIVITY_DATA::BlockRatsnestItems( const std::vector<BOARD_ITEM*>& aIte
 
             for( auto cnItem : entry.GetItems() )
             {
-                for( auto anchor : cnItem->Anchors() )
-                    anchor->SetNoLine( true );
+                for( auto& anchor : cnItem->Anchors() )
+                    anchor.SetNoLine( true );
             }
         }
     }
@@ -235,7 +261,8 @@ void CONNECTIVITY_DATA::ComputeDynamicRatsnest( const std::vector<BOARD_ITEM*>&
         if( dynNet->GetNodeCount() != 0 )
         {
             auto ourNet = m_nets[nc];
-            CN_ANCHOR_PTR nodeA, nodeB;
+            CN_ANCHOR_PTR nodeA = nullptr;
+            CN_ANCHOR_PTR nodeB = nullptr;
 
             if( ourNet->NearestBicoloredPair( *dynNet, nodeA, nodeB ) )
             {
@@ -524,9 +551,9 @@ const std::vector<VECTOR2I> CONNECTIVITY_DATA::NearestUnconnectedTargets(
                 if( item->Valid() && item->Parent()->GetNetCode() == refNet
                     && item->Parent()->Type() != PCB_ZONE_AREA_T )
                 {
-                    for( auto anchor : item->Anchors() )
+                    for( const auto& anchor : item->Anchors() )
                     {
-                        anchors.insert( anchor->Pos() );
+                        anchors.insert( anchor.Pos() );
                     }
                 }
             }
@@ -572,9 +599,9 @@ const std::vector<BOARD_CONNECTED_ITEM*> CONNECTIVITY_DATA::GetConnectedItems(
 
     for( auto cnItem : entry.GetItems() )
     {
-        for( auto anchor : cnItem->Anchors() )
+        for( const auto& anchor : cnItem->Anchors() )
         {
-            if( anchor->Pos() == aAnchor )
+            if( anchor.Pos() == aAnchor )
             {
                 for( int i = 0; aTypes[i] > 0; i++ )
                 {
@@ -60,6 +60,37 @@ struct RN_DYNAMIC_LINE
     VECTOR2I a, b;
 };
 
+/**
+ * Struct CONNECTIVITY_STATS
+ * The work done by the last ratsnest update, which only searches the items changed
+ * since the previous one.
+ */
+struct CONNECTIVITY_STATS
+{
+    CONNECTIVITY_STATS() :
+        m_itemsSearched( 0 ),
+        m_itemsRemoved( 0 ),
+        m_clustersPropagated( 0 ),
+        m_clustersRebuilt( 0 ),
+        m_netsRecomputed( 0 ),
+        m_searchTime( 0 ),
+        m_clusterTime( 0 ),
+        m_ratsnestTime( 0 ),
+        m_totalTime( 0 )
+    {
+    }
+
+    int         m_itemsSearched;        ///< items added since the previous search
+    int         m_itemsRemoved;         ///< items removed since the previous search
+    int         m_clustersPropagated;   ///< clusters the nets were propagated in
+    int         m_clustersRebuilt;      ///< ratsnest clusters of the dirty nets
+    int         m_netsRecomputed;       ///< nets which ratsnest was computed again
+    unsigned    m_searchTime;           ///< connection search, in microseconds
+    unsigned    m_clusterTime;          ///< clusters building and net propagation, in microseconds
+    unsigned    m_ratsnestTime;         ///< ratsnest computation, in microseconds
+    unsigned    m_totalTime;            ///< whole update, in microseconds
+};
+
 // a wrapper class encompassing the connectivity computation algorithm and the
 class CONNECTIVITY_DATA
 {
@@ -140,10 +171,31 @@ public:
 
     /**
      * Function RecalculateRatsnest()
-     * Updates the ratsnest for the board.
+     * Updates the ratsnest for the board. Only the connections of the items added or
+     * updated since the last call are searched, and only the clusters of the nets they
+     * changed are built again.
      */
     void RecalculateRatsnest();
 
+    /**
+     * Function GetStats()
+     * Returns the work done by the last RecalculateRatsnest() call.
+     */
+    const CONNECTIVITY_STATS& GetStats() const
+    {
+        return m_stats;
+    }
+
+    /**
+     * Function GetSerial()
+     * Returns a number changed by each RecalculateRatsnest() call, to tell whether the
+     * ratsnest was updated since it was last read.
+     */
+    unsigned GetSerial() const
+    {
+        return m_serial;
+    }
+
     /**
      * Function GetUnconnectedCount()
      * Returns the number of remaining edges in the ratsnest.
@@ -227,6 +279,9 @@ private:
 
     std::vector<RN_DYNAMIC_LINE> m_dynamicRatsnest;
     std::vector<RN_NET*> m_nets;
+
+    CONNECTIVITY_STATS m_stats;
+    unsigned m_serial;
 };
 
 #endif
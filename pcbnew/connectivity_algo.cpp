@@ -24,21 +24,10 @@
 
 #include <connectivity_algo.h>
 
-#ifdef PROFILE
 #include <profile.h>
-#endif
 
 using namespace std::placeholders;
 
-bool operator<( const CN_ANCHOR_PTR a, const CN_ANCHOR_PTR b )
-{
-    if( a->Pos().x == b->Pos().x )
-        return a->Pos().y < b->Pos().y;
-    else
-        return a->Pos().x < b->Pos().x;
-}
-
-
 bool CN_ANCHOR::IsDirty() const
 {
     return m_item->Dirty();
@@ -47,7 +36,6 @@ bool CN_ANCHOR::IsDirty() const
 
 CN_CLUSTER::CN_CLUSTER()
 {
-    m_items.reserve( 64 );
     m_originPad = nullptr;
     m_originNet = -1;
     m_conflicting = false;
@@ -277,7 +265,10 @@ bool CN_CONNECTIVITY_ALGO::Add( BOARD_ITEM* aItem )
         m_itemMap[zone] = ITEM_MAP_ENTRY();
 
         for( auto zitem : m_zoneList.Add( zone ) )
+        {
             m_itemMap[zone].Link(zitem);
+            m_dirtyItems.push_back( zitem );
+        }
 
         break;
     }
@@ -290,19 +281,9 @@ bool CN_CONNECTIVITY_ALGO::Add( BOARD_ITEM* aItem )
 }
 
 
-void CN_CONNECTIVITY_ALGO::searchConnections( bool aIncludeZones )
+void CN_CONNECTIVITY_ALGO::searchConnections()
 {
-    int totalDirtyCount = 0;
-
-    if( m_lastSearchWithZones != aIncludeZones )
-    {
-        m_padList.MarkAllAsDirty();
-        m_viaList.MarkAllAsDirty();
-        m_trackList.MarkAllAsDirty();
-        m_zoneList.MarkAllAsDirty();
-    }
-
-    m_lastSearchWithZones = aIncludeZones;
+    unsigned start = GetRunningMicroSecs();
 
     auto checkForConnection = [] ( const CN_ANCHOR_PTR point, CN_ITEM* aRefItem, int aMaxDist = 0 )
     {
@@ -422,6 +403,15 @@ void CN_CONNECTIVITY_ALGO::searchConnections( bool aIncludeZones )
     printf("Search start\n");
 #endif
 
+    // The items added, then removed before being searched are deleted below
+    auto isInvalid = [] ( const CN_ITEM* aItem ) { return !aItem->Valid(); };
+
+    m_dirtyItems.erase( std::remove_if( m_dirtyItems.begin(), m_dirtyItems.end(), isInvalid ),
+                        m_dirtyItems.end() );
+    m_propagateSeeds.erase( std::remove_if( m_propagateSeeds.begin(), m_propagateSeeds.end(),
+                                            isInvalid ),
+                            m_propagateSeeds.end() );
+
     std::vector<CN_ITEM*> garbage;
     garbage.reserve( 1024 );
 
@@ -431,92 +421,191 @@ void CN_CONNECTIVITY_ALGO::searchConnections( bool aIncludeZones )
     m_zoneList.RemoveInvalidItems( garbage );
 
     for( auto item : garbage )
-        delete item;
-
-    //auto all = allItemsInBoard();
+    {
+        // The items connected to a removed item may now belong to another cluster
+        for( auto connected : item->ConnectedItems() )
+        {
+            if( connected->Valid() )
+                m_propagateSeeds.push_back( connected );
+        }
 
-    #ifdef CONNECTIVITY_DEBUG
-        for( auto item : m_padList )
-            if( all.find( item->Parent() ) == all.end() ) { printf("Failing pad : %p\n", item->Parent() ); assert ( false ); }
+        // The ratsnest of the net the item was clustered in points to its anchors:
+        // it must be rebuilt, even if the item was moved to another net since
+        int cluster = item->ClusterId();
 
-        for( auto item : m_viaList )
-            if( all.find( item->Parent() ) == all.end() ) { printf("Failing via : %p\n", item->Parent() ); assert ( false ); }
+        if( cluster >= 0 && cluster < (int) m_ratsnestClusters.size() )
+            MarkNetAsDirty( m_ratsnestClusters[cluster]->OriginNet() );
+    }
 
-        for( auto item : m_trackList )
-            if( all.find( item->Parent() ) == all.end() ) { printf("Failing track : %p\n", item->Parent() ); assert ( false ); }
+    for( auto item : garbage )
+        delete item;
 
-        for( auto item : m_zoneList )
-            if( all.find( item->Parent() ) == all.end() ) { printf("Failing zome : %p\n", item->Parent() ); assert ( false ); }
-    #endif
+    m_stats.m_itemsRemoved += garbage.size();
 
 #ifdef PROFILE
     PROF_COUNTER search_cnt( "search-connections" );
-    PROF_COUNTER search_basic( "search-basic" );
 #endif
 
-    if( m_padList.IsDirty() || m_trackList.IsDirty() || m_viaList.IsDirty() )
+    // Only the items added since the last search are searched. The connections are searched
+    // from the new item to the anchors around it, as a full search would do, and from the
+    // items already searched around it to its anchors, since they would have found them.
+    // The searches in a list without searched items are skipped.
+    int dirtyPads = 0;
+    int dirtyTracks = 0;
+    int dirtyVias = 0;
+    int dirtyZones = 0;
+
+    for( auto item : m_dirtyItems )
+    {
+        switch( item->Parent()->Type() )
+        {
+        case PCB_PAD_T:         dirtyPads++;    break;
+        case PCB_TRACE_T:       dirtyTracks++;  break;
+        case PCB_VIA_T:         dirtyVias++;    break;
+        default:                dirtyZones++;   break;
+        }
+    }
+
+    bool searchedPads = m_padList.Size() > dirtyPads;
+    bool searchedTracks = m_trackList.Size() > dirtyTracks;
+    bool searchedVias = m_viaList.Size() > dirtyVias;
+    std::vector<CN_ZONE*> searchedZones;
+
+    if( m_zoneList.Size() > dirtyZones )
     {
-        totalDirtyCount++;
+        for( auto item : m_zoneList )
+        {
+            if( !item->Dirty() )
+                searchedZones.push_back( static_cast<CN_ZONE*>( item ) );
+        }
+    }
+
+    for( auto item : m_dirtyItems )
+    {
+        auto parent = item->Parent();
 
-        for( auto padItem : m_padList )
+        switch( parent->Type() )
+        {
+        case PCB_PAD_T:
         {
-            auto pad = static_cast<D_PAD*> ( padItem->Parent() );
-            auto searchPads = std::bind( checkForConnection, _1, padItem );
+            auto pad = static_cast<D_PAD*> ( parent );
+            auto searchPads = std::bind( checkForConnection, _1, item );
 
             m_padList.FindNearby( pad->ShapePos(), pad->GetBoundingRadius(), searchPads );
             m_trackList.FindNearby( pad->ShapePos(), pad->GetBoundingRadius(), searchPads );
             m_viaList.FindNearby( pad->ShapePos(), pad->GetBoundingRadius(), searchPads );
+            break;
         }
 
-        for( auto& trackItem : m_trackList )
+        case PCB_TRACE_T:
         {
-            auto track = static_cast<TRACK*> ( trackItem->Parent() );
+            auto track = static_cast<TRACK*> ( parent );
             int dist_max = track->GetWidth() / 2;
-            auto searchTracks = std::bind( checkForConnection, _1, trackItem, dist_max );
+            auto searchTracks = std::bind( checkForConnection, _1, item, dist_max );
 
             m_trackList.FindNearby( track->GetStart(), dist_max, searchTracks );
             m_trackList.FindNearby( track->GetEnd(), dist_max, searchTracks );
+            break;
         }
 
-        for( auto& viaItem : m_viaList )
+        case PCB_VIA_T:
         {
-            auto via = static_cast<VIA*> ( viaItem->Parent() );
+            auto via = static_cast<VIA*> ( parent );
             int dist_max = via->GetWidth() / 2;
-            auto searchVias = std::bind( checkForConnection, _1, viaItem, dist_max );
+            auto searchVias = std::bind( checkForConnection, _1, item, dist_max );
 
-            totalDirtyCount++;
             m_viaList.FindNearby( via->GetStart(), dist_max, searchVias );
             m_trackList.FindNearby( via->GetStart(), dist_max, searchVias );
+            break;
         }
-    }
 
-#ifdef PROFILE
-    search_basic.Show();
-#endif
-
-    if( aIncludeZones )
-    {
-        for( auto& item : m_zoneList )
+        default:
         {
-            auto zoneItem = static_cast<CN_ZONE *> (item);
+            auto zoneItem = static_cast<CN_ZONE *> ( item );
             auto searchZones = std::bind( checkForConnection, _1, zoneItem );
 
-            if( zoneItem->Dirty() || m_padList.IsDirty() || m_trackList.IsDirty() || m_viaList.IsDirty() )
+            m_viaList.FindNearby( zoneItem->BBox(), searchZones );
+            m_trackList.FindNearby( zoneItem->BBox(), searchZones );
+            m_padList.FindNearby( zoneItem->BBox(), searchZones );
+
+            // Only the zone areas are tested against other zones: test both ways
+            m_zoneList.FindNearbyZones( zoneItem->BBox(),
+                    [&checkInterZoneConnection, zoneItem] ( CN_ZONE* aZone )
+                    {
+                        checkInterZoneConnection( aZone, zoneItem );
+                        checkInterZoneConnection( zoneItem, aZone );
+                    } );
+
+            // Nothing else searches the zones
+            continue;
+        }
+        }
+
+        for( auto& anchor : item->Anchors() )
+        {
+            CN_ANCHOR_PTR point = &anchor;
+            const VECTOR2I& pos = anchor.Pos();
+
+            // The pads search the pads, tracks and vias
+            if( searchedPads )
+            {
+                m_padList.FindNearby( pos, m_padList.GetMaxSearchRadius(),
+                        [&checkForConnection, point] ( CN_ANCHOR_PTR aPadAnchor )
+                        {
+                            if( !aPadAnchor->IsDirty() )
+                                checkForConnection( point, aPadAnchor->Item() );
+                        } );
+            }
+
+            // The tracks search the tracks
+            if( searchedTracks && parent->Type() == PCB_TRACE_T )
+            {
+                m_trackList.FindNearby( pos, m_trackList.GetMaxSearchRadius(),
+                        [&checkForConnection, point] ( CN_ANCHOR_PTR aTrackAnchor )
+                        {
+                            auto track = static_cast<TRACK*>( aTrackAnchor->Parent() );
+
+                            if( !aTrackAnchor->IsDirty() )
+                                checkForConnection( point, aTrackAnchor->Item(),
+                                                    track->GetWidth() / 2 );
+                        } );
+            }
+
+            // The vias search the vias and tracks
+            if( searchedVias && parent->Type() != PCB_PAD_T )
             {
-                totalDirtyCount++;
-                m_viaList.FindNearby( zoneItem->BBox(), searchZones );
-                m_trackList.FindNearby( zoneItem->BBox(), searchZones );
-                m_padList.FindNearby( zoneItem->BBox(), searchZones );
-                m_zoneList.FindNearbyZones( zoneItem->BBox(), std::bind( checkInterZoneConnection, _1, zoneItem ) );
+                m_viaList.FindNearby( pos, m_viaList.GetMaxSearchRadius(),
+                        [&checkForConnection, point] ( CN_ANCHOR_PTR aViaAnchor )
+                        {
+                            if( !aViaAnchor->IsDirty() )
+                                checkForConnection( point, aViaAnchor->Item() );
+                        } );
+            }
+
+            // The zones search the pads, tracks and vias in their bounding box
+            for( auto zoneItem : searchedZones )
+            {
+                if( zoneItem->BBox().Contains( pos ) )
+                    checkForConnection( point, zoneItem );
             }
         }
+    }
 
-        m_zoneList.ClearDirtyFlags();
+    m_stats.m_itemsSearched += m_dirtyItems.size();
+
+    // The net propagation starts from the new items
+    for( auto item : m_dirtyItems )
+    {
+        item->SetDirty( false );
+        m_propagateSeeds.push_back( item );
     }
 
-    m_padList.ClearDirtyFlags();
-    m_viaList.ClearDirtyFlags();
-    m_trackList.ClearDirtyFlags();
+    m_dirtyItems.clear();
+
+    m_padList.SetDirty( false );
+    m_viaList.SetDirty( false );
+    m_trackList.SetDirty( false );
+    m_zoneList.SetDirty( false );
 
 #ifdef CONNECTIVITY_DEBUG
     printf("Search end\n");
@@ -525,6 +614,8 @@ void CN_CONNECTIVITY_ALGO::searchConnections( bool aIncludeZones )
 #ifdef PROFILE
     search_cnt.Show();
 #endif
+
+    m_stats.m_searchTime += GetRunningMicroSecs() - start;
 }
 
 
@@ -538,14 +629,55 @@ void CN_ITEM::RemoveInvalidRefs()
 }
 
 
+void CN_LIST::sort()
+{
+    if( m_sorted )
+        return;
+
+    std::vector<std::pair<VECTOR2I, CN_ANCHOR_PTR>> sorted;
+
+    sorted.reserve( m_anchors.size() );
+
+    for( unsigned int i = 0; i < m_anchors.size(); i++ )
+        sorted.emplace_back( m_anchorPos[i], m_anchors[i] );
+
+    std::sort( sorted.begin(), sorted.end(),
+            [] ( const std::pair<VECTOR2I, CN_ANCHOR_PTR>& a,
+                 const std::pair<VECTOR2I, CN_ANCHOR_PTR>& b )
+    {
+        if( a.first.x == b.first.x )
+            return a.first.y < b.first.y;
+        else
+            return a.first.x < b.first.x;
+    } );
+
+    for( unsigned int i = 0; i < sorted.size(); i++ )
+    {
+        m_anchorPos[i] = sorted[i].first;
+        m_anchors[i] = sorted[i].second;
+    }
+
+    m_sorted = true;
+}
+
+
 void CN_LIST::RemoveInvalidItems( std::vector<CN_ITEM*>& aGarbage )
 {
-    auto lastAnchor = std::remove_if(m_anchors.begin(), m_anchors.end(),
-        [] ( const CN_ANCHOR_PTR anchor ) {
-            return !anchor->Valid();
-        } );
+    // Compact the anchor arrays, keeping their order
+    unsigned int lastAnchor = 0;
 
-    m_anchors.resize( lastAnchor - m_anchors.begin() );
+    for( unsigned int i = 0; i < m_anchors.size(); i++ )
+    {
+        if( m_anchors[i]->Valid() )
+        {
+            m_anchorPos[lastAnchor] = m_anchorPos[i];
+            m_anchors[lastAnchor] = m_anchors[i];
+            lastAnchor++;
+        }
+    }
+
+    m_anchorPos.resize( lastAnchor );
+    m_anchors.resize( lastAnchor );
 
     auto lastItem = std::remove_if(m_items.begin(), m_items.end(), [&aGarbage] ( CN_ITEM* item ) {
         if( !item->Valid() )
@@ -585,15 +717,19 @@ const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::SearchClusters( CLUST
     bool includeZones = ( aMode != CSM_PROPAGATE );
     bool withinAnyNet = ( aMode != CSM_PROPAGATE );
 
-    std::deque<CN_ITEM*> Q;
-    CN_ITEM* head = nullptr;
-    CLUSTERS clusters;
-
     if( isDirty() )
-        searchConnections( includeZones );
+        searchConnections();
+
+    // Number the items to search. The items left out get -1, so the connections to them
+    // are ignored.
+    std::vector<CN_ITEM*>& items = m_searchItems;
 
-    auto addToSearchList = [&head, withinAnyNet, aSingleNet, aTypes] ( CN_ITEM *aItem )
+    items.clear();
+
+    auto addToSearchList = [&items, withinAnyNet, aSingleNet, aTypes] ( CN_ITEM *aItem )
     {
+        aItem->SetSearchIndex( -1 );
+
         if( withinAnyNet && aItem->Net() <= 0 )
             return;
 
@@ -617,13 +753,8 @@ const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::SearchClusters( CLUST
         if( !found )
             return;
 
-        aItem->ListClear();
-        aItem->SetVisited( false );
-
-        if( !head )
-            head = aItem;
-        else
-            head->ListInsert( aItem );
+        aItem->SetSearchIndex( items.size() );
+        items.push_back( aItem );
     };
 
     std::for_each( m_padList.begin(), m_padList.end(), addToSearchList );
@@ -634,58 +765,79 @@ const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::SearchClusters( CLUST
     {
         std::for_each( m_zoneList.begin(), m_zoneList.end(), addToSearchList );
     }
+    else
+    {
+        for( auto item : m_zoneList )
+            item->SetSearchIndex( -1 );
+    }
 
+    CLUSTERS clusters = buildClusters( withinAnyNet );
 
-    while( head )
+    std::stable_sort( clusters.begin(), clusters.end(), []( CN_CLUSTER_PTR a, CN_CLUSTER_PTR b ) {
+        return a->OriginNet() < b->OriginNet();
+    } );
+
+#ifdef CONNECTIVITY_DEBUG
+    printf("Active clusters: %d\n");
+
+    for( auto cl : clusters )
     {
-        CN_CLUSTER_PTR cluster ( new CN_CLUSTER() );
+        printf( "Net %d\n", cl->OriginNet() );
+        cl->Dump();
+    }
+#endif
 
-        Q.clear();
-        CN_ITEM* root = head;
-        root->SetVisited ( true );
+    return clusters;
+}
 
-        head = root->ListRemove();
 
-        Q.push_back( root );
+CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::buildClusters( bool aWithinNet )
+{
+    std::vector<CN_ITEM*>& items = m_searchItems;
+    CLUSTERS clusters;
 
-        while( Q.size() )
+    // Merge the sets of the connected items. Within a net, the connections to other nets
+    // do not count.
+    DISJOINT_SET& sets = m_searchSets;
+
+    sets.Reset( items.size() );
+
+    for( unsigned int i = 0; i < items.size(); i++ )
+    {
+        CN_ITEM* item = items[i];
+
+        for( auto n : item->ConnectedItems() )
         {
-            CN_ITEM* current = Q.front();
+            int j = n->SearchIndex();
 
-            Q.pop_front();
-            cluster->Add( current );
+            if( j < 0 || !n->Valid() )
+                continue;
 
-            for( auto n : current->ConnectedItems() )
-            {
-                if( withinAnyNet && n->Net() != root->Net() )
-                    continue;
+            if( aWithinNet && n->Net() != item->Net() )
+                continue;
 
-                if( !n->Visited() && n->Valid() )
-                {
-                    n->SetVisited( true );
-                    Q.push_back( n );
-                    head = n->ListRemove();
-                }
-            }
+            sets.Union( i, j );
         }
-
-        clusters.push_back( cluster );
     }
 
+    // One cluster per set, the items in the search order
+    std::vector<int> setCluster( items.size(), -1 );
 
-    std::sort( clusters.begin(), clusters.end(), []( CN_CLUSTER_PTR a, CN_CLUSTER_PTR b ) {
-        return a->OriginNet() < b->OriginNet();
-    } );
+    for( unsigned int i = 0; i < items.size(); i++ )
+    {
+        int root = sets.Find( i );
 
-#ifdef CONNECTIVITY_DEBUG
-    printf("Active clusters: %d\n");
+        if( setCluster[root] < 0 )
+        {
+            setCluster[root] = clusters.size();
+            clusters.push_back( std::make_shared<CN_CLUSTER>() );
+        }
 
-    for( auto cl : clusters )
-    {
-        printf( "Net %d\n", cl->OriginNet() );
-        cl->Dump();
+        clusters[ setCluster[root] ]->Add( items[i] );
     }
-#endif
+
+    for( auto item : items )
+        item->SetSearchIndex( -1 );
 
     return clusters;
 }
@@ -793,9 +945,53 @@ void CN_CONNECTIVITY_ALGO::propagateConnections()
 
 void CN_CONNECTIVITY_ALGO::PropagateNets()
 {
-    //searchConnections( false );
-    m_connClusters = SearchClusters( CSM_PROPAGATE );
+    if( isDirty() )
+        searchConnections();
+
+    unsigned start = GetRunningMicroSecs();
+
+    // Only the clusters of the items added or disconnected since the last propagation may
+    // have changed. They are collected by following the connections from these items,
+    // across the nets and leaving the zones out, as SearchClusters( CSM_PROPAGATE ) does.
+    std::vector<CN_ITEM*>& items = m_searchItems;
+
+    items.clear();
+
+    auto visit = [&items] ( CN_ITEM* aItem )
+    {
+        if( !aItem->Valid() || aItem->SearchIndex() >= 0 )
+            return;
+
+        switch( aItem->Parent()->Type() )
+        {
+        case PCB_PAD_T:
+        case PCB_TRACE_T:
+        case PCB_VIA_T:
+            aItem->SetSearchIndex( items.size() );
+            items.push_back( aItem );
+            break;
+
+        default:
+            break;
+        }
+    };
+
+    for( auto item : m_propagateSeeds )
+        visit( item );
+
+    for( unsigned int i = 0; i < items.size(); i++ )
+    {
+        for( auto connected : items[i]->ConnectedItems() )
+            visit( connected );
+    }
+
+    m_propagateSeeds.clear();
+
+    m_connClusters = buildClusters( false );
     propagateConnections();
+
+    m_stats.m_clustersPropagated += m_connClusters.size();
+    m_stats.m_clusterTime += GetRunningMicroSecs() - start;
 }
 
 
@@ -809,9 +1005,11 @@ void CN_CONNECTIVITY_ALGO::FindIsolatedCopperIslands( ZONE_CONTAINER* aZone, std
     Remove( aZone );
     Add( aZone );
 
-    m_connClusters = SearchClusters( CSM_CONNECTIVITY_CHECK );
+    // The islands are the clusters of the zone net without a pad
+    constexpr KICAD_T types[] = { PCB_TRACE_T, PCB_PAD_T, PCB_VIA_T, PCB_ZONE_AREA_T, PCB_MODULE_T, EOT };
+    const auto clusters = SearchClusters( CSM_CONNECTIVITY_CHECK, types, aZone->GetNetCode() );
 
-    for( auto cluster : m_connClusters )
+    for( auto cluster : clusters )
     {
         if( cluster->Contains( aZone ) && cluster->IsOrphaned() )
         {
@@ -831,7 +1029,66 @@ void CN_CONNECTIVITY_ALGO::FindIsolatedCopperIslands( ZONE_CONTAINER* aZone, std
 
 const CN_CONNECTIVITY_ALGO::CLUSTERS& CN_CONNECTIVITY_ALGO::GetClusters()
 {
-    m_ratsnestClusters = SearchClusters( CSM_RATSNEST );
+    if( isDirty() )
+        searchConnections();
+
+    unsigned start = GetRunningMicroSecs();
+
+    // The clusters of a net do not change until it is marked as dirty: only the clusters
+    // of the dirty nets are searched again, as SearchClusters( CSM_RATSNEST ) does
+    CLUSTERS clusters;
+
+    for( auto cluster : m_ratsnestClusters )
+    {
+        if( !IsNetDirty( cluster->OriginNet() ) )
+            clusters.push_back( cluster );
+    }
+
+    std::vector<CN_ITEM*>& items = m_searchItems;
+
+    items.clear();
+
+    auto addToSearchList = [this, &items] ( CN_ITEM* aItem )
+    {
+        if( !aItem->Valid() || aItem->Net() <= 0 || !IsNetDirty( aItem->Net() ) )
+            return;
+
+        // The old-style zones are not part of the ratsnest
+        if( aItem->Parent()->Type() == PCB_ZONE_T )
+            return;
+
+        aItem->SetSearchIndex( items.size() );
+        items.push_back( aItem );
+    };
+
+    std::for_each( m_padList.begin(), m_padList.end(), addToSearchList );
+    std::for_each( m_trackList.begin(), m_trackList.end(), addToSearchList );
+    std::for_each( m_viaList.begin(), m_viaList.end(), addToSearchList );
+    std::for_each( m_zoneList.begin(), m_zoneList.end(), addToSearchList );
+
+    CLUSTERS rebuilt = buildClusters( true );
+
+    m_stats.m_clustersRebuilt += rebuilt.size();
+
+    clusters.insert( clusters.end(), rebuilt.begin(), rebuilt.end() );
+
+    std::stable_sort( clusters.begin(), clusters.end(), []( CN_CLUSTER_PTR a, CN_CLUSTER_PTR b ) {
+        return a->OriginNet() < b->OriginNet();
+    } );
+
+    m_ratsnestClusters = clusters;
+
+    // The ratsnest compares the clusters of the anchors by their index
+    ForEachItem( [] ( CN_ITEM* aItem ) { aItem->SetClusterId( -1 ); } );
+
+    for( unsigned int i = 0; i < m_ratsnestClusters.size(); i++ )
+    {
+        for( auto item : *m_ratsnestClusters[i] )
+            item->SetClusterId( i );
+    }
+
+    m_stats.m_clusterTime += GetRunningMicroSecs() - start;
+
     return m_ratsnestClusters;
 }
 
@@ -939,6 +1196,8 @@ void CN_CONNECTIVITY_ALGO::Clear()
 {
     m_ratsnestClusters.clear();
     m_connClusters.clear();
+    m_dirtyItems.clear();
+    m_propagateSeeds.clear();
     m_itemMap.clear();
     m_padList.Clear();
     m_trackList.Clear();
@@ -982,16 +1241,16 @@ void CN_CONNECTIVITY_ALGO::ForEachAnchor( std::function<void(CN_ANCHOR_PTR)> aFu
 
 bool CN_ANCHOR::IsDangling() const
 {
-    if( !m_cluster )
+    // The cluster of the anchor is its item alone when no other item of the net
+    // touches it (the items without a net are never part of a cluster)
+    if( !m_item->Valid() || m_item->Net() <= 0 )
         return true;
 
-    int validCount = 0;
-
-    for( auto item : *m_cluster )
+    for( auto item : m_item->ConnectedItems() )
     {
-        if( item->Valid() )
-            validCount++;
+        if( item->Valid() && item->Net() == m_item->Net() )
+            return false;
     }
 
-    return validCount <= 1;
+    return true;
 }
@@ -34,14 +34,13 @@
 #include <class_zone.h>
 
 #include <geometry/shape_poly_set.h>
-#include <geometry/poly_grid_partition.h>
 
 #include <memory>
 #include <algorithm>
 #include <functional>
 #include <vector>
 #include <deque>
-#include <intrusive_list.h>
+#include <disjoint_set.h>
 
 #include <connectivity.h>
 
@@ -110,16 +109,6 @@ public:
         return m_noline;
     }
 
-    inline void SetCluster( std::shared_ptr<CN_CLUSTER> aCluster )
-    {
-        m_cluster = aCluster;
-    }
-
-    inline std::shared_ptr<CN_CLUSTER> GetCluster() const
-    {
-        return m_cluster;
-    }
-
     bool IsDangling() const;
 
     // Tag used for unconnected items.
@@ -137,14 +126,12 @@ private:
 
     /// Whether it the node can be a target for ratsnest lines
     bool m_noline = false;
-
-    /// Cluster to which the anchor belongs
-    std::shared_ptr<CN_CLUSTER> m_cluster;
 };
 
 
-typedef std::shared_ptr<CN_ANCHOR>  CN_ANCHOR_PTR;
-typedef std::vector<CN_ANCHOR_PTR>  CN_ANCHORS;
+/// The anchors are stored in their item, and live as long as it
+typedef CN_ANCHOR*                  CN_ANCHOR_PTR;
+typedef std::vector<CN_ANCHOR>      CN_ANCHORS;
 
 
 class CN_EDGE
@@ -185,8 +172,8 @@ public:
     }
 
 private:
-    CN_ANCHOR_PTR m_source;
-    CN_ANCHOR_PTR m_target;
+    CN_ANCHOR_PTR m_source = nullptr;
+    CN_ANCHOR_PTR m_target = nullptr;
     unsigned int m_weight = 0;
     bool m_visible = true;
 };
@@ -253,7 +240,7 @@ typedef std::shared_ptr<CN_CLUSTER> CN_CLUSTER_PTR;
 
 
 // basic connectivity item
-class CN_ITEM : public INTRUSIVE_LIST<CN_ITEM>
+class CN_ITEM
 {
 private:
     BOARD_CONNECTED_ITEM* m_parent;
@@ -263,10 +250,14 @@ private:
     ///> list of items physically connected (touching)
     CONNECTED_ITEMS m_connected;
 
+    ///> the anchors, allocated once: the lists keep pointers to them
     CN_ANCHORS m_anchors;
 
-    ///> visited flag for the BFS scan
-    bool m_visited;
+    ///> index of the item in the set searched by the cluster search, or -1
+    int m_searchIndex;
+
+    ///> index of the cluster of the item in the last ratsnest cluster search, or -1
+    int m_clusterId;
 
     ///> can the net propagator modify the netcode?
     bool m_canChangeNet;
@@ -284,19 +275,22 @@ public:
     {
         m_parent = aParent;
         m_canChangeNet = aCanChangeNet;
-        m_visited = false;
+        m_searchIndex = -1;
+        m_clusterId = -1;
         m_valid = true;
         m_dirty = true;
-        m_anchors.reserve( 2 );
+        m_anchors.reserve( aAnchorCount );
     }
 
     virtual ~CN_ITEM() {};
 
     CN_ANCHOR_PTR AddAnchor( const VECTOR2I& aPos )
     {
-        m_anchors.emplace_back( std::make_shared<CN_ANCHOR>( aPos, this ) );
-        //printf("%p add %d\n", this, m_anchors.size() );
-        return m_anchors.back();
+        // The anchors must not move once their address is given
+        assert( m_anchors.size() < m_anchors.capacity() );
+
+        m_anchors.emplace_back( aPos, this );
+        return &m_anchors.back();
     }
 
     CN_ANCHORS& Anchors()
@@ -339,14 +333,25 @@ public:
         m_connected.clear();
     }
 
-    void SetVisited( bool aVisited )
+    void SetSearchIndex( int aIndex )
     {
-        m_visited = aVisited;
+        m_searchIndex = aIndex;
     }
 
-    bool Visited() const
+    int SearchIndex() const
     {
-        return m_visited;
+        return m_searchIndex;
+    }
+
+    void SetClusterId( int aId )
+    {
+        m_clusterId = aId;
+    }
+
+    /// The index of the item cluster in the clusters returned by the last GetClusters()
+    int ClusterId() const
+    {
+        return m_clusterId;
     }
 
     bool CanChangeNet() const
@@ -397,33 +402,42 @@ typedef std::shared_ptr<CN_ITEM> CN_ITEM_PTR;
 class CN_LIST
 {
 private:
-    bool m_dirty;
-    std::vector<CN_ANCHOR_PTR> m_anchors;
+    bool m_dirty;       ///< items were added or removed since the last search
+    bool m_sorted;      ///< the anchors are sorted, see sort()
+
+    ///> the largest distance an item of the list searches its connections within
+    int  m_maxSearchRadius;
+
+    // The anchors of the items, as parallel arrays: the searches only read the positions,
+    // which are sorted by x, then y (see sort())
+    std::vector<VECTOR2I>       m_anchorPos;
+    std::vector<CN_ANCHOR_PTR>  m_anchors;
 
 protected:
     std::vector<CN_ITEM*> m_items;
 
     void addAnchor( VECTOR2I pos, CN_ITEM* item )
     {
+        m_anchorPos.push_back( pos );
         m_anchors.push_back( item->AddAnchor( pos ) );
+        m_sorted = false;
     }
 
-private:
-
-    void sort()
+    void updateMaxSearchRadius( int aRadius )
     {
-        if( m_dirty )
-        {
-            std::sort( m_anchors.begin(), m_anchors.end() );
-
-            m_dirty = false;
-        }
+        m_maxSearchRadius = std::max( m_maxSearchRadius, aRadius );
     }
 
+private:
+
+    void sort();
+
 public:
     CN_LIST()
     {
         m_dirty = false;
+        m_sorted = true;
+        m_maxSearchRadius = 0;
     }
 
     void Clear()
@@ -432,6 +446,10 @@ public:
             delete item;
 
         m_items.clear();
+        m_anchorPos.clear();
+        m_anchors.clear();
+        m_sorted = true;
+        m_maxSearchRadius = 0;
     }
 
     using ITER = decltype(m_items)::iterator;
@@ -439,7 +457,7 @@ public:
     ITER begin() { return m_items.begin(); };
     ITER end() { return m_items.end(); };
 
-    std::vector<CN_ANCHOR_PTR>& Anchors() { return m_anchors; }
+    const std::vector<CN_ANCHOR_PTR>& Anchors() const { return m_anchors; }
 
     template <class T>
     void FindNearby( VECTOR2I aPosition, int aDistMax, T aFunc, bool aDirtyOnly = false );
@@ -459,26 +477,21 @@ public:
 
     void ClearConnections()
     {
-        for( auto& anchor : m_anchors )
-            anchor->Item()->ClearConnections();
+        for( auto item : m_items )
+            item->ClearConnections();
     }
 
     void RemoveInvalidItems( std::vector<CN_ITEM*>& aGarbage );
 
-    void ClearDirtyFlags()
-    {
-        for( auto item : m_items )
-            item->SetDirty( false );
-
-        SetDirty( false );
-    }
-
-    void MarkAllAsDirty()
+    /**
+     * Function GetMaxSearchRadius
+     * @return the largest distance an item ever added to the list searched its
+     * connections within: the items of the list found by a search are its anchors
+     * closer than this distance.
+     */
+    int GetMaxSearchRadius() const
     {
-        for( auto item : m_items )
-            item->SetDirty( true );
-
-        SetDirty( true );
+        return m_maxSearchRadius;
     }
 
     int Size() const
@@ -493,10 +506,11 @@ class CN_PAD_LIST : public CN_LIST
 public:
     CN_ITEM* Add( D_PAD* pad )
     {
-        auto item = new CN_ITEM( pad, false, 2 );
+        auto item = new CN_ITEM( pad, false, 1 );
 
         addAnchor( pad->ShapePos(), item );
         m_items.push_back( item );
+        updateMaxSearchRadius( pad->GetBoundingRadius() );
 
         SetDirty();
         return item;
@@ -515,6 +529,7 @@ public:
 
         addAnchor( track->GetStart(), item );
         addAnchor( track->GetEnd(), item );
+        updateMaxSearchRadius( track->GetWidth() / 2 );
         SetDirty();
 
         return item;
@@ -527,10 +542,11 @@ class CN_VIA_LIST : public CN_LIST
 public:
     CN_ITEM* Add( VIA* via )
     {
-        auto item = new CN_ITEM( via, true );
+        auto item = new CN_ITEM( via, true, 1 );
 
         m_items.push_back( item );
         addAnchor( via->GetStart(), item );
+        updateMaxSearchRadius( via->GetWidth() / 2 );
         SetDirty();
         return item;
     }
@@ -541,7 +557,8 @@ class CN_ZONE : public CN_ITEM
 {
 public:
     CN_ZONE( ZONE_CONTAINER* aParent, bool aCanChangeNet, int aSubpolyIndex ) :
-        CN_ITEM( aParent, aCanChangeNet ),
+        CN_ITEM( aParent, aCanChangeNet,
+                 aParent->GetFilledPolysList().COutline( aSubpolyIndex ).PointCount() ),
         m_subpolyIndex( aSubpolyIndex )
     {
         SHAPE_LINE_CHAIN outline = aParent->GetFilledPolysList().COutline( aSubpolyIndex );
@@ -549,7 +566,8 @@ public:
         outline.SetClosed( true );
         outline.Simplify();
 
-        m_cachedPoly.reset( new POLY_GRID_PARTITION( outline, 16 ) );
+        m_cachedPoly.AddOutline( outline );
+        m_bbox = outline.BBox();
     }
 
     int SubpolyIndex() const
@@ -559,19 +577,25 @@ public:
 
     bool ContainsAnchor( const CN_ANCHOR_PTR anchor ) const
     {
-        auto zone = static_cast<ZONE_CONTAINER*> ( Parent() );
-        return m_cachedPoly->ContainsPoint( anchor->Pos(), zone->GetMinThickness() );
+        return ContainsPoint( anchor->Pos() );
     }
 
+    ///> Tells if p is inside of the zone area or on its outline, or closer to the outline
+    ///> than the minimum thickness of the zone
     bool ContainsPoint( const VECTOR2I p ) const
     {
         auto zone = static_cast<ZONE_CONTAINER*> ( Parent() );
-        return m_cachedPoly->ContainsPoint( p, zone->GetMinThickness() );
+
+        if( m_cachedPoly.Contains( p ) )
+            return true;
+
+        return zone->GetMinThickness() > 0
+               && m_cachedPoly.IsNearEdge( p, zone->GetMinThickness() );
     }
 
     const BOX2I& BBox() const
     {
-        return m_cachedPoly->BBox();
+        return m_bbox;
     }
 
     virtual int             AnchorCount() const override;
@@ -579,7 +603,10 @@ public:
 
 private:
     std::vector<VECTOR2I> m_testOutlinePoints;
-    std::unique_ptr<POLY_GRID_PARTITION> m_cachedPoly;
+
+    ///> The simplified outline of the zone area, indexed by the point queries
+    SHAPE_POLY_SET m_cachedPoly;
+    BOX2I m_bbox;
     int m_subpolyIndex;
 };
 
@@ -619,11 +646,13 @@ public:
 template <class T>
 void CN_LIST::FindNearby( BOX2I aBBox, T aFunc, bool aDirtyOnly )
 {
-    for( auto p : m_anchors )
+    for( unsigned int i = 0; i < m_anchorPos.size(); i++ )
     {
-        if( p->Valid() && aBBox.Contains( p->Pos() ) )
+        if( aBBox.Contains( m_anchorPos[i] ) )
         {
-            if( !aDirtyOnly || p->IsDirty() )
+            auto p = m_anchors[i];
+
+            if( p->Valid() && ( !aDirtyOnly || p->IsDirty() ) )
                 aFunc( p );
         }
     }
@@ -651,98 +680,35 @@ void CN_ZONE_LIST::FindNearbyZones( BOX2I aBBox, T aFunc, bool aDirtyOnly )
 template <class T>
 void CN_LIST::FindNearby( VECTOR2I aPosition, int aDistMax, T aFunc, bool aDirtyOnly )
 {
-    /* Search items in m_Candidates that position is <= aDistMax from aPosition
+    /* Search the anchors which position is <= aDistMax from aPosition
      * (Rectilinear distance)
-     * m_Candidates is sorted by X then Y values, so a fast binary search is used
-     * to locate the "best" entry point in list
-     * The best entry is a pad having its m_Pos.x == (or near) aPosition.x
-     * All candidates are near this candidate in list
-     * So from this entry point, a linear search is made to find all candidates
+     * The anchors are sorted by X then Y values, so a binary search is used
+     * to find the first anchor having its x >= aPosition.x - aDistMax,
+     * then the anchors are scanned until their x > aPosition.x + aDistMax.
+     * Only the positions are read, until a candidate is found.
      */
 
     sort();
 
-    int idxmax = m_anchors.size() - 1;
+    auto first = std::lower_bound( m_anchorPos.begin(), m_anchorPos.end(),
+                                   aPosition.x - aDistMax,
+                                   [] ( const VECTOR2I& aPos, int aX ) { return aPos.x < aX; } );
 
-    int delta = idxmax + 1;
-    int idx = 0;        // Starting index is the beginning of list
-
-    while( delta )
-    {
-        // Calculate half size of remaining interval to test.
-        // Ensure the computed value is not truncated (too small)
-        if( ( delta & 1 ) && ( delta > 1 ) )
-            delta++;
-
-        delta /= 2;
-
-        auto p = m_anchors[idx];
-
-        int dist = p->Pos().x - aPosition.x;
-
-        if( std::abs( dist ) <= aDistMax )
-        {
-            break;                              // A good entry point is found. The list can be scanned from this point.
-        }
-        else if( p->Pos().x < aPosition.x )     // We should search after this point
-        {
-            idx += delta;
-
-            if( idx > idxmax )
-                idx = idxmax;
-        }
-        else    // We should search before this p
-        {
-            idx -= delta;
-
-            if( idx < 0 )
-                idx = 0;
-        }
-    }
-
-    /* Now explore the candidate list from the "best" entry point found
-     * (candidate "near" aPosition.x)
-     * We exp the list until abs(candidate->m_Point.x - aPosition.x) > aDistMashar* Currently a linear search is made because the number of candidates
-     * having the right X position is usually small
-     */
-    // search next candidates in list
-    VECTOR2I diff;
-
-    for( int ii = idx; ii <= idxmax; ii++ )
+    for( unsigned int ii = first - m_anchorPos.begin(); ii < m_anchorPos.size(); ii++ )
     {
-        auto& p = m_anchors[ii];
-        diff = p->Pos() - aPosition;;
+        const VECTOR2I diff = m_anchorPos[ii] - aPosition;
 
-        if( std::abs( diff.x ) > aDistMax )
+        if( diff.x > aDistMax )
             break; // Exit: the distance is to long, we cannot find other candidates
 
         if( std::abs( diff.y ) > aDistMax )
             continue; // the y distance is to long, but we can find other candidates
 
         // We have here a good candidate: add it
-        if( p->Valid() )
-            if( !aDirtyOnly || p->IsDirty() )
-                aFunc( p );
-    }
+        auto p = m_anchors[ii];
 
-    // search previous candidates in list
-    for( int ii = idx - 1; ii >=0; ii-- )
-    {
-        auto& p = m_anchors[ii];
-        diff = p->Pos() - aPosition;
-
-        if( abs( diff.x ) > aDistMax )
-            break;
-
-        if( abs( diff.y ) > aDistMax )
-            continue;
-
-        // We have here a good candidate:add it
-        if( p->Valid() )
-        {
-            if( !aDirtyOnly || p->IsDirty() )
-                aFunc( p );
-        }
+        if( p->Valid() && ( !aDirtyOnly || p->IsDirty() ) )
+            aFunc( p );
     }
 }
 
@@ -761,8 +727,6 @@ public:
 
 private:
 
-    bool m_lastSearchWithZones = false;
-
     class ITEM_MAP_ENTRY
     {
 public:
@@ -807,7 +771,29 @@ public:
     CLUSTERS m_ratsnestClusters;
     std::vector<bool> m_dirtyNets;
 
-    void    searchConnections( bool aIncludeZones = false );
+    ///> the items of the last cluster search and their sets, kept to reuse their memory
+    std::vector<CN_ITEM*> m_searchItems;
+    DISJOINT_SET m_searchSets;
+
+    ///> the items added since the last connection search
+    std::vector<CN_ITEM*> m_dirtyItems;
+
+    ///> the items which clusters may have changed since the nets were last propagated
+    std::vector<CN_ITEM*> m_propagateSeeds;
+
+    CONNECTIVITY_STATS m_stats;
+
+    void    searchConnections();
+
+    /**
+     * Function buildClusters
+     * groups the connected items of m_searchItems in clusters, in the order of their
+     * first item. The connections to items outside of m_searchItems are ignored.
+     * The search index of the items must be their index in m_searchItems; it is reset
+     * to -1 on return.
+     * @param aWithinNet tells to ignore the connections between items of different nets.
+     */
+    CLUSTERS buildClusters( bool aWithinNet );
 
     void    update();
     void    propagateConnections();
@@ -818,6 +804,7 @@ public:
         auto item = c.Add( brditem );
 
         m_itemMap[ brditem ] = ITEM_MAP_ENTRY( item );
+        m_dirtyItems.push_back( item );
     }
 
     bool addConnectedItem( BOARD_CONNECTED_ITEM* aItem );
@@ -842,7 +829,7 @@ public:
 
     bool IsNetDirty( int aNet ) const
     {
-        if( aNet < 0 )
+        if( aNet < 0 || aNet >= (int) m_dirtyNets.size() )
             return false;
 
         return m_dirtyNets[ aNet ];
@@ -895,8 +882,15 @@ public:
 
     void MarkNetAsDirty( int aNet );
 
-};
+    const CONNECTIVITY_STATS& GetStats() const
+    {
+        return m_stats;
+    }
 
-bool operator<( const CN_ANCHOR_PTR a, const CN_ANCHOR_PTR b );
+    void ResetStats()
+    {
+        m_stats = CONNECTIVITY_STATS();
+    }
+};
 
 #endif
@@ -173,8 +173,7 @@ void PCB_EDIT_FRAME::Delete_net( wxDC* DC, TRACK* aTrack )
         if( segm->GetNetCode() != netcode )
             break;
 
-        GetBoard()->GetConnectivity()->Remove( segm );
-        GetBoard()->m_Track.Remove( segm );
+        GetBoard()->Remove( segm );
 
         // redraw the area where the track was
         m_canvas->RefreshDrawingRect( segm->GetBoundingBox() );
@@ -219,8 +218,7 @@ void PCB_EDIT_FRAME::Remove_One_Track( wxDC* DC, TRACK* pt_segm )
                      << TO_UTF8( TRACK::ShowState( tracksegment->GetStatus() ) ) \
                      << std::endl; )
 
-        GetBoard()->GetConnectivity()->Remove( tracksegment );
-        GetBoard()->m_Track.Remove( tracksegment );
+        GetBoard()->Remove( tracksegment );
 
         // redraw the area where the track was
         m_canvas->RefreshDrawingRect( tracksegment->GetBoundingBox() );
@@ -40,6 +40,7 @@
 
 #include <pcbnew_id.h>
 #include <class_track.h>
+#include <zone_obstacle_cache.h>
 #include <macros.h>
 #include <html_messagebox.h>
 
@@ -701,6 +702,9 @@ bool DIALOG_DESIGN_RULES::TransferDataFromWindow()
     CopyGlobalRulesToBoard();
     CopyDimensionsListsToBoard();
     m_BrdSettings->SetCurrentNetClass( NETCLASS::Default );
+
+    // The clearances may have changed everywhere: the next zone refill is a full one
+    m_Pcb->GetZoneObstacleCache()->ResetDirtyAreas();
     return true;
 }
 
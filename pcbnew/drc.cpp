@@ -38,6 +38,7 @@
 #include <class_pad.h>
 #include <class_zone.h>
 #include <class_pcb_text.h>
+#include <class_marker_pcb.h>
 #include <class_draw_panel_gal.h>
 #include <view/view.h>
 #include <geometry/seg.h>
@@ -51,9 +52,17 @@
 #include <pcbnew.h>
 #include <drc_stuff.h>
 
+#include <drc_item_index.h>
+#include <drc_live_context.h>
 #include <dialog_drc.h>
 #include <wx/progdlg.h>
 #include <board_commit.h>
+#include <sync_queue.h>
+#include <thread_pool.h>
+
+#include <algorithm>
+#include <climits>
+
 
 void DRC::ShowDRCDialog( wxWindow* aParent )
 {
@@ -91,11 +100,57 @@ void DRC::ShowDRCDialog( wxWindow* aParent )
 
 void DRC::addMarkerToPcb( MARKER_PCB* aMarker )
 {
+    if( !m_pcbEditorFrame )
+    {
+        m_pcb->Add( aMarker );
+        return;
+    }
+
     BOARD_COMMIT commit ( m_pcbEditorFrame );
     commit.Add( aMarker );
     commit.Push( wxEmptyString, false );
 }
 
+
+void DRC::addMarkersToPcb( const std::vector<MARKER_PCB*>& aMarkers )
+{
+    if( !m_pcbEditorFrame )
+    {
+        for( MARKER_PCB* marker : aMarkers )
+        {
+            if( marker )
+                m_pcb->Add( marker );
+        }
+
+        return;
+    }
+
+    BOARD_COMMIT commit ( m_pcbEditorFrame );
+    bool         empty = true;
+
+    for( MARKER_PCB* marker : aMarkers )
+    {
+        if( marker )
+        {
+            commit.Add( marker );
+            empty = false;
+        }
+    }
+
+    if( !empty )
+        commit.Push( wxEmptyString, false );
+}
+
+
+std::unique_ptr<DRC> DRC::cloneForWorker() const
+{
+    std::unique_ptr<DRC> worker( new DRC( m_pcb ) );
+
+    worker->m_pcbEditorFrame = m_pcbEditorFrame;
+
+    return worker;
+}
+
 void DRC::DestroyDRCDialog( int aReason )
 {
     if( m_drcDialog )
@@ -118,6 +173,22 @@ DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
     m_pcb = aPcbWindow->GetBoard();
     m_drcDialog  = NULL;
 
+    init();
+}
+
+
+DRC::DRC( BOARD* aBoard )
+{
+    m_pcbEditorFrame = NULL;
+    m_pcb = aBoard;
+    m_drcDialog  = NULL;
+
+    init();
+}
+
+
+void DRC::init()
+{
     // establish initial values for everything:
     m_doPad2PadTest     = true;     // enable pad to pad clearance tests
     m_doUnconnectedTest = true;     // enable unconnected tests
@@ -199,6 +270,13 @@ void DRC::RunTests( wxTextCtrl* aMessages )
 
     // someone should have cleared the two lists before calling this.
 
+    // The markers were deleted with the lists: the live DRC must not look at them anymore
+    if( m_liveContext )
+        m_liveContext->ForgetMarkers();
+
+    // The markers added by the tests must not trigger the live DRC
+    m_drcInProgress = true;
+
     if( !testNetClasses() )
     {
         // testing the netclasses is a special case because if the netclasses
@@ -211,9 +289,21 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         // update the m_drcDialog listboxes
         updatePointers();
 
+        m_drcInProgress = false;
         return;
     }
 
+    // The clearance tests pick their candidate pairs from a spatial index
+    // of all the tracks, vias and pads
+    DRC_ITEM_INDEX itemIndex;
+    DRC_TEST_ORDER testOrder;
+
+    itemIndex.Build( m_pcb );
+    testOrder.Build( m_pcb );
+
+    std::vector<MARKER_PCB*> padMarkers;
+    std::vector<MARKER_PCB*> trackMarkers;
+
     // test pad to pad clearances, nothing to do with tracks, vias or zones.
     if( m_doPad2PadTest )
     {
@@ -223,7 +313,8 @@ void DRC::RunTests( wxTextCtrl* aMessages )
             wxSafeYield();
         }
 
-        testPad2Pad();
+        testPad2Pad( itemIndex, testOrder, padMarkers );
+        addMarkersToPcb( padMarkers );
     }
 
     // test track and via clearances to other tracks, pads, and vias
@@ -233,7 +324,17 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         wxSafeYield();
     }
 
-    testTracks( aMessages ? aMessages->GetParent() : m_pcbEditorFrame, true );
+    testTracks( itemIndex, testOrder, aMessages ? aMessages->GetParent() : m_pcbEditorFrame,
+                true, trackMarkers );
+    addMarkersToPcb( trackMarkers );
+
+    // The live DRC takes over the clearance markers just created, so that it updates them
+    // (instead of adding duplicates) on the next edits
+    if( m_pcbEditorFrame->Settings().m_liveDrc )
+    {
+        createLiveContext();
+        m_liveContext->Adopt( testOrder, trackMarkers, padMarkers );
+    }
 
     // Before testing segments and unconnected, refill all zones:
     // this is a good caution, because filled areas can be outdated.
@@ -303,6 +404,8 @@ void DRC::RunTests( wxTextCtrl* aMessages )
     // update the m_drcDialog listboxes
     updatePointers();
 
+    m_drcInProgress = false;
+
     if( aMessages )
     {
         // no newline on this one because it is last, don't want the window
@@ -321,6 +424,102 @@ void DRC::ListUnconnectedPads()
 }
 
 
+/**
+ * Makes sure the frame and the tools do not keep references to the markers removed by
+ * the live DRC: they are deleted on the next update.
+ */
+static void releaseMarkers( PCB_EDIT_FRAME* aFrame, const std::vector<MARKER_PCB*>& aMarkers )
+{
+    for( MARKER_PCB* marker : aMarkers )
+    {
+        if( aFrame->GetCurItem() == marker )
+            aFrame->SetCurItem( NULL );
+
+        if( marker->IsSelected() )
+            aFrame->GetToolManager()->RunAction( PCB_ACTIONS::selectionClear, true );
+    }
+}
+
+
+void DRC::applyLiveMarkers( const DRC_LIVE_RESULT& aResult )
+{
+    if( aResult.m_addedMarkers.empty() && aResult.m_removedMarkers.empty() )
+        return;
+
+    releaseMarkers( m_pcbEditorFrame, aResult.m_removedMarkers );
+
+    // Like the markers of a full run, the live markers are not saved in the undo list:
+    // undo and redo report their changes to the live DRC, which updates the markers
+    BOARD_COMMIT commit( m_pcbEditorFrame );
+
+    for( MARKER_PCB* marker : aResult.m_removedMarkers )
+        commit.Remove( marker );
+
+    for( MARKER_PCB* marker : aResult.m_addedMarkers )
+        commit.Add( marker );
+
+    commit.Push( wxEmptyString, false );
+
+    updatePointers();
+}
+
+
+void DRC::UpdateLiveDrc( const std::vector<BOARD_ITEM*>& aAdded,
+                         const std::vector<BOARD_ITEM*>& aModified,
+                         const std::vector<BOARD_ITEM*>& aRemoved )
+{
+    if( !m_pcbEditorFrame->Settings().m_liveDrc )
+    {
+        m_liveContext.reset();
+        return;
+    }
+
+    if( m_drcInProgress )
+        return;
+
+    m_pcb = m_pcbEditorFrame->GetBoard();
+
+    if( !m_liveContext || m_liveContext->GetBoard() != m_pcb )
+    {
+        RebuildLiveDrc();
+        return;
+    }
+
+    applyLiveMarkers( m_liveContext->Update( aAdded, aModified, aRemoved ) );
+}
+
+
+void DRC::RebuildLiveDrc()
+{
+    if( !m_pcbEditorFrame->Settings().m_liveDrc )
+    {
+        m_liveContext.reset();
+        return;
+    }
+
+    m_pcb = m_pcbEditorFrame->GetBoard();
+
+    createLiveContext();
+
+    applyLiveMarkers( m_liveContext->Rebuild() );
+}
+
+
+void DRC::ResetLiveDrc()
+{
+    m_liveContext.reset();
+}
+
+
+void DRC::createLiveContext()
+{
+    if( m_liveContext && m_liveContext->GetBoard() == m_pcb )
+        return;
+
+    m_liveContext.reset( new DRC_LIVE_CONTEXT( m_pcb ) );
+}
+
+
 void DRC::updatePointers()
 {
     // update my pointers, m_pcbEditorFrame is the only unchangeable one
@@ -451,55 +650,137 @@ bool DRC::testNetClasses()
 }
 
 
-void DRC::testPad2Pad()
+/**
+ * Runs aTest( worker, index ) for every index in [0, aCount) on the thread pool.
+ * aTest gets a DRC instance of its own, taken from aWorkers.
+ */
+static void runDrcInParallel( SYNC_QUEUE<DRC*>& aWorkers, size_t aFirst, size_t aCount,
+                              const std::function<void( DRC*, size_t )>& aTest )
 {
-    std::vector<D_PAD*> sortedPads;
+    // Items are handed out in small chunks, to amortize fetching a worker
+    const size_t grain = 16;
 
-    m_pcb->GetSortedPadListByXthenYCoord( sortedPads );
+    THREAD_POOL::GetInstance().ParallelFor( ( aCount + grain - 1 ) / grain,
+            [&]( size_t aChunk )
+            {
+                DRC* worker = nullptr;
 
-    // find the max size of the pads (used to stop the test)
-    int max_size = 0;
+                // There is one worker per thread which can run a chunk
+                while( !aWorkers.pop( worker ) )
+                    std::this_thread::yield();
 
-    for( unsigned i = 0; i < sortedPads.size(); ++i )
-    {
-        D_PAD* pad = sortedPads[i];
+                size_t last = std::min( aFirst + aCount, aFirst + ( aChunk + 1 ) * grain );
+
+                for( size_t ii = aFirst + aChunk * grain; ii < last; ++ii )
+                    aTest( worker, ii );
+
+                aWorkers.push( worker );
+            } );
+}
 
-        // GetBoundingRadius() is the radius of the minimum sized circle fully containing the pad
-        int radius = pad->GetBoundingRadius();
-        if( radius > max_size )
-            max_size = radius;
+
+bool DRC::doPadClearanceDrc( D_PAD* aRefPad, const DRC_ITEM_INDEX& aIndex,
+                             const DRC_TEST_ORDER& aOrder )
+{
+    // Each pair of pads is tested once, from the pad coming first in the sorted list,
+    // and pads are tested against their neighbours in list order
+    std::vector<BOARD_CONNECTED_ITEM*> found;
+    std::vector<D_PAD*> candidates;
+
+    aIndex.Query( DRC_ITEM_INDEX::ItemBoundingBox( aRefPad ), LSET::AllCuMask(), found );
+
+    for( BOARD_CONNECTED_ITEM* item : found )
+    {
+        if( item->Type() == PCB_PAD_T && aOrder.Precedes( aRefPad, item ) )
+            candidates.push_back( static_cast<D_PAD*>( item ) );
     }
 
-    // Test the pads
-    D_PAD** listEnd = &sortedPads[ sortedPads.size() ];
+    if( candidates.empty() )
+        return true;
+
+    std::sort( candidates.begin(), candidates.end(),
+               [&aOrder]( const D_PAD* a, const D_PAD* b )
+               {
+                   return aOrder.Precedes( a, b );
+               } );
+
+    return doPadToPadsDrc( aRefPad, &candidates[0], &candidates[0] + candidates.size(),
+                           INT_MAX );
+}
+
+
+bool DRC::doTrackClearanceDrc( TRACK* aRefSeg, const DRC_ITEM_INDEX& aIndex,
+                               const DRC_TEST_ORDER& aOrder )
+{
+    // As in the sequential test, a track is tested against the pads, and against the
+    // tracks following it in the track list (the pairs before it have already been
+    // tested), in list order.
+    std::vector<BOARD_CONNECTED_ITEM*> found;
+    std::vector<D_PAD*> candidatePads;
+    std::vector<TRACK*> candidateTracks;
+
+    aIndex.Query( DRC_ITEM_INDEX::ItemBoundingBox( aRefSeg ),
+                  DRC_ITEM_INDEX::ItemLayers( aRefSeg ), found );
 
-    for( unsigned i = 0; i< sortedPads.size(); ++i )
+    for( BOARD_CONNECTED_ITEM* item : found )
     {
-        D_PAD* pad = sortedPads[i];
+        if( item->Type() == PCB_PAD_T )
+            candidatePads.push_back( static_cast<D_PAD*>( item ) );
+        else if( aOrder.Precedes( aRefSeg, item ) )
+            candidateTracks.push_back( static_cast<TRACK*>( item ) );
+    }
 
-        int    x_limit = max_size + pad->GetClearance() +
-                         pad->GetBoundingRadius() + pad->GetPosition().x;
+    auto inOrder = [&aOrder]( const BOARD_ITEM* a, const BOARD_ITEM* b )
+    {
+        return aOrder.Precedes( a, b );
+    };
 
-        if( !doPadToPadsDrc( pad, &sortedPads[i], listEnd, x_limit ) )
-        {
-            wxASSERT( m_currentMarker );
-            addMarkerToPcb ( m_currentMarker );
-            m_currentMarker = nullptr;
-        }
+    std::sort( candidatePads.begin(), candidatePads.end(), inOrder );
+    std::sort( candidateTracks.begin(), candidateTracks.end(), inOrder );
+
+    return doTrackDrc( aRefSeg, candidatePads, candidateTracks );
+}
+
+
+void DRC::testPad2Pad( const DRC_ITEM_INDEX& aIndex, const DRC_TEST_ORDER& aOrder,
+                       std::vector<MARKER_PCB*>& aMarkers )
+{
+    // Each pad has its own result slot, so the markers are the same from run to run
+    // whatever the number of threads.
+    aMarkers.assign( aOrder.m_sortedPads.size(), nullptr );
+
+    std::vector<std::unique_ptr<DRC>> workers;
+    SYNC_QUEUE<DRC*> freeWorkers;
+
+    for( unsigned ii = 0; ii <= THREAD_POOL::GetInstance().GetThreadCount(); ++ii )
+    {
+        workers.push_back( cloneForWorker() );
+        freeWorkers.push( workers.back().get() );
     }
+
+    runDrcInParallel( freeWorkers, 0, aOrder.m_sortedPads.size(),
+            [&]( DRC* aWorker, size_t aRank )
+            {
+                if( !aWorker->doPadClearanceDrc( aOrder.m_sortedPads[aRank], aIndex, aOrder ) )
+                {
+                    wxASSERT( aWorker->m_currentMarker );
+                    aMarkers[aRank] = aWorker->m_currentMarker;
+                    aWorker->m_currentMarker = nullptr;
+                }
+            } );
 }
 
 
-void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
+void DRC::testTracks( const DRC_ITEM_INDEX& aIndex, const DRC_TEST_ORDER& aOrder,
+                      wxWindow *aActiveWindow, bool aShowProgressBar,
+                      std::vector<MARKER_PCB*>& aMarkers )
 {
     wxProgressDialog * progressDialog = NULL;
     const int delta = 500;  // This is the number of tests between 2 calls to the
                             // progress bar
-    int count = 0;
-    for( TRACK* segm = m_pcb->m_Track; segm && segm->Next(); segm = segm->Next() )
-        count++;
+    const std::vector<TRACK*>& tracks = aOrder.m_tracks;
 
-    int deltamax = count/delta;
+    int deltamax = tracks.size() / delta;
 
     if( aShowProgressBar && deltamax > 3 )
     {
@@ -510,33 +791,49 @@ void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
         progressDialog->Update( 0, wxEmptyString );
     }
 
-    int ii = 0;
-    count = 0;
+    aMarkers.assign( tracks.size(), nullptr );
+
+    std::vector<std::unique_ptr<DRC>> workers;
+    SYNC_QUEUE<DRC*> freeWorkers;
+
+    for( unsigned ii = 0; ii <= THREAD_POOL::GetInstance().GetThreadCount(); ++ii )
+    {
+        workers.push_back( cloneForWorker() );
+        freeWorkers.push( workers.back().get() );
+    }
+
+    auto testTrack = [&]( DRC* aWorker, size_t aRank )
+    {
+        if( !aWorker->doTrackClearanceDrc( tracks[aRank], aIndex, aOrder ) )
+        {
+            wxASSERT( aWorker->m_currentMarker );
+            aMarkers[aRank] = aWorker->m_currentMarker;
+            aWorker->m_currentMarker = nullptr;
+        }
+    };
+
+    // Tracks are tested by blocks, so the progress bar can be updated (and the test
+    // aborted) from this thread between two blocks
+    size_t blockSize = delta * ( THREAD_POOL::GetInstance().GetThreadCount() + 1 );
+    int count = 0;
 
-    for( TRACK* segm = m_pcb->m_Track; segm; segm = segm->Next() )
+    for( size_t first = 0; first < tracks.size(); first += blockSize )
     {
-        if ( ii++ > delta )
+        size_t blockCount = std::min( blockSize, tracks.size() - first );
+
+        runDrcInParallel( freeWorkers, first, blockCount, testTrack );
+
+        if( progressDialog )
         {
-            ii = 0;
-            count++;
+            count = std::min<int>( ( first + blockCount ) / delta, deltamax );
 
-            if( progressDialog )
-            {
-                if( !progressDialog->Update( count, wxEmptyString ) )
-                    break;  // Aborted by user
+            if( !progressDialog->Update( count, wxEmptyString ) )
+                break;  // Aborted by user
 #ifdef __WXMAC__
-                // Work around a dialog z-order issue on OS X
-                if( count == deltamax )
-                    aActiveWindow->Raise();
+            // Work around a dialog z-order issue on OS X
+            if( count == deltamax )
+                aActiveWindow->Raise();
 #endif
-            }
-        }
-
-        if( !doTrackDrc( segm, segm->Next(), true ) )
-        {
-            wxASSERT( m_currentMarker );
-            addMarkerToPcb ( m_currentMarker );
-            m_currentMarker = nullptr;
         }
     }
 
@@ -621,9 +918,9 @@ void DRC::testKeepoutAreas()
         ZONE_CONTAINER* area = m_pcb->GetArea( ii );
 
         if( !area->GetIsKeepout() )
-        {
+        {
             continue;
-        }
+        }
 
         for( TRACK* segm = m_pcb->m_Track; segm != NULL; segm = segm->Next() )
         {
@@ -632,8 +929,8 @@ void DRC::testKeepoutAreas()
                 if( ! area->GetDoNotAllowTracks()  )
                     continue;
 
-                // Ignore if the keepout zone is not on the same layer
-                if( !area->IsOnLayer( segm->GetLayer() ) )
+                // Ignore if the keepout zone is not on the same layer
+                if( !area->IsOnLayer( segm->GetLayer() ) )
                     continue;
 
                 if( area->Outline()->Distance( SEG( segm->GetStart(), segm->GetEnd() ),
@@ -649,9 +946,9 @@ void DRC::testKeepoutAreas()
                 if( ! area->GetDoNotAllowVias()  )
                     continue;
 
-                auto viaLayers = segm->GetLayerSet();
-
-                if( !area->CommonLayerExists( viaLayers ) )
+                auto viaLayers = segm->GetLayerSet();
+
+                if( !area->CommonLayerExists( viaLayers ) )
                     continue;
 
                 if( area->Outline()->Distance( segm->GetPosition() ) < segm->GetWidth()/2 )
@@ -806,7 +1103,7 @@ bool DRC::doTrackKeepoutDrc( TRACK* aRefSeg )
             if( ! area->GetDoNotAllowTracks()  )
                 continue;
 
-            if( !area->IsOnLayer( aRefSeg->GetLayer() ) )
+            if( !area->IsOnLayer( aRefSeg->GetLayer() ) )
                 continue;
 
             if( area->Outline()->Distance( SEG( aRefSeg->GetStart(), aRefSeg->GetEnd() ),
@@ -822,9 +1119,9 @@ bool DRC::doTrackKeepoutDrc( TRACK* aRefSeg )
             if( ! area->GetDoNotAllowVias()  )
                 continue;
 
-            auto viaLayers = aRefSeg->GetLayerSet();
-
-            if( !area->CommonLayerExists( viaLayers ) )
+            auto viaLayers = aRefSeg->GetLayerSet();
+
+            if( !area->CommonLayerExists( viaLayers ) )
                 continue;
 
             if( area->Outline()->Distance( aRefSeg->GetPosition() ) < aRefSeg->GetWidth()/2 )
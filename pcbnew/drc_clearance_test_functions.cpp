@@ -136,7 +136,22 @@ bool convex2pointDRC( wxPoint* aTref, int aTrefCount, wxPoint aPcompare, int aDi
 
 bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
 {
-    TRACK*    track;
+    std::vector<D_PAD*> pads;
+    std::vector<TRACK*> tracks;
+
+    if( testPads )
+        pads = m_pcb->GetPads();
+
+    for( TRACK* track = aStart; track; track = track->Next() )
+        tracks.push_back( track );
+
+    return doTrackDrc( aRefSeg, pads, tracks );
+}
+
+
+bool DRC::doTrackDrc( TRACK* aRefSeg, const std::vector<D_PAD*>& aPads,
+                      const std::vector<TRACK*>& aTracks )
+{
     wxPoint   delta;           // length on X and Y axis of segments
     LSET layerMask;
     int       net_code_ref;
@@ -270,64 +285,55 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
     dummypad.SetLayerSet( LSET::AllCuMask() );     // Ensure the hole is on all layers
 
     // Compute the min distance to pads
-    if( testPads )
+    for( D_PAD* pad : aPads )
     {
-        unsigned pad_count = m_pcb->GetPadCount();
-
-        auto pads = m_pcb->GetPads();
-
-        for( unsigned ii = 0;  ii<pad_count;  ++ii )
+        /* No problem if pads are on an other layer,
+         * But if a drill hole exists	(a pad on a single layer can have a hole!)
+         * we must test the hole
+         */
+        if( !( pad->GetLayerSet() & layerMask ).any() )
         {
-            D_PAD* pad = pads[ii];
-
-            /* No problem if pads are on an other layer,
-             * But if a drill hole exists	(a pad on a single layer can have a hole!)
-             * we must test the hole
+            /* We must test the pad hole. In order to use the function
+             * checkClearanceSegmToPad(),a pseudo pad is used, with a shape and a
+             * size like the hole
              */
-            if( !( pad->GetLayerSet() & layerMask ).any() )
-            {
-                /* We must test the pad hole. In order to use the function
-                 * checkClearanceSegmToPad(),a pseudo pad is used, with a shape and a
-                 * size like the hole
-                 */
-                if( pad->GetDrillSize().x == 0 )
-                    continue;
-
-                dummypad.SetSize( pad->GetDrillSize() );
-                dummypad.SetPosition( pad->GetPosition() );
-                dummypad.SetShape( pad->GetDrillShape()  == PAD_DRILL_SHAPE_OBLONG ?
-                                   PAD_SHAPE_OVAL : PAD_SHAPE_CIRCLE );
-                dummypad.SetOrientation( pad->GetOrientation() );
-
-                m_padToTestPos = dummypad.GetPosition() - origin;
-
-                if( !checkClearanceSegmToPad( &dummypad, aRefSeg->GetWidth(),
-                                              netclass->GetClearance() ) )
-                {
-                    m_currentMarker = fillMarker( aRefSeg, pad,
-                                                  DRCE_TRACK_NEAR_THROUGH_HOLE, m_currentMarker );
-                    return false;
-                }
-
+            if( pad->GetDrillSize().x == 0 )
                 continue;
-            }
 
-            // The pad must be in a net (i.e pt_pad->GetNet() != 0 )
-            // but no problem if the pad netcode is the current netcode (same net)
-            if( pad->GetNetCode()                       // the pad must be connected
-               && net_code_ref == pad->GetNetCode() )   // the pad net is the same as current net -> Ok
-                continue;
+            dummypad.SetSize( pad->GetDrillSize() );
+            dummypad.SetPosition( pad->GetPosition() );
+            dummypad.SetShape( pad->GetDrillShape()  == PAD_DRILL_SHAPE_OBLONG ?
+                               PAD_SHAPE_OVAL : PAD_SHAPE_CIRCLE );
+            dummypad.SetOrientation( pad->GetOrientation() );
 
-            // DRC for the pad
-            shape_pos = pad->ShapePos();
-            m_padToTestPos = shape_pos - origin;
+            m_padToTestPos = dummypad.GetPosition() - origin;
 
-            if( !checkClearanceSegmToPad( pad, aRefSeg->GetWidth(), aRefSeg->GetClearance( pad ) ) )
+            if( !checkClearanceSegmToPad( &dummypad, aRefSeg->GetWidth(),
+                                          netclass->GetClearance() ) )
             {
                 m_currentMarker = fillMarker( aRefSeg, pad,
-                                              DRCE_TRACK_NEAR_PAD, m_currentMarker );
+                                              DRCE_TRACK_NEAR_THROUGH_HOLE, m_currentMarker );
                 return false;
             }
+
+            continue;
+        }
+
+        // The pad must be in a net (i.e pt_pad->GetNet() != 0 )
+        // but no problem if the pad netcode is the current netcode (same net)
+        if( pad->GetNetCode()                       // the pad must be connected
+           && net_code_ref == pad->GetNetCode() )   // the pad net is the same as current net -> Ok
+            continue;
+
+        // DRC for the pad
+        shape_pos = pad->ShapePos();
+        m_padToTestPos = shape_pos - origin;
+
+        if( !checkClearanceSegmToPad( pad, aRefSeg->GetWidth(), aRefSeg->GetClearance( pad ) ) )
+        {
+            m_currentMarker = fillMarker( aRefSeg, pad,
+                                          DRCE_TRACK_NEAR_PAD, m_currentMarker );
+            return false;
         }
     }
 
@@ -340,7 +346,7 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
     // Test the reference segment with other track segments
     wxPoint segStartPoint;
     wxPoint segEndPoint;
-    for( track = aStart; track; track = track->Next() )
+    for( TRACK* track : aTracks )
     {
         // No problem if segments have the same net code:
         if( net_code_ref == track->GetNetCode() )
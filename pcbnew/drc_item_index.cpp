@@ -0,0 +1,336 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+
+#include <class_board.h>
+#include <class_board_design_settings.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+
+#include <drc_item_index.h>
+
+
+DRC_ITEM_INDEX::DRC_ITEM_INDEX() :
+    m_maxClearance( 0 )
+{
+    for( int layer = 0; layer < PCB_LAYER_ID_COUNT; ++layer )
+        m_trees[layer] = IsCopperLayer( layer ) ? new ITEM_TREE : nullptr;
+}
+
+
+DRC_ITEM_INDEX::~DRC_ITEM_INDEX()
+{
+    for( int layer = 0; layer < PCB_LAYER_ID_COUNT; ++layer )
+        delete m_trees[layer];
+}
+
+
+void DRC_ITEM_INDEX::Clear()
+{
+    for( int layer = 0; layer < PCB_LAYER_ID_COUNT; ++layer )
+    {
+        if( m_trees[layer] )
+            m_trees[layer]->RemoveAll();
+    }
+
+    m_entries.clear();
+    m_maxClearance = 0;
+}
+
+
+void DRC_ITEM_INDEX::Build( BOARD* aBoard )
+{
+    Clear();
+
+    m_maxClearance = aBoard->GetDesignSettings().GetBiggestClearanceValue();
+
+    for( MODULE* module = aBoard->m_Modules; module; module = module->Next() )
+    {
+        for( D_PAD* pad = module->PadsList(); pad; pad = pad->Next() )
+            Add( pad );
+    }
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+        Add( track );
+}
+
+
+EDA_RECT DRC_ITEM_INDEX::ItemBoundingBox( const BOARD_CONNECTED_ITEM* aItem )
+{
+    EDA_RECT bbox;
+
+    switch( aItem->Type() )
+    {
+    case PCB_PAD_T:
+    {
+        const D_PAD* pad = static_cast<const D_PAD*>( aItem );
+
+        // The circle containing the pad shape, centered on the shape and on the anchor,
+        // plus the hole: this covers offset, rotated and custom shapes alike.
+        // GetBoundingRadius() also caches the radius, which must be done before the
+        // index is shared between threads.
+        int radius = pad->GetBoundingRadius();
+
+        bbox.SetOrigin( pad->ShapePos() );
+        bbox.Inflate( radius );
+
+        EDA_RECT other( pad->GetPosition(), wxSize( 0, 0 ) );
+        other.Inflate( radius );
+        bbox.Merge( other );
+
+        wxSize drill = pad->GetDrillSize();
+
+        if( drill.x || drill.y )
+        {
+            EDA_RECT hole( pad->GetPosition(), wxSize( 0, 0 ) );
+            hole.Inflate( std::max( drill.x, drill.y ) / 2 + 1 );
+            bbox.Merge( hole );
+        }
+
+        break;
+    }
+
+    case PCB_VIA_T:
+    {
+        const VIA* via = static_cast<const VIA*>( aItem );
+
+        bbox.SetOrigin( via->GetStart() );
+        bbox.Inflate( std::max( via->GetWidth(), via->GetDrillValue() ) / 2 + 1 );
+        break;
+    }
+
+    default:
+    {
+        const TRACK* track = static_cast<const TRACK*>( aItem );
+
+        bbox.SetOrigin( track->GetStart() );
+        bbox.SetEnd( track->GetEnd() );
+        bbox.Normalize();
+        bbox.Inflate( track->GetWidth() / 2 + 1 );
+        break;
+    }
+    }
+
+    return bbox;
+}
+
+
+LSET DRC_ITEM_INDEX::ItemLayers( const BOARD_CONNECTED_ITEM* aItem )
+{
+    LSET layers = aItem->GetLayerSet() & LSET::AllCuMask();
+
+    // A hole goes through every copper layer
+    if( aItem->Type() == PCB_PAD_T && static_cast<const D_PAD*>( aItem )->GetDrillSize().x )
+        layers = LSET::AllCuMask();
+
+    return layers;
+}
+
+
+void DRC_ITEM_INDEX::Add( BOARD_CONNECTED_ITEM* aItem )
+{
+    switch( aItem->Type() )
+    {
+    case PCB_PAD_T:
+    case PCB_VIA_T:
+    case PCB_TRACE_T:
+        break;
+
+    default:
+        return;
+    }
+
+    if( m_entries.count( aItem ) )
+        Remove( aItem );
+
+    ENTRY entry;
+    entry.m_bbox = ItemBoundingBox( aItem );
+    entry.m_layers = ItemLayers( aItem );
+
+    const int mmin[2] = { entry.m_bbox.GetX(), entry.m_bbox.GetY() };
+    const int mmax[2] = { entry.m_bbox.GetRight(), entry.m_bbox.GetBottom() };
+
+    for( LSEQ seq = entry.m_layers.Seq(); seq; ++seq )
+        m_trees[*seq]->Insert( mmin, mmax, aItem );
+
+    m_maxClearance = std::max( m_maxClearance, aItem->GetClearance() );
+    m_entries[aItem] = entry;
+}
+
+
+void DRC_ITEM_INDEX::Remove( const BOARD_CONNECTED_ITEM* aItem )
+{
+    auto it = m_entries.find( aItem );
+
+    if( it == m_entries.end() )
+        return;
+
+    const ENTRY& entry = it->second;
+    const int mmin[2] = { entry.m_bbox.GetX(), entry.m_bbox.GetY() };
+    const int mmax[2] = { entry.m_bbox.GetRight(), entry.m_bbox.GetBottom() };
+
+    // The trees only compare the pointers: aItem may already be deleted
+    BOARD_CONNECTED_ITEM* data = const_cast<BOARD_CONNECTED_ITEM*>( aItem );
+
+    for( LSEQ seq = entry.m_layers.Seq(); seq; ++seq )
+        m_trees[*seq]->Remove( mmin, mmax, data );
+
+    // m_maxClearance is not lowered: it only has to be an upper bound
+    m_entries.erase( it );
+}
+
+
+bool DRC_ITEM_INDEX::GetItemArea( const BOARD_CONNECTED_ITEM* aItem, EDA_RECT& aBBox,
+                                  LSET& aLayers ) const
+{
+    auto it = m_entries.find( aItem );
+
+    if( it == m_entries.end() )
+        return false;
+
+    aBBox = it->second.m_bbox;
+    aLayers = it->second.m_layers;
+    return true;
+}
+
+
+void DRC_ITEM_INDEX::GetItems( std::vector<const BOARD_CONNECTED_ITEM*>& aItems ) const
+{
+    aItems.reserve( aItems.size() + m_entries.size() );
+
+    for( const auto& entry : m_entries )
+        aItems.push_back( entry.first );
+}
+
+
+void DRC_ITEM_INDEX::Query( const EDA_RECT& aArea, LSET aLayers,
+                            std::vector<BOARD_CONNECTED_ITEM*>& aResult ) const
+{
+    EDA_RECT area( aArea );
+    area.Normalize();
+    area.Inflate( m_maxClearance + 1 );
+
+    const int mmin[2] = { area.GetX(), area.GetY() };
+    const int mmax[2] = { area.GetRight(), area.GetBottom() };
+
+    size_t first = aResult.size();
+
+    auto collect = [&aResult]( BOARD_CONNECTED_ITEM* aItem ) -> bool
+    {
+        aResult.push_back( aItem );
+        return true;
+    };
+
+    aLayers &= LSET::AllCuMask();
+
+    for( LSEQ seq = aLayers.Seq(); seq; ++seq )
+        m_trees[*seq]->Search( mmin, mmax, collect );
+
+    // Items on several layers (vias, through hole pads) are found once per layer
+    if( aLayers.count() > 1 )
+    {
+        std::sort( aResult.begin() + first, aResult.end() );
+        aResult.erase( std::unique( aResult.begin() + first, aResult.end() ), aResult.end() );
+    }
+}
+
+
+void DRC_TEST_ORDER::Build( BOARD* aBoard )
+{
+    m_tracks.clear();
+    m_sortedPads.clear();
+    m_padKeys.clear();
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+        m_tracks.push_back( track );
+
+    m_trackRanks.Number( aBoard->m_Track );
+
+    aBoard->GetSortedPadListByXthenYCoord( m_sortedPads );
+
+    for( size_t ii = 0; ii < m_sortedPads.size(); ++ii )
+    {
+        const wxPoint& pos = m_sortedPads[ii]->GetPosition();
+
+        m_padKeys[ m_sortedPads[ii] ] = PAD_KEY{ pos.x, pos.y, ii };
+    }
+
+    m_padSequence = m_sortedPads.size();
+}
+
+
+void DRC_TEST_ORDER::Add( const std::vector<BOARD_CONNECTED_ITEM*>& aItems )
+{
+    std::vector<TRACK*> tracks;
+
+    for( BOARD_CONNECTED_ITEM* item : aItems )
+    {
+        switch( item->Type() )
+        {
+        case PCB_PAD_T:
+        {
+            const wxPoint& pos = item->GetPosition();
+
+            m_padKeys[item] = PAD_KEY{ pos.x, pos.y, m_padSequence++ };
+            break;
+        }
+
+        case PCB_TRACE_T:
+        case PCB_VIA_T:
+            tracks.push_back( static_cast<TRACK*>( item ) );
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    // The new tracks are ranked together, runs of consecutive tracks at once
+    m_trackRanks.Insert( tracks );
+}
+
+
+void DRC_TEST_ORDER::Remove( const BOARD_CONNECTED_ITEM* aItem )
+{
+    m_padKeys.erase( aItem );
+    m_trackRanks.Remove( static_cast<const TRACK*>( aItem ) );
+}
+
+
+bool DRC_TEST_ORDER::Precedes( const BOARD_ITEM* aItemA, const BOARD_ITEM* aItemB ) const
+{
+    if( aItemA->Type() == PCB_PAD_T )
+        return m_padKeys.at( aItemA ) < m_padKeys.at( aItemB );
+
+    return m_trackRanks.Rank( static_cast<const TRACK*>( aItemA ) )
+         < m_trackRanks.Rank( static_cast<const TRACK*>( aItemB ) );
+}
+
+
+bool DRC_TEST_ORDER::Contains( const BOARD_ITEM* aItem ) const
+{
+    return m_padKeys.count( aItem ) > 0
+        || m_trackRanks.Contains( static_cast<const TRACK*>( aItem ) );
+}
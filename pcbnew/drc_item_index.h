@@ -0,0 +1,229 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef DRC_ITEM_INDEX_H
+#define DRC_ITEM_INDEX_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <class_eda_rect.h>
+#include <layers_id_colors_and_visibility.h>
+#include <geometry/rtree.h>
+#include <list_ranks.h>
+
+class BOARD;
+class BOARD_ITEM;
+class BOARD_CONNECTED_ITEM;
+class D_PAD;
+class TRACK;
+
+
+/**
+ * Class DRC_ITEM_INDEX
+ *
+ * Spatial index of the copper items (tracks, vias and pads) checked by the clearance tests.
+ * There is one R-tree per copper layer. Pads with a hole are stored on every copper layer,
+ * because the hole must be tested against items of all layers.
+ *
+ * Queries return every item whose bounding box comes within GetMaxClearance() of the query
+ * area, so the exact clearance tests only need to run on the returned candidates.
+ * The index is read only during the checks, so it can be queried from several threads.
+ */
+class DRC_ITEM_INDEX
+{
+public:
+    DRC_ITEM_INDEX();
+    ~DRC_ITEM_INDEX();
+
+    /**
+     * Function Build
+     * clears the index and fills it with all tracks, vias and pads of aBoard.
+     */
+    void Build( BOARD* aBoard );
+
+    void Clear();
+
+    /**
+     * Function Add
+     * indexes a track, via or pad. Other item types are ignored.
+     */
+    void Add( BOARD_CONNECTED_ITEM* aItem );
+
+    /**
+     * Function Remove
+     * removes an item from the index, using the area it had when it was added (so it
+     * can be called after the item has been moved).
+     */
+    void Remove( const BOARD_CONNECTED_ITEM* aItem );
+
+    bool Contains( const BOARD_CONNECTED_ITEM* aItem ) const
+    {
+        return m_entries.count( aItem ) > 0;
+    }
+
+    /**
+     * Function GetItemArea
+     * gives the area and layers aItem was indexed with, which may differ from its
+     * current ones if it has been modified since. aItem is not dereferenced.
+     * @return false if aItem is not in the index.
+     */
+    bool GetItemArea( const BOARD_CONNECTED_ITEM* aItem, EDA_RECT& aBBox, LSET& aLayers ) const;
+
+    /**
+     * Function GetItems
+     * appends all the indexed items to aItems, in no particular order.
+     */
+    void GetItems( std::vector<const BOARD_CONNECTED_ITEM*>& aItems ) const;
+
+    /**
+     * Function GetMaxClearance
+     * @return the largest clearance of the board netclasses and of the indexed items.
+     */
+    int GetMaxClearance() const
+    {
+        return m_maxClearance;
+    }
+
+    /**
+     * Function Query
+     * collects the items stored on any copper layer of aLayers whose bounding box is
+     * within GetMaxClearance() of aArea.
+     * @param aArea the area to search
+     * @param aLayers the layers to search
+     * @param aResult receives the candidates, each of them once, in no particular order
+     */
+    void Query( const EDA_RECT& aArea, LSET aLayers,
+                std::vector<BOARD_CONNECTED_ITEM*>& aResult ) const;
+
+    /**
+     * Function ItemBoundingBox
+     * @return the area covered by the copper (and the hole, for pads) of aItem.
+     */
+    static EDA_RECT ItemBoundingBox( const BOARD_CONNECTED_ITEM* aItem );
+
+    /**
+     * Function ItemLayers
+     * @return the copper layers aItem is indexed on.
+     */
+    static LSET ItemLayers( const BOARD_CONNECTED_ITEM* aItem );
+
+private:
+    typedef RTree<BOARD_CONNECTED_ITEM*, int, 2, float> ITEM_TREE;
+
+    struct ENTRY
+    {
+        EDA_RECT m_bbox;
+        LSET     m_layers;
+    };
+
+    ITEM_TREE* m_trees[PCB_LAYER_ID_COUNT];
+    std::unordered_map<const BOARD_CONNECTED_ITEM*, ENTRY> m_entries;
+    int m_maxClearance;
+};
+
+
+/**
+ * Struct DRC_TEST_ORDER
+ *
+ * The order in which the clearance tests visit the items. A track is tested against the
+ * pads, and against the tracks following it in the track list. A pad is tested against the
+ * pads following it in the pad list sorted by X then Y coordinate. Candidates are always
+ * tested in that order, and only the first violation of an item is reported, so the
+ * markers do not depend on the number of threads, nor on whether the whole board or only
+ * the items around an edit are tested.
+ *
+ * The order can be kept up to date while the board is edited, by removing the changed
+ * items and adding them again: only these items are ranked again.
+ */
+struct DRC_TEST_ORDER
+{
+    DRC_TEST_ORDER() :
+        m_padSequence( 0 )
+    {
+    }
+
+    /**
+     * Function Build
+     * ranks all the tracks, vias and pads of aBoard, and lists them in m_tracks and
+     * m_sortedPads.
+     */
+    void Build( BOARD* aBoard );
+
+    /**
+     * Function Add
+     * ranks tracks and vias, already linked in the track list, and pads at their current
+     * position. Other item types are ignored. m_tracks and m_sortedPads are not updated.
+     */
+    void Add( const std::vector<BOARD_CONNECTED_ITEM*>& aItems );
+
+    /**
+     * Function Remove
+     * forgets the rank of aItem, which is not dereferenced.
+     */
+    void Remove( const BOARD_CONNECTED_ITEM* aItem );
+
+    /**
+     * Function Precedes
+     * @return true if aItemA is tested before aItemB. Both are tracks or vias, or both
+     * are pads.
+     */
+    bool Precedes( const BOARD_ITEM* aItemA, const BOARD_ITEM* aItemB ) const;
+
+    /**
+     * Function Contains
+     * @return true if aItem is ranked. aItem is not dereferenced.
+     */
+    bool Contains( const BOARD_ITEM* aItem ) const;
+
+    ///> The tracks in list order and the sorted pads, as of the last Build()
+    std::vector<TRACK*> m_tracks;
+    std::vector<D_PAD*> m_sortedPads;
+
+private:
+    ///> Pads are ranked by their position, then by the order they were ranked in
+    struct PAD_KEY
+    {
+        int      m_x;
+        int      m_y;
+        uint64_t m_sequence;
+
+        bool operator<( const PAD_KEY& aOther ) const
+        {
+            if( m_x != aOther.m_x )
+                return m_x < aOther.m_x;
+
+            if( m_y != aOther.m_y )
+                return m_y < aOther.m_y;
+
+            return m_sequence < aOther.m_sequence;
+        }
+    };
+
+    LIST_RANKS<TRACK> m_trackRanks;
+    std::unordered_map<const BOARD_ITEM*, PAD_KEY> m_padKeys;
+    uint64_t m_padSequence;
+};
+
+#endif  // DRC_ITEM_INDEX_H
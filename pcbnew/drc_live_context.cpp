@@ -0,0 +1,430 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <unordered_set>
+
+#include <fctsys.h>
+#include <profile.h>
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+#include <class_marker_pcb.h>
+
+#include <drc_stuff.h>
+#include <drc_live_context.h>
+
+
+/**
+ * @return true if both markers report the same problem at the same place.
+ */
+static bool sameMarker( const MARKER_PCB* aMarkerA, const MARKER_PCB* aMarkerB )
+{
+    const DRC_ITEM& a = aMarkerA->GetReporter();
+    const DRC_ITEM& b = aMarkerB->GetReporter();
+
+    return aMarkerA->GetPosition() == aMarkerB->GetPosition()
+        && aMarkerA->GetItem() == aMarkerB->GetItem()
+        && a.GetErrorCode() == b.GetErrorCode()
+        && a.GetPointA() == b.GetPointA()
+        && a.GetPointB() == b.GetPointB()
+        && a.GetTextA() == b.GetTextA()
+        && a.GetTextB() == b.GetTextB();
+}
+
+
+DRC_LIVE_CONTEXT::DRC_LIVE_CONTEXT( BOARD* aBoard, bool aPublishMarkers ) :
+    m_board( aBoard ),
+    m_publish( aPublishMarkers ),
+    m_checker( new DRC( aBoard ) ),
+    m_valid( false )
+{
+}
+
+
+DRC_LIVE_CONTEXT::~DRC_LIVE_CONTEXT()
+{
+    deleteRemovedMarkers();
+
+    if( !m_publish )
+    {
+        for( auto& entry : m_markers )
+            delete entry.second;
+    }
+}
+
+
+void DRC_LIVE_CONTEXT::collectItems( BOARD_ITEM* aItem,
+                                     std::vector<BOARD_CONNECTED_ITEM*>& aItems )
+{
+    switch( aItem->Type() )
+    {
+    case PCB_MODULE_T:
+        for( D_PAD* pad = static_cast<MODULE*>( aItem )->PadsList(); pad; pad = pad->Next() )
+            aItems.push_back( pad );
+
+        break;
+
+    case PCB_PAD_T:
+    case PCB_TRACE_T:
+    case PCB_VIA_T:
+        aItems.push_back( static_cast<BOARD_CONNECTED_ITEM*>( aItem ) );
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+bool DRC_LIVE_CONTEXT::isOnBoard( const BOARD_ITEM* aItem )
+{
+    // Items removed from the board are unlinked from its lists, the pads of a module
+    // removed from the board stay in the pad list of the module
+    if( aItem->Type() == PCB_PAD_T )
+        return aItem->GetList() && aItem->GetParent() && aItem->GetParent()->GetList();
+
+    return aItem->GetList() != nullptr;
+}
+
+
+void DRC_LIVE_CONTEXT::recordModulePads()
+{
+    m_modulePads.clear();
+
+    for( MODULE* module = m_board->m_Modules; module; module = module->Next() )
+    {
+        std::vector<BOARD_CONNECTED_ITEM*>& pads = m_modulePads[module];
+
+        for( D_PAD* pad = module->PadsList(); pad; pad = pad->Next() )
+            pads.push_back( pad );
+    }
+}
+
+
+void DRC_LIVE_CONTEXT::deleteRemovedMarkers()
+{
+    for( MARKER_PCB* marker : m_lastResult.m_removedMarkers )
+        delete marker;
+
+    m_lastResult.m_removedMarkers.clear();
+}
+
+
+void DRC_LIVE_CONTEXT::setMarker( const BOARD_ITEM* aItem, MARKER_PCB* aMarker )
+{
+    auto it = m_markers.find( aItem );
+    MARKER_PCB* old = it != m_markers.end() ? it->second : nullptr;
+
+    if( !aMarker )
+    {
+        if( old )
+        {
+            m_lastResult.m_removedMarkers.push_back( old );
+            m_lastResult.m_markersRemoved++;
+            m_markers.erase( it );
+        }
+
+        return;
+    }
+
+    // Keep the current marker when nothing changed, to avoid needless redraws
+    if( old && sameMarker( old, aMarker ) )
+    {
+        delete aMarker;
+        return;
+    }
+
+    if( old )
+    {
+        m_lastResult.m_removedMarkers.push_back( old );
+        m_lastResult.m_markersUpdated++;
+    }
+    else
+    {
+        m_lastResult.m_markersAdded++;
+    }
+
+    m_lastResult.m_addedMarkers.push_back( aMarker );
+    m_markers[aItem] = aMarker;
+}
+
+
+void DRC_LIVE_CONTEXT::pruneMarkers()
+{
+    // Markers may have been deleted behind our back (by the user, or by the DRC dialog):
+    // they are recognized by their address only, without being dereferenced
+    if( m_publish )
+    {
+        std::unordered_set<const MARKER_PCB*> onBoard;
+
+        for( int ii = 0; ii < m_board->GetMARKERCount(); ++ii )
+            onBoard.insert( m_board->GetMARKER( ii ) );
+
+        for( auto it = m_markers.begin(); it != m_markers.end(); )
+        {
+            if( onBoard.count( it->second ) )
+                ++it;
+            else
+                it = m_markers.erase( it );
+        }
+    }
+
+    // The markers of the items which left the board
+    std::vector<const BOARD_ITEM*> gone;
+
+    for( const auto& entry : m_markers )
+    {
+        if( !m_order.Contains( entry.first ) )
+            gone.push_back( entry.first );
+    }
+
+    for( const BOARD_ITEM* item : gone )
+        setMarker( item, nullptr );
+}
+
+
+void DRC_LIVE_CONTEXT::testItem( BOARD_CONNECTED_ITEM* aItem )
+{
+    bool ok;
+
+    m_checker->m_currentMarker = nullptr;
+
+    if( aItem->Type() == PCB_PAD_T )
+        ok = m_checker->doPadClearanceDrc( static_cast<D_PAD*>( aItem ), m_index, m_order );
+    else
+        ok = m_checker->doTrackClearanceDrc( static_cast<TRACK*>( aItem ), m_index, m_order );
+
+    MARKER_PCB* marker = ok ? nullptr : m_checker->m_currentMarker;
+
+    wxASSERT( ok || marker );
+    m_checker->m_currentMarker = nullptr;
+
+    setMarker( aItem, marker );
+    m_lastResult.m_itemsTested++;
+}
+
+
+const DRC_LIVE_RESULT& DRC_LIVE_CONTEXT::Rebuild()
+{
+    unsigned start = GetRunningMicroSecs();
+
+    deleteRemovedMarkers();
+    m_lastResult = DRC_LIVE_RESULT();
+    m_lastResult.m_fullRebuild = true;
+
+    m_index.Build( m_board );
+    m_order.Build( m_board );
+    recordModulePads();
+    m_valid = true;
+
+    pruneMarkers();
+
+    std::vector<MARKER_PCB*> padMarkers;
+    std::vector<MARKER_PCB*> trackMarkers;
+
+    m_checker->testPad2Pad( m_index, m_order, padMarkers );
+    m_checker->testTracks( m_index, m_order, NULL, false, trackMarkers );
+
+    for( size_t ii = 0; ii < padMarkers.size(); ++ii )
+        setMarker( m_order.m_sortedPads[ii], padMarkers[ii] );
+
+    for( size_t ii = 0; ii < trackMarkers.size(); ++ii )
+        setMarker( m_order.m_tracks[ii], trackMarkers[ii] );
+
+    m_lastResult.m_itemsTested = padMarkers.size() + trackMarkers.size();
+    m_lastResult.m_duration = GetRunningMicroSecs() - start;
+
+    return m_lastResult;
+}
+
+
+const DRC_LIVE_RESULT& DRC_LIVE_CONTEXT::Update( const std::vector<BOARD_ITEM*>& aAdded,
+                                                 const std::vector<BOARD_ITEM*>& aModified,
+                                                 const std::vector<BOARD_ITEM*>& aRemoved )
+{
+    if( !m_valid )
+        return Rebuild();
+
+    unsigned start = GetRunningMicroSecs();
+
+    deleteRemovedMarkers();
+    m_lastResult = DRC_LIVE_RESULT();
+
+    std::vector<EDA_RECT> areas;
+
+    // Take out the changed items, with the area they had before the change. A module may
+    // have lost pads or, when a change is undone, got other pads: the pads it had are
+    // taken out too.
+    auto takeOut = [&]( BOARD_ITEM* aItem )
+    {
+        std::vector<BOARD_CONNECTED_ITEM*> items;
+        auto it = m_modulePads.find( aItem );
+
+        if( it != m_modulePads.end() )
+        {
+            items = it->second;
+            m_modulePads.erase( it );
+        }
+
+        collectItems( aItem, items );
+
+        for( const BOARD_CONNECTED_ITEM* item : items )
+        {
+            EDA_RECT bbox;
+            LSET layers;
+
+            if( m_index.GetItemArea( item, bbox, layers ) )
+            {
+                areas.push_back( bbox );
+                m_index.Remove( item );
+            }
+
+            m_order.Remove( item );
+        }
+    };
+
+    for( BOARD_ITEM* item : aRemoved )
+        takeOut( item );
+
+    for( BOARD_ITEM* item : aAdded )
+        takeOut( item );
+
+    for( BOARD_ITEM* item : aModified )
+        takeOut( item );
+
+    // Put back the ones still on the board
+    std::vector<BOARD_CONNECTED_ITEM*> present;
+
+    auto putBack = [&]( BOARD_ITEM* aItem )
+    {
+        if( !isOnBoard( aItem ) )
+            return;
+
+        size_t first = present.size();
+
+        collectItems( aItem, present );
+
+        if( aItem->Type() == PCB_MODULE_T )
+            m_modulePads[aItem].assign( present.begin() + first, present.end() );
+    };
+
+    for( BOARD_ITEM* item : aAdded )
+        putBack( item );
+
+    for( BOARD_ITEM* item : aModified )
+        putBack( item );
+
+    // Nothing to do for changes of markers, drawings, zones...
+    if( areas.empty() && present.empty() )
+        return m_lastResult;
+
+    m_order.Add( present );
+
+    for( BOARD_CONNECTED_ITEM* item : present )
+    {
+        if( !m_index.Contains( item ) )
+        {
+            m_index.Add( item );
+            areas.push_back( DRC_ITEM_INDEX::ItemBoundingBox( item ) );
+        }
+    }
+
+    pruneMarkers();
+
+    // Every item whose candidates include a changed item, before or after the change,
+    // has to be tested again. The index query is symmetric, so these are the items found
+    // around the changed areas.
+    std::vector<BOARD_CONNECTED_ITEM*> dirty;
+
+    for( const EDA_RECT& area : areas )
+        m_index.Query( area, LSET::AllCuMask(), dirty );
+
+    std::sort( dirty.begin(), dirty.end() );
+    dirty.erase( std::unique( dirty.begin(), dirty.end() ), dirty.end() );
+
+    // Pads first then tracks, each in test order, like the full test
+    const DRC_TEST_ORDER& order = m_order;
+
+    std::sort( dirty.begin(), dirty.end(),
+               [&order]( const BOARD_CONNECTED_ITEM* a, const BOARD_CONNECTED_ITEM* b )
+               {
+                   bool padA = a->Type() == PCB_PAD_T;
+                   bool padB = b->Type() == PCB_PAD_T;
+
+                   if( padA != padB )
+                       return padA;
+
+                   return order.Precedes( a, b );
+               } );
+
+    for( BOARD_CONNECTED_ITEM* item : dirty )
+        testItem( item );
+
+    m_lastResult.m_duration = GetRunningMicroSecs() - start;
+
+    return m_lastResult;
+}
+
+
+void DRC_LIVE_CONTEXT::Adopt( const DRC_TEST_ORDER& aOrder,
+                              const std::vector<MARKER_PCB*>& aTrackMarkers,
+                              const std::vector<MARKER_PCB*>& aPadMarkers )
+{
+    unsigned start = GetRunningMicroSecs();
+
+    deleteRemovedMarkers();
+    m_lastResult = DRC_LIVE_RESULT();
+    m_lastResult.m_fullRebuild = true;
+
+    m_index.Build( m_board );
+    m_order = aOrder;
+    recordModulePads();
+    m_valid = true;
+
+    pruneMarkers();
+
+    // The new markers replace the ones we had
+    std::vector<const BOARD_ITEM*> items;
+
+    for( const auto& entry : m_markers )
+        items.push_back( entry.first );
+
+    for( const BOARD_ITEM* item : items )
+        setMarker( item, nullptr );
+
+    for( size_t ii = 0; ii < aPadMarkers.size(); ++ii )
+    {
+        if( aPadMarkers[ii] )
+            m_markers[ m_order.m_sortedPads[ii] ] = aPadMarkers[ii];
+    }
+
+    for( size_t ii = 0; ii < aTrackMarkers.size(); ++ii )
+    {
+        if( aTrackMarkers[ii] )
+            m_markers[ m_order.m_tracks[ii] ] = aTrackMarkers[ii];
+    }
+
+    m_lastResult.m_duration = GetRunningMicroSecs() - start;
+}
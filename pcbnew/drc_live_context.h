@@ -0,0 +1,198 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef DRC_LIVE_CONTEXT_H
+#define DRC_LIVE_CONTEXT_H
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <drc_item_index.h>
+
+class BOARD;
+class BOARD_ITEM;
+class BOARD_CONNECTED_ITEM;
+class MARKER_PCB;
+class DRC;
+
+/**
+ * Struct DRC_LIVE_RESULT
+ * tells what an update of a DRC_LIVE_CONTEXT did.
+ */
+struct DRC_LIVE_RESULT
+{
+    DRC_LIVE_RESULT() :
+        m_fullRebuild( false ),
+        m_itemsTested( 0 ),
+        m_markersAdded( 0 ),
+        m_markersUpdated( 0 ),
+        m_markersRemoved( 0 ),
+        m_duration( 0 )
+    {
+    }
+
+    bool     m_fullRebuild;         ///< true if the whole board was tested
+    int      m_itemsTested;         ///< tracks, vias and pads tested
+    int      m_markersAdded;        ///< markers of items which had none
+    int      m_markersUpdated;      ///< markers replaced because the violation changed
+    int      m_markersRemoved;      ///< markers of items which are now correct (or gone)
+    unsigned m_duration;            ///< in microseconds
+
+    /// The new markers, to be added to the board
+    std::vector<MARKER_PCB*> m_addedMarkers;
+
+    /// The markers to be removed from the board, still allocated until the next update
+    std::vector<MARKER_PCB*> m_removedMarkers;
+};
+
+
+/**
+ * Class DRC_LIVE_CONTEXT
+ *
+ * Keeps the clearance markers of the tracks, vias and pads of a board up to date while it
+ * is edited. The context owns a DRC_ITEM_INDEX of the board. When items change, only the
+ * changed items and the items close enough to their old or new position to interact with
+ * them are tested again.
+ *
+ * The tests are the ones of the full DRC (DRC::doTrackClearanceDrc() and
+ * DRC::doPadClearanceDrc()), run in the same DRC_TEST_ORDER, so after any sequence of
+ * updates the markers are the ones a full test of the board would give.
+ *
+ * There is at most one marker per reference item. When aPublishMarkers is true the markers
+ * belong on the board: the context does not touch the board, each update lists the markers
+ * to add and to remove, and the caller applies them (DRC does it with a BOARD_COMMIT, like
+ * the markers of a full run). Otherwise they are only kept in the context, which is what
+ * benchmarks and scripts comparing results want.
+ */
+class DRC_LIVE_CONTEXT
+{
+public:
+    typedef std::unordered_map<const BOARD_ITEM*, MARKER_PCB*> MARKER_MAP;
+
+    DRC_LIVE_CONTEXT( BOARD* aBoard, bool aPublishMarkers = true );
+
+    /**
+     * Published markers are left on the board, the others are deleted.
+     */
+    ~DRC_LIVE_CONTEXT();
+
+    BOARD* GetBoard() const
+    {
+        return m_board;
+    }
+
+    /**
+     * Function Rebuild
+     * re-indexes and re-tests the whole board.
+     */
+    const DRC_LIVE_RESULT& Rebuild();
+
+    /**
+     * Function Update
+     * re-tests the items affected by a change. Only the given items are indexed and
+     * ranked again, so all the changed items must be given. Modules are expanded to their
+     * pads, items which are not tracks, vias or pads are ignored.
+     * @param aAdded the items added to the board
+     * @param aModified the items modified in place. The ones which are no longer linked in
+     * the board lists are taken as removed.
+     * @param aRemoved the items removed from the board. They must not have been deleted.
+     */
+    const DRC_LIVE_RESULT& Update( const std::vector<BOARD_ITEM*>& aAdded,
+                                   const std::vector<BOARD_ITEM*>& aModified,
+                                   const std::vector<BOARD_ITEM*>& aRemoved );
+
+    /**
+     * Function Adopt
+     * takes over the markers created by a full DRC run (already added to the board).
+     * @param aOrder the order the markers are given in
+     * @param aTrackMarkers the marker of each track of aOrder.m_tracks, or NULL
+     * @param aPadMarkers the marker of each pad of aOrder.m_sortedPads, or NULL
+     * (may be empty if the pad test was not run)
+     */
+    void Adopt( const DRC_TEST_ORDER& aOrder, const std::vector<MARKER_PCB*>& aTrackMarkers,
+                const std::vector<MARKER_PCB*>& aPadMarkers );
+
+    /**
+     * Function ForgetMarkers
+     * drops the markers of the context without looking at them, when they have been
+     * deleted by someone else.
+     */
+    void ForgetMarkers()
+    {
+        m_markers.clear();
+    }
+
+    const DRC_LIVE_RESULT& GetLastResult() const
+    {
+        return m_lastResult;
+    }
+
+    /**
+     * Function GetMarkers
+     * @return the current markers, by reference item (the track, via or pad tested).
+     */
+    const MARKER_MAP& GetMarkers() const
+    {
+        return m_markers;
+    }
+
+private:
+    /// Appends the copper items of aItem (itself or, for a module, its pads) to aItems
+    static void collectItems( BOARD_ITEM* aItem, std::vector<BOARD_CONNECTED_ITEM*>& aItems );
+
+    /// @return true if aItem is linked in the board lists (or, for a pad, in a module
+    /// which is)
+    static bool isOnBoard( const BOARD_ITEM* aItem );
+
+    /// Records the pads of each module of the board in m_modulePads
+    void recordModulePads();
+
+    /// Forgets the markers which are no longer on the board, and the markers of items
+    /// which are no longer tested
+    void pruneMarkers();
+
+    /// Runs the test of aItem and applies the result to its marker
+    void testItem( BOARD_CONNECTED_ITEM* aItem );
+
+    /// Replaces the marker of aItem by aMarker (NULL when aItem is correct)
+    void setMarker( const BOARD_ITEM* aItem, MARKER_PCB* aMarker );
+
+    void deleteRemovedMarkers();
+
+    BOARD*               m_board;
+    bool                 m_publish;
+    std::unique_ptr<DRC> m_checker;
+
+    DRC_ITEM_INDEX       m_index;
+    DRC_TEST_ORDER       m_order;
+    bool                 m_valid;       ///< false until the first Rebuild()
+
+    ///> The pads of each module, as of its last update: a module may change its pads
+    std::unordered_map<const BOARD_ITEM*, std::vector<BOARD_CONNECTED_ITEM*>> m_modulePads;
+
+    MARKER_MAP           m_markers;
+    DRC_LIVE_RESULT      m_lastResult;
+};
+
+#endif  // DRC_LIVE_CONTEXT_H
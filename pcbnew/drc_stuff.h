@@ -97,6 +97,11 @@ class TRACK;
 class MARKER_PCB;
 class DRC_ITEM;
 class NETCLASS;
+class DRC_ITEM_INDEX;
+class DRC_LIVE_CONTEXT;
+struct DRC_LIVE_RESULT;
+struct DRC_TEST_ORDER;
+class BOARD_CONNECTED_ITEM;
 
 
 /**
@@ -158,6 +163,7 @@ typedef std::vector<DRC_ITEM*> DRC_LIST;
 class DRC
 {
     friend class DIALOG_DRC_CONTROL;
+    friend class DRC_LIVE_CONTEXT;
 
 private:
 
@@ -205,6 +211,8 @@ private:
     BOARD*              m_pcb;
     DIALOG_DRC_CONTROL* m_drcDialog;
 
+    std::unique_ptr<DRC_LIVE_CONTEXT> m_liveContext;   ///< the incremental checker, when live DRC is on
+
     DRC_LIST            m_unconnected;      ///< list of unconnected pads, as DRC_ITEMs
 
 
@@ -269,6 +277,39 @@ private:
      */
     void addMarkerToPcb( MARKER_PCB* aMarker );
 
+    /**
+     * Function addMarkersToPcb
+     * Adds the non null markers of aMarkers to the PCB, in list order, using a single COMMIT.
+     */
+    void addMarkersToPcb( const std::vector<MARKER_PCB*>& aMarkers );
+
+    /**
+     * Function cloneForWorker
+     * creates a checker for the same board. The single item tests keep their working
+     * state (m_segmAngle, m_currentMarker...) in members, so each thread of the parallel
+     * tests needs its own DRC instance.
+     */
+    std::unique_ptr<DRC> cloneForWorker() const;
+
+    /**
+     * Function init
+     * sets the test options and the working state to their initial values.
+     */
+    void init();
+
+    /**
+     * Function createLiveContext
+     * creates the live DRC context of the current board, if it does not exist yet.
+     */
+    void createLiveContext();
+
+    /**
+     * Function applyLiveMarkers
+     * adds the new markers of a live DRC update to the board and removes the old ones,
+     * in a single commit.
+     */
+    void applyLiveMarkers( const DRC_LIVE_RESULT& aResult );
+
     //-----<categorical group tests>-----------------------------------------
 
     /**
@@ -287,13 +328,27 @@ private:
      * Function testTracks
      * performs the DRC on all tracks.
      * because this test can take a while, a progress bar can be displayed
+     * @param aIndex = the items to pick the candidates from
+     * @param aOrder = the order of the tracks and pads of the board
      * @param aActiveWindow = the active window ued as parent for the progress bar
      * @param aShowProgressBar = true to show a progress bar
      * (Note: it is shown only if there are many tracks)
+     * @param aMarkers = receives the marker of each track (or NULL), in aOrder.m_tracks order.
+     * The markers are not added to the board.
      */
-    void testTracks( wxWindow * aActiveWindow, bool aShowProgressBar );
+    void testTracks( const DRC_ITEM_INDEX& aIndex, const DRC_TEST_ORDER& aOrder,
+                     wxWindow * aActiveWindow, bool aShowProgressBar,
+                     std::vector<MARKER_PCB*>& aMarkers );
 
-    void testPad2Pad();
+    /**
+     * Function testPad2Pad
+     * performs the pad to pad clearance tests. Candidate pairs are taken from aIndex
+     * and tested in parallel.
+     * @param aMarkers = receives the marker of each pad (or NULL), in aOrder.m_sortedPads
+     * order. The markers are not added to the board.
+     */
+    void testPad2Pad( const DRC_ITEM_INDEX& aIndex, const DRC_TEST_ORDER& aOrder,
+                      std::vector<MARKER_PCB*>& aMarkers );
 
     void testUnconnected();
 
@@ -307,6 +362,26 @@ private:
 
     bool doNetClass( std::shared_ptr<NETCLASS> aNetClass, wxString& msg );
 
+    /**
+     * Function doTrackClearanceDrc
+     * tests the clearances of a track or via against the nearby pads, and against the
+     * nearby tracks following it in aOrder, as the full track test does.
+     * @return bool - true if no poblems, else false and m_currentMarker is
+     *          filled in with the problem information.
+     */
+    bool doTrackClearanceDrc( TRACK* aRefSeg, const DRC_ITEM_INDEX& aIndex,
+                              const DRC_TEST_ORDER& aOrder );
+
+    /**
+     * Function doPadClearanceDrc
+     * tests the clearances of a pad against the nearby pads following it in aOrder,
+     * as the full pad to pad test does.
+     * @return bool - true if no poblems, else false and m_currentMarker is
+     *          filled in with the problem information.
+     */
+    bool doPadClearanceDrc( D_PAD* aRefPad, const DRC_ITEM_INDEX& aIndex,
+                            const DRC_TEST_ORDER& aOrder );
+
     /**
      * Function doPadToPadsDrc
      * tests the clearance between aRefPad and other pads.
@@ -314,7 +389,8 @@ private:
      * @param aRefPad The pad to test
      * @param aStart The start of the pad list to test against
      * @param aEnd Marks the end of the list and is not included
-     * @param x_limit is used to stop the test (when the any pad's X coord exceeds this)
+     * @param x_limit is used to stop the test (when the any pad's X coord exceeds this),
+     *                INT_MAX to test the whole (then unsorted) list
      */
     bool doPadToPadsDrc( D_PAD* aRefPad, D_PAD** aStart, D_PAD** aEnd, int x_limit );
 
@@ -329,6 +405,19 @@ private:
      */
     bool doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool doPads = true );
 
+    /**
+     * Function DoTrackDrc
+     * tests the current segment against the given pads and tracks only.
+     * The first violation found, in list order, is reported.
+     * @param aRefSeg The segment to test
+     * @param aPads The pads to test against
+     * @param aTracks The tracks and vias to test against
+     * @return bool - true if no poblems, else false and m_currentMarker is
+     *          filled in with the problem information.
+     */
+    bool doTrackDrc( TRACK* aRefSeg, const std::vector<D_PAD*>& aPads,
+                     const std::vector<TRACK*>& aTracks );
+
     /**
      * Function doTrackKeepoutDrc
      * tests the current segment or via.
@@ -416,6 +505,13 @@ private:
 public:
     DRC( PCB_EDIT_FRAME* aPcbWindow );
 
+    /**
+     * Constructor
+     * creates a checker without user interface, for aBoard. Markers are added
+     * directly to the board.
+     */
+    DRC( BOARD* aBoard );
+
     ~DRC();
 
     /**
@@ -536,6 +632,42 @@ public:
         return m_currentMarker;
     }
 
+    /**
+     * Function UpdateLiveDrc
+     * re-tests the tracks, vias and pads affected by a change of the board, when the live
+     * DRC is enabled in the settings (see DRC_LIVE_CONTEXT). Called by BOARD_COMMIT::Push()
+     * and by the undo and redo commands, which give all the items they changed.
+     * @param aAdded the items added to the board
+     * @param aModified the items modified in place (or removed, see
+     * DRC_LIVE_CONTEXT::Update())
+     * @param aRemoved the items removed from the board (they must not be deleted yet)
+     */
+    void UpdateLiveDrc( const std::vector<BOARD_ITEM*>& aAdded,
+                        const std::vector<BOARD_ITEM*>& aModified,
+                        const std::vector<BOARD_ITEM*>& aRemoved );
+
+    /**
+     * Function RebuildLiveDrc
+     * re-tests the whole board, when the live DRC is enabled. Used after changes which
+     * are not reported (legacy tools).
+     */
+    void RebuildLiveDrc();
+
+    /**
+     * Function ResetLiveDrc
+     * forgets the live DRC state, without touching the board. Must be called when the
+     * board is replaced.
+     */
+    void ResetLiveDrc();
+
+    /**
+     * @return the live DRC context, or NULL if the live DRC has not run yet.
+     */
+    DRC_LIVE_CONTEXT* GetLiveContext() const
+    {
+        return m_liveContext.get();
+    }
+
 };
 
 
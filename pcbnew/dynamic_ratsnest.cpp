@@ -0,0 +1,337 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <unordered_map>
+
+#include <dynamic_ratsnest.h>
+#include <connectivity_algo.h>
+#include <ratsnest_data.h>
+
+
+/**
+ * Arranges the points of [aFirst, aLast) as a k-d tree: the median point along the split
+ * axis (x, then y at the next depth) is in the middle, with the points before it on one
+ * side and the points after it on the other side.
+ */
+static void buildTree( std::vector<VECTOR2I>& aPoints, int aFirst, int aLast, int aDepth )
+{
+    if( aLast - aFirst < 2 )
+        return;
+
+    int mid = ( aFirst + aLast ) / 2;
+    bool splitX = ( aDepth % 2 ) == 0;
+
+    std::nth_element( aPoints.begin() + aFirst, aPoints.begin() + mid, aPoints.begin() + aLast,
+            [splitX] ( const VECTOR2I& aA, const VECTOR2I& aB )
+            {
+                return splitX ? aA.x < aB.x : aA.y < aB.y;
+            } );
+
+    buildTree( aPoints, aFirst, mid, aDepth + 1 );
+    buildTree( aPoints, mid + 1, aLast, aDepth + 1 );
+}
+
+
+/**
+ * Finds the point of the k-d tree [aFirst, aLast) closer to aQuery than aBestDist
+ * (a squared distance), if any, and updates aBest and aBestDist.
+ */
+static void findNearest( const std::vector<VECTOR2I>& aPoints, int aFirst, int aLast, int aDepth,
+                         const VECTOR2I& aQuery, VECTOR2I& aBest,
+                         VECTOR2I::extended_type& aBestDist )
+{
+    if( aFirst >= aLast )
+        return;
+
+    int mid = ( aFirst + aLast ) / 2;
+    const VECTOR2I& point = aPoints[mid];
+    VECTOR2I::extended_type dist = ( point - aQuery ).SquaredEuclideanNorm();
+
+    if( dist < aBestDist )
+    {
+        aBestDist = dist;
+        aBest = point;
+    }
+
+    VECTOR2I::extended_type delta = ( aDepth % 2 ) == 0
+                                    ? (VECTOR2I::extended_type) aQuery.x - point.x
+                                    : (VECTOR2I::extended_type) aQuery.y - point.y;
+
+    // The side of the query first, the other one only if it may be close enough
+    if( delta < 0 )
+    {
+        findNearest( aPoints, aFirst, mid, aDepth + 1, aQuery, aBest, aBestDist );
+
+        if( delta * delta < aBestDist )
+            findNearest( aPoints, mid + 1, aLast, aDepth + 1, aQuery, aBest, aBestDist );
+    }
+    else
+    {
+        findNearest( aPoints, mid + 1, aLast, aDepth + 1, aQuery, aBest, aBestDist );
+
+        if( delta * delta < aBestDist )
+            findNearest( aPoints, aFirst, mid, aDepth + 1, aQuery, aBest, aBestDist );
+    }
+}
+
+
+DYNAMIC_RATSNEST::DYNAMIC_RATSNEST( std::function<void()> aLinesReady ) :
+    m_linesReady( aLinesReady ),
+    m_serial( 0 ),
+    m_quit( false ),
+    m_pending( false ),
+    m_ready( false )
+{
+}
+
+
+DYNAMIC_RATSNEST::~DYNAMIC_RATSNEST()
+{
+    Stop();
+}
+
+
+void DYNAMIC_RATSNEST::Start( const std::shared_ptr<CONNECTIVITY_DATA>& aConnectivity,
+                              const std::vector<BOARD_ITEM*>& aItems )
+{
+    Stop();
+
+    m_connectivity = aConnectivity;
+    m_serial = aConnectivity->GetSerial();
+    m_items = aItems;
+
+    m_moving.reset( new CONNECTIVITY_DATA );
+    m_moving->Build( aItems );
+
+    aConnectivity->BlockRatsnestItems( aItems );
+
+    for( int net = 1; net < m_moving->GetNetCount(); net++ )
+    {
+        RN_NET* movingNet = m_moving->GetRatsnestForNet( net );
+
+        if( !movingNet || movingNet->GetNodeCount() == 0 )
+            continue;
+
+        // The dragged nodes of the net, with their index
+        std::unordered_map<CN_ANCHOR_PTR, int> nodeIndex;
+
+        m_netFirstNode.push_back( m_movingNodes.size() );
+
+        for( auto node : movingNet->GetNodes() )
+        {
+            MOVING_NODE movingNode;
+
+            movingNode.m_item = node->Item();
+            movingNode.m_anchor = node - &node->Item()->Anchors()[0];
+
+            nodeIndex[node] = m_movingNodes.size();
+            m_movingNodes.push_back( movingNode );
+        }
+
+        for( const auto& edge : movingNet->GetUnconnected() )
+        {
+            m_movingEdges.emplace_back( nodeIndex[ edge.GetSourceNode() ],
+                                        nodeIndex[ edge.GetTargetNode() ] );
+        }
+
+        // The nodes of the net which stay in place
+        STATIC_NET staticNet;
+        RN_NET* boardNet = aConnectivity->GetRatsnestForNet( net );
+
+        staticNet.m_net = net;
+
+        if( boardNet )
+        {
+            for( auto node : boardNet->GetNodes() )
+            {
+                if( !node->GetNoLine() )
+                    staticNet.m_points.push_back( node->Pos() );
+            }
+        }
+
+        buildTree( staticNet.m_points, 0, staticNet.m_points.size(), 0 );
+        m_staticNets.push_back( std::move( staticNet ) );
+    }
+
+    m_netFirstNode.push_back( m_movingNodes.size() );
+
+    m_quit = false;
+    m_pending = false;
+    m_ready = false;
+    m_thread = std::thread( &DYNAMIC_RATSNEST::run, this );
+
+    Update( aConnectivity, aItems );
+}
+
+
+bool DYNAMIC_RATSNEST::Update( const std::shared_ptr<CONNECTIVITY_DATA>& aConnectivity,
+                               const std::vector<BOARD_ITEM*>& aItems )
+{
+    if( !m_moving || aConnectivity != m_connectivity || aConnectivity->GetSerial() != m_serial
+            || aItems != m_items )
+        return false;
+
+    // The items are read here, the thread only sees the positions
+    std::lock_guard<std::mutex> lock( m_lock );
+
+    m_request.resize( m_movingNodes.size() );
+
+    for( unsigned int i = 0; i < m_movingNodes.size(); i++ )
+    {
+        const MOVING_NODE& node = m_movingNodes[i];
+
+        m_request[i] = node.m_item->GetAnchor( node.m_anchor );
+    }
+
+    m_pending = true;
+    m_wakeUp.notify_one();
+
+    return true;
+}
+
+
+void DYNAMIC_RATSNEST::Stop()
+{
+    if( m_thread.joinable() )
+    {
+        {
+            std::lock_guard<std::mutex> lock( m_lock );
+            m_quit = true;
+        }
+
+        m_wakeUp.notify_one();
+        m_thread.join();
+    }
+
+    m_connectivity.reset();
+    m_items.clear();
+    m_moving.reset();
+    m_movingNodes.clear();
+    m_staticNets.clear();
+    m_netFirstNode.clear();
+    m_movingEdges.clear();
+    m_pending = false;
+    m_ready = false;
+}
+
+
+bool DYNAMIC_RATSNEST::SwapLines( std::vector<RN_DYNAMIC_LINE>& aLines )
+{
+    std::lock_guard<std::mutex> lock( m_lock );
+
+    if( !m_ready )
+        return false;
+
+    aLines.swap( m_result );
+    m_ready = false;
+
+    return true;
+}
+
+
+void DYNAMIC_RATSNEST::run()
+{
+    std::vector<VECTOR2I> positions;
+    std::vector<RN_DYNAMIC_LINE> lines;
+
+    while( true )
+    {
+        {
+            std::unique_lock<std::mutex> lock( m_lock );
+
+            m_wakeUp.wait( lock, [this] () { return m_quit || m_pending; } );
+
+            if( m_quit )
+                return;
+
+            // Only the last positions count
+            positions.swap( m_request );
+            m_pending = false;
+        }
+
+        compute( positions, lines );
+
+        {
+            std::lock_guard<std::mutex> lock( m_lock );
+
+            m_result.swap( lines );
+            m_ready = true;
+        }
+
+        if( m_linesReady )
+            m_linesReady();
+    }
+}
+
+
+void DYNAMIC_RATSNEST::compute( const std::vector<VECTOR2I>& aPositions,
+                                std::vector<RN_DYNAMIC_LINE>& aLines )
+{
+    aLines.clear();
+
+    // The shortest line from the dragged nodes of each net to its other nodes. The
+    // queries only look for points closer than the best one so far, which they replace.
+    for( unsigned int i = 0; i < m_staticNets.size(); i++ )
+    {
+        const STATIC_NET& net = m_staticNets[i];
+        VECTOR2I::extended_type bestDist = VECTOR2I::ECOORD_MAX;
+        VECTOR2I staticPos;
+        int bestNode = -1;
+
+        for( int node = m_netFirstNode[i]; node < m_netFirstNode[i + 1]; node++ )
+        {
+            VECTOR2I::extended_type dist = bestDist;
+
+            findNearest( net.m_points, 0, net.m_points.size(), 0, aPositions[node],
+                         staticPos, dist );
+
+            if( dist < bestDist )
+            {
+                bestDist = dist;
+                bestNode = node;
+            }
+        }
+
+        if( bestNode >= 0 )
+        {
+            RN_DYNAMIC_LINE l;
+
+            l.a = staticPos;
+            l.b = aPositions[bestNode];
+            l.netCode = net.m_net;
+            aLines.push_back( l );
+        }
+    }
+
+    // The lines between the dragged nodes, which move together
+    for( const auto& edge : m_movingEdges )
+    {
+        RN_DYNAMIC_LINE l;
+
+        l.a = aPositions[edge.first];
+        l.b = aPositions[edge.second];
+        l.netCode = 0;
+        aLines.push_back( l );
+    }
+}
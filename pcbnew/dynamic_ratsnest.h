@@ -0,0 +1,147 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef DYNAMIC_RATSNEST_H
+#define DYNAMIC_RATSNEST_H
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <math/vector2d.h>
+#include <connectivity.h>
+
+class BOARD_ITEM;
+class CN_ITEM;
+
+/**
+ * Class DYNAMIC_RATSNEST
+ *
+ * Computes the ratsnest of items being dragged, on a thread of its own.
+ *
+ * Start() does the work which does not depend on where the items are: it builds the
+ * connectivity of the dragged items and copies the anchors of the other items of their
+ * nets, which do not move, to a k-d tree per net. The spanning trees of the dragged items
+ * do not change as they move together, and the dragged anchor closest to the rest of its
+ * net is found with nearest neighbor queries in the k-d trees.
+ *
+ * Update() only reads the positions of the dragged anchors, and hands them to the thread.
+ * The lines are computed in a buffer of the thread, and exchanged with the ones drawn by
+ * SwapLines(), so that no buffer is allocated once the drag goes on.
+ */
+class DYNAMIC_RATSNEST
+{
+public:
+    /**
+     * @param aLinesReady is called from the ratsnest thread when new lines can be taken
+     * with SwapLines(). It must not touch the user interface itself.
+     */
+    DYNAMIC_RATSNEST( std::function<void()> aLinesReady );
+    ~DYNAMIC_RATSNEST();
+
+    /**
+     * Function Start
+     * prepares the ratsnest of aItems, dragged away from the other items of aConnectivity,
+     * and computes it for their current position. The anchors of aItems are hidden from
+     * the ratsnest of aConnectivity until its ClearDynamicRatsnest() is called.
+     */
+    void Start( const std::shared_ptr<CONNECTIVITY_DATA>& aConnectivity,
+                const std::vector<BOARD_ITEM*>& aItems );
+
+    /**
+     * Function Update
+     * computes the ratsnest of the items for their current position.
+     * @return false if the ratsnest must be started again, because the connectivity or
+     * the items are not the ones given to Start(), or the connectivity changed since.
+     */
+    bool Update( const std::shared_ptr<CONNECTIVITY_DATA>& aConnectivity,
+                 const std::vector<BOARD_ITEM*>& aItems );
+
+    /**
+     * Function Stop
+     * waits for the computation in progress, and drops the ratsnest.
+     */
+    void Stop();
+
+    /**
+     * Function SwapLines
+     * exchanges aLines with the last computed lines, if there are new ones.
+     * @return true if aLines was exchanged.
+     */
+    bool SwapLines( std::vector<RN_DYNAMIC_LINE>& aLines );
+
+private:
+    ///> A dragged anchor: how to read its position
+    struct MOVING_NODE
+    {
+        CN_ITEM*    m_item;
+        int         m_anchor;
+    };
+
+    ///> The anchors of a net which do not move, stored as a k-d tree (see buildTree())
+    struct STATIC_NET
+    {
+        int                     m_net;
+        std::vector<VECTOR2I>   m_points;
+    };
+
+    void run();
+
+    ///> Computes the lines for the dragged anchors at aPositions
+    void compute( const std::vector<VECTOR2I>& aPositions, std::vector<RN_DYNAMIC_LINE>& aLines );
+
+    std::function<void()>                   m_linesReady;
+
+    std::shared_ptr<CONNECTIVITY_DATA>      m_connectivity;
+    unsigned                                m_serial;
+    std::vector<BOARD_ITEM*>                m_items;
+
+    ///> The connectivity of the dragged items alone
+    std::unique_ptr<CONNECTIVITY_DATA>      m_moving;
+    std::vector<MOVING_NODE>                m_movingNodes;
+
+    ///> The static nets, and the first dragged node of each of them (and the end)
+    std::vector<STATIC_NET>                 m_staticNets;
+    std::vector<int>                        m_netFirstNode;
+
+    ///> The ratsnest lines between dragged nodes, as node indices
+    std::vector<std::pair<int, int>>        m_movingEdges;
+
+    std::thread                             m_thread;
+    std::mutex                              m_lock;
+    std::condition_variable                 m_wakeUp;
+    bool                                    m_quit;
+
+    ///> The positions to compute the lines for, when m_pending is set
+    std::vector<VECTOR2I>                   m_request;
+    bool                                    m_pending;
+
+    ///> The last computed lines, when m_ready is set
+    std::vector<RN_DYNAMIC_LINE>            m_result;
+    bool                                    m_ready;
+};
+
+#endif  // DYNAMIC_RATSNEST_H
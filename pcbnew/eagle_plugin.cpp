@@ -1767,7 +1767,7 @@ void EAGLE_PLUGIN::loadSignals( wxXmlNode* aSignals )
                     t->SetLayer( layer );
                     t->SetNetCode( netCode );
 
-                    m_board->m_Track.Insert( t, NULL );
+                    m_board->Add( t, ADD_APPEND );
                 }
                 else
                 {
@@ -1791,7 +1791,6 @@ void EAGLE_PLUGIN::loadSignals( wxXmlNode* aSignals )
                     int  kidiam;
                     int  drillz = v.drill.ToPcbUnits();
                     VIA* via = new VIA( m_board );
-                    m_board->m_Track.Insert( via, NULL );
 
                     via->SetLayerPair( layer_front_most, layer_back_most );
 
@@ -1840,6 +1839,8 @@ void EAGLE_PLUGIN::loadSignals( wxXmlNode* aSignals )
                     via->SetEnd( pos );
 
                     via->SetNetCode( netCode );
+
+                    m_board->Add( via, ADD_APPEND );
                 }
 
                 m_xpath->pop();
@@ -483,8 +483,7 @@ bool PCB_EDIT_FRAME::End_Route( TRACK* aTrack, wxDC* aDC )
         {
             ITEM_PICKER picker( track, UR_NEW );
             s_ItemsListPicker.PushItem( picker );
-            GetBoard()->m_Track.Insert( track, insertBeforeMe );
-            GetBoard()->GetConnectivity()->Add( track );
+            GetBoard()->InsertTrack( track, insertBeforeMe );
         }
 
         TraceAirWiresToTargets( aDC );
@@ -34,12 +34,245 @@
 #include <lib_id.h>
 #include <macros.h>
 #include <make_unique.h>
+#include <pcb_parser.h>
 #include <pgm_base.h>
+#include <richio.h>
 #include <wildcards_and_files_ext.h>
 
+#include <wx/dir.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+
+#include <ctime>
+#include <map>
 #include <thread>
 
 
+/// The version of the footprint library indexes, to increment when their content changes
+#define FOOTPRINT_INDEX_VERSION     2
+
+
+/**
+ * A footprint of a library index, with the size and time of its file when it was read.
+ * A file which could not be read is kept with its error, reported again by the next loads
+ * for as long as the file is unchanged.
+ */
+struct FOOTPRINT_INDEX_ENTRY
+{
+    long long   m_size;
+    long long   m_time;
+    bool        m_failed;
+    wxString    m_error;
+    int         m_pad_count;
+    int         m_unique_pad_count;
+    wxString    m_doc;
+    wxString    m_keywords;
+};
+
+/// The footprints of a library index, by footprint name
+typedef std::map<wxString, FOOTPRINT_INDEX_ENTRY> FOOTPRINT_INDEX;
+
+
+/**
+ * Gives the size and modification time in seconds of the file or directory aPath.
+ * @return false if it does not exist.
+ */
+static bool statFile( const wxString& aPath, long long* aSize, long long* aTime )
+{
+    wxStructStat st;
+
+    if( wxStat( aPath, &st ) != 0 )
+        return false;
+
+    *aSize = st.st_size;
+    *aTime = st.st_mtime;
+
+    // A file modified during the last second may change again without its time changing,
+    // so it is not trusted by the next load
+    if( *aTime >= (long long) time( NULL ) - 1 )
+        *aTime = -1;
+
+    return true;
+}
+
+
+/**
+ * Reads the index aIndexFile of the library directory aLibraryPath.
+ * @return false if there is no index of the library of this version, or if it is damaged.
+ */
+static bool readIndex( const wxString& aIndexFile, const wxString& aLibraryPath,
+                       long long* aLibraryTime, FOOTPRINT_INDEX& aIndex )
+{
+    if( !wxFileExists( aIndexFile ) )
+        return false;
+
+    try
+    {
+        FILE_LINE_READER reader( aIndexFile );
+        DSNLEXER lexer( NULL, 0, &reader );
+
+        auto needKeyword = [&]( const char* aKeyword )
+        {
+            lexer.NeedLEFT();
+
+            if( !DSNLEXER::IsSymbol( lexer.NextTok() ) || strcmp( lexer.CurText(), aKeyword ) )
+                lexer.Expecting( aKeyword );
+        };
+
+        auto needNumber = [&]( const char* aKeyword ) -> long long
+        {
+            needKeyword( aKeyword );
+            lexer.NeedNUMBER( aKeyword );
+
+            long long value = strtoll( lexer.CurText(), NULL, 10 );
+
+            lexer.NeedRIGHT();
+            return value;
+        };
+
+        auto needString = [&]( const char* aKeyword ) -> wxString
+        {
+            needKeyword( aKeyword );
+            lexer.NeedSYMBOLorNUMBER();
+
+            wxString value = FROM_UTF8( lexer.CurText() );
+
+            lexer.NeedRIGHT();
+            return value;
+        };
+
+        needKeyword( "footprint_index" );
+
+        if( needNumber( "version" ) != FOOTPRINT_INDEX_VERSION
+                || needString( "library" ) != aLibraryPath )
+            return false;
+
+        *aLibraryTime = needNumber( "time" );
+
+        int tok;
+
+        while( ( tok = lexer.NextTok() ) == DSN_LEFT )
+        {
+            if( !DSNLEXER::IsSymbol( lexer.NextTok() ) || strcmp( lexer.CurText(), "footprint" ) )
+                lexer.Expecting( "footprint" );
+
+            lexer.NeedSYMBOLorNUMBER();
+
+            FOOTPRINT_INDEX_ENTRY& entry = aIndex[FROM_UTF8( lexer.CurText() )];
+
+            entry.m_size = needNumber( "size" );
+            entry.m_time = needNumber( "time" );
+
+            lexer.NeedLEFT();
+
+            if( !DSNLEXER::IsSymbol( lexer.NextTok() ) )
+                lexer.Expecting( "pads or failed" );
+
+            entry.m_failed = !strcmp( lexer.CurText(), "failed" );
+
+            if( entry.m_failed )
+            {
+                lexer.NeedSYMBOLorNUMBER();
+                entry.m_error = FROM_UTF8( lexer.CurText() );
+                entry.m_pad_count = 0;
+                entry.m_unique_pad_count = 0;
+                lexer.NeedRIGHT();
+                lexer.NeedRIGHT();
+                continue;
+            }
+
+            if( strcmp( lexer.CurText(), "pads" ) )
+                lexer.Expecting( "pads or failed" );
+
+            lexer.NeedNUMBER( "pads" );
+            entry.m_pad_count = atoi( lexer.CurText() );
+            lexer.NeedNUMBER( "pads" );
+            entry.m_unique_pad_count = atoi( lexer.CurText() );
+            lexer.NeedRIGHT();
+
+            entry.m_doc = needString( "descr" );
+            entry.m_keywords = needString( "tags" );
+
+            lexer.NeedRIGHT();
+        }
+
+        if( tok != DSN_RIGHT )
+            lexer.Expecting( DSN_RIGHT );
+    }
+    catch( const IO_ERROR& )
+    {
+        // A damaged index is made again
+        aIndex.clear();
+        return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * Writes the index aIndexFile of the library directory aLibraryPath.
+ * @throw IO_ERROR if it cannot be written.
+ */
+static void writeIndex( const wxString& aIndexFile, const wxString& aLibraryPath,
+                        long long aLibraryTime, const FOOTPRINT_INDEX& aIndex )
+{
+    wxFileName fn( aIndexFile );
+
+    if( !fn.DirExists() && !wxFileName::Mkdir( fn.GetPath(), 0777, wxPATH_MKDIR_FULL ) )
+    {
+        THROW_IO_ERROR( wxString::Format( _( "Cannot create directory '%s'" ),
+                                          GetChars( fn.GetPath() ) ) );
+    }
+
+    // Written aside then renamed, so that another instance never reads half an index
+    wxString tempFile = wxFileName::CreateTempFileName( aIndexFile );
+
+    try
+    {
+        FILE_OUTPUTFORMATTER out( tempFile );
+
+        out.Print( 0, "(footprint_index (version %d)\n", FOOTPRINT_INDEX_VERSION );
+        out.Print( 1, "(library %s) (time %lld)\n", out.Quotew( aLibraryPath ).c_str(),
+                   aLibraryTime );
+
+        for( auto const& it : aIndex )
+        {
+            const FOOTPRINT_INDEX_ENTRY& entry = it.second;
+
+            if( entry.m_failed )
+            {
+                out.Print( 1, "(footprint %s (size %lld) (time %lld) (failed %s))\n",
+                           out.Quotew( it.first ).c_str(), entry.m_size, entry.m_time,
+                           out.Quotew( entry.m_error ).c_str() );
+                continue;
+            }
+
+            out.Print( 1, "(footprint %s (size %lld) (time %lld) (pads %d %d)",
+                       out.Quotew( it.first ).c_str(), entry.m_size, entry.m_time,
+                       entry.m_pad_count, entry.m_unique_pad_count );
+            out.Print( 0, " (descr %s) (tags %s))\n", out.Quotew( entry.m_doc ).c_str(),
+                       out.Quotew( entry.m_keywords ).c_str() );
+        }
+
+        out.Print( 0, ")\n" );
+    }
+    catch( const IO_ERROR& )
+    {
+        wxRemoveFile( tempFile );
+        throw;
+    }
+
+    if( !wxRenameFile( tempFile, aIndexFile, true ) )
+    {
+        wxRemoveFile( tempFile );
+
+        THROW_IO_ERROR( wxString::Format( _( "Cannot rename file '%s' to '%s'" ),
+                                          GetChars( tempFile ), GetChars( aIndexFile ) ) );
+    }
+}
+
+
 void FOOTPRINT_INFO_IMPL::load()
 {
     FP_LIB_TABLE* fptable = m_owner->GetTable();
@@ -103,8 +336,11 @@ void FOOTPRINT_LIST_IMPL::loader_job()
     while( m_queue_in.pop( nickname ) )
     {
         CatchErrors( [this, &nickname]() {
-            m_lib_table->PrefetchLib( nickname );
-            m_queue_out.push( nickname );
+            if( !loadIndexed( nickname ) )
+            {
+                m_lib_table->PrefetchLib( nickname );
+                m_queue_out.push( nickname );
+            }
         } );
 
         m_count_finished.fetch_add( 1 );
@@ -121,6 +357,178 @@ void FOOTPRINT_LIST_IMPL::loader_job()
 }
 
 
+bool FOOTPRINT_LIST_IMPL::loadIndexed( const wxString& aNickname )
+{
+    const FP_LIB_TABLE_ROW* row = m_lib_table->FindRow( aNickname );
+
+    if( IO_MGR::EnumFromStr( row->GetType() ) != IO_MGR::KICAD_SEXP )
+        return false;
+
+    wxString    libPath = row->GetFullURI( true );
+    long long   libSize;
+    long long   libTime;
+
+    if( !wxDirExists( libPath ) || !statFile( libPath, &libSize, &libTime ) )
+        return false;
+
+    wxString        indexFile = IndexFileName( libPath );
+    FOOTPRINT_INDEX index;
+    long long       indexTime = -1;
+    bool            changed = !readIndex( indexFile, libPath, &indexTime, index );
+    std::vector<wxString> names;
+
+    // The files of the library are those of its index for as long as the directory is unchanged
+    if( !changed && libTime >= 0 && indexTime == libTime )
+    {
+        for( auto const& it : index )
+            names.push_back( it.first );
+    }
+    else
+    {
+        wxDir dir( libPath );
+
+        if( !dir.IsOpened() )
+            return false;
+
+        wxString fileName;
+        wxString wildcard = wxT( "*." ) + KiCadFootprintFileExtension;
+
+        if( dir.GetFirst( &fileName, wildcard, wxDIR_FILES ) )
+        {
+            do
+            {
+                names.push_back( wxFileName( fileName ).GetName() );
+            } while( dir.GetNext( &fileName ) );
+        }
+
+        changed = true;
+    }
+
+    FOOTPRINT_INDEX current;
+
+    for( const wxString& name : names )
+    {
+        wxFileName  fn( libPath, name, KiCadFootprintFileExtension );
+        long long   size;
+        long long   fileTime;
+
+        if( !statFile( fn.GetFullPath(), &size, &fileTime ) )
+        {
+            changed = true;
+            continue;
+        }
+
+        auto it = index.find( name );
+
+        if( it != index.end() && fileTime >= 0 && it->second.m_size == size
+                && it->second.m_time == fileTime )
+        {
+            FOOTPRINT_INDEX_ENTRY& entry = current[name];
+
+            entry = std::move( it->second );
+
+            // An unchanged file which could not be read gives the same error
+            if( entry.m_failed )
+                CatchErrors( [&]() { THROW_IO_ERROR( entry.m_error ); } );
+
+            continue;
+        }
+
+        changed = true;
+
+        // Only the changed files are parsed, the errors of one do not stop the others.
+        // A file which cannot be read stays in the index, to be read again once changed.
+        FOOTPRINT_INDEX_ENTRY& entry = current[name];
+
+        entry.m_size = size;
+        entry.m_time = fileTime;
+        entry.m_failed = true;
+        entry.m_pad_count = 0;
+        entry.m_unique_pad_count = 0;
+
+        CatchErrors( [&]() {
+            try
+            {
+                LOCALE_IO                   toggle;
+                MAPPED_FILE_LINE_READER     reader( fn.GetFullPath() );
+                PCB_PARSER                  parser( &reader );
+                std::unique_ptr<BOARD_ITEM> item( parser.Parse() );
+                MODULE*                     footprint = dynamic_cast<MODULE*>( item.get() );
+
+                if( !footprint )
+                {
+                    THROW_IO_ERROR( wxString::Format( _( "File '%s' is not a footprint" ),
+                                                      GetChars( fn.GetFullPath() ) ) );
+                }
+
+                entry.m_pad_count = footprint->GetPadCount( DO_NOT_INCLUDE_NPTH );
+                entry.m_unique_pad_count = footprint->GetUniquePadCount( DO_NOT_INCLUDE_NPTH );
+                entry.m_doc = footprint->GetDescription();
+                entry.m_keywords = footprint->GetKeywords();
+                entry.m_failed = false;
+            }
+            catch( const IO_ERROR& ioe )
+            {
+                entry.m_error = ioe.Problem();
+                throw;
+            }
+            catch( const std::exception& se )
+            {
+                entry.m_error = FROM_UTF8( se.what() );
+                throw;
+            }
+        } );
+    }
+
+    if( changed )
+    {
+        try
+        {
+            writeIndex( indexFile, libPath, libTime, current );
+        }
+        catch( const IO_ERROR& )
+        {
+            // The index is only a cache, the library is listed without it
+        }
+    }
+
+    for( auto const& it : current )
+    {
+        const FOOTPRINT_INDEX_ENTRY& entry = it.second;
+
+        if( entry.m_failed )
+            continue;
+
+        FOOTPRINT_INFO* fpinfo = new FOOTPRINT_INFO_IMPL( this, aNickname, it.first,
+                entry.m_doc, entry.m_keywords, entry.m_pad_count, entry.m_unique_pad_count );
+
+        m_queue_indexed.move_push( std::unique_ptr<FOOTPRINT_INFO>( fpinfo ) );
+    }
+
+    return true;
+}
+
+
+wxString FOOTPRINT_LIST_IMPL::IndexFileName( const wxString& aLibraryPath )
+{
+    // A FNV-1a hash of the path, which unlike std::hash is the same for all the builds
+    std::string path = TO_UTF8( aLibraryPath );
+    uint64_t    hash = 0xCBF29CE484222325ULL;
+
+    for( char c : path )
+        hash = ( hash ^ (unsigned char) c ) * 0x100000001B3ULL;
+
+    wxFileName fn( GetKicadConfigPath(), wxEmptyString );
+
+    fn.AppendDir( wxT( "fp-index" ) );
+    fn.SetName( wxFileName( aLibraryPath ).GetName()
+                + wxString::Format( wxT( "-%016llx" ), (unsigned long long) hash ) );
+    fn.SetExt( wxT( "index" ) );
+
+    return fn.GetFullPath();
+}
+
+
 bool FOOTPRINT_LIST_IMPL::ReadFootprintFiles( FP_LIB_TABLE* aTable, const wxString* aNickname )
 {
     FOOTPRINT_ASYNC_LOADER loader;
@@ -145,6 +553,7 @@ void FOOTPRINT_LIST_IMPL::StartWorkers( FP_LIB_TABLE* aTable, wxString const* aN
     m_threads.clear();
     m_queue_in.clear();
     m_queue_out.clear();
+    m_queue_indexed.clear();
 
     if( aNickname )
         m_queue_in.push( *aNickname );
@@ -230,6 +639,9 @@ bool FOOTPRINT_LIST_IMPL::JoinWorkers()
     while( queue_parsed.pop( fpi ) )
         m_list.push_back( std::move( fpi ) );
 
+    while( m_queue_indexed.pop( fpi ) )
+        m_list.push_back( std::move( fpi ) );
+
     std::sort( m_list.begin(), m_list.end(),
             []( std::unique_ptr<FOOTPRINT_INFO> const&     lhs,
                     std::unique_ptr<FOOTPRINT_INFO> const& rhs ) -> bool { return *lhs < *rhs; } );
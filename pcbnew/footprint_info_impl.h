@@ -50,6 +50,22 @@ public:
 #endif
     }
 
+    /// A footprint already loaded, from the index of its library
+    FOOTPRINT_INFO_IMPL( FOOTPRINT_LIST* aOwner, const wxString& aNickname,
+            const wxString& aFootprintName, const wxString& aDoc, const wxString& aKeywords,
+            int aPadCount, int aUniquePadCount )
+    {
+        m_owner = aOwner;
+        m_loaded = true;
+        m_nickname = aNickname;
+        m_fpname = aFootprintName;
+        m_num = 0;
+        m_pad_count = aPadCount;
+        m_unique_pad_count = aUniquePadCount;
+        m_doc = aDoc;
+        m_keywords = aKeywords;
+    }
+
 protected:
     virtual void load() override;
 };
@@ -61,6 +77,7 @@ class FOOTPRINT_LIST_IMPL : public FOOTPRINT_LIST
     std::vector<std::thread> m_threads;
     SYNC_QUEUE<wxString>     m_queue_in;
     SYNC_QUEUE<wxString>     m_queue_out;
+    SYNC_QUEUE<std::unique_ptr<FOOTPRINT_INFO>> m_queue_indexed;
     std::atomic_size_t       m_count_finished;
     std::atomic_bool         m_first_to_finish;
 
@@ -83,12 +100,30 @@ protected:
      */
     void loader_job();
 
+    /**
+     * Function loadIndexed
+     * lists the footprints of the library \a aNickname into m_queue_indexed from its index,
+     * parsing only the footprint files changed since the index was written, and updates the
+     * index.
+     *
+     * @return false if the library is not a directory of footprint files, which is then
+     *  listed through the library table.
+     */
+    bool loadIndexed( const wxString& aNickname );
+
 public:
     FOOTPRINT_LIST_IMPL();
     virtual ~FOOTPRINT_LIST_IMPL();
 
     virtual bool ReadFootprintFiles(
             FP_LIB_TABLE* aTable, const wxString* aNickname = NULL ) override;
+
+    /**
+     * Function IndexFileName
+     * returns the name of the index of the footprint library directory \a aLibraryPath,
+     * which is kept in the user configuration directory.
+     */
+    static wxString IndexFileName( const wxString& aLibraryPath );
 };
 
 #endif // FOOTPRINT_INFO_IMPL_H
@@ -98,7 +98,11 @@ void FOOTPRINT_WIZARD_FRAME::ReloadFootprint()
 
     SetCurItem( NULL );
     // Delete the current footprint
-    GetBoard()->m_Modules.DeleteAll();
+    while( MODULE* module = GetBoard()->m_Modules )
+    {
+        GetBoard()->Remove( module );
+        delete module;
+    }
 
     // Creates the module
     wxString msg;
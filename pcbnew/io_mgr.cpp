@@ -28,6 +28,7 @@
 #include <io_mgr.h>
 #include <legacy_plugin.h>
 #include <kicad_plugin.h>
+#include <snapshot_plugin.h>
 #include <eagle_plugin.h>
 #include <pcad2kicadpcb_plugin/pcad_plugin.h>
 #include <gpcb_plugin.h>
@@ -84,6 +85,9 @@ PLUGIN* IO_MGR::PluginFind( PCB_FILE_T aFileType )
         THROW_IO_ERROR( "BUILD_GITHUB_PLUGIN not enabled in cmake build environment" );
 #endif
 
+    case KICAD_SNAPSHOT:
+        return new SNAPSHOT_PLUGIN();
+
     case FILE_TYPE_NONE:
         return NULL;
     }
@@ -130,6 +134,9 @@ const wxString IO_MGR::ShowType( PCB_FILE_T aType )
 
     case GITHUB:
         return wxString( wxT( "Github" ) );
+
+    case KICAD_SNAPSHOT:
+        return wxString( wxT( "KiCad-Snapshot" ) );
     }
 }
 
@@ -158,6 +165,9 @@ IO_MGR::PCB_FILE_T IO_MGR::EnumFromStr( const wxString& aType )
     if( aType == wxT( "Github" ) )
         return GITHUB;
 
+    if( aType == wxT( "KiCad-Snapshot" ) )
+        return KICAD_SNAPSHOT;
+
     // wxASSERT( blow up here )
 
     return PCB_FILE_T( -1 );
@@ -56,6 +56,7 @@ public:
         PCAD,
         GEDA_PCB,       ///< Geda PCB file formats.
         GITHUB,         ///< Read only http://github.com repo holding pretty footprints
+        KICAD_SNAPSHOT, ///< S-expression Pcbnew file format with a binary snapshot cache.
 
         // add your type here.
 
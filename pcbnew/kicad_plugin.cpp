@@ -303,7 +303,7 @@ void FP_CACHE::Load()
             // Queue I/O errors so only files that fail to parse don't get loaded.
             try
             {
-                FILE_LINE_READER    reader( fullPath.GetFullPath() );
+                MAPPED_FILE_LINE_READER reader( fullPath.GetFullPath() );
 
                 m_owner->m_parser->SetLineReader( &reader );
 
@@ -792,11 +792,14 @@ void PCB_IO::format( BOARD* aBoard, int aNestLevel ) const
     // Do not save MARKER_PCBs, they can be regenerated easily.
 
     // Save the tracks and vias.
-    for( TRACK* track = aBoard->m_Track;  track; track = track->Next() )
-        Format( track, aNestLevel );
+    if( !( m_ctl & CTL_OMIT_TRACKS ) )
+    {
+        for( TRACK* track = aBoard->m_Track;  track; track = track->Next() )
+            Format( track, aNestLevel );
 
-    if( aBoard->m_Track.GetCount() )
-        m_out->Print( 0, "\n" );
+        if( aBoard->m_Track.GetCount() )
+            m_out->Print( 0, "\n" );
+    }
 
     /// @todo Add warning here that the old segment filed zones are no longer supported and
     ///       will not be saved.
@@ -1127,8 +1130,11 @@ void PCB_IO::format( MODULE* aModule, int aNestLevel ) const
         Format( gr, aNestLevel+1 );
 
     // Save pads.
-    for( D_PAD* pad = aModule->PadsList();  pad;  pad = pad->Next() )
-        format( pad, aNestLevel+1 );
+    if( !( m_ctl & CTL_OMIT_PADS ) )
+    {
+        for( D_PAD* pad = aModule->PadsList();  pad;  pad = pad->Next() )
+            format( pad, aNestLevel+1 );
+    }
 
     // Save 3D info.
     std::list<S3D_INFO>::const_iterator bs3D = aModule->Models().begin();
@@ -1566,6 +1572,9 @@ void PCB_IO::format( TEXTE_MODULE* aText, int aNestLevel ) const
 
 void PCB_IO::format( TRACK* aTrack, int aNestLevel ) const
 {
+    // The tracks are the bulk of the boards: no printf() style formatting
+    FORMAT_BUFFER   out( m_out );
+
     if( aTrack->Type() == PCB_VIA_T )
     {
         PCB_LAYER_ID  layer1, layer2;
@@ -1576,7 +1585,7 @@ void PCB_IO::format( TRACK* aTrack, int aNestLevel ) const
         wxCHECK_RET( board != 0, wxT( "Via " ) + via->GetSelectMenuText() +
                      wxT( " has no parent." ) );
 
-        m_out->Print( aNestLevel, "(via" );
+        out.Indent( aNestLevel ).Text( "(via" );
 
         via->LayerPair( &layer1, &layer2 );
 
@@ -1586,46 +1595,113 @@ void PCB_IO::format( TRACK* aTrack, int aNestLevel ) const
             break;
 
         case VIA_BLIND_BURIED:
-            m_out->Print( 0, " blind" );
+            out.Text( " blind" );
             break;
 
         case VIA_MICROVIA:
-            m_out->Print( 0, " micro" );
+            out.Text( " micro" );
             break;
 
         default:
             THROW_IO_ERROR( wxString::Format( _( "unknown via type %d"  ), via->GetViaType() ) );
         }
 
-        m_out->Print( 0, " (at %s) (size %s)",
-                      FMT_IU( aTrack->GetStart() ).c_str(),
-                      FMT_IU( aTrack->GetWidth() ).c_str() );
+        out.Text( " (at " );
+        BOARD_ITEM::FormatInternalUnits( out, aTrack->GetStart() ).Text( ") (size " );
+        BOARD_ITEM::FormatInternalUnits( out, aTrack->GetWidth() ).Char( ')' );
 
         if( via->GetDrill() != UNDEFINED_DRILL_DIAMETER )
-            m_out->Print( 0, " (drill %s)", FMT_IU( via->GetDrill() ).c_str() );
+        {
+            out.Text( " (drill " );
+            BOARD_ITEM::FormatInternalUnits( out, via->GetDrill() ).Char( ')' );
+        }
 
-        m_out->Print( 0, " (layers %s %s)",
-                      m_out->Quotew( m_board->GetLayerName( layer1 ) ).c_str(),
-                      m_out->Quotew( m_board->GetLayerName( layer2 ) ).c_str() );
+        out.Text( " (layers " ).Quotew( m_board->GetLayerName( layer1 ) ).Char( ' ' )
+           .Quotew( m_board->GetLayerName( layer2 ) ).Char( ')' );
     }
     else
     {
-        m_out->Print( aNestLevel, "(segment (start %s) (end %s) (width %s)",
-                      FMT_IU( aTrack->GetStart() ).c_str(), FMT_IU( aTrack->GetEnd() ).c_str(),
-                      FMT_IU( aTrack->GetWidth() ).c_str() );
+        out.Indent( aNestLevel ).Text( "(segment (start " );
+        BOARD_ITEM::FormatInternalUnits( out, aTrack->GetStart() ).Text( ") (end " );
+        BOARD_ITEM::FormatInternalUnits( out, aTrack->GetEnd() ).Text( ") (width " );
+        BOARD_ITEM::FormatInternalUnits( out, aTrack->GetWidth() ).Char( ')' );
 
-        m_out->Print( 0, " (layer %s)", m_out->Quotew( aTrack->GetLayerName() ).c_str() );
+        out.Text( " (layer " ).Quotew( aTrack->GetLayerName() ).Char( ')' );
     }
 
-    m_out->Print( 0, " (net %d)", m_mapping->Translate( aTrack->GetNetCode() ) );
+    out.Text( " (net " ).Int( m_mapping->Translate( aTrack->GetNetCode() ) ).Char( ')' );
 
     if( aTrack->GetTimeStamp() != 0 )
-        m_out->Print( 0, " (tstamp %lX)", (unsigned long)aTrack->GetTimeStamp() );
+        out.Text( " (tstamp " ).Hex( (unsigned long) aTrack->GetTimeStamp() ).Char( ')' );
 
     if( aTrack->GetStatus() != 0 )
-        m_out->Print( 0, " (status %X)", aTrack->GetStatus() );
+        out.Text( " (status " ).Hex( (unsigned) aTrack->GetStatus() ).Char( ')' );
 
-    m_out->Print( 0, ")\n" );
+    out.Text( ")\n" );
+    out.Flush();
+}
+
+
+/**
+ * Function formatPolygons
+ * writes the contours iterated by @a aIterator as "(polygon (pts (xy X Y) ...))" lists,
+ * using @a aKeyword for "polygon", with five points per line.
+ */
+template<class ITERATOR>
+static void formatPolygons( OUTPUTFORMATTER* aOut, const char* aKeyword, ITERATOR aIterator,
+                            int aNestLevel )
+{
+    FORMAT_BUFFER   out( aOut );
+    int             newLine = 0;
+    bool            new_polygon = true;
+    bool            is_closed = false;
+
+    for( ; aIterator; ++aIterator )
+    {
+        if( new_polygon )
+        {
+            newLine = 0;
+            out.Indent( aNestLevel ).Char( '(' ).Text( aKeyword ).Char( '\n' );
+            out.Indent( aNestLevel+1 ).Text( "(pts\n" );
+            new_polygon = false;
+            is_closed = false;
+        }
+
+        if( newLine == 0 )
+            out.Indent( aNestLevel+2 ).Text( "(xy " );
+        else
+            out.Text( " (xy " );
+
+        BOARD_ITEM::FormatInternalUnits( out, aIterator->x ).Char( ' ' );
+        BOARD_ITEM::FormatInternalUnits( out, aIterator->y ).Char( ')' );
+
+        if( newLine < 4 )
+        {
+            newLine += 1;
+        }
+        else
+        {
+            newLine = 0;
+            out.Char( '\n' );
+        }
+
+        if( aIterator.IsEndContour() )
+        {
+            is_closed = true;
+
+            if( newLine != 0 )
+                out.Char( '\n' );
+
+            out.Indent( aNestLevel+1 ).Text( ")\n" );
+            out.Indent( aNestLevel ).Text( ")\n" );
+            new_polygon = true;
+        }
+    }
+
+    if( !is_closed )    // Should not happen, but...
+        out.Indent( aNestLevel ).Text( ")\n" );
+
+    out.Flush();
 }
 
 
@@ -1744,128 +1820,33 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
 
     m_out->Print( 0, ")\n" );
 
-    int newLine = 0;
-
     if( aZone->GetNumCorners() )
-    {
-        bool new_polygon = true;
-        bool is_closed = false;
-
-        for( auto iterator = aZone->IterateWithHoles(); iterator; iterator++ )
-        {
-            if( new_polygon )
-            {
-                newLine = 0;
-                m_out->Print( aNestLevel+1, "(polygon\n" );
-                m_out->Print( aNestLevel+2, "(pts\n" );
-                new_polygon = false;
-                is_closed = false;
-            }
-
-            if( newLine == 0 )
-                m_out->Print( aNestLevel+3, "(xy %s %s)",
-                              FMT_IU( iterator->x ).c_str(), FMT_IU( iterator->y ).c_str() );
-            else
-                m_out->Print( 0, " (xy %s %s)",
-                              FMT_IU( iterator->x ).c_str(), FMT_IU( iterator->y ).c_str() );
-
-            if( newLine < 4 )
-            {
-                newLine += 1;
-            }
-            else
-            {
-                newLine = 0;
-                m_out->Print( 0, "\n" );
-            }
-
-            if( iterator.IsEndContour() )
-            {
-                is_closed = true;
-
-                if( newLine != 0 )
-                    m_out->Print( 0, "\n" );
-
-                m_out->Print( aNestLevel+2, ")\n" );
-                m_out->Print( aNestLevel+1, ")\n" );
-                new_polygon = true;
-            }
-        }
-
-        if( !is_closed )    // Should not happen, but...
-            m_out->Print( aNestLevel+1, ")\n" );
-
-    }
+        formatPolygons( m_out, "polygon", aZone->IterateWithHoles(), aNestLevel+1 );
 
     // Save the PolysList (filled areas)
     const SHAPE_POLY_SET& fv = aZone->GetFilledPolysList();
-    newLine = 0;
-
-    if( !fv.IsEmpty() )
-    {
-        bool new_polygon = true;
-        bool is_closed = false;
-
-        for( auto it = fv.CIterate(); it; ++it )
-        {
-            if( new_polygon )
-            {
-                newLine = 0;
-                m_out->Print( aNestLevel+1, "(filled_polygon\n" );
-                m_out->Print( aNestLevel+2, "(pts\n" );
-                new_polygon = false;
-                is_closed = false;
-            }
-
-            if( newLine == 0 )
-                m_out->Print( aNestLevel+3, "(xy %s %s)",
-                              FMT_IU( it->x ).c_str(), FMT_IU( it->y ).c_str() );
-            else
-                m_out->Print( 0, " (xy %s %s)",
-                              FMT_IU( it->x ) .c_str(), FMT_IU( it->y ).c_str() );
-
-            if( newLine < 4 )
-            {
-                newLine += 1;
-            }
-            else
-            {
-                newLine = 0;
-                m_out->Print( 0, "\n" );
-            }
 
-            if( it.IsEndContour() )
-            {
-                is_closed = true;
-
-                if( newLine != 0 )
-                    m_out->Print( 0, "\n" );
-
-                m_out->Print( aNestLevel+2, ")\n" );
-                m_out->Print( aNestLevel+1, ")\n" );
-                new_polygon = true;
-            }
-        }
-
-        if( !is_closed )    // Should not happen, but...
-            m_out->Print( aNestLevel+1, ")\n" );
-    }
+    if( !fv.IsEmpty() && !( m_ctl & CTL_OMIT_FILLS ) )
+        formatPolygons( m_out, "filled_polygon", fv.CIterate(), aNestLevel+1 );
 
     // Save the filling segments list
     const std::vector< SEGMENT >& segs = aZone->FillSegments();
 
-    if( segs.size() )
+    if( segs.size() && !( m_ctl & CTL_OMIT_FILLS ) )
     {
-        m_out->Print( aNestLevel+1, "(fill_segments\n" );
+        FORMAT_BUFFER out( m_out );
+
+        out.Indent( aNestLevel+1 ).Text( "(fill_segments\n" );
 
         for( std::vector< SEGMENT >::const_iterator it = segs.begin();  it != segs.end();  ++it )
         {
-            m_out->Print( aNestLevel+2, "(pts (xy %s) (xy %s))\n",
-                          FMT_IU( it->m_Start ).c_str(),
-                          FMT_IU( it->m_End ).c_str() );
+            out.Indent( aNestLevel+2 ).Text( "(pts (xy " );
+            BOARD_ITEM::FormatInternalUnits( out, it->m_Start ).Text( ") (xy " );
+            BOARD_ITEM::FormatInternalUnits( out, it->m_End ).Text( "))\n" );
         }
 
-        m_out->Print( aNestLevel+1, ")\n" );
+        out.Indent( aNestLevel+1 ).Text( ")\n" );
+        out.Flush();
     }
 
     m_out->Print( aNestLevel, ")\n" );
@@ -1893,11 +1874,23 @@ PCB_IO::~PCB_IO()
 
 BOARD* PCB_IO::Load( const wxString& aFileName, BOARD* aAppendToMe, const PROPERTIES* aProperties )
 {
-    FILE_LINE_READER    reader( aFileName );
+    MAPPED_FILE_LINE_READER reader( aFileName );
 
     init( aProperties );
 
-    m_parser->SetLineReader( &reader );
+    BOARD* board = loadBoard( &reader, aAppendToMe );
+
+    // Give the filename to the board if it's new
+    if( !aAppendToMe )
+        board->SetFileName( aFileName );
+
+    return board;
+}
+
+
+BOARD* PCB_IO::loadBoard( LINE_READER* aReader, BOARD* aAppendToMe )
+{
+    m_parser->SetLineReader( aReader );
     m_parser->SetBoard( aAppendToMe );
 
     BOARD* board;
@@ -1927,10 +1920,6 @@ BOARD* PCB_IO::Load( const wxString& aFileName, BOARD* aAppendToMe, const PROPER
                 m_parser->CurLineNumber(), m_parser->CurOffset() );
     }
 
-    // Give the filename to the board if it's new
-    if( !aAppendToMe )
-        board->SetFileName( aFileName );
-
     return board;
 }
 
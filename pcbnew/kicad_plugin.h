@@ -54,6 +54,9 @@ class NETINFO_MAPPING;
 #define CTL_OMIT_AT                 (1 << 5)    ///< Omit position and rotation
                                                 // (always saved with potion 0,0 and rotation = 0 in library)
 //#define CTL_OMIT_HIDE             (1 << 6)    // found and defined in eda_text.h
+#define CTL_OMIT_TRACKS             (1 << 7)    ///< Omit the tracks and vias of the board
+#define CTL_OMIT_PADS               (1 << 8)    ///< Omit the pads of the modules
+#define CTL_OMIT_FILLS              (1 << 9)    ///< Omit the filled areas of the zones
 
 
 // common combinations of the above:
@@ -68,6 +71,10 @@ class NETINFO_MAPPING;
 /// a BOARD file underneath IO_MGR.
 #define CTL_FOR_BOARD               (CTL_OMIT_INITIAL_COMMENTS)
 
+/// Format the text of a board snapshot, which holds the omitted items apart.
+/// See SNAPSHOT_PLUGIN.
+#define CTL_FOR_SNAPSHOT            (CTL_FOR_BOARD|CTL_OMIT_TRACKS|CTL_OMIT_PADS|CTL_OMIT_FILLS)
+
 
 class DIMENSION;
 class EDGE_MODULE;
@@ -188,6 +195,9 @@ protected:
 
     void init( const PROPERTIES* aProperties );
 
+    /// parses the board read by aReader, see Load()
+    BOARD* loadBoard( LINE_READER* aReader, BOARD* aAppendToMe );
+
     /// formats the board setup information
     void formatSetup( BOARD* aBoard, int aNestLevel = 0 ) const;
 
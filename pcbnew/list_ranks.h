@@ -0,0 +1,211 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef LIST_RANKS_H
+#define LIST_RANKS_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+
+/**
+ * Class LIST_RANKS
+ *
+ * Ranks the items of a board list (a DLIST of modules or tracks) so that comparing their
+ * ranks tells which one comes first in the list, without numbering the list again when
+ * items are inserted: new items take ranks between the ones of their neighbours.
+ * When there is no room left between them, the ranks of a window of items around the
+ * new ones are spread out again; the window grows until its neighbours leave more room
+ * than it has items, so the cost of an insertion stays low whatever the insertion order.
+ *
+ * Only the ranked items are looked at: the list may hold other items, they are skipped.
+ */
+template <class T>
+class LIST_RANKS
+{
+public:
+    void Clear()
+    {
+        m_ranks.clear();
+    }
+
+    /**
+     * Function Number
+     * ranks all the items of the list beginning with aFirst, in place of the current ranks.
+     */
+    void Number( T* aFirst )
+    {
+        uint64_t rank = 0;
+
+        m_ranks.clear();
+
+        for( T* item = aFirst; item; item = item->Next() )
+        {
+            rank += STEP;
+            m_ranks[item] = rank;
+        }
+    }
+
+    /**
+     * Function Insert
+     * ranks aItem, already linked in its list, between the ranked items around it.
+     */
+    void Insert( T* aItem )
+    {
+        m_ranks[aItem] = 0;
+        spread( aItem, aItem, 1 );
+    }
+
+    /**
+     * Function Insert
+     * ranks the items of aItems, already linked in their list. The items of a run of new
+     * items are ranked together, between the ranked items around the run.
+     */
+    void Insert( const std::vector<T*>& aItems )
+    {
+        std::unordered_set<const T*> pending( aItems.begin(), aItems.end() );
+
+        for( T* item : aItems )
+        {
+            if( !pending.count( item ) )
+                continue;
+
+            T* first = item;
+            T* last = item;
+            uint64_t count = 1;
+
+            for( ; first->Back() && pending.count( first->Back() ); ++count )
+                first = first->Back();
+
+            for( ; last->Next() && pending.count( last->Next() ); ++count )
+                last = last->Next();
+
+            for( T* runItem = first; runItem != last->Next(); runItem = runItem->Next() )
+            {
+                pending.erase( runItem );
+                m_ranks[runItem] = 0;
+            }
+
+            spread( first, last, count );
+        }
+    }
+
+    void Remove( const T* aItem )
+    {
+        m_ranks.erase( aItem );
+    }
+
+    bool Contains( const T* aItem ) const
+    {
+        return m_ranks.count( aItem ) > 0;
+    }
+
+    uint64_t Rank( const T* aItem ) const
+    {
+        return m_ranks.at( aItem );
+    }
+
+private:
+    // The ranks of a numbered list, and of the items appended to it, are spaced by STEP.
+    // All the ranks stay below MAX_RANK.
+    static constexpr uint64_t STEP = (uint64_t) 1 << 32;
+    static constexpr uint64_t MAX_RANK = (uint64_t) 1 << 62;
+
+    T* previousRanked( T* aItem ) const
+    {
+        T* item = aItem->Back();
+
+        while( item && !Contains( item ) )
+            item = item->Back();
+
+        return item;
+    }
+
+    T* nextRanked( T* aItem ) const
+    {
+        T* item = aItem->Next();
+
+        while( item && !Contains( item ) )
+            item = item->Next();
+
+        return item;
+    }
+
+    /// Ranks the count items from aFirst to aLast evenly between their ranked neighbours,
+    /// taking more items around them until there is enough room
+    void spread( T* aFirst, T* aLast, uint64_t aCount )
+    {
+        T* previous = previousRanked( aFirst );
+        T* next = nextRanked( aLast );
+
+        for( uint64_t span = 1; ; span *= 2 )
+        {
+            uint64_t low = previous ? m_ranks[previous] : 0;
+            uint64_t high = MAX_RANK;
+
+            // Items appended to the list are spaced as the items of a numbered list
+            if( next )
+                high = m_ranks[next];
+            else if( MAX_RANK - low > STEP * ( aCount + 1 ) )
+                high = low + STEP * ( aCount + 1 );
+
+            uint64_t gap = ( high - low ) / ( aCount + 1 );
+
+            if( gap > aCount )
+            {
+                uint64_t rank = low;
+
+                for( T* item = aFirst; item != aLast->Next(); item = item->Next() )
+                {
+                    auto it = m_ranks.find( item );
+
+                    if( it != m_ranks.end() )
+                    {
+                        rank += gap;
+                        it->second = rank;
+                    }
+                }
+
+                return;
+            }
+
+            for( uint64_t ii = 0; ii < span && previous; ++ii, ++aCount )
+            {
+                aFirst = previous;
+                previous = previousRanked( previous );
+            }
+
+            for( uint64_t ii = 0; ii < span && next; ++ii, ++aCount )
+            {
+                aLast = next;
+                next = nextRanked( next );
+            }
+        }
+    }
+
+    std::unordered_map<const T*, uint64_t> m_ranks;
+};
+
+#endif  // LIST_RANKS_H
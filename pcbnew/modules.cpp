@@ -324,6 +324,7 @@ void PCB_EDIT_FRAME::Change_Side_Module( MODULE* Module, wxDC* DC )
     /* Flip the module */
     Module->Flip( Module->GetPosition() );
     m_Pcb->GetConnectivity()->Update( Module );
+    m_Pcb->UpdateItemIndex( Module );
     SetMsgPanel( Module );
 
     if( !Module->IsMoving() ) /* Inversion simple */
@@ -346,6 +347,7 @@ void PCB_EDIT_FRAME::Change_Side_Module( MODULE* Module, wxDC* DC )
 
     }
     m_Pcb->GetConnectivity()->Update( Module );
+    m_Pcb->UpdateItemIndex( Module );
 }
 
 
@@ -412,6 +414,7 @@ void PCB_BASE_FRAME::PlaceModule( MODULE* aModule, wxDC* aDC, bool aDoNotRecreat
     m_canvas->SetMouseCapture( NULL, NULL );
 
     m_Pcb->GetConnectivity()->Update( aModule );
+    m_Pcb->UpdateItemIndex( aModule );
 
     if( GetBoard()->IsElementVisible( LAYER_RATSNEST ) && !aDoNotRecreateRatsnest )
         Compile_Ratsnest( aDC, true );
@@ -467,6 +470,7 @@ void PCB_BASE_FRAME::Rotate_Module( wxDC* DC, MODULE* module, double angle, bool
 
     SetMsgPanel( module );
     m_Pcb->GetConnectivity()->Update( module );
+    m_Pcb->UpdateItemIndex( module );
 
     if( DC )
     {
@@ -472,7 +472,11 @@ void FOOTPRINT_VIEWER_FRAME::ClickOnFootprintList( wxCommandEvent& event )
         SetCurItem( NULL );
 
         // Delete the current footprint
-        GetBoard()->m_Modules.DeleteAll();
+        while( MODULE* module = GetBoard()->m_Modules )
+        {
+            GetBoard()->Remove( module );
+            delete module;
+        }
 
         LIB_ID id;
         id.SetLibNickname( getCurNickname() );
@@ -847,7 +851,11 @@ void FOOTPRINT_VIEWER_FRAME::SelectAndViewFootprint( int aMode )
         SetCurItem( NULL );
 
         // Delete the current footprint
-        GetBoard()->m_Modules.DeleteAll();
+        while( MODULE* module = GetBoard()->m_Modules )
+        {
+            GetBoard()->Remove( module );
+            delete module;
+        }
 
         MODULE* footprint = Prj().PcbFootprintLibs()->FootprintLoad(
                                 getCurNickname(), getCurFootprintName() );
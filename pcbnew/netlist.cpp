@@ -47,6 +47,7 @@ using namespace std::placeholders;
 #include <class_board.h>
 #include <class_module.h>
 #include <ratsnest_data.h>
+#include <zone_obstacle_cache.h>
 #include <pcbnew.h>
 #include <io_mgr.h>
 
@@ -126,6 +127,9 @@ void PCB_EDIT_FRAME::ReadPcbNetlist( const wxString& aNetlistFileName,
     if( netlist.IsDryRun() )
         return;
 
+    // The board was changed outside of a commit: the next zone refill is a full one
+    board->GetZoneObstacleCache()->ResetDirtyAreas();
+
     if( IsGalCanvasActive() )
     {
         SpreadFootprints( &newFootprints, false, false, GetCrossHairPosition() );
@@ -151,6 +155,10 @@ void PCB_EDIT_FRAME::ReadPcbNetlist( const wxString& aNetlistFileName,
         SpreadFootprints( &newFootprints, false, false, placementAreaPosition );
     }
 
+    // The footprints were spread outside of a commit
+    for( MODULE* footprint : newFootprints )
+        board->UpdateItemIndex( footprint );
+
     OnModify();
 
     SetCurItem( NULL );
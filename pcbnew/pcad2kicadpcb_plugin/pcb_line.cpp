@@ -138,7 +138,6 @@ void PCB_LINE::AddToBoard()
     if( IsCopperLayer( m_KiCadLayer ) )
     {
         TRACK* track = new TRACK( m_board );
-        m_board->m_Track.Append( track );
 
         track->SetTimeStamp( m_timestamp );
 
@@ -149,6 +148,8 @@ void PCB_LINE::AddToBoard()
 
         track->SetLayer( m_KiCadLayer );
         track->SetNetCode( m_netCode );
+
+        m_board->Add( track, ADD_APPEND );
     }
     else
     {
@@ -331,7 +331,6 @@ void PCB_PAD::AddToBoard()
         if( IsCopperLayer( m_KiCadLayer ) )
         {
             VIA* via = new VIA( m_board );
-            m_board->m_Track.Append( via );
 
             via->SetTimeStamp( 0 );
 
@@ -345,6 +344,8 @@ void PCB_PAD::AddToBoard()
 
             via->SetLayer( m_KiCadLayer );
             via->SetNetCode( m_netCode );
+
+            m_board->Add( via, ADD_APPEND );
         }
     }
     else // pad
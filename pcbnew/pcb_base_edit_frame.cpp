@@ -27,6 +27,7 @@
 #include <pcb_draw_panel_gal.h>
 #include <gal/graphics_abstraction_layer.h>
 #include <class_board.h>
+#include <zone_obstacle_cache.h>
 #include <view/view.h>
 
 
@@ -48,6 +49,11 @@ void PCB_BASE_EDIT_FRAME::UseGalCanvas( bool aEnable )
         UndoRedoBlock( false );
     else
         static_cast<PCB_DRAW_PANEL_GAL*>( GetGalCanvas() )->SyncLayersVisibility( m_Pcb );
+
+    // The legacy canvas edits the board outside of the commits: the zone fills cannot be
+    // updated from the recorded changes any more
+    if( m_Pcb )
+        m_Pcb->GetZoneObstacleCache()->ResetDirtyAreas();
 }
 
 
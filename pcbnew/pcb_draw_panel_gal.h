@@ -102,6 +102,12 @@ public:
     ///> Forces refresh of the ratsnest visual representation
     void RedrawRatsnest();
 
+    ///> Returns the ratsnest view item
+    KIGFX::RATSNEST_VIEWITEM* GetRatsnestItem() const
+    {
+        return m_ratsnest.get();
+    }
+
 protected:
     ///> Reassigns layer order to the initial settings.
     void setDefaultLayerOrder();
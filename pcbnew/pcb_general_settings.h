@@ -63,6 +63,11 @@ public:
 
     bool    m_editActionChangesTrackWidth = false;
 
+    bool    m_liveDrc = false;                      // True to test the clearances of the edited
+                                                    // items after each change
+    bool    m_autoRefillZones = false;              // True to refill the filled zones around
+                                                    // the edited items after each change
+
     MAGNETIC_PAD_OPTION_VALUES  m_magneticPads  = CAPTURE_CURSOR_IN_TRACK_TOOL;
     MAGNETIC_PAD_OPTION_VALUES  m_magneticTracks = CAPTURE_CURSOR_IN_TRACK_TOOL;
 };
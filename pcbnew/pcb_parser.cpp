@@ -32,6 +32,7 @@
 #include <confirm.h>
 #include <macros.h>
 #include <trigo.h>
+#include <kicad_string.h>
 #include <class_title_block.h>
 
 #include <class_board.h>
@@ -48,15 +49,22 @@
 #include <pcb_plot_params_parser.h>
 #include <pcb_plot_params.h>
 #include <zones.h>
+#include <thread_pool.h>
 #include <pcb_parser.h>
 
 using namespace PCB_KEYS_T;
 
 
+/// The board sections parsed in parallel are shared out in tasks of about this many bytes
+static const size_t SectionTaskSize = 64 * 1024;
+
+
 void PCB_PARSER::init()
 {
     m_tooRecent = false;
     m_requiredVersion = 0;
+    m_readOnlyBoard = false;
+    m_netSkipped = false;
     m_layerIndices.clear();
     m_layerMasks.clear();
 
@@ -123,11 +131,12 @@ void PCB_PARSER::pushValueIntoMap( int aIndex, int aValue )
 
 double PCB_PARSER::parseDouble()
 {
-    char* tmp;
+    const char* tmp;
 
     errno = 0;
 
-    double fval = strtod( CurText(), &tmp );
+    // Not strtod(), which is slowed down by the locale
+    double fval = ParseDecimal( CurText(), &tmp );
 
     if( errno )
     {
@@ -461,6 +470,12 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
 {
     T token;
 
+    // The modules, tracks, vias and zones of a board read in place are skipped here, and
+    // parsed in parallel once the nets and layers are known.
+    MEMORY_LINE_READER* memReader = m_parallel ? dynamic_cast<MEMORY_LINE_READER*>( reader )
+                                               : NULL;
+    std::vector<BOARD_SECTION> sections;
+
     parseHeader();
 
     for( token = NextTok();  token != T_RIGHT;  token = NextTok() )
@@ -468,8 +483,49 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
         if( token != T_LEFT )
             Expecting( T_LEFT );
 
+        // Where the section starts, in the text read in place
+        const char* line = start;
+        const char* left = start + CurOffset();
+        unsigned    lineNumber = CurLineNumber();
+
         token = NextTok();
 
+        if( memReader && ( token == T_module || token == T_segment || token == T_via
+                           || token == T_zone ) )
+        {
+            BOARD_SECTION section;
+
+            section.m_line = line;
+            section.m_start = left;
+            section.m_lineNumber = lineNumber;
+
+            if( !skipSection( memReader ) )
+            {
+                // The section is not closed: its parse reports the error, after the errors
+                // of the sections before it.
+                try
+                {
+                    section.m_item.reset( parseSection( memReader, section ) );
+                }
+                catch( ... )
+                {
+                    parseBoardSections( memReader, sections );
+                    throw;
+                }
+            }
+
+            sections.push_back( std::move( section ) );
+            continue;
+        }
+
+        // The sections the items depend on come first in the files.  When they do not,
+        // the items before them are parsed without them, as in a serial parse.
+        if( !sections.empty() && ( token == T_general || token == T_layers || token == T_setup
+                                   || token == T_net || token == T_net_class ) )
+        {
+            parseBoardSections( memReader, sections );
+        }
+
         switch( token )
         {
         case T_general:
@@ -543,10 +599,237 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
         }
     }
 
+    parseBoardSections( memReader, sections );
+
     return m_board;
 }
 
 
+/// The separators of the tokens, as seen by DSNLEXER
+static inline bool isSeparator( char cc )
+{
+    switch( cc )
+    {
+    case ' ':
+    case '\n':
+    case '\r':
+    case '\t':
+    case '\0':
+    case '(':
+    case ')':
+        return true;
+    }
+
+    return false;
+}
+
+
+void PCB_PARSER::moveTo( MEMORY_LINE_READER* aReader, const char* aLine, const char* aPos,
+                         unsigned aLineNumber )
+{
+    const char* text = aReader->Text();
+    const char* end  = text + aReader->Size();
+    const char* eol  = (const char*) memchr( aPos, '\n', end - aPos );
+
+    start = aLine;
+    next  = aPos;
+    limit = eol ? eol + 1 : end;
+
+    // the next line read is the one after aLine
+    aReader->Seek( limit - text, aLineNumber + 1 );
+}
+
+
+bool PCB_PARSER::skipSection( MEMORY_LINE_READER* aReader )
+{
+    const char* end = aReader->Text() + aReader->Size();
+    const char* cur = next;
+    const char* line = start;
+    unsigned    lineNumber = CurLineNumber();
+    bool        lineStart = false;
+    int         depth = 1;
+
+    // Read as NextTok() does: the parentheses of the quoted strings and of the comment
+    // lines do not count, and quoted strings end on their line.
+    while( cur < end )
+    {
+        char cc = *cur;
+
+        if( cc == '\n' )
+        {
+            line = ++cur;
+            ++lineNumber;
+            lineStart = true;
+        }
+        else if( isSeparator( cc ) && cc != '(' && cc != ')' )
+        {
+            ++cur;
+        }
+        else if( cc == '#' && lineStart )
+        {
+            // a comment line
+            const char* eol = (const char*) memchr( cur, '\n', end - cur );
+
+            cur = eol ? eol : end;
+        }
+        else if( cc == '(' )
+        {
+            lineStart = false;
+            ++depth;
+            ++cur;
+        }
+        else if( cc == ')' )
+        {
+            lineStart = false;
+            ++cur;
+
+            if( --depth == 0 )
+            {
+                moveTo( aReader, line, cur, lineNumber );
+                return true;
+            }
+        }
+        else if( cc == '"' )
+        {
+            lineStart = false;
+
+            for( ++cur;  cur < end && *cur != '"';  ++cur )
+            {
+                // an escaped character, which cannot be the end of the line
+                if( *cur == '\\' )
+                    ++cur;
+
+                if( cur >= end || *cur == '\n' )
+                    return false;
+            }
+
+            if( cur >= end )
+                return false;
+
+            ++cur;      // the closing quote
+        }
+        else
+        {
+            lineStart = false;
+
+            while( cur < end && !isSeparator( *cur ) )
+                ++cur;
+        }
+    }
+
+    return false;
+}
+
+
+BOARD_ITEM* PCB_PARSER::parseSection( MEMORY_LINE_READER* aReader,
+                                      const BOARD_SECTION& aSection )
+{
+    moveTo( aReader, aSection.m_line, aSection.m_start, aSection.m_lineNumber );
+
+    NeedLEFT();
+
+    switch( NextTok() )
+    {
+    case T_module:
+        return parseMODULE();
+
+    case T_segment:
+        return parseTRACK();
+
+    case T_via:
+        return parseVIA();
+
+    case T_zone:
+        return parseZONE_CONTAINER();
+
+    default:
+        Expecting( "module, segment, via or zone" );
+    }
+
+    return NULL;
+}
+
+
+void PCB_PARSER::parseBoardSections( MEMORY_LINE_READER* aReader,
+                                     std::vector<BOARD_SECTION>& aSections )
+{
+    if( aSections.empty() )
+        return;
+
+    std::vector<size_t> taskStart( 1, 0 );
+
+    for( size_t i = 1; i < aSections.size(); ++i )
+    {
+        if( size_t( aSections[i].m_start - aSections[taskStart.back()].m_start )
+                >= SectionTaskSize )
+            taskStart.push_back( i );
+    }
+
+    taskStart.push_back( aSections.size() );
+
+    // Each task has its own parser and reader, sharing the board only to look up its nets
+    THREAD_POOL::GetInstance().ParallelFor( taskStart.size() - 1, [&]( size_t aTask )
+    {
+        MEMORY_LINE_READER textReader( aReader->Text(), aReader->Size(),
+                                       aReader->GetSource() );
+        PCB_PARSER parser( &textReader );
+
+        parser.m_board = m_board;
+        parser.m_layerIndices = m_layerIndices;
+        parser.m_layerMasks = m_layerMasks;
+        parser.m_netCodes = m_netCodes;
+        parser.m_tooRecent = m_tooRecent;
+        parser.m_requiredVersion = m_requiredVersion;
+        parser.m_readOnlyBoard = true;
+
+        for( size_t i = taskStart[aTask]; i < taskStart[aTask + 1]; ++i )
+        {
+            BOARD_SECTION& section = aSections[i];
+
+            if( section.m_item )
+                continue;
+
+            try
+            {
+                section.m_item.reset( parser.parseSection( &textReader, section ) );
+
+                // The zone adding a net is parsed again below
+                if( parser.m_netSkipped )
+                {
+                    section.m_item.reset();
+                    parser.m_netSkipped = false;
+                }
+            }
+            catch( ... )
+            {
+                section.m_error = std::current_exception();
+            }
+        }
+    } );
+
+    // The zones adding nets are parsed again here, after which the lexing goes on where it was
+    const char* line = start;
+    const char* pos = next;
+    unsigned    lineNumber = CurLineNumber();
+
+    // The items are added in the order of the file, as a serial parse would have,
+    // and the first error in that order is the one reported.
+    for( BOARD_SECTION& section : aSections )
+    {
+        if( section.m_error )
+            std::rethrow_exception( section.m_error );
+
+        if( !section.m_item )
+            section.m_item.reset( parseSection( aReader, section ) );
+
+        m_board->Add( section.m_item.release(), ADD_APPEND );
+    }
+
+    aSections.clear();
+    moveTo( aReader, line, pos, lineNumber );
+}
+
+
 void PCB_PARSER::parseHeader()
 {
     wxCHECK_RET( CurTok() == T_kicad_pcb,
@@ -3118,6 +3401,11 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER()
 
         if( net )   // An existing net has the same net name. use it for the zone
             zone->SetNetCode( net->GetNet() );
+        else if( m_readOnlyBoard )
+        {
+            // Parsed again once the board can be changed, see parseBoardSections()
+            m_netSkipped = true;
+        }
         else    // Not existing net: add a new net to keep trace of the zone netname
         {
             int newnetcode = m_board->GetNetCount();
@@ -40,6 +40,10 @@
 #include <boost/unordered_map.hpp>
 #include <boost/unordered_set.hpp>
 
+#include <exception>
+#include <memory>
+#include <vector>
+
 
 class BOARD;
 class BOARD_ITEM;
@@ -55,6 +59,7 @@ class MODULE;
 class PCB_TARGET;
 class VIA;
 class ZONE_CONTAINER;
+class MEMORY_LINE_READER;
 struct LAYER;
 
 
@@ -74,6 +79,21 @@ class PCB_PARSER : public PCB_LEXER
     std::vector<int>    m_netCodes;         ///< net codes mapping for boards being loaded
     bool                m_tooRecent;        ///< true if version parses as later than supported
     int                 m_requiredVersion;  ///< set to the KiCad format version this board requires
+    bool                m_parallel;         ///< parse the board sections in parallel if possible
+    bool                m_readOnlyBoard;    ///< true in the parsers of the sections parsed
+                                            ///< in parallel, which cannot add nets to the board
+    bool                m_netSkipped;       ///< a net was not added to the read only board
+
+    /// A module, track, via or zone of a board read in place, parsed once the other
+    /// top level sections are read, see parseBoardSections()
+    struct BOARD_SECTION
+    {
+        const char*                 m_line;         ///< the line of its left parenthesis
+        const char*                 m_start;        ///< its left parenthesis
+        unsigned                    m_lineNumber;   ///< the number of m_line
+        std::unique_ptr<BOARD_ITEM> m_item;         ///< the item, once parsed
+        std::exception_ptr          m_error;        ///< the error of its parse, if any
+    };
 
     ///> Converts net code using the mapping table if available,
     ///> otherwise returns unchanged net code if < 0 or if is is out of range
@@ -140,6 +160,35 @@ class PCB_PARSER : public PCB_LEXER
      */
     BOARD*          parseBOARD_unchecked();
 
+    /**
+     * Function moveTo
+     * goes on lexing the text of @a aReader at @a aPos, in the line starting at @a aLine
+     * numbered @a aLineNumber.
+     */
+    void moveTo( MEMORY_LINE_READER* aReader, const char* aLine, const char* aPos,
+                 unsigned aLineNumber );
+
+    /**
+     * Function skipSection
+     * skips the rest of the current top level section of the board, without parsing it.
+     * @return false if the section could not be skipped, because it is not properly closed.
+     */
+    bool skipSection( MEMORY_LINE_READER* aReader );
+
+    /**
+     * Function parseSection
+     * parses the module, track, via or zone of @a aSection, read in place from @a aReader.
+     */
+    BOARD_ITEM* parseSection( MEMORY_LINE_READER* aReader, const BOARD_SECTION& aSection );
+
+    /**
+     * Function parseBoardSections
+     * parses the sections of @a aSections not parsed yet, concurrently, and adds all of
+     * them to the board in their order.  The nets and layers must be known.
+     */
+    void parseBoardSections( MEMORY_LINE_READER* aReader,
+                             std::vector<BOARD_SECTION>& aSections );
+
 
     /**
      * Function lookUpLayer
@@ -274,7 +323,8 @@ public:
 
     PCB_PARSER( LINE_READER* aReader = NULL ) :
         PCB_LEXER( aReader ),
-        m_board( 0 )
+        m_board( 0 ),
+        m_parallel( true )
     {
         init();
     }
@@ -300,6 +350,17 @@ public:
         m_board = aBoard;
     }
 
+    /**
+     * Function SetParallel
+     * enables or disables the parse of the modules, tracks, vias and zones of a board
+     * in parallel, which is done when the board is read from a MEMORY_LINE_READER.
+     * The board is the same either way.
+     */
+    void SetParallel( bool aParallel )
+    {
+        m_parallel = aParallel;
+    }
+
     BOARD_ITEM* Parse();
     /**
      * Function parseMODULE
@@ -335,6 +335,7 @@ PCB_EDIT_FRAME::PCB_EDIT_FRAME( KIWAY* aKiway, wxWindow* aParent ) :
     m_hotkeysDescrList = g_Board_Editor_Hokeys_Descr;
     m_hasAutoSave = true;
     m_microWaveToolBar = NULL;
+    m_drc = NULL;
 
     m_rotationAngle = 900;
 
@@ -502,6 +503,10 @@ PCB_EDIT_FRAME::~PCB_EDIT_FRAME()
 
 void PCB_EDIT_FRAME::SetBoard( BOARD* aBoard )
 {
+    // The live DRC markers belong to the old board
+    if( m_drc )
+        m_drc->ResetLiveDrc();
+
     PCB_BASE_EDIT_FRAME::SetBoard( aBoard );
 
     if( IsGalCanvasActive() )
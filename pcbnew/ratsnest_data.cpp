@@ -45,6 +45,7 @@ using namespace std::placeholders;
 #include <limits>
 
 #include <connectivity_algo.h>
+#include <disjoint_set.h>
 
 static uint64_t getDistance( const CN_ANCHOR_PTR& aNode1, const CN_ANCHOR_PTR& aNode2 )
 {
@@ -61,97 +62,66 @@ static bool sortWeight( const CN_EDGE& aEdge1, const CN_EDGE& aEdge2 )
 }
 
 
-static const std::vector<CN_EDGE> kruskalMST( std::list<CN_EDGE>& aEdges,
+static const std::vector<CN_EDGE> kruskalMST( std::vector<CN_EDGE>& aEdges,
         std::vector<CN_ANCHOR_PTR>& aNodes )
 {
     unsigned int    nodeNumber = aNodes.size();
     unsigned int    mstExpectedSize = nodeNumber - 1;
-    unsigned int    mstSize = 0;
+    unsigned int    mergeCount = 0;
     bool ratsnestLines = false;
 
-    //printf("mst nodes : %d edges : %d\n", aNodes.size(), aEdges.size () );
     // The output
     std::vector<CN_EDGE> mst;
 
-    // Set tags for marking cycles
-    std::unordered_map<CN_ANCHOR_PTR, int> tags;
-    unsigned int tag = 0;
-
-    for( auto& node : aNodes )
-    {
-        node->SetTag( tag );
-        tags[node] = tag++;
-    }
+    // The tag of a node is its index, until it is set to the subtree of its connected nodes
+    for( unsigned int i = 0; i < nodeNumber; ++i )
+        aNodes[i]->SetTag( i );
 
-    // Lists of nodes connected together (subtrees) to detect cycles in the graph
-    std::vector<std::list<int> > cycles( nodeNumber );
+    // Subtrees of nodes connected together, to detect cycles in the graph
+    DISJOINT_SET subtrees( nodeNumber );
 
-    for( unsigned int i = 0; i < nodeNumber; ++i )
-        cycles[i].push_back( i );
+    // Tags the nodes connected by the board items with their subtree
+    auto tagConnectedNodes = [&aNodes, &subtrees, nodeNumber] ()
+    {
+        for( unsigned int i = 0; i < nodeNumber; ++i )
+            aNodes[i]->SetTag( subtrees.Find( i ) );
+    };
 
     // Kruskal algorithm requires edges to be sorted by their weight
-    aEdges.sort( sortWeight );
+    std::stable_sort( aEdges.begin(), aEdges.end(), sortWeight );
 
-    while( mstSize < mstExpectedSize && !aEdges.empty() )
+    for( const auto& dt : aEdges )
     {
-        //printf("mstSize %d %d\n", mstSize, mstExpectedSize);
-        auto& dt = aEdges.front();
-
-        int srcTag  = tags[dt.GetSourceNode()];
-        int trgTag  = tags[dt.GetTargetNode()];
+        if( mergeCount >= mstExpectedSize )
+            break;
 
-        // Check if by adding this edge we are going to join two different forests
-        if( srcTag != trgTag )
+        // Because edges are sorted by their weight, first we always process connected
+        // items (weight == 0). Once we stumble upon an edge with non-zero weight,
+        // it means that the rest of the lines are ratsnest.
+        if( !ratsnestLines && dt.GetWeight() != 0 )
         {
-            // Because edges are sorted by their weight, first we always process connected
-            // items (weight == 0). Once we stumble upon an edge with non-zero weight,
-            // it means that the rest of the lines are ratsnest.
-            if( !ratsnestLines && dt.GetWeight() != 0 )
-                ratsnestLines = true;
-
-            // Update tags
-            if( ratsnestLines )
-            {
-                for( auto it = cycles[trgTag].begin(); it != cycles[trgTag].end(); ++it )
-                {
-                    tags[aNodes[*it]] = srcTag;
-                }
-
-                // Do a copy of edge, but make it RN_EDGE_MST. In contrary to RN_EDGE,
-                // RN_EDGE_MST saves both source and target node and does not require any other
-                // edges to exist for getting source/target nodes
-                CN_EDGE newEdge ( dt.GetSourceNode(), dt.GetTargetNode(), dt.GetWeight() );
-
-                assert( newEdge.GetSourceNode()->GetTag() != newEdge.GetTargetNode()->GetTag() );
-                assert( newEdge.GetWeight() > 0 );
+            ratsnestLines = true;
+            tagConnectedNodes();
+        }
 
-                mst.push_back( newEdge );
-                ++mstSize;
-            }
-            else
-            {
-                // for( it = cycles[trgTag].begin(), itEnd = cycles[trgTag].end(); it != itEnd; ++it )
-                // for( auto it : cycles[trgTag] )
-                for( auto it = cycles[trgTag].begin(); it != cycles[trgTag].end(); ++it )
-                {
-                    tags[aNodes[*it]] = srcTag;
-                    aNodes[*it]->SetTag( srcTag );
-                }
+        // Check if by adding this edge we are going to join two different forests
+        // (a tag is always an element of the subtree of its node)
+        if( !subtrees.Union( dt.GetSourceNode()->GetTag(), dt.GetTargetNode()->GetTag() ) )
+            continue;
 
-                // Processing a connection, decrease the expected size of the ratsnest MST
-                --mstExpectedSize;
-            }
+        if( ratsnestLines )
+        {
+            assert( dt.GetSourceNode()->GetTag() != dt.GetTargetNode()->GetTag() );
+            assert( dt.GetWeight() > 0 );
 
-            // Move nodes that were marked with old tag to the list marked with the new tag
-            cycles[srcTag].splice( cycles[srcTag].end(), cycles[trgTag] );
+            mst.emplace_back( dt.GetSourceNode(), dt.GetTargetNode(), dt.GetWeight() );
         }
 
-        // Remove the edge that was just processed
-        aEdges.erase( aEdges.begin() );
+        ++mergeCount;
     }
 
-    // Probably we have discarded some of edges, so reduce the size
-    mst.resize( mstSize );
+    if( !ratsnestLines )
+        tagConnectedNodes();
 
     return mst;
 }
@@ -241,9 +211,9 @@ public:
         m_allNodes.push_back( aNode );
     }
 
-    const std::list<CN_EDGE> Triangulate()
+    const std::vector<CN_EDGE> Triangulate()
     {
-        std::list<CN_EDGE> mstEdges;
+        std::vector<CN_EDGE> mstEdges;
         std::list<hed::EDGE_PTR> triangEdges;
         std::vector<hed::NODE_PTR> triNodes;
 
@@ -267,7 +237,7 @@ public:
         }
                 );
 
-        CN_ANCHOR_PTR prev, last;
+        CN_ANCHOR_PTR prev = nullptr;
         int id = 0;
 
         for( auto n : m_allNodes )
@@ -305,11 +275,18 @@ public:
         {
             return mstEdges;
         }
-        else if( triNodes.size() == 2 )
+        else if( triNodes.size() <= 3 )
         {
-            auto src = m_allNodes[ triNodes[0]->Id() ];
-            auto dst = m_allNodes[ triNodes[1]->Id() ];
-            mstEdges.emplace_back( src, dst, getDistance( src, dst ) );
+            // Up to three nodes, the triangulation has (at most) all the possible edges
+            for( unsigned int i = 0; i < triNodes.size(); i++ )
+            {
+                for( unsigned int j = i + 1; j < triNodes.size(); j++ )
+                {
+                    auto src = m_allNodes[ triNodes[i]->Id() ];
+                    auto dst = m_allNodes[ triNodes[j]->Id() ];
+                    mstEdges.emplace_back( src, dst, getDistance( src, dst ) );
+                }
+            }
         }
         else
         {
@@ -336,14 +313,14 @@ public:
 
             std::sort( chain.begin(), chain.end(),
                     [] ( const CN_ANCHOR_PTR& a, const CN_ANCHOR_PTR& b ) {
-                return a->GetCluster().get() < b->GetCluster().get();
+                return a->Item()->ClusterId() < b->Item()->ClusterId();
             } );
 
             for( unsigned int j = 1; j < chain.size(); j++ )
             {
                 const auto& prevNode    = chain[j - 1];
                 const auto& curNode     = chain[j];
-                int weight = prevNode->GetCluster() != curNode->GetCluster() ? 1 : 0;
+                int weight = prevNode->Item()->ClusterId() != curNode->Item()->ClusterId() ? 1 : 0;
                 mstEdges.push_back( CN_EDGE ( prevNode, curNode, weight ) );
             }
         }
@@ -390,24 +367,46 @@ void RN_NET::compute()
         return;
     }
 
+    std::vector<CN_EDGE> triangEdges;
 
-    m_triangulator->Clear();
-
-    for( auto n : m_nodes )
+    if( m_nodes.size() == 3 )
     {
-        m_triangulator->AddNode( n );
+        // The three possible edges are a superset of the triangulation. As the triangulator
+        // does, the coincident anchors of different clusters get the smallest weight.
+        for( unsigned int i = 0; i < 3; i++ )
+        {
+            for( unsigned int j = i + 1; j < 3; j++ )
+            {
+                const auto& src = m_nodes[i];
+                const auto& dst = m_nodes[j];
+                unsigned int weight = getDistance( src, dst );
+
+                if( weight == 0 )
+                    weight = src->Item()->ClusterId() != dst->Item()->ClusterId() ? 1 : 0;
+
+                triangEdges.emplace_back( src, dst, weight );
+            }
+        }
     }
+    else
+    {
+        m_triangulator->Clear();
+
+        for( auto n : m_nodes )
+        {
+            m_triangulator->AddNode( n );
+        }
 
-    #ifdef PROFILE
-    PROF_COUNTER cnt("triangulate");
-    #endif
-    auto triangEdges = m_triangulator->Triangulate();
-    #ifdef PROFILE
-    cnt.Show();
-    #endif
+        #ifdef PROFILE
+        PROF_COUNTER cnt("triangulate");
+        #endif
+        triangEdges = m_triangulator->Triangulate();
+        #ifdef PROFILE
+        cnt.Show();
+        #endif
+    }
 
-    for( const auto& e : m_boardEdges )
-        triangEdges.push_back( e );
+    triangEdges.insert( triangEdges.end(), m_boardEdges.begin(), m_boardEdges.end() );
 
 // Get the minimal spanning tree
 #ifdef PROFILE
@@ -441,7 +440,7 @@ void RN_NET::Clear()
 
 void RN_NET::AddCluster( CN_CLUSTER_PTR aCluster )
 {
-    CN_ANCHOR_PTR firstAnchor;
+    CN_ANCHOR_PTR firstAnchor = nullptr;
 
     for( auto item : *aCluster )
     {
@@ -457,21 +456,20 @@ void RN_NET::AddCluster( CN_CLUSTER_PTR aCluster )
 
         for( unsigned int i = 0; i < nAnchors; i++ )
         {
-        //    printf("add anchor %p\n", anchors[i].get() );
+            CN_ANCHOR_PTR anchor = &anchors[i];
 
-            anchors[i]->SetCluster( aCluster );
-            m_nodes.push_back(anchors[i]);
+            m_nodes.push_back( anchor );
 
             if( firstAnchor )
             {
-                if( firstAnchor != anchors[i] )
+                if( firstAnchor != anchor )
                 {
-                    m_boardEdges.emplace_back( firstAnchor, anchors[i], 0 );
+                    m_boardEdges.emplace_back( firstAnchor, anchor, 0 );
                 }
             }
             else
             {
-                firstAnchor = anchors[i];
+                firstAnchor = anchor;
             }
         }
     }
@@ -114,6 +114,11 @@ public:
         return m_nodes.size();
     }
 
+    const std::vector<CN_ANCHOR_PTR>& GetNodes() const
+    {
+        return m_nodes;
+    }
+
     /**
      * Function GetNodes()
      * Returns list of nodes that are associated with a given item.
@@ -71,7 +71,7 @@ void RATSNEST_VIEWITEM::ViewDraw( int aLayer, KIGFX::VIEW* aView ) const
     gal->SetStrokeColor( color.Brightened(0.8) );
 
     // Draw the "dynamic" ratsnest (i.e. for objects that may be currently being moved)
-    for( const auto& l : m_data->GetDynamicRatsnest() )
+    auto drawDynamicLine = [gal] ( const RN_DYNAMIC_LINE& l )
     {
         if ( l.a == l.b )
         {
@@ -80,7 +80,13 @@ void RATSNEST_VIEWITEM::ViewDraw( int aLayer, KIGFX::VIEW* aView ) const
         } else {
             gal->DrawLine( l.a, l.b );
         }
-    }
+    };
+
+    for( const auto& l : m_data->GetDynamicRatsnest() )
+        drawDynamicLine( l );
+
+    for( const auto& l : m_dynamicLines )
+        drawDynamicLine( l );
 
     for( int i = 1; i < m_data->GetNetCount(); ++i )
     {
@@ -31,8 +31,10 @@
 #define RATSNEST_VIEWITEM_H
 
 #include <memory>
+#include <vector>
 #include <base_struct.h>
 #include <math/vector2d.h>
+#include <connectivity.h>
 
 class GAL;
 class CONNECTIVITY_DATA;
@@ -53,6 +55,16 @@ public:
     /// @copydoc VIEW_ITEM::ViewGetLayers()
     void ViewGetLayers( int aLayers[], int& aCount ) const override;
 
+    /**
+     * Function SwapDynamicLines
+     * exchanges the dragged items ratsnest lines drawn with aLines, so that the buffers
+     * of the lines are reused from a move to the next one (see DYNAMIC_RATSNEST).
+     */
+    void SwapDynamicLines( std::vector<RN_DYNAMIC_LINE>& aLines )
+    {
+        m_dynamicLines.swap( aLines );
+    }
+
 #if defined(DEBUG)
     /// @copydoc EDA_ITEM::Show()
     void Show( int x, std::ostream& st ) const override
@@ -71,6 +83,9 @@ public:
 protected:
     ///> Object containing ratsnest data.
     std::shared_ptr<CONNECTIVITY_DATA> m_data;
+
+    ///> Ratsnest of the dragged items, computed in the background.
+    std::vector<RN_DYNAMIC_LINE> m_dynamicLines;
 };
 
 }   // namespace KIGFX
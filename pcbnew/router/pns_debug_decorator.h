@@ -27,6 +27,8 @@
 #include <geometry/seg.h>
 #include <geometry/shape_line_chain.h>
 
+#include "pns_hull_cache.h"
+
 namespace PNS {
 
 class DEBUG_DECORATOR
@@ -44,6 +46,23 @@ public:
     virtual void AddBox( BOX2I aB, int aColor ) {};
     virtual void AddDirections( VECTOR2D aP, int aMask, int aColor ) {};
     virtual void Clear() {};
+
+    ///> Number of item hulls taken from the hull caches since the last ResetCounters()
+    long long HullCacheHits() const
+    {
+        return HULL_CACHE::Hits();
+    }
+
+    ///> Number of item hulls built since the last ResetCounters()
+    long long HullCacheMisses() const
+    {
+        return HULL_CACHE::Misses();
+    }
+
+    void ResetCounters()
+    {
+        HULL_CACHE::ResetStats();
+    }
 };
 
 }
@@ -0,0 +1,195 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_HULL_CACHE_H
+#define __PNS_HULL_CACHE_H
+
+#include <atomic>
+#include <memory>
+
+#include <geometry/shape_line_chain.h>
+
+namespace PNS {
+
+/**
+ * Class HULL_CACHE
+ *
+ * Keeps the hulls of an item for the (clearance, walkaround thickness) pairs they were
+ * built for. The items stored in a NODE are shared with its branches, and so are their
+ * hulls. The owner of the cache empties it when the shape of the item changes; a copy of
+ * an item starts with an empty cache.
+ *
+ * The walkaround looks for the hulls of the same items from several threads. The entries
+ * never change once added, and are added to the head of a list with a compare and swap,
+ * so the lookups take no lock. The hulls are shared, not copied: they stay valid for their
+ * users after the cache has been emptied.
+ */
+class HULL_CACHE
+{
+public:
+    typedef std::shared_ptr<const SHAPE_LINE_CHAIN> HULL_PTR;
+
+    HULL_CACHE() :
+        m_head( nullptr )
+    {}
+
+    HULL_CACHE( const HULL_CACHE& aOther ) :
+        m_head( nullptr )
+    {}
+
+    HULL_CACHE& operator=( const HULL_CACHE& aOther )
+    {
+        Clear();
+        return *this;
+    }
+
+    ~HULL_CACHE()
+    {
+        Clear();
+    }
+
+    /**
+     * Function Get()
+     *
+     * Returns the hull for aClearance and aWalkaroundThickness, calling aBuild() to make
+     * it if it is not in the cache yet.
+     */
+    template <class BUILDER>
+    HULL_PTR Get( int aClearance, int aWalkaroundThickness, BUILDER aBuild )
+    {
+        ENTRY* head = m_head.load( std::memory_order_acquire );
+
+        if( const ENTRY* found = find( head, nullptr, aClearance, aWalkaroundThickness ) )
+        {
+            s_hits.fetch_add( 1, std::memory_order_relaxed );
+            return found->m_hull;
+        }
+
+        s_misses.fetch_add( 1, std::memory_order_relaxed );
+
+        // Built without any lock: another thread may build the same hull meanwhile, the
+        // first one added to the cache is kept
+        HULL_PTR hull = std::make_shared<SHAPE_LINE_CHAIN>( aBuild() );
+        ENTRY* entry = new ENTRY( aClearance, aWalkaroundThickness, hull );
+
+        while( true )
+        {
+            // An item is mostly walked around by lines of a few widths and clearances:
+            // once the cache is full, the other hulls are not kept
+            if( head && head->m_count >= MaxEntries )
+            {
+                delete entry;
+                return hull;
+            }
+
+            entry->m_next = head;
+            entry->m_count = head ? head->m_count + 1 : 1;
+
+            if( m_head.compare_exchange_weak( head, entry, std::memory_order_release,
+                                              std::memory_order_acquire ) )
+                return hull;
+
+            // Entries were added meanwhile, maybe the same hull
+            if( const ENTRY* found = find( head, entry->m_next, aClearance,
+                                           aWalkaroundThickness ) )
+            {
+                delete entry;
+                return found->m_hull;
+            }
+        }
+    }
+
+    /**
+     * Function Clear()
+     *
+     * Empties the cache. Must not be called while the item is looked at from other threads,
+     * which is the case as the shape of an item does not change while it is walked around.
+     */
+    void Clear()
+    {
+        ENTRY* entry = m_head.exchange( nullptr, std::memory_order_acq_rel );
+
+        while( entry )
+        {
+            ENTRY* next = entry->m_next;
+            delete entry;
+            entry = next;
+        }
+    }
+
+    ///> Number of hulls found in the caches of all items since the last ResetStats()
+    static long long Hits()
+    {
+        return s_hits;
+    }
+
+    ///> Number of hulls built because they were not in the cache
+    static long long Misses()
+    {
+        return s_misses;
+    }
+
+    static void ResetStats()
+    {
+        s_hits = 0;
+        s_misses = 0;
+    }
+
+private:
+    static const int MaxEntries = 4;
+
+    struct ENTRY
+    {
+        ENTRY( int aClearance, int aThickness, const HULL_PTR& aHull ) :
+            m_clearance( aClearance ),
+            m_thickness( aThickness ),
+            m_hull( aHull ),
+            m_next( nullptr ),
+            m_count( 0 )
+        {}
+
+        int         m_clearance;
+        int         m_thickness;
+        HULL_PTR    m_hull;
+        ENTRY*      m_next;
+        int         m_count;        ///< number of entries from this one to the end
+    };
+
+    ///> Looks for the hull in the entries from aFirst up to aLast (excluded)
+    static const ENTRY* find( const ENTRY* aFirst, const ENTRY* aLast, int aClearance,
+                              int aWalkaroundThickness )
+    {
+        for( const ENTRY* entry = aFirst; entry != aLast; entry = entry->m_next )
+        {
+            if( entry->m_clearance == aClearance && entry->m_thickness == aWalkaroundThickness )
+                return entry;
+        }
+
+        return nullptr;
+    }
+
+    std::atomic<ENTRY*> m_head;
+
+    static std::atomic<long long> s_hits;
+    static std::atomic<long long> s_misses;
+};
+
+}
+
+#endif    // __PNS_HULL_CACHE_H
@@ -24,6 +24,10 @@
 
 namespace PNS {
 
+std::atomic<long long> HULL_CACHE::s_hits( 0 );
+std::atomic<long long> HULL_CACHE::s_misses( 0 );
+
+
 bool ITEM::collideSimple( const ITEM* aOther, int aClearance, bool aNeedMTV,
         VECTOR2I& aMTV, bool aDifferentNetsOnly ) const
 {
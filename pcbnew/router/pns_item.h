@@ -29,6 +29,7 @@
 #include <geometry/shape_line_chain.h>
 
 #include "pns_layerset.h"
+#include "pns_hull_cache.h"
 
 class BOARD_CONNECTED_ITEM;
 
@@ -112,6 +113,25 @@ public:
         return SHAPE_LINE_CHAIN();
     }
 
+    /**
+     * Function SharedHull()
+     *
+     * Returns the hull made by Hull(), without copying it. It is kept for the next calls
+     * if the item belongs to a NODE; temporary items are not worth caching.
+     */
+    HULL_CACHE::HULL_PTR SharedHull( int aClearance = 0, int aWalkaroundThickness = 0 ) const
+    {
+        auto build = [&] ()
+        {
+            return Hull( aClearance, aWalkaroundThickness );
+        };
+
+        if( !m_owner )
+            return std::make_shared<SHAPE_LINE_CHAIN>( build() );
+
+        return m_hullCache.Get( aClearance, aWalkaroundThickness, build );
+    }
+
     /**
      * Function Kind()
      *
@@ -343,6 +363,12 @@ private:
             VECTOR2I& aMTV, bool aDifferentNetsOnly ) const;
 
 protected:
+    ///> Drops the cached hulls, to be called when the shape of the item changes
+    void invalidateHull()
+    {
+        m_hullCache.Clear();
+    }
+
     PnsKind                 m_kind;
 
     BOARD_CONNECTED_ITEM*   m_parent;
@@ -353,6 +379,8 @@ protected:
     int                     m_net;
     int                     m_marker;
     int                     m_rank;
+
+    mutable HULL_CACHE      m_hullCache;
 };
 
 template< typename T, typename S >
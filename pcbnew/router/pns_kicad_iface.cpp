@@ -438,6 +438,9 @@ public:
 
     void AddLine( const SHAPE_LINE_CHAIN& aLine, int aType, int aWidth ) override
     {
+        if( !m_view )
+            return;
+
         ROUTER_PREVIEW_ITEM* pitem = new ROUTER_PREVIEW_ITEM( NULL, m_view );
 
         pitem->Line( aLine, aWidth, aType );
@@ -475,8 +478,10 @@ PNS_KICAD_IFACE::PNS_KICAD_IFACE()
     m_previewItems = nullptr;
     m_world = nullptr;
     m_router = nullptr;
-    m_debugDecorator = nullptr;
     m_dispOptions = nullptr;
+
+    // Draws nothing until a view is set (the router may run without one)
+    m_debugDecorator = new PNS_PCBNEW_DEBUG_DECORATOR();
 }
 
 
@@ -871,7 +876,7 @@ void PNS_KICAD_IFACE::EraseView()
 
     m_hiddenItems.clear();
 
-    if( m_previewItems )
+    if( m_view && m_previewItems )
     {
         m_previewItems->FreeItems();
         m_view->Update( m_previewItems );
@@ -886,6 +891,9 @@ void PNS_KICAD_IFACE::DisplayItem( const PNS::ITEM* aItem, int aColor, int aClea
 {
     wxLogTrace( "PNS", "DisplayItem %p", aItem );
 
+    if( !m_view )
+        return;
+
     ROUTER_PREVIEW_ITEM* pitem = new ROUTER_PREVIEW_ITEM( aItem, m_view );
 
     if( aColor >= 0 )
@@ -914,7 +922,7 @@ void PNS_KICAD_IFACE::HideItem( PNS::ITEM* aItem )
 {
     BOARD_CONNECTED_ITEM* parent = aItem->Parent();
 
-    if( parent )
+    if( parent && m_view )
     {
         if( m_view->IsVisible( parent ) )
             m_hiddenItems.insert( parent );
@@ -929,7 +937,7 @@ void PNS_KICAD_IFACE::RemoveItem( PNS::ITEM* aItem )
 {
     BOARD_CONNECTED_ITEM* parent = aItem->Parent();
 
-    if( parent )
+    if( parent && m_commit )
     {
         m_commit->Remove( parent );
     }
@@ -940,6 +948,10 @@ void PNS_KICAD_IFACE::AddItem( PNS::ITEM* aItem )
 {
     BOARD_CONNECTED_ITEM* newBI = NULL;
 
+    // Without a host frame, the routed items are only kept in the router world
+    if( !m_commit )
+        return;
+
     switch( aItem->Kind() )
     {
     case PNS::ITEM::SEGMENT_T:
@@ -988,6 +1000,10 @@ void PNS_KICAD_IFACE::AddItem( PNS::ITEM* aItem )
 void PNS_KICAD_IFACE::Commit()
 {
     EraseView();
+
+    if( !m_commit )
+        return;
+
     m_commit->Push( wxT( "Added a track" ) );
     m_commit.reset( new BOARD_COMMIT( m_frame ) );
 }
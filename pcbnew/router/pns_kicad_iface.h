@@ -38,6 +38,11 @@ namespace KIGFX
     class VIEW;
 };
 
+/**
+ * The router interface to a board. The view and the host frame are optional: without a
+ * view nothing is displayed, and without a frame the routed items are not committed to
+ * the board, which lets the router run headless (see the pcbnew benchmarks).
+ */
 class PNS_KICAD_IFACE : public PNS::ROUTER_IFACE {
 public:
     PNS_KICAD_IFACE();
@@ -419,10 +419,10 @@ bool LINE_PLACER::rhMarkObstacles( const VECTOR2I& aP, LINE& aNewHead )
     if( obs )
     {
         int cl = m_currentNode->GetClearance( obs->m_item, &m_head );
-        auto hull = obs->m_item->Hull( cl, m_head.Width() );
+        auto hull = obs->m_item->SharedHull( cl, m_head.Width() );
 
-        auto nearest = hull.NearestPoint( aP );
-        Dbg()->AddLine( hull, 2, 10000 );
+        auto nearest = hull->NearestPoint( aP );
+        Dbg()->AddLine( *hull, 2, 10000 );
 
         if( ( nearest - aP ).EuclideanNorm() < m_head.Width() )
         {
@@ -32,8 +32,13 @@
 #include <geometry/shape_circle.h>
 #include <geometry/shape_convex.h>
 
+#include <fstream>
+
 namespace PNS {
 
+static const char* eventNames[] = { "start_route", "start_drag", "move", "fix" };
+
+
 LOGGER::LOGGER( )
 {
     m_groupOpened = false;
@@ -139,6 +144,46 @@ void LOGGER::Log( const VECTOR2I& aStart, const VECTOR2I& aEnd,
 }
 
 
+void LOGGER::Log( EVENT_TYPE aEvent, const VECTOR2I& aP, int aParam )
+{
+    m_theLog << "event " << eventNames[aEvent] << " " << aP.x << " " << aP.y << " " <<
+                aParam << std::endl;
+}
+
+
+bool LOGGER::ParseEvents( const std::string& aFilename, std::vector<EVENT_ENTRY>& aEvents )
+{
+    std::ifstream f( aFilename );
+
+    if( !f )
+        return false;
+
+    std::string line;
+
+    while( std::getline( f, line ) )
+    {
+        std::istringstream tokens( line );
+        std::string tag, name;
+        EVENT_ENTRY evt;
+
+        if( !( tokens >> tag >> name >> evt.p.x >> evt.p.y >> evt.param ) || tag != "event" )
+            continue;
+
+        for( int i = EVT_START_ROUTE; i <= EVT_FIX; i++ )
+        {
+            if( name == eventNames[i] )
+            {
+                evt.type = (EVENT_TYPE) i;
+                aEvents.push_back( evt );
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+
 void LOGGER::dumpShape( const SHAPE* aSh )
 {
     switch( aSh->Type() )
@@ -39,6 +39,22 @@ class ITEM;
 class LOGGER
 {
 public:
+    ///> The router operations recorded by Log( EVENT_TYPE... ), which can be replayed
+    enum EVENT_TYPE
+    {
+        EVT_START_ROUTE = 0,
+        EVT_START_DRAG,
+        EVT_MOVE,
+        EVT_FIX
+    };
+
+    struct EVENT_ENTRY
+    {
+        EVENT_TYPE  type;
+        VECTOR2I    p;
+        int         param;      ///> layer for EVT_START_ROUTE, drag mode for EVT_START_DRAG
+    };
+
     LOGGER();
     ~LOGGER();
 
@@ -52,6 +68,14 @@ public:
     void Log( const SHAPE_LINE_CHAIN *aL, int aKind = 0, const std::string aName = std::string() );
     void Log( const VECTOR2I& aStart, const VECTOR2I& aEnd, int aKind = 0,
               const std::string aName = std::string() );
+    void Log( EVENT_TYPE aEvent, const VECTOR2I& aP, int aParam = 0 );
+
+    /**
+     * Function ParseEvents
+     * reads the events from a log saved by Save(), ignoring the other entries.
+     * @return false if the file cannot be read.
+     */
+    static bool ParseEvents( const std::string& aFilename, std::vector<EVENT_ENTRY>& aEvents );
 
 private:
     void dumpShape( const SHAPE* aSh );
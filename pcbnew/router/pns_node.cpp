@@ -51,6 +51,7 @@ NODE::NODE()
 {
     wxLogTrace( "PNS", "NODE::create %p", this );
     m_depth = 0;
+    m_branchCount = 0;
     m_root = this;
     m_parent = NULL;
     m_maxClearance = 800000;    // fixme: depends on how thick traces are.
@@ -118,10 +119,11 @@ NODE* NODE::Branch()
     child->m_parent = this;
     child->m_ruleResolver = m_ruleResolver;
     child->m_root = isRoot() ? this : m_root;
+    child->m_root->m_branchCount++;
 
     // immmediate offspring of the root branch needs not copy anything.
-    // For the rest, deep-copy joints, overridden item map and pointers
-    // to stored items.
+    // For the rest, deep-copy joints and pointers to stored items, and share
+    // the overridden item set, which is copied on write.
     if( !isRoot() )
     {
         JOINT_MAP::iterator j;
@@ -134,7 +136,7 @@ NODE* NODE::Branch()
     }
 
     wxLogTrace( "PNS", "%d items, %d joints, %d overrides",
-            child->m_index->Size(), (int) child->m_joints.size(), (int) child->m_override.size() );
+            child->m_index->Size(), (int) child->m_joints.size(), (int) child->m_override.Size() );
 
     return child;
 }
@@ -343,7 +345,7 @@ NODE::OPT_OBSTACLE NODE::NearestObstacle( const LINE* aItem, int aKindMask,
 
         int clearance = GetClearance( obs.m_item, &aLine );
 
-        SHAPE_LINE_CHAIN hull = obs.m_item->Hull( clearance, aItem->Width() );
+        HULL_CACHE::HULL_PTR hull = obs.m_item->SharedHull( clearance, aItem->Width() );
 
         if( aLine.EndsWithVia() )
         {
@@ -351,7 +353,7 @@ NODE::OPT_OBSTACLE NODE::NearestObstacle( const LINE* aItem, int aKindMask,
 
             SHAPE_LINE_CHAIN viaHull = aLine.Via().Hull( clearance, aItem->Width() );
 
-            viaHull.Intersect( hull, isect_list );
+            viaHull.Intersect( *hull, isect_list );
 
             for( SHAPE_LINE_CHAIN::INTERSECTION isect : isect_list )
             {
@@ -377,7 +379,7 @@ NODE::OPT_OBSTACLE NODE::NearestObstacle( const LINE* aItem, int aKindMask,
 
         isect_list.clear();
 
-        hull.Intersect( aLine.CLine(), isect_list );
+        hull->Intersect( aLine.CLine(), isect_list );
 
         for( SHAPE_LINE_CHAIN::INTERSECTION isect : isect_list )
         {
@@ -639,7 +641,7 @@ void NODE::doRemove( ITEM* aItem )
     // case 1: removing an item that is stored in the root node from any branch:
     // mark it as overridden, but do not remove
     if( aItem->BelongsTo( m_root ) && !isRoot() )
-        m_override.insert( aItem );
+        m_override.Insert( aItem );
 
     // case 2: the item belongs to this branch or a parent, non-root branch,
     // or the root itself and we are the root: remove from the index
@@ -1162,7 +1164,7 @@ void NODE::Dump( bool aLong )
 
 void NODE::GetUpdatedItems( ITEM_VECTOR& aRemoved, ITEM_VECTOR& aAdded )
 {
-    aRemoved.reserve( m_override.size() );
+    aRemoved.reserve( m_override.Size() );
     aAdded.reserve( m_index->Size() );
 
     if( isRoot() )
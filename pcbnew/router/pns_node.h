@@ -36,6 +36,8 @@
 #include "pns_item.h"
 #include "pns_joint.h"
 #include "pns_itemset.h"
+#include "pns_override_set.h"
+#include "pns_pool.h"
 
 namespace PNS {
 
@@ -82,7 +84,7 @@ struct OBSTACLE
     ITEM* m_item;
 
     ///> Hull of the colliding m_item
-    SHAPE_LINE_CHAIN m_hull;
+    HULL_CACHE::HULL_PTR m_hull;
 
     ///> First and last intersection point between the head item and the hull
     ///> of the colliding m_item
@@ -144,6 +146,8 @@ public:
     NODE();
     ~NODE();
 
+    PNS_POOLED_ALLOCATION( NODE )
+
     ///> Returns the expected clearance between items a and b.
     int GetClearance( const ITEM* aA, const ITEM* aB ) const;
 
@@ -182,6 +186,18 @@ public:
         return m_depth;
     }
 
+    ///> Returns the number of branches made from the root node and its descendants
+    ///> since the last ResetBranchCount()
+    int BranchCount() const
+    {
+        return m_root->m_branchCount;
+    }
+
+    void ResetBranchCount()
+    {
+        m_root->m_branchCount = 0;
+    }
+
     /**
      * Function QueryColliding()
      *
@@ -415,7 +431,7 @@ public:
     ///> from the root branch.
     bool Overrides( ITEM* aItem ) const
     {
-        return m_override.find( aItem ) != m_override.end();
+        return m_override.Contains( aItem );
     }
 
 private:
@@ -485,8 +501,9 @@ private:
     ///> list of nodes branched from this one
     std::set<NODE*> m_children;
 
-    ///> hash of root's items that have been changed in this node
-    boost::unordered_set<ITEM*> m_override;
+    ///> root's items that have been changed in this node, shared with the parent
+    ///> until either of them changes another one
+    OVERRIDE_SET m_override;
 
     ///> worst case item-item clearance
     int m_maxClearance;
@@ -500,6 +517,9 @@ private:
     ///> depth of the node (number of parent nodes in the inheritance chain)
     int m_depth;
 
+    ///> number of branches of the hierarchy, counted by the root node
+    int m_branchCount;
+
     boost::unordered_set<ITEM*> m_garbageItems;
 };
 
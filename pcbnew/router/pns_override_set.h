@@ -0,0 +1,145 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_OVERRIDE_SET_H
+#define __PNS_OVERRIDE_SET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace PNS {
+
+class ITEM;
+
+/**
+ * Class OVERRIDE_SET
+ *
+ * The items of the root node a branch has removed or replaced. A branch starts with the
+ * items overridden by its parent, so the set is shared between the two, and copied only
+ * when one of them overrides a new item (copy on write). Most branches of a shove never
+ * override anything, and so never copy the set of their parent.
+ *
+ * The items are kept in the order they were added, and hashed in an open addressing
+ * table of pointers, half full at most.
+ */
+class OVERRIDE_SET
+{
+public:
+    typedef std::vector<ITEM*>::const_iterator const_iterator;
+
+    bool Contains( const ITEM* aItem ) const
+    {
+        if( !m_data )
+            return false;
+
+        const std::vector<ITEM*>& slots = m_data->m_slots;
+        size_t mask = slots.size() - 1;
+
+        for( size_t i = hash( aItem ) & mask; slots[i]; i = ( i + 1 ) & mask )
+        {
+            if( slots[i] == aItem )
+                return true;
+        }
+
+        return false;
+    }
+
+    void Insert( ITEM* aItem )
+    {
+        if( Contains( aItem ) )
+            return;
+
+        if( !m_data )
+            m_data = std::make_shared<DATA>();
+        else if( m_data.use_count() > 1 )
+            m_data = std::make_shared<DATA>( *m_data );
+
+        m_data->m_items.push_back( aItem );
+
+        if( 2 * m_data->m_items.size() > m_data->m_slots.size() )
+            rehash( m_data->m_slots.empty() ? 16 : 2 * m_data->m_slots.size() );
+        else
+            insertSlot( m_data->m_slots, aItem );
+    }
+
+    size_t Size() const
+    {
+        return m_data ? m_data->m_items.size() : 0;
+    }
+
+    bool Empty() const
+    {
+        return Size() == 0;
+    }
+
+    const_iterator begin() const
+    {
+        return m_data ? m_data->m_items.cbegin() : const_iterator();
+    }
+
+    const_iterator end() const
+    {
+        return m_data ? m_data->m_items.cend() : const_iterator();
+    }
+
+private:
+    struct DATA
+    {
+        ///> items in the order they were added
+        std::vector<ITEM*> m_items;
+
+        ///> hash table of m_items, a power of two in size, NULL for the free slots
+        std::vector<ITEM*> m_slots;
+    };
+
+    static size_t hash( const ITEM* aItem )
+    {
+        // Fibonacci hashing of the address, without its alignment bits
+        uint64_t h = ( reinterpret_cast<uintptr_t>( aItem ) >> 4 ) * 0x9E3779B97F4A7C15ULL;
+
+        return (size_t) ( h >> 32 );
+    }
+
+    static void insertSlot( std::vector<ITEM*>& aSlots, ITEM* aItem )
+    {
+        size_t mask = aSlots.size() - 1;
+        size_t i = hash( aItem ) & mask;
+
+        while( aSlots[i] )
+            i = ( i + 1 ) & mask;
+
+        aSlots[i] = aItem;
+    }
+
+    void rehash( size_t aSize )
+    {
+        m_data->m_slots.assign( aSize, nullptr );
+
+        for( ITEM* item : m_data->m_items )
+            insertSlot( m_data->m_slots, item );
+    }
+
+    std::shared_ptr<DATA> m_data;
+};
+
+}
+
+#endif    // __PNS_OVERRIDE_SET_H
@@ -0,0 +1,272 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_POOL_H
+#define __PNS_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace PNS {
+
+/**
+ * Class POOL
+ *
+ * Free lists of memory blocks of Size bytes, for the objects the router creates and
+ * deletes at a high rate while shoving (the branches of the world, their segments and
+ * vias). Each thread allocates from its own free list, without locking. A block always
+ * goes back to the list of the thread which allocated it: a block freed by another thread
+ * is pushed on a lock-free list of the owner, which takes it back when its own list is
+ * empty. The list of a thread which ends is taken over by the next thread.
+ *
+ * The blocks are allocated by chunks, which are kept until Release().
+ */
+template <size_t Size>
+class POOL
+{
+public:
+    static void* Alloc( size_t aSize )
+    {
+        // Classes derived from the pooled one are allocated normally
+        if( aSize != Size )
+            return ::operator new( aSize );
+
+        CACHE* cache = localCache();
+
+        if( !cache->m_free )
+        {
+            // Take back the blocks freed by the other threads
+            cache->m_free = cache->m_remoteFree.exchange( nullptr, std::memory_order_acquire );
+
+            if( !cache->m_free )
+                allocChunk( cache );
+        }
+
+        BLOCK* block = cache->m_free;
+        cache->m_free = block->m_data.m_next;
+        cache->m_used++;
+
+        return &block->m_data.m_storage;
+    }
+
+    static void Free( void* aPtr, size_t aSize )
+    {
+        if( !aPtr )
+            return;
+
+        if( aSize != Size )
+        {
+            ::operator delete( aPtr );
+            return;
+        }
+
+        BLOCK* block = reinterpret_cast<BLOCK*>( static_cast<char*>( aPtr )
+                                                 - offsetof( BLOCK, m_data ) );
+        CACHE* owner = block->m_owner;
+
+        if( owner == localCache() )
+        {
+            block->m_data.m_next = owner->m_free;
+            owner->m_free = block;
+            owner->m_used--;
+            return;
+        }
+
+        BLOCK* head = owner->m_remoteFree.load( std::memory_order_relaxed );
+
+        do
+        {
+            block->m_data.m_next = head;
+        } while( !owner->m_remoteFree.compare_exchange_weak( head, block,
+                                                             std::memory_order_release,
+                                                             std::memory_order_relaxed ) );
+
+        owner->m_remoteFreed.fetch_add( 1, std::memory_order_relaxed );
+    }
+
+    /**
+     * Function Release()
+     *
+     * Gives the memory of the pool back to the system, if all its blocks are free.
+     * Must be called when no other thread uses the pool, e.g. when the router is
+     * destroyed.
+     * @return false if some blocks are still in use, in which case nothing is released.
+     */
+    static bool Release()
+    {
+        REGISTRY& registry = getRegistry();
+        std::lock_guard<std::mutex> lock( registry.m_lock );
+        long long used = 0;
+
+        for( CACHE* cache : registry.m_caches )
+            used += cache->m_used - cache->m_remoteFreed.load( std::memory_order_acquire );
+
+        if( used )
+            return false;
+
+        for( CACHE* cache : registry.m_caches )
+        {
+            cache->m_free = nullptr;
+            cache->m_remoteFree.store( nullptr, std::memory_order_relaxed );
+            cache->m_used = 0;
+            cache->m_remoteFreed.store( 0, std::memory_order_relaxed );
+        }
+
+        for( void* chunk : registry.m_chunks )
+            ::operator delete( chunk );
+
+        registry.m_chunks.clear();
+
+        return true;
+    }
+
+private:
+    struct CACHE;
+
+    struct BLOCK
+    {
+        CACHE* m_owner;
+
+        union
+        {
+            BLOCK* m_next;
+            typename std::aligned_storage<Size, alignof( std::max_align_t )>::type m_storage;
+        } m_data;
+    };
+
+    ///> The free lists of a thread
+    struct CACHE
+    {
+        CACHE() :
+            m_free( nullptr ),
+            m_used( 0 ),
+            m_remoteFree( nullptr ),
+            m_remoteFreed( 0 ),
+            m_orphan( false )
+        {}
+
+        BLOCK*                  m_free;         ///< used by the owner thread only
+        long long               m_used;         ///< blocks allocated by the owner thread
+        std::atomic<BLOCK*>     m_remoteFree;   ///< blocks freed by the other threads
+        std::atomic<long long>  m_remoteFreed;
+        bool                    m_orphan;       ///< its thread has ended
+    };
+
+    ///> The caches of all the threads and the chunks, kept for the whole session
+    struct REGISTRY
+    {
+        std::mutex          m_lock;
+        std::vector<CACHE*> m_caches;
+        std::vector<void*>  m_chunks;
+    };
+
+    ///> Gives its thread a cache, and leaves it to the next thread when the thread ends
+    struct CACHE_HANDLE
+    {
+        CACHE_HANDLE() :
+            m_cache( nullptr )
+        {
+            REGISTRY& registry = getRegistry();
+            std::lock_guard<std::mutex> lock( registry.m_lock );
+
+            for( CACHE* cache : registry.m_caches )
+            {
+                if( cache->m_orphan )
+                {
+                    cache->m_orphan = false;
+                    m_cache = cache;
+                    return;
+                }
+            }
+
+            m_cache = new CACHE;
+            registry.m_caches.push_back( m_cache );
+        }
+
+        ~CACHE_HANDLE()
+        {
+            REGISTRY& registry = getRegistry();
+            std::lock_guard<std::mutex> lock( registry.m_lock );
+
+            m_cache->m_orphan = true;
+        }
+
+        CACHE* m_cache;
+    };
+
+    static const int BlocksPerChunk = 256;
+
+    static REGISTRY& getRegistry()
+    {
+        static REGISTRY* registry = new REGISTRY;
+        return *registry;
+    }
+
+    static CACHE* localCache()
+    {
+        static thread_local CACHE_HANDLE handle;
+        return handle.m_cache;
+    }
+
+    static void allocChunk( CACHE* aCache )
+    {
+        BLOCK* chunk = static_cast<BLOCK*>( ::operator new( sizeof( BLOCK ) * BlocksPerChunk ) );
+
+        for( int i = 0; i < BlocksPerChunk; i++ )
+        {
+            chunk[i].m_owner = aCache;
+            chunk[i].m_data.m_next = aCache->m_free;
+            aCache->m_free = &chunk[i];
+        }
+
+        REGISTRY& registry = getRegistry();
+        std::lock_guard<std::mutex> lock( registry.m_lock );
+
+        registry.m_chunks.push_back( chunk );
+    }
+};
+
+
+/**
+ * Gives a class the new and delete operators allocating its objects from a POOL, and
+ * ReleasePool() to give the memory of the pool back once all the objects are deleted.
+ */
+#define PNS_POOLED_ALLOCATION( ClassName )                      \
+    static void* operator new( size_t aSize )                   \
+    {                                                           \
+        return POOL<sizeof( ClassName )>::Alloc( aSize );       \
+    }                                                           \
+                                                                \
+    static void operator delete( void* aPtr, size_t aSize )     \
+    {                                                           \
+        POOL<sizeof( ClassName )>::Free( aPtr, aSize );         \
+    }                                                           \
+                                                                \
+    static bool ReleasePool()                                   \
+    {                                                           \
+        return POOL<sizeof( ClassName )>::Release();            \
+    }
+
+}
+
+#endif    // __PNS_POOL_H
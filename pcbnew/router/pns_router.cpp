@@ -39,6 +39,8 @@
 #include "pns_node.h"
 #include "pns_line_placer.h"
 #include "pns_line.h"
+#include "pns_segment.h"
+#include "pns_via.h"
 #include "pns_solid.h"
 #include "pns_utils.h"
 #include "pns_router.h"
@@ -85,6 +87,14 @@ ROUTER::~ROUTER()
 {
     ClearWorld();
     theRouter = nullptr;
+
+    m_dragger.reset();
+    m_shove.reset();
+
+    // Give the memory of the branches and items back, unless another router still uses it
+    NODE::ReleasePool();
+    SEGMENT::ReleasePool();
+    VIA::ReleasePool();
 }
 
 
@@ -126,6 +136,8 @@ const ITEM_SET ROUTER::QueryHoverItems( const VECTOR2I& aP )
 
 bool ROUTER::StartDragging( const VECTOR2I& aP, ITEM* aStartItem, int aDragMode )
 {
+    m_logger.Clear();
+    m_logger.Log( LOGGER::EVT_START_DRAG, aP, aDragMode );
 
     if( aDragMode & DM_FREE_ANGLE )
         m_forceMarkObstaclesMode = true;
@@ -155,6 +167,9 @@ bool ROUTER::StartDragging( const VECTOR2I& aP, ITEM* aStartItem, int aDragMode
 
 bool ROUTER::StartRouting( const VECTOR2I& aP, ITEM* aStartItem, int aLayer )
 {
+    m_logger.Clear();
+    m_logger.Log( LOGGER::EVT_START_ROUTE, aP, aLayer );
+
     m_forceMarkObstaclesMode = false;
 
     switch( m_mode )
@@ -205,6 +220,9 @@ void ROUTER::Move( const VECTOR2I& aP, ITEM* endItem )
 {
     m_currentEnd = aP;
 
+    if( m_state != IDLE )
+        m_logger.Log( LOGGER::EVT_MOVE, aP );
+
     switch( m_state )
     {
     case ROUTE_TRACK:
@@ -344,6 +362,9 @@ bool ROUTER::FixRoute( const VECTOR2I& aP, ITEM* aEndItem )
 {
     bool rv = false;
 
+    if( m_state != IDLE )
+        m_logger.Log( LOGGER::EVT_FIX, aP );
+
     switch( m_state )
     {
     case ROUTE_TRACK:
@@ -462,6 +483,9 @@ void ROUTER::DumpLog()
 
     if( logger )
         logger->Save( "/tmp/shove.log" );
+
+    // The events can be replayed by the router benchmark
+    m_logger.Save( "/tmp/pns_events.log" );
 }
 
 
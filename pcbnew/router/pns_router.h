@@ -35,6 +35,7 @@
 #include "pns_item.h"
 #include "pns_itemset.h"
 #include "pns_node.h"
+#include "pns_logger.h"
 
 namespace KIGFX
 {
@@ -220,6 +221,16 @@ public:
         return m_iface;
     }
 
+    /**
+     * Function Logger()
+     * @return the events of the last routing or dragging operation, which can be replayed
+     * (see LOGGER::ParseEvents()).
+     */
+    LOGGER* Logger()
+    {
+        return &m_logger;
+    }
+
 private:
     void movePlacing( const VECTOR2I& aP, ITEM* aItem );
     void moveDragging( const VECTOR2I& aP, ITEM* aItem );
@@ -270,6 +281,8 @@ private:
 
     wxString m_toolStatusbarName;
     wxString m_failureReason;
+
+    LOGGER m_logger;
 };
 
 }
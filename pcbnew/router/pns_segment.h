@@ -30,6 +30,7 @@
 
 #include "pns_item.h"
 #include "pns_line.h"
+#include "pns_pool.h"
 
 namespace PNS {
 
@@ -58,6 +59,8 @@ public:
         m_rank = aParentLine.Rank();
     }
 
+    PNS_POOLED_ALLOCATION( SEGMENT )
+
     static inline bool ClassOf( const ITEM* aItem )
     {
         return aItem && SEGMENT_T == aItem->Kind();
@@ -83,6 +86,7 @@ public:
     void SetWidth( int aWidth )
     {
         m_seg.SetWidth(aWidth);
+        invalidateHull();
     }
 
     int Width() const
@@ -103,12 +107,14 @@ public:
     void SetEnds( const VECTOR2I& a, const VECTOR2I& b )
     {
         m_seg.SetSeg( SEG ( a, b ) );
+        invalidateHull();
     }
 
     void SwapEnds()
     {
         SEG tmp = m_seg.GetSeg();
         m_seg.SetSeg( SEG (tmp.B , tmp.A ) );
+        invalidateHull();
     }
 
     const SHAPE_LINE_CHAIN Hull( int aClearance, int aWalkaroundThickness ) const override;
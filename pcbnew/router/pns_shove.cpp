@@ -176,7 +176,7 @@ SHOVE::SHOVE_STATUS SHOVE::processHullSet( LINE& aCurrent, LINE& aObstacle,
 
         for( int i = 0; i < (int) aHulls.size(); i++ )
         {
-            const SHAPE_LINE_CHAIN& hull = aHulls[invertTraversal ? aHulls.size() - 1 - i : i];
+            const SHAPE_LINE_CHAIN& hull = *aHulls[invertTraversal ? aHulls.size() - 1 - i : i];
 
             l.Walkaround( hull, path, clockwise );
             path.Simplify();
@@ -291,16 +291,28 @@ SHOVE::SHOVE_STATUS SHOVE::ProcessSingleLine( LINE& aCurrent, LINE& aObstacle,
 
         hulls.reserve( n_segs + 1 );
 
+        // The segments of the world keep their hulls between the shove iterations
+        bool linked = aCurrent.IsLinkedChecked();
+
         for( int i = 0; i < n_segs; i++ )
         {
-            SEGMENT seg( aCurrent, aCurrent.CSegment( i ) );
-            SHAPE_LINE_CHAIN hull = seg.Hull( clearance, w );
+            const SEG s = aCurrent.CSegment( i );
+            SEGMENT* linkedSeg = linked ? aCurrent.LinkedSegments()[i] : NULL;
 
-            hulls.push_back( hull );
+            if( linkedSeg && linkedSeg->Seg().A == s.A && linkedSeg->Seg().B == s.B
+                    && linkedSeg->Width() == aCurrent.Width() )
+            {
+                hulls.push_back( linkedSeg->SharedHull( clearance, w ) );
+            }
+            else
+            {
+                SEGMENT seg( aCurrent, s );
+                hulls.push_back( seg.SharedHull( clearance, w ) );
+            }
         }
 
         if( viaOnEnd )
-            hulls.push_back( aCurrent.Via().Hull( clearance, w ) );
+            hulls.push_back( aCurrent.Via().SharedHull( clearance, w ) );
 
         rv = processHullSet( aCurrent, aObstacle, aShoved, hulls );
     }
@@ -86,7 +86,7 @@ public:
     void SetInitialLine( LINE& aInitial );
 
 private:
-    typedef std::vector<SHAPE_LINE_CHAIN> HULL_SET;
+    typedef std::vector<HULL_CACHE::HULL_PTR> HULL_SET;
     typedef boost::optional<LINE> OPT_LINE;
     typedef std::pair<LINE, LINE> LINE_PAIR;
     typedef std::vector<LINE_PAIR> LINE_PAIR_VEC;
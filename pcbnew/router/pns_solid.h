@@ -69,6 +69,7 @@ public:
             delete m_shape;
 
         m_shape = shape;
+        invalidateHull();
     }
 
     const VECTOR2I& Pos() const
@@ -28,6 +28,7 @@
 #include "../class_track.h"
 
 #include "pns_item.h"
+#include "pns_pool.h"
 
 namespace PNS {
 
@@ -79,6 +80,8 @@ public:
         m_viaType = aB.m_viaType;
     }
 
+    PNS_POOLED_ALLOCATION( VIA )
+
     static inline bool ClassOf( const ITEM* aItem )
     {
         return aItem && VIA_T == aItem->Kind();
@@ -94,6 +97,7 @@ public:
     {
         m_pos = aPos;
         m_shape.SetCenter( aPos );
+        invalidateHull();
     }
 
     VIATYPE_T ViaType() const
@@ -115,6 +119,7 @@ public:
     {
         m_diameter = aDiameter;
         m_shape.SetRadius( m_diameter / 2 );
+        invalidateHull();
     }
 
     int Drill() const
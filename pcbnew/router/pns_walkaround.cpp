@@ -19,6 +19,8 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <climits>
+
 #include <boost/optional.hpp>
 
 #include <geometry/shape_line_chain.h>
@@ -27,13 +29,16 @@
 #include "pns_optimizer.h"
 #include "pns_utils.h"
 #include "pns_router.h"
+
+#include <thread_pool.h>
+
 using boost::optional;
 
 namespace PNS {
 
 void WALKAROUND::start( const LINE& aInitialPath )
 {
-    m_iteration = 0;
+    m_iteration[0] = m_iteration[1] = 0;
     m_iterationLimit = 50;
 }
 
@@ -59,6 +64,8 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
         aWindingDirection ? m_currentObstacle[0] : m_currentObstacle[1];
 
     bool& prev_recursive = aWindingDirection ? m_recursiveCollision[0] : m_recursiveCollision[1];
+    int& blockage_count =
+        aWindingDirection ? m_recursiveBlockageCount[0] : m_recursiveBlockageCount[1];
 
     if( !current_obs )
         return DONE;
@@ -67,12 +74,12 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
 
     VECTOR2I last = aPath.CPoint( -1 );
 
-    if( ( current_obs->m_hull ).PointInside( last ) || ( current_obs->m_hull ).PointOnEdge( last ) )
+    if( current_obs->m_hull->PointInside( last ) || current_obs->m_hull->PointOnEdge( last ) )
     {
-        m_recursiveBlockageCount++;
+        blockage_count++;
 
-        if( m_recursiveBlockageCount < 3 )
-            aPath.Line().Append( current_obs->m_hull.NearestPoint( last ) );
+        if( blockage_count < 3 )
+            aPath.Line().Append( current_obs->m_hull->NearestPoint( last ) );
         else
         {
             aPath = aPath.ClipToNearestObstacle( m_world );
@@ -80,18 +87,23 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
         }
     }
 
-    aPath.Walkaround( current_obs->m_hull, path_pre[0], path_walk[0],
+    aPath.Walkaround( *current_obs->m_hull, path_pre[0], path_walk[0],
                       path_post[0], aWindingDirection );
-    aPath.Walkaround( current_obs->m_hull, path_pre[1], path_walk[1],
+    aPath.Walkaround( *current_obs->m_hull, path_pre[1], path_walk[1],
                       path_post[1], !aWindingDirection );
 
 #ifdef DEBUG
-    m_logger.NewGroup( aWindingDirection ? "walk-cw" : "walk-ccw", m_iteration );
+    std::unique_lock<std::mutex> logLock( m_logLock );
+
+    m_logger.NewGroup( aWindingDirection ? "walk-cw" : "walk-ccw",
+                       m_iteration[aWindingDirection ? 0 : 1] );
     m_logger.Log( &path_walk[0], 0, "path-walk" );
     m_logger.Log( &path_pre[0], 1, "path-pre" );
     m_logger.Log( &path_post[0], 4, "path-post" );
-    m_logger.Log( &current_obs->m_hull, 2, "hull" );
+    m_logger.Log( current_obs->m_hull.get(), 2, "hull" );
     m_logger.Log( current_obs->m_item, 3, "item" );
+
+    logLock.unlock();
 #endif
 
     int len_pre = path_walk[0].Length();
@@ -142,6 +154,45 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
 }
 
 
+WALKAROUND::WALKAROUND_STATUS WALKAROUND::walk( LINE& aPath, bool aWindingDirection,
+                                                std::atomic<int>* aDoneAt )
+{
+    int dir = aWindingDirection ? 0 : 1;
+    int& iteration = m_iteration[dir];
+
+    for( iteration = 0; iteration < m_iterationLimit; iteration++ )
+    {
+        // The other direction finished in fewer steps: this one can't be picked anymore
+        if( !m_forceLongerPath && aDoneAt[1 - dir] < iteration )
+            break;
+
+        if( singleStep( aPath, aWindingDirection ) == DONE )
+        {
+            aDoneAt[dir] = iteration;
+            return DONE;
+        }
+    }
+
+    return IN_PROGRESS;
+}
+
+
+/**
+ * Picks the shorter of two walks. Walks of the same length are compared with their corner
+ * cost, as the optimizer does.
+ */
+static const LINE& shorterPath( const LINE& aCw, const LINE& aCcw )
+{
+    int len_cw  = aCw.CLine().Length();
+    int len_ccw = aCcw.CLine().Length();
+
+    if( len_cw == len_ccw )
+        return COST_ESTIMATOR::CornerCost( aCw ) < COST_ESTIMATOR::CornerCost( aCcw ) ? aCw : aCcw;
+
+    return len_cw < len_ccw ? aCw : aCcw;
+}
+
+
 WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
         LINE& aWalkPath, bool aOptimize )
 {
@@ -162,7 +213,7 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
     start( aInitialPath );
 
     m_currentObstacle[0] = m_currentObstacle[1] = nearestObstacle( aInitialPath );
-    m_recursiveBlockageCount = 0;
+    m_recursiveBlockageCount[0] = m_recursiveBlockageCount[1] = 0;
 
     aWalkPath = aInitialPath;
 
@@ -175,49 +226,52 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
         m_forceSingleDirection = false;
     }
 
-    while( m_iteration < m_iterationLimit )
-    {
-        if( s_cw != STUCK )
-            s_cw = singleStep( path_cw, true );
+    // The step each direction finished at
+    std::atomic<int> doneAt[2];
 
-        if( s_ccw != STUCK )
-            s_ccw = singleStep( path_ccw, false );
+    doneAt[0] = doneAt[1] = INT_MAX;
 
-        if( ( s_cw == DONE && s_ccw == DONE ) || ( s_cw == STUCK && s_ccw == STUCK ) )
-        {
-            int len_cw  = path_cw.CLine().Length();
-            int len_ccw = path_ccw.CLine().Length();
+    if( s_cw != STUCK && s_ccw != STUCK )
+    {
+        // The walks only read the world: the counter-clockwise one is handed to the pool
+        // while this thread walks the clockwise one
+        THREAD_POOL& pool = THREAD_POOL::GetInstance();
 
-            if( m_forceLongerPath )
-                aWalkPath = ( len_cw > len_ccw ? path_cw : path_ccw );
-            else
-                aWalkPath = ( len_cw < len_ccw ? path_cw : path_ccw );
+        auto ccw = pool.Submit( [&] () { return walk( path_ccw, false, doneAt ); } );
 
-            break;
-        }
-        else if( s_cw == DONE && !m_forceLongerPath )
-        {
-            aWalkPath = path_cw;
-            break;
-        }
-        else if( s_ccw == DONE && !m_forceLongerPath )
-        {
-            aWalkPath = path_ccw;
-            break;
-        }
+        s_cw = walk( path_cw, true, doneAt );
 
-        m_iteration++;
+        pool.Wait( ccw );
+        s_ccw = ccw.get();
+    }
+    else if( s_cw != STUCK )
+    {
+        s_cw = walk( path_cw, true, doneAt );
+    }
+    else if( s_ccw != STUCK )
+    {
+        s_ccw = walk( path_ccw, false, doneAt );
     }
 
-    if( m_iteration == m_iterationLimit )
+    if( m_forceLongerPath )
     {
         int len_cw  = path_cw.CLine().Length();
         int len_ccw = path_ccw.CLine().Length();
 
-        if( m_forceLongerPath )
-            aWalkPath = ( len_cw > len_ccw ? path_cw : path_ccw );
-        else
-            aWalkPath = ( len_cw < len_ccw ? path_cw : path_ccw );
+        aWalkPath = ( len_cw > len_ccw ? path_cw : path_ccw );
+    }
+    else if( s_cw == DONE && doneAt[0] < doneAt[1] )
+    {
+        aWalkPath = path_cw;
+    }
+    else if( s_ccw == DONE && doneAt[1] < doneAt[0] )
+    {
+        aWalkPath = path_ccw;
+    }
+    else
+    {
+        // Both finished at the same step, or none of them did
+        aWalkPath = shorterPath( path_cw, path_ccw );
     }
 
     if( m_cursorApproachMode )
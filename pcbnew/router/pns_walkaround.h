@@ -22,6 +22,8 @@
 #ifndef __PNS_WALKAROUND_H
 #define __PNS_WALKAROUND_H
 
+#include <atomic>
+#include <mutex>
 #include <set>
 
 #include "pns_line.h"
@@ -49,9 +51,9 @@ public:
         m_itemMask = ITEM::ANY_T;
 
         // Initialize other members, to avoid uninitialized variables.
-        m_recursiveBlockageCount = 0;
+        m_recursiveBlockageCount[0] = m_recursiveBlockageCount[1] = 0;
         m_recursiveCollision[0] = m_recursiveCollision[1] = false;
-        m_iteration = 0;
+        m_iteration[0] = m_iteration[1] = 0;
         m_forceCw = false;
     }
 
@@ -118,6 +120,13 @@ public:
             m_restrictedSet.clear();
     }
 
+    /**
+     * Function Route
+     * walks aInitialPath around the obstacles of the world, clockwise and counter-clockwise.
+     * Both directions are walked concurrently (they only read the world), and the one
+     * finishing in fewer steps wins. A direction stops as soon as the other one has
+     * finished in fewer steps, unless the longer path is forced.
+     */
     WALKAROUND_STATUS Route( const LINE& aInitialPath, LINE& aWalkPath,
             bool aOptimize = true );
 
@@ -130,12 +139,18 @@ private:
     void start( const LINE& aInitialPath );
 
     WALKAROUND_STATUS singleStep( LINE& aPath, bool aWindingDirection );
+
+    ///> Steps aPath in one direction until it is done, stores the step it finished at in
+    ///> aDoneAt[direction] and gives up once aDoneAt[other direction] is earlier
+    WALKAROUND_STATUS walk( LINE& aPath, bool aWindingDirection, std::atomic<int>* aDoneAt );
+
     NODE::OPT_OBSTACLE nearestObstacle( const LINE& aPath );
 
     NODE* m_world;
 
-    int m_recursiveBlockageCount;
-    int m_iteration;
+    // The state of each direction (clockwise first), used by a single thread
+    int m_recursiveBlockageCount[2];
+    int m_iteration[2];
     int m_iterationLimit;
     int m_itemMask;
     bool m_forceSingleDirection, m_forceLongerPath;
@@ -146,6 +161,10 @@ private:
     NODE::OPT_OBSTACLE m_currentObstacle[2];
     bool m_recursiveCollision[2];
     LOGGER m_logger;
+
+    ///> Serializes the debug logging of the two directions
+    std::mutex m_logLock;
+
     std::set<ITEM*> m_restrictedSet;
 };
 
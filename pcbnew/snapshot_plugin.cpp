@@ -0,0 +1,1142 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file snapshot_plugin.cpp
+ * @brief Binary snapshot cache of the Pcbnew s-expression board files.
+ */
+
+#include <fctsys.h>
+#include <common.h>
+#include <build_version.h>
+#include <richio.h>
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <connectivity.h>
+#include <snapshot_plugin.h>
+
+#include <wx/filename.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+/*
+ * A snapshot file is a SNAPSHOT_HEADER followed by the sections it gives the offset and
+ * size of, each one aligned on 8 bytes so that its records are read in place from the
+ * mapped file.  The records are written in the byte order of the machine, which the header
+ * tells.  The items refer to strings by their index in SECTION_STRINGS, and to ranges of
+ * other records by the index of their first record and their count.
+ */
+
+/// The version of the layout of the snapshot files, to increment when it changes.
+#define SNAPSHOT_VERSION    1
+
+static const char       snapshotMagic[8] = { 'K', 'I', 'C', 'A', 'D', 'S', 'N', 'P' };
+static const uint32_t   snapshotByteOrder = 0x01020304;
+
+/// The string index of the items of the unconnected net
+static const uint32_t   NO_NET = 0xFFFFFFFF;
+
+static_assert( PCB_LAYER_ID_COUNT <= 64, "the layer sets of the pads are written on 64 bits" );
+
+
+enum SNAPSHOT_SECTION_T
+{
+    SECTION_TEXT,           ///< the text of the board, without the items below
+    SECTION_STRINGS,        ///< SNAPSHOT_STRING
+    SECTION_STRING_DATA,    ///< the UTF-8 text of the strings
+    SECTION_TRACKS,         ///< SNAPSHOT_TRACK
+    SECTION_VIAS,           ///< SNAPSHOT_VIA
+    SECTION_MODULES,        ///< SNAPSHOT_MODULE
+    SECTION_PADS,           ///< SNAPSHOT_PAD
+    SECTION_PRIMITIVES,     ///< SNAPSHOT_PRIMITIVE, the shapes of the custom pads
+    SECTION_ZONES,          ///< SNAPSHOT_ZONE
+    SECTION_OUTLINES,       ///< SNAPSHOT_OUTLINE, the filled polygons of the zones
+    SECTION_SEGMENTS,       ///< SNAPSHOT_SEGMENT, the fill segments of the zones
+    SECTION_POINTS,         ///< SNAPSHOT_POINT, of the primitives and of the outlines
+    SECTION_COUNT
+};
+
+
+struct SNAPSHOT_SECTION
+{
+    uint64_t    m_offset;
+    uint64_t    m_size;                 ///< in bytes
+};
+
+
+struct SNAPSHOT_HEADER
+{
+    char        m_magic[8];
+    uint32_t    m_byteOrder;
+    uint32_t    m_version;              ///< SNAPSHOT_VERSION
+    uint32_t    m_boardVersion;         ///< SEXPR_BOARD_FILE_VERSION of the text
+    uint32_t    m_reserved;
+    uint64_t    m_sourceHash;           ///< of the content of the board file
+    uint64_t    m_sourceSize;
+    SNAPSHOT_SECTION m_sections[SECTION_COUNT];
+};
+
+
+struct SNAPSHOT_STRING
+{
+    uint32_t    m_offset;               ///< in SECTION_STRING_DATA
+    uint32_t    m_length;
+};
+
+
+struct SNAPSHOT_TRACK
+{
+    int32_t     m_startX, m_startY;
+    int32_t     m_endX, m_endY;
+    int32_t     m_width;
+    int32_t     m_layer;
+    uint32_t    m_net;
+    uint32_t    m_status;
+    uint64_t    m_timeStamp;
+};
+
+
+struct SNAPSHOT_VIA
+{
+    uint32_t    m_order;                ///< position of the via in the track list
+    int32_t     m_x, m_y;
+    int32_t     m_width;
+    int32_t     m_drill;
+    int32_t     m_viaType;
+    int32_t     m_topLayer, m_bottomLayer;
+    uint32_t    m_net;
+    uint32_t    m_status;
+    uint64_t    m_timeStamp;
+};
+
+
+struct SNAPSHOT_MODULE
+{
+    uint32_t    m_reference;            ///< checked against the module of the text
+    uint32_t    m_firstPad;
+    uint32_t    m_padCount;
+    uint32_t    m_reserved;
+};
+
+
+struct SNAPSHOT_PAD
+{
+    double      m_orientation;
+    double      m_roundRectRatio;
+    double      m_solderPasteMarginRatio;
+    uint64_t    m_layers;
+    int32_t     m_x, m_y;
+    int32_t     m_x0, m_y0;
+    int32_t     m_sizeX, m_sizeY;
+    int32_t     m_deltaX, m_deltaY;
+    int32_t     m_drillX, m_drillY;
+    int32_t     m_offsetX, m_offsetY;
+    int32_t     m_padToDieLength;
+    int32_t     m_solderMaskMargin;
+    int32_t     m_solderPasteMargin;
+    int32_t     m_clearance;
+    int32_t     m_thermalWidth;
+    int32_t     m_thermalGap;
+    int32_t     m_zoneConnection;
+    uint32_t    m_name;
+    uint32_t    m_net;
+    uint8_t     m_shape;
+    uint8_t     m_attribute;
+    uint8_t     m_drillShape;
+    uint8_t     m_anchorShape;
+    uint8_t     m_customShapeInZone;
+    uint8_t     m_reserved[3];
+    uint32_t    m_firstPrimitive;
+    uint32_t    m_primitiveCount;
+};
+
+
+struct SNAPSHOT_PRIMITIVE
+{
+    double      m_arcAngle;
+    int32_t     m_shape;
+    int32_t     m_thickness;
+    int32_t     m_radius;
+    int32_t     m_startX, m_startY;
+    int32_t     m_endX, m_endY;
+    uint32_t    m_firstPoint;
+    uint32_t    m_pointCount;
+    uint32_t    m_reserved;
+};
+
+
+struct SNAPSHOT_ZONE
+{
+    uint32_t    m_firstOutline;
+    uint32_t    m_outlineCount;
+    uint32_t    m_firstSegment;
+    uint32_t    m_segmentCount;
+};
+
+
+struct SNAPSHOT_OUTLINE
+{
+    uint32_t    m_firstPoint;
+    uint32_t    m_pointCount;
+};
+
+
+struct SNAPSHOT_SEGMENT
+{
+    int32_t     m_startX, m_startY;
+    int32_t     m_endX, m_endY;
+};
+
+
+struct SNAPSHOT_POINT
+{
+    int32_t     m_x, m_y;
+};
+
+
+/**
+ * The hash of the content of a board file: a FNV-1a hash of its 64 bit words, in four
+ * interleaved lanes so that the multiplications of successive words overlap.
+ */
+static uint64_t hashContent( const char* aText, size_t aSize )
+{
+    const uint64_t  prime = 0x100000001B3ULL;
+    const uint64_t  basis = 0xCBF29CE484222325ULL;
+    uint64_t        lanes[4] = { basis, basis + 1, basis + 2, basis + 3 };
+    size_t          ndx = 0;
+
+    for( ; ndx + 32 <= aSize; ndx += 32 )
+    {
+        for( int lane = 0; lane < 4; ++lane )
+        {
+            uint64_t word;
+
+            memcpy( &word, aText + ndx + 8 * lane, 8 );
+            lanes[lane] = ( lanes[lane] ^ word ) * prime;
+            lanes[lane] ^= lanes[lane] >> 29;
+        }
+    }
+
+    uint64_t hash = basis ^ aSize;
+
+    for( int lane = 0; lane < 4; ++lane )
+        hash = ( hash ^ lanes[lane] ) * prime;
+
+    for( ; ndx < aSize; ++ndx )
+        hash = ( hash ^ (unsigned char) aText[ndx] ) * prime;
+
+    return hash;
+}
+
+
+/**
+ * Class SNAPSHOT_WRITER
+ * gathers the sections of the snapshot of a board.
+ */
+class SNAPSHOT_WRITER
+{
+public:
+    std::string                         m_text;
+    std::vector<SNAPSHOT_STRING>        m_strings;
+    std::string                         m_stringData;
+    std::vector<SNAPSHOT_TRACK>         m_tracks;
+    std::vector<SNAPSHOT_VIA>           m_vias;
+    std::vector<SNAPSHOT_MODULE>        m_modules;
+    std::vector<SNAPSHOT_PAD>           m_pads;
+    std::vector<SNAPSHOT_PRIMITIVE>     m_primitives;
+    std::vector<SNAPSHOT_ZONE>          m_zones;
+    std::vector<SNAPSHOT_OUTLINE>       m_outlines;
+    std::vector<SNAPSHOT_SEGMENT>       m_segments;
+    std::vector<SNAPSHOT_POINT>         m_points;
+
+    void AddTracks( BOARD* aBoard );
+    void AddModules( BOARD* aBoard );
+    void AddZones( BOARD* aBoard );
+
+    /// writes the snapshot to aFileName
+    void Write( const wxString& aFileName, uint64_t aSourceHash, uint64_t aSourceSize );
+
+private:
+    std::unordered_map<std::string, uint32_t>   m_stringIndices;
+
+    uint32_t addString( const wxString& aString );
+    uint32_t addNet( const BOARD_CONNECTED_ITEM* aItem );
+    void addPoint( int aX, int aY );
+};
+
+
+uint32_t SNAPSHOT_WRITER::addString( const wxString& aString )
+{
+    std::string utf8 = TO_UTF8( aString );
+    auto it = m_stringIndices.find( utf8 );
+
+    if( it != m_stringIndices.end() )
+        return it->second;
+
+    SNAPSHOT_STRING string;
+
+    string.m_offset = m_stringData.size();
+    string.m_length = utf8.size();
+
+    m_stringData += utf8;
+    m_strings.push_back( string );
+
+    return m_stringIndices[utf8] = m_strings.size() - 1;
+}
+
+
+uint32_t SNAPSHOT_WRITER::addNet( const BOARD_CONNECTED_ITEM* aItem )
+{
+    if( aItem->GetNetCode() == NETINFO_LIST::UNCONNECTED )
+        return NO_NET;
+
+    return addString( aItem->GetNetname() );
+}
+
+
+void SNAPSHOT_WRITER::addPoint( int aX, int aY )
+{
+    SNAPSHOT_POINT point;
+
+    point.m_x = aX;
+    point.m_y = aY;
+    m_points.push_back( point );
+}
+
+
+void SNAPSHOT_WRITER::AddTracks( BOARD* aBoard )
+{
+    uint32_t order = 0;
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next(), ++order )
+    {
+        if( track->Type() == PCB_VIA_T )
+        {
+            const VIA*      via = static_cast<const VIA*>( track );
+            PCB_LAYER_ID    top, bottom;
+            SNAPSHOT_VIA    record;
+
+            via->LayerPair( &top, &bottom );
+
+            record.m_order       = order;
+            record.m_x           = via->GetStart().x;
+            record.m_y           = via->GetStart().y;
+            record.m_width       = via->GetWidth();
+            record.m_drill       = via->GetDrill();
+            record.m_viaType     = via->GetViaType();
+            record.m_topLayer    = top;
+            record.m_bottomLayer = bottom;
+            record.m_net         = addNet( via );
+            record.m_status      = via->GetStatus();
+            record.m_timeStamp   = (uint64_t) via->GetTimeStamp();
+
+            m_vias.push_back( record );
+        }
+        else
+        {
+            SNAPSHOT_TRACK record;
+
+            record.m_startX    = track->GetStart().x;
+            record.m_startY    = track->GetStart().y;
+            record.m_endX      = track->GetEnd().x;
+            record.m_endY      = track->GetEnd().y;
+            record.m_width     = track->GetWidth();
+            record.m_layer     = track->GetLayer();
+            record.m_net       = addNet( track );
+            record.m_status    = track->GetStatus();
+            record.m_timeStamp = (uint64_t) track->GetTimeStamp();
+
+            m_tracks.push_back( record );
+        }
+    }
+}
+
+
+void SNAPSHOT_WRITER::AddModules( BOARD* aBoard )
+{
+    for( MODULE* module = aBoard->m_Modules; module; module = module->Next() )
+    {
+        SNAPSHOT_MODULE moduleRecord;
+
+        moduleRecord.m_reference = addString( module->GetReference() );
+        moduleRecord.m_firstPad  = m_pads.size();
+        moduleRecord.m_reserved  = 0;
+
+        for( D_PAD* pad = module->PadsList(); pad; pad = pad->Next() )
+        {
+            SNAPSHOT_PAD record;
+            uint64_t     layers = 0;
+            LSET         layerSet = pad->GetLayerSet();
+
+            memset( &record, 0, sizeof( record ) );
+
+            for( int layer = 0; layer < PCB_LAYER_ID_COUNT; ++layer )
+            {
+                if( layerSet[layer] )
+                    layers |= uint64_t( 1 ) << layer;
+            }
+
+            record.m_orientation            = pad->GetOrientation();
+            record.m_roundRectRatio         = pad->GetRoundRectRadiusRatio();
+            record.m_solderPasteMarginRatio = pad->GetLocalSolderPasteMarginRatio();
+            record.m_layers                 = layers;
+            record.m_x                      = pad->GetPosition().x;
+            record.m_y                      = pad->GetPosition().y;
+            record.m_x0                     = pad->GetPos0().x;
+            record.m_y0                     = pad->GetPos0().y;
+            record.m_sizeX                  = pad->GetSize().x;
+            record.m_sizeY                  = pad->GetSize().y;
+            record.m_deltaX                 = pad->GetDelta().x;
+            record.m_deltaY                 = pad->GetDelta().y;
+            record.m_drillX                 = pad->GetDrillSize().x;
+            record.m_drillY                 = pad->GetDrillSize().y;
+            record.m_offsetX                = pad->GetOffset().x;
+            record.m_offsetY                = pad->GetOffset().y;
+            record.m_padToDieLength         = pad->GetPadToDieLength();
+            record.m_solderMaskMargin       = pad->GetLocalSolderMaskMargin();
+            record.m_solderPasteMargin      = pad->GetLocalSolderPasteMargin();
+            record.m_clearance              = pad->GetLocalClearance();
+
+            // What PCB_IO writes, the settings of the module when the pad has none
+            record.m_thermalWidth           = pad->GetThermalWidth();
+            record.m_thermalGap             = pad->GetThermalGap();
+            record.m_zoneConnection         = pad->GetZoneConnection();
+
+            record.m_name                   = addString( pad->GetName() );
+            record.m_net                    = addNet( pad );
+            record.m_shape                  = pad->GetShape();
+            record.m_attribute              = pad->GetAttribute();
+            record.m_drillShape             = pad->GetDrillShape();
+            record.m_anchorShape            = pad->GetAnchorPadShape();
+            record.m_customShapeInZone      = pad->GetCustomShapeInZoneOpt();
+            record.m_firstPrimitive         = m_primitives.size();
+
+            if( pad->GetShape() == PAD_SHAPE_CUSTOM )
+            {
+                for( const PAD_CS_PRIMITIVE& primitive : pad->GetPrimitives() )
+                {
+                    SNAPSHOT_PRIMITIVE shape;
+
+                    shape.m_arcAngle   = primitive.m_ArcAngle;
+                    shape.m_shape      = primitive.m_Shape;
+                    shape.m_thickness  = primitive.m_Thickness;
+                    shape.m_radius     = primitive.m_Radius;
+                    shape.m_startX     = primitive.m_Start.x;
+                    shape.m_startY     = primitive.m_Start.y;
+                    shape.m_endX       = primitive.m_End.x;
+                    shape.m_endY       = primitive.m_End.y;
+                    shape.m_firstPoint = m_points.size();
+                    shape.m_pointCount = primitive.m_Poly.size();
+                    shape.m_reserved   = 0;
+
+                    for( const wxPoint& point : primitive.m_Poly )
+                        addPoint( point.x, point.y );
+
+                    m_primitives.push_back( shape );
+                }
+            }
+
+            record.m_primitiveCount = m_primitives.size() - record.m_firstPrimitive;
+
+            m_pads.push_back( record );
+        }
+
+        moduleRecord.m_padCount = m_pads.size() - moduleRecord.m_firstPad;
+
+        m_modules.push_back( moduleRecord );
+    }
+}
+
+
+void SNAPSHOT_WRITER::AddZones( BOARD* aBoard )
+{
+    for( int ii = 0; ii < aBoard->GetAreaCount(); ++ii )
+    {
+        ZONE_CONTAINER*         zone = aBoard->GetArea( ii );
+        const SHAPE_POLY_SET&   polys = zone->GetFilledPolysList();
+        SNAPSHOT_ZONE           record;
+
+        record.m_firstOutline = m_outlines.size();
+
+        // The outlines PCB_IO writes, without their holes
+        for( int jj = 0; jj < polys.OutlineCount(); ++jj )
+        {
+            const SHAPE_LINE_CHAIN& chain = polys.COutline( jj );
+            SNAPSHOT_OUTLINE        outline;
+
+            if( chain.PointCount() == 0 )
+                continue;
+
+            outline.m_firstPoint = m_points.size();
+            outline.m_pointCount = chain.PointCount();
+
+            for( int kk = 0; kk < chain.PointCount(); ++kk )
+                addPoint( chain.CPoint( kk ).x, chain.CPoint( kk ).y );
+
+            m_outlines.push_back( outline );
+        }
+
+        record.m_outlineCount = m_outlines.size() - record.m_firstOutline;
+        record.m_firstSegment = m_segments.size();
+
+        for( const SEGMENT& fill : zone->FillSegments() )
+        {
+            SNAPSHOT_SEGMENT segment;
+
+            segment.m_startX = fill.m_Start.x;
+            segment.m_startY = fill.m_Start.y;
+            segment.m_endX   = fill.m_End.x;
+            segment.m_endY   = fill.m_End.y;
+
+            m_segments.push_back( segment );
+        }
+
+        record.m_segmentCount = m_segments.size() - record.m_firstSegment;
+
+        m_zones.push_back( record );
+    }
+}
+
+
+/// The size of aVector in bytes
+template <class T>
+static size_t byteSize( const std::vector<T>& aVector )
+{
+    return aVector.size() * sizeof( T );
+}
+
+
+void SNAPSHOT_WRITER::Write( const wxString& aFileName, uint64_t aSourceHash,
+                             uint64_t aSourceSize )
+{
+    const void* data[SECTION_COUNT];
+    size_t      sizes[SECTION_COUNT];
+
+    data[SECTION_TEXT]        = m_text.data();
+    sizes[SECTION_TEXT]       = m_text.size();
+    data[SECTION_STRINGS]     = m_strings.data();
+    sizes[SECTION_STRINGS]    = byteSize( m_strings );
+    data[SECTION_STRING_DATA] = m_stringData.data();
+    sizes[SECTION_STRING_DATA] = m_stringData.size();
+    data[SECTION_TRACKS]      = m_tracks.data();
+    sizes[SECTION_TRACKS]     = byteSize( m_tracks );
+    data[SECTION_VIAS]        = m_vias.data();
+    sizes[SECTION_VIAS]       = byteSize( m_vias );
+    data[SECTION_MODULES]     = m_modules.data();
+    sizes[SECTION_MODULES]    = byteSize( m_modules );
+    data[SECTION_PADS]        = m_pads.data();
+    sizes[SECTION_PADS]       = byteSize( m_pads );
+    data[SECTION_PRIMITIVES]  = m_primitives.data();
+    sizes[SECTION_PRIMITIVES] = byteSize( m_primitives );
+    data[SECTION_ZONES]       = m_zones.data();
+    sizes[SECTION_ZONES]      = byteSize( m_zones );
+    data[SECTION_OUTLINES]    = m_outlines.data();
+    sizes[SECTION_OUTLINES]   = byteSize( m_outlines );
+    data[SECTION_SEGMENTS]    = m_segments.data();
+    sizes[SECTION_SEGMENTS]   = byteSize( m_segments );
+    data[SECTION_POINTS]      = m_points.data();
+    sizes[SECTION_POINTS]     = byteSize( m_points );
+
+    SNAPSHOT_HEADER header;
+
+    memset( &header, 0, sizeof( header ) );
+    memcpy( header.m_magic, snapshotMagic, sizeof( snapshotMagic ) );
+    header.m_byteOrder    = snapshotByteOrder;
+    header.m_version      = SNAPSHOT_VERSION;
+    header.m_boardVersion = SEXPR_BOARD_FILE_VERSION;
+    header.m_sourceHash   = aSourceHash;
+    header.m_sourceSize   = aSourceSize;
+
+    uint64_t offset = sizeof( header );
+
+    for( int section = 0; section < SECTION_COUNT; ++section )
+    {
+        offset = ( offset + 7 ) & ~uint64_t( 7 );
+
+        header.m_sections[section].m_offset = offset;
+        header.m_sections[section].m_size   = sizes[section];
+
+        offset += sizes[section];
+    }
+
+    FILE* fp = wxFopen( aFileName, wxT( "wb" ) );
+
+    if( !fp )
+    {
+        THROW_IO_ERROR( wxString::Format( _( "Unable to open file '%s' for writing" ),
+                                          aFileName.GetData() ) );
+    }
+
+    static const char padding[8] = { 0 };
+    bool ok = fwrite( &header, sizeof( header ), 1, fp ) == 1;
+
+    offset = sizeof( header );
+
+    for( int section = 0; ok && section < SECTION_COUNT; ++section )
+    {
+        size_t pad = header.m_sections[section].m_offset - offset;
+
+        if( pad )
+            ok = fwrite( padding, 1, pad, fp ) == pad;
+
+        if( ok && sizes[section] )
+            ok = fwrite( data[section], 1, sizes[section], fp ) == sizes[section];
+
+        offset = header.m_sections[section].m_offset + sizes[section];
+    }
+
+    if( fclose( fp ) != 0 || !ok )
+    {
+        THROW_IO_ERROR( wxString::Format( _( "Unable to write file '%s'" ),
+                                          aFileName.GetData() ) );
+    }
+}
+
+
+/**
+ * Class SNAPSHOT_READER
+ * gives the checked sections of a mapped snapshot.
+ */
+class SNAPSHOT_READER
+{
+public:
+    SNAPSHOT_READER( const char* aData, size_t aSize, const wxString& aFileName ) :
+        m_data( aData ),
+        m_size( aSize ),
+        m_fileName( aFileName )
+    {
+    }
+
+    const SNAPSHOT_HEADER* Header() const
+    {
+        return reinterpret_cast<const SNAPSHOT_HEADER*>( m_data );
+    }
+
+    /// the records of aSection, and their count in aCount
+    template <class T>
+    const T* Section( int aSection, size_t* aCount ) const
+    {
+        const SNAPSHOT_SECTION& section = Header()->m_sections[aSection];
+
+        if( section.m_offset > m_size || section.m_size > m_size - section.m_offset
+                || section.m_offset % 8 != 0 || section.m_size % sizeof( T ) != 0 )
+            Damaged();
+
+        *aCount = section.m_size / sizeof( T );
+
+        return reinterpret_cast<const T*>( m_data + section.m_offset );
+    }
+
+    /// checks that the range of aCount records from aFirst is within aSize records
+    void CheckRange( uint64_t aFirst, uint64_t aCount, size_t aSize ) const
+    {
+        if( aFirst > aSize || aCount > aSize - aFirst )
+            Damaged();
+    }
+
+    void Damaged() const
+    {
+        THROW_IO_ERROR( wxString::Format( _( "The board snapshot '%s' is damaged" ),
+                                          m_fileName.GetData() ) );
+    }
+
+private:
+    const char*     m_data;
+    size_t          m_size;
+    wxString        m_fileName;
+};
+
+
+SNAPSHOT_PLUGIN::SNAPSHOT_PLUGIN() :
+    PCB_IO( CTL_FOR_BOARD )
+{
+}
+
+
+wxString SNAPSHOT_PLUGIN::SnapshotFileName( const wxString& aFileName )
+{
+    wxFileName fn( aFileName );
+
+    fn.SetExt( SNAPSHOT_FILE_EXTENSION );
+
+    return fn.GetFullPath();
+}
+
+
+void SNAPSHOT_PLUGIN::Save( const wxString& aFileName, BOARD* aBoard,
+                            const PROPERTIES* aProperties )
+{
+    PCB_IO::Save( aFileName, aBoard, aProperties );
+
+    try
+    {
+        SaveSnapshot( aFileName, aBoard );
+    }
+    catch( const IO_ERROR& )
+    {
+        // The snapshot is only a cache: the board is saved without it, for instance in a
+        // directory where it cannot be renamed over an older one
+    }
+}
+
+
+BOARD* SNAPSHOT_PLUGIN::Load( const wxString& aFileName, BOARD* aAppendToMe,
+                              const PROPERTIES* aProperties )
+{
+    if( aAppendToMe )
+        return PCB_IO::Load( aFileName, aAppendToMe, aProperties );
+
+    MAPPED_FILE_LINE_READER reader( aFileName );
+    uint64_t hash = hashContent( reader.Text(), reader.Size() );
+    BOARD*   board = NULL;
+
+    init( aProperties );
+
+    try
+    {
+        board = readSnapshot( aFileName, hash, reader.Size() );
+    }
+    catch( const IO_ERROR& )
+    {
+        // A damaged snapshot is made again below
+    }
+
+    if( !board )
+    {
+        board = loadBoard( &reader, NULL );
+
+        try
+        {
+            writeSnapshot( aFileName, board, hash, reader.Size() );
+        }
+        catch( const IO_ERROR& )
+        {
+            // The snapshot is only a cache: a board of a read only directory loads without
+        }
+    }
+
+    board->SetFileName( aFileName );
+
+    return board;
+}
+
+
+void SNAPSHOT_PLUGIN::SaveSnapshot( const wxString& aFileName, BOARD* aBoard )
+{
+    MAPPED_FILE_LINE_READER reader( aFileName );
+
+    writeSnapshot( aFileName, aBoard, hashContent( reader.Text(), reader.Size() ),
+                   reader.Size() );
+}
+
+
+BOARD* SNAPSHOT_PLUGIN::LoadSnapshot( const wxString& aFileName )
+{
+    MAPPED_FILE_LINE_READER reader( aFileName );
+
+    init( NULL );
+
+    BOARD* board = readSnapshot( aFileName, hashContent( reader.Text(), reader.Size() ),
+                                 reader.Size() );
+
+    if( board )
+        board->SetFileName( aFileName );
+
+    return board;
+}
+
+
+void SNAPSHOT_PLUGIN::writeSnapshot( const wxString& aFileName, BOARD* aBoard,
+                                     uint64_t aSourceHash, uint64_t aSourceSize )
+{
+    SNAPSHOT_WRITER     writer;
+    STRING_FORMATTER    formatter;
+    int                 ctl = m_ctl;
+
+    {
+        LOCALE_IO toggle;
+
+        m_board = aBoard;
+        m_mapping->SetBoard( aBoard );
+        m_out = &formatter;
+        m_ctl = CTL_FOR_SNAPSHOT;
+
+        try
+        {
+            m_out->Print( 0, "(kicad_pcb (version %d) (host pcbnew %s)\n",
+                          SEXPR_BOARD_FILE_VERSION,
+                          formatter.Quotew( GetBuildVersion() ).c_str() );
+
+            Format( aBoard, 1 );
+
+            m_out->Print( 0, ")\n" );
+        }
+        catch( const IO_ERROR& )
+        {
+            m_out = &m_sf;
+            m_ctl = ctl;
+            throw;
+        }
+
+        m_out = &m_sf;
+        m_ctl = ctl;
+    }
+
+    writer.m_text = formatter.GetString();
+    writer.AddTracks( aBoard );
+    writer.AddModules( aBoard );
+    writer.AddZones( aBoard );
+
+    // Written aside then renamed, so that a load never maps a snapshot being written
+    wxString snapshotName = SnapshotFileName( aFileName );
+    wxString tempName = wxFileName::CreateTempFileName( snapshotName );
+
+    if( tempName.IsEmpty() )
+    {
+        THROW_IO_ERROR( wxString::Format( _( "Unable to create a file next to '%s'" ),
+                                          snapshotName.GetData() ) );
+    }
+
+    try
+    {
+        writer.Write( tempName, aSourceHash, aSourceSize );
+    }
+    catch( const IO_ERROR& )
+    {
+        wxRemoveFile( tempName );
+        throw;
+    }
+
+    if( !wxRenameFile( tempName, snapshotName, true ) )
+    {
+        wxRemoveFile( tempName );
+
+        THROW_IO_ERROR( wxString::Format( _( "Unable to rename file '%s' to '%s'" ),
+                                          tempName.GetData(), snapshotName.GetData() ) );
+    }
+}
+
+
+BOARD* SNAPSHOT_PLUGIN::readSnapshot( const wxString& aFileName, uint64_t aSourceHash,
+                                      uint64_t aSourceSize )
+{
+    wxString snapshotName = SnapshotFileName( aFileName );
+
+    if( !wxFileExists( snapshotName ) )
+        return NULL;
+
+    MAPPED_FILE_LINE_READER snapshot( snapshotName );
+    SNAPSHOT_READER         sections( snapshot.Text(), snapshot.Size(), snapshotName );
+    const SNAPSHOT_HEADER*  header = sections.Header();
+
+    if( snapshot.Size() < sizeof( SNAPSHOT_HEADER )
+            || memcmp( header->m_magic, snapshotMagic, sizeof( snapshotMagic ) ) != 0 )
+        sections.Damaged();
+
+    // Made by another build, or of another content of the board file
+    if( header->m_byteOrder != snapshotByteOrder
+            || header->m_version != SNAPSHOT_VERSION
+            || header->m_boardVersion != SEXPR_BOARD_FILE_VERSION
+            || header->m_sourceHash != aSourceHash
+            || header->m_sourceSize != aSourceSize )
+        return NULL;
+
+    size_t textSize, stringCount, stringDataSize, trackCount, viaCount, moduleCount;
+    size_t padCount, primitiveCount, zoneCount, outlineCount, segmentCount, pointCount;
+
+    const char* text       = sections.Section<char>( SECTION_TEXT, &textSize );
+    const SNAPSHOT_STRING* strings = sections.Section<SNAPSHOT_STRING>( SECTION_STRINGS,
+                                                                        &stringCount );
+    const char* stringData = sections.Section<char>( SECTION_STRING_DATA, &stringDataSize );
+    const SNAPSHOT_TRACK* tracks = sections.Section<SNAPSHOT_TRACK>( SECTION_TRACKS,
+                                                                     &trackCount );
+    const SNAPSHOT_VIA* vias = sections.Section<SNAPSHOT_VIA>( SECTION_VIAS, &viaCount );
+    const SNAPSHOT_MODULE* modules = sections.Section<SNAPSHOT_MODULE>( SECTION_MODULES,
+                                                                        &moduleCount );
+    const SNAPSHOT_PAD* pads = sections.Section<SNAPSHOT_PAD>( SECTION_PADS, &padCount );
+    const SNAPSHOT_PRIMITIVE* primitives =
+            sections.Section<SNAPSHOT_PRIMITIVE>( SECTION_PRIMITIVES, &primitiveCount );
+    const SNAPSHOT_ZONE* zones = sections.Section<SNAPSHOT_ZONE>( SECTION_ZONES, &zoneCount );
+    const SNAPSHOT_OUTLINE* outlines = sections.Section<SNAPSHOT_OUTLINE>( SECTION_OUTLINES,
+                                                                           &outlineCount );
+    const SNAPSHOT_SEGMENT* segments = sections.Section<SNAPSHOT_SEGMENT>( SECTION_SEGMENTS,
+                                                                           &segmentCount );
+    const SNAPSHOT_POINT* points = sections.Section<SNAPSHOT_POINT>( SECTION_POINTS,
+                                                                     &pointCount );
+
+    // The strings are converted once, the nets are found once per net name
+    std::vector<wxString>   names( stringCount );
+    std::vector<int>        netCodes( stringCount, -1 );
+
+    for( size_t ii = 0; ii < stringCount; ++ii )
+    {
+        sections.CheckRange( strings[ii].m_offset, strings[ii].m_length, stringDataSize );
+        names[ii] = wxString::FromUTF8( stringData + strings[ii].m_offset,
+                                        strings[ii].m_length );
+    }
+
+    // The rest of the board, parsed in place
+    MEMORY_LINE_READER reader( text, textSize, snapshotName );
+    std::unique_ptr<BOARD> board( loadBoard( &reader, NULL ) );
+    std::shared_ptr<CONNECTIVITY_DATA> connectivity = board->GetConnectivity();
+
+    auto netCode = [&]( uint32_t aNet ) -> int
+    {
+        if( aNet == NO_NET )
+            return NETINFO_LIST::UNCONNECTED;
+
+        sections.CheckRange( aNet, 1, stringCount );
+
+        if( netCodes[aNet] < 0 )
+        {
+            NETINFO_ITEM* net = board->FindNet( names[aNet] );
+
+            if( !net )
+                sections.Damaged();
+
+            netCodes[aNet] = net->GetNet();
+        }
+
+        return netCodes[aNet];
+    };
+
+    auto layer = [&]( int32_t aLayer ) -> PCB_LAYER_ID
+    {
+        if( aLayer < 0 || aLayer >= PCB_LAYER_ID_COUNT )
+            sections.Damaged();
+
+        return PCB_LAYER_ID( aLayer );
+    };
+
+    // The tracks and vias, in the order of the track list
+    size_t trackNdx = 0;
+    size_t viaNdx = 0;
+
+    for( size_t order = 0; order < trackCount + viaCount; ++order )
+    {
+        if( viaNdx < viaCount && vias[viaNdx].m_order == order )
+        {
+            const SNAPSHOT_VIA& record = vias[viaNdx++];
+            VIA*    via = new VIA( board.get() );
+            wxPoint pos( record.m_x, record.m_y );
+
+            via->SetViaType( VIATYPE_T( record.m_viaType ) );
+            via->SetStart( pos );
+            via->SetEnd( pos );
+            via->SetWidth( record.m_width );
+            via->SetDrill( record.m_drill );
+            via->SetLayerPair( layer( record.m_topLayer ), layer( record.m_bottomLayer ) );
+            via->SetNetCode( netCode( record.m_net ), /* aNoAssert */ true );
+            via->SetTimeStamp( (time_t) record.m_timeStamp );
+            via->SetStatus( record.m_status );
+
+            board->Add( via, ADD_APPEND );
+        }
+        else if( trackNdx < trackCount )
+        {
+            const SNAPSHOT_TRACK& record = tracks[trackNdx++];
+            TRACK* track = new TRACK( board.get() );
+
+            track->SetStart( wxPoint( record.m_startX, record.m_startY ) );
+            track->SetEnd( wxPoint( record.m_endX, record.m_endY ) );
+            track->SetWidth( record.m_width );
+            track->SetLayer( layer( record.m_layer ) );
+            track->SetNetCode( netCode( record.m_net ), /* aNoAssert */ true );
+            track->SetTimeStamp( (time_t) record.m_timeStamp );
+            track->SetStatus( record.m_status );
+
+            board->Add( track, ADD_APPEND );
+        }
+        else
+        {
+            sections.Damaged();
+        }
+    }
+
+    if( viaNdx != viaCount )
+        sections.Damaged();
+
+    // The pads, of the modules of the text in the same order
+    MODULE* module = board->m_Modules;
+
+    for( size_t ii = 0; ii < moduleCount; ++ii, module = module->Next() )
+    {
+        const SNAPSHOT_MODULE& moduleRecord = modules[ii];
+
+        sections.CheckRange( moduleRecord.m_reference, 1, stringCount );
+        sections.CheckRange( moduleRecord.m_firstPad, moduleRecord.m_padCount, padCount );
+
+        if( !module || module->GetReference() != names[moduleRecord.m_reference] )
+            sections.Damaged();
+
+        for( size_t jj = 0; jj < moduleRecord.m_padCount; ++jj )
+        {
+            const SNAPSHOT_PAD& record = pads[moduleRecord.m_firstPad + jj];
+            D_PAD*  pad = new D_PAD( module );
+            LSET    layerSet;
+
+            sections.CheckRange( record.m_name, 1, stringCount );
+
+            for( int kk = 0; kk < PCB_LAYER_ID_COUNT; ++kk )
+            {
+                if( record.m_layers & ( uint64_t( 1 ) << kk ) )
+                    layerSet.set( kk );
+            }
+
+            pad->SetName( names[record.m_name] );
+            pad->SetAttribute( PAD_ATTR_T( record.m_attribute ) );
+            pad->SetShape( PAD_SHAPE_T( record.m_shape ) );
+            pad->SetAnchorPadShape( PAD_SHAPE_T( record.m_anchorShape ) );
+            pad->SetCustomShapeInZoneOpt( CUST_PAD_SHAPE_IN_ZONE( record.m_customShapeInZone ) );
+            pad->SetPosition( wxPoint( record.m_x, record.m_y ) );
+            pad->SetPos0( wxPoint( record.m_x0, record.m_y0 ) );
+            pad->SetOrientation( record.m_orientation );
+            pad->SetSize( wxSize( record.m_sizeX, record.m_sizeY ) );
+            pad->SetDelta( wxSize( record.m_deltaX, record.m_deltaY ) );
+            pad->SetDrillShape( PAD_DRILL_SHAPE_T( record.m_drillShape ) );
+            pad->SetDrillSize( wxSize( record.m_drillX, record.m_drillY ) );
+            pad->SetOffset( wxPoint( record.m_offsetX, record.m_offsetY ) );
+            pad->SetLayerSet( layerSet );
+            pad->SetRoundRectRadiusRatio( record.m_roundRectRatio );
+            pad->SetNetCode( netCode( record.m_net ), /* aNoAssert */ true );
+            pad->SetPadToDieLength( record.m_padToDieLength );
+            pad->SetLocalSolderMaskMargin( record.m_solderMaskMargin );
+            pad->SetLocalSolderPasteMargin( record.m_solderPasteMargin );
+            pad->SetLocalSolderPasteMarginRatio( record.m_solderPasteMarginRatio );
+            pad->SetLocalClearance( record.m_clearance );
+            pad->SetZoneConnection( ZoneConnection( record.m_zoneConnection ) );
+            pad->SetThermalWidth( record.m_thermalWidth );
+            pad->SetThermalGap( record.m_thermalGap );
+
+            if( pad->GetShape() == PAD_SHAPE_CUSTOM )
+            {
+                std::vector<PAD_CS_PRIMITIVE> shapes;
+
+                sections.CheckRange( record.m_firstPrimitive, record.m_primitiveCount,
+                                     primitiveCount );
+
+                for( size_t kk = 0; kk < record.m_primitiveCount; ++kk )
+                {
+                    const SNAPSHOT_PRIMITIVE& primitive =
+                            primitives[record.m_firstPrimitive + kk];
+                    PAD_CS_PRIMITIVE shape( STROKE_T( primitive.m_shape ) );
+
+                    sections.CheckRange( primitive.m_firstPoint, primitive.m_pointCount,
+                                         pointCount );
+
+                    shape.m_Thickness = primitive.m_thickness;
+                    shape.m_Radius    = primitive.m_radius;
+                    shape.m_ArcAngle  = primitive.m_arcAngle;
+                    shape.m_Start     = wxPoint( primitive.m_startX, primitive.m_startY );
+                    shape.m_End       = wxPoint( primitive.m_endX, primitive.m_endY );
+
+                    for( size_t ll = 0; ll < primitive.m_pointCount; ++ll )
+                    {
+                        const SNAPSHOT_POINT& point = points[primitive.m_firstPoint + ll];
+                        shape.m_Poly.push_back( wxPoint( point.m_x, point.m_y ) );
+                    }
+
+                    shapes.push_back( shape );
+                }
+
+                pad->SetPrimitives( shapes );
+            }
+
+            module->Add( pad, ADD_APPEND );
+            connectivity->Add( pad );
+        }
+
+        module->CalculateBoundingBox();
+    }
+
+    if( module )
+        sections.Damaged();
+
+    // The fills of the zones of the text, in the same order
+    if( (int) zoneCount != board->GetAreaCount() )
+        sections.Damaged();
+
+    for( size_t ii = 0; ii < zoneCount; ++ii )
+    {
+        const SNAPSHOT_ZONE&    record = zones[ii];
+        ZONE_CONTAINER*         zone = board->GetArea( ii );
+
+        sections.CheckRange( record.m_firstOutline, record.m_outlineCount, outlineCount );
+        sections.CheckRange( record.m_firstSegment, record.m_segmentCount, segmentCount );
+
+        if( record.m_outlineCount == 0 && record.m_segmentCount == 0 )
+            continue;
+
+        if( record.m_outlineCount )
+        {
+            SHAPE_POLY_SET polys;
+
+            for( size_t jj = 0; jj < record.m_outlineCount; ++jj )
+            {
+                const SNAPSHOT_OUTLINE& outline = outlines[record.m_firstOutline + jj];
+
+                sections.CheckRange( outline.m_firstPoint, outline.m_pointCount, pointCount );
+
+                polys.NewOutline();
+
+                // The points as they were, even the repeated ones
+                for( size_t kk = 0; kk < outline.m_pointCount; ++kk )
+                {
+                    const SNAPSHOT_POINT& point = points[outline.m_firstPoint + kk];
+                    polys.Append( point.m_x, point.m_y, -1, -1, true );
+                }
+            }
+
+            zone->AddFilledPolysList( polys );
+        }
+
+        if( record.m_segmentCount )
+        {
+            std::vector<SEGMENT> fills;
+
+            fills.reserve( record.m_segmentCount );
+
+            for( size_t jj = 0; jj < record.m_segmentCount; ++jj )
+            {
+                const SNAPSHOT_SEGMENT& segment = segments[record.m_firstSegment + jj];
+
+                fills.push_back( SEGMENT( wxPoint( segment.m_startX, segment.m_startY ),
+                                          wxPoint( segment.m_endX, segment.m_endY ) ) );
+            }
+
+            zone->AddFillSegments( fills );
+        }
+
+        connectivity->Update( zone );
+    }
+
+    return board.release();
+}
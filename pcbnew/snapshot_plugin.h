@@ -0,0 +1,126 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file snapshot_plugin.h
+ * @brief Binary snapshot cache of the Pcbnew s-expression board files.
+ */
+
+#ifndef SNAPSHOT_PLUGIN_H_
+#define SNAPSHOT_PLUGIN_H_
+
+#include <kicad_plugin.h>
+#include <stdint.h>
+
+
+/**
+ * Class SNAPSHOT_PLUGIN
+ * is a PCB_IO which keeps a binary snapshot of the boards it loads and saves next to their
+ * board file, and loads a board from its snapshot for as long as the board file is the one
+ * the snapshot was made of.
+ *
+ * The snapshot holds the tracks and vias, the pads of the modules and the filled areas of
+ * the zones as flat arrays of records, which refer to their nets, the references of their
+ * modules and the names of the pads through a string table.  The rest of the board is the
+ * s-expression text PCB_IO writes without these items, parsed in place from the mapped
+ * snapshot.  A board loaded from its snapshot saves to the same board file as the board the
+ * snapshot was made of.
+ *
+ * The snapshot is named after its board file with the SNAPSHOT_FILE_EXTENSION extension.
+ * It holds the hash of the content of the board file, and is made again on the next load
+ * when the board file has changed, or when it was made by another version of the plugin or
+ * on a machine of another byte order.
+ */
+class SNAPSHOT_PLUGIN : public PCB_IO
+{
+public:
+
+    //-----<PLUGIN API>---------------------------------------------------------
+
+    const wxString PluginName() const override
+    {
+        return wxT( "KiCad-Snapshot" );
+    }
+
+    /**
+     * Function Save
+     * saves the board file, as PCB_IO does, and the snapshot of \a aBoard next to it.
+     * The board is saved even if its snapshot cannot be.
+     */
+    void Save( const wxString& aFileName, BOARD* aBoard,
+               const PROPERTIES* aProperties = NULL ) override;
+
+    /**
+     * Function Load
+     * loads the board from the snapshot of \a aFileName if it is up to date, or else from
+     * \a aFileName, of which the snapshot is then made again.  A board appended to
+     * \a aAppendToMe is always loaded from the board file.
+     */
+    BOARD* Load( const wxString& aFileName, BOARD* aAppendToMe,
+                 const PROPERTIES* aProperties = NULL ) override;
+
+    //-----</PLUGIN API>--------------------------------------------------------
+
+    SNAPSHOT_PLUGIN();
+
+    /**
+     * Function SaveSnapshot
+     * writes the snapshot of \a aBoard next to its board file \a aFileName, which must hold
+     * \a aBoard as saved by PCB_IO.
+     *
+     * @throw IO_ERROR if the board file cannot be read or the snapshot cannot be written.
+     */
+    void SaveSnapshot( const wxString& aFileName, BOARD* aBoard );
+
+    /**
+     * Function LoadSnapshot
+     * loads the board of \a aFileName from its snapshot.
+     *
+     * @return BOARD* - the board, or NULL if there is no snapshot of the current content of
+     *  \a aFileName.  Caller owns it.
+     * @throw IO_ERROR if the board file cannot be read or the snapshot is damaged.
+     */
+    BOARD* LoadSnapshot( const wxString& aFileName );
+
+    /**
+     * Function SnapshotFileName
+     * returns the name of the snapshot of the board file \a aFileName.
+     */
+    static wxString SnapshotFileName( const wxString& aFileName );
+
+protected:
+
+    /// writes the snapshot of aBoard, for the board file of content hash aSourceHash
+    void writeSnapshot( const wxString& aFileName, BOARD* aBoard, uint64_t aSourceHash,
+                        uint64_t aSourceSize );
+
+    /// reads the snapshot of the board file of content hash aSourceHash, if there is one
+    BOARD* readSnapshot( const wxString& aFileName, uint64_t aSourceHash,
+                         uint64_t aSourceSize );
+};
+
+
+/// The extension of the snapshot files, which replaces the one of their board file.
+#define SNAPSHOT_FILE_EXTENSION     wxT( "kicad_pcb_snapshot" )
+
+#endif  // SNAPSHOT_PLUGIN_H_
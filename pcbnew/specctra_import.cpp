@@ -381,7 +381,11 @@ void SPECCTRA_DB::FromSESSION( BOARD* aBoard )
         THROW_IO_ERROR( _("Session file is missing the \"library_out\" section") );
 
     // delete all the old tracks and vias
-    aBoard->m_Track.DeleteAll();
+    while( TRACK* track = aBoard->m_Track )
+    {
+        aBoard->Remove( track );
+        delete track;
+    }
 
     aBoard->DeleteMARKERs();
 
@@ -233,6 +233,7 @@ void PCB_EDIT_FRAME::OnActionPlugin( wxCommandEvent& aEvent )
         actionPlugin->Run();
 
         currentPcb->m_Status_Pcb = 0;
+        currentPcb->InvalidateItemIndex();
 
         // Get back the undo buffer to fix some modifications
         PICKED_ITEMS_LIST* oldBuffer = NULL;
@@ -43,9 +43,11 @@
 #include <class_module.h>
 #include <class_mire.h>
 #include <connectivity.h>
+#include <dynamic_ratsnest.h>
 #include <collectors.h>
 #include <zones_functions_for_undo_redo.h>
 #include <board_commit.h>
+#include <zone_filler.h>
 #include <confirm.h>
 #include <bitmaps.h>
 #include <hotkeys.h>
@@ -240,12 +242,17 @@ PCB_EDITOR_CONTROL::PCB_EDITOR_CONTROL() :
     m_placeOrigin.reset( new KIGFX::ORIGIN_VIEWITEM( KIGFX::COLOR4D( 0.8, 0.0, 0.0, 1.0 ),
                                                 KIGFX::ORIGIN_VIEWITEM::CIRCLE_CROSS ) );
     m_probingSchToPcb = false;
-    m_slowRatsnest = false;
+
+    // The lines are computed in another thread, they are shown by the GUI thread
+    m_dynamicRatsnest.reset( new DYNAMIC_RATSNEST( [this] () {
+        CallAfter( [this] () { showDynamicRatsnest(); } );
+    } ) );
 }
 
 
 PCB_EDITOR_CONTROL::~PCB_EDITOR_CONTROL()
 {
+    m_dynamicRatsnest->Stop();
 }
 
 
@@ -253,6 +260,10 @@ void PCB_EDITOR_CONTROL::Reset( RESET_REASON aReason )
 {
     m_frame = getEditFrame<PCB_EDIT_FRAME>();
 
+    // The dragged items ratsnest refers to the items of the previous board
+    if( aReason == MODEL_RELOAD )
+        m_dynamicRatsnest->Stop();
+
     if( aReason == MODEL_RELOAD || aReason == GAL_SWITCH )
     {
         m_placeOrigin->SetPosition( getModel<BOARD>()->GetAuxOrigin() );
@@ -311,10 +322,6 @@ bool PCB_EDITOR_CONTROL::Init()
         menu.AddMenu( zoneMenu.get(), false, toolActiveFunctor( DRAWING_TOOL::MODE::ZONE ) );
     }
 
-    m_ratsnestTimer.SetOwner( this );
-    Connect( m_ratsnestTimer.GetId(), wxEVT_TIMER,
-            wxTimerEventHandler( PCB_EDITOR_CONTROL::ratsnestTimer ), NULL, this );
-
     return true;
 }
 
@@ -663,6 +670,7 @@ int PCB_EDITOR_CONTROL::ZoneFill( const TOOL_EVENT& aEvent )
     auto selTool = m_toolMgr->GetTool<SELECTION_TOOL>();
     const auto& selection = selTool->GetSelection();
     auto connectivity = getModel<BOARD>()->GetConnectivity();
+    std::vector<ZONE_CONTAINER*> zones;
 
     BOARD_COMMIT commit( this );
 
@@ -673,10 +681,16 @@ int PCB_EDITOR_CONTROL::ZoneFill( const TOOL_EVENT& aEvent )
         ZONE_CONTAINER* zone = static_cast<ZONE_CONTAINER*> ( item );
 
         commit.Modify( zone );
+        zones.push_back( zone );
+    }
 
-        m_frame->Fill_Zone( zone );
+    wxBusyCursor dummy;     // Shows an hourglass cursor (removed by its destructor)
+
+    ZONE_FILLER filler( getModel<BOARD>() );
+    filler.Fill( zones );
+
+    for( ZONE_CONTAINER* zone : zones )
         zone->SetIsFilled( true );
-    }
 
     commit.Push( _( "Fill Zone" ) );
 
@@ -693,7 +707,6 @@ int PCB_EDITOR_CONTROL::ZoneFillAll( const TOOL_EVENT& aEvent )
     int areaCount = board->GetAreaCount();
     const wxString fmt = _( "Filling zone %d out of %d (net %s)..." );
     wxString msg;
-    bool aborted = false;
 
     // Create a message with a long net name, and build a wxProgressDialog
     // with a correct size to show this long net name
@@ -705,29 +718,38 @@ int PCB_EDITOR_CONTROL::ZoneFillAll( const TOOL_EVENT& aEvent )
                                  wxPD_APP_MODAL | wxPD_ELAPSED_TIME );
 
     BOARD_COMMIT commit( this );
+    std::vector<ZONE_CONTAINER*> zones;
 
     for( int i = 0; i < areaCount; ++i )
     {
         ZONE_CONTAINER* zone = board->GetArea( i );
 
-        msg.Printf( fmt, i, areaCount, GetChars( zone->GetNetname() ) );
-
         commit.Modify( zone );
+        zones.push_back( zone );
+    }
 
-        if( !progressDialog->Update( i, msg ) )
-        {
-            aborted = true;
-            break;  // Aborted by user
-        }
+    // The zones are computed in parallel, and applied to the board one after the other
+    ZONE_FILLER filler( board );
 
-        m_frame->Fill_Zone( zone );
-        zone->SetIsFilled( true );
-    }
+    filler.SetProgressCallback( [&]( int aIndex, int aCount, ZONE_CONTAINER* aZone ) -> bool
+    {
+        msg.Printf( fmt, aIndex, aCount, GetChars( aZone->GetNetname() ) );
+
+        return progressDialog->Update( aIndex, msg );
+    } );
+
+    if( filler.Fill( zones ) )
+    {
+        for( ZONE_CONTAINER* zone : zones )
+            zone->SetIsFilled( true );
 
-    if( aborted )
-        commit.Revert();
-    else
         commit.Push( _( "Fill All Zones" ) );
+    }
+    else
+    {
+        // Aborted by user
+        commit.Revert();
+    }
 
     connectivity->RecalculateRatsnest();
     progressDialog->Destroy();
@@ -1167,28 +1189,22 @@ int PCB_EDITOR_CONTROL::UpdateSelectionRatsnest( const TOOL_EVENT& aEvent )
 
     if( selection.Empty() )
     {
-        connectivity->ClearDynamicRatsnest();
-    }
-    else if( m_slowRatsnest )
-    {
-        // Compute ratsnest only when user stops dragging for a moment
-        connectivity->HideDynamicRatsnest();
-        m_ratsnestTimer.Start( 20 );
+        clearDynamicRatsnest();
+        return 0;
     }
-    else
+
+    std::vector<BOARD_ITEM*> items;
+    items.reserve( selection.Size() );
+
+    for( auto item : selection )
+        items.push_back( static_cast<BOARD_ITEM*>( item ) );
+
+    // The ratsnest of the items is prepared once, then only their positions are
+    // given to the ratsnest thread while they are dragged
+    if( !m_dynamicRatsnest->Update( connectivity, items ) )
     {
-        // Check how much time doest it take to calculate ratsnest
-        PROF_COUNTER counter;
-        calculateSelectionRatsnest();
-        counter.Stop();
-
-        // If it is too slow, then switch to 'slow ratsnest' mode when
-        // ratsnest is calculated when user stops dragging items for a moment
-        if( counter.msecs() > 25 )
-        {
-            m_slowRatsnest = true;
-            connectivity->HideDynamicRatsnest();
-        }
+        connectivity->ClearDynamicRatsnest();
+        m_dynamicRatsnest->Start( connectivity, items );
     }
 
     return 0;
@@ -1197,34 +1213,38 @@ int PCB_EDITOR_CONTROL::UpdateSelectionRatsnest( const TOOL_EVENT& aEvent )
 
 int PCB_EDITOR_CONTROL::HideSelectionRatsnest( const TOOL_EVENT& aEvent )
 {
-    getModel<BOARD>()->GetConnectivity()->ClearDynamicRatsnest();
-    m_slowRatsnest = false;
+    clearDynamicRatsnest();
     return 0;
 }
 
 
-void PCB_EDITOR_CONTROL::ratsnestTimer( wxTimerEvent& aEvent )
+void PCB_EDITOR_CONTROL::showDynamicRatsnest()
 {
-    m_ratsnestTimer.Stop();
-    calculateSelectionRatsnest();
-    static_cast<PCB_DRAW_PANEL_GAL*>( m_frame->GetGalCanvas() )->RedrawRatsnest();
-    m_frame->GetGalCanvas()->Refresh();
+    auto panel = static_cast<PCB_DRAW_PANEL_GAL*>( m_frame->GetGalCanvas() );
+    auto ratsnest = panel->GetRatsnestItem();
+
+    if( ratsnest && m_dynamicRatsnest->SwapLines( m_dynamicLines ) )
+    {
+        ratsnest->SwapDynamicLines( m_dynamicLines );
+        panel->RedrawRatsnest();
+        panel->Refresh();
+    }
 }
 
 
-void PCB_EDITOR_CONTROL::calculateSelectionRatsnest()
+void PCB_EDITOR_CONTROL::clearDynamicRatsnest()
 {
-    auto selectionTool = m_toolMgr->GetTool<SELECTION_TOOL>();
-    auto& selection = selectionTool->GetSelection();
-    auto connectivity = board()->GetConnectivity();
-
-    std::vector<BOARD_ITEM*> items;
-    items.reserve( selection.Size() );
+    m_dynamicRatsnest->Stop();
+    getModel<BOARD>()->GetConnectivity()->ClearDynamicRatsnest();
 
-    for( auto item : selection )
-        items.push_back( static_cast<BOARD_ITEM*>( item ) );
+    auto panel = static_cast<PCB_DRAW_PANEL_GAL*>( m_frame->GetGalCanvas() );
+    auto ratsnest = panel->GetRatsnestItem();
 
-    connectivity->ComputeDynamicRatsnest( items );
+    if( ratsnest )
+    {
+        m_dynamicLines.clear();
+        ratsnest->SwapDynamicLines( m_dynamicLines );
+    }
 }
 
 
@@ -26,12 +26,14 @@
 #define PCB_EDITOR_CONTROL_H
 
 #include <tools/pcb_tool.h>
+#include <connectivity.h>
 
 namespace KIGFX {
     class ORIGIN_VIEWITEM;
 }
 
 class PCB_EDIT_FRAME;
+class DYNAMIC_RATSNEST;
 
 /**
  * Class PCB_EDITOR_CONTROL
@@ -112,11 +114,11 @@ public:
     int ShowLocalRatsnest( const TOOL_EVENT& aEvent );
 
 private:
-    ///> Event handler to recalculate dynamic ratsnest
-    void ratsnestTimer( wxTimerEvent& aEvent );
+    ///> Shows the dynamic ratsnest lines computed last, called in the GUI thread
+    void showDynamicRatsnest();
 
-    ///> Recalculates dynamic ratsnest for the current selection
-    void calculateSelectionRatsnest();
+    ///> Clears the dynamic ratsnest lines shown
+    void clearDynamicRatsnest();
 
     ///> Sets up handlers for various events.
     void setTransitions() override;
@@ -130,11 +132,11 @@ private:
     ///> Flag to ignore a single crossprobe message from eeschema.
     bool m_probingSchToPcb;
 
-    ///> Flag to indicate whether the current selection ratsnest is slow to calculate.
-    bool m_slowRatsnest;
+    ///> Computes the ratsnest of the dragged items in the background.
+    std::unique_ptr<DYNAMIC_RATSNEST> m_dynamicRatsnest;
 
-    ///> Timer that start ratsnest calculation when it is slow to compute.
-    wxTimer m_ratsnestTimer;
+    ///> The dynamic ratsnest lines exchanged with the ones shown.
+    std::vector<RN_DYNAMIC_LINE> m_dynamicLines;
 
     ///> How to modify a property for selected items.
     enum MODIFY_MODE { ON, OFF, TOGGLE };
@@ -265,10 +265,9 @@ int PCB_EDIT_FRAME::EraseRedundantTrack( wxDC*              aDC,
 
                     if( aItemsListPicker )
                     {
-                        pt_del->UnLink();
+                        GetBoard()->Remove( pt_del );
                         pt_del->SetStatus( 0 );
                         pt_del->ClearFlags();
-                        GetBoard()->GetConnectivity()->Remove( pt_del );
                         ITEM_PICKER picker( pt_del, UR_DELETED );
                         aItemsListPicker->PushItem( picker );
                     }
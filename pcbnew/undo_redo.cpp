@@ -46,6 +46,8 @@ using namespace std::placeholders;
 #include <class_edge_mod.h>
 
 #include <connectivity.h>
+#include <drc_stuff.h>
+#include <zone_obstacle_cache.h>
 
 #include <tools/selection_tool.h>
 #include <tool/tool_manager.h>
@@ -265,6 +267,11 @@ void PCB_BASE_EDIT_FRAME::SaveCopyInUndoList( const PICKED_ITEMS_LIST& aItemsLis
 
         wxASSERT( item );
 
+        // The legacy tools save the items they change in place before or after
+        // changing them, outside of the commits
+        if( command != UR_NEW && command != UR_DELETED )
+            GetBoard()->UpdateItemIndex( item );
+
         switch( command )
         {
         case UR_CHANGED:
@@ -390,6 +397,9 @@ void PCB_BASE_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool
 
     bool build_item_list = true;    // if true the list of existing items must be rebuilt
 
+    std::vector<BOARD_ITEM*> changedItems;  // the items to be checked again by the live DRC
+    ZONE_OBSTACLE_CACHE* obstacles = GetBoard()->GetZoneObstacleCache();
+
     // Restore changes in reverse order
     for( int ii = aList->GetCount() - 1; ii >= 0 ; ii-- )
     {
@@ -428,6 +438,7 @@ void PCB_BASE_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool
         }
 
         item->ClearFlags();
+        changedItems.push_back( item );
 
         // see if we must rebuild ratsnets and pointers lists
         switch( item->Type() )
@@ -453,6 +464,12 @@ void PCB_BASE_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool
         // It is possible that we are going to replace the selected item, so clear it
         SetCurItem( NULL );
 
+        // The zone fills depend on the item areas before and after the change
+        if( status == UR_CHANGED )
+            obstacles->AddDirtyItem( item, (BOARD_ITEM*) aList->GetPickedItemLink( ii ) );
+        else
+            obstacles->AddDirtyItem( item );
+
         switch( aList->GetPickedItemStatus( ii ) )
         {
         case UR_CHANGED:    /* Exchange old and new data for each item */
@@ -550,6 +567,13 @@ void PCB_BASE_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool
         }
         break;
         }
+
+        if( status != UR_CHANGED )
+            obstacles->AddDirtyItem( item );
+
+        // New and deleted items went through BOARD::Remove() and BOARD::Add()
+        if( status != UR_NEW && status != UR_DELETED )
+            GetBoard()->UpdateItemIndex( item );
     }
 
     if( not_found )
@@ -561,6 +585,21 @@ void PCB_BASE_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool
     {
         Compile_Ratsnest( NULL, false );
     }
+
+    // Drop the zone fill polygons of the restored items
+    for( BOARD_ITEM* changed : changedItems )
+        obstacles->Invalidate( changed );
+
+    if( IsType( FRAME_PCB ) )
+        static_cast<PCB_EDIT_FRAME*>( this )->RefillChangedZones();
+
+    // The live DRC finds by itself whether the items are still on the board
+    if( IsType( FRAME_PCB ) )
+    {
+        DRC* drc = static_cast<PCB_EDIT_FRAME*>( this )->GetDrcController();
+        drc->UpdateLiveDrc( std::vector<BOARD_ITEM*>(), changedItems,
+                            std::vector<BOARD_ITEM*>() );
+    }
 }
 
 
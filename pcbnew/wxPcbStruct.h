@@ -1426,6 +1426,13 @@ public:
      */
     int Fill_All_Zones( wxWindow * aActiveWindow, bool aVerbose = true );
 
+    /**
+     * Function RefillChangedZones
+     * updates the filled zones around the board changes made since their last fill,
+     * when the AutoRefillZones setting is on. Called after each commit, undo and redo.
+     */
+    void RefillChangedZones();
+
 
     /**
      * Function Add_Zone_Cutout
@@ -0,0 +1,275 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <unordered_set>
+
+#include <fctsys.h>
+#include <profile.h>
+#include <thread_pool.h>
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_zone.h>
+
+#include <zone_filler.h>
+#include <zone_obstacle_cache.h>
+
+
+ZONE_FILLER::ZONE_FILLER( BOARD* aBoard ) :
+    m_board( aBoard ),
+    m_incremental( false ),
+    m_partitioned( false )
+{
+}
+
+
+bool ZONE_FILLER::Fill( const std::vector<ZONE_CONTAINER*>& aZones )
+{
+    THREAD_POOL& pool = THREAD_POOL::GetInstance();
+    int count = aZones.size();
+
+    m_stats.assign( count, ZONE_FILL_STATS() );
+
+    // The thermal reliefs reach out of the pads by the thermal gap and, for the ends of
+    // the spokes, by the spoke width, which the pads may set for themselves
+    int padThermalReach = 0;
+
+    // GetBoundingRadius() caches the radius, which must be done before the pads are
+    // read from several threads
+    for( MODULE* module = m_board->m_Modules; module; module = module->Next() )
+    {
+        for( D_PAD* pad = module->PadsList(); pad; pad = pad->Next() )
+        {
+            pad->GetBoundingRadius();
+            padThermalReach = std::max( padThermalReach,
+                                        pad->GetThermalGap() + pad->GetThermalWidth() );
+        }
+    }
+
+    int biggestClearance = m_board->GetDesignSettings().GetBiggestClearanceValue();
+
+    // The computations read the smoothed outlines of the knockout zones: build them now,
+    // with the smoothed outlines of the zones to fill (which may be knockouts of others).
+    // Each zone is computed on a copy, so the zones on the board keep their filled areas
+    // (and can be drawn) until the results are applied.
+    ZONE_OBSTACLE_CACHE* obstacles = m_board->GetZoneObstacleCache();
+    std::vector<std::unique_ptr<ZONE_CONTAINER>> work( count );
+    std::vector<std::vector<EDA_RECT>> dirtyAreas( count );
+    std::vector<bool> keep( count, false );
+    std::unordered_set<ZONE_CONTAINER*> smoothed;
+    bool compute = false;
+
+    for( int ii = 0; ii < count; ++ii )
+    {
+        ZONE_CONTAINER* zone = aZones[ii];
+
+        m_stats[ii].m_zone = zone;
+
+        if( zone->GetIsKeepout() )
+            continue;
+
+        bool update = m_incremental && zone->IsFilled() && zone->CanUpdateFilledAreas()
+                      && zone->GetFillSerial() >= obstacles->GetPrunedSerial();
+
+        if( update )
+        {
+            // The board changes which can reach the fill: the items within the largest
+            // clearance of the board, and the pads within reach of a thermal relief
+            int thermalReach = std::max( padThermalReach, zone->GetThermalReliefGap()
+                                         + zone->GetThermalReliefCopperBridge() );
+            int margin = std::max( biggestClearance, zone->GetClearance() )
+                         + zone->GetMinThickness() / 2 + thermalReach + 1;
+            EDA_RECT zoneArea = zone->GetBoundingBox();
+
+            zoneArea.Inflate( margin );
+            obstacles->GetDirtyAreas( zone->GetFillSerial(), zone->GetLayer(), zoneArea,
+                                      dirtyAreas[ii] );
+
+            for( EDA_RECT& area : dirtyAreas[ii] )
+                area.Inflate( margin );
+
+            m_stats[ii].m_incremental = true;
+            m_stats[ii].m_dirtyAreaCount = dirtyAreas[ii].size();
+
+            // The islands depend on the items of the zone net, wherever they are
+            if( dirtyAreas[ii].empty() && ( zone->GetNetCode() <= 0
+                    || !obstacles->IsNetDirty( zone->GetFillSerial(), zone->GetNetCode() ) ) )
+            {
+                keep[ii] = true;
+                zone->SetFillSerial( obstacles->GetDirtySerial() );
+                m_stats[ii].m_filled = true;
+                m_stats[ii].m_kept = true;
+                continue;
+            }
+        }
+
+        // Cannot fill malformed zones
+        if( !zone->BuildSmoothedPoly() )
+            continue;
+
+        smoothed.insert( zone );
+
+        if( zone->IsOnCopperLayer() )
+        {
+            std::vector<ZONE_CONTAINER*> knockouts;
+
+            zone->GetKnockoutZones( m_board, knockouts );
+
+            for( ZONE_CONTAINER* knockout : knockouts )
+            {
+                if( smoothed.insert( knockout ).second )
+                    knockout->BuildSmoothedPoly();
+            }
+        }
+
+        // The copy keeps the filled areas to update
+        work[ii].reset( new ZONE_CONTAINER( *zone ) );
+
+        if( !update )
+            work[ii]->UnFill();
+
+        compute = true;
+    }
+
+    // The zones only visit the pads and tracks near them, and share their polygons.
+    // The board is not modified until all the computations are done.
+    if( compute )
+        obstacles->BuildIndex( m_board );
+
+    // Compute the filled areas, in the zone order so that the first ones are ready first
+    std::atomic<bool> cancelled( false );
+    std::vector<std::future<bool>> computed( count );
+
+    for( int ii = 0; ii < count; ++ii )
+    {
+        if( !work[ii] )
+            continue;
+
+        ZONE_CONTAINER*        zone = work[ii].get();
+        ZONE_FILL_STATS*       stats = &m_stats[ii];
+        BOARD*                 board = m_board;
+        std::vector<EDA_RECT>* areas = &dirtyAreas[ii];
+        bool                   keepState = m_incremental;
+        bool                   partitioned = m_partitioned;
+
+        computed[ii] = pool.Submit( [zone, stats, board, areas, keepState, partitioned,
+                                     &cancelled]() -> bool
+        {
+            if( cancelled )
+                return false;
+
+            unsigned start = GetRunningMicroSecs();
+
+            zone->BuildSmoothedPoly();
+
+            if( stats->m_incremental )
+                zone->UpdateFilledAreas( board, *areas, partitioned );
+            else
+                zone->ComputeFilledAreas( board, keepState, partitioned );
+
+            stats->m_computeTime = GetRunningMicroSecs() - start;
+
+            return true;
+        } );
+    }
+
+    // Apply the results, in the zone order
+    bool aborted = false;
+
+    try
+    {
+        for( int ii = 0; ii < count; ++ii )
+        {
+            ZONE_CONTAINER* zone = aZones[ii];
+
+            if( m_progress && !m_progress( ii, count, zone ) )
+            {
+                aborted = true;
+                break;
+            }
+
+            if( keep[ii] )
+                continue;
+
+            zone->UnFill();
+
+            if( !work[ii] )
+                continue;
+
+            pool.Wait( computed[ii] );
+
+            if( !computed[ii].get() )
+                continue;
+
+            unsigned start = GetRunningMicroSecs();
+
+            zone->CopyComputedFill( *work[ii] );
+
+            m_stats[ii].m_filled = zone->FinishFilledAreas( m_board );
+            m_stats[ii].m_finishTime = GetRunningMicroSecs() - start;
+        }
+    }
+    catch( ... )
+    {
+        // The pending computations use the copies: let them end before leaving
+        cancelled = true;
+
+        for( std::future<bool>& result : computed )
+        {
+            if( result.valid() )
+                pool.Wait( result );
+        }
+
+        obstacles->ClearIndex();
+        throw;
+    }
+
+    cancelled = aborted;
+
+    for( std::future<bool>& result : computed )
+    {
+        if( result.valid() )
+            pool.Wait( result );
+    }
+
+    obstacles->ClearIndex();
+
+    // Forget the changes seen by all the zones which can be refilled incrementally
+    unsigned seen = obstacles->GetDirtySerial();
+
+    for( int ii = 0; ii < m_board->GetAreaCount(); ++ii )
+    {
+        ZONE_CONTAINER* zone = m_board->GetArea( ii );
+
+        if( zone->IsFilled() && zone->CanUpdateFilledAreas() )
+            seen = std::min( seen, zone->GetFillSerial() );
+    }
+
+    obstacles->PruneDirtyAreas( seen );
+
+    return !aborted;
+}
@@ -0,0 +1,148 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef ZONE_FILLER_H
+#define ZONE_FILLER_H
+
+#include <functional>
+#include <vector>
+
+class BOARD;
+class ZONE_CONTAINER;
+
+
+/**
+ * Struct ZONE_FILL_STATS
+ * the time spent filling a zone.
+ */
+struct ZONE_FILL_STATS
+{
+    ZONE_FILL_STATS() :
+        m_zone( nullptr ),
+        m_filled( false ),
+        m_incremental( false ),
+        m_kept( false ),
+        m_dirtyAreaCount( 0 ),
+        m_computeTime( 0 ),
+        m_finishTime( 0 )
+    {
+    }
+
+    ZONE_CONTAINER* m_zone;
+    bool            m_filled;       ///< false for keepouts, malformed and aborted zones
+    bool            m_incremental;  ///< only the areas changed since the last fill were updated
+    bool            m_kept;         ///< nothing changed around the zone: its fill was kept
+    int             m_dirtyAreaCount;   ///< number of changed areas, for an incremental fill
+    unsigned        m_computeTime;  ///< filled areas computation, in microseconds
+    unsigned        m_finishTime;   ///< islands removal and fill segments, in microseconds
+};
+
+
+/**
+ * Class ZONE_FILLER
+ *
+ * Fills a set of zones using all the cores.
+ *
+ * The filled areas of a zone depend on the board items and on the outlines of its knockout
+ * zones, but not on the filled areas of other zones: once the smoothed outlines are built,
+ * the filled areas of all zones are computed concurrently. Each zone is computed on a copy,
+ * so the board is left untouched until the result is applied.
+ *
+ * The removal of insulated copper islands goes through the board connectivity, and its
+ * result depends on the zones already refilled. It runs on the calling thread, in the order
+ * of the given zones, as the computed areas become available. The fill is thus identical
+ * to filling the zones one after the other.
+ *
+ * During the fill, the board ZONE_OBSTACLE_CACHE indexes the pads and tracks, and keeps
+ * their polygons for the next zones and the next fills.
+ *
+ * In incremental mode, the zones filled since the last change of their outline and
+ * settings only recompute the areas where the board changed since their last fill, as
+ * recorded by the ZONE_OBSTACLE_CACHE. The zones with no change nearby, nor on their net,
+ * keep their filled areas as they are.
+ */
+class ZONE_FILLER
+{
+public:
+    /**
+     * Called on the calling thread before each zone is applied to the board.
+     * @return false to abort the fill
+     */
+    typedef std::function<bool( int aIndex, int aCount, ZONE_CONTAINER* aZone )> PROGRESS_FUNC;
+
+    ZONE_FILLER( BOARD* aBoard );
+
+    void SetProgressCallback( const PROGRESS_FUNC& aCallback )
+    {
+        m_progress = aCallback;
+    }
+
+    /**
+     * Function SetIncremental
+     * enables the update of the filled areas around the board changes only, when possible.
+     * Off by default: all the zones are filled from scratch, and do not keep the state
+     * needed by a later incremental fill. In incremental mode, the zones filled from
+     * scratch keep it for the next incremental fill.
+     */
+    void SetIncremental( bool aIncremental )
+    {
+        m_incremental = aIncremental;
+    }
+
+    /**
+     * Function SetPartitioned
+     * computes the separate parts of large zones in parallel, with the partitioned polygon
+     * modes of SHAPE_POLY_SET. Off by default: the polygons are then not exactly the same,
+     * a vertex may move by one unit and the polygons come in another order.
+     */
+    void SetPartitioned( bool aPartitioned )
+    {
+        m_partitioned = aPartitioned;
+    }
+
+    /**
+     * Function Fill
+     * refills aZones. Keepout zones are only unfilled.
+     * @return false if aborted by the progress callback. The zones not reached then keep
+     * their previous filled areas.
+     */
+    bool Fill( const std::vector<ZONE_CONTAINER*>& aZones );
+
+    /**
+     * Function GetStats
+     * @return the timings of the last Fill(), one entry per zone, in the same order.
+     */
+    const std::vector<ZONE_FILL_STATS>& GetStats() const
+    {
+        return m_stats;
+    }
+
+private:
+    BOARD*                       m_board;
+    bool                         m_incremental;
+    bool                         m_partitioned;
+    PROGRESS_FUNC                m_progress;
+    std::vector<ZONE_FILL_STATS> m_stats;
+};
+
+#endif  // ZONE_FILLER_H
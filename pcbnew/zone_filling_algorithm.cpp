@@ -62,6 +62,34 @@ bool ZONE_CONTAINER::BuildFilledSolidAreasPolygons( BOARD* aPcb, SHAPE_POLY_SET*
      * this zone
      */
 
+    if( !BuildSmoothedPoly() )
+        return false;
+
+    if( aOutlineBuffer )
+    {
+        aOutlineBuffer->Append( *m_smoothedPoly );
+        return true;
+    }
+
+    // The outlines of the knockout zones are removed from the filled areas
+    if( IsOnCopperLayer() )
+    {
+        std::vector<ZONE_CONTAINER*> knockouts;
+
+        GetKnockoutZones( aPcb, knockouts );
+
+        for( ZONE_CONTAINER* zone : knockouts )
+            zone->BuildSmoothedPoly();
+    }
+
+    ComputeFilledAreas( aPcb );
+
+    return FinishFilledAreas( aPcb );
+}
+
+
+bool ZONE_CONTAINER::BuildSmoothedPoly()
+{
     if( GetNumCorners() <= 2 )  // malformed zone. polygon calculations do not like it ...
         return false;
 
@@ -95,43 +123,65 @@ bool ZONE_CONTAINER::BuildFilledSolidAreasPolygons( BOARD* aPcb, SHAPE_POLY_SET*
         break;
     }
 
-    if( aOutlineBuffer )
-        aOutlineBuffer->Append( *m_smoothedPoly );
+    return true;
+}
+
 
+void ZONE_CONTAINER::ComputeFilledAreas( BOARD* aPcb, bool aKeepFillState, bool aPartitioned )
+{
     /* For copper layers, we now must add holes in the Polygon list.
      * holes are pads and tracks with their clearance area
      * For non copper layers, just recalculate the m_FilledPolysList
      * with m_ZoneMinThickness taken in account
      */
+    m_FilledPolysList.RemoveAllContours();
+
+    if( IsOnCopperLayer() )
+    {
+        AddClearanceAreasPolygonsToPolysList_NG( aPcb, aKeepFillState, aPartitioned );
+    }
     else
     {
-        m_FilledPolysList.RemoveAllContours();
+        // Only the copper zones are updated by UpdateFilledAreas()
+        storeFillState( aPcb, nullptr );
 
-        if( IsOnCopperLayer() )
-        {
-            AddClearanceAreasPolygonsToPolysList_NG( aPcb );
+        m_FilledPolysList = *m_smoothedPoly;
 
-            if( m_FillMode )   // if fill mode uses segments, create them:
-            {
-                if( !FillZoneAreasWithSegments() )
-                    return false;
-            }
-        }
-        else
+        // The filled areas are deflated by -m_ZoneMinThickness / 2, because
+        // the outlines are drawn with a line thickness = m_ZoneMinThickness to
+        // give a good shape with the minimal thickness
+        m_FilledPolysList.Inflate( -m_ZoneMinThickness / 2, 16 );
+        m_FilledPolysList.Fracture( SHAPE_POLY_SET::PM_FAST );
+    }
+}
+
+
+bool ZONE_CONTAINER::FinishFilledAreas( BOARD* aPcb )
+{
+    if( IsOnCopperLayer() )
+    {
+        // After UpdateFilledAreas() too, all the filled polygons are tested, not only the
+        // ones crossing the changed areas. A polygon is an island when no pad can be reached
+        // from it through the copper of its net: tracks, vias and the polygons of this zone
+        // and of the other zones of the net. A polygon far from the changes can be reached
+        // through a polygon which was split or removed by them, or through a track of the
+        // net edited anywhere on the board, so its previous state cannot be kept.
+        if( GetNetCode() > 0 )
+            TestForCopperIslandAndRemoveInsulatedIslands( aPcb );
+
+        if( m_FillMode )   // if fill mode uses segments, create them:
         {
-            m_FillMode = 0;     // Fill by segments is no more used in non copper layers
-                                // force use solid polygons (usefull only for old boards)
-            m_FilledPolysList = *m_smoothedPoly;
-
-            // The filled areas are deflated by -m_ZoneMinThickness / 2, because
-            // the outlines are drawn with a line thickness = m_ZoneMinThickness to
-            // give a good shape with the minimal thickness
-            m_FilledPolysList.Inflate( -m_ZoneMinThickness / 2, 16 );
-            m_FilledPolysList.Fracture( SHAPE_POLY_SET::PM_FAST );
+            if( !FillZoneAreasWithSegments() )
+                return false;
         }
-
-        m_IsFilled = true;
     }
+    else
+    {
+        m_FillMode = 0;     // Fill by segments is no more used in non copper layers
+                            // force use solid polygons (usefull only for old boards)
+    }
+
+    m_IsFilled = true;
 
     return true;
 }
@@ -0,0 +1,509 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <unordered_set>
+
+#include <class_board.h>
+#include <class_board_design_settings.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <drc_item_index.h>
+
+#include <zone_obstacle_cache.h>
+
+
+bool ZONE_OBSTACLE_CACHE::ITEM_GEOMETRY::operator==( const ITEM_GEOMETRY& aOther ) const
+{
+    return m_type == aOther.m_type
+        && m_shape == aOther.m_shape
+        && m_start == aOther.m_start
+        && m_end == aOther.m_end
+        && m_size == aOther.m_size
+        && m_delta == aOther.m_delta
+        && m_orient == aOther.m_orient
+        && m_cornerRadius == aOther.m_cornerRadius
+        && m_drill == aOther.m_drill
+        && m_drillShape == aOther.m_drillShape;
+}
+
+
+ZONE_OBSTACLE_CACHE::ZONE_OBSTACLE_CACHE( BOARD* aBoard ) :
+    m_board( aBoard ),
+    m_hits( 0 ),
+    m_misses( 0 ),
+    m_indexValid( false ),
+    m_padCount( 0 ),
+    m_dirtySerial( 0 ),
+    m_prunedSerial( 0 )
+{
+    for( int layer = 0; layer < PCB_LAYER_ID_COUNT; ++layer )
+        m_trees[layer] = IsCopperLayer( layer ) ? new ITEM_TREE : nullptr;
+}
+
+
+ZONE_OBSTACLE_CACHE::~ZONE_OBSTACLE_CACHE()
+{
+    for( int layer = 0; layer < PCB_LAYER_ID_COUNT; ++layer )
+        delete m_trees[layer];
+}
+
+
+ZONE_OBSTACLE_CACHE::ITEM_GEOMETRY ZONE_OBSTACLE_CACHE::itemGeometry(
+        const BOARD_CONNECTED_ITEM* aItem )
+{
+    ITEM_GEOMETRY geometry;
+
+    geometry.m_type = aItem->Type();
+    geometry.m_shape = 0;
+    geometry.m_orient = 0.0;
+    geometry.m_cornerRadius = 0;
+    geometry.m_drillShape = 0;
+
+    if( aItem->Type() == PCB_PAD_T )
+    {
+        const D_PAD* pad = static_cast<const D_PAD*>( aItem );
+
+        geometry.m_shape = pad->GetShape();
+        geometry.m_start = pad->GetPosition();
+        geometry.m_end = pad->ShapePos();
+        geometry.m_size = pad->GetSize();
+        geometry.m_delta = pad->GetDelta();
+        geometry.m_orient = pad->GetOrientation();
+
+        if( pad->GetShape() == PAD_SHAPE_ROUNDRECT )
+            geometry.m_cornerRadius = pad->GetRoundRectCornerRadius();
+
+        geometry.m_drill = pad->GetDrillSize();
+        geometry.m_drillShape = pad->GetDrillShape();
+    }
+    else
+    {
+        const TRACK* track = static_cast<const TRACK*>( aItem );
+
+        geometry.m_start = track->GetStart();
+        geometry.m_end = track->GetEnd();
+        geometry.m_size = wxSize( track->GetWidth(), 0 );
+    }
+
+    return geometry;
+}
+
+
+EDA_RECT ZONE_OBSTACLE_CACHE::itemArea( const BOARD_CONNECTED_ITEM* aItem, int aHoleClearance )
+{
+    // The bounding box used by the zone fill tests, inflated by the item dependent
+    // part of the margins they add to it
+    EDA_RECT bbox = aItem->GetBoundingBox();
+
+    if( aItem->Type() == PCB_PAD_T )
+    {
+        const D_PAD* pad = static_cast<const D_PAD*>( aItem );
+        int margin = std::max( pad->GetClearance(), pad->GetThermalGap() );
+        wxSize drill = pad->GetDrillSize();
+
+        if( drill.x || drill.y )
+        {
+            EDA_RECT hole( pad->GetPosition(), wxSize( 0, 0 ) );
+            hole.Inflate( std::max( drill.x, drill.y ) / 2 + 1 );
+            bbox.Merge( hole );
+            margin = std::max( margin, aHoleClearance );
+        }
+
+        bbox.Inflate( margin );
+    }
+
+    bbox.Normalize();
+
+    return bbox;
+}
+
+
+ZONE_OBSTACLE_CACHE::FRAGMENT_PTR ZONE_OBSTACLE_CACHE::GetFragment(
+        const BOARD_CONNECTED_ITEM* aItem, FRAGMENT_KIND aKind, int aClearance,
+        int aSegsPerCircle, const BUILD_FUNC& aBuild )
+{
+    bool cached = aKind == FK_HOLE || aItem->Type() != PCB_PAD_T
+                  || static_cast<const D_PAD*>( aItem )->GetShape() != PAD_SHAPE_CUSTOM;
+
+    ITEM_GEOMETRY geometry;
+    BUCKET& itemBucket = bucket( aItem );
+
+    if( cached )
+    {
+        geometry = itemGeometry( aItem );
+
+        std::lock_guard<std::mutex> lock( itemBucket.m_lock );
+        auto it = itemBucket.m_entries.find( aItem );
+
+        if( it != itemBucket.m_entries.end() && it->second.m_geometry == geometry )
+        {
+            for( const FRAGMENT& fragment : it->second.m_fragments )
+            {
+                if( fragment.m_kind == aKind && fragment.m_clearance == aClearance
+                    && fragment.m_segsPerCircle == aSegsPerCircle )
+                {
+                    m_hits++;
+                    return fragment.m_polys;
+                }
+            }
+        }
+    }
+
+    // Build the fragment outside of the lock: other threads may need the bucket meanwhile
+    std::shared_ptr<SHAPE_POLY_SET> polys = std::make_shared<SHAPE_POLY_SET>();
+
+    aBuild( *polys );
+    m_misses++;
+
+    if( cached )
+    {
+        std::lock_guard<std::mutex> lock( itemBucket.m_lock );
+        auto it = itemBucket.m_entries.find( aItem );
+
+        if( it == itemBucket.m_entries.end() )
+        {
+            it = itemBucket.m_entries.insert( std::make_pair( aItem, ENTRY() ) ).first;
+            it->second.m_geometry = geometry;
+        }
+        else if( it->second.m_geometry != geometry )
+        {
+            // The item has been modified since its fragments were built
+            it->second.m_geometry = geometry;
+            it->second.m_fragments.clear();
+        }
+
+        // Another thread may have built the same fragment meanwhile: both are identical
+        FRAGMENT fragment;
+        fragment.m_kind = aKind;
+        fragment.m_clearance = aClearance;
+        fragment.m_segsPerCircle = aSegsPerCircle;
+        fragment.m_polys = polys;
+
+        it->second.m_fragments.push_back( fragment );
+    }
+
+    return polys;
+}
+
+
+void ZONE_OBSTACLE_CACHE::Invalidate( const BOARD_ITEM* aItem )
+{
+    if( aItem->Type() == PCB_MODULE_T )
+    {
+        const MODULE* module = static_cast<const MODULE*>( aItem );
+
+        for( const D_PAD* pad = module->PadsList(); pad; pad = pad->Next() )
+            Invalidate( pad );
+
+        return;
+    }
+
+    BUCKET& itemBucket = bucket( aItem );
+    std::lock_guard<std::mutex> lock( itemBucket.m_lock );
+
+    itemBucket.m_entries.erase( aItem );
+}
+
+
+void ZONE_OBSTACLE_CACHE::Clear()
+{
+    for( BUCKET& b : m_buckets )
+    {
+        std::lock_guard<std::mutex> lock( b.m_lock );
+        b.m_entries.clear();
+    }
+
+    ClearIndex();
+}
+
+
+int ZONE_OBSTACLE_CACHE::GetFragmentCount() const
+{
+    int count = 0;
+
+    for( const BUCKET& b : m_buckets )
+    {
+        std::lock_guard<std::mutex> lock( b.m_lock );
+
+        for( const auto& entry : b.m_entries )
+            count += entry.second.m_fragments.size();
+    }
+
+    return count;
+}
+
+
+void ZONE_OBSTACLE_CACHE::ClearIndex()
+{
+    for( int layer = 0; layer < PCB_LAYER_ID_COUNT; ++layer )
+    {
+        if( m_trees[layer] )
+            m_trees[layer]->RemoveAll();
+    }
+
+    m_items.clear();
+    m_padCount = 0;
+    m_indexValid = false;
+}
+
+
+void ZONE_OBSTACLE_CACHE::BuildIndex( BOARD* aBoard )
+{
+    ClearIndex();
+
+    for( MODULE* module = aBoard->m_Modules; module; module = module->Next() )
+    {
+        for( D_PAD* pad = module->PadsList(); pad; pad = pad->Next() )
+            m_items.push_back( pad );
+    }
+
+    m_padCount = m_items.size();
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+        m_items.push_back( track );
+
+    // The holes of pads not on a layer are tested with the default netclass clearance
+    int holeClearance = aBoard->GetDesignSettings().GetBiggestClearanceValue();
+
+    for( int ii = 0; ii < (int) m_items.size(); ++ii )
+    {
+        BOARD_CONNECTED_ITEM* item = m_items[ii];
+
+        EDA_RECT bbox = itemArea( item, holeClearance );
+        const int mmin[2] = { bbox.GetX(), bbox.GetY() };
+        const int mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
+        LSET layers = DRC_ITEM_INDEX::ItemLayers( item );
+
+        for( LSEQ seq = layers.Seq(); seq; ++seq )
+            m_trees[*seq]->Insert( mmin, mmax, ii );
+    }
+
+    // Drop the fragments of the items deleted without a commit
+    std::unordered_set<const BOARD_ITEM*> onBoard( m_items.begin(), m_items.end() );
+
+    for( BUCKET& b : m_buckets )
+    {
+        std::lock_guard<std::mutex> lock( b.m_lock );
+
+        for( auto it = b.m_entries.begin(); it != b.m_entries.end(); )
+        {
+            if( onBoard.count( it->first ) )
+                ++it;
+            else
+                it = b.m_entries.erase( it );
+        }
+    }
+
+    m_indexValid = true;
+}
+
+
+void ZONE_OBSTACLE_CACHE::QueryIndex( const EDA_RECT& aArea, PCB_LAYER_ID aLayer, int aMargin,
+                                      std::vector<D_PAD*>& aPads,
+                                      std::vector<TRACK*>& aTracks ) const
+{
+    aPads.clear();
+    aTracks.clear();
+
+    wxCHECK_RET( m_indexValid && IsCopperLayer( aLayer ), wxT( "no index for this layer" ) );
+
+    EDA_RECT area( aArea );
+    area.Normalize();
+    area.Inflate( aMargin + 1 );
+
+    const int mmin[2] = { area.GetX(), area.GetY() };
+    const int mmax[2] = { area.GetRight(), area.GetBottom() };
+    std::vector<int> found;
+
+    auto collect = [&found]( int aIndex ) -> bool
+    {
+        found.push_back( aIndex );
+        return true;
+    };
+
+    m_trees[aLayer]->Search( mmin, mmax, collect );
+
+    // Back to the board order, which gives the same polygons as walking the board lists
+    std::sort( found.begin(), found.end() );
+
+    for( int idx : found )
+    {
+        if( idx < m_padCount )
+            aPads.push_back( static_cast<D_PAD*>( m_items[idx] ) );
+        else
+            aTracks.push_back( static_cast<TRACK*>( m_items[idx] ) );
+    }
+}
+
+
+void ZONE_OBSTACLE_CACHE::AddDirtyItem( const BOARD_ITEM* aItem, const BOARD_ITEM* aOldItem )
+{
+    // Changing the filled areas of a zone does not change the other zones
+    if( aItem->Type() == PCB_ZONE_AREA_T && aOldItem && aOldItem->Type() == PCB_ZONE_AREA_T
+        && static_cast<const ZONE_CONTAINER*>( aItem )->HasSameFillParameters(
+                    *static_cast<const ZONE_CONTAINER*>( aOldItem ) ) )
+        return;
+
+    int holeClearance = m_board->GetDesignSettings().GetBiggestClearanceValue();
+    size_t count = m_dirtyAreas.size();
+
+    m_dirtySerial++;
+
+    addDirtyAreas( aItem, holeClearance );
+
+    if( aOldItem )
+        addDirtyAreas( aOldItem, holeClearance );
+
+    if( m_dirtyAreas.size() == count )
+    {
+        // Nothing the zone fills depend on
+        m_dirtySerial--;
+    }
+    else if( m_dirtyAreas.size() > MAX_DIRTY_AREAS )
+    {
+        ResetDirtyAreas();
+    }
+}
+
+
+void ZONE_OBSTACLE_CACHE::addDirtyAreas( const BOARD_ITEM* aItem, int aHoleClearance )
+{
+    DIRTY_AREA dirty;
+
+    dirty.m_netCode = 0;
+    dirty.m_serial = m_dirtySerial;
+
+    switch( aItem->Type() )
+    {
+    case PCB_PAD_T:
+    case PCB_TRACE_T:
+    case PCB_VIA_T:
+    {
+        const BOARD_CONNECTED_ITEM* item = static_cast<const BOARD_CONNECTED_ITEM*>( aItem );
+
+        dirty.m_area = itemArea( item, aHoleClearance );
+
+        // The index leaves the track clearance to the zone fill tests
+        if( aItem->Type() != PCB_PAD_T )
+            dirty.m_area.Inflate( item->GetClearance() );
+
+        dirty.m_layers = DRC_ITEM_INDEX::ItemLayers( item );
+        dirty.m_netCode = item->GetNetCode();
+        break;
+    }
+
+    case PCB_MODULE_T:
+    {
+        const MODULE* module = static_cast<const MODULE*>( aItem );
+
+        for( const D_PAD* pad = module->PadsList(); pad; pad = pad->Next() )
+            addDirtyAreas( pad, aHoleClearance );
+
+        for( const BOARD_ITEM* item = module->GraphicalItemsList(); item; item = item->Next() )
+        {
+            if( item->Type() == PCB_MODULE_EDGE_T )
+                addDirtyAreas( item, aHoleClearance );
+        }
+
+        return;
+    }
+
+    case PCB_ZONE_AREA_T:
+    {
+        const ZONE_CONTAINER* zone = static_cast<const ZONE_CONTAINER*>( aItem );
+
+        // The zone outline, as a knockout of the other zones
+        dirty.m_area = zone->GetBoundingBox();
+        dirty.m_area.Inflate( zone->GetClearance() );
+        dirty.m_layers = zone->GetLayerSet();
+        dirty.m_netCode = zone->GetNetCode();
+        break;
+    }
+
+    case PCB_LINE_T:
+    case PCB_TEXT_T:
+    case PCB_MODULE_EDGE_T:
+        dirty.m_area = aItem->GetBoundingBox();
+
+        // The board edges are removed from the zones of all the copper layers
+        if( aItem->GetLayer() == Edge_Cuts )
+            dirty.m_layers = LSET::AllCuMask();
+        else
+            dirty.m_layers = LSET( aItem->GetLayer() ) & LSET::AllCuMask();
+
+        break;
+
+    default:
+        return;
+    }
+
+    if( dirty.m_layers.none() )
+        return;
+
+    dirty.m_area.Normalize();
+    m_dirtyAreas.push_back( dirty );
+}
+
+
+void ZONE_OBSTACLE_CACHE::GetDirtyAreas( unsigned aSince, PCB_LAYER_ID aLayer,
+                                         const EDA_RECT& aArea,
+                                         std::vector<EDA_RECT>& aAreas ) const
+{
+    for( const DIRTY_AREA& dirty : m_dirtyAreas )
+    {
+        if( dirty.m_serial > aSince && dirty.m_layers[aLayer]
+            && dirty.m_area.Intersects( aArea ) )
+            aAreas.push_back( dirty.m_area );
+    }
+}
+
+
+bool ZONE_OBSTACLE_CACHE::IsNetDirty( unsigned aSince, int aNetCode ) const
+{
+    for( const DIRTY_AREA& dirty : m_dirtyAreas )
+    {
+        if( dirty.m_serial > aSince && dirty.m_netCode == aNetCode )
+            return true;
+    }
+
+    return false;
+}
+
+
+void ZONE_OBSTACLE_CACHE::PruneDirtyAreas( unsigned aSerial )
+{
+    if( aSerial <= m_prunedSerial )
+        return;
+
+    auto seen = [aSerial]( const DIRTY_AREA& aDirty ) -> bool
+    {
+        return aDirty.m_serial <= aSerial;
+    };
+
+    m_dirtyAreas.erase( std::remove_if( m_dirtyAreas.begin(), m_dirtyAreas.end(), seen ),
+                        m_dirtyAreas.end() );
+    m_prunedSerial = aSerial;
+}
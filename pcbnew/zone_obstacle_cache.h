@@ -0,0 +1,282 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef ZONE_OBSTACLE_CACHE_H
+#define ZONE_OBSTACLE_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <class_eda_rect.h>
+#include <layers_id_colors_and_visibility.h>
+#include <geometry/rtree.h>
+#include <geometry/shape_poly_set.h>
+
+class BOARD;
+class BOARD_ITEM;
+class BOARD_CONNECTED_ITEM;
+class D_PAD;
+class TRACK;
+
+
+/**
+ * Class ZONE_OBSTACLE_CACHE
+ *
+ * Keeps the polygons of the pads, holes, tracks and vias inflated by a clearance, as built
+ * by the zone fill, so that zones sharing the same obstacles do not build them again.
+ *
+ * A fragment is the polygon of one item for a given kind, clearance and arc approximation.
+ * It does not depend on the zone or on the layer being filled. Fragments are kept with
+ * the geometry of the item they were built from: when the item geometry differs on the
+ * next lookup (the item was changed outside of a commit), its fragments are dropped.
+ * Commits also drop the fragments of the items they change, see Invalidate().
+ * Fragments can be looked up and added from several threads.
+ *
+ * During a fill, the cache can also hold a spatial index of the copper items, one R-tree
+ * per copper layer, so each zone only visits the items near its outline, in the board
+ * order. The index is built by BuildIndex() and only valid until ClearIndex(): the board
+ * must not be modified meanwhile.
+ *
+ * Last, the cache records the areas changed by the commits (the dirty areas), each with
+ * a serial number. A zone remembers the serial of the last change seen by its fill, so an
+ * incremental refill only recomputes the areas changed after it.
+ */
+class ZONE_OBSTACLE_CACHE
+{
+public:
+    enum FRAGMENT_KIND
+    {
+        FK_SHAPE,       ///< the pad or track shape
+        FK_HOLE         ///< the hole of a pad not on the filled layer
+    };
+
+    typedef std::shared_ptr<const SHAPE_POLY_SET> FRAGMENT_PTR;
+
+    /// Builds a fragment, by appending its outlines to the given (empty) set
+    typedef std::function<void( SHAPE_POLY_SET& aFragment )> BUILD_FUNC;
+
+    ZONE_OBSTACLE_CACHE( BOARD* aBoard );
+    ~ZONE_OBSTACLE_CACHE();
+
+    /**
+     * Function GetFragment
+     * returns the fragment of aItem for the given kind, clearance and number of segments
+     * per circle, calling aBuild to build it if it is not in the cache.
+     * Custom shaped pads are not cached: their fragment is built on each call.
+     */
+    FRAGMENT_PTR GetFragment( const BOARD_CONNECTED_ITEM* aItem, FRAGMENT_KIND aKind,
+                              int aClearance, int aSegsPerCircle, const BUILD_FUNC& aBuild );
+
+    /**
+     * Function Invalidate
+     * drops the fragments of aItem (of its pads, for a module). aItem may have been
+     * removed from the board, but not deleted.
+     */
+    void Invalidate( const BOARD_ITEM* aItem );
+
+    /**
+     * Function Clear
+     * drops all the fragments and the index.
+     */
+    void Clear();
+
+    /**
+     * Function BuildIndex
+     * indexes the pads, tracks and vias of aBoard, and drops the fragments of the items
+     * no longer on the board.
+     */
+    void BuildIndex( BOARD* aBoard );
+
+    void ClearIndex();
+
+    bool HasIndex() const
+    {
+        return m_indexValid;
+    }
+
+    /**
+     * Function QueryIndex
+     * collects the pads and tracks indexed on aLayer that may be an obstacle to, or have a
+     * thermal relief in, a zone.
+     * @param aArea the area searched, i.e. the zone bounding box inflated as in
+     *              ZONE_CONTAINER::buildFeatureHoleList()
+     * @param aMargin the largest zone dependent margin of the tests done on the candidates
+     *                (zone clearance, outline half thickness, zone thermal gap)
+     * @param aPads receives the pads found, in the order of the board module and pad lists
+     * @param aTracks receives the tracks and vias found, in the order of the board track list
+     */
+    void QueryIndex( const EDA_RECT& aArea, PCB_LAYER_ID aLayer, int aMargin,
+                     std::vector<D_PAD*>& aPads, std::vector<TRACK*>& aTracks ) const;
+
+    /// Fragments found in the cache since the last ResetStats()
+    unsigned GetHits() const { return m_hits; }
+
+    /// Fragments built since the last ResetStats()
+    unsigned GetMisses() const { return m_misses; }
+
+    void ResetStats()
+    {
+        m_hits = 0;
+        m_misses = 0;
+    }
+
+    /// Number of cached fragments
+    int GetFragmentCount() const;
+
+    /**
+     * Function AddDirtyItem
+     * records the area where the zone fills may be changed by an added, removed or
+     * modified item, i.e. the item shape inflated by its clearance, on its copper layers.
+     * @param aItem the item, in its new state for a modified item
+     * @param aOldItem the item before the change, for a modified item, or NULL
+     */
+    void AddDirtyItem( const BOARD_ITEM* aItem, const BOARD_ITEM* aOldItem = NULL );
+
+    /// The serial of the last dirty area: a fill started now sees all the changes up to it
+    unsigned GetDirtySerial() const { return m_dirtySerial; }
+
+    /// The dirty areas up to this serial are no longer known
+    unsigned GetPrunedSerial() const { return m_prunedSerial; }
+
+    /**
+     * Function GetDirtyAreas
+     * collects the dirty areas recorded after the serial aSince, on aLayer, and
+     * intersecting aArea.
+     */
+    void GetDirtyAreas( unsigned aSince, PCB_LAYER_ID aLayer, const EDA_RECT& aArea,
+                        std::vector<EDA_RECT>& aAreas ) const;
+
+    /**
+     * Function IsNetDirty
+     * @return true if an item of the net aNetCode was changed after the serial aSince,
+     * anywhere on the board
+     */
+    bool IsNetDirty( unsigned aSince, int aNetCode ) const;
+
+    /**
+     * Function PruneDirtyAreas
+     * forgets the dirty areas up to the serial aSerial, which must be seen by all the
+     * zones to refill incrementally.
+     */
+    void PruneDirtyAreas( unsigned aSerial );
+
+    /**
+     * Function ResetDirtyAreas
+     * forgets all the dirty areas, after a change not recorded by AddDirtyItem():
+     * the zones filled until now can only be filled again from scratch.
+     */
+    void ResetDirtyAreas()
+    {
+        PruneDirtyAreas( m_dirtySerial );
+    }
+
+private:
+    /// The geometry a fragment depends on, besides its clearance
+    struct ITEM_GEOMETRY
+    {
+        int     m_type;
+        int     m_shape;
+        wxPoint m_start;        ///< pad position, track start
+        wxPoint m_end;          ///< pad shape position, track end
+        wxSize  m_size;         ///< pad size, (track width, 0)
+        wxSize  m_delta;
+        double  m_orient;
+        int     m_cornerRadius;
+        wxSize  m_drill;
+        int     m_drillShape;
+
+        bool operator==( const ITEM_GEOMETRY& aOther ) const;
+        bool operator!=( const ITEM_GEOMETRY& aOther ) const { return !( *this == aOther ); }
+    };
+
+    struct FRAGMENT
+    {
+        FRAGMENT_KIND m_kind;
+        int           m_clearance;
+        int           m_segsPerCircle;
+        FRAGMENT_PTR  m_polys;
+    };
+
+    struct ENTRY
+    {
+        ITEM_GEOMETRY         m_geometry;
+        std::vector<FRAGMENT> m_fragments;
+    };
+
+    /// The fragments are split in buckets by item, each with its own lock
+    struct BUCKET
+    {
+        mutable std::mutex m_lock;
+        std::unordered_map<const BOARD_ITEM*, ENTRY> m_entries;
+    };
+
+    static const int BUCKET_COUNT = 64;
+
+    static ITEM_GEOMETRY itemGeometry( const BOARD_CONNECTED_ITEM* aItem );
+
+    BUCKET& bucket( const BOARD_ITEM* aItem )
+    {
+        // Skip the low bits of the address, which are the same for all items
+        return m_buckets[ ( reinterpret_cast<uintptr_t>( aItem ) >> 4 ) % BUCKET_COUNT ];
+    }
+
+    /// Stores the index of the item in m_items
+    typedef RTree<int, int, 2, float> ITEM_TREE;
+
+    struct DIRTY_AREA
+    {
+        EDA_RECT m_area;
+        LSET     m_layers;
+        int      m_netCode;
+        unsigned m_serial;
+    };
+
+    /// Beyond this count, the dirty areas are dropped and the next refill is a full one
+    static const int MAX_DIRTY_AREAS = 4096;
+
+    /// The area the zone fills depend on around a pad, track or via
+    static EDA_RECT itemArea( const BOARD_CONNECTED_ITEM* aItem, int aHoleClearance );
+
+    void addDirtyAreas( const BOARD_ITEM* aItem, int aHoleClearance );
+
+    BOARD*                m_board;
+    BUCKET                m_buckets[BUCKET_COUNT];
+    std::atomic<unsigned> m_hits;
+    std::atomic<unsigned> m_misses;
+
+    bool                  m_indexValid;
+    ITEM_TREE*            m_trees[PCB_LAYER_ID_COUNT];
+    std::vector<BOARD_CONNECTED_ITEM*> m_items;     ///< the pads first, in the board order
+    int                   m_padCount;
+
+    std::vector<DIRTY_AREA> m_dirtyAreas;
+    unsigned              m_dirtySerial;
+    unsigned              m_prunedSerial;
+};
+
+#endif  // ZONE_OBSTACLE_CACHE_H
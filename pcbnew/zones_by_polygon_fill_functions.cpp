@@ -32,6 +32,7 @@
 #include <pgm_base.h>
 #include <class_drawpanel.h>
 #include <class_draw_panel_gal.h>
+#include <view/view.h>
 #include <ratsnest_data.h>
 #include <wxPcbStruct.h>
 #include <macros.h>
@@ -45,6 +46,7 @@
 
 #include <connectivity.h>
 #include <board_commit.h>
+#include <zone_filler.h>
 
 #define FORMAT_STRING _( "Filling zone %d out of %d (net %s)..." )
 
@@ -155,33 +157,39 @@ int PCB_EDIT_FRAME::Fill_All_Zones( wxWindow * aActiveWindow, bool aVerbose )
     // Remove segment zones
     GetBoard()->m_Zone.DeleteAll();
 
-    int ii;
+    // Keepout zones are not filled
+    std::vector<ZONE_CONTAINER*> zones;
 
-    for( ii = 0; ii < areaCount; ii++ )
+    for( int ii = 0; ii < areaCount; ii++ )
     {
         ZONE_CONTAINER* zoneContainer = GetBoard()->GetArea( ii );
 
-        // Keepout zones are not filled
-        if( zoneContainer->GetIsKeepout() )
-            continue;
+        if( !zoneContainer->GetIsKeepout() )
+            zones.push_back( zoneContainer );
+    }
 
-        msg.Printf( FORMAT_STRING, ii + 1, areaCount, GetChars( zoneContainer->GetNetname() ) );
+    BOARD_COMMIT commit( this );
 
-        if( progressDialog )
-        {
-            if( !progressDialog->Update( ii+1, msg ) )
-                break;  // Aborted by user
-        }
+    for( ZONE_CONTAINER* zoneContainer : zones )
+        commit.Modify( zoneContainer );
 
-        errorLevel = Fill_Zone( zoneContainer );
+    // The zones are computed in parallel, and applied to the board one after the other
+    ZONE_FILLER filler( GetBoard() );
 
-        if( errorLevel && !aVerbose )
-            break;
-    }
+    filler.SetProgressCallback( [&]( int aIndex, int aCount, ZONE_CONTAINER* aZone ) -> bool
+    {
+        msg.Printf( FORMAT_STRING, aIndex + 1, aCount, GetChars( aZone->GetNetname() ) );
+
+        return !progressDialog || progressDialog->Update( aIndex + 1, msg );
+    } );
+
+    filler.Fill( zones );
+
+    commit.Push( _( "Fill All Zones" ), false );
 
     if( progressDialog )
     {
-        progressDialog->Update( ii+2, _( "Updating ratsnest..." ) );
+        progressDialog->Update( areaCount + 2, _( "Updating ratsnest..." ) );
 #ifdef __WXMAC__
         // Work around a dialog z-order issue on OS X
         aActiveWindow->Raise();
@@ -197,3 +205,38 @@ int PCB_EDIT_FRAME::Fill_All_Zones( wxWindow * aActiveWindow, bool aVerbose )
 
     return errorLevel;
 }
+
+
+void PCB_EDIT_FRAME::RefillChangedZones()
+{
+    // The legacy canvas edits the board outside of the commits, the changes are not known
+    if( !Settings().m_autoRefillZones || !IsGalCanvasActive() )
+        return;
+
+    // Only the filled zones are kept up to date
+    std::vector<ZONE_CONTAINER*> zones;
+
+    for( int ii = 0; ii < GetBoard()->GetAreaCount(); ii++ )
+    {
+        ZONE_CONTAINER* zone = GetBoard()->GetArea( ii );
+
+        if( zone->IsFilled() && !zone->GetIsKeepout() )
+            zones.push_back( zone );
+    }
+
+    if( zones.empty() )
+        return;
+
+    ZONE_FILLER filler( GetBoard() );
+
+    filler.SetIncremental( true );
+    filler.Fill( zones );
+
+    KIGFX::VIEW* view = GetGalCanvas()->GetView();
+
+    for( const ZONE_FILL_STATS& stats : filler.GetStats() )
+    {
+        if( !stats.m_kept )
+            view->Update( stats.m_zone );
+    }
+}
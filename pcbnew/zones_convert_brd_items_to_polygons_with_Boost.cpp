@@ -45,7 +45,15 @@
 // Forcing strickly simple polygons is time consuming, and we have not see issues in fast mode
 // so we use fast mode when possible (intermediate calculations)
 // (choice is SHAPE_POLY_SET::PM_STRICTLY_SIMPLE or SHAPE_POLY_SET::PM_FAST)
-#define POLY_CALC_MODE SHAPE_POLY_SET::PM_FAST
+// The partitioned modes process the separate groups of holes and filled areas of large
+// zones in parallel. Their polygons are not exactly the same as the other modes ones (see
+// SHAPE_POLY_SET::POLYGON_MODE), so they are only used when the zone filler is asked to
+// (see ZONE_FILLER::SetPartitioned())
+#define POLY_CALC_MODE( partitioned ) \
+    ( (partitioned) ? SHAPE_POLY_SET::PM_FAST_PARTITIONED : SHAPE_POLY_SET::PM_FAST )
+#define POLY_STRICT_MODE( partitioned ) \
+    ( (partitioned) ? SHAPE_POLY_SET::PM_STRICTLY_SIMPLE_PARTITIONED \
+                    : SHAPE_POLY_SET::PM_STRICTLY_SIMPLE )
 
 #include <cmath>
 #include <sstream>
@@ -65,6 +73,7 @@
 
 #include <pcbnew.h>
 #include <zones.h>
+#include <zone_obstacle_cache.h>
 #include <convert_basic_shapes_to_polygon.h>
 
 #include <geometry/shape_poly_set.h>
@@ -80,7 +89,11 @@ static const bool s_DumpZonesWhenFilling = false;
 extern void BuildUnconnectedThermalStubsPolygonList( SHAPE_POLY_SET& aCornerBuffer,
                                                      BOARD* aPcb, ZONE_CONTAINER* aZone,
                                                      double aArcCorrection,
-                                                     double aRoundPadThermalRotation);
+                                                     double aRoundPadThermalRotation,
+                                                     const EDA_RECT* aArea = NULL );
+
+extern bool GetThermalStubsArea( D_PAD* aPad, ZONE_CONTAINER* aZone, double aArcCorrection,
+                                 EDA_RECT& aArea );
 
 extern void Test_For_Copper_Island_And_Remove( BOARD*          aPcb,
                                                ZONE_CONTAINER* aZone_container );
@@ -97,7 +110,8 @@ extern void CreateThermalReliefPadPolygon( SHAPE_POLY_SET&       aCornerBuffer,
 // Local Variables:
 static double s_thermalRot = 450;  // angle of stubs in thermal reliefs for round pads
 
-void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeatures )
+void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeatures,
+                                           const EDA_RECT* aArea )
 {
     int segsPerCircle;
     double correctionFactor;
@@ -133,9 +147,10 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
 
     /* items ouside the zone bounding box are skipped
      * the bounding box is the zone bounding box + the biggest clearance found in Netclass list
+     * (when updating the filled areas, the area to update replaces the zone bounding box)
      */
     EDA_RECT item_boundingbox;
-    EDA_RECT zone_boundingbox  = GetBoundingBox();
+    EDA_RECT zone_boundingbox  = aArea ? *aArea : GetBoundingBox();
     int      biggest_clearance = aPcb->GetDesignSettings().GetBiggestClearanceValue();
     biggest_clearance = std::max( biggest_clearance, zone_clearance );
     zone_boundingbox.Inflate( biggest_clearance );
@@ -155,106 +170,83 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
     MODULE dummymodule( aPcb );    // Creates a dummy parent
     D_PAD dummypad( &dummymodule );
 
-    for( MODULE* module = aPcb->m_Modules;  module;  module = module->Next() )
-    {
-        D_PAD* nextpad;
+    /* The pad, hole and track polygons do not depend on the zone: they are kept in the
+     * board obstacle cache, to be shared with the other zones. During a ZONE_FILLER run,
+     * the cache also indexes the items, so only the ones close to the zone are visited.
+     */
+    ZONE_OBSTACLE_CACHE* cache = aPcb->GetZoneObstacleCache();
+    std::vector<D_PAD*> pads;
+    std::vector<TRACK*> tracks;
 
-        for( D_PAD* pad = module->PadsList(); pad != NULL; pad = nextpad )
+    if( cache->HasIndex() )
+    {
+        // The candidates come in the board order, giving the same polygons as a full scan
+        int margin = std::max( zone_clearance, m_ThermalReliefGap );
+        cache->QueryIndex( zone_boundingbox, GetLayer(), margin, pads, tracks );
+    }
+    else
+    {
+        for( MODULE* module = aPcb->m_Modules;  module;  module = module->Next() )
         {
-            nextpad = pad->Next();  // pad pointer can be modified by next code, so
-                                    // calculate the next pad here
+            for( D_PAD* pad = module->PadsList(); pad != NULL; pad = pad->Next() )
+                pads.push_back( pad );
+        }
 
-            if( !pad->IsOnLayer( GetLayer() ) )
-            {
-                /* Test for pads that are on top or bottom only and have a hole.
-                 * There are curious pads but they can be used for some components that are
-                 * inside the board (in fact inside the hole. Some photo diodes and Leds are
-                 * like this)
-                 */
-                if( pad->GetDrillSize().x == 0 && pad->GetDrillSize().y == 0 )
-                    continue;
-
-                // Use a dummy pad to calculate a hole shape that have the same dimension as
-                // the pad hole
-                dummypad.SetSize( pad->GetDrillSize() );
-                dummypad.SetOrientation( pad->GetOrientation() );
-                dummypad.SetShape( pad->GetDrillShape() == PAD_DRILL_SHAPE_OBLONG ?
-                                   PAD_SHAPE_OVAL : PAD_SHAPE_CIRCLE );
-                dummypad.SetPosition( pad->GetPosition() );
-
-                pad = &dummypad;
-            }
+        for( TRACK* track = aPcb->m_Track;  track;  track = track->Next() )
+            tracks.push_back( track );
+    }
 
-            // Note: netcode <=0 means not connected item
-            if( ( pad->GetNetCode() != GetNetCode() ) || ( pad->GetNetCode() <= 0 ) )
-            {
-                int item_clearance = pad->GetClearance() + outline_half_thickness;
-                item_boundingbox = pad->GetBoundingBox();
-                item_boundingbox.Inflate( item_clearance );
+    for( D_PAD* boardPad : pads )
+    {
+        D_PAD* pad = boardPad;  // pad pointer can be modified by next code
+        ZONE_OBSTACLE_CACHE::FRAGMENT_KIND kind = ZONE_OBSTACLE_CACHE::FK_SHAPE;
 
-                if( item_boundingbox.Intersects( zone_boundingbox ) )
-                {
-                    int clearance = std::max( zone_clearance, item_clearance );
+        if( !pad->IsOnLayer( GetLayer() ) )
+        {
+            /* Test for pads that are on top or bottom only and have a hole.
+             * There are curious pads but they can be used for some components that are
+             * inside the board (in fact inside the hole. Some photo diodes and Leds are
+             * like this)
+             */
+            if( pad->GetDrillSize().x == 0 && pad->GetDrillSize().y == 0 )
+                continue;
 
-                    // PAD_SHAPE_CUSTOM can have a specific keepout, to avoid to break the shape
-                    if( pad->GetShape() == PAD_SHAPE_CUSTOM &&
-                        pad->GetCustomShapeInZoneOpt() == CUST_PAD_SHAPE_IN_ZONE_CONVEXHULL )
-                    {
-                        // the pad shape in zone can be its convex hull or
-                        // the shape itself
-                        SHAPE_POLY_SET outline( pad->GetCustomShapeAsPolygon() );
-                        outline.Inflate( KiROUND( clearance*correctionFactor) , segsPerCircle );
-                        pad->CustomShapeAsPolygonToBoardPosition( &outline,
-                                    pad->GetPosition(), pad->GetOrientation() );
-
-                        if( pad->GetCustomShapeInZoneOpt() == CUST_PAD_SHAPE_IN_ZONE_CONVEXHULL )
-                        {
-                            std::vector<wxPoint> convex_hull;
-                            BuildConvexHull( convex_hull, outline );
-
-                            aFeatures.NewOutline();
-                            for( unsigned ii = 0; ii < convex_hull.size(); ++ii )
-                                aFeatures.Append( convex_hull[ii] );
-                        }
-                        else
-                            aFeatures.Append( outline );
-                    }
-                    else
-                        pad->TransformShapeWithClearanceToPolygon( aFeatures,
-                                                                   clearance,
-                                                                   segsPerCircle,
-                                                                   correctionFactor );
-                }
+            // Use a dummy pad to calculate a hole shape that have the same dimension as
+            // the pad hole
+            dummypad.SetSize( pad->GetDrillSize() );
+            dummypad.SetOrientation( pad->GetOrientation() );
+            dummypad.SetShape( pad->GetDrillShape() == PAD_DRILL_SHAPE_OBLONG ?
+                               PAD_SHAPE_OVAL : PAD_SHAPE_CIRCLE );
+            dummypad.SetPosition( pad->GetPosition() );
 
-                continue;
-            }
+            pad = &dummypad;
+            kind = ZONE_OBSTACLE_CACHE::FK_HOLE;
+        }
+
+        // Note: netcode <=0 means not connected item
+        if( ( pad->GetNetCode() != GetNetCode() ) || ( pad->GetNetCode() <= 0 ) )
+        {
+            int item_clearance = pad->GetClearance() + outline_half_thickness;
+            item_boundingbox = pad->GetBoundingBox();
+            item_boundingbox.Inflate( item_clearance );
 
-            // Pads are removed from zone if the setup is PAD_ZONE_CONN_NONE
-            // or if they have a custom shape, because a thermal relief will break
-            // the shape
-            if( GetPadConnection( pad ) == PAD_ZONE_CONN_NONE ||
-                pad->GetShape() == PAD_SHAPE_CUSTOM )
+            if( item_boundingbox.Intersects( zone_boundingbox ) )
             {
-                int gap = zone_clearance;
-                int thermalGap = GetThermalReliefGap( pad );
-                gap = std::max( gap, thermalGap );
-                item_boundingbox = pad->GetBoundingBox();
-                item_boundingbox.Inflate( gap );
+                int clearance = std::max( zone_clearance, item_clearance );
 
-                if( item_boundingbox.Intersects( zone_boundingbox ) )
+                // PAD_SHAPE_CUSTOM can have a specific keepout, to avoid to break the shape
+                if( pad->GetShape() == PAD_SHAPE_CUSTOM &&
+                    pad->GetCustomShapeInZoneOpt() == CUST_PAD_SHAPE_IN_ZONE_CONVEXHULL )
                 {
-                    // PAD_SHAPE_CUSTOM has a specific keepout, to avoid to break the shape
-                    // the pad shape in zone can be its convex hull or the shape itself
-                    if( pad->GetShape() == PAD_SHAPE_CUSTOM &&
-                        pad->GetCustomShapeInZoneOpt() == CUST_PAD_SHAPE_IN_ZONE_CONVEXHULL )
+                    // the pad shape in zone can be its convex hull or
+                    // the shape itself
+                    SHAPE_POLY_SET outline( pad->GetCustomShapeAsPolygon() );
+                    outline.Inflate( KiROUND( clearance*correctionFactor) , segsPerCircle );
+                    pad->CustomShapeAsPolygonToBoardPosition( &outline,
+                                pad->GetPosition(), pad->GetOrientation() );
+
+                    if( pad->GetCustomShapeInZoneOpt() == CUST_PAD_SHAPE_IN_ZONE_CONVEXHULL )
                     {
-                        // the pad shape in zone can be its convex hull or
-                        // the shape itself
-                        SHAPE_POLY_SET outline( pad->GetCustomShapeAsPolygon() );
-                        outline.Inflate( KiROUND( gap*correctionFactor) , segsPerCircle );
-                        pad->CustomShapeAsPolygonToBoardPosition( &outline,
-                                    pad->GetPosition(), pad->GetOrientation() );
-
                         std::vector<wxPoint> convex_hull;
                         BuildConvexHull( convex_hull, outline );
 
@@ -263,8 +255,70 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
                             aFeatures.Append( convex_hull[ii] );
                     }
                     else
-                        pad->TransformShapeWithClearanceToPolygon( aFeatures,
-                                        gap, segsPerCircle, correctionFactor );
+                        aFeatures.Append( outline );
+                }
+                else
+                {
+                    auto fragment = cache->GetFragment( boardPad, kind, clearance,
+                                                        segsPerCircle,
+                            [&]( SHAPE_POLY_SET& aFragment )
+                            {
+                                pad->TransformShapeWithClearanceToPolygon( aFragment,
+                                                                           clearance,
+                                                                           segsPerCircle,
+                                                                           correctionFactor );
+                            } );
+
+                    aFeatures.Append( *fragment );
+                }
+            }
+
+            continue;
+        }
+
+        // Pads are removed from zone if the setup is PAD_ZONE_CONN_NONE
+        // or if they have a custom shape, because a thermal relief will break
+        // the shape
+        if( GetPadConnection( pad ) == PAD_ZONE_CONN_NONE ||
+            pad->GetShape() == PAD_SHAPE_CUSTOM )
+        {
+            int gap = zone_clearance;
+            int thermalGap = GetThermalReliefGap( pad );
+            gap = std::max( gap, thermalGap );
+            item_boundingbox = pad->GetBoundingBox();
+            item_boundingbox.Inflate( gap );
+
+            if( item_boundingbox.Intersects( zone_boundingbox ) )
+            {
+                // PAD_SHAPE_CUSTOM has a specific keepout, to avoid to break the shape
+                // the pad shape in zone can be its convex hull or the shape itself
+                if( pad->GetShape() == PAD_SHAPE_CUSTOM &&
+                    pad->GetCustomShapeInZoneOpt() == CUST_PAD_SHAPE_IN_ZONE_CONVEXHULL )
+                {
+                    // the pad shape in zone can be its convex hull or
+                    // the shape itself
+                    SHAPE_POLY_SET outline( pad->GetCustomShapeAsPolygon() );
+                    outline.Inflate( KiROUND( gap*correctionFactor) , segsPerCircle );
+                    pad->CustomShapeAsPolygonToBoardPosition( &outline,
+                                pad->GetPosition(), pad->GetOrientation() );
+
+                    std::vector<wxPoint> convex_hull;
+                    BuildConvexHull( convex_hull, outline );
+
+                    aFeatures.NewOutline();
+                    for( unsigned ii = 0; ii < convex_hull.size(); ++ii )
+                        aFeatures.Append( convex_hull[ii] );
+                }
+                else
+                {
+                    auto fragment = cache->GetFragment( boardPad, kind, gap, segsPerCircle,
+                            [&]( SHAPE_POLY_SET& aFragment )
+                            {
+                                pad->TransformShapeWithClearanceToPolygon( aFragment,
+                                                gap, segsPerCircle, correctionFactor );
+                            } );
+
+                    aFeatures.Append( *fragment );
                 }
             }
         }
@@ -273,7 +327,7 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
     /* Add holes (i.e. tracks and vias areas as polygons outlines)
      * in cornerBufferPolysToSubstract
      */
-    for( TRACK* track = aPcb->m_Track;  track;  track = track->Next() )
+    for( TRACK* track : tracks )
     {
         if( !track->IsOnLayer( GetLayer() ) )
             continue;
@@ -287,10 +341,17 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
         if( item_boundingbox.Intersects( zone_boundingbox ) )
         {
             int clearance = std::max( zone_clearance, item_clearance );
-            track->TransformShapeWithClearanceToPolygon( aFeatures,
-                                                         clearance,
-                                                         segsPerCircle,
-                                                         correctionFactor );
+            auto fragment = cache->GetFragment( track, ZONE_OBSTACLE_CACHE::FK_SHAPE,
+                                                clearance, segsPerCircle,
+                    [&]( SHAPE_POLY_SET& aFragment )
+                    {
+                        track->TransformShapeWithClearanceToPolygon( aFragment,
+                                                                     clearance,
+                                                                     segsPerCircle,
+                                                                     correctionFactor );
+                    } );
+
+            aFeatures.Append( *fragment );
         }
     }
 
@@ -359,26 +420,12 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
     }
 
     // Add zones outlines having an higher priority and keepout
-    for( int ii = 0; ii < GetBoard()->GetAreaCount(); ii++ )
-    {
-        ZONE_CONTAINER* zone = GetBoard()->GetArea( ii );
-
-        // If the zones share no common layers
-        if( !CommonLayerExists( zone->GetLayerSet() ) )
-            continue;
-
-        if( !zone->GetIsKeepout() && zone->GetPriority() <= GetPriority() )
-            continue;
-
-        if( zone->GetIsKeepout() && ! zone->GetDoNotAllowCopperPour() )
-            continue;
-
-        // A highter priority zone or keepout area is found: remove this area
-        item_boundingbox = zone->GetBoundingBox();
+    std::vector<ZONE_CONTAINER*> knockouts;
 
-        if( !item_boundingbox.Intersects( zone_boundingbox ) )
-            continue;
+    GetKnockoutZones( aPcb, knockouts );
 
+    for( ZONE_CONTAINER* zone : knockouts )
+    {
         // Add the zone outline area.
         // However if the zone has the same net as the current zone,
         // do not add any clearance.
@@ -403,49 +450,81 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
             use_net_clearance = false;
         }
 
-        zone->TransformOutlinesShapeWithClearanceToPolygon(
+        // The smoothed outline of the other zone is up to date (see ComputeFilledAreas()):
+        // it is not rebuilt here, because other zones may be filled at the same time
+        zone->TransformSmoothedOutlinesWithClearanceToPolygon(
                     aFeatures, min_clearance, use_net_clearance );
     }
 
    // Remove thermal symbols
-    for( MODULE* module = aPcb->m_Modules;  module;  module = module->Next() )
+    for( D_PAD* pad : pads )
     {
-        for( D_PAD* pad = module->PadsList(); pad != NULL; pad = pad->Next() )
-        {
-            // Rejects non-standard pads with tht-only thermal reliefs
-            if( GetPadConnection( pad ) == PAD_ZONE_CONN_THT_THERMAL
-                && pad->GetAttribute() != PAD_ATTRIB_STANDARD )
-                continue;
+        // Rejects non-standard pads with tht-only thermal reliefs
+        if( GetPadConnection( pad ) == PAD_ZONE_CONN_THT_THERMAL
+            && pad->GetAttribute() != PAD_ATTRIB_STANDARD )
+            continue;
 
-            if( GetPadConnection( pad ) != PAD_ZONE_CONN_THERMAL
-                && GetPadConnection( pad ) != PAD_ZONE_CONN_THT_THERMAL )
-                continue;
+        if( GetPadConnection( pad ) != PAD_ZONE_CONN_THERMAL
+            && GetPadConnection( pad ) != PAD_ZONE_CONN_THT_THERMAL )
+            continue;
 
-            if( !pad->IsOnLayer( GetLayer() ) )
-                continue;
+        if( !pad->IsOnLayer( GetLayer() ) )
+            continue;
 
-            if( pad->GetNetCode() != GetNetCode() )
-                continue;
+        if( pad->GetNetCode() != GetNetCode() )
+            continue;
 
-            item_boundingbox = pad->GetBoundingBox();
-            int thermalGap = GetThermalReliefGap( pad );
-            item_boundingbox.Inflate( thermalGap, thermalGap );
+        item_boundingbox = pad->GetBoundingBox();
+        int thermalGap = GetThermalReliefGap( pad );
+        item_boundingbox.Inflate( thermalGap, thermalGap );
 
-            if( item_boundingbox.Intersects( zone_boundingbox ) )
-            {
-                CreateThermalReliefPadPolygon( aFeatures,
-                                               *pad, thermalGap,
-                                               GetThermalReliefCopperBridge( pad ),
-                                               m_ZoneMinThickness,
-                                               segsPerCircle,
-                                               correctionFactor, s_thermalRot );
-            }
+        if( item_boundingbox.Intersects( zone_boundingbox ) )
+        {
+            CreateThermalReliefPadPolygon( aFeatures,
+                                           *pad, thermalGap,
+                                           GetThermalReliefCopperBridge( pad ),
+                                           m_ZoneMinThickness,
+                                           segsPerCircle,
+                                           correctionFactor, s_thermalRot );
         }
     }
 
 }
 
 
+void ZONE_CONTAINER::GetKnockoutZones( BOARD* aPcb, std::vector<ZONE_CONTAINER*>& aZones ) const
+{
+    // Same area as in buildFeatureHoleList(): the zone bounding box inflated by the
+    // biggest clearance
+    int      zone_clearance = GetClearance() + m_ZoneMinThickness / 2;
+    EDA_RECT zone_boundingbox  = GetBoundingBox();
+    int      biggest_clearance = aPcb->GetDesignSettings().GetBiggestClearanceValue();
+    biggest_clearance = std::max( biggest_clearance, zone_clearance );
+    zone_boundingbox.Inflate( biggest_clearance );
+
+    for( int ii = 0; ii < aPcb->GetAreaCount(); ii++ )
+    {
+        ZONE_CONTAINER* zone = aPcb->GetArea( ii );
+
+        // If the zones share no common layers
+        if( !CommonLayerExists( zone->GetLayerSet() ) )
+            continue;
+
+        if( !zone->GetIsKeepout() && zone->GetPriority() <= GetPriority() )
+            continue;
+
+        if( zone->GetIsKeepout() && ! zone->GetDoNotAllowCopperPour() )
+            continue;
+
+        // A highter priority zone or keepout area is found: remove this area
+        if( !zone->GetBoundingBox().Intersects( zone_boundingbox ) )
+            continue;
+
+        aZones.push_back( zone );
+    }
+}
+
+
 /**
  * Function AddClearanceAreasPolygonsToPolysList
  * Supports a min thickness area constraint.
@@ -476,7 +555,8 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
  *     Remove new insulated copper islands
  */
 
-void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb )
+void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb, bool aKeepFillState,
+                                                              bool aPartitioned )
 {
     int segsPerCircle;
     double correctionFactor;
@@ -506,8 +586,8 @@ void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb )
 
     SHAPE_POLY_SET solidAreas = *m_smoothedPoly;
 
-    solidAreas.Inflate( -outline_half_thickness, segsPerCircle );
-    solidAreas.Simplify( POLY_CALC_MODE );
+    solidAreas.Inflate( -outline_half_thickness, segsPerCircle, POLY_CALC_MODE( aPartitioned ) );
+    solidAreas.Simplify( POLY_CALC_MODE( aPartitioned ) );
 
     SHAPE_POLY_SET holes;
 
@@ -520,7 +600,7 @@ void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb )
     if(s_DumpZonesWhenFilling)
         dumper->Write( &holes, "feature-holes" );
 
-    holes.Simplify( POLY_CALC_MODE );
+    holes.Simplify( POLY_CALC_MODE( aPartitioned ) );
 
     if (s_DumpZonesWhenFilling)
         dumper->Write( &holes, "feature-holes-postsimplify" );
@@ -529,13 +609,24 @@ void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb )
     // be created later).
     // Use SHAPE_POLY_SET::PM_STRICTLY_SIMPLE to generate strictly simple polygons
     // needed by Gerber files and Fracture()
-    solidAreas.BooleanSubtract( holes, SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+    solidAreas.BooleanSubtract( holes, POLY_STRICT_MODE( aPartitioned ) );
 
     if (s_DumpZonesWhenFilling)
         dumper->Write( &solidAreas, "solid-areas-minus-holes" );
 
+    // Same as Fracture(), keeping the simplified areas for UpdateFilledAreas() if needed
+    std::shared_ptr<FILL_STATE> fillState;
+
+    if( aKeepFillState )
+        fillState = std::make_shared<FILL_STATE>();
+
     SHAPE_POLY_SET areas_fractured = solidAreas;
-    areas_fractured.Fracture( POLY_CALC_MODE );
+    areas_fractured.Simplify( POLY_CALC_MODE( aPartitioned ) );
+
+    if( fillState )
+        fillState->m_unfracturedPolys = areas_fractured;
+
+    areas_fractured.FractureSimplified( POLY_CALC_MODE( aPartitioned ) );
 
     if (s_DumpZonesWhenFilling)
         dumper->Write( &areas_fractured, "areas_fractured" );
@@ -553,18 +644,23 @@ void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb )
     // remove copper areas corresponding to not connected stubs
     if( !thermalHoles.IsEmpty() )
     {
-        thermalHoles.Simplify( POLY_CALC_MODE );
+        thermalHoles.Simplify( POLY_CALC_MODE( aPartitioned ) );
         // Remove unconnected stubs. Use SHAPE_POLY_SET::PM_STRICTLY_SIMPLE to
         // generate strictly simple polygons
         // needed by Gerber files and Fracture()
-        solidAreas.BooleanSubtract( thermalHoles, SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+        solidAreas.BooleanSubtract( thermalHoles, POLY_STRICT_MODE( aPartitioned ) );
 
         if( s_DumpZonesWhenFilling )
             dumper->Write( &thermalHoles, "thermal-holes" );
 
         // put these areas in m_FilledPolysList
         SHAPE_POLY_SET th_fractured = solidAreas;
-        th_fractured.Fracture( POLY_CALC_MODE );
+        th_fractured.Simplify( POLY_CALC_MODE( aPartitioned ) );
+
+        if( fillState )
+            fillState->m_unfracturedPolys = th_fractured;
+
+        th_fractured.FractureSimplified( POLY_CALC_MODE( aPartitioned ) );
 
         if( s_DumpZonesWhenFilling )
             dumper->Write ( &th_fractured, "th_fractured" );
@@ -574,14 +670,188 @@ void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb )
     }
 
     m_RawPolysList = m_FilledPolysList;
+    storeFillState( aPcb, fillState );
 
-	if( GetNetCode() > 0 )
-        TestForCopperIslandAndRemoveInsulatedIslands( aPcb );
-
+    // The insulated copper islands are removed later, by FinishFilledAreas(), because
+    // it updates the board connectivity
     if(s_DumpZonesWhenFilling)
         dumper->EndGroup();
 }
 
+
+/**
+ * Function UpdateFilledAreas
+ * Each area is recomputed as in AddClearanceAreasPolygonsToPolysList_NG(), but only
+ * inside a rectangle:
+ * 1 - the rectangle is grown to include the whole thermal stubs of the pads it touches,
+ *     because the stubs are kept or removed depending on the filled areas at their ends
+ * 2 - the zone area inside the rectangle, minus the holes close to it, and minus
+ *     the unconnected thermal stubs inside it, gives the new filled areas in the rectangle
+ * 3 - the previous filled polygons crossing the rectangle are clipped by it, merged with
+ *     the new areas and fractured again. The other polygons are kept as they are.
+ * The insulated copper islands are removed later, by FinishFilledAreas(), for the whole
+ * zone, because an island depends on the items connected to it, wherever they are.
+ */
+void ZONE_CONTAINER::UpdateFilledAreas( BOARD* aPcb, const std::vector<EDA_RECT>& aAreas,
+                                        bool aPartitioned )
+{
+    int segsPerCircle;
+    double correctionFactor;
+    int outline_half_thickness = m_ZoneMinThickness / 2;
+
+    if( m_ArcToSegmentsCount == ARC_APPROX_SEGMENTS_COUNT_HIGHT_DEF  )
+        segsPerCircle = ARC_APPROX_SEGMENTS_COUNT_HIGHT_DEF;
+    else
+        segsPerCircle = ARC_APPROX_SEGMENTS_COUNT_LOW_DEF;
+
+    correctionFactor = 1.0 / cos( M_PI / (double) segsPerCircle );
+
+    SHAPE_POLY_SET solidAreas = *m_smoothedPoly;
+
+    solidAreas.Inflate( -outline_half_thickness, segsPerCircle, POLY_CALC_MODE( aPartitioned ) );
+    solidAreas.Simplify( POLY_CALC_MODE( aPartitioned ) );
+
+    // The areas of the thermal stubs of this zone
+    std::vector<EDA_RECT> stubAreas;
+
+    if( GetNetCode() > 0 )
+    {
+        for( MODULE* module = aPcb->m_Modules;  module;  module = module->Next() )
+        {
+            for( D_PAD* pad = module->PadsList(); pad != NULL; pad = pad->Next() )
+            {
+                EDA_RECT stubArea;
+
+                if( GetThermalStubsArea( pad, this, correctionFactor, stubArea ) )
+                    stubAreas.push_back( stubArea );
+            }
+        }
+    }
+
+    // Grow the areas to include the stubs they touch, and merge the overlapping ones
+    std::vector<EDA_RECT> areas;
+
+    for( EDA_RECT area : aAreas )
+    {
+        area.Normalize();
+        areas.push_back( area );
+    }
+
+    bool grown = true;
+
+    while( grown )
+    {
+        grown = false;
+
+        for( size_t ii = 0; ii < areas.size(); ++ii )
+        {
+            for( const EDA_RECT& stubArea : stubAreas )
+            {
+                if( stubArea.Intersects( areas[ii] ) && !areas[ii].Contains( stubArea ) )
+                {
+                    areas[ii].Merge( stubArea );
+                    grown = true;
+                }
+            }
+
+            for( size_t jj = ii + 1; jj < areas.size(); )
+            {
+                if( areas[jj].Intersects( areas[ii] ) )
+                {
+                    areas[ii].Merge( areas[jj] );
+                    areas.erase( areas.begin() + jj );
+                    grown = true;
+                }
+                else
+                {
+                    ++jj;
+                }
+            }
+        }
+    }
+
+    std::shared_ptr<FILL_STATE> fillState = std::make_shared<FILL_STATE>();
+    SHAPE_POLY_SET& unfractured = fillState->m_unfracturedPolys;
+
+    unfractured = m_fillState->m_unfracturedPolys;
+    SHAPE_POLY_SET fractured = m_RawPolysList;
+
+    for( const EDA_RECT& area : areas )
+    {
+        SHAPE_POLY_SET areaPoly;
+
+        areaPoly.NewOutline();
+        areaPoly.Append( area.GetX(), area.GetY() );
+        areaPoly.Append( area.GetRight(), area.GetY() );
+        areaPoly.Append( area.GetRight(), area.GetBottom() );
+        areaPoly.Append( area.GetX(), area.GetBottom() );
+
+        // The polygons touching the area are recomputed, the others are kept
+        BOX2I areaBox( VECTOR2I( area.GetX() - 1, area.GetY() - 1 ),
+                       VECTOR2I( area.GetWidth() + 2, area.GetHeight() + 2 ) );
+        SHAPE_POLY_SET kept;
+        SHAPE_POLY_SET keptFractured;
+        SHAPE_POLY_SET changed;
+
+        for( int ii = 0; ii < unfractured.OutlineCount(); ++ii )
+        {
+            SHAPE_POLY_SET& target = unfractured.COutline( ii ).BBox().Intersects( areaBox ) ?
+                                     changed : kept;
+            int idx = target.AddOutline( unfractured.COutline( ii ) );
+
+            for( int jj = 0; jj < unfractured.HoleCount( ii ); ++jj )
+                target.AddHole( unfractured.CHole( ii, jj ), idx );
+
+            if( &target == &kept )
+                keptFractured.AddOutline( fractured.COutline( ii ) );
+        }
+
+        // The new filled areas inside the area
+        SHAPE_POLY_SET local;
+        SHAPE_POLY_SET holes;
+
+        local.BooleanIntersection( solidAreas, areaPoly, POLY_CALC_MODE( aPartitioned ) );
+        buildFeatureHoleList( aPcb, holes, &area );
+        holes.Simplify( POLY_CALC_MODE( aPartitioned ) );
+        local.BooleanSubtract( holes, POLY_STRICT_MODE( aPartitioned ) );
+
+        if( GetNetCode() > 0 )
+        {
+            // The stubs test reads m_FilledPolysList, which must hold the new areas
+            SHAPE_POLY_SET thermalHoles;
+
+            m_FilledPolysList = local;
+            m_FilledPolysList.Fracture( POLY_CALC_MODE( aPartitioned ) );
+
+            BuildUnconnectedThermalStubsPolygonList( thermalHoles, aPcb, this,
+                                                     correctionFactor, s_thermalRot, &area );
+
+            if( !thermalHoles.IsEmpty() )
+            {
+                thermalHoles.Simplify( POLY_CALC_MODE( aPartitioned ) );
+                local.BooleanSubtract( thermalHoles, POLY_STRICT_MODE( aPartitioned ) );
+            }
+        }
+
+        changed.BooleanSubtract( areaPoly, POLY_CALC_MODE( aPartitioned ) );
+        changed.BooleanAdd( local, POLY_STRICT_MODE( aPartitioned ) );
+        changed.Simplify( POLY_CALC_MODE( aPartitioned ) );
+
+        SHAPE_POLY_SET changedFractured = changed;
+        changedFractured.FractureSimplified( POLY_CALC_MODE( aPartitioned ) );
+
+        kept.Append( changed );
+        keptFractured.Append( changedFractured );
+
+        unfractured = kept;
+        fractured = keptFractured;
+    }
+
+    m_FilledPolysList = fractured;
+    m_RawPolysList = fractured;
+    storeFillState( aPcb, fillState );
+}
+
 void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList( BOARD* aPcb )
 {
 }
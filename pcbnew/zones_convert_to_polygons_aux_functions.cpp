@@ -50,8 +50,21 @@ void ZONE_CONTAINER::TransformOutlinesShapeWithClearanceToPolygon(
         SHAPE_POLY_SET& aCornerBuffer, int aMinClearanceValue, bool aUseNetClearance )
 {
     // Creates the zone outline polygon (with holes if any)
-    SHAPE_POLY_SET polybuffer;
-    BuildFilledSolidAreasPolygons( NULL, &polybuffer );
+    if( !BuildSmoothedPoly() )
+        return;
+
+    TransformSmoothedOutlinesWithClearanceToPolygon( aCornerBuffer, aMinClearanceValue,
+                                                     aUseNetClearance );
+}
+
+
+void ZONE_CONTAINER::TransformSmoothedOutlinesWithClearanceToPolygon(
+        SHAPE_POLY_SET& aCornerBuffer, int aMinClearanceValue, bool aUseNetClearance ) const
+{
+    if( !m_smoothedPoly || GetNumCorners() <= 2 )
+        return;
+
+    SHAPE_POLY_SET polybuffer = *m_smoothedPoly;
 
     // add clearance to outline
     int clearance = aMinClearanceValue;
@@ -74,6 +87,62 @@ void ZONE_CONTAINER::TransformOutlinesShapeWithClearanceToPolygon(
 
 
 
+/**
+ * Function GetThermalStubsArea
+ * Gives the area covered by the thermal stubs of a pad in a zone, and by the points
+ * tested by BuildUnconnectedThermalStubsPolygonList() to keep or remove them
+ * @param aPad = the pad
+ * @param aZone = the zone
+ * @param aArcCorrection = the arc correction factor used by the zone fill
+ * @param aArea = the rectangle receiving the area
+ * @return false if the pad has no thermal stubs in this zone
+ */
+bool GetThermalStubsArea( D_PAD* aPad, ZONE_CONTAINER* aZone, double aArcCorrection,
+                          EDA_RECT& aArea )
+{
+    // Same tests as BuildUnconnectedThermalStubsPolygonList()
+    if( aZone->GetPadConnection( aPad ) == PAD_ZONE_CONN_THT_THERMAL
+     && aPad->GetAttribute() != PAD_ATTRIB_STANDARD )
+        return false;
+
+    if( aZone->GetPadConnection( aPad ) != PAD_ZONE_CONN_THERMAL
+     && aZone->GetPadConnection( aPad ) != PAD_ZONE_CONN_THT_THERMAL )
+        return false;
+
+    if( !aPad->IsOnLayer( aZone->GetLayer() ) || aPad->GetNetCode() != aZone->GetNetCode() )
+        return false;
+
+    int thermalBridgeWidth = aZone->GetThermalReliefCopperBridge( aPad )
+                             - aZone->GetMinThickness();
+
+    if( thermalBridgeWidth <= 0 )
+        return false;
+
+    thermalBridgeWidth = ( thermalBridgeWidth + 4 ) / 2;
+
+    int thermalReliefGap = aZone->GetThermalReliefGap( aPad );
+    int endX = ( aPad->GetSize().x / 2 ) + thermalReliefGap;
+    int endY = ( aPad->GetSize().y / 2 ) + thermalReliefGap;
+
+    if( aPad->GetShape() == PAD_SHAPE_CIRCLE )
+    {
+        endX = KiROUND( endX * aArcCorrection );
+        endY = endX;
+    }
+
+    endX += aZone->GetMinThickness() / 2;
+    endY += aZone->GetMinThickness() / 2;
+
+    // The stubs are rotated: use the circle containing them
+    int radius = KiROUND( hypot( endX, endY ) ) + thermalBridgeWidth + 1;
+
+    aArea = EDA_RECT( aPad->ShapePos(), wxSize( 0, 0 ) );
+    aArea.Inflate( radius );
+
+    return true;
+}
+
+
 /**
  * Function BuildUnconnectedThermalStubsPolygonList
  * Creates a set of polygons corresponding to stubs created by thermal shapes on pads
@@ -83,13 +152,16 @@ void ZONE_CONTAINER::TransformOutlinesShapeWithClearanceToPolygon(
  * @param aZone = a pointer to the ZONE_CONTAINER  to examine.
  * @param aArcCorrection = a pointer to the ZONE_CONTAINER  to examine.
  * @param aRoundPadThermalRotation = the rotation in 1.0 degree for thermal stubs in round pads
+ * @param aArea = if not null, only the pads whose stubs are inside this area
+ *                (see GetThermalStubsArea()) are examined
  */
 
 void BuildUnconnectedThermalStubsPolygonList( SHAPE_POLY_SET& aCornerBuffer,
                                               BOARD*                aPcb,
                                               ZONE_CONTAINER*       aZone,
                                               double                aArcCorrection,
-                                              double                aRoundPadThermalRotation )
+                                              double                aRoundPadThermalRotation,
+                                              const EDA_RECT*       aArea )
 {
     std::vector<wxPoint> corners_buffer;    // a local polygon buffer to store one stub
     corners_buffer.reserve( 4 );
@@ -144,6 +216,16 @@ void BuildUnconnectedThermalStubsPolygonList( SHAPE_POLY_SET& aCornerBuffer,
             if( !( item_boundingbox.Intersects( zone_boundingbox ) ) )
                 continue;
 
+            if( aArea )
+            {
+                EDA_RECT stubsArea;
+
+                GetThermalStubsArea( pad, aZone, aArcCorrection, stubsArea );
+
+                if( !aArea->Contains( stubsArea ) )
+                    continue;
+            }
+
             // Thermal bridges are like a segment from a starting point inside the pad
             // to an ending point outside the pad
 
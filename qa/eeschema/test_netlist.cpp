@@ -0,0 +1,290 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_netlist.cpp
+ * Checks the net numbers of the netlist built by NETLIST_OBJECT_LIST::BuildNetListInfo(),
+ * with and without the items of the sheets kept by a NETLIST_SHEET_CACHE, and the netlists
+ * the exporters write from it before and after the schematic changes.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <fctsys.h>
+#include <pgm_base.h>
+#include <kiway.h>
+#include <general.h>
+#include <richio.h>
+#include <class_library.h>
+#include <class_netlist_object.h>
+#include <class_sch_screen.h>
+#include <sch_collectors.h>
+#include <sch_component.h>
+#include <sch_io_mgr.h>
+#include <sch_line.h>
+#include <sch_sheet.h>
+#include <sch_sheet_path.h>
+#include <wildcards_and_files_ext.h>
+#include <netlist_exporter_cadstar.h>
+#include <netlist_exporter_kicad.h>
+#include <netlist_exporter_orcadpcb2.h>
+
+#include <wx/filename.h>
+
+#include <memory>
+
+
+/**
+ * Struct SCHEMATIC_FIXTURE
+ * the complex hierarchy demo, loaded for each test with its components linked to the
+ * symbols of its cache library. Its root sheet is g_RootSheet. The tests may modify it.
+ */
+struct SCHEMATIC_FIXTURE
+{
+    SCHEMATIC_FIXTURE() :
+        m_kiway( &Pgm(), KFCTL_STANDALONE )
+    {
+        wxFileName file( wxT( QA_DEMOS_DIR ), wxT( "complex_hierarchy.sch" ) );
+
+        file.AppendDir( wxT( "complex_hierarchy" ) );
+
+        m_root.reset( SCH_IO_MGR::Load( SCH_IO_MGR::SCH_LEGACY, file.GetFullPath(),
+                                        &m_kiway ) );
+        g_RootSheet = m_root.get();
+
+        wxFileName cacheLib( file );
+
+        cacheLib.SetName( file.GetName() + wxT( "-cache" ) );
+        cacheLib.SetExt( SchematicLibraryFileExtension );
+
+        m_libs.reset( new PART_LIBS() );
+        m_libs->AddLibrary( cacheLib.GetFullPath() );
+
+        SCH_SCREENS screens;
+
+        for( SCH_SCREEN* screen = screens.GetFirst(); screen; screen = screens.GetNext() )
+        {
+            SCH_TYPE_COLLECTOR components;
+
+            components.Collect( screen->GetDrawItems(), SCH_COLLECTOR::ComponentsOnly );
+            SCH_COMPONENT::ResolveAll( components, m_libs.get() );
+        }
+
+        m_sheets.reset( new SCH_SHEET_LIST( m_root.get() ) );
+    }
+
+    ~SCHEMATIC_FIXTURE()
+    {
+        if( g_RootSheet == m_root.get() )
+            g_RootSheet = NULL;
+    }
+
+    KIWAY                           m_kiway;
+    std::unique_ptr<PART_LIBS>      m_libs;
+    std::unique_ptr<SCH_SHEET>      m_root;
+    std::unique_ptr<SCH_SHEET_LIST> m_sheets;
+};
+
+
+/// The netlists written by the exporters using the net numbers
+struct NETLIST_EXPORTS
+{
+    std::string m_kicad;
+    std::string m_cadstar;
+    std::string m_orcadPcb2;    ///< The pin net names of NETLIST_EXPORTER::sprintPinNetName()
+};
+
+
+/**
+ * @return the netlist written by an EXPORTER from aList, which it owns, without the date of
+ * its header.
+ */
+template <class EXPORTER>
+static std::string writeNetlist( NETLIST_OBJECT_LIST* aList, PART_LIBS* aLibs )
+{
+    EXPORTER exporter( aList, aLibs );
+    wxString fileName = wxFileName::CreateTempFileName( wxT( "qa_eeschema" ) );
+    std::string text;
+
+    BOOST_REQUIRE( exporter.WriteNetlist( fileName, 0 ) );
+
+    {
+        FILE_LINE_READER reader( fileName );
+
+        while( reader.ReadLine() )
+        {
+            std::string line( reader.Line() );
+
+            // The Cadstar time line and the OrcadPCB2 first line
+            if( line.find( "TIM " ) != std::string::npos
+                    || line.find( " created " ) != std::string::npos )
+                continue;
+
+            text += line;
+        }
+    }
+
+    wxRemoveFile( fileName );
+
+    return text;
+}
+
+
+/**
+ * @return the netlist of aSheets built with aCache, as each exporter writes it.
+ */
+static NETLIST_EXPORTS exportNetlists( SCH_SHEET_LIST& aSheets, NETLIST_SHEET_CACHE* aCache,
+                                       PART_LIBS* aLibs )
+{
+    NETLIST_EXPORTS exports;
+
+    // Each exporter owns its list
+    auto buildNetlist = [&]() -> NETLIST_OBJECT_LIST*
+    {
+        NETLIST_OBJECT_LIST* list = new NETLIST_OBJECT_LIST();
+
+        BOOST_CHECK( list->BuildNetListInfo( aSheets, aCache ) );
+
+        return list;
+    };
+
+    {
+        NETLIST_EXPORTER_KICAD exporter( buildNetlist(), aLibs );
+        STRING_FORMATTER formatter;
+
+        // Without the header, which holds the date
+        exporter.Format( &formatter, GNL_ALL & ~GNL_HEADER );
+        exports.m_kicad = formatter.GetString();
+    }
+
+    exports.m_cadstar = writeNetlist<NETLIST_EXPORTER_CADSTAR>( buildNetlist(), aLibs );
+    exports.m_orcadPcb2 = writeNetlist<NETLIST_EXPORTER_ORCADPCB2>( buildNetlist(), aLibs );
+
+    return exports;
+}
+
+
+static void checkSameExports( const NETLIST_EXPORTS& aFound, const NETLIST_EXPORTS& aExpected )
+{
+    BOOST_CHECK( aFound.m_kicad == aExpected.m_kicad );
+    BOOST_CHECK( aFound.m_cadstar == aExpected.m_cadstar );
+    BOOST_CHECK( aFound.m_orcadPcb2 == aExpected.m_orcadPcb2 );
+}
+
+
+BOOST_FIXTURE_TEST_SUITE( Netlist, SCHEMATIC_FIXTURE )
+
+/**
+ * Checks that the nets are numbered in the order of their first item in the list of the
+ * items of the sheets sorted by sheet, connected at once by ConnectItems(), and that
+ * BuildNetListInfo() gives the same numbers with the items of the sheets it keeps.
+ */
+BOOST_AUTO_TEST_CASE( NetsNumberedInListOrder )
+{
+    NETLIST_OBJECT_LIST connected;
+
+    for( unsigned i = 0; i < m_sheets->size(); i++ )
+    {
+        SCH_SHEET_PATH* sheet = &( *m_sheets )[i];
+
+        for( SCH_ITEM* item = sheet->LastScreen()->GetDrawItems(); item; item = item->Next() )
+            item->GetNetListItem( connected, sheet );
+    }
+
+    BOOST_REQUIRE( !connected.empty() );
+
+    connected.SortListbySheet();
+    connected.ConnectItems();
+    connected.NumberNets();
+
+    int lastNet = 0;
+
+    for( unsigned ii = 0; ii < connected.size(); ii++ )
+    {
+        int net = connected.GetItemNet( ii );
+
+        BOOST_CHECK_LE( net, lastNet + 1 );
+        lastNet = std::max( lastNet, net );
+    }
+
+    BOOST_CHECK_GT( lastNet, 1 );
+
+    connected.SortListbyNetcode();
+
+    NETLIST_SHEET_CACHE cache;
+
+    // Filling the cache, then reading it
+    for( int pass = 0; pass < 2; pass++ )
+    {
+        NETLIST_OBJECT_LIST built;
+
+        BOOST_REQUIRE( built.BuildNetListInfo( *m_sheets, &cache ) );
+        BOOST_REQUIRE_EQUAL( built.size(), connected.size() );
+
+        for( unsigned ii = 0; ii < built.size(); ii++ )
+        {
+            const NETLIST_OBJECT* item = built.GetItem( ii );
+            const NETLIST_OBJECT* expected = connected.GetItem( ii );
+
+            BOOST_CHECK( item->m_Comp == expected->m_Comp );
+            BOOST_CHECK( item->m_Type == expected->m_Type );
+            BOOST_CHECK( item->m_SheetPath == expected->m_SheetPath );
+            BOOST_CHECK_EQUAL( item->GetNet(), expected->GetNet() );
+        }
+    }
+}
+
+
+/**
+ * Checks that the exporters write the same netlists with and without the items of the
+ * sheets kept by the cache, before and after a screen shared by several sheets is changed,
+ * and once a new net shifts the numbers of the nets after it.
+ */
+BOOST_AUTO_TEST_CASE( CachedNetlistExportsAsBefore )
+{
+    NETLIST_SHEET_CACHE cache;
+    NETLIST_EXPORTS reference = exportNetlists( *m_sheets, NULL, m_libs.get() );
+
+    BOOST_REQUIRE( !reference.m_kicad.empty() );
+
+    // Filling the cache, then reading it
+    checkSameExports( exportNetlists( *m_sheets, &cache, m_libs.get() ), reference );
+    checkSameExports( exportNetlists( *m_sheets, &cache, m_libs.get() ), reference );
+
+    // The sheets of a changed screen are collected again, with the same nets
+    ( *m_sheets )[ m_sheets->size() - 1 ].LastScreen()->NewRevision();
+    checkSameExports( exportNetlists( *m_sheets, &cache, m_libs.get() ), reference );
+
+    // A wire connected to nothing is a new net in the root sheet
+    SCH_LINE* wire = new SCH_LINE( wxPoint( -10000, -10000 ), LAYER_WIRE );
+
+    wire->SetEndPoint( wxPoint( -9000, -10000 ) );
+    m_root->GetScreen()->Append( wire );
+
+    NETLIST_EXPORTS changed = exportNetlists( *m_sheets, NULL, m_libs.get() );
+
+    BOOST_CHECK( changed.m_kicad != reference.m_kicad );
+    checkSameExports( exportNetlists( *m_sheets, &cache, m_libs.get() ), changed );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
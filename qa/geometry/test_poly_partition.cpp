@@ -0,0 +1,280 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <geometry/shape_poly_set.h>
+#include <geometry/shape_line_chain.h>
+
+#include <cmath>
+#include <random>
+
+static double area( const SHAPE_POLY_SET& aSet )
+{
+    double area = 0.0;
+
+    for( int polygon = 0; polygon < aSet.OutlineCount(); polygon++ )
+    {
+        area += std::abs( aSet.COutline( polygon ).Area() );
+
+        for( int hole = 0; hole < aSet.HoleCount( polygon ); hole++ )
+            area -= std::abs( aSet.CHole( polygon, hole ).Area() );
+    }
+
+    return area;
+}
+
+
+/**
+ * Checks that aFound covers the same area as aExpected. Clipper rounds the intersections
+ * of the edges at the scan lines of all the polygons it is given, so the polygons of a group
+ * may move by one unit when the other groups are not there: the area they do not have in
+ * common must be less than one unit along their outlines.
+ */
+static void checkSameArea( const SHAPE_POLY_SET& aFound, const SHAPE_POLY_SET& aExpected )
+{
+    SHAPE_POLY_SET foundOnly, expectedOnly;
+    double length = 0.0;
+
+    foundOnly.BooleanSubtract( aFound, aExpected, SHAPE_POLY_SET::PM_FAST );
+    expectedOnly.BooleanSubtract( aExpected, aFound, SHAPE_POLY_SET::PM_FAST );
+
+    for( int polygon = 0; polygon < aExpected.OutlineCount(); polygon++ )
+    {
+        for( const SHAPE_LINE_CHAIN& chain : aExpected.CPolygon( polygon ) )
+            length += chain.Length();
+    }
+
+    BOOST_CHECK_LE( area( foundOnly ) + area( expectedOnly ), length );
+    BOOST_CHECK_CLOSE( area( aFound ), area( aExpected ), 0.01 );
+}
+
+
+/**
+ * Checks that aFound has exactly the polygons of aExpected: the same vertices, in the same
+ * order.
+ */
+static void checkSamePolygons( const SHAPE_POLY_SET& aFound, const SHAPE_POLY_SET& aExpected )
+{
+    BOOST_REQUIRE_EQUAL( aFound.OutlineCount(), aExpected.OutlineCount() );
+
+    for( int polygon = 0; polygon < aExpected.OutlineCount(); polygon++ )
+    {
+        const SHAPE_POLY_SET::POLYGON& found = aFound.CPolygon( polygon );
+        const SHAPE_POLY_SET::POLYGON& expected = aExpected.CPolygon( polygon );
+
+        BOOST_REQUIRE_EQUAL( found.size(), expected.size() );
+
+        for( unsigned int i = 0; i < expected.size(); i++ )
+        {
+            BOOST_REQUIRE_EQUAL( found[i].PointCount(), expected[i].PointCount() );
+            BOOST_CHECK_EQUAL( found[i].IsClosed(), expected[i].IsClosed() );
+
+            for( int point = 0; point < expected[i].PointCount(); point++ )
+                BOOST_CHECK( found[i].CPoint( point ) == expected[i].CPoint( point ) );
+        }
+    }
+}
+
+
+/**
+ * A random star shaped polygon of aCount vertices, at most aRadius away from aCenter.
+ */
+static SHAPE_LINE_CHAIN randomStar( std::mt19937& aRng, int aCount, const VECTOR2I& aCenter,
+                                    int aRadius )
+{
+    std::uniform_int_distribution<int> radius( aRadius / 4, aRadius );
+    SHAPE_LINE_CHAIN chain;
+
+    for( int i = 0; i < aCount; i++ )
+    {
+        double angle = 2.0 * M_PI * i / aCount;
+        int r = radius( aRng );
+
+        chain.Append( aCenter + VECTOR2I( (int) std::lround( r * cos( angle ) ),
+                                          (int) std::lround( r * sin( angle ) ) ), true );
+    }
+
+    chain.SetClosed( true );
+
+    return chain;
+}
+
+
+/**
+ * Clusters of random polygons on a grid of aSize x aSize, far enough apart for most of the
+ * clusters to be separate groups, some of them touching or overlapping their neighbours.
+ */
+static SHAPE_POLY_SET randomClusters( std::mt19937& aRng, int aPitch, int aSize = 12 )
+{
+    std::uniform_int_distribution<int> count( 3, 12 );
+    std::uniform_int_distribution<int> offset( 0, 500 );
+    SHAPE_POLY_SET set;
+
+    for( int x = 0; x < aSize; x++ )
+    {
+        for( int y = 0; y < aSize; y++ )
+        {
+            for( int i = 0; i < 3; i++ )
+            {
+                VECTOR2I center = VECTOR2I( x, y ) * aPitch
+                                  + VECTOR2I( offset( aRng ), offset( aRng ) );
+
+                set.AddOutline( randomStar( aRng, count( aRng ), center, 400 ) );
+            }
+        }
+    }
+
+    return set;
+}
+
+
+BOOST_AUTO_TEST_SUITE( PolyPartition )
+
+/**
+ * Checks that the partitioned modes give exactly the same polygons as the other ones when
+ * they do not partition: for small sets, and for sets whose polygons all touch each other.
+ * The fracture of simplified polygons, done polygon by polygon, is always the same.
+ */
+BOOST_AUTO_TEST_CASE( SamePolygonsWhenNotPartitioned )
+{
+    std::mt19937 rng( 3 );
+
+    // 75 polygons of at most 12 vertices, and one group of polygons over 3000 vertices
+    for( int size : { 5, 12 } )
+    {
+        int pitch = size == 5 ? 1500 : 300;
+        SHAPE_POLY_SET a = randomClusters( rng, pitch, size );
+        SHAPE_POLY_SET b = randomClusters( rng, pitch, size );
+
+        for( SHAPE_POLY_SET::POLYGON_MODE mode : { SHAPE_POLY_SET::PM_FAST,
+                                                   SHAPE_POLY_SET::PM_STRICTLY_SIMPLE } )
+        {
+            auto partitioned = (SHAPE_POLY_SET::POLYGON_MODE) ( mode | 2 );
+            SHAPE_POLY_SET expected, found;
+
+            expected.BooleanAdd( a, b, mode );
+            found.BooleanAdd( a, b, partitioned );
+            checkSamePolygons( found, expected );
+
+            expected.BooleanSubtract( a, b, mode );
+            found.BooleanSubtract( a, b, partitioned );
+            checkSamePolygons( found, expected );
+
+            expected.BooleanIntersection( a, b, mode );
+            found.BooleanIntersection( a, b, partitioned );
+            checkSamePolygons( found, expected );
+
+            expected = found = a;
+            expected.Inflate( 100, 16 );
+            found.Inflate( 100, 16, partitioned );
+            checkSamePolygons( found, expected );
+        }
+    }
+
+    SHAPE_POLY_SET set = randomClusters( rng, 1500 );
+
+    set.Simplify( SHAPE_POLY_SET::PM_FAST );
+
+    SHAPE_POLY_SET expected = set;
+    SHAPE_POLY_SET found = set;
+
+    expected.FractureSimplified( SHAPE_POLY_SET::PM_FAST );
+    found.FractureSimplified( SHAPE_POLY_SET::PM_FAST_PARTITIONED );
+    checkSamePolygons( found, expected );
+}
+
+/**
+ * Checks that the partitioned boolean operations cover the same areas as the other ones,
+ * for sets they partition, where the polygons are not exactly the same.
+ */
+BOOST_AUTO_TEST_CASE( BooleanOps )
+{
+    std::mt19937 rng( 1 );
+
+    for( int pitch : { 900, 1000, 1500 } )
+    {
+        SHAPE_POLY_SET a = randomClusters( rng, pitch );
+        SHAPE_POLY_SET b = randomClusters( rng, pitch );
+
+        for( SHAPE_POLY_SET::POLYGON_MODE mode : { SHAPE_POLY_SET::PM_FAST,
+                                                   SHAPE_POLY_SET::PM_STRICTLY_SIMPLE } )
+        {
+            auto partitioned = (SHAPE_POLY_SET::POLYGON_MODE) ( mode | 2 );
+            SHAPE_POLY_SET expected, found;
+
+            expected.BooleanAdd( a, b, mode );
+            found.BooleanAdd( a, b, partitioned );
+            checkSameArea( found, expected );
+
+            expected.BooleanSubtract( a, b, mode );
+            found.BooleanSubtract( a, b, partitioned );
+            checkSameArea( found, expected );
+
+            expected.BooleanIntersection( a, b, mode );
+            found.BooleanIntersection( a, b, partitioned );
+            checkSameArea( found, expected );
+
+            expected = found = a;
+            expected.Simplify( mode );
+            found.Simplify( partitioned );
+            checkSameArea( found, expected );
+
+            // The in place operations, reading the set they write
+            found.BooleanSubtract( b, partitioned );
+            expected.BooleanSubtract( b, mode );
+            checkSameArea( found, expected );
+
+            expected.Fracture( mode );
+            found.Fracture( partitioned );
+            checkSameArea( found, expected );
+        }
+    }
+}
+
+/**
+ * Checks that the partitioned inflation covers the same areas as the other one, the
+ * groups growing into each other or not.
+ */
+BOOST_AUTO_TEST_CASE( Inflate )
+{
+    std::mt19937 rng( 2 );
+
+    for( int pitch : { 1000, 1500, 3000 } )
+    {
+        SHAPE_POLY_SET set = randomClusters( rng, pitch );
+
+        set.Simplify( SHAPE_POLY_SET::PM_FAST );
+
+        for( int factor : { -100, -10, 10, 200, 600 } )
+        {
+            SHAPE_POLY_SET expected = set;
+            SHAPE_POLY_SET found = set;
+
+            expected.Inflate( factor, 16 );
+            found.Inflate( factor, 16, SHAPE_POLY_SET::PM_FAST_PARTITIONED );
+            checkSameArea( found, expected );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
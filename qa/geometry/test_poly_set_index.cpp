@@ -0,0 +1,452 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <geometry/shape_poly_set.h>
+#include <geometry/shape_line_chain.h>
+
+#include <climits>
+#include <random>
+
+/**
+ * The point in polygon test of SHAPE_POLY_SET, testing all the edges of aPath.
+ */
+static bool referencePointInPolygon( const VECTOR2I& aP, const SHAPE_LINE_CHAIN& aPath )
+{
+    int result = 0;
+    int cnt = aPath.PointCount();
+
+    if( !aPath.BBox().Contains( aP ) )
+        return false;
+
+    if( cnt < 3 )
+        return false;
+
+    VECTOR2I ip = aPath.CPoint( 0 );
+
+    for( int i = 1; i <= cnt; ++i )
+    {
+        VECTOR2I ipNext = ( i == cnt ? aPath.CPoint( 0 ) : aPath.CPoint( i ) );
+
+        if( ipNext.y == aP.y )
+        {
+            if( ( ipNext.x == aP.x ) || ( ip.y == aP.y &&
+                ( ( ipNext.x > aP.x ) == ( ip.x < aP.x ) ) ) )
+                return true;
+        }
+
+        if( ( ip.y < aP.y ) != ( ipNext.y < aP.y ) )
+        {
+            if( ip.x >= aP.x )
+            {
+                if( ipNext.x > aP.x )
+                    result = 1 - result;
+                else
+                {
+                    int64_t d = (int64_t)( ip.x - aP.x ) * (int64_t)( ipNext.y - aP.y ) -
+                                (int64_t)( ipNext.x - aP.x ) * (int64_t)( ip.y - aP.y );
+
+                    if( !d )
+                        return true;
+
+                    if( ( d > 0 ) == ( ipNext.y > ip.y ) )
+                        result = 1 - result;
+                }
+            }
+            else if( ipNext.x > aP.x )
+            {
+                int64_t d = (int64_t)( ip.x - aP.x ) * (int64_t)( ipNext.y - aP.y ) -
+                            (int64_t)( ipNext.x - aP.x ) * (int64_t)( ip.y - aP.y );
+
+                if( !d )
+                    return true;
+
+                if( ( d > 0 ) == ( ipNext.y > ip.y ) )
+                    result = 1 - result;
+            }
+        }
+
+        ip = ipNext;
+    }
+
+    return result ? true : false;
+}
+
+
+/**
+ * SHAPE_POLY_SET::Contains(), testing all the edges of the set.
+ */
+static bool referenceContains( const SHAPE_POLY_SET& aSet, const VECTOR2I& aP )
+{
+    for( int polygon = 0; polygon < aSet.OutlineCount(); polygon++ )
+    {
+        if( !referencePointInPolygon( aP, aSet.COutline( polygon ) ) )
+            continue;
+
+        bool inHole = false;
+
+        for( int hole = 0; hole < aSet.HoleCount( polygon ); hole++ )
+        {
+            const SHAPE_LINE_CHAIN& chain = aSet.CHole( polygon, hole );
+
+            if( referencePointInPolygon( aP, chain ) && !chain.PointOnEdge( aP ) )
+                inHole = true;
+        }
+
+        if( !inHole )
+            return true;
+    }
+
+    return false;
+}
+
+
+/**
+ * SHAPE_POLY_SET::CollideEdge(), testing all the edges of the set.
+ */
+static bool referenceCollideEdge( const SHAPE_POLY_SET& aSet, const VECTOR2I& aP,
+                                  SHAPE_POLY_SET::VERTEX_INDEX& aClosest, int aClearance )
+{
+    bool collision = false;
+
+    for( int polygon = 0; polygon < aSet.OutlineCount(); polygon++ )
+    {
+        for( int contour = 0; contour <= aSet.HoleCount( polygon ); contour++ )
+        {
+            const SHAPE_LINE_CHAIN& chain = aSet.CPolygon( polygon )[contour];
+
+            for( int i = 0; i < chain.SegmentCount(); i++ )
+            {
+                int distance = chain.CSegment( i ).Distance( aP );
+
+                if( distance <= aClearance )
+                {
+                    collision = true;
+                    aClearance = distance;
+                    aClosest.m_polygon = polygon;
+                    aClosest.m_contour = contour;
+                    aClosest.m_vertex = i;
+                }
+            }
+        }
+    }
+
+    return collision;
+}
+
+
+/**
+ * SHAPE_POLY_SET::IsNearEdge(), testing all the edges of the set.
+ */
+static bool referenceIsNearEdge( const SHAPE_POLY_SET& aSet, const VECTOR2I& aP, int aDistance )
+{
+    for( int polygon = 0; polygon < aSet.OutlineCount(); polygon++ )
+    {
+        for( int contour = 0; contour <= aSet.HoleCount( polygon ); contour++ )
+        {
+            const SHAPE_LINE_CHAIN& chain = aSet.CPolygon( polygon )[contour];
+
+            for( int i = 0; i < chain.SegmentCount(); i++ )
+            {
+                if( chain.CSegment( i ).SquaredDistance( aP )
+                        <= (VECTOR2I::extended_type) aDistance * aDistance )
+                    return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+/**
+ * SHAPE_POLY_SET::CollideVertex(), testing all the vertices of the set.
+ */
+static bool referenceCollideVertex( const SHAPE_POLY_SET& aSet, const VECTOR2I& aP,
+                                    SHAPE_POLY_SET::VERTEX_INDEX& aClosest, int aClearance )
+{
+    bool collision = false;
+    double clearance = aClearance;
+
+    for( auto iterator = aSet.CIterateWithHoles(); iterator; iterator++ )
+    {
+        double distance = VECTOR2D( *iterator - aP ).EuclideanNorm();
+
+        if( distance <= clearance )
+        {
+            collision = true;
+            clearance = distance;
+            aClosest = iterator.GetIndex();
+        }
+    }
+
+    return collision;
+}
+
+
+/**
+ * A random closed chain of aCount vertices in a small area, so that many queries fall on
+ * its vertices and edges.
+ */
+static SHAPE_LINE_CHAIN randomChain( std::mt19937& aRng, int aCount, int aOrigin, int aSize )
+{
+    std::uniform_int_distribution<int> coord( aOrigin, aOrigin + aSize );
+    SHAPE_LINE_CHAIN chain;
+
+    for( int i = 0; i < aCount; i++ )
+        chain.Append( VECTOR2I( coord( aRng ), coord( aRng ) ), true );
+
+    chain.SetClosed( true );
+
+    return chain;
+}
+
+
+static bool sameIndex( const SHAPE_POLY_SET::VERTEX_INDEX& aA,
+                       const SHAPE_POLY_SET::VERTEX_INDEX& aB )
+{
+    return aA.m_polygon == aB.m_polygon && aA.m_contour == aB.m_contour
+           && aA.m_vertex == aB.m_vertex;
+}
+
+
+/**
+ * Checks all the point queries of aSet on a grid covering it.
+ */
+static void checkQueries( const SHAPE_POLY_SET& aSet )
+{
+    BOX2I bbox = aSet.BBox( 10 );
+
+    for( int x = bbox.GetLeft(); x <= bbox.GetRight(); x += 3 )
+    {
+        for( int y = bbox.GetTop(); y <= bbox.GetBottom(); y += 2 )
+        {
+            VECTOR2I p( x, y );
+            bool onEdge = false;
+
+            for( int polygon = 0; polygon < aSet.OutlineCount(); polygon++ )
+            {
+                for( const SHAPE_LINE_CHAIN& chain : aSet.CPolygon( polygon ) )
+                    onEdge |= chain.PointOnEdge( p );
+            }
+
+            BOOST_CHECK_EQUAL( aSet.Contains( p ), referenceContains( aSet, p ) );
+            BOOST_CHECK_EQUAL( aSet.PointOnEdge( p ), onEdge );
+
+            for( int clearance : { -1, 0, 1, 4, 15 } )
+            {
+                SHAPE_POLY_SET::VERTEX_INDEX found, expected;
+
+                BOOST_CHECK_EQUAL( aSet.CollideEdge( p, found, clearance ),
+                                   referenceCollideEdge( aSet, p, expected, clearance ) );
+                BOOST_CHECK( sameIndex( found, expected ) );
+
+                if( clearance >= 0 )
+                {
+                    BOOST_CHECK_EQUAL( aSet.IsNearEdge( p, clearance ),
+                                       referenceIsNearEdge( aSet, p, clearance ) );
+                }
+
+                found = expected = SHAPE_POLY_SET::VERTEX_INDEX();
+
+                BOOST_CHECK_EQUAL( aSet.CollideVertex( p, found, clearance ),
+                                   referenceCollideVertex( aSet, p, expected, clearance ) );
+                BOOST_CHECK( sameIndex( found, expected ) );
+            }
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE( PolySetIndex )
+
+/**
+ * Checks the indexed queries against the queries testing all the edges, on random
+ * self-intersecting polygons with holes, large enough to be indexed.
+ */
+BOOST_AUTO_TEST_CASE( RandomPolygons )
+{
+    std::mt19937 rng( 1 );
+
+    for( int iter = 0; iter < 4; iter++ )
+    {
+        SHAPE_POLY_SET set;
+
+        for( int polygon = 0; polygon < 3; polygon++ )
+        {
+            set.AddOutline( randomChain( rng, 150, polygon * 100, 200 ) );
+            set.AddHole( randomChain( rng, 40, polygon * 100 + 50, 100 ) );
+        }
+
+        checkQueries( set );
+    }
+}
+
+/**
+ * Checks that the index follows the changes of the set.
+ */
+BOOST_AUTO_TEST_CASE( Invalidation )
+{
+    std::mt19937 rng( 2 );
+    SHAPE_POLY_SET set;
+
+    set.AddOutline( randomChain( rng, 200, 0, 300 ) );
+    checkQueries( set );
+
+    // A copy shares the index of the set, and drops it when it is changed
+    SHAPE_POLY_SET copy( set );
+
+    copy.Move( VECTOR2I( 17, -5 ) );
+    checkQueries( copy );
+    checkQueries( set );
+
+    set.Outline( 0 ).Append( VECTOR2I( 400, 400 ) );
+    checkQueries( set );
+
+    set.Vertex( 3 ) = VECTOR2I( -50, 120 );
+    checkQueries( set );
+
+    set.AddHole( randomChain( rng, 30, 100, 100 ) );
+    checkQueries( set );
+
+    set.RemoveVertex( 10 );
+    checkQueries( set );
+
+    for( auto iterator = set.Iterate(); iterator; iterator++ )
+        *iterator += VECTOR2I( 1, 2 );
+
+    checkQueries( set );
+}
+
+/**
+ * Checks that the index follows the changes made through references to the contours kept
+ * across queries.
+ */
+BOOST_AUTO_TEST_CASE( KeptReferences )
+{
+    std::mt19937 rng( 3 );
+    SHAPE_POLY_SET set;
+
+    set.AddOutline( randomChain( rng, 200, 0, 300 ) );
+    set.AddHole( randomChain( rng, 80, 100, 100 ) );
+
+    SHAPE_LINE_CHAIN& outline = set.Outline( 0 );
+    SHAPE_LINE_CHAIN& hole = set.Hole( 0, 0 );
+    SHAPE_POLY_SET::POLYGON& polygon = set.Polygon( 0 );
+
+    checkQueries( set );
+
+    outline.Append( VECTOR2I( 400, 400 ) );
+    checkQueries( set );
+
+    outline.Point( 7 ) = VECTOR2I( -40, 150 );
+    checkQueries( set );
+
+    hole.Move( VECTOR2I( 30, -20 ) );
+    checkQueries( set );
+
+    hole.Remove( 5, 20 );
+    checkQueries( set );
+
+    outline.SetClosed( false );
+    checkQueries( set );
+
+    outline.SetClosed( true );
+
+    // A contour replaced by another one
+    polygon[1] = randomChain( rng, 80, 120, 100 );
+    checkQueries( set );
+
+    // A copy takes the version of the copied contour
+    SHAPE_LINE_CHAIN copy( outline );
+
+    copy.Move( VECTOR2I( 3, 3 ) );
+    outline = copy;
+    checkQueries( set );
+
+    // Const iterations leave the versions alone
+    uint64_t version = outline.Version();
+    const SHAPE_POLY_SET& constSet = set;
+
+    for( auto iterator = constSet.CIterateWithHoles(); iterator; iterator++ )
+        BOOST_CHECK( iterator->x >= INT_MIN );
+
+    BOOST_CHECK_EQUAL( outline.Version(), version );
+
+    // Contours added and removed through the polygon, which moves them
+    polygon.push_back( randomChain( rng, 70, 150, 60 ) );
+    checkQueries( set );
+
+    polygon.erase( polygon.begin() + 1 );
+    checkQueries( set );
+}
+
+/**
+ * Checks IsNearEdge() at the boundary distance, where CollideEdge() rounds the distance
+ * down, on a square small enough not to be indexed and on one large enough to be.
+ */
+BOOST_AUTO_TEST_CASE( NearEdgeBoundary )
+{
+    for( int step : { 10000, 400 } )
+    {
+        SHAPE_LINE_CHAIN square;
+
+        for( int x = 0; x < 10000; x += step )
+            square.Append( VECTOR2I( x, 0 ) );
+
+        for( int y = 0; y < 10000; y += step )
+            square.Append( VECTOR2I( 10000, y ) );
+
+        for( int x = 10000; x > 0; x -= step )
+            square.Append( VECTOR2I( x, 10000 ) );
+
+        for( int y = 10000; y > 0; y -= step )
+            square.Append( VECTOR2I( 0, y ) );
+
+        square.SetClosed( true );
+
+        SHAPE_POLY_SET set;
+        SHAPE_POLY_SET::VERTEX_INDEX closest;
+
+        set.AddOutline( square );
+
+        // 100 units from the bottom edge
+        BOOST_CHECK( set.IsNearEdge( VECTOR2I( 5000, -100 ), 100 ) );
+        BOOST_CHECK( !set.IsNearEdge( VECTOR2I( 5000, -100 ), 99 ) );
+
+        // 5 units from the corner
+        BOOST_CHECK( set.IsNearEdge( VECTOR2I( 10003, 10004 ), 5 ) );
+        BOOST_CHECK( !set.IsNearEdge( VECTOR2I( 10003, 10004 ), 4 ) );
+
+        // sqrt( 34 ) units from the corner: near for CollideEdge() at 5, not for IsNearEdge()
+        BOOST_CHECK( set.CollideEdge( VECTOR2I( 10003, 10005 ), closest, 5 ) );
+        BOOST_CHECK( !set.IsNearEdge( VECTOR2I( 10003, 10005 ), 5 ) );
+        BOOST_CHECK( set.IsNearEdge( VECTOR2I( 10003, 10005 ), 6 ) );
+
+        // Inside, away from the edges
+        BOOST_CHECK( !set.IsNearEdge( VECTOR2I( 5000, 5000 ), 4999 ) );
+        BOOST_CHECK( set.IsNearEdge( VECTOR2I( 5000, 5000 ), 5000 ) );
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,235 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <geometry/seg_batch.h>
+#include <geometry/shape_circle.h>
+#include <geometry/shape_line_chain.h>
+
+#include <qa/data/fixtures_geometry.h>
+
+#include <climits>
+#include <random>
+
+/**
+ * SHAPE_LINE_CHAIN::Collide() as it was before the segments were skipped by SEG_BATCH.
+ */
+static bool referenceCollide( const SHAPE_LINE_CHAIN& aChain, const SEG& aSeg, int aClearance )
+{
+    BOX2I box_a( aSeg.A, aSeg.B - aSeg.A );
+    BOX2I::ecoord_type dist_sq = (BOX2I::ecoord_type) aClearance * aClearance;
+
+    for( int i = 0; i < aChain.SegmentCount(); i++ )
+    {
+        const SEG& s = aChain.CSegment( i );
+        BOX2I box_b( s.A, s.B - s.A );
+
+        if( box_a.SquaredDistance( box_b ) < dist_sq && s.Collide( aSeg, aClearance ) )
+            return true;
+    }
+
+    return false;
+}
+
+
+/**
+ * The collision of a circle with a line chain, as it was before the segments were skipped.
+ */
+static bool referenceCollide( const SHAPE_LINE_CHAIN& aChain, const SHAPE_CIRCLE& aCircle,
+                              int aClearance )
+{
+    for( int i = 0; i < aChain.SegmentCount(); i++ )
+    {
+        if( aCircle.Collide( aChain.CSegment( i ), aClearance ) )
+            return true;
+    }
+
+    return false;
+}
+
+
+/**
+ * The kernels supported by the processor running the tests.
+ */
+static std::vector<SEG_BATCH::KERNEL> supportedKernels()
+{
+    std::vector<SEG_BATCH::KERNEL> kernels;
+
+    for( int k = SEG_BATCH::KERNEL_SCALAR; k <= SEG_BATCH::BestKernel(); k++ )
+        kernels.push_back( (SEG_BATCH::KERNEL) k );
+
+    return kernels;
+}
+
+
+/**
+ * Checks that every kernel finds the same candidates as the scalar test of each segment,
+ * and that the line chain collides with aSeg as it did before. The collisions with a circle
+ * are only compared if aCheckCircle is true: SEG::Distance() overflows with the largest
+ * coordinates, and the skipped segments would then change the result.
+ */
+static void checkQuery( const SHAPE_LINE_CHAIN& aChain, const SEG& aSeg, int aClearance,
+                        bool aCheckCircle = true )
+{
+    const SEG_BATCH batch( aSeg, aClearance );
+    std::vector<int> expected;
+
+    for( int i = 0; i < aChain.SegmentCount(); i++ )
+    {
+        const SEG s = aChain.CSegment( i );
+
+        if( aClearance <= 0 || !batch.Skips( s.A, s.B ) )
+            expected.push_back( i );
+    }
+
+    bool collides = referenceCollide( aChain, aSeg, aClearance );
+    SHAPE_CIRCLE circle( aSeg.A, 3 );
+    const SHAPE& circleShape = circle;
+    bool circleCollides = referenceCollide( aChain, circle, aClearance );
+
+    for( SEG_BATCH::KERNEL kernel : supportedKernels() )
+    {
+        SEG_BATCH::SetKernel( kernel );
+
+        std::vector<int> found;
+
+        for( int i = aChain.NextCandidateSegment( batch, 0 ); i < aChain.SegmentCount();
+             i = aChain.NextCandidateSegment( batch, i + 1 ) )
+            found.push_back( i );
+
+        BOOST_CHECK( found == expected );
+        BOOST_CHECK_EQUAL( aChain.Collide( aSeg, aClearance ), collides );
+
+        if( aCheckCircle )
+            BOOST_CHECK_EQUAL( circleShape.Collide( &aChain, aClearance ), circleCollides );
+    }
+
+    SEG_BATCH::SetKernel( SEG_BATCH::BestKernel() );
+}
+
+
+/**
+ * Declares the CollisionFixture as the boost test suite fixture.
+ */
+BOOST_FIXTURE_TEST_SUITE( SegBatch, CollisionFixture )
+
+/**
+ * Checks the kernels with the segments and the points of the segment and collision tests,
+ * against the outline and the holes of holeyPolySet.
+ */
+BOOST_AUTO_TEST_CASE( Fixtures )
+{
+    std::vector<SHAPE_LINE_CHAIN> chains;
+
+    chains.push_back( common.holeyPolySet.COutline( 0 ) );
+
+    for( int hole = 0; hole < common.holeyPolySet.HoleCount( 0 ); hole++ )
+        chains.push_back( common.holeyPolySet.CHole( 0, hole ) );
+
+    // The same points as a single open chain, long enough for the vector kernels
+    chains.push_back( SHAPE_LINE_CHAIN() );
+
+    for( const VECTOR2I& point : common.holeyPoints )
+        chains.back().Append( point, true );
+
+    std::vector<SEG> queries = common.holeySegments;
+
+    queries.push_back( SEG( VECTOR2I( 10, 20 ), VECTOR2I( 100, 200 ) ) );
+
+    for( const VECTOR2I& point : collidingPoints )
+        queries.push_back( SEG( point, point ) );
+
+    for( const VECTOR2I& point : nonCollidingPoints )
+        queries.push_back( SEG( point, point ) );
+
+    for( const SHAPE_LINE_CHAIN& chain : chains )
+    {
+        for( const SEG& query : queries )
+        {
+            for( int clearance : { -5, 0, 1, 2, 5, 10, 50 } )
+                checkQuery( chain, query, clearance );
+        }
+    }
+}
+
+/**
+ * Checks the kernels with random chains, some of them with coordinates too large for the
+ * bounds of the queries to fit in 32 bits.
+ */
+BOOST_AUTO_TEST_CASE( RandomChains )
+{
+    std::mt19937 rng( 1 );
+
+    for( int iter = 0; iter < 200; iter++ )
+    {
+        bool huge = ( iter % 4 == 3 );
+        int range = huge ? INT_MAX : 1000;
+        std::uniform_int_distribution<int> coord( -range, range );
+        std::uniform_int_distribution<int> count( 0, 40 );
+        SHAPE_LINE_CHAIN chain;
+
+        for( int i = count( rng ); i > 0; i-- )
+            chain.Append( VECTOR2I( coord( rng ), coord( rng ) ), true );
+
+        chain.SetClosed( iter % 2 );
+
+        for( int q = 0; q < 10; q++ )
+        {
+            SEG query( VECTOR2I( coord( rng ), coord( rng ) ),
+                       VECTOR2I( coord( rng ), coord( rng ) ) );
+
+            for( int clearance : { 1, 20, 100, 400 } )
+                checkQuery( chain, query, clearance, !huge );
+        }
+    }
+}
+
+/**
+ * Checks that the closing segment of a closed chain is tested when no segment is skipped:
+ * a circle too large for the batches only reaches the closing segment.
+ */
+BOOST_AUTO_TEST_CASE( ClosingSegmentNotSkipped )
+{
+    const int radius = ( 1 << 26 ) + 1000;
+    SHAPE_LINE_CHAIN chain;
+
+    chain.Append( VECTOR2I( 0, -100000 ) );
+    chain.Append( VECTOR2I( 50000, 0 ) );
+    chain.Append( VECTOR2I( 0, 100000 ) );
+    chain.SetClosed( true );
+
+    SHAPE_CIRCLE circle( VECTOR2I( -radius - 3, 0 ), radius );
+    const SHAPE& circleShape = circle;
+
+    for( SEG_BATCH::KERNEL kernel : supportedKernels() )
+    {
+        SEG_BATCH::SetKernel( kernel );
+
+        BOOST_CHECK( circleShape.Collide( &chain, 5 ) );
+        BOOST_CHECK( !circleShape.Collide( &chain, 1 ) );
+    }
+
+    SEG_BATCH::SetKernel( SEG_BATCH::BestKernel() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
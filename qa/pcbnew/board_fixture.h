@@ -0,0 +1,59 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef BOARD_FIXTURE_H
+#define BOARD_FIXTURE_H
+
+#include <fctsys.h>
+#include <class_board.h>
+#include <io_mgr.h>
+
+#include <wx/filename.h>
+
+#include <memory>
+
+
+/**
+ * Struct BOARD_FIXTURE
+ * the test board of the qa data, loaded with its connectivity for each test. The tests may
+ * modify it.
+ */
+struct BOARD_FIXTURE
+{
+    BOARD_FIXTURE()
+    {
+        m_board.reset( IO_MGR::Load( IO_MGR::KICAD_SEXP, BoardFileName() ) );
+        m_board->BuildConnectivity();
+        m_board->SynchronizeNetsAndNetClasses();
+    }
+
+    static wxString BoardFileName()
+    {
+        return wxFileName( wxT( QA_DATA_DIR ), wxT( "complex_hierarchy.kicad_pcb" ) )
+                .GetFullPath();
+    }
+
+    std::unique_ptr<BOARD> m_board;
+};
+
+#endif  // BOARD_FIXTURE_H
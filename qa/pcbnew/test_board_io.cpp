@@ -0,0 +1,451 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_board_io.cpp
+ * Checks that the board files load and save to the same boards and texts whichever way they
+ * are read and written: the parallel parse of the board sections against the serial one,
+ * the buffered formatting of the tracks and numbers against their former printf() style
+ * formatting, the boards saved and loaded again, and the boards loaded from the binary
+ * snapshots of SNAPSHOT_PLUGIN against the boards the snapshots were made of.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <class_module.h>
+#include <class_track.h>
+#include <kicad_plugin.h>
+#include <pcb_parser.h>
+#include <richio.h>
+#include <snapshot_plugin.h>
+#include <common.h>
+
+#include <wx/filename.h>
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+
+#include "board_fixture.h"
+
+
+/**
+ * The content of the file aFileName.
+ */
+static std::string fileContent( const wxString& aFileName )
+{
+    MAPPED_FILE_LINE_READER reader( aFileName );
+
+    return std::string( reader.Text(), reader.Size() );
+}
+
+
+/**
+ * Loads the board read by aReader, and formats it.
+ */
+static std::string loadAndFormat( LINE_READER& aReader, bool aParallel )
+{
+    PCB_PARSER parser( &aReader );
+
+    parser.SetParallel( aParallel );
+
+    std::unique_ptr<BOARD> board( dynamic_cast<BOARD*>( parser.Parse() ) );
+    PCB_IO io;
+
+    BOOST_REQUIRE( board );
+
+    io.Format( board.get() );
+
+    return io.GetStringOutput( true );
+}
+
+
+/**
+ * Parses aText, expecting a parse error.
+ * @return the error.
+ */
+static PARSE_ERROR parseError( const std::string& aText, bool aParallel )
+{
+    MEMORY_LINE_READER reader( aText.data(), aText.size(), wxT( "test board" ) );
+    PCB_PARSER parser( &reader );
+
+    parser.SetParallel( aParallel );
+
+    try
+    {
+        delete parser.Parse();
+    }
+    catch( const PARSE_ERROR& error )
+    {
+        return error;
+    }
+
+    BOOST_ERROR( "the board is parsed without error" );
+
+    return PARSE_ERROR( wxEmptyString, "", "", 0, "", "", 0, 0 );
+}
+
+
+/**
+ * The former BOARD_ITEM::FormatInternalUnits()
+ */
+static std::string referenceIU( int aValue )
+{
+    char    buf[50];
+    int     len;
+    double  mm = aValue / IU_PER_MM;
+
+    if( mm != 0.0 && fabs( mm ) <= 0.0001 )
+    {
+        len = sprintf( buf, "%.10f", mm );
+
+        while( --len > 0 && buf[len] == '0' )
+            buf[len] = '\0';
+
+        if( buf[len] == '.' )
+            buf[len] = '\0';
+        else
+            ++len;
+    }
+    else
+    {
+        len = sprintf( buf, "%.10g", mm );
+    }
+
+    return std::string( buf, len );
+}
+
+
+static std::string referenceIU( const wxPoint& aPoint )
+{
+    return referenceIU( aPoint.x ) + " " + referenceIU( aPoint.y );
+}
+
+
+/**
+ * The former BOARD_ITEM::FormatAngle()
+ */
+static std::string referenceAngle( double aAngle )
+{
+    char temp[50];
+
+    int len = snprintf( temp, sizeof(temp), "%.10g", aAngle / 10.0 );
+
+    return std::string( temp, len );
+}
+
+
+/**
+ * A PCB_IO which formats the items of a board to its string as its Save() does to a file.
+ */
+class TEST_PCB_IO : public PCB_IO
+{
+public:
+    void SetBoard( BOARD* aBoard )
+    {
+        m_board = aBoard;
+        m_mapping->SetBoard( aBoard );
+    }
+};
+
+
+/**
+ * The former formatting of a track by PCB_IO.
+ */
+static void referenceTrack( OUTPUTFORMATTER& aOut, BOARD* aBoard,
+                            const NETINFO_MAPPING& aMapping, TRACK* aTrack )
+{
+    if( aTrack->Type() == PCB_VIA_T )
+    {
+        PCB_LAYER_ID  layer1, layer2;
+        const VIA*    via = static_cast<const VIA*>( aTrack );
+
+        aOut.Print( 1, "(via" );
+
+        via->LayerPair( &layer1, &layer2 );
+
+        if( via->GetViaType() == VIA_BLIND_BURIED )
+            aOut.Print( 0, " blind" );
+        else if( via->GetViaType() == VIA_MICROVIA )
+            aOut.Print( 0, " micro" );
+
+        aOut.Print( 0, " (at %s) (size %s)", referenceIU( aTrack->GetStart() ).c_str(),
+                    referenceIU( aTrack->GetWidth() ).c_str() );
+
+        if( via->GetDrill() != UNDEFINED_DRILL_DIAMETER )
+            aOut.Print( 0, " (drill %s)", referenceIU( via->GetDrill() ).c_str() );
+
+        aOut.Print( 0, " (layers %s %s)",
+                    aOut.Quotew( aBoard->GetLayerName( layer1 ) ).c_str(),
+                    aOut.Quotew( aBoard->GetLayerName( layer2 ) ).c_str() );
+    }
+    else
+    {
+        aOut.Print( 1, "(segment (start %s) (end %s) (width %s)",
+                    referenceIU( aTrack->GetStart() ).c_str(),
+                    referenceIU( aTrack->GetEnd() ).c_str(),
+                    referenceIU( aTrack->GetWidth() ).c_str() );
+
+        aOut.Print( 0, " (layer %s)", aOut.Quotew( aTrack->GetLayerName() ).c_str() );
+    }
+
+    aOut.Print( 0, " (net %d)", aMapping.Translate( aTrack->GetNetCode() ) );
+
+    if( aTrack->GetTimeStamp() != 0 )
+        aOut.Print( 0, " (tstamp %lX)", (unsigned long)aTrack->GetTimeStamp() );
+
+    if( aTrack->GetStatus() != 0 )
+        aOut.Print( 0, " (status %X)", aTrack->GetStatus() );
+
+    aOut.Print( 0, ")\n" );
+}
+
+
+BOOST_AUTO_TEST_SUITE( BoardIo )
+
+
+BOOST_AUTO_TEST_CASE( ParallelParseMatchesSerialParse )
+{
+    wxString fileName = BOARD_FIXTURE::BoardFileName();
+    std::string reference;
+    std::string text;
+
+    {
+        FILE_LINE_READER reader( fileName );
+        reference = loadAndFormat( reader, false );
+    }
+
+    {
+        MAPPED_FILE_LINE_READER reader( fileName );
+        text = loadAndFormat( reader, false );
+    }
+
+    BOOST_CHECK( text == reference );
+
+    {
+        MAPPED_FILE_LINE_READER reader( fileName );
+        text = loadAndFormat( reader, true );
+    }
+
+    BOOST_CHECK( text == reference );
+}
+
+
+/**
+ * The sections parsed in parallel report the error a serial parse meets first.
+ */
+BOOST_AUTO_TEST_CASE( ParallelParseReportsFirstError )
+{
+    std::string text = fileContent( BOARD_FIXTURE::BoardFileName() );
+    std::string::size_type layer = text.find( "(layer ", text.find( "(module " ) );
+    std::string::size_type segment = text.rfind( "(segment (start" );
+
+    BOOST_REQUIRE( layer != std::string::npos && segment != std::string::npos );
+
+    // An unknown keyword in the first module, and the last segment not closed
+    text.replace( segment, 9, "(segment (" );
+    text.replace( layer, 7, "(lazer " );
+
+    PARSE_ERROR serial = parseError( text, false );
+    PARSE_ERROR parallel = parseError( text, true );
+
+    BOOST_CHECK( parallel.Problem() == serial.Problem() );
+    BOOST_CHECK_EQUAL( parallel.lineNumber, serial.lineNumber );
+    BOOST_CHECK_EQUAL( parallel.byteIndex, serial.byteIndex );
+}
+
+
+/**
+ * The coordinates and angles, over ranges of values and the ones of the board, are formatted
+ * as before.
+ */
+BOOST_FIXTURE_TEST_CASE( NumbersFormatAsBefore, BOARD_FIXTURE )
+{
+    std::vector<int> values;
+    std::vector<double> angles;
+    std::mt19937 rng( 1 );
+    int mismatches = 0;
+
+    for( int value = -1000000; value <= 1000000; ++value )
+        values.push_back( value );
+
+    for( int i = 0; i < 1000000; ++i )
+        values.push_back( (int) rng() );
+
+    values.push_back( std::numeric_limits<int>::max() );
+    values.push_back( std::numeric_limits<int>::min() );
+
+    for( TRACK* track = m_board->m_Track; track; track = track->Next() )
+    {
+        values.push_back( track->GetStart().x );
+        values.push_back( track->GetStart().y );
+        values.push_back( track->GetEnd().x );
+        values.push_back( track->GetEnd().y );
+        values.push_back( track->GetWidth() );
+    }
+
+    for( int angle = -36000; angle <= 36000; ++angle )
+        angles.push_back( angle );
+
+    angles.push_back( 0.5 );
+    angles.push_back( -0.0 );
+    angles.push_back( 1e12 );
+
+    for( MODULE* module = m_board->m_Modules; module; module = module->Next() )
+        angles.push_back( module->GetOrientation() );
+
+    for( int value : values )
+    {
+        if( BOARD_ITEM::FormatInternalUnits( value ) != referenceIU( value ) )
+            mismatches++;
+    }
+
+    for( double angle : angles )
+    {
+        if( BOARD_ITEM::FormatAngle( angle ) != referenceAngle( angle ) )
+            mismatches++;
+    }
+
+    BOOST_CHECK_EQUAL( mismatches, 0 );
+}
+
+
+/**
+ * The tracks are formatted as before.
+ */
+BOOST_FIXTURE_TEST_CASE( TracksFormatAsBefore, BOARD_FIXTURE )
+{
+    BOARD* board = m_board.get();
+    TEST_PCB_IO io;
+    NETINFO_MAPPING mapping;
+    LOCALE_IO toggle;
+
+    io.SetBoard( board );
+    mapping.SetBoard( board );
+
+    for( TRACK* track = board->m_Track; track; track = track->Next() )
+    {
+        STRING_FORMATTER reference;
+
+        referenceTrack( reference, board, mapping, track );
+        io.Format( track, 1 );
+
+        BOOST_CHECK_EQUAL( io.GetStringOutput( true ), reference.GetString() );
+    }
+}
+
+
+/**
+ * A saved board loads to a board which saves to the same file, and the file holds the text
+ * PCB_IO::Format() gives of the board, between its header line and its closing parenthesis.
+ */
+BOOST_FIXTURE_TEST_CASE( SavedBoardLoadsBack, BOARD_FIXTURE )
+{
+    PCB_IO fileIo;
+    TEST_PCB_IO io;
+    wxString fileName = wxFileName::CreateTempFileName( wxT( "qa_pcbnew" ) );
+
+    fileIo.Save( fileName, m_board.get() );
+
+    std::string saved = fileContent( fileName );
+    std::string text;
+
+    {
+        LOCALE_IO toggle;
+
+        io.SetBoard( m_board.get() );
+        io.Format( m_board.get(), 1 );
+        text = io.GetStringOutput( true );
+    }
+
+    std::string::size_type header = saved.find( '\n' ) + 1;
+
+    BOOST_CHECK( saved.size() == header + text.size() + 2 );
+    BOOST_CHECK( saved.compare( header, text.size(), text ) == 0 );
+
+    std::unique_ptr<BOARD> loaded( fileIo.Load( fileName, NULL ) );
+
+    BOOST_REQUIRE( loaded );
+
+    fileIo.Save( fileName, loaded.get() );
+    BOOST_CHECK( fileContent( fileName ) == saved );
+
+    wxRemoveFile( fileName );
+}
+
+/**
+ * The boards loaded from the snapshots save to the same files as the boards the snapshots
+ * were made of, whether the snapshot is written by SNAPSHOT_PLUGIN::Save() or made by
+ * SNAPSHOT_PLUGIN::Load(), and a snapshot is ignored once its board file has changed.
+ */
+BOOST_FIXTURE_TEST_CASE( SnapshotLoadsSavedBoard, BOARD_FIXTURE )
+{
+    PCB_IO fileIo;
+    SNAPSHOT_PLUGIN plugin;
+
+    wxString fileName = wxFileName::CreateTempFileName( wxT( "qa_pcbnew" ) );
+    wxString checkName = wxFileName::CreateTempFileName( wxT( "qa_pcbnew" ) );
+    wxString snapshotName = SNAPSHOT_PLUGIN::SnapshotFileName( fileName );
+
+    // The snapshot written along the board file
+    plugin.Save( fileName, m_board.get() );
+
+    std::string saved = fileContent( fileName );
+    std::unique_ptr<BOARD> loaded( plugin.LoadSnapshot( fileName ) );
+
+    BOOST_REQUIRE( loaded );
+
+    fileIo.Save( checkName, loaded.get() );
+    BOOST_CHECK( fileContent( checkName ) == saved );
+
+    // The snapshot made by the load of the board file
+    wxRemoveFile( snapshotName );
+    loaded.reset( plugin.Load( fileName, NULL ) );
+
+    BOOST_REQUIRE( loaded );
+    BOOST_CHECK( wxFileExists( snapshotName ) );
+
+    loaded.reset( plugin.LoadSnapshot( fileName ) );
+
+    BOOST_REQUIRE( loaded );
+
+    fileIo.Save( checkName, loaded.get() );
+    BOOST_CHECK( fileContent( checkName ) == saved );
+
+    // Once the board file has changed, its snapshot is out of date
+    {
+        FILE_OUTPUTFORMATTER out( fileName, wxT( "at" ) );
+        out.Print( 0, "\n" );
+    }
+
+    loaded.reset( plugin.LoadSnapshot( fileName ) );
+    BOOST_CHECK( !loaded );
+
+    wxRemoveFile( fileName );
+    wxRemoveFile( checkName );
+    wxRemoveFile( snapshotName );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
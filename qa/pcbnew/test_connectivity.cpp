@@ -0,0 +1,193 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_connectivity.cpp
+ * Checks the connectivity and the ratsnest of a board updated after each edit, as a commit
+ * does, against the ones built from scratch for the edited board.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <class_module.h>
+#include <class_track.h>
+#include <connectivity.h>
+#include <connectivity_algo.h>
+#include <ratsnest_data.h>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <set>
+
+#include "board_fixture.h"
+
+
+/// A cluster: its net and its items, sorted
+typedef std::pair<int, std::vector<const BOARD_CONNECTED_ITEM*>> CLUSTER_KEY;
+
+
+static std::set<CLUSTER_KEY> clusterKeys( CONNECTIVITY_DATA& aConnectivity )
+{
+    std::set<CLUSTER_KEY> keys;
+
+    for( const auto& cluster : aConnectivity.GetConnectivityAlgo()->GetClusters() )
+    {
+        CLUSTER_KEY key;
+
+        key.first = cluster->OriginNet();
+
+        for( CN_ITEM* item : *cluster )
+            key.second.push_back( item->Parent() );
+
+        std::sort( key.second.begin(), key.second.end() );
+        keys.insert( key );
+    }
+
+    return keys;
+}
+
+
+/**
+ * Moves random modules and tracks of aBoard, updating its connectivity and ratsnest after
+ * each move. The moves are the same from run to run.
+ */
+static void moveItems( BOARD* aBoard, int aCount )
+{
+    auto connectivity = aBoard->GetConnectivity();
+    std::vector<BOARD_ITEM*> tracks;
+    std::vector<BOARD_ITEM*> modules;
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+        tracks.push_back( track );
+
+    for( MODULE* module = aBoard->m_Modules; module; module = module->Next() )
+        modules.push_back( module );
+
+    BOOST_REQUIRE( !tracks.empty() && !modules.empty() );
+
+    std::mt19937 rng( 1 );
+    std::uniform_int_distribution<int> offset( -500000, 500000 );   // +/- 0.5 mm
+
+    for( int ii = 0; ii < aCount; ++ii )
+    {
+        std::vector<BOARD_ITEM*>& items = rng() % 4 == 0 ? modules : tracks;
+        BOARD_ITEM* item = items[ rng() % items.size() ];
+
+        item->Move( wxPoint( offset( rng ), offset( rng ) ) );
+        connectivity->Update( item );
+        connectivity->RecalculateRatsnest();
+    }
+}
+
+
+/**
+ * The number and the total length of the ratsnest lines of each net. Equal length lines
+ * may be chosen in another order, but the spanning trees have the same length.
+ */
+static std::map<int, std::pair<int, long long>> ratsnestKeys( CONNECTIVITY_DATA& aConnectivity )
+{
+    std::map<int, std::pair<int, long long>> keys;
+
+    for( int net = 1; net < aConnectivity.GetNetCount(); ++net )
+    {
+        RN_NET* rn = aConnectivity.GetRatsnestForNet( net );
+
+        if( !rn )
+            continue;
+
+        std::pair<int, long long>& key = keys[net];
+
+        for( const CN_EDGE& edge : rn->GetUnconnected() )
+        {
+            key.first++;
+            key.second += edge.GetWeight();
+        }
+    }
+
+    return keys;
+}
+
+
+BOOST_FIXTURE_TEST_SUITE( Connectivity, BOARD_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( UpdatedClustersMatchBuild )
+{
+    BOARD* board = m_board.get();
+    auto connectivity = board->GetConnectivity();
+
+    moveItems( board, 100 );
+
+    CONNECTIVITY_DATA reference;
+
+    reference.Build( board );
+
+    BOOST_CHECK( clusterKeys( *connectivity ) == clusterKeys( reference ) );
+    BOOST_CHECK_EQUAL( connectivity->GetUnconnectedCount(), reference.GetUnconnectedCount() );
+}
+
+
+/**
+ * The ratsnest of a net links its clusters: it has one line less than the net has
+ * clusters.
+ */
+BOOST_AUTO_TEST_CASE( RatsnestLinksClusters )
+{
+    BOARD* board = m_board.get();
+    auto connectivity = board->GetConnectivity();
+
+    moveItems( board, 100 );
+
+    std::map<int, int> netClusters;
+    unsigned int expected = 0;
+
+    for( const auto& cluster : connectivity->GetConnectivityAlgo()->GetClusters() )
+        netClusters[ cluster->OriginNet() ]++;
+
+    for( const auto& entry : netClusters )
+    {
+        if( entry.first > 0 )
+            expected += entry.second - 1;
+    }
+
+    BOOST_CHECK_EQUAL( connectivity->GetUnconnectedCount(), expected );
+}
+
+
+BOOST_AUTO_TEST_CASE( UpdatedRatsnestMatchesBuild )
+{
+    BOARD* board = m_board.get();
+    auto connectivity = board->GetConnectivity();
+
+    moveItems( board, 100 );
+
+    CONNECTIVITY_DATA reference;
+
+    reference.Build( board );
+
+    BOOST_CHECK( ratsnestKeys( *connectivity ) == ratsnestKeys( reference ) );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,245 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_drc.cpp
+ * Checks the track and pad clearance markers of the DRC engine: the parallel full test
+ * must give the markers of a test of the items one after the other, and the live DRC
+ * updated after edits the markers of a full test of the edited board.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+#include <class_marker_pcb.h>
+#include <drc_live_context.h>
+
+#include <memory>
+#include <random>
+#include <set>
+#include <tuple>
+
+#include "board_fixture.h"
+
+
+/// Identifies a marker independently of its address
+typedef std::tuple<const BOARD_ITEM*, int, int, int, int, int, int, int> MARKER_KEY;
+
+
+static std::set<MARKER_KEY> markerKeys( const DRC_LIVE_CONTEXT& aContext )
+{
+    std::set<MARKER_KEY> keys;
+
+    for( const auto& entry : aContext.GetMarkers() )
+    {
+        const MARKER_PCB* marker = entry.second;
+        const DRC_ITEM& rpt = marker->GetReporter();
+
+        keys.insert( MARKER_KEY( entry.first, rpt.GetErrorCode(),
+                                 marker->GetPosition().x, marker->GetPosition().y,
+                                 rpt.GetPointA().x, rpt.GetPointA().y,
+                                 rpt.GetPointB().x, rpt.GetPointB().y ) );
+    }
+
+    return keys;
+}
+
+
+/**
+ * Moves every tenth track onto a through hole pad of another net, so that the board has
+ * clearance violations.
+ * @return the moved tracks.
+ */
+static std::vector<BOARD_ITEM*> moveTracksOntoPads( BOARD* aBoard )
+{
+    std::vector<D_PAD*> pads;
+    std::vector<BOARD_ITEM*> moved;
+
+    for( MODULE* module = aBoard->m_Modules; module; module = module->Next() )
+    {
+        for( D_PAD* pad = module->PadsList(); pad; pad = pad->Next() )
+        {
+            if( pad->GetAttribute() == PAD_ATTRIB_STANDARD )
+                pads.push_back( pad );
+        }
+    }
+
+    if( pads.empty() )
+        return moved;
+
+    int ii = 0;
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next(), ++ii )
+    {
+        if( ii % 10 )
+            continue;
+
+        D_PAD* pad = pads[ ( ii / 10 ) % pads.size() ];
+
+        if( pad->GetNetCode() == track->GetNetCode() )
+            continue;
+
+        track->Move( pad->GetPosition() - track->GetStart() );
+        moved.push_back( track );
+    }
+
+    return moved;
+}
+
+
+BOOST_FIXTURE_TEST_SUITE( Drc, BOARD_FIXTURE )
+
+
+/**
+ * The full test runs on the thread pool. An update of all the items tests them again one
+ * after the other, in the same order, on this thread.
+ */
+BOOST_AUTO_TEST_CASE( ParallelMatchesSerial )
+{
+    BOARD* board = m_board.get();
+
+    BOOST_REQUIRE( !moveTracksOntoPads( board ).empty() );
+
+    DRC_LIVE_CONTEXT parallel( board, false );
+    DRC_LIVE_CONTEXT serial( board, false );
+    std::vector<BOARD_ITEM*> all;
+    std::vector<BOARD_ITEM*> none;
+    int itemCount = 0;
+
+    for( TRACK* track = board->m_Track; track; track = track->Next() )
+    {
+        all.push_back( track );
+        itemCount++;
+    }
+
+    for( MODULE* module = board->m_Modules; module; module = module->Next() )
+    {
+        all.push_back( module );
+        itemCount += module->GetPadCount();
+    }
+
+    parallel.Rebuild();
+    serial.Rebuild();
+    serial.Update( none, all, none );
+
+    BOOST_CHECK_EQUAL( serial.GetLastResult().m_itemsTested, itemCount );
+
+    std::set<MARKER_KEY> parallelKeys = markerKeys( parallel );
+    std::set<MARKER_KEY> serialKeys = markerKeys( serial );
+
+    BOOST_CHECK( !parallelKeys.empty() );
+    BOOST_CHECK( parallelKeys == serialKeys );
+}
+
+
+/**
+ * Random edits (moves of modules and tracks, tracks added and removed), each followed by
+ * an update of the live DRC, as a commit does.
+ */
+BOOST_AUTO_TEST_CASE( LiveUpdatesMatchFullTest )
+{
+    BOARD* board = m_board.get();
+    DRC_LIVE_CONTEXT live( board, false );
+    std::vector<TRACK*> tracks;
+    std::vector<MODULE*> modules;
+    std::vector<std::unique_ptr<TRACK>> removedTracks;
+    std::vector<BOARD_ITEM*> none;
+
+    moveTracksOntoPads( board );
+    live.Rebuild();
+
+    for( TRACK* track = board->m_Track; track; track = track->Next() )
+        tracks.push_back( track );
+
+    for( MODULE* module = board->m_Modules; module; module = module->Next() )
+        modules.push_back( module );
+
+    BOOST_REQUIRE( tracks.size() > 1 && !modules.empty() );
+
+    // The edits are the same from run to run
+    std::mt19937 rng( 1 );
+    std::uniform_int_distribution<int> offset( -500000, 500000 );   // +/- 0.5 mm
+
+    for( int ii = 0; ii < 200; ++ii )
+    {
+        std::vector<BOARD_ITEM*> changed( 1 );
+        wxPoint delta( offset( rng ), offset( rng ) );
+
+        switch( rng() % 5 )
+        {
+        case 0:
+            changed[0] = modules[ rng() % modules.size() ];
+            changed[0]->Move( delta );
+            live.Update( none, changed, none );
+            break;
+
+        case 1:
+            if( tracks.size() > 1 )
+            {
+                // Removed tracks are kept alive, as the undo list does
+                size_t idx = rng() % tracks.size();
+
+                changed[0] = tracks[idx];
+                tracks.erase( tracks.begin() + idx );
+                board->Remove( changed[0] );
+                removedTracks.emplace_back( static_cast<TRACK*>( changed[0] ) );
+                live.Update( none, none, changed );
+            }
+
+            break;
+
+        case 2:
+        {
+            TRACK* track = static_cast<TRACK*>( tracks[ rng() % tracks.size() ]->Clone() );
+
+            track->Move( delta );
+            board->Add( track );
+            tracks.push_back( track );
+            changed[0] = track;
+            live.Update( changed, none, none );
+            break;
+        }
+
+        default:
+            changed[0] = tracks[ rng() % tracks.size() ];
+            changed[0]->Move( delta );
+            live.Update( none, changed, none );
+            break;
+        }
+    }
+
+    DRC_LIVE_CONTEXT reference( board, false );
+
+    reference.Rebuild();
+
+    std::set<MARKER_KEY> liveKeys = markerKeys( live );
+    std::set<MARKER_KEY> referenceKeys = markerKeys( reference );
+
+    BOOST_CHECK( !referenceKeys.empty() );
+    BOOST_CHECK( liveKeys == referenceKeys );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,298 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_footprint_list.cpp
+ * Checks the footprint list of a library made of the modules of the board, read by
+ * FOOTPRINT_LIST_IMPL with its library index against the list read by parsing all the
+ * footprint files, and against the footprints loaded by PCB_IO, before and after a footprint
+ * is changed since the index was written, and with a footprint file which cannot be read
+ * until it is fixed.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <class_module.h>
+#include <footprint_info_impl.h>
+#include <fp_lib_table.h>
+#include <kicad_plugin.h>
+#include <lib_id.h>
+#include <richio.h>
+#include <wildcards_and_files_ext.h>
+
+#include <wx/dir.h>
+#include <wx/filename.h>
+
+#include <cstdlib>
+#include <memory>
+
+#include "board_fixture.h"
+
+
+/**
+ * Sets the modification time of the library aLibPath and of its files to aTime, so that the
+ * index does not take them for files being written.
+ */
+static void setLibraryTime( const wxString& aLibPath, const wxDateTime& aTime )
+{
+    wxDir    dir( aLibPath );
+    wxString fileName;
+
+    if( dir.GetFirst( &fileName, wxEmptyString, wxDIR_FILES ) )
+    {
+        do
+        {
+            wxFileName( aLibPath, fileName ).SetTimes( &aTime, &aTime, NULL );
+        } while( dir.GetNext( &fileName ) );
+    }
+
+    wxFileName::DirName( aLibPath ).SetTimes( &aTime, &aTime, NULL );
+}
+
+
+/**
+ * The count of the footprints of aList which differ from the ones PCB_IO loads from aLibPath.
+ */
+static int countMismatches( FOOTPRINT_LIST& aList, const wxString& aLibPath )
+{
+    PCB_IO          io;
+    wxArrayString   names;
+    int             mismatches = 0;
+
+    io.FootprintEnumerate( names, aLibPath );
+
+    if( names.size() != aList.GetCount() )
+        return std::abs( (int) names.size() - (int) aList.GetCount() );
+
+    for( unsigned i = 0; i < aList.GetCount(); ++i )
+    {
+        FOOTPRINT_INFO& info = aList.GetItem( i );
+        std::unique_ptr<MODULE> footprint( io.FootprintLoad( aLibPath, info.GetFootprintName() ) );
+
+        if( !footprint
+                || info.GetDoc() != footprint->GetDescription()
+                || info.GetKeywords() != footprint->GetKeywords()
+                || info.GetPadCount() != footprint->GetPadCount( DO_NOT_INCLUDE_NPTH )
+                || info.GetUniquePadCount()
+                        != footprint->GetUniquePadCount( DO_NOT_INCLUDE_NPTH ) )
+            mismatches++;
+    }
+
+    return mismatches;
+}
+
+
+/**
+ * Writes aText to the file aFileName.
+ */
+static void writeFile( const wxString& aFileName, const std::string& aText )
+{
+    FILE_OUTPUTFORMATTER out( aFileName );
+
+    out.Print( 0, "%s", aText.c_str() );
+}
+
+
+/**
+ * A footprint library holding the modules of the test board as FP0, FP1..., in the library
+ * table of the test, without index.
+ */
+struct LIBRARY_FIXTURE : public BOARD_FIXTURE
+{
+    LIBRARY_FIXTURE()
+    {
+        PCB_IO io;
+        unsigned n = 0;
+
+        m_libPath = wxFileName::CreateTempFileName( wxT( "qa_pcbnew" ) );
+        wxRemoveFile( m_libPath );
+        m_libPath += wxT( "." ) + KiCadFootprintLibPathExtension;
+
+        io.FootprintLibCreate( m_libPath );
+
+        for( MODULE* module = m_board->m_Modules; module; module = module->Next() )
+        {
+            MODULE footprint( *module );
+
+            footprint.SetFPID( LIB_ID( wxString::Format( wxT( "FP%u" ), n++ ) ) );
+            io.FootprintSave( m_libPath, &footprint );
+        }
+
+        m_footprintCount = n;
+
+        setLibraryTime( m_libPath, wxDateTime::Now() - wxTimeSpan::Hours( 1 ) );
+
+        m_table.InsertRow( new FP_LIB_TABLE_ROW( wxT( "qa" ), m_libPath, wxT( "KiCad" ),
+                                                 wxEmptyString ) );
+        m_indexFile = FOOTPRINT_LIST_IMPL::IndexFileName( m_libPath );
+        wxRemoveFile( m_indexFile );
+    }
+
+    ~LIBRARY_FIXTURE()
+    {
+        wxRemoveFile( m_indexFile );
+        wxFileName::Rmdir( m_libPath, wxPATH_RMDIR_RECURSIVE );
+    }
+
+    wxString        m_libPath;
+    wxString        m_indexFile;
+    FP_LIB_TABLE    m_table;
+    unsigned        m_footprintCount;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( FootprintList, LIBRARY_FIXTURE )
+
+
+/**
+ * The list read with the index written by a first read, which parses all the files, holds
+ * the same footprints as the parsed list.
+ */
+BOOST_AUTO_TEST_CASE( IndexedListMatchesParsedList )
+{
+    FOOTPRINT_LIST_IMPL parsed;
+    FOOTPRINT_LIST_IMPL indexed;
+
+    parsed.ReadFootprintFiles( &m_table );
+
+    BOOST_REQUIRE( wxFileExists( m_indexFile ) );
+
+    indexed.ReadFootprintFiles( &m_table );
+
+    BOOST_CHECK_EQUAL( parsed.GetErrorCount(), 0u );
+    BOOST_CHECK_EQUAL( indexed.GetErrorCount(), 0u );
+    BOOST_CHECK_EQUAL( parsed.GetCount(), m_footprintCount );
+    BOOST_REQUIRE_EQUAL( indexed.GetCount(), parsed.GetCount() );
+
+    for( unsigned i = 0; i < parsed.GetCount(); ++i )
+    {
+        BOOST_CHECK( indexed.GetItem( i ).GetFootprintName()
+                     == parsed.GetItem( i ).GetFootprintName() );
+    }
+
+    BOOST_CHECK_EQUAL( countMismatches( parsed, m_libPath ), 0 );
+    BOOST_CHECK_EQUAL( countMismatches( indexed, m_libPath ), 0 );
+}
+
+
+/**
+ * A footprint changed since the index was written is read again.
+ */
+BOOST_AUTO_TEST_CASE( ChangedFootprintIsReadAgain )
+{
+    {
+        FOOTPRINT_LIST_IMPL parsed;
+
+        parsed.ReadFootprintFiles( &m_table );
+    }
+
+    BOOST_REQUIRE( wxFileExists( m_indexFile ) );
+    BOOST_REQUIRE( m_footprintCount > 0 );
+
+    PCB_IO io;
+    std::unique_ptr<MODULE> footprint( io.FootprintLoad( m_libPath, wxT( "FP0" ) ) );
+    wxString description = footprint->GetDescription() + wxT( " (changed)" );
+    wxDateTime changed = wxDateTime::Now() - wxTimeSpan::Minutes( 30 );
+
+    footprint->SetDescription( description );
+    io.FootprintSave( m_libPath, footprint.get() );
+
+    // Only this file is parsed again, the others keep their time
+    wxFileName( m_libPath, wxT( "FP0" ), KiCadFootprintFileExtension )
+            .SetTimes( &changed, &changed, NULL );
+    wxFileName::DirName( m_libPath ).SetTimes( &changed, &changed, NULL );
+
+    FOOTPRINT_LIST_IMPL indexed;
+
+    indexed.ReadFootprintFiles( &m_table );
+
+    FOOTPRINT_INFO* info = indexed.GetModuleInfo( wxT( "qa:FP0" ) );
+
+    BOOST_REQUIRE( info );
+    BOOST_CHECK( info->GetDoc() == description );
+    BOOST_CHECK_EQUAL( countMismatches( indexed, m_libPath ), 0 );
+}
+
+
+/**
+ * A footprint file which cannot be read is reported by each read of the list, also when the
+ * index lists the files, and is listed once fixed, even if the directory is unchanged.
+ */
+BOOST_AUTO_TEST_CASE( FailedFootprintIsReadAgain )
+{
+    BOOST_REQUIRE( m_footprintCount > 0 );
+
+    wxString    goodFile = wxFileName( m_libPath, wxT( "FP0" ), KiCadFootprintFileExtension )
+                                   .GetFullPath();
+    wxString    badFile = wxFileName( m_libPath, wxT( "FPbad" ), KiCadFootprintFileExtension )
+                                  .GetFullPath();
+    std::string text;
+
+    {
+        MAPPED_FILE_LINE_READER reader( goodFile );
+
+        text = std::string( reader.Text(), reader.Size() );
+    }
+
+    std::string broken = text;
+    std::string::size_type layer = broken.find( "(layer " );
+
+    BOOST_REQUIRE( layer != std::string::npos );
+    broken.replace( layer, 7, "(lazer " );
+    writeFile( badFile, broken );
+
+    wxDateTime libTime = wxDateTime::Now() - wxTimeSpan::Hours( 1 );
+
+    setLibraryTime( m_libPath, libTime );
+
+    for( int read = 0; read < 2; ++read )
+    {
+        FOOTPRINT_LIST_IMPL list;
+
+        list.ReadFootprintFiles( &m_table );
+
+        BOOST_CHECK_EQUAL( list.GetErrorCount(), 1u );
+        BOOST_CHECK_EQUAL( list.GetCount(), m_footprintCount );
+        BOOST_CHECK( !list.GetModuleInfo( wxT( "qa:FPbad" ) ) );
+        BOOST_REQUIRE( wxFileExists( m_indexFile ) );
+    }
+
+    // Fixed in place: the directory keeps its time, the index lists the files
+    wxDateTime changed = wxDateTime::Now() - wxTimeSpan::Minutes( 30 );
+
+    writeFile( badFile, text );
+    wxFileName( badFile ).SetTimes( &changed, &changed, NULL );
+    wxFileName::DirName( m_libPath ).SetTimes( &libTime, &libTime, NULL );
+
+    FOOTPRINT_LIST_IMPL list;
+
+    list.ReadFootprintFiles( &m_table );
+
+    BOOST_CHECK_EQUAL( list.GetErrorCount(), 0u );
+    BOOST_CHECK_EQUAL( list.GetCount(), m_footprintCount + 1 );
+    BOOST_CHECK( list.GetModuleInfo( wxT( "qa:FPbad" ) ) );
+    BOOST_CHECK_EQUAL( countMismatches( list, m_libPath ), 0 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,73 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Main file of the pcbnew tests: the process level objects they need.
+ */
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "Pcbnew module"
+
+#include <boost/test/unit_test.hpp>
+
+#include <wx/init.h>
+
+#include <fctsys.h>
+#include <pgm_base.h>
+
+
+/**
+ * Struct PGM_TEST
+ * the process level object the pcbnew objects expect. The tests do not use it.
+ */
+static struct PGM_TEST : public PGM_BASE
+{
+    void MacOpenFile( const wxString& aFileName ) override
+    {
+    }
+} program;
+
+
+PGM_BASE& Pgm()
+{
+    return program;
+}
+
+
+/**
+ * Initializes wxWidgets for all the tests, as wxInitializer does for a program.
+ */
+struct WX_FIXTURE
+{
+    WX_FIXTURE()
+    {
+        wxInitialize();
+    }
+
+    ~WX_FIXTURE()
+    {
+        wxUninitialize();
+    }
+};
+
+BOOST_GLOBAL_FIXTURE( WX_FIXTURE );
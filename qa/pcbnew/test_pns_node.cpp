@@ -0,0 +1,203 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_pns_node.cpp
+ * Checks the root items overridden by the router branches: a branch sees the items
+ * overridden by its parent, and the items overridden later by the parent, a sibling or a
+ * child are not seen by the others.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <router/pns_node.h>
+#include <router/pns_segment.h>
+
+#include <memory>
+#include <random>
+#include <set>
+
+
+/// A root node with a few segments of the same net
+struct ROOT_FIXTURE
+{
+    ROOT_FIXTURE() :
+        m_root( new PNS::NODE )
+    {
+        for( int i = 0; i < 4; i++ )
+        {
+            std::unique_ptr<PNS::SEGMENT> seg( new PNS::SEGMENT(
+                    SEG( VECTOR2I( 0, i * 1000000 ), VECTOR2I( 5000000, i * 1000000 ) ), 1 ) );
+
+            m_segs.push_back( seg.get() );
+            m_root->Add( std::move( seg ) );
+        }
+    }
+
+    ~ROOT_FIXTURE()
+    {
+        m_root->KillChildren();
+        delete m_root;
+    }
+
+    PNS::NODE* m_root;
+    std::vector<PNS::SEGMENT*> m_segs;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( PnsNode, ROOT_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( BranchSeesParentOverrides )
+{
+    PNS::NODE* a = m_root->Branch();
+    a->Remove( m_segs[0] );
+
+    BOOST_CHECK( a->Overrides( m_segs[0] ) );
+    BOOST_CHECK( !a->Overrides( m_segs[1] ) );
+    BOOST_CHECK( !m_root->Overrides( m_segs[0] ) );
+
+    PNS::NODE* b = a->Branch();
+
+    BOOST_CHECK( b->Overrides( m_segs[0] ) );
+
+    b->Remove( m_segs[1] );
+
+    BOOST_CHECK( b->Overrides( m_segs[1] ) );
+    BOOST_CHECK( !a->Overrides( m_segs[1] ) );
+}
+
+
+BOOST_AUTO_TEST_CASE( LaterOverridesNotShared )
+{
+    PNS::NODE* a = m_root->Branch();
+    a->Remove( m_segs[0] );
+
+    PNS::NODE* b = a->Branch();
+    PNS::NODE* c = a->Branch();
+
+    // The parent after branching
+    a->Remove( m_segs[1] );
+
+    // A sibling
+    b->Remove( m_segs[2] );
+
+    BOOST_CHECK( a->Overrides( m_segs[1] ) );
+    BOOST_CHECK( !a->Overrides( m_segs[2] ) );
+
+    BOOST_CHECK( b->Overrides( m_segs[0] ) );
+    BOOST_CHECK( !b->Overrides( m_segs[1] ) );
+    BOOST_CHECK( b->Overrides( m_segs[2] ) );
+
+    BOOST_CHECK( c->Overrides( m_segs[0] ) );
+    BOOST_CHECK( !c->Overrides( m_segs[1] ) );
+    BOOST_CHECK( !c->Overrides( m_segs[2] ) );
+}
+
+
+BOOST_AUTO_TEST_CASE( UpdatedItemsInRemovalOrder )
+{
+    PNS::NODE* a = m_root->Branch();
+    a->Remove( m_segs[2] );
+    a->Remove( m_segs[0] );
+
+    PNS::NODE* b = a->Branch();
+    b->Remove( m_segs[3] );
+
+    PNS::NODE::ITEM_VECTOR removed, added;
+    b->GetUpdatedItems( removed, added );
+
+    PNS::NODE::ITEM_VECTOR expected = { m_segs[2], m_segs[0], m_segs[3] };
+
+    BOOST_CHECK( removed == expected );
+    BOOST_CHECK( added.empty() );
+
+    m_root->Commit( b );
+
+    std::set<PNS::ITEM*> segs;
+    m_root->AllItemsInNet( 1, segs );
+
+    BOOST_CHECK_EQUAL( segs.size(), 1 );
+    BOOST_CHECK( segs.count( m_segs[1] ) );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
+
+
+BOOST_AUTO_TEST_SUITE( PnsOverrideSet )
+
+
+/**
+ * Grows sets shared as the branches share them, and checks each against a std::set.
+ */
+BOOST_AUTO_TEST_CASE( SameAsStdSet )
+{
+    // Stand-ins for the items, as far apart as items
+    struct FAKE_ITEM
+    {
+        long long m_data[4];
+    };
+
+    std::vector<FAKE_ITEM> items( 5000 );
+    std::mt19937 rng( 42 );
+    std::uniform_int_distribution<size_t> pick( 0, items.size() - 1 );
+
+    std::vector<PNS::OVERRIDE_SET> sets( 1 );
+    std::vector<std::set<PNS::ITEM*>> refs( 1 );
+
+    for( int step = 0; step < 20000; step++ )
+    {
+        size_t n = rng() % sets.size();
+
+        if( rng() % 100 == 0 )
+        {
+            // A branch
+            sets.push_back( sets[n] );
+            refs.push_back( refs[n] );
+            continue;
+        }
+
+        PNS::ITEM* item = reinterpret_cast<PNS::ITEM*>( &items[pick( rng )] );
+
+        sets[n].Insert( item );
+        refs[n].insert( item );
+    }
+
+    for( size_t n = 0; n < sets.size(); n++ )
+    {
+        BOOST_REQUIRE_EQUAL( sets[n].Size(), refs[n].size() );
+
+        std::set<PNS::ITEM*> listed( sets[n].begin(), sets[n].end() );
+        BOOST_CHECK( listed == refs[n] );
+
+        for( FAKE_ITEM& fake : items )
+        {
+            PNS::ITEM* item = reinterpret_cast<PNS::ITEM*>( &fake );
+            BOOST_CHECK_EQUAL( sets[n].Contains( item ), refs[n].count( item ) > 0 );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
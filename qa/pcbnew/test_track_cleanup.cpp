@@ -0,0 +1,257 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_track_cleanup.cpp
+ * Checks the position queries of the track cleanup (duplicated tracks, tracks connected at
+ * each track end, pads under the track ends) done through the board spatial index against
+ * walks of the board lists, before and after edits of the board. The cleanup itself needs
+ * an edit frame to commit its changes to.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+#include <board_item_index.h>
+
+#include <memory>
+#include <random>
+
+#include "board_fixture.h"
+
+
+/// The items found by the queries for all the tracks, in the order they were found
+struct CLEANUP_QUERIES
+{
+    std::vector<const BOARD_ITEM*> m_duplicates;
+    std::vector<const BOARD_ITEM*> m_connected;
+    std::vector<const BOARD_ITEM*> m_onPad;
+
+    bool operator==( const CLEANUP_QUERIES& aOther ) const
+    {
+        return m_duplicates == aOther.m_duplicates && m_connected == aOther.m_connected
+               && m_onPad == aOther.m_onPad;
+    }
+};
+
+
+static bool isDuplicate( const TRACK* aTrack, const TRACK* aOther )
+{
+    return aTrack != aOther && aTrack->GetNetCode() == aOther->GetNetCode()
+           && aTrack->Type() == aOther->Type() && aTrack->GetLayer() == aOther->GetLayer()
+           && ( ( aTrack->GetStart() == aOther->GetStart() && aTrack->GetEnd() == aOther->GetEnd() )
+             || ( aTrack->GetStart() == aOther->GetEnd() && aTrack->GetEnd() == aOther->GetStart() ) );
+}
+
+
+static bool isConnected( const TRACK* aTrack, const TRACK* aOther, const wxPoint& aPosition )
+{
+    return aTrack != aOther && aTrack->GetNetCode() == aOther->GetNetCode()
+           && ( aTrack->GetLayerSet() & aOther->GetLayerSet() ).any()
+           && ( aOther->GetStart() == aPosition || aOther->GetEnd() == aPosition );
+}
+
+
+/// The queries walking the board lists, as the cleanup did
+static void linearQueries( BOARD* aBoard, CLEANUP_QUERIES& aResult )
+{
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+    {
+        for( TRACK* other = aBoard->m_Track; other; other = other->Next() )
+        {
+            if( isDuplicate( track, other ) )
+                aResult.m_duplicates.push_back( other );
+        }
+
+        for( ENDPOINT_T endpoint = ENDPOINT_START; endpoint <= ENDPOINT_END;
+                endpoint = ENDPOINT_T( endpoint + 1 ) )
+        {
+            const wxPoint& position = track->GetEndPoint( endpoint );
+
+            for( TRACK* other = aBoard->m_Track; other; other = other->Next() )
+            {
+                if( isConnected( track, other, position ) )
+                    aResult.m_connected.push_back( other );
+            }
+
+            for( MODULE* module = aBoard->m_Modules; module; module = module->Next() )
+            {
+                for( D_PAD* pad = module->PadsList(); pad; pad = pad->Next() )
+                {
+                    if( ( pad->GetLayerSet() & track->GetLayerSet() ).any()
+                            && pad->HitTest( position ) )
+                        aResult.m_onPad.push_back( pad );
+                }
+            }
+        }
+    }
+}
+
+
+/// The same queries, through the board spatial index
+static void indexedQueries( BOARD* aBoard, CLEANUP_QUERIES& aResult )
+{
+    BOARD_ITEM_INDEX* index = aBoard->GetItemIndex();
+    std::vector<TRACK*> tracks;
+    std::vector<D_PAD*> pads;
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+    {
+        index->QueryTracks( track->GetStart(), tracks );
+
+        for( TRACK* other : tracks )
+        {
+            if( isDuplicate( track, other ) )
+                aResult.m_duplicates.push_back( other );
+        }
+
+        for( ENDPOINT_T endpoint = ENDPOINT_START; endpoint <= ENDPOINT_END;
+                endpoint = ENDPOINT_T( endpoint + 1 ) )
+        {
+            const wxPoint& position = track->GetEndPoint( endpoint );
+
+            index->QueryTracks( position, tracks );
+
+            for( TRACK* other : tracks )
+            {
+                if( isConnected( track, other, position ) )
+                    aResult.m_connected.push_back( other );
+            }
+
+            index->QueryPads( position, pads );
+
+            for( D_PAD* pad : pads )
+            {
+                if( ( pad->GetLayerSet() & track->GetLayerSet() ).any()
+                        && pad->HitTest( position ) )
+                    aResult.m_onPad.push_back( pad );
+            }
+        }
+    }
+}
+
+
+static void checkQueries( BOARD* aBoard )
+{
+    CLEANUP_QUERIES reference;
+    CLEANUP_QUERIES result;
+
+    linearQueries( aBoard, reference );
+    indexedQueries( aBoard, result );
+
+    BOOST_CHECK( !reference.m_connected.empty() );
+    BOOST_CHECK( result == reference );
+}
+
+
+BOOST_FIXTURE_TEST_SUITE( TrackCleanup, BOARD_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( IndexedQueriesMatchListWalks )
+{
+    checkQueries( m_board.get() );
+}
+
+
+/**
+ * Edits done as the commits do them: the items changed in place are given to the index,
+ * the added and removed ones go through BOARD::Add() and BOARD::Remove().
+ */
+BOOST_AUTO_TEST_CASE( IndexedQueriesMatchListWalksAfterEdits )
+{
+    BOARD* board = m_board.get();
+    std::vector<TRACK*> tracks;
+    std::vector<MODULE*> modules;
+    std::vector<std::unique_ptr<TRACK>> removedTracks;
+
+    // The index is built by the first query
+    checkQueries( board );
+
+    for( TRACK* track = board->m_Track; track; track = track->Next() )
+        tracks.push_back( track );
+
+    for( MODULE* module = board->m_Modules; module; module = module->Next() )
+        modules.push_back( module );
+
+    std::mt19937 rng( 1 );
+    std::uniform_int_distribution<int> offset( -500000, 500000 );   // +/- 0.5 mm
+
+    for( int ii = 0; ii < 100; ++ii )
+    {
+        wxPoint delta( offset( rng ), offset( rng ) );
+
+        switch( rng() % 5 )
+        {
+        case 0:
+        {
+            MODULE* module = modules[ rng() % modules.size() ];
+
+            module->Move( delta );
+            board->UpdateItemIndex( module );
+            break;
+        }
+
+        case 1:
+            if( tracks.size() > 1 )
+            {
+                size_t idx = rng() % tracks.size();
+
+                board->Remove( tracks[idx] );
+                removedTracks.emplace_back( tracks[idx] );
+                tracks.erase( tracks.begin() + idx );
+            }
+
+            break;
+
+        case 2:
+        {
+            // A duplicate, or a track connected to an end of the original one
+            TRACK* track = static_cast<TRACK*>( tracks[ rng() % tracks.size() ]->Clone() );
+
+            if( rng() % 2 )
+                track->Move( track->GetEnd() - track->GetStart() );
+
+            board->Add( track );
+            tracks.push_back( track );
+            break;
+        }
+
+        default:
+        {
+            TRACK* track = tracks[ rng() % tracks.size() ];
+
+            track->Move( delta );
+            board->UpdateItemIndex( track );
+            break;
+        }
+        }
+
+        if( ii % 10 == 9 )
+            checkQueries( board );
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
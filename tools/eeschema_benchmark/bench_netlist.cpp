@@ -0,0 +1,677 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file bench_netlist.cpp
+ * Builds the netlist of the schematic, timing the connection of its items, the whole
+ * NETLIST_OBJECT_LIST::BuildNetListInfo() and the KiCad netlist export.
+ * The nets found by NETLIST_OBJECT_LIST::ConnectItems() are checked against the ones found
+ * by the connection functions it replaced, which scanned the list for each item and for each
+ * merge of two nets: the items having the same code must be the same, whatever the codes.
+ * The netlist is also built again with a NETLIST_SHEET_CACHE, when no screen changed and
+ * when the root screen changed, and checked against the netlist built without it.
+ */
+
+#include <fctsys.h>
+#include <class_netlist_object.h>
+#include <sch_sheet_path.h>
+#include <trigo.h>
+#include <richio.h>
+#include <netlist_exporter_kicad.h>
+#include <class_sch_screen.h>
+
+#include <unordered_map>
+
+#include "eeschema_benchmark.h"
+
+#define IS_WIRE false
+#define IS_BUS true
+
+
+/**
+ * Class SCAN_CONNECTIONS
+ * the connection functions of NETLIST_OBJECT_LIST before ConnectItems(): each of them
+ * scans the list, and so does each merge of two nets.
+ */
+class SCAN_CONNECTIONS
+{
+public:
+    SCAN_CONNECTIONS( NETLIST_OBJECT_LIST& aList ) :
+        m_list( aList ),
+        m_lastNetCode( 1 ),
+        m_lastBusNetCode( 1 )
+    {
+    }
+
+    /**
+     * Function Run
+     * gives the net codes to the items of the list, sorted by sheet.
+     */
+    void Run();
+
+private:
+    void propagateNetCode( int aOldNetCode, int aNewNetCode, bool aIsBus );
+    void labelConnect( NETLIST_OBJECT* aLabelRef );
+    void sheetLabelConnect( NETLIST_OBJECT* aSheetLabel );
+    void pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus, int start );
+    void segmentToPointConnect( NETLIST_OBJECT* aJonction, bool aIsBus, int aIdxStart );
+    void connectBusLabels();
+
+    NETLIST_OBJECT_LIST&    m_list;
+    int                     m_lastNetCode;
+    int                     m_lastBusNetCode;
+};
+
+
+void SCAN_CONNECTIONS::Run()
+{
+    SCH_SHEET_PATH* sheet;
+    sheet = &(m_list.GetItem( 0 )->m_SheetPath);
+    for( unsigned ii = 0, istart = 0; ii < m_list.size(); ii++ )
+    {
+        NETLIST_OBJECT* net_item = m_list.GetItem( ii );
+
+        if( net_item->m_SheetPath != *sheet )   // Sheet change
+        {
+            sheet  = &(net_item->m_SheetPath);
+            istart = ii;
+        }
+
+        switch( net_item->m_Type )
+        {
+        case NET_ITEM_UNSPECIFIED:
+            wxMessageBox( wxT( "BuildNetListInfo() error" ) );
+            break;
+
+        case NET_PIN:
+        case NET_PINLABEL:
+        case NET_SHEETLABEL:
+        case NET_NOCONNECT:
+            if( net_item->GetNet() != 0 )
+                break;
+
+        case NET_SEGMENT:
+            // Test connections point to point type without bus.
+            if( net_item->GetNet() == 0 )
+            {
+                net_item->SetNet( m_lastNetCode );
+                m_lastNetCode++;
+            }
+
+            pointToPointConnect( net_item, IS_WIRE, istart );
+            break;
+
+        case NET_JUNCTION:
+            // Control of the junction outside BUS.
+            if( net_item->GetNet() == 0 )
+            {
+                net_item->SetNet( m_lastNetCode );
+                m_lastNetCode++;
+            }
+
+            segmentToPointConnect( net_item, IS_WIRE, istart );
+
+            // Control of the junction, on BUS.
+            if( net_item->m_BusNetCode == 0 )
+            {
+                net_item->m_BusNetCode = m_lastBusNetCode;
+                m_lastBusNetCode++;
+            }
+
+            segmentToPointConnect( net_item, IS_BUS, istart );
+            break;
+
+        case NET_LABEL:
+        case NET_HIERLABEL:
+        case NET_GLOBLABEL:
+            // Test connections type junction without bus.
+            if( net_item->GetNet() == 0 )
+            {
+                net_item->SetNet( m_lastNetCode );
+                m_lastNetCode++;
+            }
+
+            segmentToPointConnect( net_item, IS_WIRE, istart );
+            break;
+
+        case NET_SHEETBUSLABELMEMBER:
+            if( net_item->m_BusNetCode != 0 )
+                break;
+
+        case NET_BUS:
+            // Control type connections point to point mode bus
+            if( net_item->m_BusNetCode == 0 )
+            {
+                net_item->m_BusNetCode = m_lastBusNetCode;
+                m_lastBusNetCode++;
+            }
+
+            pointToPointConnect( net_item, IS_BUS, istart );
+            break;
+
+        case NET_BUSLABELMEMBER:
+        case NET_HIERBUSLABELMEMBER:
+        case NET_GLOBBUSLABELMEMBER:
+            // Control connections similar has on BUS
+            if( net_item->GetNet() == 0 )
+            {
+                net_item->m_BusNetCode = m_lastBusNetCode;
+                m_lastBusNetCode++;
+            }
+
+            segmentToPointConnect( net_item, IS_BUS, istart );
+            break;
+        }
+    }
+
+    // Updating the Bus Labels Netcode connected by Bus
+    connectBusLabels();
+
+    // Group objects by label.
+    for( unsigned ii = 0; ii < m_list.size(); ii++ )
+    {
+        switch( m_list.GetItem( ii )->m_Type )
+        {
+        case NET_PIN:
+        case NET_SHEETLABEL:
+        case NET_SEGMENT:
+        case NET_JUNCTION:
+        case NET_BUS:
+        case NET_NOCONNECT:
+            break;
+
+        case NET_LABEL:
+        case NET_GLOBLABEL:
+        case NET_PINLABEL:
+        case NET_BUSLABELMEMBER:
+        case NET_GLOBBUSLABELMEMBER:
+            labelConnect( m_list.GetItem( ii ) );
+            break;
+
+        case NET_SHEETBUSLABELMEMBER:
+        case NET_HIERLABEL:
+        case NET_HIERBUSLABELMEMBER:
+            break;
+
+        case NET_ITEM_UNSPECIFIED:
+            break;
+        }
+    }
+
+    // Connection between hierarchy sheets
+    for( unsigned ii = 0; ii < m_list.size(); ii++ )
+    {
+        if( m_list.GetItem( ii )->m_Type == NET_SHEETLABEL
+            || m_list.GetItem( ii )->m_Type == NET_SHEETBUSLABELMEMBER )
+            sheetLabelConnect( m_list.GetItem( ii ) );
+    }
+
+}
+
+void SCAN_CONNECTIONS::sheetLabelConnect( NETLIST_OBJECT* SheetLabel )
+{
+    if( SheetLabel->GetNet() == 0 )
+        return;
+
+    for( unsigned ii = 0; ii < m_list.size(); ii++ )
+    {
+        NETLIST_OBJECT* ObjetNet = m_list.GetItem( ii );
+
+        if( ObjetNet->m_SheetPath != SheetLabel->m_SheetPathInclude )
+            continue;  //use SheetInclude, not the sheet!!
+
+        if( (ObjetNet->m_Type != NET_HIERLABEL ) && (ObjetNet->m_Type != NET_HIERBUSLABELMEMBER ) )
+            continue;
+
+        if( ObjetNet->GetNet() == SheetLabel->GetNet() )
+            continue;  //already connected.
+
+        if( ObjetNet->m_Label != SheetLabel->m_Label )
+            continue;  //different names.
+
+        // Propagate Netcode having all the objects of the same Netcode.
+        if( ObjetNet->GetNet() )
+            propagateNetCode( ObjetNet->GetNet(), SheetLabel->GetNet(), IS_WIRE );
+        else
+            ObjetNet->SetNet( SheetLabel->GetNet() );
+    }
+}
+
+
+void SCAN_CONNECTIONS::connectBusLabels()
+{
+    // Propagate the net code between all bus label member objects connected by they name.
+    // If the net code is not yet existing, a new one is created
+    // Search is done in the entire list
+    for( unsigned ii = 0; ii < m_list.size(); ii++ )
+    {
+        NETLIST_OBJECT* Label = m_list.GetItem( ii );
+
+        if( Label->IsLabelBusMemberType() )
+        {
+            if( Label->GetNet() == 0 )
+            {
+                // Not yet existiing net code: create a new one.
+                Label->SetNet( m_lastNetCode );
+                m_lastNetCode++;
+            }
+
+            for( unsigned jj = ii + 1; jj < m_list.size(); jj++ )
+            {
+                NETLIST_OBJECT* LabelInTst =  m_list.GetItem( jj );
+
+                if( LabelInTst->IsLabelBusMemberType() )
+                {
+                    if( LabelInTst->m_BusNetCode != Label->m_BusNetCode )
+                        continue;
+
+                    if( LabelInTst->m_Member != Label->m_Member )
+                        continue;
+
+                    if( LabelInTst->GetNet() == 0 )
+                        // Append this object to the current net
+                        LabelInTst->SetNet( Label->GetNet() );
+                    else
+                        // Merge the 2 net codes, they are connected.
+                        propagateNetCode( LabelInTst->GetNet(), Label->GetNet(), IS_WIRE );
+                }
+            }
+        }
+    }
+}
+
+
+void SCAN_CONNECTIONS::propagateNetCode( int aOldNetCode, int aNewNetCode, bool aIsBus )
+{
+    if( aOldNetCode == aNewNetCode )
+        return;
+
+    if( aIsBus == false )    // Propagate NetCode
+    {
+        for( unsigned jj = 0; jj < m_list.size(); jj++ )
+        {
+            NETLIST_OBJECT* object = m_list.GetItem( jj );
+
+            if( object->GetNet() == aOldNetCode )
+                object->SetNet( aNewNetCode );
+        }
+    }
+    else               // Propagate BusNetCode
+    {
+        for( unsigned jj = 0; jj < m_list.size(); jj++ )
+        {
+            NETLIST_OBJECT* object = m_list.GetItem( jj );
+
+            if( object->m_BusNetCode == aOldNetCode )
+                object->m_BusNetCode = aNewNetCode;
+        }
+    }
+}
+
+
+void SCAN_CONNECTIONS::pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus, int start )
+{
+    int netCode;
+
+    if( aIsBus == false )    // Objects other than BUS and BUSLABELS
+    {
+        netCode = aRef->GetNet();
+
+        for( unsigned i = start; i < m_list.size(); i++ )
+        {
+            NETLIST_OBJECT* item = m_list.GetItem( i );
+
+            if( item->m_SheetPath != aRef->m_SheetPath )  //used to be > (why?)
+                continue;
+
+            switch( item->m_Type )
+            {
+            case NET_SEGMENT:
+            case NET_PIN:
+            case NET_LABEL:
+            case NET_HIERLABEL:
+            case NET_GLOBLABEL:
+            case NET_SHEETLABEL:
+            case NET_PINLABEL:
+            case NET_JUNCTION:
+            case NET_NOCONNECT:
+                if( aRef->m_Start == item->m_Start
+                    || aRef->m_Start == item->m_End
+                    || aRef->m_End   == item->m_Start
+                    || aRef->m_End   == item->m_End )
+                {
+                    if( item->GetNet() == 0 )
+                        item->SetNet( netCode );
+                    else
+                        propagateNetCode( item->GetNet(), netCode, IS_WIRE );
+                }
+                break;
+
+            case NET_BUS:
+            case NET_BUSLABELMEMBER:
+            case NET_SHEETBUSLABELMEMBER:
+            case NET_HIERBUSLABELMEMBER:
+            case NET_GLOBBUSLABELMEMBER:
+            case NET_ITEM_UNSPECIFIED:
+                break;
+            }
+        }
+    }
+    else    // Object type BUS, BUSLABELS, and junctions.
+    {
+        netCode = aRef->m_BusNetCode;
+
+        for( unsigned i = start; i < m_list.size(); i++ )
+        {
+            NETLIST_OBJECT* item = m_list.GetItem( i );
+
+            if( item->m_SheetPath != aRef->m_SheetPath )
+                continue;
+
+            switch( item->m_Type )
+            {
+            case NET_ITEM_UNSPECIFIED:
+            case NET_SEGMENT:
+            case NET_PIN:
+            case NET_LABEL:
+            case NET_HIERLABEL:
+            case NET_GLOBLABEL:
+            case NET_SHEETLABEL:
+            case NET_PINLABEL:
+            case NET_NOCONNECT:
+                break;
+
+            case NET_BUS:
+            case NET_BUSLABELMEMBER:
+            case NET_SHEETBUSLABELMEMBER:
+            case NET_HIERBUSLABELMEMBER:
+            case NET_GLOBBUSLABELMEMBER:
+            case NET_JUNCTION:
+                if(  aRef->m_Start == item->m_Start
+                  || aRef->m_Start == item->m_End
+                  || aRef->m_End   == item->m_Start
+                  || aRef->m_End   == item->m_End )
+                {
+                    if( item->m_BusNetCode == 0 )
+                        item->m_BusNetCode = netCode;
+                    else
+                        propagateNetCode( item->m_BusNetCode, netCode, IS_BUS );
+                }
+                break;
+            }
+        }
+    }
+}
+
+
+void SCAN_CONNECTIONS::segmentToPointConnect( NETLIST_OBJECT* aJonction,
+                                                 bool aIsBus, int aIdxStart )
+{
+    for( unsigned i = aIdxStart; i < m_list.size(); i++ )
+    {
+        NETLIST_OBJECT* segment = m_list.GetItem( i );
+
+        // if different sheets, obviously no physical connection between elements.
+        if( segment->m_SheetPath != aJonction->m_SheetPath )
+            continue;
+
+        if( aIsBus == IS_WIRE )
+        {
+            if( segment->m_Type != NET_SEGMENT )
+                continue;
+        }
+        else
+        {
+            if( segment->m_Type != NET_BUS )
+                continue;
+        }
+
+        if( IsPointOnSegment( segment->m_Start, segment->m_End, aJonction->m_Start ) )
+        {
+            // Propagation Netcode has all the objects of the same Netcode.
+            if( aIsBus == IS_WIRE )
+            {
+                if( segment->GetNet() )
+                    propagateNetCode( segment->GetNet(), aJonction->GetNet(), aIsBus );
+                else
+                    segment->SetNet( aJonction->GetNet() );
+            }
+            else
+            {
+                if( segment->m_BusNetCode )
+                    propagateNetCode( segment->m_BusNetCode, aJonction->m_BusNetCode, aIsBus );
+                else
+                    segment->m_BusNetCode = aJonction->m_BusNetCode;
+            }
+        }
+    }
+}
+
+
+void SCAN_CONNECTIONS::labelConnect( NETLIST_OBJECT* aLabelRef )
+{
+    if( aLabelRef->GetNet() == 0 )
+        return;
+
+    for( unsigned i = 0; i < m_list.size(); i++ )
+    {
+        NETLIST_OBJECT* item = m_list.GetItem( i );
+
+        if( item->GetNet() == aLabelRef->GetNet() )
+            continue;
+
+        if( item->m_SheetPath != aLabelRef->m_SheetPath )
+        {
+            if( item->m_Type != NET_PINLABEL && item->m_Type != NET_GLOBLABEL
+                && item->m_Type != NET_GLOBBUSLABELMEMBER )
+                continue;
+
+            if( (item->m_Type == NET_GLOBLABEL
+                 || item->m_Type == NET_GLOBBUSLABELMEMBER)
+               && item->m_Type != aLabelRef->m_Type )
+                //global labels only connect other global labels.
+                continue;
+        }
+
+        // NET_HIERLABEL are used to connect sheets.
+        // NET_LABEL are local to a sheet
+        // NET_GLOBLABEL are global.
+        // NET_PINLABEL is a kind of global label (generated by a power pin invisible)
+        if( item->IsLabelType() )
+        {
+            if( item->m_Label != aLabelRef->m_Label )
+                continue;
+
+            if( item->GetNet() )
+                propagateNetCode( item->GetNet(), aLabelRef->GetNet(), IS_WIRE );
+            else
+                item->SetNet( aLabelRef->GetNet() );
+        }
+    }
+}
+
+
+/**
+ * The items of the netlist of aSheets, sorted by sheet, as BuildNetListInfo() connects them.
+ */
+static void collectItems( SCH_SHEET_LIST& aSheets, NETLIST_OBJECT_LIST& aItems )
+{
+    for( unsigned i = 0; i < aSheets.size(); i++ )
+    {
+        SCH_SHEET_PATH* sheet = &aSheets[i];
+
+        for( SCH_ITEM* item = sheet->LastScreen()->GetDrawItems(); item; item = item->Next() )
+            item->GetNetListItem( aItems, sheet );
+    }
+
+    aItems.SortListbySheet();
+}
+
+
+/**
+ * @return true if the items having the same code in aCodes have the same code in aOther.
+ */
+static bool sameSets( const std::vector<int>& aCodes, const std::vector<int>& aOther )
+{
+    std::unordered_map<int, int> codes;
+    std::unordered_map<int, int> others;
+
+    for( unsigned ii = 0; ii < aCodes.size(); ii++ )
+    {
+        if( codes.emplace( aCodes[ii], aOther[ii] ).first->second != aOther[ii]
+                || others.emplace( aOther[ii], aCodes[ii] ).first->second != aCodes[ii] )
+            return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * @return true if aList and aOther have the same items with the same codes.
+ */
+static bool sameNetlist( const NETLIST_OBJECT_LIST& aList, const NETLIST_OBJECT_LIST& aOther )
+{
+    if( aList.size() != aOther.size() )
+        return false;
+
+    for( unsigned ii = 0; ii < aList.size(); ii++ )
+    {
+        const NETLIST_OBJECT* item = aList.GetItem( ii );
+        const NETLIST_OBJECT* other = aOther.GetItem( ii );
+
+        if( item->m_Comp != other->m_Comp || item->m_Type != other->m_Type
+                || item->GetNet() != other->GetNet() || item->m_BusNetCode != other->m_BusNetCode )
+            return false;
+    }
+
+    return true;
+}
+
+
+bool bench_netlist( BENCH_CONTEXT& aContext )
+{
+    std::ostream& os = aContext.m_out;
+    SCH_SHEET_LIST& sheets = aContext.GetSheets();
+    long long collectUs = 0;
+    long long scanUs = 0;
+    long long connectUs = 0;
+    long long buildUs = 0;
+    long long cachedUs = 0;
+    long long changedUs = 0;
+    long long exportUs = 0;
+    unsigned itemCount = 0;
+    int mismatches = 0;
+
+    for( int rep = 0; rep < aContext.m_reps; ++rep )
+    {
+        NETLIST_OBJECT_LIST reference;
+        NETLIST_OBJECT_LIST items;
+
+        TIME_PT start = CLOCK::now();
+        collectItems( sheets, reference );
+        collectUs += elapsedUs( start );
+
+        if( reference.empty() )
+            break;
+
+        for( NETLIST_OBJECT* item : reference )
+            items.push_back( new NETLIST_OBJECT( *item ) );
+
+        start = CLOCK::now();
+        SCAN_CONNECTIONS( reference ).Run();
+        scanUs += elapsedUs( start );
+
+        start = CLOCK::now();
+        items.ConnectItems();
+        connectUs += elapsedUs( start );
+
+        itemCount = items.size();
+        mismatches = 0;
+
+        std::vector<int> nets, referenceNets, buses, referenceBuses;
+
+        for( unsigned ii = 0; ii < items.size(); ii++ )
+        {
+            nets.push_back( items.GetItemNet( ii ) );
+            referenceNets.push_back( reference.GetItemNet( ii ) );
+            buses.push_back( items.GetItem( ii )->m_BusNetCode );
+            referenceBuses.push_back( reference.GetItem( ii )->m_BusNetCode );
+        }
+
+        if( !sameSets( nets, referenceNets ) || !sameSets( buses, referenceBuses ) )
+            mismatches++;
+
+        // The whole netlist, and its export (which owns it)
+        NETLIST_OBJECT_LIST* netlist = new NETLIST_OBJECT_LIST();
+
+        start = CLOCK::now();
+        netlist->BuildNetListInfo( sheets );
+        buildUs += elapsedUs( start );
+
+        // Again, keeping the items of the sheets which did not change
+        NETLIST_SHEET_CACHE cache;
+        NETLIST_OBJECT_LIST filled, cached, changed;
+
+        filled.BuildNetListInfo( sheets, &cache );
+
+        start = CLOCK::now();
+        cached.BuildNetListInfo( sheets, &cache );
+        cachedUs += elapsedUs( start );
+
+        sheets[0].LastScreen()->NewRevision();
+
+        start = CLOCK::now();
+        changed.BuildNetListInfo( sheets, &cache );
+        changedUs += elapsedUs( start );
+
+        if( !sameNetlist( *netlist, filled ) || !sameNetlist( *netlist, cached )
+                || !sameNetlist( *netlist, changed ) )
+            mismatches++;
+
+        NETLIST_EXPORTER_KICAD exporter( netlist, aContext.GetLibs() );
+        STRING_FORMATTER formatter;
+
+        start = CLOCK::now();
+        exporter.Format( &formatter, GNL_ALL );
+        exportUs += elapsedUs( start );
+    }
+
+    int reps = aContext.m_reps;
+
+    os << wxString::Format( "  %u items in %d sheets", itemCount, (int) sheets.size() )
+       << std::endl;
+    os << wxString::Format( "  collect:          %10lld us", collectUs / reps ) << std::endl;
+    os << wxString::Format( "  connect (scan):   %10lld us", scanUs / reps ) << std::endl;
+    os << wxString::Format( "  connect (hashed): %10lld us, x%.2f", connectUs / reps,
+                            connectUs ? (double) scanUs / connectUs : 0.0 ) << std::endl;
+    os << wxString::Format( "  build netlist:    %10lld us", buildUs / reps ) << std::endl;
+    os << wxString::Format( "  cached, same:     %10lld us, x%.2f", cachedUs / reps,
+                            cachedUs ? (double) buildUs / cachedUs : 0.0 ) << std::endl;
+    os << wxString::Format( "  cached, root new: %10lld us, x%.2f", changedUs / reps,
+                            changedUs ? (double) buildUs / changedUs : 0.0 ) << std::endl;
+    os << wxString::Format( "  kicad export:     %10lld us", exportUs / reps ) << std::endl;
+    os << wxString::Format( "  %d netlist mismatches", mismatches ) << std::endl;
+
+    return mismatches == 0;
+}
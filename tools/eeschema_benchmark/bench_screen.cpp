@@ -0,0 +1,190 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file bench_screen.cpp
+ * Times the position queries of the screens of the schematic and their dangling end test,
+ * which go through the spatial index of the draw items of each SCH_SCREEN.
+ * The results are checked against the walks of the draw list these functions replaced:
+ * the dangling end test against all the end points of the screen, GetItem() and
+ * CountConnectedItems() at each connection point of each item.
+ */
+
+#include <fctsys.h>
+#include <sch_item_struct.h>
+#include <sch_sheet_path.h>
+#include <class_sch_screen.h>
+
+#include <vector>
+
+#include "eeschema_benchmark.h"
+
+
+/**
+ * The dangling end test before the index: each item against all the end points.
+ */
+static void scanDanglingEnds( SCH_SCREEN* aScreen, std::vector<bool>& aStates )
+{
+    std::vector< DANGLING_END_ITEM > endPoints;
+
+    for( SCH_ITEM* item = aScreen->GetDrawItems(); item; item = item->Next() )
+        item->GetEndPoints( endPoints );
+
+    for( SCH_ITEM* item = aScreen->GetDrawItems(); item; item = item->Next() )
+    {
+        item->IsDanglingStateChanged( endPoints );
+        aStates.push_back( item->IsDangling() );
+    }
+}
+
+
+/**
+ * The first item of the draw list of aScreen hit at aPosition.
+ */
+static SCH_ITEM* scanItem( SCH_SCREEN* aScreen, const wxPoint& aPosition )
+{
+    for( SCH_ITEM* item = aScreen->GetDrawItems(); item; item = item->Next() )
+    {
+        if( item->HitTest( aPosition, 0 ) )
+            return item;
+    }
+
+    return NULL;
+}
+
+
+/**
+ * The count of the items of the draw list of aScreen connected at aPosition.
+ */
+static int scanConnectedItems( SCH_SCREEN* aScreen, const wxPoint& aPosition )
+{
+    int count = 0;
+
+    for( SCH_ITEM* item = aScreen->GetDrawItems(); item; item = item->Next() )
+    {
+        if( item->IsConnected( aPosition ) )
+            count++;
+    }
+
+    return count;
+}
+
+
+bool bench_screen( BENCH_CONTEXT& aContext )
+{
+    std::ostream& os = aContext.m_out;
+
+    // Loads the hierarchy
+    aContext.GetSheets();
+
+    SCH_SCREENS screens;
+    long long scanDanglingUs = 0;
+    long long danglingUs = 0;
+    long long scanQueryUs = 0;
+    long long queryUs = 0;
+    unsigned itemCount = 0;
+    unsigned queryCount = 0;
+    int mismatches = 0;
+
+    for( int rep = 0; rep < aContext.m_reps; ++rep )
+    {
+        itemCount = 0;
+        queryCount = 0;
+        mismatches = 0;
+
+        for( SCH_SCREEN* screen = screens.GetFirst(); screen; screen = screens.GetNext() )
+        {
+            std::vector<bool> reference;
+            std::vector<bool> states;
+            std::vector<wxPoint> points;
+
+            TIME_PT start = CLOCK::now();
+            scanDanglingEnds( screen, reference );
+            scanDanglingUs += elapsedUs( start );
+
+            start = CLOCK::now();
+            screen->TestDanglingEnds();
+            danglingUs += elapsedUs( start );
+
+            for( SCH_ITEM* item = screen->GetDrawItems(); item; item = item->Next() )
+            {
+                states.push_back( item->IsDangling() );
+                item->GetConnectionPoints( points );
+            }
+
+            if( states != reference )
+                mismatches++;
+
+            itemCount += states.size();
+            queryCount += points.size();
+
+            std::vector<SCH_ITEM*> referenceItems;
+            std::vector<int> referenceCounts;
+
+            start = CLOCK::now();
+
+            for( const wxPoint& point : points )
+            {
+                referenceItems.push_back( scanItem( screen, point ) );
+                referenceCounts.push_back( scanConnectedItems( screen, point ) );
+            }
+
+            scanQueryUs += elapsedUs( start );
+
+            std::vector<SCH_ITEM*> items;
+            std::vector<int> counts;
+
+            // The first query builds the index
+            screen->NewRevision();
+            start = CLOCK::now();
+
+            for( const wxPoint& point : points )
+            {
+                items.push_back( screen->GetItem( point ) );
+                counts.push_back( screen->CountConnectedItems( point, true ) );
+            }
+
+            queryUs += elapsedUs( start );
+
+            if( items != referenceItems || counts != referenceCounts )
+                mismatches++;
+        }
+    }
+
+    int reps = aContext.m_reps;
+
+    os << wxString::Format( "  %u items, %u connection points", itemCount, queryCount )
+       << std::endl;
+    os << wxString::Format( "  dangling ends (scan):    %10lld us", scanDanglingUs / reps )
+       << std::endl;
+    os << wxString::Format( "  dangling ends (indexed): %10lld us, x%.2f", danglingUs / reps,
+                            danglingUs ? (double) scanDanglingUs / danglingUs : 0.0 )
+       << std::endl;
+    os << wxString::Format( "  queries (scan):          %10lld us", scanQueryUs / reps )
+       << std::endl;
+    os << wxString::Format( "  queries (indexed):       %10lld us, x%.2f", queryUs / reps,
+                            queryUs ? (double) scanQueryUs / queryUs : 0.0 ) << std::endl;
+    os << wxString::Format( "  %d screen mismatches", mismatches ) << std::endl;
+
+    return mismatches == 0;
+}
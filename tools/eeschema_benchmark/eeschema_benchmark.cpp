@@ -0,0 +1,266 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file eeschema_benchmark.cpp
+ * Runs the eeschema benchmarks on a hierarchy made of copies of a schematic, without user
+ * interface:
+ *   eeschema_benchmark <schematic.sch> <COPIES> <REPS> [benchmark flags]
+ */
+
+#include <wx/wx.h>
+#include <wx/init.h>
+
+#include <fctsys.h>
+#include <pgm_base.h>
+#include <kiway.h>
+#include <general.h>
+#include <class_library.h>
+#include <class_sch_screen.h>
+#include <sch_collectors.h>
+#include <sch_component.h>
+#include <sch_io_mgr.h>
+#include <sch_sheet.h>
+#include <sch_sheet_path.h>
+#include <wildcards_and_files_ext.h>
+
+#include "eeschema_benchmark.h"
+
+
+/**
+ * Struct PGM_BENCHMARK
+ * the process level object the eeschema objects expect. The benchmarks do not use it.
+ */
+static struct PGM_BENCHMARK : public PGM_BASE
+{
+    void MacOpenFile( const wxString& aFileName ) override
+    {
+    }
+} program;
+
+
+BENCH_CONTEXT::BENCH_CONTEXT( const wxFileName& aFile, int aCopies, int aReps,
+                              std::ostream& aOut ) :
+    m_file( aFile ),
+    m_copies( aCopies ),
+    m_reps( aReps ),
+    m_out( aOut )
+{
+}
+
+
+BENCH_CONTEXT::~BENCH_CONTEXT()
+{
+    if( g_RootSheet == m_root.get() )
+        g_RootSheet = NULL;
+}
+
+
+void BENCH_CONTEXT::load()
+{
+    m_kiway.reset( new KIWAY( &Pgm(), KFCTL_STANDALONE ) );
+    m_file.MakeAbsolute();
+    m_schematic.reset( SCH_IO_MGR::Load( SCH_IO_MGR::SCH_LEGACY, m_file.GetFullPath(),
+                                         m_kiway.get() ) );
+
+    // The root of the hierarchy: copies of the schematic, with distinct time stamps so that
+    // their sheet paths are distinct
+    m_root.reset( new SCH_SHEET() );
+    m_root->SetScreen( new SCH_SCREEN( m_kiway.get() ) );
+
+    for( int ii = 0; ii < m_copies; ii++ )
+    {
+        SCH_SHEET* sheet = new SCH_SHEET( wxPoint( 0, ii * 1000 ) );
+
+        sheet->SetTimeStamp( ii + 1 );
+        sheet->SetName( wxString::Format( "copy%d", ii + 1 ) );
+        sheet->SetFileName( m_schematic->GetFileName() );
+        sheet->SetScreen( m_schematic->GetScreen() );
+        sheet->SetParent( m_root.get() );
+        m_root->GetScreen()->Append( sheet );
+    }
+
+    g_RootSheet = m_root.get();
+
+    // The symbols of the project are all in its cache library
+    wxFileName cacheLib( m_file );
+
+    cacheLib.SetName( m_file.GetName() + "-cache" );
+    cacheLib.SetExt( SchematicLibraryFileExtension );
+
+    m_libs.reset( new PART_LIBS() );
+    m_libs->AddLibrary( cacheLib.GetFullPath() );
+
+    SCH_SCREENS screens;
+
+    for( SCH_SCREEN* screen = screens.GetFirst(); screen; screen = screens.GetNext() )
+    {
+        SCH_TYPE_COLLECTOR components;
+
+        components.Collect( screen->GetDrawItems(), SCH_COLLECTOR::ComponentsOnly );
+        SCH_COMPONENT::ResolveAll( components, m_libs.get() );
+    }
+
+    m_sheets.reset( new SCH_SHEET_LIST( m_root.get() ) );
+}
+
+
+SCH_SHEET_LIST& BENCH_CONTEXT::GetSheets()
+{
+    if( !m_sheets )
+        load();
+
+    return *m_sheets;
+}
+
+
+PART_LIBS* BENCH_CONTEXT::GetLibs()
+{
+    if( !m_sheets )
+        load();
+
+    return m_libs.get();
+}
+
+
+/**
+ * List of available benchmarks
+ */
+static std::vector<BENCHMARK> benchmarkList =
+{
+    { 'n', bench_netlist, "Netlist build" },
+    { 's', bench_screen, "Screen queries and dangling ends" },
+};
+
+
+/**
+ * Construct string of all flags used for specifying benchmarks
+ * on the command line
+ */
+static wxString getBenchFlags()
+{
+    wxString flags;
+
+    for( auto& bmark : benchmarkList )
+    {
+        flags << bmark.triggerChar;
+    }
+
+    return flags;
+}
+
+
+/**
+ * Usage description of a benchmark spec
+ */
+static wxString getBenchDescriptions()
+{
+    wxString desc;
+
+    for( auto& bmark : benchmarkList )
+    {
+        desc << "    " << bmark.triggerChar << ": " << bmark.name << "\n";
+    }
+
+    return desc;
+}
+
+
+enum RET_CODES
+{
+    BAD_ARGS = 1,
+    BAD_RESULTS = 2,
+    LOAD_FAILED = 3,
+};
+
+
+int main( int argc, char* argv[] )
+{
+    wxInitializer initializer( argc, argv );
+    auto& os = std::cout;
+
+    if( argc < 4 )
+    {
+        os << "Usage: " << argv[0] << " <FILE> <COPIES> <REPS> [" << getBenchFlags() << "]\n\n";
+        os << "Benchmarks:\n";
+        os << getBenchDescriptions();
+        return BAD_ARGS;
+    }
+
+    wxFileName inFile( argv[1] );
+
+    long copies = 0;
+    wxString( argv[2] ).ToLong( &copies );
+
+    long reps = 0;
+    wxString( argv[3] ).ToLong( &reps );
+
+    // get the benchmark to do, or all of them if nothing given
+    wxString bench;
+
+    if( argc == 5 )
+        bench = argv[4];
+
+    // The eeschema objects reach the process through the kiface
+    int kifaceVersion = 0;
+    KIFACE_GETTER( &kifaceVersion, KIFACE_VERSION, &program );
+
+    os << "Eeschema Bench Mark Util" << std::endl;
+
+    os << "  Benchmark file: " << inFile.GetFullName() << std::endl;
+    os << "  Copies:         " << (int) copies << std::endl;
+    os << "  Repetitions:    " << (int) reps << std::endl;
+    os << std::endl;
+
+    BENCH_CONTEXT context( inFile, std::max( 1, (int) copies ), std::max( 1, (int) reps ), os );
+
+    try
+    {
+        context.GetSheets();
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        os << "Cannot load the schematic: " << ioe.What() << std::endl;
+        return LOAD_FAILED;
+    }
+
+    bool ok = true;
+
+    for( auto& bmark : benchmarkList )
+    {
+        if( bench.size() && !bench.Contains( bmark.triggerChar ) )
+            continue;
+
+        os << bmark.name << std::endl;
+
+        if( !bmark.func( context ) )
+        {
+            os << "  RESULTS DIFFER" << std::endl;
+            ok = false;
+        }
+
+        os << std::endl;
+    }
+
+    return ok ? 0 : BAD_RESULTS;
+}
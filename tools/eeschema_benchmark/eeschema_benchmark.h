@@ -0,0 +1,116 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef EESCHEMA_BENCHMARK_H
+#define EESCHEMA_BENCHMARK_H
+
+#include <wx/filename.h>
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+
+class KIWAY;
+class PART_LIBS;
+class SCH_SHEET;
+class SCH_SHEET_LIST;
+
+
+using CLOCK = std::chrono::steady_clock;
+using TIME_PT = std::chrono::time_point<CLOCK>;
+
+
+/**
+ * @return the time elapsed since aStart, in microseconds.
+ */
+inline long long elapsedUs( const TIME_PT& aStart )
+{
+    using std::chrono::microseconds;
+    using std::chrono::duration_cast;
+
+    return duration_cast<microseconds>( CLOCK::now() - aStart ).count();
+}
+
+
+/**
+ * Struct BENCH_CONTEXT
+ * what a benchmark works on: a large hierarchy made of m_copies sheets of the schematic
+ * file given on the command line, its components linked to the symbols of the cache
+ * library of the project.
+ */
+struct BENCH_CONTEXT
+{
+    BENCH_CONTEXT( const wxFileName& aFile, int aCopies, int aReps, std::ostream& aOut );
+
+    ~BENCH_CONTEXT();
+
+    /**
+     * Function GetSheets
+     * @return the flattened sheet list of the hierarchy, loaded on first use. Its root sheet
+     * is g_RootSheet.
+     */
+    SCH_SHEET_LIST& GetSheets();
+
+    /**
+     * Function GetLibs
+     * @return the libraries of the symbols of the hierarchy.
+     */
+    PART_LIBS* GetLibs();
+
+    wxFileName              m_file;
+    int                     m_copies;
+    int                     m_reps;
+    std::ostream&           m_out;
+
+private:
+    void load();
+
+    std::unique_ptr<KIWAY>          m_kiway;
+    std::unique_ptr<PART_LIBS>      m_libs;
+    std::unique_ptr<SCH_SHEET>      m_schematic;
+    std::unique_ptr<SCH_SHEET>      m_root;
+    std::unique_ptr<SCH_SHEET_LIST> m_sheets;
+};
+
+
+/**
+ * A benchmark prints its timings to aContext.m_out.
+ * @return false if the results of the optimized code differ from the reference ones.
+ */
+using BENCH_FUNC = std::function<bool( BENCH_CONTEXT& aContext )>;
+
+
+struct BENCHMARK
+{
+    char triggerChar;
+    BENCH_FUNC func;
+    wxString name;
+};
+
+
+// The benchmarks, each in its own file
+bool bench_netlist( BENCH_CONTEXT& aContext );
+bool bench_screen( BENCH_CONTEXT& aContext );
+
+#endif  // EESCHEMA_BENCHMARK_H
@@ -155,6 +155,28 @@ static void bench_line_reader_reuse( const wxFileName& aFile, int aReps, BENCH_R
 }
 
 
+/**
+ * Benchmark using a given LINE_READER implementation, through ReadLineInPlace(),
+ * which does not copy the lines when the reader holds the whole file.
+ * The LINE_READER is recreated for each cycle.
+ */
+template<typename LR>
+static void bench_line_reader_in_place( const wxFileName& aFile, int aReps, BENCH_REPORT& report )
+{
+    for( int i = 0; i < aReps; ++i)
+    {
+        LR fstr( aFile.GetFullName() );
+        unsigned len;
+
+        while( const char* line = fstr.ReadLineInPlace( &len ) )
+        {
+            report.linesRead++;
+            report.charAcc += (unsigned char) line[0];
+        }
+    }
+}
+
+
 /**
  * Benchmark using an INPUTSTREAM_LINE_READER with a given
  * wxInputStream implementation.
@@ -264,6 +286,9 @@ static std::vector<BENCHMARK> benchmarkList =
     { 'F', bench_fstream_reuse, "std::fstream, reused" },
     { 'r', bench_line_reader<FILE_LINE_READER>, "RICHIO" },
     { 'R', bench_line_reader_reuse<FILE_LINE_READER>, "RICHIO, reused" },
+    { 'm', bench_line_reader<MAPPED_FILE_LINE_READER>, "mapped RICHIO" },
+    { 'M', bench_line_reader_reuse<MAPPED_FILE_LINE_READER>, "mapped RICHIO, reused" },
+    { 'i', bench_line_reader_in_place<MAPPED_FILE_LINE_READER>, "mapped RICHIO, in place" },
     { 'n', bench_line_reader<IFSTREAM_LINE_READER>, "std::ifstream L_R" },
     { 'N', bench_line_reader_reuse<IFSTREAM_LINE_READER>, "std::ifstream L_R, reused" },
     { 'w', bench_wxis<wxFileInputStream>, "wxFileIStream" },
@@ -0,0 +1,262 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file bench_board_load.cpp
+ * Times the load of the board file through the FILE_LINE_READER it used to be read with,
+ * and through the MAPPED_FILE_LINE_READER of PCB_IO::Load(), with its modules, tracks,
+ * vias and zones parsed serially and in parallel, checking that all the boards format to
+ * the same text. Times as well ParseDecimal() against the strtod() it replaced in the
+ * parser on all the numbers of the file, checking that they give the same values.
+ * The same is timed on a large board made of copies of the board laid side by side.
+ */
+
+#include <fctsys.h>
+#include <class_board.h>
+#include <class_module.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <kicad_plugin.h>
+#include <pcb_parser.h>
+#include <richio.h>
+#include <dsnlexer.h>
+#include <kicad_string.h>
+#include <common.h>
+
+#include <stdlib.h>
+#include <memory>
+#include <vector>
+
+#include "pcbnew_benchmark.h"
+
+
+/**
+ * Loads the board read by aReader, and formats it into aText.
+ */
+static void loadBoard( LINE_READER& aReader, bool aParallel, std::string& aText )
+{
+    PCB_PARSER parser( &aReader );
+
+    parser.SetParallel( aParallel );
+
+    std::unique_ptr<BOARD> board( dynamic_cast<BOARD*>( parser.Parse() ) );
+    PCB_IO io;
+
+    io.Format( board.get() );
+    aText = io.GetStringOutput( true );
+}
+
+
+/**
+ * The numbers of the file given to aLexer.
+ */
+static void readNumbers( DSNLEXER& aLexer, std::vector<std::string>& aNumbers )
+{
+    int tok;
+
+    while( ( tok = aLexer.NextTok() ) != DSN_EOF )
+    {
+        if( tok == DSN_NUMBER )
+            aNumbers.push_back( aLexer.CurText() );
+    }
+}
+
+
+/**
+ * Saves to aFileName a board made of aColumns x aRows copies of the board of the file
+ * aBoardFile, laid side by side.
+ */
+static void makeLargeBoard( const wxString& aBoardFile, const wxString& aFileName,
+                            int aColumns, int aRows )
+{
+    PCB_IO io;
+    std::unique_ptr<BOARD> board( io.Load( aBoardFile, NULL ) );
+    std::vector<BOARD_ITEM*> items;
+
+    for( MODULE* module = board->m_Modules; module; module = module->Next() )
+        items.push_back( module );
+
+    for( TRACK* track = board->m_Track; track; track = track->Next() )
+        items.push_back( track );
+
+    for( BOARD_ITEM* item = board->m_Drawings; item; item = item->Next() )
+        items.push_back( item );
+
+    for( int i = 0; i < board->GetAreaCount(); ++i )
+        items.push_back( board->GetArea( i ) );
+
+    EDA_RECT bbox = board->ComputeBoundingBox();
+
+    for( int col = 0; col < aColumns; ++col )
+    {
+        for( int row = 0; row < aRows; ++row )
+        {
+            if( col == 0 && row == 0 )
+                continue;
+
+            wxPoint offset( col * bbox.GetWidth(), row * bbox.GetHeight() );
+
+            for( BOARD_ITEM* item : items )
+            {
+                BOARD_ITEM* copy = static_cast<BOARD_ITEM*>( item->Clone() );
+
+                copy->Move( offset );
+                board->Add( copy, ADD_APPEND );
+            }
+        }
+    }
+
+    io.Save( aFileName, board.get() );
+}
+
+
+/**
+ * Times the loads of the board file aFileName.
+ */
+static bool benchFile( BENCH_CONTEXT& aContext, const wxString& aFileName )
+{
+    std::ostream& os = aContext.m_out;
+    long long fileUs = 0;
+    long long mappedUs = 0;
+    long long parallelUs = 0;
+    long long strtodUs = 0;
+    long long decimalUs = 0;
+    int mismatches = 0;
+    std::vector<std::string> numbers;
+
+    {
+        MAPPED_FILE_LINE_READER reader( aFileName );
+        DSNLEXER lexer( NULL, 0, &reader );
+
+        readNumbers( lexer, numbers );
+    }
+
+    for( int rep = 0; rep < aContext.m_reps; ++rep )
+    {
+        std::string reference;
+        std::string text;
+
+        TIME_PT start = CLOCK::now();
+
+        {
+            FILE_LINE_READER reader( aFileName );
+            loadBoard( reader, false, reference );
+        }
+
+        fileUs += elapsedUs( start );
+        start = CLOCK::now();
+
+        {
+            MAPPED_FILE_LINE_READER reader( aFileName );
+            loadBoard( reader, false, text );
+        }
+
+        mappedUs += elapsedUs( start );
+
+        if( text != reference )
+            mismatches++;
+
+        start = CLOCK::now();
+
+        {
+            MAPPED_FILE_LINE_READER reader( aFileName );
+            loadBoard( reader, true, text );
+        }
+
+        parallelUs += elapsedUs( start );
+
+        if( text != reference )
+            mismatches++;
+
+        std::vector<double> referenceValues;
+        std::vector<double> values;
+
+        referenceValues.reserve( numbers.size() );
+        values.reserve( numbers.size() );
+
+        start = CLOCK::now();
+
+        {
+            // The parser used to read its numbers in the "C" locale
+            LOCALE_IO toggle;
+
+            for( const std::string& number : numbers )
+                referenceValues.push_back( strtod( number.c_str(), NULL ) );
+        }
+
+        strtodUs += elapsedUs( start );
+        start = CLOCK::now();
+
+        for( const std::string& number : numbers )
+            values.push_back( ParseDecimal( number.c_str() ) );
+
+        decimalUs += elapsedUs( start );
+
+        if( values != referenceValues )
+            mismatches++;
+    }
+
+    int reps = aContext.m_reps;
+
+    os << wxString::Format( "  %u numbers", (unsigned) numbers.size() ) << std::endl;
+    os << wxString::Format( "  load (FILE_LINE_READER):        %10lld us", fileUs / reps )
+       << std::endl;
+    os << wxString::Format( "  load (MAPPED_FILE_LINE_READER): %10lld us, x%.2f",
+                            mappedUs / reps, mappedUs ? (double) fileUs / mappedUs : 0.0 )
+       << std::endl;
+    os << wxString::Format( "  load (mapped, parallel):        %10lld us, x%.2f",
+                            parallelUs / reps,
+                            parallelUs ? (double) fileUs / parallelUs : 0.0 )
+       << std::endl;
+    os << wxString::Format( "  numbers (strtod):               %10lld us", strtodUs / reps )
+       << std::endl;
+    os << wxString::Format( "  numbers (ParseDecimal):         %10lld us, x%.2f",
+                            decimalUs / reps, decimalUs ? (double) strtodUs / decimalUs : 0.0 )
+       << std::endl;
+    os << wxString::Format( "  %d mismatches", mismatches ) << std::endl;
+
+    return mismatches == 0;
+}
+
+
+bool bench_board_load( BENCH_CONTEXT& aContext )
+{
+    std::ostream& os = aContext.m_out;
+    const int columns = 4;
+    const int rows = 4;
+    bool ok = benchFile( aContext, aContext.m_file.GetFullPath() );
+
+    wxString largeName = wxFileName::CreateTempFileName( wxT( "bench_board_load" ) );
+
+    makeLargeBoard( aContext.m_file.GetFullPath(), largeName, columns, rows );
+
+    os << wxString::Format( "  %d x %d copies of the board, %lld bytes:", columns, rows,
+                            (long long) wxFileName::GetSize( largeName ).GetValue() )
+       << std::endl;
+
+    ok = benchFile( aContext, largeName ) && ok;
+
+    wxRemoveFile( largeName );
+
+    return ok;
+}
@@ -0,0 +1,401 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file bench_board_save.cpp
+ * Times the save of the board, to a string and to a file, and the formatting of its
+ * tracks and zone outlines through the FORMAT_BUFFER of PCB_IO against the printf() style
+ * formatting they used before. The texts of both ways are checked to be the same, as are
+ * the coordinates and angles formatted by BOARD_ITEM against their former sprintf()
+ * formatting.
+ */
+
+#include <fctsys.h>
+#include <class_board.h>
+#include <class_module.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <kicad_plugin.h>
+#include <richio.h>
+#include <common.h>
+
+#include <wx/filename.h>
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include "pcbnew_benchmark.h"
+
+
+/**
+ * The former BOARD_ITEM::FormatInternalUnits()
+ */
+static std::string referenceIU( int aValue )
+{
+    char    buf[50];
+    int     len;
+    double  mm = aValue / IU_PER_MM;
+
+    if( mm != 0.0 && fabs( mm ) <= 0.0001 )
+    {
+        len = sprintf( buf, "%.10f", mm );
+
+        while( --len > 0 && buf[len] == '0' )
+            buf[len] = '\0';
+
+        if( buf[len] == '.' )
+            buf[len] = '\0';
+        else
+            ++len;
+    }
+    else
+    {
+        len = sprintf( buf, "%.10g", mm );
+    }
+
+    return std::string( buf, len );
+}
+
+
+static std::string referenceIU( const wxPoint& aPoint )
+{
+    return referenceIU( aPoint.x ) + " " + referenceIU( aPoint.y );
+}
+
+
+/**
+ * The former BOARD_ITEM::FormatAngle()
+ */
+static std::string referenceAngle( double aAngle )
+{
+    char temp[50];
+
+    int len = snprintf( temp, sizeof(temp), "%.10g", aAngle / 10.0 );
+
+    return std::string( temp, len );
+}
+
+
+/**
+ * A PCB_IO which formats the items of a board to its string as its Save() does to a file.
+ */
+class BENCH_PCB_IO : public PCB_IO
+{
+public:
+    void SetBoard( BOARD* aBoard )
+    {
+        m_board = aBoard;
+        m_mapping->SetBoard( aBoard );
+    }
+};
+
+
+/**
+ * The former formatting of a track by PCB_IO.
+ */
+static void referenceTrack( OUTPUTFORMATTER& aOut, BOARD* aBoard,
+                            const NETINFO_MAPPING& aMapping, TRACK* aTrack )
+{
+    if( aTrack->Type() == PCB_VIA_T )
+    {
+        PCB_LAYER_ID  layer1, layer2;
+        const VIA*    via = static_cast<const VIA*>( aTrack );
+
+        aOut.Print( 1, "(via" );
+
+        via->LayerPair( &layer1, &layer2 );
+
+        if( via->GetViaType() == VIA_BLIND_BURIED )
+            aOut.Print( 0, " blind" );
+        else if( via->GetViaType() == VIA_MICROVIA )
+            aOut.Print( 0, " micro" );
+
+        aOut.Print( 0, " (at %s) (size %s)", referenceIU( aTrack->GetStart() ).c_str(),
+                    referenceIU( aTrack->GetWidth() ).c_str() );
+
+        if( via->GetDrill() != UNDEFINED_DRILL_DIAMETER )
+            aOut.Print( 0, " (drill %s)", referenceIU( via->GetDrill() ).c_str() );
+
+        aOut.Print( 0, " (layers %s %s)",
+                    aOut.Quotew( aBoard->GetLayerName( layer1 ) ).c_str(),
+                    aOut.Quotew( aBoard->GetLayerName( layer2 ) ).c_str() );
+    }
+    else
+    {
+        aOut.Print( 1, "(segment (start %s) (end %s) (width %s)",
+                    referenceIU( aTrack->GetStart() ).c_str(),
+                    referenceIU( aTrack->GetEnd() ).c_str(),
+                    referenceIU( aTrack->GetWidth() ).c_str() );
+
+        aOut.Print( 0, " (layer %s)", aOut.Quotew( aTrack->GetLayerName() ).c_str() );
+    }
+
+    aOut.Print( 0, " (net %d)", aMapping.Translate( aTrack->GetNetCode() ) );
+
+    if( aTrack->GetTimeStamp() != 0 )
+        aOut.Print( 0, " (tstamp %lX)", (unsigned long)aTrack->GetTimeStamp() );
+
+    if( aTrack->GetStatus() != 0 )
+        aOut.Print( 0, " (status %X)", aTrack->GetStatus() );
+
+    aOut.Print( 0, ")\n" );
+}
+
+
+/**
+ * The former formatting of the outline or filled polygons of a zone by PCB_IO.
+ */
+template<class ITERATOR>
+static void referencePolygons( OUTPUTFORMATTER& aOut, const char* aKeyword, ITERATOR aIt )
+{
+    int  newLine = 0;
+    bool new_polygon = true;
+    bool is_closed = false;
+
+    for( ; aIt; ++aIt )
+    {
+        if( new_polygon )
+        {
+            newLine = 0;
+            aOut.Print( 2, "(%s\n", aKeyword );
+            aOut.Print( 3, "(pts\n" );
+            new_polygon = false;
+            is_closed = false;
+        }
+
+        if( newLine == 0 )
+            aOut.Print( 4, "(xy %s %s)",
+                        referenceIU( aIt->x ).c_str(), referenceIU( aIt->y ).c_str() );
+        else
+            aOut.Print( 0, " (xy %s %s)",
+                        referenceIU( aIt->x ).c_str(), referenceIU( aIt->y ).c_str() );
+
+        if( newLine < 4 )
+        {
+            newLine += 1;
+        }
+        else
+        {
+            newLine = 0;
+            aOut.Print( 0, "\n" );
+        }
+
+        if( aIt.IsEndContour() )
+        {
+            is_closed = true;
+
+            if( newLine != 0 )
+                aOut.Print( 0, "\n" );
+
+            aOut.Print( 3, ")\n" );
+            aOut.Print( 2, ")\n" );
+            new_polygon = true;
+        }
+    }
+
+    if( !is_closed )
+        aOut.Print( 2, ")\n" );
+}
+
+
+static void referenceZone( OUTPUTFORMATTER& aOut, ZONE_CONTAINER* aZone )
+{
+    if( aZone->GetNumCorners() )
+        referencePolygons( aOut, "polygon", aZone->IterateWithHoles() );
+
+    if( !aZone->GetFilledPolysList().IsEmpty() )
+        referencePolygons( aOut, "filled_polygon", aZone->GetFilledPolysList().CIterate() );
+}
+
+
+/**
+ * Counts the coordinates and angles formatted differently from their former formatting.
+ */
+static int countNumberMismatches( BOARD* aBoard )
+{
+    std::vector<int> values;
+    std::vector<double> angles;
+    std::mt19937 rng( 1 );
+    int mismatches = 0;
+
+    for( int value = -1000000; value <= 1000000; ++value )
+        values.push_back( value );
+
+    for( int i = 0; i < 1000000; ++i )
+        values.push_back( (int) rng() );
+
+    values.push_back( std::numeric_limits<int>::max() );
+    values.push_back( std::numeric_limits<int>::min() );
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+    {
+        values.push_back( track->GetStart().x );
+        values.push_back( track->GetStart().y );
+        values.push_back( track->GetEnd().x );
+        values.push_back( track->GetEnd().y );
+        values.push_back( track->GetWidth() );
+    }
+
+    for( int angle = -36000; angle <= 36000; ++angle )
+        angles.push_back( angle );
+
+    angles.push_back( 0.5 );
+    angles.push_back( -0.0 );
+    angles.push_back( 1e12 );
+
+    for( MODULE* module = aBoard->m_Modules; module; module = module->Next() )
+        angles.push_back( module->GetOrientation() );
+
+    for( int value : values )
+    {
+        if( BOARD_ITEM::FormatInternalUnits( value ) != referenceIU( value ) )
+            mismatches++;
+    }
+
+    for( double angle : angles )
+    {
+        if( BOARD_ITEM::FormatAngle( angle ) != referenceAngle( angle ) )
+            mismatches++;
+    }
+
+    return mismatches;
+}
+
+
+bool bench_board_save( BENCH_CONTEXT& aContext )
+{
+    std::ostream& os = aContext.m_out;
+    BOARD* board = aContext.GetBoard();
+    BENCH_PCB_IO io;
+    PCB_IO fileIo;
+    NETINFO_MAPPING mapping;
+    long long referenceUs = 0;
+    long long bufferedUs = 0;
+    long long stringUs = 0;
+    long long fileUs = 0;
+    size_t itemBytes = 0;
+    size_t boardBytes = 0;
+    int mismatches = 0;
+
+    io.SetBoard( board );
+    mapping.SetBoard( board );
+    mismatches += countNumberMismatches( board );
+
+    wxString fileName = wxFileName::CreateTempFileName( wxT( "bench_board_save" ) );
+
+    for( int rep = 0; rep < aContext.m_reps; ++rep )
+    {
+        STRING_FORMATTER reference;
+
+        {
+            LOCALE_IO toggle;
+            TIME_PT start = CLOCK::now();
+
+            for( TRACK* track = board->m_Track; track; track = track->Next() )
+                referenceTrack( reference, board, mapping, track );
+
+            for( int i = 0; i < board->GetAreaCount(); ++i )
+                referenceZone( reference, board->GetArea( i ) );
+
+            referenceUs += elapsedUs( start );
+        }
+
+        std::string text;
+        TIME_PT start = CLOCK::now();
+
+        for( TRACK* track = board->m_Track; track; track = track->Next() )
+        {
+            io.Format( track, 1 );
+            text += io.GetStringOutput( true );
+        }
+
+        for( int i = 0; i < board->GetAreaCount(); ++i )
+        {
+            io.Format( board->GetArea( i ), 1 );
+            text += io.GetStringOutput( true );
+        }
+
+        bufferedUs += elapsedUs( start );
+
+        // The zones have their other settings around their polygons
+        std::string::size_type pos = 0;
+
+        for( TRACK* track = board->m_Track; track; track = track->Next() )
+        {
+            STRING_FORMATTER one;
+
+            referenceTrack( one, board, mapping, track );
+
+            if( text.compare( pos, one.GetString().size(), one.GetString() ) != 0 )
+                mismatches++;
+
+            pos += one.GetString().size();
+        }
+
+        for( int i = 0; i < board->GetAreaCount(); ++i )
+        {
+            STRING_FORMATTER one;
+
+            referenceZone( one, board->GetArea( i ) );
+
+            if( ( pos = text.find( one.GetString(), pos ) ) == std::string::npos )
+            {
+                mismatches++;
+                break;
+            }
+
+            pos += one.GetString().size();
+        }
+
+        itemBytes = reference.GetString().size();
+
+        start = CLOCK::now();
+        io.Format( board );
+        boardBytes = io.GetStringOutput( true ).size();
+        stringUs += elapsedUs( start );
+
+        start = CLOCK::now();
+        fileIo.Save( fileName, board );
+        fileUs += elapsedUs( start );
+    }
+
+    wxRemoveFile( fileName );
+
+    int reps = aContext.m_reps;
+    auto mbPerS = [&]( long long aUs ) { return aUs ? (double) boardBytes * reps / aUs : 0.0; };
+
+    os << wxString::Format( "  %u bytes of tracks and zone polygons, %u bytes of board",
+                            (unsigned) itemBytes, (unsigned) boardBytes ) << std::endl;
+    os << wxString::Format( "  tracks and zones (printf):   %10lld us", referenceUs / reps )
+       << std::endl;
+    os << wxString::Format( "  tracks and zones (buffered): %10lld us, x%.2f", bufferedUs / reps,
+                            bufferedUs ? (double) referenceUs / bufferedUs : 0.0 ) << std::endl;
+    os << wxString::Format( "  board to string:             %10lld us, %.1f MB/s",
+                            stringUs / reps, mbPerS( stringUs ) ) << std::endl;
+    os << wxString::Format( "  board to file:               %10lld us, %.1f MB/s",
+                            fileUs / reps, mbPerS( fileUs ) ) << std::endl;
+    os << wxString::Format( "  %d mismatches", mismatches ) << std::endl;
+
+    return mismatches == 0;
+}
@@ -0,0 +1,160 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file bench_board_snapshot.cpp
+ * Times the load of the board from its board file and from the binary snapshot of
+ * SNAPSHOT_PLUGIN, and the write of the snapshot. The boards loaded from the snapshots are
+ * checked to save to the same board files as the boards the snapshots were made of: the
+ * board of the benchmark, of which the snapshot is written by SNAPSHOT_PLUGIN::Save(), and
+ * the board loaded from its file, of which the snapshot is made by SNAPSHOT_PLUGIN::Load().
+ * A snapshot is also checked to be ignored once its board file has changed.
+ */
+
+#include <fctsys.h>
+#include <class_board.h>
+#include <kicad_plugin.h>
+#include <snapshot_plugin.h>
+#include <richio.h>
+
+#include <wx/filename.h>
+
+#include <memory>
+
+#include "pcbnew_benchmark.h"
+
+
+/**
+ * The content of the file aFileName.
+ */
+static std::string fileContent( const wxString& aFileName )
+{
+    MAPPED_FILE_LINE_READER reader( aFileName );
+
+    return std::string( reader.Text(), reader.Size() );
+}
+
+
+bool bench_board_snapshot( BENCH_CONTEXT& aContext )
+{
+    std::ostream& os = aContext.m_out;
+    BOARD* board = aContext.GetBoard();
+    PCB_IO fileIo;
+    SNAPSHOT_PLUGIN plugin;
+    long long textUs = 0;
+    long long writeUs = 0;
+    long long snapshotUs = 0;
+    size_t boardBytes = 0;
+    size_t snapshotBytes = 0;
+    int mismatches = 0;
+
+    wxString fileName = wxFileName::CreateTempFileName( wxT( "bench_board_snapshot" ) );
+    wxString checkName = wxFileName::CreateTempFileName( wxT( "bench_board_snapshot" ) );
+    wxString snapshotName = SNAPSHOT_PLUGIN::SnapshotFileName( fileName );
+
+    // The snapshot written along the board file
+    plugin.Save( fileName, board );
+
+    std::string saved = fileContent( fileName );
+    std::unique_ptr<BOARD> loaded( plugin.LoadSnapshot( fileName ) );
+
+    if( loaded )
+    {
+        fileIo.Save( checkName, loaded.get() );
+
+        if( fileContent( checkName ) != saved )
+            mismatches++;
+    }
+    else
+    {
+        mismatches++;
+    }
+
+    // The snapshot made by the load of the board file
+    loaded.reset( fileIo.Load( fileName, NULL ) );
+    fileIo.Save( fileName, loaded.get() );
+    saved = fileContent( fileName );
+    wxRemoveFile( snapshotName );
+    loaded.reset( plugin.Load( fileName, NULL ) );
+
+    if( !wxFileExists( snapshotName ) )
+        mismatches++;
+
+    for( int rep = 0; rep < aContext.m_reps; ++rep )
+    {
+        TIME_PT start = CLOCK::now();
+        loaded.reset( fileIo.Load( fileName, NULL ) );
+        textUs += elapsedUs( start );
+
+        start = CLOCK::now();
+        plugin.SaveSnapshot( fileName, loaded.get() );
+        writeUs += elapsedUs( start );
+
+        start = CLOCK::now();
+        loaded.reset( plugin.LoadSnapshot( fileName ) );
+        snapshotUs += elapsedUs( start );
+
+        if( loaded )
+        {
+            fileIo.Save( checkName, loaded.get() );
+
+            if( fileContent( checkName ) != saved )
+                mismatches++;
+        }
+        else
+        {
+            mismatches++;
+        }
+    }
+
+    boardBytes = saved.size();
+    snapshotBytes = fileContent( snapshotName ).size();
+
+    // Once the board file has changed, its snapshot is out of date
+    {
+        FILE_OUTPUTFORMATTER out( fileName, wxT( "at" ) );
+        out.Print( 0, "\n" );
+    }
+
+    loaded.reset( plugin.LoadSnapshot( fileName ) );
+
+    if( loaded )
+        mismatches++;
+
+    loaded.reset();
+    wxRemoveFile( fileName );
+    wxRemoveFile( checkName );
+    wxRemoveFile( snapshotName );
+
+    int reps = aContext.m_reps;
+
+    os << wxString::Format( "  %u bytes of board file, %u bytes of snapshot",
+                            (unsigned) boardBytes, (unsigned) snapshotBytes ) << std::endl;
+    os << wxString::Format( "  load (board file): %10lld us", textUs / reps ) << std::endl;
+    os << wxString::Format( "  load (snapshot):   %10lld us, x%.2f", snapshotUs / reps,
+                            snapshotUs ? (double) textUs / snapshotUs : 0.0 ) << std::endl;
+    os << wxString::Format( "  snapshot write:    %10lld us", writeUs / reps ) << std::endl;
+    os << wxString::Format( "  %d mismatches", mismatches ) << std::endl;
+
+    return mismatches == 0;
+}
@@ -0,0 +1,156 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file bench_connectivity.cpp
+ * Builds the connectivity of a board from scratch, with its ratsnest, then propagates the
+ * nets, timing both. The ratsnest clusters are checked against the connected components
+ * found by a plain breadth-first search of the connections.
+ */
+
+#include <fctsys.h>
+#include <class_board.h>
+#include <connectivity.h>
+#include <connectivity_algo.h>
+
+#include <deque>
+#include <unordered_map>
+
+#include "pcbnew_benchmark.h"
+
+
+/**
+ * Checks that each cluster is a connected component of the items of a net: all its items
+ * were reached from the first one, and nothing else was.
+ */
+static int countClusterMismatches( CN_CONNECTIVITY_ALGO& aAlgo )
+{
+    std::unordered_map<CN_ITEM*, int> component;
+    std::deque<CN_ITEM*> queue;
+    int mismatches = 0;
+    int id = 0;
+
+    for( const auto& cluster : aAlgo.GetClusters() )
+    {
+        if( cluster->Size() == 0 )
+            continue;
+
+        CN_ITEM* root = *cluster->begin();
+        int reached = 0;
+
+        component[root] = id;
+        queue.push_back( root );
+
+        while( !queue.empty() )
+        {
+            CN_ITEM* item = queue.front();
+
+            queue.pop_front();
+            reached++;
+
+            for( auto connected : item->ConnectedItems() )
+            {
+                if( !connected->Valid() || connected->Net() != root->Net() )
+                    continue;
+
+                if( component.insert( std::make_pair( connected, id ) ).second )
+                    queue.push_back( connected );
+            }
+        }
+
+        if( reached != cluster->Size() )
+            mismatches++;
+        else
+        {
+            for( auto item : *cluster )
+            {
+                if( component[item] != id )
+                {
+                    mismatches++;
+                    break;
+                }
+            }
+        }
+
+        id++;
+    }
+
+    return mismatches;
+}
+
+
+bool bench_connectivity( BENCH_CONTEXT& aContext )
+{
+    std::ostream& os = aContext.m_out;
+    BOARD* board = aContext.GetBoard();
+
+    long long bestBuildUs = -1;
+    long long bestPropagateUs = -1;
+    int mismatches = 0;
+    int items = 0;
+    int anchors = 0;
+    int clusters = 0;
+
+    for( int rep = 0; rep < aContext.m_reps; ++rep )
+    {
+        CONNECTIVITY_DATA connectivity;
+
+        TIME_PT start = CLOCK::now();
+        connectivity.Build( board );
+        long long buildUs = elapsedUs( start );
+
+        start = CLOCK::now();
+        connectivity.PropagateNets();
+        long long propagateUs = elapsedUs( start );
+
+        if( bestBuildUs < 0 || buildUs < bestBuildUs )
+            bestBuildUs = buildUs;
+
+        if( bestPropagateUs < 0 || propagateUs < bestPropagateUs )
+            bestPropagateUs = propagateUs;
+
+        if( rep == 0 )
+        {
+            auto algo = connectivity.GetConnectivityAlgo();
+
+            items = 0;
+            anchors = 0;
+
+            algo->ForEachItem( [&items] ( CN_ITEM* aItem ) { items++; } );
+            algo->ForEachAnchor( [&anchors] ( CN_ANCHOR_PTR aAnchor ) { anchors++; } );
+
+            clusters = algo->GetClusters().size();
+            mismatches = countClusterMismatches( *algo );
+        }
+    }
+
+    os << wxString::Format( "  %d items, %d anchors (%d bytes each), %d ratsnest clusters",
+                            items, anchors, (int) sizeof( CN_ANCHOR ), clusters ) << std::endl;
+    os << wxString::Format( "  build with ratsnest: %lld us, propagate nets: %lld us, "
+                            "%d cluster mismatches", bestBuildUs, bestPropagateUs, mismatches ) << std::endl;
+
+    // The nets may have been propagated differently than when the board was loaded
+    aContext.ReloadBoard();
+
+    return mismatches == 0;
+}
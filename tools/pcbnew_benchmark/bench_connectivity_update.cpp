@@ -0,0 +1,148 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file bench_connectivity_update.cpp
+ * Applies random moves to the modules and tracks of a board, updating its connectivity
+ * and ratsnest after each of them, as a commit does. The clusters and the unconnected
+ * count are then compared with the ones of a connectivity built from scratch. The
+ * ratsnest lines themselves are not compared: the equal length ones may be chosen in
+ * another order.
+ */
+
+#include <fctsys.h>
+#include <class_board.h>
+#include <class_module.h>
+#include <class_track.h>
+#include <connectivity.h>
+#include <connectivity_algo.h>
+
+#include <algorithm>
+#include <random>
+
+#include "pcbnew_benchmark.h"
+
+
+/// The (net, item count) pairs of the ratsnest clusters, sorted
+static std::vector<std::pair<int, int>> clusterSignature( CONNECTIVITY_DATA& aConnectivity )
+{
+    std::vector<std::pair<int, int>> signature;
+
+    for( const auto& cluster : aConnectivity.GetConnectivityAlgo()->GetClusters() )
+        signature.emplace_back( cluster->OriginNet(), cluster->Size() );
+
+    std::sort( signature.begin(), signature.end() );
+
+    return signature;
+}
+
+
+bool bench_connectivity_update( BENCH_CONTEXT& aContext )
+{
+    std::ostream& os = aContext.m_out;
+    BOARD* board = aContext.GetBoard();
+    auto connectivity = board->GetConnectivity();
+
+    std::vector<TRACK*> tracks;
+    std::vector<MODULE*> modules;
+
+    for( TRACK* track = board->m_Track; track; track = track->Next() )
+        tracks.push_back( track );
+
+    for( MODULE* module = board->m_Modules; module; module = module->Next() )
+        modules.push_back( module );
+
+    // The edits are the same from run to run
+    std::mt19937 rng( 1 );
+    std::uniform_int_distribution<int> offset( -500000, 500000 );   // +/- 0.5 mm
+
+    int edits = aContext.m_reps * 20;
+    long long totalUs = 0;
+    long long maxUs = 0;
+    long long searchUs = 0;
+    long long clusterUs = 0;
+    long long ratsnestUs = 0;
+    long long clustersRebuilt = 0;
+    long long netsRecomputed = 0;
+
+    for( int ii = 0; ii < edits && ( tracks.size() || modules.size() ); ++ii )
+    {
+        bool moveModule = modules.size() && ( tracks.empty() || rng() % 4 == 0 );
+        wxPoint delta( offset( rng ), offset( rng ) );
+        BOARD_ITEM* item;
+
+        if( moveModule )
+            item = modules[ rng() % modules.size() ];
+        else
+            item = tracks[ rng() % tracks.size() ];
+
+        TIME_PT start = CLOCK::now();
+
+        item->Move( delta );
+        connectivity->Update( item );
+        connectivity->RecalculateRatsnest();
+
+        long long us = elapsedUs( start );
+        const CONNECTIVITY_STATS& stats = connectivity->GetStats();
+
+        totalUs += us;
+        maxUs = std::max( maxUs, us );
+        searchUs += stats.m_searchTime;
+        clusterUs += stats.m_clusterTime;
+        ratsnestUs += stats.m_ratsnestTime;
+        clustersRebuilt += stats.m_clustersRebuilt;
+        netsRecomputed += stats.m_netsRecomputed;
+    }
+
+    if( edits )
+    {
+        os << wxString::Format( "  incremental update: %d edits, mean %lld us, max %lld us "
+                                "(search %lld, clusters %lld, ratsnest %lld)",
+                                edits, totalUs / edits, maxUs, searchUs / edits,
+                                clusterUs / edits, ratsnestUs / edits ) << std::endl;
+        os << wxString::Format( "  per edit: %lld clusters rebuilt, %lld nets recomputed",
+                                clustersRebuilt / edits, netsRecomputed / edits ) << std::endl;
+    }
+
+    // The reference: the connectivity of the edited board, built from scratch
+    CONNECTIVITY_DATA reference;
+
+    TIME_PT start = CLOCK::now();
+    reference.Build( board );
+    long long buildUs = elapsedUs( start );
+
+    int mismatches = 0;
+
+    if( clusterSignature( *connectivity ) != clusterSignature( reference ) )
+        mismatches++;
+
+    if( connectivity->GetUnconnectedCount() != reference.GetUnconnectedCount() )
+        mismatches++;
+
+    os << wxString::Format( "  full build, edited: %lld us, %u unconnected, %d mismatches",
+                            buildUs, reference.GetUnconnectedCount(), mismatches ) << std::endl;
+
+    aContext.ReloadBoard();
+
+    return mismatches == 0;
+}
@@ -0,0 +1,197 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file bench_footprint_list.cpp
+ * Times the listing of a footprint library made of the modules of the board, by
+ * FOOTPRINT_LIST_IMPL without its library index, which parses all the footprint files, and
+ * with it, which only checks their sizes and times. Both lists are checked against the
+ * footprints loaded by PCB_IO, and a footprint changed after the index was written is
+ * checked to be read again.
+ */
+
+#include <fctsys.h>
+#include <class_board.h>
+#include <class_module.h>
+#include <footprint_info_impl.h>
+#include <fp_lib_table.h>
+#include <kicad_plugin.h>
+#include <lib_id.h>
+#include <wildcards_and_files_ext.h>
+
+#include <wx/dir.h>
+#include <wx/filename.h>
+
+#include <cstdlib>
+#include <memory>
+
+#include "pcbnew_benchmark.h"
+
+
+/**
+ * Sets the modification time of the library aLibPath and of its files to aTime, so that the
+ * index does not take them for files being written.
+ */
+static void setLibraryTime( const wxString& aLibPath, const wxDateTime& aTime )
+{
+    wxDir    dir( aLibPath );
+    wxString fileName;
+
+    if( dir.GetFirst( &fileName, wxEmptyString, wxDIR_FILES ) )
+    {
+        do
+        {
+            wxFileName( aLibPath, fileName ).SetTimes( &aTime, &aTime, NULL );
+        } while( dir.GetNext( &fileName ) );
+    }
+
+    wxFileName::DirName( aLibPath ).SetTimes( &aTime, &aTime, NULL );
+}
+
+
+/**
+ * The count of the footprints of aList which differ from the ones PCB_IO loads from aLibPath.
+ */
+static int countMismatches( FOOTPRINT_LIST& aList, const wxString& aLibPath )
+{
+    PCB_IO          io;
+    wxArrayString   names;
+    int             mismatches = 0;
+
+    io.FootprintEnumerate( names, aLibPath );
+
+    if( names.size() != aList.GetCount() )
+        return std::abs( (int) names.size() - (int) aList.GetCount() );
+
+    for( unsigned i = 0; i < aList.GetCount(); ++i )
+    {
+        FOOTPRINT_INFO& info = aList.GetItem( i );
+        std::unique_ptr<MODULE> footprint( io.FootprintLoad( aLibPath, info.GetFootprintName() ) );
+
+        if( !footprint
+                || info.GetDoc() != footprint->GetDescription()
+                || info.GetKeywords() != footprint->GetKeywords()
+                || info.GetPadCount() != footprint->GetPadCount( DO_NOT_INCLUDE_NPTH )
+                || info.GetUniquePadCount()
+                        != footprint->GetUniquePadCount( DO_NOT_INCLUDE_NPTH ) )
+            mismatches++;
+    }
+
+    return mismatches;
+}
+
+
+bool bench_footprint_list( BENCH_CONTEXT& aContext )
+{
+    std::ostream& os = aContext.m_out;
+    BOARD* board = aContext.GetBoard();
+    long long parseUs = 0;
+    long long indexedUs = 0;
+    unsigned footprintCount = 0;
+    int mismatches = 0;
+
+    wxString libPath = wxFileName::CreateTempFileName( wxT( "bench_footprint_list" ) );
+
+    wxRemoveFile( libPath );
+    libPath += wxT( "." ) + KiCadFootprintLibPathExtension;
+
+    {
+        PCB_IO io;
+        unsigned n = 0;
+
+        io.FootprintLibCreate( libPath );
+
+        for( MODULE* module = board->m_Modules; module; module = module->Next() )
+        {
+            MODULE footprint( *module );
+
+            footprint.SetFPID( LIB_ID( wxString::Format( wxT( "FP%u" ), n++ ) ) );
+            io.FootprintSave( libPath, &footprint );
+        }
+    }
+
+    setLibraryTime( libPath, wxDateTime::Now() - wxTimeSpan::Hours( 1 ) );
+
+    FP_LIB_TABLE table;
+    table.InsertRow( new FP_LIB_TABLE_ROW( wxT( "bench" ), libPath, wxT( "KiCad" ),
+                                           wxEmptyString ) );
+
+    wxString indexFile = FOOTPRINT_LIST_IMPL::IndexFileName( libPath );
+
+    for( int rep = 0; rep < aContext.m_reps; ++rep )
+    {
+        FOOTPRINT_LIST_IMPL parsed;
+        FOOTPRINT_LIST_IMPL indexed;
+
+        // Without index, all the files are parsed, and the index is written
+        wxRemoveFile( indexFile );
+
+        TIME_PT start = CLOCK::now();
+        parsed.ReadFootprintFiles( &table );
+        parseUs += elapsedUs( start );
+
+        start = CLOCK::now();
+        indexed.ReadFootprintFiles( &table );
+        indexedUs += elapsedUs( start );
+
+        footprintCount = indexed.GetCount();
+        mismatches += parsed.GetErrorCount() + indexed.GetErrorCount();
+        mismatches += countMismatches( parsed, libPath );
+        mismatches += countMismatches( indexed, libPath );
+    }
+
+    // A footprint changed since the index was written
+    if( footprintCount )
+    {
+        PCB_IO io;
+        std::unique_ptr<MODULE> footprint( io.FootprintLoad( libPath, wxT( "FP0" ) ) );
+
+        wxDateTime changed = wxDateTime::Now() - wxTimeSpan::Minutes( 30 );
+
+        footprint->SetDescription( footprint->GetDescription() + wxT( " (changed)" ) );
+        io.FootprintSave( libPath, footprint.get() );
+
+        // Only this file is parsed again, the others keep their time
+        wxFileName( libPath, wxT( "FP0" ), KiCadFootprintFileExtension )
+                .SetTimes( &changed, &changed, NULL );
+        wxFileName::DirName( libPath ).SetTimes( &changed, &changed, NULL );
+
+        FOOTPRINT_LIST_IMPL indexed;
+
+        indexed.ReadFootprintFiles( &table );
+        mismatches += countMismatches( indexed, libPath );
+    }
+
+    wxRemoveFile( indexFile );
+    wxFileName::Rmdir( libPath, wxPATH_RMDIR_RECURSIVE );
+
+    int reps = aContext.m_reps;
+
+    os << wxString::Format( "  %u footprints", footprintCount ) << std::endl;
+    os << wxString::Format( "  list (parsed):  %10lld us", parseUs / reps ) << std::endl;
+    os << wxString::Format( "  list (indexed): %10lld us, x%.2f", indexedUs / reps,
+                            indexedUs ? (double) parseUs / indexedUs : 0.0 ) << std::endl;
+    os << wxString::Format( "  %d mismatches", mismatches ) << std::endl;
+
+    return mismatches == 0;
+}
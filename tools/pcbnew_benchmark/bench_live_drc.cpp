@@ -0,0 +1,199 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file bench_live_drc.cpp
+ * Applies random edits to a board, updating the live DRC after each of them, then
+ * compares the resulting markers with the markers of a full test of the edited board.
+ */
+
+#include <fctsys.h>
+#include <class_board.h>
+#include <class_module.h>
+#include <class_track.h>
+#include <class_marker_pcb.h>
+#include <drc_live_context.h>
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <set>
+#include <tuple>
+
+#include "pcbnew_benchmark.h"
+
+
+/// Identifies a marker independently of its address
+typedef std::tuple<const BOARD_ITEM*, int, int, int, int, int, int, int> MARKER_KEY;
+
+
+static std::set<MARKER_KEY> markerKeys( const DRC_LIVE_CONTEXT& aContext )
+{
+    std::set<MARKER_KEY> keys;
+
+    for( const auto& entry : aContext.GetMarkers() )
+    {
+        const MARKER_PCB* marker = entry.second;
+        const DRC_ITEM& rpt = marker->GetReporter();
+
+        keys.insert( MARKER_KEY( entry.first, rpt.GetErrorCode(),
+                                 marker->GetPosition().x, marker->GetPosition().y,
+                                 rpt.GetPointA().x, rpt.GetPointA().y,
+                                 rpt.GetPointB().x, rpt.GetPointB().y ) );
+    }
+
+    return keys;
+}
+
+
+bool bench_live_drc( BENCH_CONTEXT& aContext )
+{
+    std::ostream& os = aContext.m_out;
+    BOARD* board = aContext.GetBoard();
+
+    DRC_LIVE_CONTEXT live( board, false );
+
+    TIME_PT start = CLOCK::now();
+    live.Rebuild();
+    long long fullUs = elapsedUs( start );
+
+    os << wxString::Format( "  full test:         %lld us, %d items, %d markers",
+                            fullUs, live.GetLastResult().m_itemsTested,
+                            (int) live.GetMarkers().size() ) << std::endl;
+
+    std::vector<TRACK*> tracks;
+    std::vector<MODULE*> modules;
+
+    for( TRACK* track = board->m_Track; track; track = track->Next() )
+        tracks.push_back( track );
+
+    for( MODULE* module = board->m_Modules; module; module = module->Next() )
+        modules.push_back( module );
+
+    // The edits are the same from run to run
+    std::mt19937 rng( 1 );
+    std::uniform_int_distribution<int> offset( -500000, 500000 );   // +/- 0.5 mm
+    std::vector<BOARD_ITEM*> none;
+    std::vector<TRACK*> removedTracks;
+
+    int edits = aContext.m_reps * 100;
+    long long incrementalUs = 0;
+    long long maxUs = 0;
+    long long itemsTested = 0;
+
+    for( int ii = 0; ii < edits && ( tracks.size() || modules.size() ); ++ii )
+    {
+        std::vector<BOARD_ITEM*> changed( 1 );
+        bool moveModule = modules.size() && ( tracks.empty() || rng() % 4 == 0 );
+        wxPoint delta( offset( rng ), offset( rng ) );
+
+        start = CLOCK::now();
+
+        if( moveModule )
+        {
+            MODULE* module = modules[ rng() % modules.size() ];
+
+            module->Move( delta );
+            changed[0] = module;
+            live.Update( none, changed, none );
+        }
+        else if( rng() % 10 == 0 && tracks.size() > 1 )
+        {
+            // Remove a track (kept alive, as the undo list would)
+            size_t idx = rng() % tracks.size();
+            TRACK* track = tracks[idx];
+
+            tracks.erase( tracks.begin() + idx );
+            board->Remove( track );
+            removedTracks.push_back( track );
+            changed[0] = track;
+            live.Update( none, none, changed );
+        }
+        else if( rng() % 10 == 0 )
+        {
+            // Add a shifted copy of a track
+            TRACK* track = static_cast<TRACK*>( tracks[ rng() % tracks.size() ]->Clone() );
+
+            track->Move( delta );
+            board->Add( track );
+            tracks.push_back( track );
+            changed[0] = track;
+            live.Update( changed, none, none );
+        }
+        else
+        {
+            TRACK* track = tracks[ rng() % tracks.size() ];
+
+            track->Move( delta );
+            changed[0] = track;
+            live.Update( none, changed, none );
+        }
+
+        long long us = elapsedUs( start );
+
+        incrementalUs += us;
+        maxUs = std::max( maxUs, us );
+        itemsTested += live.GetLastResult().m_itemsTested;
+    }
+
+    if( edits )
+    {
+        os << wxString::Format( "  incremental:       %d edits, mean %lld us, max %lld us, "
+                                "%lld items tested per edit",
+                                edits, incrementalUs / edits, maxUs, itemsTested / edits )
+           << std::endl;
+    }
+
+    // The reference: a full test of the edited board
+    bool ok;
+
+    {
+        DRC_LIVE_CONTEXT reference( board, false );
+
+        start = CLOCK::now();
+        reference.Rebuild();
+        fullUs = elapsedUs( start );
+
+        std::set<MARKER_KEY> liveKeys = markerKeys( live );
+        std::set<MARKER_KEY> refKeys = markerKeys( reference );
+        std::vector<MARKER_KEY> diff;
+
+        std::set_symmetric_difference( liveKeys.begin(), liveKeys.end(),
+                                       refKeys.begin(), refKeys.end(),
+                                       std::back_inserter( diff ) );
+
+        os << wxString::Format( "  full test, edited: %lld us, %d markers (live: %d), "
+                                "%d mismatches",
+                                fullUs, (int) refKeys.size(), (int) liveKeys.size(),
+                                (int) diff.size() ) << std::endl;
+
+        ok = diff.empty();
+    }
+
+    for( TRACK* track : removedTracks )
+        delete track;
+
+    aContext.ReloadBoard();
+
+    return ok;
+}
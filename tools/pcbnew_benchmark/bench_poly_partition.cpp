@@ -0,0 +1,217 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file bench_poly_partition.cpp
+ * Runs the polygon operations of the zone fill on the zones of a board, with the
+ * SHAPE_POLY_SET modes processing one polygon set at a time and with the partitioned
+ * ones, and compares the filled areas. Clipper may round the intersections differently when
+ * the groups of polygons are processed apart, so the areas are compared, not the points.
+ */
+
+#include <fctsys.h>
+#include <class_board.h>
+#include <class_module.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <thread_pool.h>
+
+#include <cmath>
+
+#include "pcbnew_benchmark.h"
+
+
+/// The time spent in each step of the fill
+struct PARTITION_TIMES
+{
+    long long m_inflate  = 0;
+    long long m_holes    = 0;
+    long long m_subtract = 0;
+    long long m_fracture = 0;
+
+    long long Total() const
+    {
+        return m_inflate + m_holes + m_subtract + m_fracture;
+    }
+};
+
+
+static double polySetArea( const SHAPE_POLY_SET& aPolys )
+{
+    double area = 0.0;
+
+    for( int ii = 0; ii < aPolys.OutlineCount(); ++ii )
+    {
+        area += std::abs( aPolys.COutline( ii ).Area() );
+
+        for( int jj = 0; jj < aPolys.HoleCount( ii ); ++jj )
+            area -= std::abs( aPolys.CHole( ii, jj ).Area() );
+    }
+
+    return area;
+}
+
+
+/**
+ * The clearance areas of the pads and tracks of the other nets on the layer of aZone, as
+ * the zone fill builds them.
+ */
+static SHAPE_POLY_SET zoneHoles( BOARD* aBoard, ZONE_CONTAINER* aZone, int aSegsPerCircle,
+                                 double aCorrectionFactor )
+{
+    SHAPE_POLY_SET holes;
+    int halfThickness = aZone->GetMinThickness() / 2;
+
+    for( MODULE* module = aBoard->m_Modules; module; module = module->Next() )
+    {
+        for( D_PAD* pad = module->PadsList(); pad; pad = pad->Next() )
+        {
+            if( !pad->IsOnLayer( aZone->GetLayer() )
+                    || ( pad->GetNetCode() == aZone->GetNetCode() && pad->GetNetCode() > 0 ) )
+                continue;
+
+            int clearance = std::max( aZone->GetZoneClearance(), pad->GetClearance() );
+
+            pad->TransformShapeWithClearanceToPolygon( holes, clearance + halfThickness,
+                                                       aSegsPerCircle, aCorrectionFactor );
+        }
+    }
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+    {
+        if( !track->IsOnLayer( aZone->GetLayer() )
+                || ( track->GetNetCode() == aZone->GetNetCode() && track->GetNetCode() > 0 ) )
+            continue;
+
+        int clearance = std::max( aZone->GetZoneClearance(), track->GetClearance() );
+
+        track->TransformShapeWithClearanceToPolygon( holes, clearance + halfThickness,
+                                                     aSegsPerCircle, aCorrectionFactor );
+    }
+
+    return holes;
+}
+
+
+/**
+ * The polygon operations of ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList_NG(),
+ * in aFastMode and aStrictMode.
+ * @return the fractured filled areas.
+ */
+static SHAPE_POLY_SET fillZone( ZONE_CONTAINER* aZone, const SHAPE_POLY_SET& aHoles,
+                                int aSegsPerCircle, SHAPE_POLY_SET::POLYGON_MODE aFastMode,
+                                SHAPE_POLY_SET::POLYGON_MODE aStrictMode,
+                                PARTITION_TIMES& aTimes )
+{
+    SHAPE_POLY_SET solidAreas = *aZone->GetSmoothedPoly();
+    SHAPE_POLY_SET holes = aHoles;
+
+    TIME_PT start = CLOCK::now();
+    solidAreas.Inflate( -aZone->GetMinThickness() / 2, aSegsPerCircle, aFastMode );
+    solidAreas.Simplify( aFastMode );
+    aTimes.m_inflate += elapsedUs( start );
+
+    start = CLOCK::now();
+    holes.Simplify( aFastMode );
+    aTimes.m_holes += elapsedUs( start );
+
+    start = CLOCK::now();
+    solidAreas.BooleanSubtract( holes, aStrictMode );
+    aTimes.m_subtract += elapsedUs( start );
+
+    start = CLOCK::now();
+    solidAreas.Simplify( aFastMode );
+    solidAreas.FractureSimplified( aFastMode );
+    aTimes.m_fracture += elapsedUs( start );
+
+    return solidAreas;
+}
+
+
+bool bench_poly_partition( BENCH_CONTEXT& aContext )
+{
+    std::ostream& os = aContext.m_out;
+    BOARD* board = aContext.GetBoard();
+    PARTITION_TIMES serial;
+    PARTITION_TIMES partitioned;
+    int mismatches = 0;
+    int holeCount = 0;
+
+    for( int ii = 0; ii < board->GetAreaCount(); ++ii )
+    {
+        ZONE_CONTAINER* zone = board->GetArea( ii );
+
+        if( zone->GetIsKeepout() )
+            continue;
+
+        int segsPerCircle = zone->GetArcSegmentCount();
+        double correctionFactor = 1.0 / cos( M_PI / (double) segsPerCircle );
+        SHAPE_POLY_SET holes = zoneHoles( board, zone, segsPerCircle, correctionFactor );
+        SHAPE_POLY_SET reference;
+        SHAPE_POLY_SET result;
+
+        holeCount += holes.OutlineCount();
+
+        for( int rep = 0; rep < std::max( aContext.m_reps, 1 ); ++rep )
+        {
+            reference = fillZone( zone, holes, segsPerCircle, SHAPE_POLY_SET::PM_FAST,
+                                  SHAPE_POLY_SET::PM_STRICTLY_SIMPLE, serial );
+            result = fillZone( zone, holes, segsPerCircle, SHAPE_POLY_SET::PM_FAST_PARTITIONED,
+                               SHAPE_POLY_SET::PM_STRICTLY_SIMPLE_PARTITIONED, partitioned );
+        }
+
+        // One unit of rounding along the outlines at most
+        double length = 0.0;
+
+        for( int jj = 0; jj < reference.OutlineCount(); ++jj )
+            length += reference.COutline( jj ).Length();
+
+        double diff = std::abs( polySetArea( result ) - polySetArea( reference ) );
+
+        if( diff > length )
+        {
+            os << wxString::Format( "  zone %d: area differs by %g", ii, diff ) << std::endl;
+            mismatches++;
+        }
+    }
+
+    auto line = [&]( const char* aStep, long long aSerial, long long aPartitioned )
+    {
+        os << wxString::Format( "  %-10s serial: %10lld us, partitioned: %10lld us, x%.2f",
+                                aStep, aSerial, aPartitioned,
+                                aPartitioned ? (double) aSerial / aPartitioned : 0.0 )
+           << std::endl;
+    };
+
+    line( "inflate", serial.m_inflate, partitioned.m_inflate );
+    line( "holes", serial.m_holes, partitioned.m_holes );
+    line( "subtract", serial.m_subtract, partitioned.m_subtract );
+    line( "fracture", serial.m_fracture, partitioned.m_fracture );
+    line( "total", serial.Total(), partitioned.Total() );
+
+    os << wxString::Format( "  %d clearance holes, %u threads, %d mismatches", holeCount,
+                            THREAD_POOL::GetInstance().GetThreadCount(), mismatches )
+       << std::endl;
+
+    return mismatches == 0;
+}
@@ -0,0 +1,102 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file bench_ratsnest.cpp
+ * Computes the ratsnest of all the nets of a board again, timing the spanning trees
+ * alone. The ratsnest of a net links its clusters: it must have one line less than
+ * the net has clusters.
+ */
+
+#include <fctsys.h>
+#include <class_board.h>
+#include <connectivity.h>
+#include <connectivity_algo.h>
+#include <ratsnest_data.h>
+
+#include <map>
+
+#include "pcbnew_benchmark.h"
+
+
+bool bench_ratsnest( BENCH_CONTEXT& aContext )
+{
+    std::ostream& os = aContext.m_out;
+    BOARD* board = aContext.GetBoard();
+    auto connectivity = board->GetConnectivity();
+    auto algo = connectivity->GetConnectivityAlgo();
+
+    long long bestUs = -1;
+    long long totalUs = 0;
+    int nets = 0;
+
+    for( int rep = 0; rep < aContext.m_reps; ++rep )
+    {
+        for( int net = 1; net < algo->NetCount(); ++net )
+            algo->MarkNetAsDirty( net );
+
+        connectivity->RecalculateRatsnest();
+
+        const CONNECTIVITY_STATS& stats = connectivity->GetStats();
+        long long us = stats.m_ratsnestTime;
+
+        nets = stats.m_netsRecomputed;
+        totalUs += us;
+
+        if( bestUs < 0 || us < bestUs )
+            bestUs = us;
+    }
+
+    // Count the clusters of each net, the ratsnest links them
+    std::map<int, int> netClusters;
+    unsigned int expected = 0;
+    unsigned int nodes = 0;
+
+    for( const auto& cluster : algo->GetClusters() )
+        netClusters[ cluster->OriginNet() ]++;
+
+    for( const auto& entry : netClusters )
+    {
+        if( entry.first > 0 )
+            expected += entry.second - 1;
+    }
+
+    for( int net = 1; net < connectivity->GetNetCount(); ++net )
+    {
+        if( connectivity->GetRatsnestForNet( net ) )
+            nodes += connectivity->GetRatsnestForNet( net )->GetNodeCount();
+    }
+
+    unsigned int unconnected = connectivity->GetUnconnectedCount();
+
+    os << wxString::Format( "  %d nets, %u nodes, %u unconnected (%u expected)",
+                            nets, nodes, unconnected, expected ) << std::endl;
+
+    if( aContext.m_reps )
+    {
+        os << wxString::Format( "  ratsnest: best %lld us, mean %lld us",
+                                bestUs, totalUs / aContext.m_reps ) << std::endl;
+    }
+
+    return unconnected == expected;
+}
@@ -0,0 +1,336 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file bench_router.cpp
+ * Replays routing operations through the push and shove router, without a view: the
+ * board is synchronized into the router world by a PNS_KICAD_IFACE without a view or
+ * a frame, and the routed tracks are only committed to the world.
+ *
+ * The operations are read from the router event logs (see PNS::LOGGER::ParseEvents(),
+ * saved to /tmp/pns_events.log by the router "dump log" hotkey) found next to the board
+ * as <board name>-*.pns. Without them, pads of the same net are routed to each other
+ * in straight mouse moves. The latency of each ROUTER::Move() is reported with the
+ * number of PNS::NODE::Branch() calls, and the hit rate of the item hull caches.
+ */
+
+#include <fctsys.h>
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+
+#include <router/pns_router.h>
+#include <router/pns_kicad_iface.h>
+#include <router/pns_logger.h>
+#include <router/pns_debug_decorator.h>
+
+#include <wx/dir.h>
+
+#include <algorithm>
+#include <map>
+#include <random>
+
+#include "pcbnew_benchmark.h"
+
+
+typedef std::vector<PNS::LOGGER::EVENT_ENTRY> ROUTER_SCRIPT;
+
+
+/**
+ * Picks the item an operation at aWhere starts or ends on, as the router tool does
+ * (without the high contrast mode): vias and pads first, on aLayer first.
+ */
+static PNS::ITEM* pickItem( PNS::ROUTER& aRouter, const VECTOR2I& aWhere, int aNet, int aLayer )
+{
+    PNS::ITEM* prioritized[4] = { NULL, NULL, NULL, NULL };
+    PNS::ITEM_SET candidates = aRouter.QueryHoverItems( aWhere );
+
+    for( PNS::ITEM* item : candidates.Items() )
+    {
+        if( !IsCopperLayer( item->Layers().Start() ) )
+            continue;
+
+        if( aNet >= 0 && item->Net() != aNet )
+            continue;
+
+        int prio = item->OfKind( PNS::ITEM::VIA_T | PNS::ITEM::SOLID_T ) ? 0 : 1;
+
+        if( !prioritized[prio + 2] )
+            prioritized[prio + 2] = item;
+
+        if( item->Layers().Overlaps( aLayer ) )
+            prioritized[prio] = item;
+    }
+
+    for( PNS::ITEM* item : prioritized )
+    {
+        if( item )
+            return ( aLayer < 0 || item->Layers().Overlaps( aLayer ) ) ? item : NULL;
+    }
+
+    return NULL;
+}
+
+
+/**
+ * Makes a script routing pads of the same net to each other on the front copper, for
+ * boards without recorded scripts.
+ */
+static void makeScripts( BOARD* aBoard, std::vector<ROUTER_SCRIPT>& aScripts )
+{
+    const size_t routeCount = 20;
+    const int stepCount = 30;
+
+    std::map<int, std::vector<D_PAD*>> netPads;
+
+    for( MODULE* module = aBoard->m_Modules; module; module = module->Next() )
+    {
+        for( D_PAD* pad = module->PadsList(); pad; pad = pad->Next() )
+        {
+            if( pad->GetNetCode() > 0 && pad->IsOnLayer( F_Cu ) )
+                netPads[ pad->GetNetCode() ].push_back( pad );
+        }
+    }
+
+    std::vector<std::pair<D_PAD*, D_PAD*>> pairs;
+
+    for( const auto& net : netPads )
+    {
+        if( net.second.size() >= 2 )
+            pairs.emplace_back( net.second[0], net.second[1] );
+    }
+
+    // The routes are the same from run to run
+    std::mt19937 rng( 1 );
+    std::shuffle( pairs.begin(), pairs.end(), rng );
+
+    if( pairs.size() > routeCount )
+        pairs.resize( routeCount );
+
+    for( const auto& pair : pairs )
+    {
+        VECTOR2I start( pair.first->GetPosition() );
+        VECTOR2I end( pair.second->GetPosition() );
+        ROUTER_SCRIPT script;
+
+        script.push_back( { PNS::LOGGER::EVT_START_ROUTE, start, F_Cu } );
+
+        for( int ii = 1; ii <= stepCount; ++ii )
+            script.push_back( { PNS::LOGGER::EVT_MOVE, start + ( end - start ) * ii / stepCount, 0 } );
+
+        script.push_back( { PNS::LOGGER::EVT_FIX, end, 0 } );
+        aScripts.push_back( script );
+    }
+}
+
+
+/**
+ * Replays aScript, adding the duration and the branch count of each Move() to aMoveUs
+ * and aMoveBranches.
+ * @return false if the operation could not be started.
+ */
+static bool replay( PNS::ROUTER& aRouter, BOARD* aBoard, const ROUTER_SCRIPT& aScript,
+                    std::vector<long long>& aMoveUs, std::vector<int>& aMoveBranches )
+{
+    bool started = false;
+
+    for( const PNS::LOGGER::EVENT_ENTRY& evt : aScript )
+    {
+        switch( evt.type )
+        {
+        case PNS::LOGGER::EVT_START_ROUTE:
+        {
+            PNS::ITEM* startItem = pickItem( aRouter, evt.p, -1, evt.param );
+            PNS::SIZES_SETTINGS sizes( aRouter.Sizes() );
+
+            sizes.Init( aBoard, startItem );
+            sizes.AddLayerPair( F_Cu, B_Cu );
+            aRouter.UpdateSizes( sizes );
+
+            started = aRouter.StartRouting( evt.p, startItem, evt.param );
+            break;
+        }
+
+        case PNS::LOGGER::EVT_START_DRAG:
+            started = aRouter.StartDragging( evt.p, pickItem( aRouter, evt.p, -1, -1 ),
+                                             evt.param );
+            break;
+
+        case PNS::LOGGER::EVT_MOVE:
+        case PNS::LOGGER::EVT_FIX:
+        {
+            if( !aRouter.RoutingInProgress() )
+                break;
+
+            // The end items are only looked for when routing, as the tools do
+            PNS::ITEM* endItem = NULL;
+            std::vector<int> nets = aRouter.GetCurrentNets();
+
+            if( nets.size() )
+                endItem = pickItem( aRouter, evt.p, nets[0], aRouter.GetCurrentLayer() );
+
+            if( evt.type == PNS::LOGGER::EVT_FIX )
+            {
+                aRouter.FixRoute( evt.p, endItem );
+                break;
+            }
+
+            aRouter.GetWorld()->ResetBranchCount();
+
+            TIME_PT start = CLOCK::now();
+            aRouter.Move( evt.p, endItem );
+            aMoveUs.push_back( elapsedUs( start ) );
+
+            aMoveBranches.push_back( aRouter.GetWorld()->BranchCount() );
+            break;
+        }
+        }
+    }
+
+    if( aRouter.RoutingInProgress() )
+        aRouter.StopRouting();
+
+    return started;
+}
+
+
+/// The value of the sorted aValues below which are aPercent % of them
+static long long percentile( const std::vector<long long>& aValues, int aPercent )
+{
+    if( aValues.empty() )
+        return 0;
+
+    size_t rank = ( aValues.size() * aPercent + 99 ) / 100;
+
+    return aValues[ std::max<size_t>( rank, 1 ) - 1 ];
+}
+
+
+bool bench_router( BENCH_CONTEXT& aContext )
+{
+    std::ostream& os = aContext.m_out;
+    BOARD* board = aContext.GetBoard();
+
+    std::vector<ROUTER_SCRIPT> scripts;
+    wxArrayString files;
+
+    if( wxDir::Exists( aContext.m_file.GetPath() ) )
+        wxDir::GetAllFiles( aContext.m_file.GetPath(), &files,
+                            aContext.m_file.GetName() + "-*.pns", wxDIR_FILES );
+
+    files.Sort();
+
+    for( const wxString& file : files )
+    {
+        ROUTER_SCRIPT script;
+
+        if( PNS::LOGGER::ParseEvents( (const char*) file.utf8_str(), script ) && script.size() )
+            scripts.push_back( script );
+    }
+
+    if( scripts.size() )
+    {
+        os << wxString::Format( "  %d recorded scripts", (int) scripts.size() ) << std::endl;
+    }
+    else
+    {
+        makeScripts( board, scripts );
+        os << wxString::Format( "  no recorded script, %d pad to pad routes",
+                                (int) scripts.size() ) << std::endl;
+    }
+
+    std::vector<long long> moveUs;
+    std::vector<int> moveBranches;
+    long long syncUs = 0;
+    long long hullHits = 0;
+    long long hullMisses = 0;
+    int failed = 0;
+
+    for( int ii = 0; ii < aContext.m_reps; ++ii )
+    {
+        PNS_KICAD_IFACE iface;
+        PNS::ROUTER router;
+        PNS::ROUTING_SETTINGS settings;
+
+        settings.SetMode( PNS::RM_Shove );
+
+        iface.SetBoard( board );
+        router.SetInterface( &iface );
+        router.LoadSettings( settings );
+
+        TIME_PT start = CLOCK::now();
+        router.SyncWorld();
+        syncUs += elapsedUs( start );
+
+        PNS::DEBUG_DECORATOR* dbg = iface.GetDebugDecorator();
+
+        dbg->ResetCounters();
+
+        // Each run routes in a fresh world: the scripts see the tracks of the previous ones
+        for( const ROUTER_SCRIPT& script : scripts )
+        {
+            if( !replay( router, board, script, moveUs, moveBranches ) && ii == 0 )
+                failed++;
+        }
+
+        hullHits += dbg->HullCacheHits();
+        hullMisses += dbg->HullCacheMisses();
+    }
+
+    os << wxString::Format( "  world sync: mean %lld us", syncUs / aContext.m_reps ) << std::endl;
+
+    if( failed )
+        os << wxString::Format( "  %d operations could not be started", failed ) << std::endl;
+
+    if( moveUs.empty() )
+    {
+        os << "  no Move() call" << std::endl;
+        return true;
+    }
+
+    long long totalBranches = 0;
+
+    for( int branches : moveBranches )
+        totalBranches += branches;
+
+    std::sort( moveUs.begin(), moveUs.end() );
+    std::sort( moveBranches.begin(), moveBranches.end() );
+
+    os << wxString::Format( "  Move(): %d calls, p50 %lld us, p95 %lld us, p99 %lld us, "
+                            "max %lld us", (int) moveUs.size(), percentile( moveUs, 50 ),
+                            percentile( moveUs, 95 ), percentile( moveUs, 99 ),
+                            moveUs.back() ) << std::endl;
+    os << wxString::Format( "  Branch(): %lld calls, mean %lld per Move(), max %d",
+                            totalBranches, totalBranches / (long long) moveUs.size(),
+                            moveBranches.back() ) << std::endl;
+
+    if( hullHits + hullMisses > 0 )
+    {
+        os << wxString::Format( "  Hull() of world items: %lld calls, %lld hits, %lld misses (%.1f%% hits)",
+                                hullHits + hullMisses, hullHits, hullMisses,
+                                100.0 * hullHits / ( hullHits + hullMisses ) ) << std::endl;
+    }
+
+    // The board itself is not modified
+    return true;
+}
@@ -0,0 +1,189 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file bench_seg_batch.cpp
+ * Times SHAPE_LINE_CHAIN::Collide() with each SEG_BATCH kernel against the loop testing
+ * every segment it replaced, and checks that the results do not change: the track segments
+ * of the board against the outlines of the filled areas of the zones on their layer, then
+ * random segments against a long zigzag chain.
+ */
+
+#include <fctsys.h>
+#include <class_board.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <geometry/seg_batch.h>
+#include <geometry/shape_line_chain.h>
+
+#include <random>
+
+#include "pcbnew_benchmark.h"
+
+
+/**
+ * SHAPE_LINE_CHAIN::Collide() as it was before the segments were skipped by SEG_BATCH.
+ */
+static bool referenceCollide( const SHAPE_LINE_CHAIN& aChain, const SEG& aSeg, int aClearance )
+{
+    BOX2I box_a( aSeg.A, aSeg.B - aSeg.A );
+    BOX2I::ecoord_type dist_sq = (BOX2I::ecoord_type) aClearance * aClearance;
+
+    for( int i = 0; i < aChain.SegmentCount(); i++ )
+    {
+        const SEG& s = aChain.CSegment( i );
+        BOX2I box_b( s.A, s.B - s.A );
+
+        if( box_a.SquaredDistance( box_b ) < dist_sq && s.Collide( aSeg, aClearance ) )
+            return true;
+    }
+
+    return false;
+}
+
+
+/// A query of the benchmark: a segment against a chain
+struct SEG_QUERY
+{
+    const SHAPE_LINE_CHAIN* m_chain;
+    SEG                     m_seg;
+    int                     m_clearance;
+};
+
+
+/**
+ * Runs aQueries with the former loop and with each kernel, printing the timings.
+ * @return the number of results differing from the former loop ones.
+ */
+static int runQueries( BENCH_CONTEXT& aContext, const char* aName,
+                       const std::vector<SEG_QUERY>& aQueries )
+{
+    std::ostream& os = aContext.m_out;
+    int reps = std::max( aContext.m_reps, 1 );
+    std::vector<bool> expected;
+    long long refUs = 0;
+
+    for( int rep = 0; rep < reps; ++rep )
+    {
+        expected.clear();
+
+        TIME_PT start = CLOCK::now();
+
+        for( const SEG_QUERY& query : aQueries )
+            expected.push_back( referenceCollide( *query.m_chain, query.m_seg,
+                                                  query.m_clearance ) );
+
+        refUs += elapsedUs( start );
+    }
+
+    os << wxString::Format( "  %s: %d queries", aName, (int) aQueries.size() ) << std::endl;
+    os << wxString::Format( "    former loop: %10lld us", refUs / reps ) << std::endl;
+
+    int mismatches = 0;
+
+    for( int kernel = SEG_BATCH::KERNEL_SCALAR; kernel <= SEG_BATCH::BestKernel(); kernel++ )
+    {
+        static const char* names[] = { "scalar", "sse2", "avx2" };
+        std::vector<bool> found;
+        long long us = 0;
+
+        SEG_BATCH::SetKernel( (SEG_BATCH::KERNEL) kernel );
+
+        for( int rep = 0; rep < reps; ++rep )
+        {
+            found.clear();
+
+            TIME_PT start = CLOCK::now();
+
+            for( const SEG_QUERY& query : aQueries )
+                found.push_back( query.m_chain->Collide( query.m_seg, query.m_clearance ) );
+
+            us += elapsedUs( start );
+        }
+
+        if( found != expected )
+            mismatches++;
+
+        os << wxString::Format( "    %-11s  %10lld us, x%.2f", names[kernel], us / reps,
+                                us ? (double) refUs / us : 0.0 ) << std::endl;
+    }
+
+    SEG_BATCH::SetKernel( SEG_BATCH::BestKernel() );
+
+    return mismatches;
+}
+
+
+bool bench_seg_batch( BENCH_CONTEXT& aContext )
+{
+    BOARD* board = aContext.GetBoard();
+    int mismatches = 0;
+
+    // The tracks against the filled areas of the zones on their layer
+    std::vector<SEG_QUERY> queries;
+
+    for( int ii = 0; ii < board->GetAreaCount(); ++ii )
+    {
+        ZONE_CONTAINER* zone = board->GetArea( ii );
+        const SHAPE_POLY_SET& fill = zone->GetFilledPolysList();
+
+        for( int jj = 0; jj < fill.OutlineCount(); ++jj )
+        {
+            const SHAPE_LINE_CHAIN* chain = &fill.COutline( jj );
+
+            for( TRACK* track = board->m_Track; track; track = track->Next() )
+            {
+                if( track->Type() != PCB_TRACE_T || !zone->IsOnLayer( track->GetLayer() ) )
+                    continue;
+
+                queries.push_back( { chain, SEG( track->GetStart(), track->GetEnd() ),
+                                     track->GetWidth() / 2 + zone->GetZoneClearance() } );
+            }
+        }
+    }
+
+    mismatches += runQueries( aContext, "tracks against the zone fills", queries );
+
+    // Short segments against a long zigzag chain
+    SHAPE_LINE_CHAIN zigzag;
+    std::mt19937 rng( 2 );
+    std::uniform_int_distribution<int> coord( 0, 1000000 );
+
+    for( int i = 0; i < 2000; i++ )
+        zigzag.Append( VECTOR2I( i * 500, ( i % 2 ) * 2000 ), true );
+
+    queries.clear();
+
+    for( int i = 0; i < 2000; i++ )
+    {
+        VECTOR2I a( coord( rng ), coord( rng ) );
+
+        queries.push_back( { &zigzag, SEG( a, a + VECTOR2I( 300, 300 ) ), 100 } );
+    }
+
+    mismatches += runQueries( aContext, "segments against a zigzag chain", queries );
+
+    aContext.m_out << wxString::Format( "  %d mismatches", mismatches ) << std::endl;
+
+    return mismatches == 0;
+}
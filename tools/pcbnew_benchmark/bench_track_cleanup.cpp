@@ -0,0 +1,205 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file bench_track_cleanup.cpp
+ * Times the position queries of the track cleanup (duplicated tracks, segments to merge
+ * at each track end, pads under the track ends) done through the board spatial index,
+ * and compares their results with the ones of the former walks of the board lists.
+ * The cleanup itself needs an edit frame to commit its changes to.
+ */
+
+#include <fctsys.h>
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+#include <board_item_index.h>
+
+#include "pcbnew_benchmark.h"
+
+
+/// The result of the queries for all the tracks, to compare both methods
+struct CLEANUP_QUERIES
+{
+    int m_duplicates = 0;
+    int m_connected = 0;
+    int m_onPad = 0;
+
+    bool operator!=( const CLEANUP_QUERIES& aOther ) const
+    {
+        return m_duplicates != aOther.m_duplicates || m_connected != aOther.m_connected
+               || m_onPad != aOther.m_onPad;
+    }
+};
+
+
+static bool isDuplicate( const TRACK* aTrack, const TRACK* aOther )
+{
+    return aTrack != aOther && aTrack->GetNetCode() == aOther->GetNetCode()
+           && aTrack->Type() == aOther->Type() && aTrack->GetLayer() == aOther->GetLayer()
+           && ( ( aTrack->GetStart() == aOther->GetStart() && aTrack->GetEnd() == aOther->GetEnd() )
+             || ( aTrack->GetStart() == aOther->GetEnd() && aTrack->GetEnd() == aOther->GetStart() ) );
+}
+
+
+static bool isConnected( const TRACK* aTrack, const TRACK* aOther, const wxPoint& aPosition )
+{
+    return aTrack != aOther && aTrack->GetNetCode() == aOther->GetNetCode()
+           && ( aTrack->GetLayerSet() & aOther->GetLayerSet() ).any()
+           && ( aOther->GetStart() == aPosition || aOther->GetEnd() == aPosition );
+}
+
+
+/// The queries walking the board lists, as the cleanup did
+static void linearQueries( BOARD* aBoard, CLEANUP_QUERIES& aResult )
+{
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+    {
+        for( TRACK* other = aBoard->m_Track; other; other = other->Next() )
+        {
+            if( isDuplicate( track, other ) )
+                aResult.m_duplicates++;
+        }
+
+        for( ENDPOINT_T endpoint = ENDPOINT_START; endpoint <= ENDPOINT_END;
+                endpoint = ENDPOINT_T( endpoint + 1 ) )
+        {
+            const wxPoint& position = track->GetEndPoint( endpoint );
+
+            for( TRACK* other = aBoard->m_Track; other; other = other->Next() )
+            {
+                if( isConnected( track, other, position ) )
+                    aResult.m_connected++;
+            }
+
+            for( MODULE* module = aBoard->m_Modules; module; module = module->Next() )
+            {
+                for( D_PAD* pad = module->PadsList(); pad; pad = pad->Next() )
+                {
+                    if( ( pad->GetLayerSet() & track->GetLayerSet() ).any()
+                            && pad->HitTest( position ) )
+                        aResult.m_onPad++;
+                }
+            }
+        }
+    }
+}
+
+
+/// The same queries, through the board spatial index
+static void indexedQueries( BOARD* aBoard, CLEANUP_QUERIES& aResult )
+{
+    BOARD_ITEM_INDEX* index = aBoard->GetItemIndex();
+    std::vector<TRACK*> tracks;
+    std::vector<D_PAD*> pads;
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+    {
+        index->QueryTracks( track->GetStart(), tracks );
+
+        for( TRACK* other : tracks )
+        {
+            if( isDuplicate( track, other ) )
+                aResult.m_duplicates++;
+        }
+
+        for( ENDPOINT_T endpoint = ENDPOINT_START; endpoint <= ENDPOINT_END;
+                endpoint = ENDPOINT_T( endpoint + 1 ) )
+        {
+            const wxPoint& position = track->GetEndPoint( endpoint );
+
+            index->QueryTracks( position, tracks );
+
+            for( TRACK* other : tracks )
+            {
+                if( isConnected( track, other, position ) )
+                    aResult.m_connected++;
+            }
+
+            index->QueryPads( position, pads );
+
+            for( D_PAD* pad : pads )
+            {
+                if( ( pad->GetLayerSet() & track->GetLayerSet() ).any()
+                        && pad->HitTest( position ) )
+                    aResult.m_onPad++;
+            }
+        }
+    }
+}
+
+
+bool bench_track_cleanup( BENCH_CONTEXT& aContext )
+{
+    std::ostream& os = aContext.m_out;
+    BOARD* board = aContext.GetBoard();
+    int trackCount = board->m_Track.GetCount();
+
+    // The walks are quadratic: once is enough
+    CLEANUP_QUERIES reference;
+
+    TIME_PT start = CLOCK::now();
+    linearQueries( board, reference );
+    long long linearUs = elapsedUs( start );
+
+    os << wxString::Format( "  list walks: %d tracks, %lld us (%d duplicates, %d connected "
+                            "ends, %d ends on pads)", trackCount, linearUs,
+                            reference.m_duplicates, reference.m_connected,
+                            reference.m_onPad ) << std::endl;
+
+    // The first run builds the index
+    board->InvalidateItemIndex();
+
+    long long buildUs = 0;
+    long long totalUs = 0;
+    int mismatches = 0;
+
+    for( int ii = 0; ii < aContext.m_reps; ++ii )
+    {
+        CLEANUP_QUERIES result;
+
+        start = CLOCK::now();
+        indexedQueries( board, result );
+        long long us = elapsedUs( start );
+
+        if( ii == 0 )
+            buildUs = us;
+        else
+            totalUs += us;
+
+        if( result != reference )
+            mismatches++;
+    }
+
+    os << wxString::Format( "  spatial index: first run (with the build) %lld us",
+                            buildUs ) << std::endl;
+
+    if( aContext.m_reps > 1 )
+        os << wxString::Format( "  spatial index: mean %lld us, %d mismatches",
+                                totalUs / ( aContext.m_reps - 1 ), mismatches ) << std::endl;
+    else
+        os << wxString::Format( "  spatial index: %d mismatches", mismatches ) << std::endl;
+
+    return mismatches == 0;
+}
@@ -0,0 +1,233 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file bench_zone_fill.cpp
+ * Fills all the zones of a board one after the other, then with the ZONE_FILLER, and
+ * compares the filled areas. The ZONE_FILLER runs a last time on the same board, to time a
+ * refill finding the obstacle polygons in the cache.
+ */
+
+#include <fctsys.h>
+#include <class_board.h>
+#include <class_zone.h>
+#include <zone_filler.h>
+#include <zone_obstacle_cache.h>
+#include <thread_pool.h>
+
+#include "pcbnew_benchmark.h"
+
+
+/// The result of a zone fill, to compare fills of different boards
+struct ZONE_FILL_RESULT
+{
+    SHAPE_POLY_SET       m_polys;
+    std::vector<SEGMENT> m_segments;
+};
+
+
+static bool sameChain( const SHAPE_LINE_CHAIN& aChainA, const SHAPE_LINE_CHAIN& aChainB )
+{
+    if( aChainA.PointCount() != aChainB.PointCount() )
+        return false;
+
+    for( int ii = 0; ii < aChainA.PointCount(); ++ii )
+    {
+        if( aChainA.CPoint( ii ) != aChainB.CPoint( ii ) )
+            return false;
+    }
+
+    return true;
+}
+
+
+static bool sameFill( const ZONE_FILL_RESULT& aFillA, const ZONE_FILL_RESULT& aFillB )
+{
+    const SHAPE_POLY_SET& a = aFillA.m_polys;
+    const SHAPE_POLY_SET& b = aFillB.m_polys;
+
+    if( a.OutlineCount() != b.OutlineCount() )
+        return false;
+
+    for( int ii = 0; ii < a.OutlineCount(); ++ii )
+    {
+        if( a.HoleCount( ii ) != b.HoleCount( ii ) || !sameChain( a.COutline( ii ), b.COutline( ii ) ) )
+            return false;
+
+        for( int jj = 0; jj < a.HoleCount( ii ); ++jj )
+        {
+            if( !sameChain( a.CHole( ii, jj ), b.CHole( ii, jj ) ) )
+                return false;
+        }
+    }
+
+    if( aFillA.m_segments.size() != aFillB.m_segments.size() )
+        return false;
+
+    for( size_t ii = 0; ii < aFillA.m_segments.size(); ++ii )
+    {
+        if( aFillA.m_segments[ii].m_Start != aFillB.m_segments[ii].m_Start
+            || aFillA.m_segments[ii].m_End != aFillB.m_segments[ii].m_End )
+            return false;
+    }
+
+    return true;
+}
+
+
+static std::vector<ZONE_CONTAINER*> zonesToFill( BOARD* aBoard )
+{
+    std::vector<ZONE_CONTAINER*> zones;
+
+    for( int ii = 0; ii < aBoard->GetAreaCount(); ++ii )
+    {
+        if( !aBoard->GetArea( ii )->GetIsKeepout() )
+            zones.push_back( aBoard->GetArea( ii ) );
+    }
+
+    return zones;
+}
+
+
+static ZONE_FILL_RESULT fillResult( const ZONE_CONTAINER* aZone )
+{
+    ZONE_FILL_RESULT result;
+
+    result.m_polys = aZone->GetFilledPolysList();
+    result.m_segments = aZone->FillSegments();
+
+    return result;
+}
+
+
+bool bench_zone_fill( BENCH_CONTEXT& aContext )
+{
+    std::ostream& os = aContext.m_out;
+
+    // Reference: the zones filled one after the other, as before the ZONE_FILLER
+    std::vector<ZONE_CONTAINER*> zones = zonesToFill( aContext.GetBoard() );
+    std::vector<ZONE_FILL_RESULT> reference;
+    std::vector<long long> serialUs;
+
+    TIME_PT start = CLOCK::now();
+
+    for( ZONE_CONTAINER* zone : zones )
+    {
+        TIME_PT zoneStart = CLOCK::now();
+
+        zone->UnFill();
+        zone->BuildFilledSolidAreasPolygons( aContext.GetBoard() );
+
+        serialUs.push_back( elapsedUs( zoneStart ) );
+    }
+
+    long long serialTotalUs = elapsedUs( start );
+
+    for( ZONE_CONTAINER* zone : zones )
+        reference.push_back( fillResult( zone ) );
+
+    // The ZONE_FILLER, starting each time from the loaded board
+    long long bestUs = -1;
+    std::vector<ZONE_FILL_STATS> stats;
+    int mismatches = 0;
+    unsigned hits = 0;
+    unsigned misses = 0;
+
+    for( int rep = 0; rep < aContext.m_reps; ++rep )
+    {
+        aContext.ReloadBoard();
+        zones = zonesToFill( aContext.GetBoard() );
+
+        ZONE_FILLER filler( aContext.GetBoard() );
+        ZONE_OBSTACLE_CACHE* obstacles = aContext.GetBoard()->GetZoneObstacleCache();
+
+        start = CLOCK::now();
+        filler.Fill( zones );
+        long long us = elapsedUs( start );
+
+        if( bestUs < 0 || us < bestUs )
+        {
+            bestUs = us;
+            stats = filler.GetStats();
+            hits = obstacles->GetHits();
+            misses = obstacles->GetMisses();
+        }
+
+        for( size_t ii = 0; ii < zones.size(); ++ii )
+        {
+            if( !sameFill( reference[ii], fillResult( zones[ii] ) ) )
+                mismatches++;
+        }
+    }
+
+    // Refill the last board: the obstacle polygons are already in the cache
+    long long warmUs = 0;
+    unsigned warmHits = 0;
+    unsigned warmMisses = 0;
+
+    if( aContext.m_reps > 0 )
+    {
+        ZONE_FILLER filler( aContext.GetBoard() );
+        ZONE_OBSTACLE_CACHE* obstacles = aContext.GetBoard()->GetZoneObstacleCache();
+
+        obstacles->ResetStats();
+
+        start = CLOCK::now();
+        filler.Fill( zones );
+        warmUs = elapsedUs( start );
+
+        warmHits = obstacles->GetHits();
+        warmMisses = obstacles->GetMisses();
+
+        for( size_t ii = 0; ii < zones.size(); ++ii )
+        {
+            if( !sameFill( reference[ii], fillResult( zones[ii] ) ) )
+                mismatches++;
+        }
+    }
+
+    os << "  zone  layer      net                  serial us  compute us   finish us\n";
+
+    for( size_t ii = 0; ii < zones.size(); ++ii )
+    {
+        os << wxString::Format( "  %4d  %-9s  %-20s %10lld  %10u  %10u", (int) ii,
+                                zones[ii]->GetLayerName(),
+                                zones[ii]->GetNetname().Left( 20 ),
+                                serialUs[ii], stats[ii].m_computeTime,
+                                stats[ii].m_finishTime ) << std::endl;
+    }
+
+    os << wxString::Format( "  %d zones, serial: %lld us, parallel (%u threads): %lld us, "
+                            "%d mismatches",
+                            (int) zones.size(), serialTotalUs,
+                            THREAD_POOL::GetInstance().GetThreadCount(), bestUs, mismatches )
+       << std::endl;
+
+    os << wxString::Format( "  obstacle cache: first fill %u hits, %u misses; "
+                            "refill %lld us, %u hits, %u misses",
+                            hits, misses, warmUs, warmHits, warmMisses ) << std::endl;
+
+    aContext.ReloadBoard();
+
+    return mismatches == 0;
+}
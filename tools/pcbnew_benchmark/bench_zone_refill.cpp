@@ -0,0 +1,215 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file bench_zone_refill.cpp
+ * Fills all the zones of a board, then applies random local edits, refilling the zones
+ * incrementally after each of them, as the AutoRefillZones setting does. The filled areas
+ * are then compared with a full fill of the edited board: the fracture cut lines may differ,
+ * but the areas covered must be exactly the same.
+ */
+
+#include <fctsys.h>
+#include <class_board.h>
+#include <class_module.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <connectivity.h>
+#include <zone_filler.h>
+#include <zone_obstacle_cache.h>
+
+#include <algorithm>
+#include <random>
+
+#include "pcbnew_benchmark.h"
+
+
+/// The number of outlines covered by only one of the sets
+static int differenceCount( const SHAPE_POLY_SET& aPolysA, const SHAPE_POLY_SET& aPolysB )
+{
+    SHAPE_POLY_SET difference( aPolysA );
+
+    difference.BooleanXor( aPolysB, SHAPE_POLY_SET::PM_FAST );
+
+    return difference.OutlineCount();
+}
+
+
+/// The counts and the times of the zones refilled by refill()
+struct REFILL_TOTALS
+{
+    REFILL_TOTALS() :
+        m_updated( 0 ),
+        m_kept( 0 ),
+        m_computeUs( 0 ),
+        m_finishUs( 0 )
+    {
+    }
+
+    int       m_updated;
+    int       m_kept;
+    long long m_computeUs;  ///< filled areas computation of the updated zones
+    long long m_finishUs;   ///< islands removal and fill segments of the updated zones
+};
+
+
+static void refill( BOARD* aBoard, const std::vector<ZONE_CONTAINER*>& aZones,
+                    bool aIncremental, REFILL_TOTALS& aTotals )
+{
+    ZONE_FILLER filler( aBoard );
+
+    filler.SetIncremental( aIncremental );
+    filler.Fill( aZones );
+
+    for( const ZONE_FILL_STATS& stats : filler.GetStats() )
+    {
+        if( stats.m_kept )
+        {
+            aTotals.m_kept++;
+        }
+        else if( stats.m_incremental )
+        {
+            aTotals.m_updated++;
+            aTotals.m_computeUs += stats.m_computeTime;
+            aTotals.m_finishUs += stats.m_finishTime;
+        }
+    }
+}
+
+
+bool bench_zone_refill( BENCH_CONTEXT& aContext )
+{
+    std::ostream& os = aContext.m_out;
+    BOARD* board = aContext.GetBoard();
+    ZONE_OBSTACLE_CACHE* obstacles = board->GetZoneObstacleCache();
+    std::vector<ZONE_CONTAINER*> zones;
+
+    for( int ii = 0; ii < board->GetAreaCount(); ++ii )
+    {
+        if( !board->GetArea( ii )->GetIsKeepout() )
+            zones.push_back( board->GetArea( ii ) );
+    }
+
+    REFILL_TOTALS totals;
+
+    TIME_PT start = CLOCK::now();
+    refill( board, zones, false, totals );
+    long long fullUs = elapsedUs( start );
+
+    os << wxString::Format( "  full fill:          %lld us, %d zones", fullUs,
+                            (int) zones.size() ) << std::endl;
+
+    std::vector<TRACK*> tracks;
+    std::vector<MODULE*> modules;
+
+    for( TRACK* track = board->m_Track; track; track = track->Next() )
+        tracks.push_back( track );
+
+    for( MODULE* module = board->m_Modules; module; module = module->Next() )
+        modules.push_back( module );
+
+    // The edits are the same from run to run
+    std::mt19937 rng( 1 );
+    std::uniform_int_distribution<int> offset( -500000, 500000 );   // +/- 0.5 mm
+
+    int edits = aContext.m_reps * 20;
+    long long incrementalUs = 0;
+    long long maxUs = 0;
+
+    totals = REFILL_TOTALS();
+
+    for( int ii = 0; ii < edits && ( tracks.size() || modules.size() ); ++ii )
+    {
+        bool moveModule = modules.size() && ( tracks.empty() || rng() % 4 == 0 );
+        wxPoint delta( offset( rng ), offset( rng ) );
+        BOARD_ITEM* item;
+
+        if( moveModule )
+            item = modules[ rng() % modules.size() ];
+        else
+            item = tracks[ rng() % tracks.size() ];
+
+        // What a commit does for a modified item
+        std::unique_ptr<BOARD_ITEM> copy( static_cast<BOARD_ITEM*>( item->Clone() ) );
+
+        item->Move( delta );
+        board->GetConnectivity()->Update( item );
+        obstacles->AddDirtyItem( item, copy.get() );
+        obstacles->Invalidate( item );
+
+        start = CLOCK::now();
+        refill( board, zones, true, totals );
+        long long us = elapsedUs( start );
+
+        incrementalUs += us;
+        maxUs = std::max( maxUs, us );
+    }
+
+    if( edits )
+    {
+        os << wxString::Format( "  incremental refill: %d edits, mean %lld us, max %lld us, "
+                                "%d zones updated, %d kept",
+                                edits, incrementalUs / edits, maxUs, totals.m_updated,
+                                totals.m_kept ) << std::endl;
+
+        // The islands are searched in the whole zone after each update
+        os << wxString::Format( "  updated zones:      mean %lld us computing, "
+                                "%lld us removing the islands",
+                                totals.m_computeUs / std::max( totals.m_updated, 1 ),
+                                totals.m_finishUs / std::max( totals.m_updated, 1 ) )
+           << std::endl;
+    }
+
+    // The reference: a full fill of the edited board
+    std::vector<SHAPE_POLY_SET> incremental;
+
+    for( ZONE_CONTAINER* zone : zones )
+        incremental.push_back( zone->GetFilledPolysList() );
+
+    totals = REFILL_TOTALS();
+
+    start = CLOCK::now();
+    refill( board, zones, false, totals );
+    fullUs = elapsedUs( start );
+
+    int mismatches = 0;
+    int differences = 0;
+
+    for( size_t ii = 0; ii < zones.size(); ++ii )
+    {
+        int count = differenceCount( incremental[ii], zones[ii]->GetFilledPolysList() );
+
+        differences += count;
+
+        if( count )
+            mismatches++;
+    }
+
+    os << wxString::Format( "  full fill, edited:  %lld us, %d mismatches, "
+                            "%d differing outlines",
+                            fullUs, mismatches, differences ) << std::endl;
+
+    aContext.ReloadBoard();
+
+    return mismatches == 0;
+}
@@ -0,0 +1,207 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file pcbnew_benchmark.cpp
+ * Runs the pcbnew benchmarks on a board file, without user interface:
+ *   pcbnew_benchmark <board.kicad_pcb> <REPS> [benchmark flags]
+ */
+
+#include <wx/wx.h>
+#include <wx/init.h>
+
+#include <fctsys.h>
+#include <pgm_base.h>
+#include <class_board.h>
+#include <io_mgr.h>
+
+#include "pcbnew_benchmark.h"
+
+
+/**
+ * Struct PGM_BENCHMARK
+ * the process level object the pcbnew objects expect. The benchmarks do not use it.
+ */
+static struct PGM_BENCHMARK : public PGM_BASE
+{
+    void MacOpenFile( const wxString& aFileName ) override
+    {
+    }
+} program;
+
+
+PGM_BASE& Pgm()
+{
+    return program;
+}
+
+
+BENCH_CONTEXT::~BENCH_CONTEXT()
+{
+}
+
+
+BOARD* BENCH_CONTEXT::GetBoard()
+{
+    if( !m_board )
+    {
+        m_board.reset( IO_MGR::Load( IO_MGR::KICAD_SEXP, m_file.GetFullPath() ) );
+        m_board->BuildConnectivity();
+        m_board->SynchronizeNetsAndNetClasses();
+    }
+
+    return m_board.get();
+}
+
+
+void BENCH_CONTEXT::ReloadBoard()
+{
+    m_board.reset();
+}
+
+
+/**
+ * List of available benchmarks
+ */
+static std::vector<BENCHMARK> benchmarkList =
+{
+    { 'd', bench_live_drc, "Live DRC" },
+    { 'z', bench_zone_fill, "Zone fill" },
+    { 'r', bench_zone_refill, "Incremental zone refill" },
+    { 'c', bench_connectivity, "Connectivity build" },
+    { 'u', bench_connectivity_update, "Incremental connectivity update" },
+    { 'n', bench_ratsnest, "Ratsnest" },
+    { 'k', bench_track_cleanup, "Track cleanup queries" },
+    { 'p', bench_router, "Push and shove router replay" },
+    { 'g', bench_poly_partition, "Partitioned polygon operations of the zone fill" },
+    { 'x', bench_seg_batch, "Segment batches of the line chain collisions" },
+    { 'l', bench_board_load, "Board file load" },
+    { 's', bench_board_save, "Board file save" },
+    { 'b', bench_board_snapshot, "Board snapshot save and load" },
+    { 'f', bench_footprint_list, "Footprint library list through its index" },
+};
+
+
+/**
+ * Construct string of all flags used for specifying benchmarks
+ * on the command line
+ */
+static wxString getBenchFlags()
+{
+    wxString flags;
+
+    for( auto& bmark : benchmarkList )
+    {
+        flags << bmark.triggerChar;
+    }
+
+    return flags;
+}
+
+
+/**
+ * Usage description of a benchmark spec
+ */
+static wxString getBenchDescriptions()
+{
+    wxString desc;
+
+    for( auto& bmark : benchmarkList )
+    {
+        desc << "    " << bmark.triggerChar << ": " << bmark.name << "\n";
+    }
+
+    return desc;
+}
+
+
+enum RET_CODES
+{
+    BAD_ARGS = 1,
+    BAD_RESULTS = 2,
+    LOAD_FAILED = 3,
+};
+
+
+int main( int argc, char* argv[] )
+{
+    wxInitializer initializer( argc, argv );
+    auto& os = std::cout;
+
+    if( argc < 3 )
+    {
+        os << "Usage: " << argv[0] << " <FILE> <REPS> [" << getBenchFlags() << "]\n\n";
+        os << "Benchmarks:\n";
+        os << getBenchDescriptions();
+        return BAD_ARGS;
+    }
+
+    wxFileName inFile( argv[1] );
+
+    long reps = 0;
+    wxString( argv[2] ).ToLong( &reps );
+
+    // get the benchmark to do, or all of them if nothing given
+    wxString bench;
+
+    if( argc == 4 )
+        bench = argv[3];
+
+    os << "Pcbnew Bench Mark Util" << std::endl;
+
+    os << "  Benchmark file: " << inFile.GetFullName() << std::endl;
+    os << "  Repetitions:    " << (int) reps << std::endl;
+    os << std::endl;
+
+    BENCH_CONTEXT context( inFile, std::max( 1, (int) reps ), os );
+
+    try
+    {
+        context.GetBoard();
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        os << "Cannot load the board: " << ioe.What() << std::endl;
+        return LOAD_FAILED;
+    }
+
+    bool ok = true;
+
+    for( auto& bmark : benchmarkList )
+    {
+        if( bench.size() && !bench.Contains( bmark.triggerChar ) )
+            continue;
+
+        os << bmark.name << std::endl;
+
+        if( !bmark.func( context ) )
+        {
+            os << "  RESULTS DIFFER" << std::endl;
+            ok = false;
+        }
+
+        os << std::endl;
+    }
+
+    return ok ? 0 : BAD_RESULTS;
+}
@@ -0,0 +1,122 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2017 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef PCBNEW_BENCHMARK_H
+#define PCBNEW_BENCHMARK_H
+
+#include <wx/filename.h>
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+
+class BOARD;
+
+
+using CLOCK = std::chrono::steady_clock;
+using TIME_PT = std::chrono::time_point<CLOCK>;
+
+
+/**
+ * @return the time elapsed since aStart, in microseconds.
+ */
+inline long long elapsedUs( const TIME_PT& aStart )
+{
+    using std::chrono::microseconds;
+    using std::chrono::duration_cast;
+
+    return duration_cast<microseconds>( CLOCK::now() - aStart ).count();
+}
+
+
+/**
+ * Struct BENCH_CONTEXT
+ * what a benchmark works on: the board file given on the command line, and the board
+ * loaded from it.
+ */
+struct BENCH_CONTEXT
+{
+    BENCH_CONTEXT( const wxFileName& aFile, int aReps, std::ostream& aOut ) :
+        m_file( aFile ),
+        m_reps( aReps ),
+        m_out( aOut )
+    {
+    }
+
+    ~BENCH_CONTEXT();
+
+    /**
+     * Function GetBoard
+     * @return the board, loaded on first use. Benchmarks modifying it must call
+     * ReloadBoard() when done.
+     */
+    BOARD* GetBoard();
+
+    /**
+     * Function ReloadBoard
+     * drops the board, which will be loaded again by the next GetBoard().
+     */
+    void ReloadBoard();
+
+    wxFileName              m_file;
+    int                     m_reps;
+    std::ostream&           m_out;
+
+private:
+    std::unique_ptr<BOARD>  m_board;
+};
+
+
+/**
+ * A benchmark prints its timings to aContext.m_out.
+ * @return false if the results of the optimized code differ from the reference ones.
+ */
+using BENCH_FUNC = std::function<bool( BENCH_CONTEXT& aContext )>;
+
+
+struct BENCHMARK
+{
+    char triggerChar;
+    BENCH_FUNC func;
+    wxString name;
+};
+
+
+// The benchmarks, each in its own file
+bool bench_board_load( BENCH_CONTEXT& aContext );
+bool bench_board_save( BENCH_CONTEXT& aContext );
+bool bench_board_snapshot( BENCH_CONTEXT& aContext );
+bool bench_connectivity( BENCH_CONTEXT& aContext );
+bool bench_connectivity_update( BENCH_CONTEXT& aContext );
+bool bench_footprint_list( BENCH_CONTEXT& aContext );
+bool bench_live_drc( BENCH_CONTEXT& aContext );
+bool bench_poly_partition( BENCH_CONTEXT& aContext );
+bool bench_ratsnest( BENCH_CONTEXT& aContext );
+bool bench_router( BENCH_CONTEXT& aContext );
+bool bench_seg_batch( BENCH_CONTEXT& aContext );
+bool bench_track_cleanup( BENCH_CONTEXT& aContext );
+bool bench_zone_fill( BENCH_CONTEXT& aContext );
+bool bench_zone_refill( BENCH_CONTEXT& aContext );
+
+#endif  // PCBNEW_BENCHMARK_H